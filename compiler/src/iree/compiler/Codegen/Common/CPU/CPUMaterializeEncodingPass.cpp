@@ -130,8 +130,10 @@ chooseMatmulTileParamsX86_64(EncodingUser user, ExecutableTargetAttr target) {
   }
 }
 
-static MatmulTileParams chooseMatmulTileParams(EncodingUser user,
-                                               ExecutableTargetAttr target) {
+} // namespace
+
+MatmulTileParams chooseMatmulTileParams(EncodingUser user,
+                                        ExecutableTargetAttr target) {
   if (isAArch64(target)) {
     return chooseMatmulTileParamsAArch64(user, target);
   }
@@ -141,6 +143,8 @@ static MatmulTileParams chooseMatmulTileParams(EncodingUser user,
   return chooseMatmulTileParamsGeneric(target);
 }
 
+namespace {
+
 struct CPUMaterializeEncodingPass
     : public CPUMaterializeEncodingBase<CPUMaterializeEncodingPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
@@ -12,6 +12,7 @@
 #ifndef IREE_COMPILER_CODEGEN_COMMON_CPU_PASSES_H_
 #define IREE_COMPILER_CODEGEN_COMMON_CPU_PASSES_H_
 
+#include "iree/compiler/Codegen/Common/EncodingInfo.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Pass/Pass.h"
 
@@ -42,6 +43,11 @@ std::unique_ptr<OperationPass<func::FuncOp>> createCPUMaterializeEncodingPass();
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createCPUMaterializeUpperBoundTileSizePass();
 
+/// Returns the inner tile sizes that data-tiling uses on `target` for matmuls
+/// of the given `user` type. These are dynamic on VMVX with microkernels.
+MatmulTileParams chooseMatmulTileParams(IREE::LinalgExt::EncodingUser user,
+                                        IREE::HAL::ExecutableTargetAttr target);
+
 void registerCodegenCommonCPUPasses();
 
 } // namespace iree_compiler
@@ -31,6 +31,7 @@
 #include "mlir/Dialect/Utils/IndexingUtils.h"
 #include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #define DEBUG_TYPE "kernel-dispatch"
@@ -1751,9 +1752,68 @@ getNhwcConvVectorSizes(func::FuncOp entryPointFn,
   llvm_unreachable("unsupported conv");
 }
 
+/// Returns true if `convOp` gets lowered to the conv2d microkernel by
+/// LLVMCPULowerToUKernels. Keep in sync with the element types and shapes
+/// handled there.
+static bool isSupportedByConv2DUKernel(linalg::Conv2DNhwcHwcfOp convOp) {
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(convOp);
+  if (!hasMicrokernels(targetAttr) || isVMVXBackend(targetAttr)) {
+    return false;
+  }
+  auto filterType = cast<ShapedType>(convOp.getInputs()[1].getType());
+  if (!filterType.hasStaticShape()) {
+    return false;
+  }
+  Type inElemType = getElementTypeOrSelf(convOp.getInputs()[0].getType());
+  Type filterElemType = filterType.getElementType();
+  Type outElemType = getElementTypeOrSelf(convOp->getResultTypes()[0]);
+  if (inElemType != filterElemType) {
+    return false;
+  }
+  if (inElemType.isSignlessInteger(8)) {
+    return outElemType.isSignlessInteger(32);
+  }
+  return outElemType.isF32() &&
+         (inElemType.isF32() || inElemType.isF16() || inElemType.isBF16());
+}
+
+/// Sets the lowering configuration for a linalg.conv_2d_nhwc_hwcf op that gets
+/// lowered to the conv2d microkernel. Only the distribution level is tiled,
+/// the microkernel handling everything within a workgroup. The batch is
+/// distributed one image at a time and the output width is not distributed,
+/// so that the input tile that the microkernel reads stays contiguous except
+/// across images, and the output tile collapses to a 2D matrix.
+static LogicalResult
+setConv2DUKernelRootConfig(func::FuncOp entryPointFn,
+                           linalg::Conv2DNhwcHwcfOp convOp) {
+  // Loops are N, OH, OW, OC, KH, KW, IC.
+  unsigned numLoops = convOp.getNumLoops();
+  SmallVector<int64_t> minTileSizes(numLoops, 0);
+  SmallVector<int64_t> maxTileSizes(numLoops, 0);
+  minTileSizes[0] = maxTileSizes[0] = 1;
+  minTileSizes[1] = 1;
+  maxTileSizes[1] = defaultDistTileSize;
+  minTileSizes[3] = 1;
+  maxTileSizes[3] = defaultDistTileSize;
+  SmallVector<int64_t> distTileSizes = getDefaultDistributedLevelTileSizes(
+      convOp, minTileSizes, maxTileSizes, /*allowIncompleteTile=*/true);
+  TileSizesListType tileSizes = {distTileSizes,
+                                 SmallVector<int64_t>(numLoops, 0),
+                                 SmallVector<int64_t>(numLoops, 0)};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPointFn, convOp, tileSizes,
+      DispatchLoweringPassPipeline::Mmt4dTilingExpert);
+}
+
 static LogicalResult
 setConvInterfaceRootConfig(func::FuncOp entryPointFn,
                            linalg::ConvolutionOpInterface convOp) {
+  if (auto conv2DOp =
+          dyn_cast<linalg::Conv2DNhwcHwcfOp>(convOp.getOperation())) {
+    if (isSupportedByConv2DUKernel(conv2DOp)) {
+      return setConv2DUKernelRootConfig(entryPointFn, conv2DOp);
+    }
+  }
   int64_t vectorSize = getVectorSize(
       entryPointFn, cast<ShapedType>(convOp->getResultTypes()[0]));
   SmallVector<int64_t> targetTileSizes =
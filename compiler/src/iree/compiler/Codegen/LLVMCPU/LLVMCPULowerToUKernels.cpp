@@ -4,8 +4,12 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <limits>
+#include <optional>
+
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/builtins/ukernel/exported_bits.h"
+#include "iree/compiler/Codegen/Common/CPU/Passes.h"
 #include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
 #include "iree/compiler/Codegen/Dialect/IREECodegenOps.h"
 #include "iree/compiler/Codegen/Dialect/UKernelOps.h"
@@ -15,12 +19,14 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeRange.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 namespace mlir {
@@ -102,6 +108,40 @@ getFnNameAndDefAttrs(const char *ukernelName, RewriterBase &rewriter,
   return result;
 }
 
+/// Returns the IREE_UK_FLAG_MMT4D_TYPE_* value for the given element types,
+/// or 0 if the mmt4d microkernel does not support them.
+static uint32_t getMmt4DTypeFlags(Type lhsElemType, Type rhsElemType,
+                                  Type outElemType) {
+  if (lhsElemType.isSignlessInteger(8) && rhsElemType.isSignlessInteger(8) &&
+      outElemType.isSignlessInteger(32)) {
+    return IREE_UK_FLAG_MMT4D_TYPE_I8I8I32;
+  }
+  if (lhsElemType.isSignlessInteger(8) && rhsElemType.isSignlessInteger(4) &&
+      outElemType.isSignlessInteger(32)) {
+    return IREE_UK_FLAG_MMT4D_TYPE_I8I4I32;
+  }
+  if (lhsElemType.isF32() && rhsElemType.isSignlessInteger(4) &&
+      outElemType.isF32()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_F32I4F32;
+  }
+  if (lhsElemType.isF32() && rhsElemType.isF32() && outElemType.isF32()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_F32F32F32;
+  }
+  if (lhsElemType.isF16() && rhsElemType.isF16() && outElemType.isF32()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_F16F16F32;
+  }
+  if (lhsElemType.isF16() && rhsElemType.isF16() && outElemType.isF16()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_F16F16F16;
+  }
+  if (lhsElemType.isBF16() && rhsElemType.isBF16() && outElemType.isF32()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32;
+  }
+  if (lhsElemType.isBF16() && rhsElemType.isBF16() && outElemType.isBF16()) {
+    return IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16;
+  }
+  return 0;
+}
+
 /// Matches an (linalg.fill -> )? linalg.mmt4d operation sequence and converts
 /// it into a iree_codegen.ukernel.mmt4d operation, that is later lowered
 /// into a call to the microkernel.
@@ -117,26 +157,8 @@ matchDAGForUKernel(RewriterBase &rewriter, linalg::Mmt4DOp op,
   Type lhsElemType = lhsType.getElementType();
   Type rhsElemType = rhsType.getElementType();
   Type outElemType = outType.getElementType();
-  uint32_t flags = 0;
-  if (lhsElemType.isSignlessInteger(8) && rhsElemType.isSignlessInteger(8) &&
-      outElemType.isSignlessInteger(32)) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_I8I8I32;
-  } else if (lhsElemType.isF32() && rhsElemType.isF32() &&
-             outElemType.isF32()) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_F32F32F32;
-  } else if (lhsElemType.isF16() && rhsElemType.isF16() &&
-             outElemType.isF32()) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_F16F16F32;
-  } else if (lhsElemType.isF16() && rhsElemType.isF16() &&
-             outElemType.isF16()) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_F16F16F16;
-  } else if (lhsElemType.isBF16() && rhsElemType.isBF16() &&
-             outElemType.isF32()) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32;
-  } else if (lhsElemType.isBF16() && rhsElemType.isBF16() &&
-             outElemType.isBF16()) {
-    flags = IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16;
-  } else {
+  uint32_t flags = getMmt4DTypeFlags(lhsElemType, rhsElemType, outElemType);
+  if (!flags) {
     return rewriter.notifyMatchFailure(
         op, "unsupported combination of element types");
   }
@@ -184,6 +206,211 @@ matchDAGForUKernel(RewriterBase &rewriter, linalg::Mmt4DOp op,
       genericMicroKernelOp.getOperation());
 }
 
+/// Describes an elementwise consumer of a linalg.mmt4d op that the
+/// mmt4d_fused microkernel can apply to the accumulator tiles instead.
+struct Mmt4DEpilogue {
+  linalg::GenericOp genericOp;
+  Value bias;
+  uint32_t flags = 0;
+  float clampMin = -std::numeric_limits<float>::infinity();
+  float clampMax = std::numeric_limits<float>::infinity();
+};
+
+/// Returns the value of the scalar constant `value`, if it is one and is
+/// exactly representable as the f32 clamp bound passed to the microkernel.
+static std::optional<float> getConstantClampBound(Value value) {
+  Attribute attr;
+  if (!matchPattern(value, m_Constant(&attr))) {
+    return std::nullopt;
+  }
+  if (auto floatAttr = llvm::dyn_cast<FloatAttr>(attr)) {
+    double bound = floatAttr.getValueAsDouble();
+    if (static_cast<double>(static_cast<float>(bound)) != bound) {
+      return std::nullopt;
+    }
+    return static_cast<float>(bound);
+  }
+  if (auto intAttr = llvm::dyn_cast<IntegerAttr>(attr)) {
+    int64_t bound = intAttr.getValue().getSExtValue();
+    if (bound < -(int64_t{1} << 24) || bound > (int64_t{1} << 24)) {
+      return std::nullopt;
+    }
+    return static_cast<float>(bound);
+  }
+  return std::nullopt;
+}
+
+/// Matches the sole consumer of `op` if it is a linalg.generic computing
+///   clamp(mmt4d_result + broadcast(bias))
+/// on packed tiles, where the bias is a [M][M0] (per-row) or [N][N0]
+/// (per-column) tensor and the clamp is an optional sequence of max/min with
+/// constants, e.g. a ReLU.
+static FailureOr<Mmt4DEpilogue> matchMmt4DEpilogue(RewriterBase &rewriter,
+                                                   linalg::Mmt4DOp op) {
+  Value result = op->getResult(0);
+  if (!result.hasOneUse()) {
+    return rewriter.notifyMatchFailure(op, "expected a single consumer");
+  }
+  Mmt4DEpilogue epilogue;
+  epilogue.genericOp = dyn_cast<linalg::GenericOp>(*result.user_begin());
+  linalg::GenericOp genericOp = epilogue.genericOp;
+  if (!genericOp || genericOp.getNumLoops() != 4 ||
+      genericOp.getNumParallelLoops() != 4 ||
+      genericOp.getNumDpsInputs() != 2 || genericOp.getNumDpsInits() != 1 ||
+      genericOp->getResult(0).getType() != result.getType()) {
+    return rewriter.notifyMatchFailure(
+        op, "expected an elementwise consumer of the same type");
+  }
+  OpOperand *init = genericOp.getDpsInitOperand(0);
+  if (!genericOp.getMatchingIndexingMap(init).isIdentity() ||
+      genericOp.payloadUsesValueFromOperand(init)) {
+    return rewriter.notifyMatchFailure(op, "unsupported consumer init");
+  }
+
+  MLIRContext *context = op.getContext();
+  AffineExpr d0, d1, d2, d3;
+  bindDims(context, d0, d1, d2, d3);
+  AffineMap perRowMap = AffineMap::get(4, 0, {d0, d2}, context);
+  AffineMap perColumnMap = AffineMap::get(4, 0, {d1, d3}, context);
+  Value accArg, biasArg;
+  for (OpOperand *input : genericOp.getDpsInputOperands()) {
+    AffineMap map = genericOp.getMatchingIndexingMap(input);
+    Value arg = genericOp.getMatchingBlockArgument(input);
+    if (input->get() == result && map.isIdentity()) {
+      accArg = arg;
+    } else if (map == perRowMap || map == perColumnMap) {
+      epilogue.bias = input->get();
+      epilogue.flags |= map == perRowMap
+                            ? IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW
+                            : IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN;
+      biasArg = arg;
+    }
+  }
+  if (!accArg || !biasArg) {
+    return rewriter.notifyMatchFailure(
+        op, "expected the consumer to broadcast a bias over packed rows or "
+            "columns");
+  }
+
+  // Follow the chain of ops from the accumulator to the yielded value. The
+  // microkernel adds the bias before clamping, so only accept that order.
+  Value current = accArg;
+  bool biasAdded = false;
+  Block &body = genericOp.getRegion().front();
+  for (Operation &bodyOp : body.without_terminator()) {
+    if (bodyOp.getNumOperands() != 2 || bodyOp.getNumResults() != 1 ||
+        !llvm::is_contained(bodyOp.getOperands(), current)) {
+      return rewriter.notifyMatchFailure(op, "unsupported consumer body");
+    }
+    Value other = bodyOp.getOperand(0) == current ? bodyOp.getOperand(1)
+                                                  : bodyOp.getOperand(0);
+    std::optional<float> bound = getConstantClampBound(other);
+    if (isa<arith::AddFOp, arith::AddIOp>(bodyOp) && other == biasArg &&
+        !biasAdded && !(epilogue.flags & IREE_UK_FLAG_MMT4D_FUSED_CLAMP)) {
+      biasAdded = true;
+    } else if (isa<arith::MaxFOp, arith::MaxSIOp>(bodyOp) && bound) {
+      epilogue.flags |= IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+      epilogue.clampMin = std::max(epilogue.clampMin, *bound);
+    } else if (isa<arith::MinFOp, arith::MinSIOp>(bodyOp) && bound) {
+      epilogue.flags |= IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+      epilogue.clampMax = std::min(epilogue.clampMax, *bound);
+    } else {
+      return rewriter.notifyMatchFailure(op, "unsupported consumer body op");
+    }
+    current = bodyOp.getResult(0);
+  }
+  if (!biasAdded || body.getTerminator()->getOperand(0) != current) {
+    return rewriter.notifyMatchFailure(op, "unsupported consumer body");
+  }
+  return epilogue;
+}
+
+/// Matches an (linalg.fill -> )? linalg.mmt4d -> linalg.generic operation
+/// sequence, where the linalg.generic is a bias-add and optional clamp, and
+/// converts it into a call to the mmt4d_fused microkernel, which applies that
+/// epilogue to each accumulator tile while it is still in cache. Returns the
+/// value replacing the linalg.generic result.
+static FailureOr<Value>
+lowerMmt4DWithEpilogueToUKernel(RewriterBase &rewriter, linalg::Mmt4DOp op,
+                                bool skipIntermediateRoundings) {
+  Value lhs = op.getDpsInputOperand(0)->get();
+  Value rhs = op.getDpsInputOperand(1)->get();
+  Value out = op.getDpsInitOperand(0)->get();
+  auto outType = llvm::cast<ShapedType>(out.getType());
+  uint32_t typeFlags = getMmt4DTypeFlags(
+      llvm::cast<ShapedType>(lhs.getType()).getElementType(),
+      llvm::cast<ShapedType>(rhs.getType()).getElementType(),
+      outType.getElementType());
+  // The mmt4d_fused type flags have the same values as the mmt4d ones, but
+  // only types with a 32-bit accumulator are supported.
+  switch (typeFlags) {
+  case IREE_UK_FLAG_MMT4D_TYPE_F32F32F32:
+  case IREE_UK_FLAG_MMT4D_TYPE_I8I8I32:
+  case IREE_UK_FLAG_MMT4D_TYPE_F16F16F32:
+  case IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32:
+  case IREE_UK_FLAG_MMT4D_TYPE_I8I4I32:
+  case IREE_UK_FLAG_MMT4D_TYPE_F32I4F32:
+    break;
+  default:
+    return rewriter.notifyMatchFailure(
+        op, "unsupported combination of element types");
+  }
+
+  FailureOr<Mmt4DEpilogue> epilogue = matchMmt4DEpilogue(rewriter, op);
+  if (failed(epilogue)) {
+    return failure();
+  }
+  uint32_t flags = typeFlags | epilogue->flags;
+
+  if (isInitializedToZero(out)) {
+    if (auto fillOp = out.getDefiningOp<linalg::FillOp>()) {
+      out = fillOp.getDpsInitOperand(0)->get();
+    }
+  } else {
+    flags |= IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE;
+  }
+  if (skipIntermediateRoundings) {
+    flags |= IREE_UK_FLAG_MMT4D_FUSED_SKIP_INTERMEDIATE_ROUNDINGS;
+  }
+
+  // The bias may be defined between the mmt4d op and its consumer, e.g. as a
+  // slice created by tiling, so create the microkernel op at the consumer.
+  rewriter.setInsertionPoint(epilogue->genericOp);
+  Location loc = op.getLoc();
+  Value m = rewriter.create<tensor::DimOp>(loc, lhs, 0);
+  Value n = rewriter.create<tensor::DimOp>(loc, rhs, 0);
+  Value k = rewriter.create<tensor::DimOp>(loc, rhs, 1);
+  auto getDimAsI32 = [&](Value value, int dim) -> Value {
+    return rewriter.create<arith::IndexCastOp>(
+        loc, rewriter.getI32Type(),
+        rewriter.create<tensor::DimOp>(loc, value, dim));
+  };
+  Value m0 = getDimAsI32(lhs, 2);
+  Value n0 = getDimAsI32(rhs, 2);
+  Value k0 = getDimAsI32(rhs, 3);
+  auto getF32Constant = [&](float value) -> Value {
+    return rewriter.create<arith::ConstantOp>(loc,
+                                              rewriter.getF32FloatAttr(value));
+  };
+  // Requantization is not matched yet, so its scale and zero point are unused.
+  Value requantizeScale = getF32Constant(1.0f);
+  Value outZeroPoint =
+      rewriter.create<arith::ConstantOp>(loc, rewriter.getI32IntegerAttr(0));
+  Value clampMin = getF32Constant(epilogue->clampMin);
+  Value clampMax = getF32Constant(epilogue->clampMax);
+  Value flagsVal = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getI32IntegerAttr(flags));
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
+  auto fn = getFnNameAndDefAttrs("mmt4d_fused", rewriter, targetAttr);
+  auto genericMicroKernelOp = rewriter.create<IREE::Codegen::UKernelGenericOp>(
+      loc, outType, fn.name, ValueRange{lhs, rhs, epilogue->bias}, out,
+      ValueRange{m, n, k, m0, n0, k0, requantizeScale, outZeroPoint, clampMin,
+                 clampMax, flagsVal},
+      /*fn_def_attrs=*/rewriter.getDictionaryAttr(fn.defAttrs),
+      /*strided_outer_dims=*/rewriter.getIndexAttr(1));
+  return genericMicroKernelOp->getResult(0);
+}
+
 static FailureOr<IREE::Codegen::UKernelOpInterface>
 matchDAGForUKernel(RewriterBase &rewriter, tensor::PackOp op,
                    bool /*skipIntermediateRoundings*/) {
@@ -383,6 +610,185 @@ matchDAGForUKernel(RewriterBase &rewriter, tensor::UnPackOp op,
       genericMicroKernelOp.getOperation());
 }
 
+/// Returns the zero padding of `input` that can be folded into the conv2d
+/// microkernel, as {top, left}, updating `input` to the unpadded value. Only
+/// static zero padding of the spatial dimensions is folded. Bottom and right
+/// padding need not be passed, as the microkernel reads zeros for any input
+/// position past the end of the image.
+static std::pair<int64_t, int64_t> foldConv2DInputPadding(Value &input) {
+  auto padOp = input.getDefiningOp<tensor::PadOp>();
+  if (!padOp) {
+    return {0, 0};
+  }
+  Value padVal = padOp.getConstantPaddingValue();
+  if (!padVal || !(matchPattern(padVal, m_Zero()) ||
+                   matchPattern(padVal, m_AnyZeroFloat()))) {
+    return {0, 0};
+  }
+  std::optional<SmallVector<int64_t>> low =
+      getConstantIntValues(padOp.getMixedLowPad());
+  std::optional<SmallVector<int64_t>> high =
+      getConstantIntValues(padOp.getMixedHighPad());
+  if (!low || !high || (*low)[0] != 0 || (*low)[3] != 0 || (*high)[0] != 0 ||
+      (*high)[3] != 0) {
+    return {0, 0};
+  }
+  input = padOp.getSource();
+  return {(*low)[1], (*low)[2]};
+}
+
+/// Matches an (linalg.fill -> )? linalg.conv_2d_nhwc_hwcf operation sequence
+/// and converts it into a iree_codegen.ukernel.generic "conv2d" operation. The
+/// microkernel gathers input patches itself (implicit im2col), so the input is
+/// passed unchanged, while the filter and the result are packed with the same
+/// tile sizes that data-tiling would use for the equivalent matmul. Returns
+/// the value to replace the conv op with.
+static FailureOr<Value> lowerConv2DToUKernel(RewriterBase &rewriter,
+                                             linalg::Conv2DNhwcHwcfOp op) {
+  Value input = op.getDpsInputOperand(0)->get();
+  Value filter = op.getDpsInputOperand(1)->get();
+  Value out = op.getDpsInitOperand(0)->get();
+  auto filterType = llvm::cast<RankedTensorType>(filter.getType());
+  auto outType = llvm::cast<RankedTensorType>(out.getType());
+  Type inElemType = getElementTypeOrSelf(input.getType());
+  Type filterElemType = filterType.getElementType();
+  Type outElemType = outType.getElementType();
+  uint32_t flags = 0;
+  IREE::LinalgExt::EncodingUser user;
+  if (inElemType.isSignlessInteger(8) && filterElemType.isSignlessInteger(8) &&
+      outElemType.isSignlessInteger(32)) {
+    flags = IREE_UK_FLAG_CONV2D_TYPE_I8I8I32;
+    user = IREE::LinalgExt::EncodingUser::MATMUL_I8I8I32;
+  } else if (inElemType.isF32() && filterElemType.isF32() &&
+             outElemType.isF32()) {
+    flags = IREE_UK_FLAG_CONV2D_TYPE_F32F32F32;
+    user = IREE::LinalgExt::EncodingUser::MATMUL_F32F32F32;
+  } else if (inElemType.isF16() && filterElemType.isF16() &&
+             outElemType.isF32()) {
+    flags = IREE_UK_FLAG_CONV2D_TYPE_F16F16F32;
+    user = IREE::LinalgExt::EncodingUser::MATMUL_F16F16F32;
+  } else if (inElemType.isBF16() && filterElemType.isBF16() &&
+             outElemType.isF32()) {
+    flags = IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32;
+    user = IREE::LinalgExt::EncodingUser::MATMUL_BF16BF16F32;
+  } else {
+    return rewriter.notifyMatchFailure(
+        op, "unsupported combination of element types");
+  }
+  if (!filterType.hasStaticShape()) {
+    return rewriter.notifyMatchFailure(op, "expected a static filter shape");
+  }
+
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
+  MatmulTileParams tileParams = chooseMatmulTileParams(user, targetAttr);
+  if (ShapedType::isDynamic(tileParams.M) ||
+      ShapedType::isDynamic(tileParams.N) ||
+      ShapedType::isDynamic(tileParams.K)) {
+    return rewriter.notifyMatchFailure(op, "expected static tile sizes");
+  }
+
+  auto [paddingTop, paddingLeft] = foldConv2DInputPadding(input);
+  SmallVector<int64_t> strides(op.getStrides().getValues<int64_t>());
+  SmallVector<int64_t> dilations(op.getDilations().getValues<int64_t>());
+
+  // Check if the accumulator is zero-filled.
+  if (isInitializedToZero(out)) {
+    // Not setting flags |= IREE_UK_FLAG_CONV2D_ACCUMULATE, so the conv2d op
+    // won't read the existing accumulator, which then need not be packed.
+    if (auto fillOp = out.getDefiningOp<linalg::FillOp>()) {
+      out = fillOp.getDpsInitOperand(0)->get();
+    }
+  } else {
+    // Tell the conv2d op to read the existing accumulator.
+    flags |= IREE_UK_FLAG_CONV2D_ACCUMULATE;
+  }
+
+  Location loc = op.getLoc();
+  SmallVector<ReassociationIndices> reassociation = {{0, 1, 2}, {3}};
+  SmallVector<int64_t> outerDimsPerm = {1, 0};
+  SmallVector<int64_t> filterInnerDimsPos = {1, 0};
+  SmallVector<int64_t> outInnerDimsPos = {0, 1};
+  SmallVector<OpFoldResult> filterInnerTiles = {
+      rewriter.getIndexAttr(tileParams.N), rewriter.getIndexAttr(tileParams.K)};
+  SmallVector<OpFoldResult> outInnerTiles = {
+      rewriter.getIndexAttr(tileParams.M), rewriter.getIndexAttr(tileParams.N)};
+
+  // Filter: [KH, KW, C, F] -> [KH * KW * C, F] -> [F / N0, K / K0, N0, K0],
+  // the layout of the mmt4d RHS.
+  Value collapsedFilter =
+      rewriter.create<tensor::CollapseShapeOp>(loc, filter, reassociation);
+  SmallVector<OpFoldResult> packedFilterDims = tensor::PackOp::getResultShape(
+      rewriter, loc, tensor::getMixedSizes(rewriter, loc, collapsedFilter),
+      filterInnerTiles, filterInnerDimsPos, outerDimsPerm);
+  Value packedFilterInit = rewriter.create<tensor::EmptyOp>(
+      loc, packedFilterDims, filterElemType);
+  Value filterPaddingVal = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getZeroAttr(filterElemType));
+  Value packedFilter = rewriter.create<tensor::PackOp>(
+      loc, collapsedFilter, packedFilterInit, filterInnerDimsPos,
+      filterInnerTiles, filterPaddingVal, outerDimsPerm);
+
+  // Output: [N, OH, OW, F] -> [N * OH * OW, F] -> [M / M0, F / N0, M0, N0],
+  // the layout of the mmt4d result.
+  Value collapsedOut =
+      rewriter.create<tensor::CollapseShapeOp>(loc, out, reassociation);
+  SmallVector<OpFoldResult> packedOutDims = tensor::PackOp::getResultShape(
+      rewriter, loc, tensor::getMixedSizes(rewriter, loc, collapsedOut),
+      outInnerTiles, outInnerDimsPos, /*outerDimsPerm=*/{});
+  Value packedOut =
+      rewriter.create<tensor::EmptyOp>(loc, packedOutDims, outElemType);
+  if (flags & IREE_UK_FLAG_CONV2D_ACCUMULATE) {
+    Value outPaddingVal = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getZeroAttr(outElemType));
+    packedOut = rewriter.create<tensor::PackOp>(loc, collapsedOut, packedOut,
+                                                outInnerDimsPos, outInnerTiles,
+                                                outPaddingVal);
+  }
+
+  auto getIndex = [&](int64_t value) -> Value {
+    return rewriter.create<arith::ConstantIndexOp>(loc, value);
+  };
+  auto getI32 = [&](int64_t value) -> Value {
+    return rewriter.create<arith::ConstantIntOp>(loc, value, 32);
+  };
+  SmallVector<Value> otherOperands = {
+      rewriter.create<tensor::DimOp>(loc, input, 0),
+      rewriter.create<tensor::DimOp>(loc, input, 1),
+      rewriter.create<tensor::DimOp>(loc, input, 2),
+      rewriter.create<tensor::DimOp>(loc, input, 3),
+      rewriter.create<tensor::DimOp>(loc, out, 1),
+      rewriter.create<tensor::DimOp>(loc, out, 2),
+      rewriter.create<tensor::DimOp>(loc, out, 3),
+      getIndex(filterType.getDimSize(0)),
+      getIndex(filterType.getDimSize(1)),
+      getIndex(strides[0]),
+      getIndex(strides[1]),
+      getIndex(dilations[0]),
+      getIndex(dilations[1]),
+      getIndex(paddingTop),
+      getIndex(paddingLeft),
+      getI32(tileParams.M),
+      getI32(tileParams.N),
+      getI32(tileParams.K),
+      getI32(flags)};
+  auto fn = getFnNameAndDefAttrs("conv2d", rewriter, targetAttr);
+  auto genericMicroKernelOp = rewriter.create<IREE::Codegen::UKernelGenericOp>(
+      loc, packedOut.getType(), fn.name, ValueRange{input, packedFilter},
+      packedOut, otherOperands,
+      /*fn_def_attrs=*/rewriter.getDictionaryAttr(fn.defAttrs),
+      /*strided_outer_dims=*/rewriter.getIndexAttr(1));
+
+  // Unpack the result and restore the original NHWC shape.
+  Value unpackedInit = rewriter.create<tensor::EmptyOp>(
+      loc, tensor::getMixedSizes(rewriter, loc, collapsedOut), outElemType);
+  Value unpacked = rewriter.create<tensor::UnPackOp>(
+      loc, genericMicroKernelOp.getResult(0), unpackedInit, outInnerDimsPos,
+      outInnerTiles);
+  return rewriter
+      .create<tensor::ExpandShapeOp>(loc, outType, unpacked, reassociation)
+      .getResult();
+}
+
 static uint32_t flagForUser(IREE::LinalgExt::EncodingUser user) {
   switch (user) {
   case IREE::LinalgExt::EncodingUser::MATMUL_F32F32F32:
@@ -486,6 +892,68 @@ struct LowerToUKernelPattern : OpRewritePattern<OpType> {
   bool skipIntermediateRoundings;
 };
 
+/// Lowers a linalg.mmt4d op together with its bias-add/clamp consumer to the
+/// mmt4d_fused microkernel. This has a higher benefit than the plain mmt4d
+/// lowering, which would otherwise leave the consumer to rewrite the whole
+/// output tensor in a separate loop nest.
+struct LowerMmt4DWithEpilogueToUKernelPattern
+    : OpRewritePattern<linalg::Mmt4DOp> {
+  LowerMmt4DWithEpilogueToUKernelPattern(MLIRContext *context,
+                                         TargetPredicate targetPredicate,
+                                         bool skipIntermediateRoundings)
+      : OpRewritePattern<linalg::Mmt4DOp>(context, /*benefit=*/2),
+        targetPredicate(targetPredicate),
+        skipIntermediateRoundings(skipIntermediateRoundings) {}
+
+  LogicalResult matchAndRewrite(linalg::Mmt4DOp op,
+                                PatternRewriter &rewriter) const override {
+    if (targetPredicate &&
+        !targetPredicate(IREE::HAL::ExecutableTargetAttr::lookup(op))) {
+      return failure();
+    }
+    FailureOr<Value> replacement = lowerMmt4DWithEpilogueToUKernel(
+        rewriter, op, skipIntermediateRoundings);
+    if (failed(replacement)) {
+      return rewriter.notifyMatchFailure(
+          op, "failed to lower mmt4d and its consumer to a microkernel");
+    }
+    rewriter.replaceOp(*op->user_begin(), replacement.value());
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+  TargetPredicate targetPredicate;
+  bool skipIntermediateRoundings;
+};
+
+/// Unlike the ops handled by LowerToUKernelPattern, the conv2d microkernel
+/// produces a packed result that still needs to be unpacked, so the conv op
+/// is not replaced by the microkernel op itself.
+struct LowerConv2DToUKernelPattern
+    : OpRewritePattern<linalg::Conv2DNhwcHwcfOp> {
+  LowerConv2DToUKernelPattern(MLIRContext *context,
+                              TargetPredicate targetPredicate)
+      : OpRewritePattern<linalg::Conv2DNhwcHwcfOp>(context),
+        targetPredicate(targetPredicate) {}
+
+  LogicalResult matchAndRewrite(linalg::Conv2DNhwcHwcfOp op,
+                                PatternRewriter &rewriter) const override {
+    if (targetPredicate &&
+        !targetPredicate(IREE::HAL::ExecutableTargetAttr::lookup(op))) {
+      return failure();
+    }
+    FailureOr<Value> replacement = lowerConv2DToUKernel(rewriter, op);
+    if (failed(replacement)) {
+      return rewriter.notifyMatchFailure(
+          op, "failed to lower conv2d to a microkernel");
+    }
+    rewriter.replaceOp(op, replacement.value());
+    return success();
+  }
+
+  TargetPredicate targetPredicate;
+};
+
 } // namespace
 
 void LLVMCPULowerToUKernelsPass::runOnOperation() {
@@ -506,6 +974,13 @@ void LLVMCPULowerToUKernelsPass::runOnOperation() {
   auto allTargets = [](auto target) { return true; };
   patterns.insert<LowerToUKernelPattern<linalg::Mmt4DOp>>(
       context, allTargets, skipIntermediateRoundings);
+  // The mmt4d_fused microkernel is not exposed as a VMVX import.
+  patterns.insert<LowerMmt4DWithEpilogueToUKernelPattern>(
+      context, [](auto target) { return !isVMVXBackend(target); },
+      skipIntermediateRoundings);
+  // The conv2d microkernel avoids materializing the im2col'd input, which is
+  // what makes convolutions worth lowering to a microkernel.
+  patterns.insert<LowerConv2DToUKernelPattern>(context, allTargets);
   // These patterns could in principle be used on LLVMCPU, not just VMVX, but
   // we choose not to, for two reasons:
   // 1. Codegen for these ops is thought to be good enough, that we do not
@@ -609,6 +609,9 @@ void addMmt4dTilingExpertPassPipeline(OpPassManager &passManager,
   if (enableMicrokernels) {
     nestedModulePM.addPass(
         createLLVMCPULowerToUKernelsPass(clSkipIntermediateRoundings));
+    // The conv2d microkernel lowering packs the filter and unpacks the result.
+    nestedModulePM.addNestedPass<func::FuncOp>(
+        createDecomposePackUnPackOpsPass());
   } else {
     nestedModulePM.addNestedPass<func::FuncOp>(createLLVMCPUTileAndFusePass(
         static_cast<int64_t>(tilingConfig.getVectorCommonParallelLevel())));
@@ -94,6 +94,70 @@ func.func @mmt4d_i8i8i32(%arg0 : tensor<?x?x?x?xi8>, %arg1 : tensor<?x?x?x?xi8>,
 
 // -----
 
+func.func @mmt4d_i8i4i32(%arg0 : tensor<?x?x?x?xi8>, %arg1 : tensor<?x?x?x?xi4>,
+    %arg2 : tensor<?x?x?x?xi32>) -> tensor<?x?x?x?xi32> {
+  %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xi8>, tensor<?x?x?x?xi4>)
+      outs(%arg2 : tensor<?x?x?x?xi32>) -> tensor<?x?x?x?xi32>
+  return %0 : tensor<?x?x?x?xi32>
+}
+//      CHECK: func @mmt4d_i8i4i32(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi8>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi4>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi32>
+//  CHECK-DAG:   %[[C0:.+]] = arith.constant 0
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1
+//  CHECK-DAG:   %[[C2:.+]] = arith.constant 2
+//  CHECK-DAG:   %[[C3:.+]] = arith.constant 3
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 1287 : i32
+//  CHECK-DAG:   %[[M:.+]] = tensor.dim %[[ARG0]], %[[C0]]
+//  CHECK-DAG:   %[[N:.+]] = tensor.dim %[[ARG1]], %[[C0]]
+//  CHECK-DAG:   %[[K:.+]] = tensor.dim %[[ARG1]], %[[C1]]
+//  CHECK-DAG:   %[[M0_index:.+]] = tensor.dim %[[ARG0]], %[[C2]]
+//  CHECK-DAG:   %[[M0:.+]] = arith.index_cast %[[M0_index]] : index to i32
+//  CHECK-DAG:   %[[N0_index:.+]] = tensor.dim %[[ARG1]], %[[C2]]
+//  CHECK-DAG:   %[[N0:.+]] = arith.index_cast %[[N0_index]] : index to i32
+//  CHECK-DAG:   %[[K0_index:.+]] = tensor.dim %[[ARG1]], %[[C3]]
+//  CHECK-DAG:   %[[K0:.+]] = arith.index_cast %[[K0_index]] : index to i32
+//      CHECK:   %[[MICRO_KERNEL:.+]] = iree_codegen.ukernel.generic "iree_uk_mmt4d"
+// CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]] :
+// CHECK-SAME:       outs(%[[ARG2]] :
+// CHECK-SAME:       (%[[M]], %[[N]], %[[K]], %[[M0]], %[[N0]], %[[K0]], %[[FLAGS]] :
+//      CHECK:   return %[[MICRO_KERNEL]]
+
+// -----
+
+func.func @mmt4d_f32i4f32(%arg0 : tensor<?x?x?x?xf32>, %arg1 : tensor<?x?x?x?xi4>,
+    %arg2 : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32> {
+  %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xf32>, tensor<?x?x?x?xi4>)
+      outs(%arg2 : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32>
+  return %0 : tensor<?x?x?x?xf32>
+}
+//      CHECK: func @mmt4d_f32i4f32(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<?x?x?x?xf32>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi4>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<?x?x?x?xf32>
+//  CHECK-DAG:   %[[C0:.+]] = arith.constant 0
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1
+//  CHECK-DAG:   %[[C2:.+]] = arith.constant 2
+//  CHECK-DAG:   %[[C3:.+]] = arith.constant 3
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 1288 : i32
+//  CHECK-DAG:   %[[M:.+]] = tensor.dim %[[ARG0]], %[[C0]]
+//  CHECK-DAG:   %[[N:.+]] = tensor.dim %[[ARG1]], %[[C0]]
+//  CHECK-DAG:   %[[K:.+]] = tensor.dim %[[ARG1]], %[[C1]]
+//  CHECK-DAG:   %[[M0_index:.+]] = tensor.dim %[[ARG0]], %[[C2]]
+//  CHECK-DAG:   %[[M0:.+]] = arith.index_cast %[[M0_index]] : index to i32
+//  CHECK-DAG:   %[[N0_index:.+]] = tensor.dim %[[ARG1]], %[[C2]]
+//  CHECK-DAG:   %[[N0:.+]] = arith.index_cast %[[N0_index]] : index to i32
+//  CHECK-DAG:   %[[K0_index:.+]] = tensor.dim %[[ARG1]], %[[C3]]
+//  CHECK-DAG:   %[[K0:.+]] = arith.index_cast %[[K0_index]] : index to i32
+//      CHECK:   %[[MICRO_KERNEL:.+]] = iree_codegen.ukernel.generic "iree_uk_mmt4d"
+// CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]] :
+// CHECK-SAME:       outs(%[[ARG2]] :
+// CHECK-SAME:       (%[[M]], %[[N]], %[[K]], %[[M0]], %[[N0]], %[[K0]], %[[FLAGS]] :
+//      CHECK:   return %[[MICRO_KERNEL]]
+
+// -----
+
 func.func @mmt4d_f16f16f32(%arg0 : tensor<?x?x?x?xf16>, %arg1 : tensor<?x?x?x?xf16>,
     %arg2 : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32> {
   %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xf16>, tensor<?x?x?x?xf16>)
@@ -246,6 +310,118 @@ func.func @mmt4d_bf16bf16bf16(%arg0 : tensor<?x?x?x?xbf16>, %arg1 : tensor<?x?x?
 
 // -----
 
+func.func @mmt4d_fused_f32f32f32_bias_per_column_relu(%arg0 : tensor<?x?x?x?xf32>, %arg1 : tensor<?x?x?x?xf32>,
+    %arg2 : tensor<?x?x?x?xf32>, %arg3 : tensor<?x?xf32>) -> tensor<?x?x?x?xf32> {
+  %zero = arith.constant 0.0 : f32
+  %fill = linalg.fill ins(%zero : f32) outs(%arg2 : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32>
+  %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xf32>, tensor<?x?x?x?xf32>)
+      outs(%fill : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32>
+  %1 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d1, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>],
+      iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%0, %arg3 : tensor<?x?x?x?xf32>, tensor<?x?xf32>)
+      outs(%arg2 : tensor<?x?x?x?xf32>) {
+  ^bb0(%in: f32, %bias: f32, %out: f32):
+    %2 = arith.addf %in, %bias : f32
+    %3 = arith.maxf %2, %zero : f32
+    linalg.yield %3 : f32
+  } -> tensor<?x?x?x?xf32>
+  return %1 : tensor<?x?x?x?xf32>
+}
+//      CHECK: func @mmt4d_fused_f32f32f32_bias_per_column_relu(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<?x?x?x?xf32>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<?x?x?x?xf32>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<?x?x?x?xf32>
+// CHECK-SAME:     %[[ARG3:[a-zA-Z0-9]+]]: tensor<?x?xf32>
+//  CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//  CHECK-DAG:   %[[C2:.+]] = arith.constant 2 : index
+//  CHECK-DAG:   %[[C3:.+]] = arith.constant 3 : index
+//  CHECK-DAG:   %[[SCALE:.+]] = arith.constant 1.000000e+00 : f32
+//  CHECK-DAG:   %[[ZP:.+]] = arith.constant 0 : i32
+//  CHECK-DAG:   %[[CLAMP_MIN:.+]] = arith.constant 0.000000e+00 : f32
+//  CHECK-DAG:   %[[CLAMP_MAX:.+]] = arith.constant 0x7F800000 : f32
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 41985 : i32
+//  CHECK-DAG:   %[[M:.+]] = tensor.dim %[[ARG0]], %[[C0]]
+//  CHECK-DAG:   %[[N:.+]] = tensor.dim %[[ARG1]], %[[C0]]
+//  CHECK-DAG:   %[[K:.+]] = tensor.dim %[[ARG1]], %[[C1]]
+//  CHECK-DAG:   %[[M0_index:.+]] = tensor.dim %[[ARG0]], %[[C2]]
+//  CHECK-DAG:   %[[M0:.+]] = arith.index_cast %[[M0_index]] : index to i32
+//  CHECK-DAG:   %[[N0_index:.+]] = tensor.dim %[[ARG1]], %[[C2]]
+//  CHECK-DAG:   %[[N0:.+]] = arith.index_cast %[[N0_index]] : index to i32
+//  CHECK-DAG:   %[[K0_index:.+]] = tensor.dim %[[ARG1]], %[[C3]]
+//  CHECK-DAG:   %[[K0:.+]] = arith.index_cast %[[K0_index]] : index to i32
+//      CHECK:   %[[MICRO_KERNEL:.+]] = iree_codegen.ukernel.generic "iree_uk_mmt4d_fused"
+// CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]], %[[ARG3]] :
+// CHECK-SAME:       outs(%[[ARG2]] :
+// CHECK-SAME:       (%[[M]], %[[N]], %[[K]], %[[M0]], %[[N0]], %[[K0]], %[[SCALE]], %[[ZP]], %[[CLAMP_MIN]], %[[CLAMP_MAX]], %[[FLAGS]] :
+//  CHECK-NOT:   linalg.generic
+//      CHECK:   return %[[MICRO_KERNEL]]
+
+// -----
+
+func.func @mmt4d_fused_i8i8i32_bias_per_row_accumulate(%arg0 : tensor<?x?x?x?xi8>, %arg1 : tensor<?x?x?x?xi8>,
+    %arg2 : tensor<?x?x?x?xi32>, %arg3 : tensor<?x?xi32>) -> tensor<?x?x?x?xi32> {
+  %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xi8>, tensor<?x?x?x?xi8>)
+      outs(%arg2 : tensor<?x?x?x?xi32>) -> tensor<?x?x?x?xi32>
+  %1 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d0, d2)>,
+                       affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>],
+      iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%0, %arg3 : tensor<?x?x?x?xi32>, tensor<?x?xi32>)
+      outs(%arg2 : tensor<?x?x?x?xi32>) {
+  ^bb0(%in: i32, %bias: i32, %out: i32):
+    %2 = arith.addi %bias, %in : i32
+    linalg.yield %2 : i32
+  } -> tensor<?x?x?x?xi32>
+  return %1 : tensor<?x?x?x?xi32>
+}
+//      CHECK: func @mmt4d_fused_i8i8i32_bias_per_row_accumulate(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi8>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi8>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<?x?x?x?xi32>
+// CHECK-SAME:     %[[ARG3:[a-zA-Z0-9]+]]: tensor<?x?xi32>
+//  CHECK-DAG:   %[[CLAMP_MIN:.+]] = arith.constant 0xFF800000 : f32
+//  CHECK-DAG:   %[[CLAMP_MAX:.+]] = arith.constant 0x7F800000 : f32
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 5378 : i32
+//      CHECK:   %[[MICRO_KERNEL:.+]] = iree_codegen.ukernel.generic "iree_uk_mmt4d_fused"
+// CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]], %[[ARG3]] :
+// CHECK-SAME:       outs(%[[ARG2]] :
+// CHECK-SAME:       %[[CLAMP_MIN]], %[[CLAMP_MAX]], %[[FLAGS]] :
+//      CHECK:   return %[[MICRO_KERNEL]]
+
+// -----
+
+// Check that a consumer clamping before adding the bias is not fused, as the
+// microkernel applies the bias first.
+func.func @mmt4d_fused_clamp_before_bias(%arg0 : tensor<?x?x?x?xf32>, %arg1 : tensor<?x?x?x?xf32>,
+    %arg2 : tensor<?x?x?x?xf32>, %arg3 : tensor<?x?xf32>) -> tensor<?x?x?x?xf32> {
+  %zero = arith.constant 0.0 : f32
+  %0 = linalg.mmt4d ins(%arg0, %arg1 : tensor<?x?x?x?xf32>, tensor<?x?x?x?xf32>)
+      outs(%arg2 : tensor<?x?x?x?xf32>) -> tensor<?x?x?x?xf32>
+  %1 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d1, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>],
+      iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%0, %arg3 : tensor<?x?x?x?xf32>, tensor<?x?xf32>)
+      outs(%arg2 : tensor<?x?x?x?xf32>) {
+  ^bb0(%in: f32, %bias: f32, %out: f32):
+    %2 = arith.maxf %in, %zero : f32
+    %3 = arith.addf %2, %bias : f32
+    linalg.yield %3 : f32
+  } -> tensor<?x?x?x?xf32>
+  return %1 : tensor<?x?x?x?xf32>
+}
+//      CHECK: func @mmt4d_fused_clamp_before_bias(
+//      CHECK:   iree_codegen.ukernel.generic "iree_uk_mmt4d"
+//      CHECK:   linalg.generic
+
+// -----
+
 // Check that tensor.pack is not lowered to a microkernel by default - it should
 // only be on VMVX.
 //      CHECK: func @pack_i8i8_default(
@@ -503,3 +679,72 @@ func.func @query_tile_sizes_2d() -> (index, index)  attributes {
   %result:2 = iree_codegen.query_tile_sizes tensor<?x?xf32, #iree_linalg_ext.encoding<user=MATMUL_F32F32F32, role=RESULT>> -> index, index
   return %result#0, %result#1 : index, index
 }
+
+// -----
+
+//      CHECK: func @conv_2d_nhwc_hwcf_f32f32f32(
+// CHECK-SAME:     %[[INPUT:[a-zA-Z0-9]+]]: tensor<1x16x16x4xf32>
+// CHECK-SAME:     %[[FILTER:[a-zA-Z0-9]+]]: tensor<3x3x4x16xf32>
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 1 : i32
+//  CHECK-DAG:   %[[M0:.+]] = arith.constant 8 : i32
+//  CHECK-DAG:   %[[K0:.+]] = arith.constant 1 : i32
+//      CHECK:   %[[COLLAPSED_FILTER:.+]] = tensor.collapse_shape %[[FILTER]] {{\[}}[0, 1, 2], [3]]
+//      CHECK:   %[[PACKED_FILTER:.+]] = tensor.pack %[[COLLAPSED_FILTER]]
+// CHECK-SAME:       outer_dims_perm = [1, 0] inner_dims_pos = [1, 0] inner_tiles = [8, 1]
+// CHECK-SAME:       -> tensor<2x36x8x1xf32>
+//      CHECK:   %[[PACKED_OUT:.+]] = tensor.empty() : tensor<25x2x8x8xf32>
+//      CHECK:   %[[MICRO_KERNEL:.+]] = iree_codegen.ukernel.generic "iree_uk_conv2d"
+// CHECK-SAME:       ins(%[[INPUT]], %[[PACKED_FILTER]] :
+// CHECK-SAME:       outs(%[[PACKED_OUT]] :
+// CHECK-SAME:       %[[M0]], %[[M0]], %[[K0]], %[[FLAGS]] :
+// CHECK-SAME:       strided_outer_dims(1)
+//      CHECK:   %[[UNPACKED:.+]] = tensor.unpack %[[MICRO_KERNEL]]
+// CHECK-SAME:       inner_dims_pos = [0, 1] inner_tiles = [8, 8]
+// CHECK-SAME:       -> tensor<196x16xf32>
+//      CHECK:   %[[RESULT:.+]] = tensor.expand_shape %[[UNPACKED]] {{\[}}[0, 1, 2], [3]]
+//      CHECK:   return %[[RESULT]]
+func.func @conv_2d_nhwc_hwcf_f32f32f32(%arg0 : tensor<1x16x16x4xf32>, %arg1 : tensor<3x3x4x16xf32>) -> tensor<1x14x14x16xf32> attributes {
+  hal.executable.target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx,+avx2,+fma", target_triple = "x86_64-xyz-xyz", ukernels = true}>
+} {
+  %cst = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<1x14x14x16xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<1x14x14x16xf32>) -> tensor<1x14x14x16xf32>
+  %2 = linalg.conv_2d_nhwc_hwcf {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%arg0, %arg1 : tensor<1x16x16x4xf32>, tensor<3x3x4x16xf32>)
+      outs(%1 : tensor<1x14x14x16xf32>) -> tensor<1x14x14x16xf32>
+  func.return %2 : tensor<1x14x14x16xf32>
+}
+
+// -----
+
+//      CHECK: func @conv_2d_nhwc_hwcf_i8i8i32_padded_accumulate(
+// CHECK-SAME:     %[[INPUT:[a-zA-Z0-9]+]]: tensor<2x7x7x8xi8>
+// CHECK-SAME:     %[[FILTER:[a-zA-Z0-9]+]]: tensor<3x3x8x16xi8>
+// CHECK-SAME:     %[[OUT:[a-zA-Z0-9]+]]: tensor<2x4x4x16xi32>
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//  CHECK-DAG:   %[[C2:.+]] = arith.constant 2 : index
+//  CHECK-DAG:   %[[FLAGS:.+]] = arith.constant 258 : i32
+//      CHECK:   %[[PACKED_FILTER:.+]] = tensor.pack
+// CHECK-SAME:       -> tensor<2x36x8x2xi8>
+//      CHECK:   %[[COLLAPSED_OUT:.+]] = tensor.collapse_shape %[[OUT]] {{\[}}[0, 1, 2], [3]]
+//      CHECK:   %[[PACKED_OUT:.+]] = tensor.pack %[[COLLAPSED_OUT]]
+// CHECK-SAME:       inner_dims_pos = [0, 1] inner_tiles = [8, 8]
+// CHECK-SAME:       -> tensor<4x2x8x8xi32>
+//      CHECK:   iree_codegen.ukernel.generic "iree_uk_conv2d"
+// CHECK-SAME:       ins(%[[INPUT]], %[[PACKED_FILTER]] :
+// CHECK-SAME:       outs(%[[PACKED_OUT]] :
+// CHECK-SAME:       %[[C2]], %[[C2]], %[[C1]], %[[C1]], %[[C1]], %[[C1]]
+// CHECK-SAME:       %[[FLAGS]] :
+func.func @conv_2d_nhwc_hwcf_i8i8i32_padded_accumulate(%arg0 : tensor<2x7x7x8xi8>, %arg1 : tensor<3x3x8x16xi8>, %arg2 : tensor<2x4x4x16xi32>) -> tensor<2x4x4x16xi32> attributes {
+  hal.executable.target = #hal.executable.target<"llvm-cpu", "xyz", {cpu_features = "+avx,+avx2,+fma", target_triple = "x86_64-xyz-xyz", ukernels = true}>
+} {
+  %c0_i8 = arith.constant 0 : i8
+  %padded = tensor.pad %arg0 low[0, 1, 1, 0] high[0, 1, 1, 0] {
+  ^bb0(%b0 : index, %b1 : index, %b2 : index, %b3 : index):
+    tensor.yield %c0_i8 : i8
+  } : tensor<2x7x7x8xi8> to tensor<2x9x9x8xi8>
+  %0 = linalg.conv_2d_nhwc_hwcf {dilations = dense<1> : tensor<2xi64>, strides = dense<2> : tensor<2xi64>}
+      ins(%padded, %arg1 : tensor<2x9x9x8xi8>, tensor<3x3x8x16xi8>)
+      outs(%arg2 : tensor<2x4x4x16xi32>) -> tensor<2x4x4x16xi32>
+  func.return %0 : tensor<2x4x4x16xi32>
+}
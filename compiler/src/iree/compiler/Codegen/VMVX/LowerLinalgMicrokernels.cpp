@@ -521,6 +521,18 @@ struct CopyEmitter {
   }
 };
 
+// Returns true if |type| is a float type with elementwise kernels: f32 and the
+// 16-bit f16 and bf16.
+bool isElementwiseFloatType(Type type) {
+  return type.isF32() || type.isF16() || type.isBF16();
+}
+
+// Returns true if |type| is an integer type with elementwise kernels: i32 and
+// i8.
+bool isElementwiseIntegerType(Type type) {
+  return type.isInteger(32) || type.isInteger(8);
+}
+
 /// Matches a generic which contains an expressible binary operation, emitting
 /// as a vmvx op.
 struct LinalgBinaryGenericConversion
@@ -596,92 +608,92 @@ struct LinalgBinaryGenericConversion
     };
 
     // Select the op to lower to and configure the emitter.
-    // Emit from the iree_ukernel_x32b_opcode_t table.
+    // Emit from the iree_uk_x{32,16,8}b_opcode_t tables.
     Type resultType = binaryOp->getResult(0).getType();
     if (!resultType.isIntOrFloat())
       return failure();
     std::optional<BinaryEmitter> emitter =
         TypeSwitch<Operation *, std::optional<BinaryEmitter>>(binaryOp)
             .Case([&](arith::AddFOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericBinary(op, "add");
               }
               return std::nullopt;
             })
             .Case([&](arith::AddIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "add");
               }
               return std::nullopt;
             })
             .Case([&](arith::AndIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "and");
               }
               return std::nullopt;
             })
             .Case([&](arith::DivFOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericBinary(op, "div");
               }
               return std::nullopt;
             })
             .Case([&](arith::DivSIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "divs");
               }
               return std::nullopt;
             })
             .Case([&](arith::DivUIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "divu");
               }
               return std::nullopt;
             })
             .Case([&](arith::MulFOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericBinary(op, "mul");
               }
               return std::nullopt;
             })
             .Case([&](arith::MulIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "mul");
               }
               return std::nullopt;
             })
             .Case([&](arith::OrIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "or");
               }
               return std::nullopt;
             })
             .Case([&](arith::ShLIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "shl");
               }
               return std::nullopt;
             })
             .Case([&](arith::ShRSIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "shrs");
               }
               return std::nullopt;
             })
             .Case([&](arith::XOrIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "xor");
               }
               return std::nullopt;
             })
             .Case([&](arith::SubFOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericBinary(op, "sub");
               }
               return std::nullopt;
             })
             .Case([&](arith::SubIOp op) -> std::optional<BinaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericBinary(op, "sub");
               }
               return std::nullopt;
@@ -754,57 +766,57 @@ struct LinalgUnaryGenericConversion
     };
 
     // Select the op to lower to and configure the emitter.
-    // Emit from the iree_ukernel_x32b_opcode_t table.
+    // Emit from the iree_uk_x{32,16,8}u_opcode_t tables.
     Type resultType = unaryOp->getResult(0).getType();
     if (!resultType.isIntOrFloat())
       return failure();
     std::optional<UnaryEmitter> emitter =
         TypeSwitch<Operation *, std::optional<UnaryEmitter>>(unaryOp)
             .Case([&](math::AbsFOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "abs");
               }
               return std::nullopt;
             })
             .Case([&](math::CeilOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "ceil");
               }
               return std::nullopt;
             })
             .Case([&](math::CountLeadingZerosOp op)
                       -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseIntegerType(resultType)) {
                 return configureGenericUnary(op, "ctlz");
               }
               return std::nullopt;
             })
             .Case([&](math::ExpOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "exp");
               }
               return std::nullopt;
             })
             .Case([&](math::FloorOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "floor");
               }
               return std::nullopt;
             })
             .Case([&](math::LogOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "log");
               }
               return std::nullopt;
             })
             .Case([&](arith::NegFOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "neg");
               }
               return std::nullopt;
             })
             .Case([&](math::RsqrtOp op) -> std::optional<UnaryEmitter> {
-              if (resultType.getIntOrFloatBitWidth() == 32) {
+              if (isElementwiseFloatType(resultType)) {
                 return configureGenericUnary(op, "rsqrt");
               }
               return std::nullopt;
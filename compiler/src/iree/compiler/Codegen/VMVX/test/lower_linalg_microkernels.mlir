@@ -256,6 +256,43 @@ func.func @subf(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
   func.return
 }
 
+// 16-bit float and 8-bit integer variants.
+// CHECK-LABEL: @addf_f16
+// CHECK: vmvx.binary op("add" : f16)
+func.func @addf_f16(%arg0 : memref<64x64xf16>, %arg1 : memref<64xf16>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf16>) outs(%arg0 : memref<64x64xf16>) {
+  ^bb0(%arg2: f16, %arg3: f16):
+    %12 = arith.addf %arg2, %arg3 : f16
+    linalg.yield %12 : f16
+  }
+  func.return
+}
+
+// CHECK-LABEL: @mulf_bf16
+// CHECK: vmvx.binary op("mul" : bf16)
+func.func @mulf_bf16(%arg0 : memref<64x64xbf16>, %arg1 : memref<64xbf16>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xbf16>) outs(%arg0 : memref<64x64xbf16>) {
+  ^bb0(%arg2: bf16, %arg3: bf16):
+    %12 = arith.mulf %arg2, %arg3 : bf16
+    linalg.yield %12 : bf16
+  }
+  func.return
+}
+
+// CHECK-LABEL: @addi_i8
+// CHECK: vmvx.binary op("add" : i8)
+func.func @addi_i8(%arg0 : memref<64x64xi8>, %arg1 : memref<64xi8>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xi8>) outs(%arg0 : memref<64x64xi8>) {
+  ^bb0(%arg2: i8, %arg3: i8):
+    %12 = arith.addi %arg2, %arg3 : i8
+    linalg.yield %12 : i8
+  }
+  func.return
+}
+
 // Unary ops.
 // CHECK-LABEL: @absf
 // CHECK: vmvx.unary op("abs" : f32)
@@ -340,3 +377,39 @@ func.func @rsqrt(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
   }
   func.return
 }
+
+// CHECK-LABEL: @absf_f16
+// CHECK: vmvx.unary op("abs" : f16)
+func.func @absf_f16(%arg0 : memref<64x64xf16>, %arg1 : memref<64xf16>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf16>) outs(%arg0 : memref<64x64xf16>) {
+  ^bb0(%arg2: f16, %arg3: f16):
+    %12 = math.absf %arg2 : f16
+    linalg.yield %12 : f16
+  }
+  func.return
+}
+
+// CHECK-LABEL: @floorf_bf16
+// CHECK: vmvx.unary op("floor" : bf16)
+func.func @floorf_bf16(%arg0 : memref<64x64xbf16>, %arg1 : memref<64xbf16>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xbf16>) outs(%arg0 : memref<64x64xbf16>) {
+  ^bb0(%arg2: bf16, %arg3: bf16):
+    %12 = math.floor %arg2 : bf16
+    linalg.yield %12 : bf16
+  }
+  func.return
+}
+
+// CHECK-LABEL: @ctlz_i8
+// CHECK: vmvx.unary op("ctlz" : i8)
+func.func @ctlz_i8(%arg0 : memref<64x64xi8>, %arg1 : memref<64xi8>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xi8>) outs(%arg0 : memref<64x64xi8>) {
+  ^bb0(%arg2: i8, %arg3: i8):
+    %12 = math.ctlz %arg2 : i8
+    linalg.yield %12 : i8
+  }
+  func.return
+}
@@ -113,6 +113,9 @@ struct Statistics {
   size_t submissionCount = 0;
   int64_t transientSize = 0;
   bool transientSizeDynamic = false;
+  // Sum of the lower bounds of packed transient allocations as recorded by
+  // LayoutSlices. Allocations without a bound contribute their full size.
+  int64_t transientLowerBound = 0;
   // TODO(benvanik): add fill/copy sizes (when possible).
   size_t fillCount = 0;
   size_t copyCount = 0;
@@ -159,6 +162,12 @@ struct Statistics {
       APInt allocaSize;
       if (matchPattern(allocaOp.getStorageSize(), m_ConstantInt(&allocaSize))) {
         transientSize += allocaSize.getSExtValue();
+        if (auto lowerBoundAttr = allocaOp->getAttrOfType<IntegerAttr>(
+                "stream.pack.lower_bound")) {
+          transientLowerBound += lowerBoundAttr.getInt();
+        } else {
+          transientLowerBound += allocaSize.getSExtValue();
+        }
       } else {
         transientSizeDynamic = true;
       }
@@ -245,6 +254,15 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv(
       "{0}{1} B ({2:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
       stats.transientSize, stats.transientSize / (1 * 1024 * 1024.0f));
+  os << llvm::formatv(
+      "//  Transients: lower bound {0} B ({1:F2} MiB), {2:F2}% packing "
+      "overhead\n",
+      stats.transientLowerBound,
+      stats.transientLowerBound / (1 * 1024 * 1024.0f),
+      stats.transientLowerBound
+          ? (stats.transientSize - stats.transientLowerBound) * 100.0f /
+                stats.transientLowerBound
+          : 0.0f);
 
   os << llvm::formatv("//   DMA Fills: {0}\n", stats.fillCount);
   os << llvm::formatv("//  DMA Copies: {0}\n", stats.copyCount);
@@ -404,7 +422,7 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   Statistics stats;
   stats.analyze(usageInfo);
 
-  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables")";
+  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Lower Bound","Fills","Copies","Dispatches","Async Calls","Executables")";
   os << "\n";
 
   // Globals:
@@ -416,9 +434,10 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   os << llvm::formatv("{0},", stats.awaitCount);
 
   // Execution:
-  os << llvm::formatv("{0},{1},{2},{3},{4},{5},", stats.submissionCount,
-                      stats.transientSize, stats.fillCount, stats.copyCount,
-                      stats.dispatchCount, stats.callCount);
+  os << llvm::formatv("{0},{1},{2},{3},{4},{5},{6},", stats.submissionCount,
+                      stats.transientSize, stats.transientLowerBound,
+                      stats.fillCount, stats.copyCount, stats.dispatchCount,
+                      stats.callCount);
 
   // Executables:
   os << llvm::formatv("{0}", stats.executableCount);
@@ -539,6 +558,8 @@ static void dumpAggregateJSONStructure(const UsageInfo &usageInfo,
   os << "  \"execution\": {\n";
   os << llvm::formatv(kvPair, "submission-count", stats.submissionCount);
   os << llvm::formatv(kvPair, "transient-memory-size", stats.transientSize);
+  os << llvm::formatv(kvPair, "transient-memory-lower-bound",
+                      stats.transientLowerBound);
   os << llvm::formatv(kvPair, "fill-count", stats.fillCount);
   os << llvm::formatv(kvPair, "copy-count", stats.copyCount);
   os << llvm::formatv(kvPair, "dispatch-count", stats.dispatchCount);
@@ -4,7 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include <list>
+#include <numeric>
+#include <tuple>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -64,94 +65,313 @@ packSlicesWithNoAliasing(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
   return builder.createOrFold<IREE::Util::AlignOp>(loc, offset, rangeAlignment);
 }
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// Lifetime and range-aligned size of a statically-sized slice.
+struct StaticSlice {
+  int64_t lifetimeStart = 0;
+  int64_t lifetimeEnd = 0;
+  int64_t size = 0;
+  // Slices with intersecting lifetimes may not alias.
+  bool intersects(const StaticSlice &rhs) const {
+    return lifetimeEnd >= rhs.lifetimeStart &&
+           rhs.lifetimeEnd >= lifetimeStart;
+  }
+};
+
+// Offsets of a set of static slices within a packed allocation.
+struct StaticPacking {
+  static constexpr int64_t UNASSIGNED = INT64_MAX;
+  // Offset of each slice or UNASSIGNED if the slice has not been placed.
+  SmallVector<int64_t> offsets;
+  // Highwater mark of all placed slices.
+  int64_t size = 0;
+};
+
+// How a slice is placed among those already packed that it may not alias.
+enum class SliceFit {
+  // Placed in the smallest gap it fits in to reduce fragmentation.
+  Best,
+  // Placed at the lowest offset it fits at.
+  First,
+};
+
+// Returns the total size of the slices live at each point in time a slice
+// becomes live as (time, size) pairs in ascending time order. The largest of
+// these is a lower bound on the packed size of the slices.
+static SmallVector<std::pair<int64_t, int64_t>>
+computeLiveSizeProfile(ArrayRef<StaticSlice> slices) {
+  // Slices stop being live the step after their lifetime ends and removals
+  // sort before additions at the same time.
+  SmallVector<std::pair<int64_t, int64_t>> events;
+  events.reserve(slices.size() * 2);
+  for (auto &slice : slices) {
+    events.push_back({slice.lifetimeStart, slice.size});
+    events.push_back({slice.lifetimeEnd + 1, -slice.size});
+  }
+  llvm::sort(events);
+  SmallVector<std::pair<int64_t, int64_t>> profile;
+  int64_t liveSize = 0;
+  for (unsigned i = 0; i < events.size(); ++i) {
+    liveSize += events[i].second;
+    bool isLastAtTime =
+        i + 1 == events.size() || events[i + 1].first != events[i].first;
+    if (isLastAtTime && events[i].second > 0) {
+      profile.push_back({events[i].first, liveSize});
+    }
+  }
+  return profile;
+}
+
+// Returns the offset at which |sliceIndex| can be placed without overlapping
+// any placed slice with an intersecting lifetime.
+static int64_t findSliceOffset(unsigned sliceIndex,
+                               ArrayRef<StaticSlice> slices,
+                               ArrayRef<int64_t> offsets,
+                               int64_t offsetAlignment, SliceFit fit) {
+  // Iterate through the placed intersecting slices by ascending offset and
+  // identify gaps in which the slice will fit.
+  SmallVector<unsigned> placedSlices;
+  for (unsigned i = 0; i < slices.size(); ++i) {
+    if (offsets[i] != StaticPacking::UNASSIGNED &&
+        slices[i].intersects(slices[sliceIndex])) {
+      placedSlices.push_back(i);
+    }
+  }
+  llvm::sort(placedSlices, [&](unsigned lhs, unsigned rhs) {
+    return std::make_pair(offsets[lhs], lhs) <
+           std::make_pair(offsets[rhs], rhs);
+  });
+  int64_t size = slices[sliceIndex].size;
+  int64_t bestOffset = StaticPacking::UNASSIGNED;
+  int64_t bestOffsetFit = INT64_MAX;
+  int64_t currentOffset = 0;
+  for (unsigned i : placedSlices) {
+    // If we found a gap >= the required size and smaller than the previous
+    // best fit take it.
+    int64_t alignedOffset = IREE::Util::align(currentOffset, offsetAlignment);
+    if (alignedOffset + size <= offsets[i]) {
+      if (fit == SliceFit::First) {
+        return alignedOffset;
+      }
+      if (offsets[i] - alignedOffset < bestOffsetFit) {
+        bestOffset = alignedOffset;
+        bestOffsetFit = offsets[i] - currentOffset;
+      }
+    }
+    currentOffset = std::max(currentOffset, offsets[i] + slices[i].size);
+  }
+  if (bestOffset == StaticPacking::UNASSIGNED) {
+    bestOffset = IREE::Util::align(currentOffset, offsetAlignment);
+  }
+  return bestOffset;
+}
+
+// Packs slices one at a time in the given |order|.
 //
-// This is the same algorithm used in tflite here:
+// With SliceFit::Best and slices in lifetime order this is the greedy strip
+// packing algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
-// It's not fantastic and can end up with a significant amount of wastage.
-// They do the packing at runtime and as such care more about performance than
-// we do while doing the packing here offline. For this initial version I
-// wanted to ensure we matched apples/apples their implementation.
+static StaticPacking
+packSlicesInOrder(ArrayRef<StaticSlice> slices, ArrayRef<unsigned> order,
+                  int64_t offsetAlignment, SliceFit fit) {
+  StaticPacking packing;
+  packing.offsets.resize(slices.size(), StaticPacking::UNASSIGNED);
+  for (unsigned i : order) {
+    int64_t offset =
+        findSliceOffset(i, slices, packing.offsets, offsetAlignment, fit);
+    packing.offsets[i] = offset;
+    packing.size = std::max(packing.size, offset + slices[i].size);
+  }
+  return packing;
+}
+
+// Maximum number of slices packed by packSlicesByLowestOffset. Each placement
+// may recompute the candidate offsets of all intersecting slices, making the
+// packing cubic in the worst case.
+static constexpr unsigned kMaxLowestOffsetSliceCount = 128;
+
+// Packs slices by repeatedly placing whichever remaining slice fits at the
+// lowest offset, preferring larger and then longer-lived slices. Only the
+// slices intersecting a newly placed slice whose candidate range it overlaps
+// need their offsets updated: placing a slice never opens up a lower offset.
+static StaticPacking packSlicesByLowestOffset(ArrayRef<StaticSlice> slices,
+                                              int64_t offsetAlignment) {
+  StaticPacking packing;
+  packing.offsets.resize(slices.size(), StaticPacking::UNASSIGNED);
+  SmallVector<int64_t> candidateOffsets(slices.size(), 0);
+  SmallVector<bool> placed(slices.size(), false);
+  auto isBetterCandidate = [&](unsigned lhs, unsigned rhs) {
+    return std::make_tuple(
+               candidateOffsets[lhs], -slices[lhs].size,
+               slices[lhs].lifetimeStart - slices[lhs].lifetimeEnd, lhs) <
+           std::make_tuple(
+               candidateOffsets[rhs], -slices[rhs].size,
+               slices[rhs].lifetimeStart - slices[rhs].lifetimeEnd, rhs);
+  };
+  for (unsigned step = 0; step < slices.size(); ++step) {
+    unsigned bestIndex = 0;
+    bool hasBest = false;
+    for (unsigned i = 0; i < slices.size(); ++i) {
+      if (!placed[i] && (!hasBest || isBetterCandidate(i, bestIndex))) {
+        bestIndex = i;
+        hasBest = true;
+      }
+    }
+    int64_t offset = candidateOffsets[bestIndex];
+    int64_t end = offset + slices[bestIndex].size;
+    placed[bestIndex] = true;
+    packing.offsets[bestIndex] = offset;
+    packing.size = std::max(packing.size, end);
+    for (unsigned i = 0; i < slices.size(); ++i) {
+      if (placed[i] || !slices[i].intersects(slices[bestIndex]) ||
+          end <= candidateOffsets[i] ||
+          candidateOffsets[i] + slices[i].size <= offset) {
+        continue;
+      }
+      candidateOffsets[i] = findSliceOffset(i, slices, packing.offsets,
+                                            offsetAlignment, SliceFit::First);
+    }
+  }
+  return packing;
+}
+
+// Maximum number of slices for which all placement orders are searched.
+static constexpr unsigned kMaxExhaustiveSliceCount = 7;
+
+// Packs a small number of slices optimally by trying every placement order.
+// Placing the slices of any packing at the lowest offsets they fit at in the
+// order of their offsets produces a packing no larger so the best of all
+// orders is optimal. Stops early when a packing reaches |lowerBound|.
+static StaticPacking
+packSlicesExhaustively(ArrayRef<StaticSlice> slices,
+                       int64_t offsetAlignment, int64_t lowerBound) {
+  SmallVector<unsigned> order(slices.size());
+  std::iota(order.begin(), order.end(), 0);
+  StaticPacking bestPacking;
+  bestPacking.size = INT64_MAX;
+  do {
+    auto packing =
+        packSlicesInOrder(slices, order, offsetAlignment, SliceFit::First);
+    if (packing.size < bestPacking.size) {
+      bestPacking = std::move(packing);
+      if (bestPacking.size <= lowerBound)
+        break;
+    }
+  } while (std::next_permutation(order.begin(), order.end()));
+  return bestPacking;
+}
+
+// Packs a set of statically-sized slices by trying several heuristics and
+// keeping the smallest packing.
 //
-// We should use a set of heuristics and pick the smallest one. There are also
-// some really great papers that have approximations (as all of these are -
-// 2D strip packing is NP-hard) such as
-// https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
-// someone with a brain able to parse mathy papers can try implementing.
+// 2D strip packing is NP-hard and no single heuristic is best for all
+// lifetime/size distributions so we can afford to try several as the packing
+// happens offline. The heuristics are those of
+// https://arxiv.org/abs/2001.03288 (greedy by size/breadth) along with the
+// tflite lifetime order strip packing and a lowest-offset best-fit (for all but
+// large sets of slices). Small sets of slices are packed optimally by searching
+// all placement orders. Packing stops as soon as one reaches the lower bound of
+// the peak live size.
 //
 // Slice packed offset SSA values will be updated and start at the given
 // |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value
-packStaticSlicesGreedily(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-                         ArrayRef<Slice> slices,
-                         IREE::Stream::ResourceConfigAttr resourceConfig,
-                         IndexSet &indexSet, OpBuilder &builder) {
+// aligned to the requirements of |resourceConfig|. |outLowerBound| is set to
+// the smallest total size possible (excluding |baseOffset|).
+static Value packStaticSlices(IREE::Stream::ResourcePackOp packOp,
+                              Value baseOffset, ArrayRef<Slice> slices,
+                              IREE::Stream::ResourceConfigAttr resourceConfig,
+                              IndexSet &indexSet, OpBuilder &builder,
+                              int64_t &outLowerBound) {
   int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
   int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
 
-  struct Reservation {
-    const Slice *slice = nullptr;
-    int64_t staticOffset = 0;
-    int64_t staticSize = 0;
-  };
-  static constexpr int64_t UNASSIGNED = INT64_MAX;
-
-  std::list<Reservation> reservations;
-  int64_t highwaterMark = 0;
+  SmallVector<StaticSlice> staticSlices;
+  staticSlices.reserve(slices.size());
   for (auto &slice : slices) {
-    int64_t bestOffset = UNASSIGNED;
-    int64_t bestOffsetFit = UNASSIGNED;
     int64_t staticSize =
         cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
-
-    // Iterate through reservations (sorted by ascending offset) and identify
-    // gaps in which the slice will fit. To reduce wastage we want to find the
-    // smallest gap.
-    int64_t currentOffset = 0;
-    for (auto &reservation : reservations) {
-      if (!reservation.slice->intersects(slice)) {
-        // Non-overlapping - we can reuse the currentOffset (assuming we find
-        // no better place).
-        continue;
-      }
+    staticSlices.push_back({slice.lifetimeStart, slice.lifetimeEnd,
+                            IREE::Util::align(staticSize, rangeAlignment)});
+  }
+  auto profile = computeLiveSizeProfile(staticSlices);
+  int64_t lowerBound = 0;
+  for (auto [time, liveSize] : profile) {
+    lowerBound = std::max(lowerBound, liveSize);
+  }
 
-      // If we found a gap >= the required size and smaller than
-      // previous best fit take it.
-      int64_t alignedOffset = IREE::Util::align(currentOffset, offsetAlignment);
-      if (alignedOffset + alignedSize <= reservation.staticOffset &&
-          reservation.staticOffset - alignedOffset < bestOffsetFit) {
-        bestOffset = alignedOffset;
-        bestOffsetFit = reservation.staticOffset - currentOffset;
-      }
-      currentOffset = std::max(currentOffset, reservation.staticOffset +
-                                                  reservation.staticSize);
-    }
-    if (bestOffset == UNASSIGNED) {
-      bestOffset = IREE::Util::align(currentOffset, offsetAlignment);
+  // Each slice's breadth is the largest live size during its lifetime.
+  SmallVector<int64_t> breadths(staticSlices.size(), 0);
+  for (unsigned i = 0; i < staticSlices.size(); ++i) {
+    const auto &slice = staticSlices[i];
+    auto it = llvm::partition_point(profile, [&](auto &entry) {
+      return entry.first < slice.lifetimeStart;
+    });
+    for (; it != profile.end() && it->first <= slice.lifetimeEnd; ++it) {
+      breadths[i] = std::max(breadths[i], it->second);
     }
+  }
 
-    // Reserve the memory.
-    Reservation reservation;
-    reservation.slice = &slice;
-    reservation.staticOffset = bestOffset;
-    reservation.staticSize = alignedSize;
-    auto insertionIt = reservations.begin();
-    while (insertionIt != reservations.end() &&
-           insertionIt->staticOffset < reservation.staticOffset) {
-      ++insertionIt;
+  // Candidate placement orders. Slices are provided in lifetime order once the
+  // pack op has been canonicalized.
+  SmallVector<unsigned> lifetimeOrder(staticSlices.size());
+  std::iota(lifetimeOrder.begin(), lifetimeOrder.end(), 0);
+  SmallVector<unsigned> sizeOrder = lifetimeOrder;
+  llvm::stable_sort(sizeOrder, [&](unsigned lhs, unsigned rhs) {
+    return staticSlices[lhs].size > staticSlices[rhs].size;
+  });
+  SmallVector<unsigned> breadthOrder = lifetimeOrder;
+  llvm::stable_sort(breadthOrder, [&](unsigned lhs, unsigned rhs) {
+    return std::make_pair(breadths[lhs], staticSlices[lhs].size) >
+           std::make_pair(breadths[rhs], staticSlices[rhs].size);
+  });
+
+  // Try each heuristic and keep the smallest packing. Earlier heuristics are
+  // preferred when packings are the same size.
+  StaticPacking bestPacking;
+  bestPacking.size = INT64_MAX;
+  auto considerPacking = [&](StringRef name, StaticPacking packing) {
+    LLVM_DEBUG(llvm::dbgs() << "[LayoutSlices] " << name << " packed "
+                            << staticSlices.size() << " slices into "
+                            << packing.size << " bytes (lower bound "
+                            << lowerBound << ")\n");
+    if (packing.size < bestPacking.size) {
+      bestPacking = std::move(packing);
     }
-    reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+  };
+  auto isOptimal = [&]() { return bestPacking.size <= lowerBound; };
+  considerPacking("lifetime order",
+                  packSlicesInOrder(staticSlices, lifetimeOrder,
+                                    offsetAlignment, SliceFit::Best));
+  if (!isOptimal()) {
+    considerPacking("greedy by size",
+                    packSlicesInOrder(staticSlices, sizeOrder, offsetAlignment,
+                                      SliceFit::Best));
+  }
+  if (!isOptimal()) {
+    considerPacking("greedy by breadth",
+                    packSlicesInOrder(staticSlices, breadthOrder,
+                                      offsetAlignment, SliceFit::Best));
+  }
+  if (!isOptimal() && staticSlices.size() <= kMaxLowestOffsetSliceCount) {
+    considerPacking("lowest offset",
+                    packSlicesByLowestOffset(staticSlices, offsetAlignment));
+  }
+  if (!isOptimal() && staticSlices.size() <= kMaxExhaustiveSliceCount) {
+    considerPacking("exhaustive",
+                    packSlicesExhaustively(staticSlices, offsetAlignment,
+                                           lowerBound));
+  }
 
-    // Update highwater mark indicating how much memory needs to be allocated
-    // for the entire slab.
-    highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
+  for (unsigned i = 0; i < slices.size(); ++i) {
+    slices[i].packedOffset.replaceAllUsesWith(
+        builder.createOrFold<arith::AddIOp>(
+            packOp.getLoc(), baseOffset,
+            indexSet.get(bestPacking.offsets[i])));
   }
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  // The highwater mark indicates how much memory needs to be allocated for
+  // the entire slab.
+  int64_t highwaterMark = IREE::Util::align(bestPacking.size, rangeAlignment);
+  outLowerBound = IREE::Util::align(lowerBound, rangeAlignment);
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
                                              indexSet.get(highwaterMark));
 }
@@ -264,9 +484,6 @@ public:
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
@@ -293,9 +510,10 @@ public:
       // First pack all static slices as these are entirely knowable here at
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
+      int64_t staticLowerBound = 0;
       if (!staticSlices.empty()) {
-        offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
+        offset = packStaticSlices(packOp, offset, staticSlices, resourceConfig,
+                                  indexSet, builder, staticLowerBound);
 
         // TODO(benvanik): make this an option; it can be useful for debugging
         // this code.
@@ -311,6 +529,18 @@ public:
             packOp, offset, dynamicSlices, resourceConfig, indexSet, builder);
       }
 
+      // Record the smallest size the transient allocations could have had so
+      // that packing efficiency can be reported by
+      // --iree-stream-dump-statistics.
+      if (dynamicSlices.empty() && !packOp.getOffset()) {
+        auto lowerBoundAttr = builder.getIndexAttr(staticLowerBound);
+        for (auto *user : packOp.getTotalLength().getUsers()) {
+          if (isa<IREE::Stream::ResourceAllocaOp>(user)) {
+            user->setAttr("stream.pack.lower_bound", lowerBoundAttr);
+          }
+        }
+      }
+
       // Total packed length is the current offset after all slices are
       // allocated. This should be aligned to the range constraints.
       packOp.getTotalLength().replaceAllUsesWith(offset);
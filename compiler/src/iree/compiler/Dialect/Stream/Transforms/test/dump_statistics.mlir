@@ -6,6 +6,7 @@
 // CHECK-PRETTY:   Variables: 0, (TBD)
 // CHECK-PRETTY:  D->H Syncs: 2
 // CHECK-PRETTY: Submissions: 2, using cumulative 0 B
+// CHECK-PRETTY:  Transients: lower bound 0 B (0.00 MiB), 0.00% packing overhead
 // CHECK-PRETTY:   DMA Fills: 0
 // CHECK-PRETTY:  DMA Copies: 1
 // CHECK-PRETTY: Collectives: 0
@@ -13,8 +14,8 @@
 // CHECK-PRETTY: Executables: 2, 33% reuse
 
 // CHECK-CSV: ; Aggregate Statistics
-// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables"
-// CHECK-CSV: 1,192,0,0,2,2,0,0,1,3,0,2
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Lower Bound","Fills","Copies","Dispatches","Async Calls","Executables"
+// CHECK-CSV: 1,192,0,0,2,2,0,0,0,1,3,0,2
 // CHECK-CSV: ; Execution
 // CHECK-CSV: "Depth","Command","Symbol","Length","Invocations","Workload","Operands","Resources"
 // CHECK-CSV: 0,"copy",,16,,,,
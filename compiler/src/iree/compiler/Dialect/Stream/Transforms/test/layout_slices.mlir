@@ -29,6 +29,38 @@ func.func @layoutStatic() -> (index, index, index, index, index, index, index)
 
 // -----
 
+#layoutStaticBestOfConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Tests that the smallest of several packings is used when packing in
+// lifetime order is suboptimal and that the lower bound is recorded.
+
+// CHECK-LABEL: @layoutStaticBestOf
+func.func @layoutStaticBestOf() -> (!stream.resource<transient>, index, index, index, index)
+    attributes {stream.resources = #layoutStaticBestOfConfig} {
+  %c16 = arith.constant 16 : index
+  %c160 = arith.constant 160 : index
+  %c288 = arith.constant 288 : index
+  %t:5 = stream.resource.pack slices({
+    [2, 2] = %c160,  // +0
+    [2, 3] = %c160,  // +288 (above [3, 3])
+    [3, 3] = %c288,  // +0 (reuse [2, 2])
+    [3, 5] = %c16,   // +448 (after [2, 3])
+  }) : index
+  // 160 + 288 + 16 = 464 total bytes required (vs 608 in lifetime order)
+  // CHECK: stream.resource.alloca uninitialized {{.+}}stream.pack.lower_bound = 464 : index{{.+}}{%c464}
+  %alloca, %alloca_timepoint = stream.resource.alloca uninitialized : !stream.resource<transient>{%t#0} => !stream.timepoint
+  // CHECK: return %{{.+}}, %c0, %c288, %c0, %c448
+  return %alloca, %t#1, %t#2, %t#3, %t#4 : !stream.resource<transient>, index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
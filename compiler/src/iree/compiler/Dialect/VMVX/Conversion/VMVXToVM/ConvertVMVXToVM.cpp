@@ -97,6 +97,11 @@ protected:
       elementType = shapedType.getElementType();
     }
 
+    // bf16 shares its bit width with f16 and so needs its own name.
+    if (elementType.isBF16()) {
+      return "bf16";
+    }
+
     std::string typePrefix = "x";
     if (llvm::isa<FloatType>(elementType)) {
       typePrefix = "f";
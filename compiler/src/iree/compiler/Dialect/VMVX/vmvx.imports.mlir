@@ -9,7 +9,8 @@
 // * 'i' : signless integer (+ bit depth)   ex: i1 i8 i16 i32 i64
 // * 'si': signed integer (+ bit depth)     ex: si32 ...
 // * 'ui': unsigned integer (+ bit depth)   ex: ui32 ...
-// * 'f' : IREE float (+ bit depth)         ex: f32 f64
+// * 'f' : IREE float (+ bit depth)         ex: f16 f32 f64
+// * 'bf16': bfloat16
 //
 // See the README.md for more more details on the implementation.
 //
@@ -30,6 +31,38 @@ vm.module @vmvx {
 // Each is specialized by opcode, rank and type width.
 //===----------------------------------------------------------------------===//
 
+vm.import private @add.2d.bf16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @add.2d.f16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @add.2d.f32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -62,6 +95,22 @@ vm.import private @add.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @add.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @and.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -78,6 +127,54 @@ vm.import private @and.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @and.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @div.2d.bf16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @div.2d.f16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @div.2d.f32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -110,6 +207,22 @@ vm.import private @divs.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @divs.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @divu.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -126,6 +239,54 @@ vm.import private @divu.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @divu.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @mul.2d.bf16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @mul.2d.f16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @mul.2d.f32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -158,6 +319,22 @@ vm.import private @mul.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @mul.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @or.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -174,6 +351,22 @@ vm.import private @or.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @or.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @shl.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -190,6 +383,22 @@ vm.import private @shl.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @shl.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @shrs.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -206,6 +415,22 @@ vm.import private @shrs.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @shrs.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @shru.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -222,6 +447,54 @@ vm.import private @shru.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @shru.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @sub.2d.bf16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @sub.2d.f16(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @sub.2d.f32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -254,6 +527,22 @@ vm.import private @sub.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @sub.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @xor.2d.i32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -270,11 +559,47 @@ vm.import private @xor.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @xor.2d.i8(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 //===----------------------------------------------------------------------===//
 // VMVX Unary Elementwise Kernels
 // Each is specialized by opcode, rank and type width.
 //===----------------------------------------------------------------------===//
 
+vm.import private @abs.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @abs.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @abs.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -285,6 +610,26 @@ vm.import private @abs.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @ceil.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @ceil.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @ceil.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -305,6 +650,36 @@ vm.import private @ctlz.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @ctlz.2d.i8(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @exp.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @exp.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @exp.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -315,6 +690,26 @@ vm.import private @exp.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @floor.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @floor.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @floor.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -325,6 +720,26 @@ vm.import private @floor.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @log.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @log.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @log.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -335,6 +750,26 @@ vm.import private @log.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @neg.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @neg.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @neg.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -345,6 +780,26 @@ vm.import private @neg.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import private @rsqrt.2d.bf16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
+vm.import private @rsqrt.2d.f16(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 vm.import private @rsqrt.2d.f32(
   %in_buffer : !vm.buffer,
   %in_offset : i64,
@@ -6,6 +6,8 @@
 
 #include "./hal.h"
 
+#include <memory>
+
 #include "./numpy_interop.h"
 #include "./vm.h"
 #include "iree/base/internal/path.h"
@@ -77,6 +79,48 @@ class PyBufferReleaser {
   Py_buffer& b_;
 };
 
+// Release callback of buffers imported from a Py_buffer. Releases the view
+// (and with it the exporting object) when the HAL buffer is destroyed, which
+// may happen on any thread.
+static void ReleaseImportedPyBuffer(void* user_data,
+                                    iree_hal_buffer_t* buffer) {
+  Py_buffer* py_view = static_cast<Py_buffer*>(user_data);
+  {
+    py::gil_scoped_acquire acquire;
+    PyBuffer_Release(py_view);
+  }
+  delete py_view;
+}
+
+// Returns |hal_buffer| as a HalBuffer or, if an |element_type| is specified,
+// as a HalBufferView with the shape of |py_view|. Takes ownership of
+// |hal_buffer|.
+static py::object WrapBuffer(
+    iree_hal_allocator_t* allocator, iree_hal_buffer_t* hal_buffer,
+    const Py_buffer& py_view,
+    std::optional<iree_hal_element_types_t> element_type) {
+  if (!element_type) {
+    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
+                    py::rv_policy::move);
+  }
+
+  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
+  // copy).
+  iree_hal_encoding_type_t encoding_type =
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+  std::vector<iree_hal_dim_t> dims(py_view.ndim);
+  std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
+  iree_hal_buffer_view_t* hal_buffer_view = nullptr;
+  iree_status_t status = iree_hal_buffer_view_create(
+      hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
+      iree_hal_allocator_host_allocator(allocator), &hal_buffer_view);
+  iree_hal_buffer_release(hal_buffer);
+  CheckApiStatus(status, "Error allocating buffer_view");
+
+  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
+                  py::rv_policy::move);
+}
+
 static std::string ToHexString(const uint8_t* data, size_t length) {
   static constexpr char kHexChars[] = {'0', '1', '2', '3', '4', '5', '6', '7',
                                        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
@@ -108,6 +152,10 @@ py::dict HalAllocator::QueryStatistics() {
   items["device_bytes_peak"] = stats.device_bytes_peak;
   items["device_bytes_allocated"] = stats.device_bytes_allocated;
   items["device_bytes_freed"] = stats.device_bytes_freed;
+  items["cache_hit_count"] = stats.cache_hit_count;
+  items["cache_miss_count"] = stats.cache_miss_count;
+  items["cache_bytes_free"] = stats.cache_bytes_free;
+  items["cache_bytes_high_water"] = stats.cache_bytes_high_water;
 #endif
   return items;
 }
@@ -167,27 +215,63 @@ py::object HalAllocator::AllocateBufferCopy(
   }
   CheckApiStatus(status, "Failed to allocate device visible buffer");
 
-  if (!element_type) {
-    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
-                    py::rv_policy::move);
+  return WrapBuffer(raw_ptr(), hal_buffer, py_view, element_type);
+}
+
+py::object HalAllocator::ImportBuffer(
+    int memory_type, int allowed_usage, HalDevice& device, py::object buffer,
+    std::optional<iree_hal_element_types_t> element_type) {
+  IREE_TRACE_SCOPE_NAMED("HalAllocator::ImportBuffer");
+  // Unlike the copying paths the view must outlive this call when imported
+  // and is heap allocated for ownership by the release callback.
+  auto py_view = std::make_unique<Py_buffer>();
+  int flags = PyBUF_FORMAT | PyBUF_ND;
+  if (PyObject_GetBuffer(buffer.ptr(), py_view.get(), flags) != 0) {
+    // The GetBuffer call is required to set an appropriate error.
+    throw py::python_error();
   }
 
-  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
-  // copy).
-  iree_hal_encoding_type_t encoding_type =
-      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
-  std::vector<iree_hal_dim_t> dims(py_view.ndim);
-  std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
-  iree_hal_buffer_view_t* hal_buffer_view;
-  CheckApiStatus(
-      iree_hal_buffer_view_create(
-          hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
-          iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view),
-      "Error allocating buffer_view");
-  iree_hal_buffer_release(hal_buffer);
+  iree_hal_buffer_params_t params = {0};
+  params.type = memory_type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage = allowed_usage;
+  iree_hal_external_buffer_t external_buffer;
+  std::memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = py_view->len;
+  external_buffer.handle.host_allocation.ptr = py_view->buf;
+
+  // Read-only memory cannot be handed to programs that may write to it and
+  // dispatches assume their bindings have the heap buffer alignment.
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  if (!py_view->readonly && py_view->len > 0 &&
+      iree_host_size_has_alignment((uintptr_t)py_view->buf,
+                                   IREE_HAL_HEAP_BUFFER_ALIGNMENT) &&
+      iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                            raw_ptr(), params, py_view->len,
+                            /*out_params=*/nullptr,
+                            /*out_allocation_size=*/nullptr),
+                        IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE)) {
+    iree_hal_buffer_release_callback_t release_callback = {
+        ReleaseImportedPyBuffer, py_view.get()};
+    iree_status_t status = iree_hal_allocator_import_buffer(
+        raw_ptr(), params, &external_buffer, release_callback, &hal_buffer);
+    if (!iree_status_is_ok(status)) {
+      // Any failure to import falls back to copying.
+      iree_status_ignore(status);
+      hal_buffer = nullptr;
+    }
+  }
+  if (!hal_buffer) {
+    PyBuffer_Release(py_view.get());
+    return AllocateBufferCopy(memory_type, allowed_usage, device, buffer,
+                              element_type);
+  }
 
-  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
-                  py::rv_policy::move);
+  // The view is now owned by the buffer and remains valid until it is
+  // released.
+  Py_buffer* imported_view = py_view.release();
+  return WrapBuffer(raw_ptr(), hal_buffer, *imported_view, element_type);
 }
 
 HalBuffer HalAllocator::AllocateHostStagingBufferCopy(HalDevice& device,
@@ -945,6 +1029,17 @@ void SetupHalBindings(nanobind::module_ m) {
            "matching the characteristics of the Python buffer. The format is "
            "requested as ND/C-Contiguous, which may incur copies if not "
            "already in that format.")
+      .def("import_buffer", &HalAllocator::ImportBuffer,
+           py::arg("memory_type"), py::arg("allowed_usage"), py::arg("device"),
+           py::arg("buffer"), py::arg("element_type") = py::none(),
+           py::keep_alive<0, 1>(),
+           "Wraps the memory of a Python buffer object in a new buffer without "
+           "copying when possible. The memory must be ND/C-Contiguous, "
+           "writable, and aligned to the device requirements (64 bytes on CPU) "
+           "and the allocator must support importing host allocations; "
+           "otherwise the contents are copied as with allocate_buffer_copy. "
+           "When imported, the buffer object is kept alive by the returned "
+           "buffer and changes to either are visible in the other.")
       .def("allocate_host_staging_buffer_copy",
            &HalAllocator::AllocateHostStagingBufferCopy, py::arg("device"),
            py::arg("initial_contents"), py::keep_alive<0, 1>(),
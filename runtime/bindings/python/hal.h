@@ -151,6 +151,13 @@ class HalAllocator : public ApiRefCounted<HalAllocator, iree_hal_allocator_t> {
   py::object AllocateBufferCopy(
       int memory_type, int allowed_usage, HalDevice& device, py::object buffer,
       std::optional<iree_hal_element_types_t> element_type);
+  // Imports the memory of a Python buffer object into a HAL buffer without
+  // copying when the allocator supports it and the memory is writable and
+  // suitably aligned. The buffer object is kept alive until the HAL buffer is
+  // released. Falls back to AllocateBufferCopy otherwise.
+  py::object ImportBuffer(
+      int memory_type, int allowed_usage, HalDevice& device, py::object buffer,
+      std::optional<iree_hal_element_types_t> element_type);
   HalBuffer AllocateHostStagingBufferCopy(HalDevice& device, py::handle buffer);
 };
 
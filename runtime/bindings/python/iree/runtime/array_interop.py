@@ -194,6 +194,7 @@ def asdevicearray(
     memory_type=MemoryType.DEVICE_LOCAL,
     allowed_usage=(BufferUsage.DEFAULT | BufferUsage.MAPPING),
     element_type: Optional[HalElementType] = None,
+    copy: bool = True,
 ) -> DeviceArray:
     """Helper to create a DeviceArray from an arbitrary array like.
 
@@ -207,6 +208,10 @@ def asdevicearray(
     Note that additional flags `memory_type`, `allowed_usage` and `element_type`
     are only hints if creating a new DeviceArray. If `a` is already a DeviceArray,
     they are ignored.
+
+    If `copy` is False then the memory of `a` is used directly by the device
+    when possible (host-local devices and writable arrays aligned to 64 bytes)
+    and the returned DeviceArray aliases it. Otherwise a copy is made as usual.
     """
     if isinstance(a, DeviceArray):
         if dtype is None:
@@ -221,7 +226,12 @@ def asdevicearray(
     element_type = map_dtype_to_element_type(a.dtype)
     if element_type is None:
         raise ValueError(f"Could not map dtype {a.dtype} to IREE element type")
-    buffer_view = device.allocator.allocate_buffer_copy(
+    allocate = (
+        device.allocator.allocate_buffer_copy
+        if copy
+        else device.allocator.import_buffer
+    )
+    buffer_view = allocate(
         memory_type=memory_type,
         allowed_usage=allowed_usage,
         device=device,
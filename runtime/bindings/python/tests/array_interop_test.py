@@ -157,6 +157,15 @@ class DeviceHalTest(unittest.TestCase):
         self.assertEqual(f32_copy.dtype, np.float32)
         np.testing.assert_array_equal(orig_ary.astype(np.float32), f32_copy)
 
+    def testNoCopy(self):
+        storage = np.zeros([12 * 4 + 64], dtype=np.uint8)
+        offset = -storage.ctypes.data % 64
+        init_ary = storage[offset : offset + 12 * 4].view(np.float32).reshape([3, 4])
+        ary = iree.runtime.asdevicearray(self.device, init_ary, copy=False)
+        init_ary[0, 1] = 3.0
+        self.assertTrue(np.shares_memory(ary.to_host(), init_ary))
+        self.assertEqual(ary.to_host()[0, 1], 3.0)
+
     def testBool(self):
         init_ary = np.zeros([3, 4], dtype=np.bool_)
         init_ary[1] = True  # Set some non-zero value.
@@ -181,6 +181,59 @@ class DeviceHalTest(unittest.TestCase):
             "<HalBufferView (3, 4), element_type=0x20000011, 48 bytes (at offset 0 into 48), memory_type=DEVICE_LOCAL|HOST_VISIBLE, allowed_access=ALL, allowed_usage=TRANSFER|DISPATCH_STORAGE|MAPPING|MAPPING_PERSISTENT>",
         )
 
+    def testImportBuffer(self):
+        # Over-allocate to get an array meeting the device alignment.
+        storage = np.zeros([12 * 4 + 64], dtype=np.uint8)
+        offset = -storage.ctypes.data % 64
+        ary = storage[offset : offset + 12 * 4].view(np.int32).reshape([3, 4])
+        buffer_view = self.allocator.import_buffer(
+            memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+            allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+            device=self.device,
+            buffer=ary,
+            element_type=iree.runtime.HalElementType.SINT_32,
+        )
+        # Changes to the array are visible through the buffer.
+        ary[1, 2] = 7
+        mapped = buffer_view.map().asarray([3, 4], np.int32)
+        self.assertEqual(mapped[1, 2], 7)
+        self.assertTrue(np.shares_memory(mapped, ary))
+
+        # The array is kept alive by the buffer.
+        del ary, storage
+        gc.collect()
+        self.assertEqual(mapped[1, 2], 7)
+
+    def testImportBufferCopiesUnaligned(self):
+        storage = np.zeros([12 * 4 + 64], dtype=np.uint8)
+        offset = (-storage.ctypes.data % 64) + 4
+        ary = storage[offset : offset + 12 * 4].view(np.int32).reshape([3, 4])
+        buffer_view = self.allocator.import_buffer(
+            memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+            allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+            device=self.device,
+            buffer=ary,
+            element_type=iree.runtime.HalElementType.SINT_32,
+        )
+        ary[1, 2] = 7
+        mapped = buffer_view.map().asarray([3, 4], np.int32)
+        self.assertEqual(mapped[1, 2], 0)
+
+    def testImportBufferCopiesReadOnly(self):
+        storage = np.zeros([12 * 4 + 64], dtype=np.uint8)
+        offset = -storage.ctypes.data % 64
+        ary = storage[offset : offset + 12 * 4].view(np.int32).reshape([3, 4])
+        ary.flags.writeable = False
+        buffer_view = self.allocator.import_buffer(
+            memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+            allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+            device=self.device,
+            buffer=ary,
+            element_type=iree.runtime.HalElementType.SINT_32,
+        )
+        mapped = buffer_view.map().asarray([3, 4], np.int32)
+        self.assertFalse(np.shares_memory(mapped, ary))
+
     def testAllocateHostStagingBufferCopy(self):
         buffer = self.allocator.allocate_host_staging_buffer_copy(
             self.device, np.int32(0)
@@ -290,6 +290,17 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_BYTECODE_VERIFICATION_ENABLE 1
 #endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
 
+#if !defined(IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE)
+// Enables rewriting common op sequences (cmp+cond_br, global.load.ref+call,
+// etc) into fused superinstructions when functions are verified at load time.
+// With computed goto dispatch each fused op jumps directly to the second op
+// and avoids an indirect branch. Adds a copy of the module bytecode per loaded
+// module and requires IREE_VM_BYTECODE_VERIFICATION_ENABLE.
+#define IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE      \
+  (IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE && \
+   IREE_VM_BYTECODE_VERIFICATION_ENABLE)
+#endif  // !IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
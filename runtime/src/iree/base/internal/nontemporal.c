@@ -0,0 +1,191 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/nontemporal.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+
+#if defined(IREE_ARCH_X86_64) || \
+    (defined(IREE_ARCH_X86_32) && defined(__SSE2__))
+#include <emmintrin.h>
+#endif  // IREE_ARCH_X86_*
+
+//==============================================================================
+// Target-specific word stores
+//==============================================================================
+// Each target defines a word type that is stored with a single non-temporal
+// store instruction. Stores must be aligned to the word size while loads may be
+// unaligned.
+
+#if defined(IREE_ARCH_X86_64) || \
+    (defined(IREE_ARCH_X86_32) && defined(__SSE2__))
+
+#define IREE_NONTEMPORAL_STORES_SUPPORTED 1
+typedef __m128i iree_nontemporal_word_t;
+static inline iree_nontemporal_word_t iree_nontemporal_load_word(
+    const uint8_t* source) {
+  return _mm_loadu_si128((const __m128i*)source);
+}
+static inline void iree_nontemporal_store_word(uint8_t* target,
+                                               iree_nontemporal_word_t value) {
+  _mm_stream_si128((__m128i*)target, value);
+}
+static inline void iree_nontemporal_fence(void) { _mm_sfence(); }
+
+#elif IREE_HAVE_BUILTIN(__builtin_nontemporal_store)
+
+#define IREE_NONTEMPORAL_STORES_SUPPORTED 1
+typedef uint64_t iree_nontemporal_word_t;
+static inline iree_nontemporal_word_t iree_nontemporal_load_word(
+    const uint8_t* source) {
+  iree_nontemporal_word_t value;
+  memcpy(&value, source, sizeof(value));
+  return value;
+}
+static inline void iree_nontemporal_store_word(uint8_t* target,
+                                               iree_nontemporal_word_t value) {
+  __builtin_nontemporal_store(value, (iree_nontemporal_word_t*)target);
+}
+static inline void iree_nontemporal_fence(void) {
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+}
+
+#else
+
+// Regular stores; the transfers still work but will allocate in the caches.
+#define IREE_NONTEMPORAL_STORES_SUPPORTED 0
+typedef uint64_t iree_nontemporal_word_t;
+static inline iree_nontemporal_word_t iree_nontemporal_load_word(
+    const uint8_t* source) {
+  iree_nontemporal_word_t value;
+  memcpy(&value, source, sizeof(value));
+  return value;
+}
+static inline void iree_nontemporal_store_word(uint8_t* target,
+                                               iree_nontemporal_word_t value) {
+  memcpy(target, &value, sizeof(value));
+}
+static inline void iree_nontemporal_fence(void) {}
+
+#endif  // IREE_ARCH_*
+
+#define IREE_NONTEMPORAL_WORD_SIZE sizeof(iree_nontemporal_word_t)
+
+bool iree_nontemporal_stores_supported(void) {
+  return IREE_NONTEMPORAL_STORES_SUPPORTED ? true : false;
+}
+
+// Returns the number of bytes from |target| to the next word boundary, clamped
+// to |length|.
+static iree_host_size_t iree_nontemporal_head_length(const uint8_t* target,
+                                                     iree_host_size_t length) {
+  iree_host_size_t misalignment =
+      (uintptr_t)target & (IREE_NONTEMPORAL_WORD_SIZE - 1);
+  iree_host_size_t head_length =
+      misalignment ? IREE_NONTEMPORAL_WORD_SIZE - misalignment : 0;
+  return iree_min(head_length, length);
+}
+
+//==============================================================================
+// iree_nontemporal_fill
+//==============================================================================
+
+// Fills |length| bytes of |target| with |pattern| as if the fill had started
+// |phase| bytes prior to |target|. |pattern_length| must be a power of two.
+static void iree_nontemporal_fill_bytes(uint8_t* target,
+                                        iree_host_size_t phase,
+                                        iree_host_size_t length,
+                                        const uint8_t* pattern,
+                                        iree_host_size_t pattern_length) {
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    target[i] = pattern[(phase + i) & (pattern_length - 1)];
+  }
+}
+
+void iree_nontemporal_fill(void* target, iree_host_size_t length,
+                           const void* pattern,
+                           iree_host_size_t pattern_length) {
+  IREE_ASSERT(pattern_length == 1 || pattern_length == 2 ||
+              pattern_length == 4 || pattern_length == 8);
+  uint8_t* target_ptr = (uint8_t*)target;
+  const uint8_t* pattern_ptr = (const uint8_t*)pattern;
+
+  // Unaligned head up to the first word boundary.
+  iree_host_size_t offset = iree_nontemporal_head_length(target_ptr, length);
+  iree_nontemporal_fill_bytes(target_ptr, 0, offset, pattern_ptr,
+                              pattern_length);
+
+  // Aligned words with the pattern rotated to the phase it has at |offset|.
+  // The word size is a multiple of the pattern length so the phase is the same
+  // for every word.
+  uint8_t splat[IREE_NONTEMPORAL_WORD_SIZE];
+  iree_nontemporal_fill_bytes(splat, offset, sizeof(splat), pattern_ptr,
+                              pattern_length);
+  const iree_nontemporal_word_t value = iree_nontemporal_load_word(splat);
+  for (; offset + 4 * IREE_NONTEMPORAL_WORD_SIZE <= length;
+       offset += 4 * IREE_NONTEMPORAL_WORD_SIZE) {
+    uint8_t* ptr = target_ptr + offset;
+    iree_nontemporal_store_word(ptr + 0 * IREE_NONTEMPORAL_WORD_SIZE, value);
+    iree_nontemporal_store_word(ptr + 1 * IREE_NONTEMPORAL_WORD_SIZE, value);
+    iree_nontemporal_store_word(ptr + 2 * IREE_NONTEMPORAL_WORD_SIZE, value);
+    iree_nontemporal_store_word(ptr + 3 * IREE_NONTEMPORAL_WORD_SIZE, value);
+  }
+  for (; offset + IREE_NONTEMPORAL_WORD_SIZE <= length;
+       offset += IREE_NONTEMPORAL_WORD_SIZE) {
+    iree_nontemporal_store_word(target_ptr + offset, value);
+  }
+
+  // Partial tail word.
+  iree_nontemporal_fill_bytes(target_ptr + offset, offset, length - offset,
+                              pattern_ptr, pattern_length);
+
+  iree_nontemporal_fence();
+}
+
+//==============================================================================
+// iree_nontemporal_copy
+//==============================================================================
+
+void iree_nontemporal_copy(void* target, const void* source,
+                           iree_host_size_t length) {
+  uint8_t* target_ptr = (uint8_t*)target;
+  const uint8_t* source_ptr = (const uint8_t*)source;
+
+  // Unaligned head up to the first target word boundary. The source may remain
+  // unaligned.
+  iree_host_size_t offset = iree_nontemporal_head_length(target_ptr, length);
+  memcpy(target_ptr, source_ptr, offset);
+
+  for (; offset + 4 * IREE_NONTEMPORAL_WORD_SIZE <= length;
+       offset += 4 * IREE_NONTEMPORAL_WORD_SIZE) {
+    const uint8_t* src = source_ptr + offset;
+    uint8_t* dst = target_ptr + offset;
+    iree_nontemporal_word_t v0 =
+        iree_nontemporal_load_word(src + 0 * IREE_NONTEMPORAL_WORD_SIZE);
+    iree_nontemporal_word_t v1 =
+        iree_nontemporal_load_word(src + 1 * IREE_NONTEMPORAL_WORD_SIZE);
+    iree_nontemporal_word_t v2 =
+        iree_nontemporal_load_word(src + 2 * IREE_NONTEMPORAL_WORD_SIZE);
+    iree_nontemporal_word_t v3 =
+        iree_nontemporal_load_word(src + 3 * IREE_NONTEMPORAL_WORD_SIZE);
+    iree_nontemporal_store_word(dst + 0 * IREE_NONTEMPORAL_WORD_SIZE, v0);
+    iree_nontemporal_store_word(dst + 1 * IREE_NONTEMPORAL_WORD_SIZE, v1);
+    iree_nontemporal_store_word(dst + 2 * IREE_NONTEMPORAL_WORD_SIZE, v2);
+    iree_nontemporal_store_word(dst + 3 * IREE_NONTEMPORAL_WORD_SIZE, v3);
+  }
+  for (; offset + IREE_NONTEMPORAL_WORD_SIZE <= length;
+       offset += IREE_NONTEMPORAL_WORD_SIZE) {
+    iree_nontemporal_store_word(
+        target_ptr + offset, iree_nontemporal_load_word(source_ptr + offset));
+  }
+
+  // Partial tail word.
+  memcpy(target_ptr + offset, source_ptr + offset, length - offset);
+
+  iree_nontemporal_fence();
+}
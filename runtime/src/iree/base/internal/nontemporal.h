@@ -0,0 +1,52 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_NONTEMPORAL_H_
+#define IREE_BASE_INTERNAL_NONTEMPORAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// iree_nontemporal_*
+//==============================================================================
+// Non-temporal (streaming) stores write memory without allocating the written
+// lines in the cache hierarchy. Large transfers whose results are not read
+// again soon by the writing core can use them to avoid evicting the working set
+// of the work that follows. Small transfers or ones that are read back
+// immediately are faster with regular stores.
+//
+// All functions issue a store fence prior to returning such that the stores are
+// ordered before any subsequent synchronization performed by the caller.
+
+// Returns true if non-temporal stores are implemented for the target
+// architecture. When false the functions below use regular stores.
+bool iree_nontemporal_stores_supported(void);
+
+// Fills |length| bytes of |target| with a repeating |pattern| of
+// |pattern_length| bytes (1, 2, 4, or 8) starting at |target|.
+// |length| must be a multiple of |pattern_length|.
+void iree_nontemporal_fill(void* target, iree_host_size_t length,
+                           const void* pattern,
+                           iree_host_size_t pattern_length);
+
+// Copies |length| bytes from |source| to |target|. The ranges must not
+// overlap.
+void iree_nontemporal_copy(void* target, const void* source,
+                           iree_host_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IREE_BASE_INTERNAL_NONTEMPORAL_H_
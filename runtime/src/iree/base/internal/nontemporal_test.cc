@@ -0,0 +1,84 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/nontemporal.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Lengths around the word and unrolled loop boundaries of all targets.
+constexpr iree_host_size_t kLengths[] = {0,  1,  7,  8,   15,  16,  17,
+                                         31, 63, 64, 65,  127, 128, 129,
+                                         255, 256, 1000, 4096, 4099};
+
+// Guard bytes on either side of each transfer that must not be written.
+constexpr iree_host_size_t kGuardLength = 32;
+constexpr uint8_t kGuardValue = 0xCD;
+
+TEST(NontemporalTest, Fill) {
+  const uint8_t pattern[8] = {0x01, 0x02, 0x03, 0x04,
+                              0x05, 0x06, 0x07, 0x08};
+  for (iree_host_size_t pattern_length : {1, 2, 4, 8}) {
+    for (iree_host_size_t length : kLengths) {
+      length = length / pattern_length * pattern_length;
+      // Targets must be aligned to the pattern length.
+      for (iree_host_size_t misalignment = 0; misalignment < 16;
+           misalignment += pattern_length) {
+        std::vector<uint8_t> storage(2 * kGuardLength + 16 + length,
+                                     kGuardValue);
+        uint8_t* target = storage.data() + kGuardLength + misalignment;
+        iree_nontemporal_fill(target, length, pattern, pattern_length);
+        for (iree_host_size_t i = 0; i < storage.size(); ++i) {
+          const uint8_t* ptr = storage.data() + i;
+          uint8_t expected = kGuardValue;
+          if (ptr >= target && ptr < target + length) {
+            expected = pattern[(ptr - target) % pattern_length];
+          }
+          ASSERT_EQ(expected, *ptr)
+              << "pattern_length=" << pattern_length << " length=" << length
+              << " misalignment=" << misalignment << " i=" << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(NontemporalTest, Copy) {
+  for (iree_host_size_t length : kLengths) {
+    std::vector<uint8_t> source(16 + length);
+    for (iree_host_size_t i = 0; i < source.size(); ++i) {
+      source[i] = (uint8_t)(i * 7 + 3);
+    }
+    for (iree_host_size_t source_misalignment : {0, 1, 8}) {
+      for (iree_host_size_t target_misalignment : {0, 3, 8, 15}) {
+        std::vector<uint8_t> storage(2 * kGuardLength + 16 + length,
+                                     kGuardValue);
+        uint8_t* target = storage.data() + kGuardLength + target_misalignment;
+        const uint8_t* source_ptr = source.data() + source_misalignment;
+        iree_nontemporal_copy(target, source_ptr, length);
+        for (iree_host_size_t i = 0; i < storage.size(); ++i) {
+          const uint8_t* ptr = storage.data() + i;
+          uint8_t expected = kGuardValue;
+          if (ptr >= target && ptr < target + length) {
+            expected = source_ptr[ptr - target];
+          }
+          ASSERT_EQ(expected, *ptr)
+              << "length=" << length
+              << " source_misalignment=" << source_misalignment
+              << " target_misalignment=" << target_misalignment
+              << " i=" << i;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
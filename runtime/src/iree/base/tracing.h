@@ -244,6 +244,13 @@ enum {
     zone_id, file_name, file_name_length, line, function_name, \
     function_name_length, name, name_length)                   \
   IREE_TRACE_ZONE_BEGIN(zone_id)
+// Begins a new zone with a pointer to a provider-defined
+// iree_tracing_location_t. The location and the strings it references must
+// remain valid for the lifetime of the process as they may be read by the
+// tracing provider at any time. Unlike IREE_TRACE_ZONE_BEGIN_EXTERNAL no
+// strings are copied when the zone begins.
+#define IREE_TRACE_ZONE_BEGIN_LOCATION(zone_id, location) \
+  IREE_TRACE_ZONE_BEGIN(zone_id)
 
 // Ends the current zone. Must be passed the |zone_id| from the _BEGIN.
 #define IREE_TRACE_ZONE_END(zone_id) (void)(zone_id)
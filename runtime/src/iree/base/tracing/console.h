@@ -76,6 +76,23 @@ typedef struct iree_tracing_location_t {
 
 #define iree_tracing_make_zone_ctx(zone_id) (zone_id)
 
+// Initializes |out_location| to reference the given NUL-terminated strings.
+// The location and strings must remain valid for the lifetime of the process.
+static inline void iree_tracing_location_initialize(
+    const char* name, size_t name_length, const char* function_name,
+    size_t function_name_length, const char* file_name,
+    size_t file_name_length, uint32_t line, uint32_t color,
+    iree_tracing_location_t* out_location) {
+  out_location->name = name;
+  out_location->name_length = name_length;
+  out_location->function_name = function_name;
+  out_location->function_name_length = function_name_length;
+  out_location->file_name = file_name;
+  out_location->file_name_length = file_name_length;
+  out_location->line = line;
+  out_location->color = color;
+}
+
 void iree_tracing_console_initialize();
 void iree_tracing_console_deinitialize();
 
@@ -165,6 +182,9 @@ void iree_tracing_message_string_view(const char* value, size_t value_length,
       file_name, file_name_length, line, function_name, function_name_length, \
       name, name_length)
 
+#define IREE_TRACE_ZONE_BEGIN_LOCATION(zone_id, location) \
+  iree_zone_id_t zone_id = iree_tracing_zone_begin_impl((location), NULL, 0)
+
 #define IREE_TRACE_ZONE_END(zone_id) iree_tracing_zone_end(zone_id)
 
 #define IREE_RETURN_AND_END_ZONE_IF_ERROR(zone_id, ...) \
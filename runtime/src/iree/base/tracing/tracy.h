@@ -104,6 +104,20 @@ typedef struct ___tracy_source_location_data iree_tracing_location_t;
   (TracyCZoneCtx) { zone_id, 1 }
 #endif  // __cplusplus
 
+// Initializes |out_location| to reference the given NUL-terminated strings.
+// The location and strings must remain valid for the lifetime of the process.
+static inline void iree_tracing_location_initialize(
+    const char* name, size_t name_length, const char* function_name,
+    size_t function_name_length, const char* file_name,
+    size_t file_name_length, uint32_t line, uint32_t color,
+    iree_tracing_location_t* out_location) {
+  out_location->name = name;
+  out_location->function = function_name;
+  out_location->file = file_name;
+  out_location->line = line;
+  out_location->color = color;
+}
+
 IREE_MUST_USE_RESULT iree_zone_id_t
 iree_tracing_zone_begin_impl(const iree_tracing_location_t* src_loc,
                              const char* name, size_t name_length);
@@ -221,6 +235,9 @@ void iree_tracing_gpu_zone_notify(uint8_t context_id, uint16_t query_id,
       file_name, file_name_length, line, function_name, function_name_length, \
       name, name_length)
 
+#define IREE_TRACE_ZONE_BEGIN_LOCATION(zone_id, location) \
+  iree_zone_id_t zone_id = iree_tracing_zone_begin_impl((location), NULL, 0)
+
 #define IREE_TRACE_ZONE_END(zone_id) iree_tracing_zone_end(zone_id)
 
 #define IREE_RETURN_AND_END_ZONE_IF_ERROR(zone_id, ...) \
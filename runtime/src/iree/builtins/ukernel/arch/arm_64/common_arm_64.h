@@ -89,6 +89,32 @@ static inline int64x2x2_t iree_uk_neon_zip_4xi32_as_2xi64(int32x4_t a,
   return r;
 }
 
+// Loads 32 int4 values packed two per byte (see
+// IREE_UK_FLAG_MMT4D_TYPE_I8I4I32) and sign-extends them to int8.
+static inline int8x16x2_t iree_uk_neon_load_32xi4_to_32xi8(const void* src) {
+  int8x16_t bytes = vld1q_s8(src);
+  int8x16_t even = vshrq_n_s8(vshlq_n_s8(bytes, 4), 4);
+  int8x16_t odd = vshrq_n_s8(bytes, 4);
+  int8x16x2_t r;
+  r.val[0] = vzip1q_s8(even, odd);
+  r.val[1] = vzip2q_s8(even, odd);
+  return r;
+}
+
+// Loads 8 int4 values packed two per byte and converts them to float.
+static inline float32x4x2_t iree_uk_neon_load_8xi4_to_8xf32(const void* src) {
+  iree_uk_int32_t word;
+  iree_uk_memcpy(&word, src, sizeof word);
+  int32x4_t broadcast = vdupq_n_s32(word);
+  static const iree_uk_int32_t shifts[8] = {28, 24, 20, 16, 12, 8, 4, 0};
+  float32x4x2_t r;
+  r.val[0] = vcvtq_f32_s32(
+      vshrq_n_s32(vshlq_s32(broadcast, vld1q_s32(shifts + 0)), 28));
+  r.val[1] = vcvtq_f32_s32(
+      vshrq_n_s32(vshlq_s32(broadcast, vld1q_s32(shifts + 4)), 28));
+  return r;
+}
+
 static inline void iree_uk_neon_copy_8x1xi8_strided_to_unstrided(
     iree_uk_int8_t* IREE_UK_RESTRICT out_ptr,
     const iree_uk_int8_t* IREE_UK_RESTRICT in_ptr, iree_uk_index_t in_stride) {
@@ -0,0 +1,339 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
+#include "iree/builtins/ukernel/arch/arm_64/elementwise_arm_64_internal.h"
+
+// All ops here operate on uint8x16_t registers regardless of element type, so
+// that a single row loop can be shared by all of them.
+
+typedef uint8x16_t (*iree_uk_neon_binary_op_t)(uint8x16_t, uint8x16_t);
+typedef uint8x16_t (*iree_uk_neon_unary_op_t)(uint8x16_t);
+
+// Applies `op` to rows of `size_bytes` bytes. The remainder that does not fill
+// a whole register goes through zero-padded temporary registers, so ops must
+// not trap on zero lanes (true here: no integer division).
+static inline void iree_uk_neon_binary_row(iree_uk_neon_binary_op_t op,
+                                           const void* lhs, const void* rhs,
+                                           void* out,
+                                           iree_uk_index_t size_bytes) {
+  const iree_uk_uint8_t* lhs_ptr = lhs;
+  const iree_uk_uint8_t* rhs_ptr = rhs;
+  iree_uk_uint8_t* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 16 <= size_bytes; i += 16) {
+    vst1q_u8(out_ptr + i, op(vld1q_u8(lhs_ptr + i), vld1q_u8(rhs_ptr + i)));
+  }
+  if (i < size_bytes) {
+    iree_uk_index_t tail_bytes = size_bytes - i;
+    iree_uk_uint8_t buf[3][16] = {{0}};
+    iree_uk_memcpy(buf[0], lhs_ptr + i, tail_bytes);
+    iree_uk_memcpy(buf[1], rhs_ptr + i, tail_bytes);
+    vst1q_u8(buf[2], op(vld1q_u8(buf[0]), vld1q_u8(buf[1])));
+    iree_uk_memcpy(out_ptr + i, buf[2], tail_bytes);
+  }
+}
+
+static inline void iree_uk_neon_unary_row(iree_uk_neon_unary_op_t op,
+                                          const void* in, void* out,
+                                          iree_uk_index_t size_bytes) {
+  const iree_uk_uint8_t* in_ptr = in;
+  iree_uk_uint8_t* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 16 <= size_bytes; i += 16) {
+    vst1q_u8(out_ptr + i, op(vld1q_u8(in_ptr + i)));
+  }
+  if (i < size_bytes) {
+    iree_uk_index_t tail_bytes = size_bytes - i;
+    iree_uk_uint8_t buf[2][16] = {{0}};
+    iree_uk_memcpy(buf[0], in_ptr + i, tail_bytes);
+    vst1q_u8(buf[1], op(vld1q_u8(buf[0])));
+    iree_uk_memcpy(out_ptr + i, buf[1], tail_bytes);
+  }
+}
+
+// Defines the row function iree_uk_{category}_{name}_row_arm_64 applying
+// iree_uk_neon_{op}.
+#define IREE_UK_NEON_BINARY_ROW_FUNC(category, name, elem_size, op)        \
+  static void iree_uk_##category##_##name##_row_arm_64(                    \
+      const void* lhs, const void* rhs, void* out, iree_uk_index_t size) { \
+    iree_uk_neon_binary_row(iree_uk_neon_##op, lhs, rhs, out,              \
+                            size * (elem_size));                           \
+  }
+#define IREE_UK_NEON_UNARY_ROW_FUNC(category, name, elem_size, op)          \
+  static void iree_uk_##category##_##name##_row_arm_64(                     \
+      const void* in, void* out, iree_uk_index_t size) {                    \
+    iree_uk_neon_unary_row(iree_uk_neon_##op, in, out, size * (elem_size)); \
+  }
+
+//===----------------------------------------------------------------------===//
+// f32
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_NEON_F32_BINARY_OP(name, intrinsic)                          \
+  static inline uint8x16_t iree_uk_neon_##name(uint8x16_t a, uint8x16_t b) { \
+    return vreinterpretq_u8_f32(                                             \
+        intrinsic(vreinterpretq_f32_u8(a), vreinterpretq_f32_u8(b)));        \
+  }
+#define IREE_UK_NEON_F32_UNARY_OP(name, intrinsic)                   \
+  static inline uint8x16_t iree_uk_neon_##name(uint8x16_t a) {       \
+    return vreinterpretq_u8_f32(intrinsic(vreinterpretq_f32_u8(a))); \
+  }
+
+IREE_UK_NEON_F32_BINARY_OP(addf32, vaddq_f32)
+IREE_UK_NEON_F32_BINARY_OP(subf32, vsubq_f32)
+IREE_UK_NEON_F32_BINARY_OP(mulf32, vmulq_f32)
+IREE_UK_NEON_F32_BINARY_OP(divf32, vdivq_f32)
+IREE_UK_NEON_F32_UNARY_OP(absf32, vabsq_f32)
+IREE_UK_NEON_F32_UNARY_OP(negf32, vnegq_f32)
+IREE_UK_NEON_F32_UNARY_OP(floorf32, vrndmq_f32)
+IREE_UK_NEON_F32_UNARY_OP(ceilf32, vrndpq_f32)
+
+// Not vrsqrteq_f32, which is only an estimate: this has to match the
+// correctly rounded 1.0f / sqrtf(x) of the portable fallback.
+static inline uint8x16_t iree_uk_neon_rsqrtf32(uint8x16_t a) {
+  return vreinterpretq_u8_f32(
+      vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(vreinterpretq_f32_u8(a))));
+}
+
+//===----------------------------------------------------------------------===//
+// i32
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_NEON_U32_BINARY_OP(name, intrinsic)                          \
+  static inline uint8x16_t iree_uk_neon_##name(uint8x16_t a, uint8x16_t b) { \
+    return vreinterpretq_u8_u32(                                             \
+        intrinsic(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));        \
+  }
+
+IREE_UK_NEON_U32_BINARY_OP(addi32, vaddq_u32)
+IREE_UK_NEON_U32_BINARY_OP(subi32, vsubq_u32)
+IREE_UK_NEON_U32_BINARY_OP(muli32, vmulq_u32)
+
+static inline uint8x16_t iree_uk_neon_ctlzi32(uint8x16_t a) {
+  return vreinterpretq_u8_u32(vclzq_u32(vreinterpretq_u32_u8(a)));
+}
+
+//===----------------------------------------------------------------------===//
+// i8, including the bitwise ops which are independent of the element type.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_NEON_U8_BINARY_OP(name, intrinsic)                           \
+  static inline uint8x16_t iree_uk_neon_##name(uint8x16_t a, uint8x16_t b) { \
+    return intrinsic(a, b);                                                  \
+  }
+
+IREE_UK_NEON_U8_BINARY_OP(addi8, vaddq_u8)
+IREE_UK_NEON_U8_BINARY_OP(subi8, vsubq_u8)
+IREE_UK_NEON_U8_BINARY_OP(muli8, vmulq_u8)
+IREE_UK_NEON_U8_BINARY_OP(and, vandq_u8)
+IREE_UK_NEON_U8_BINARY_OP(or, vorrq_u8)
+IREE_UK_NEON_U8_BINARY_OP(xor, veorq_u8)
+
+//===----------------------------------------------------------------------===//
+// f16 and bf16: computed in f32, rounding back to nearest-even.
+//===----------------------------------------------------------------------===//
+
+typedef float32x4_t (*iree_uk_neon_f32_op_t)(float32x4_t, float32x4_t);
+
+// The f16 <-> f32 conversions are part of baseline AArch64 NEON; only
+// arithmetic directly on f16 would require the +fp16 extension.
+static inline uint8x16_t iree_uk_neon_f16_binary(iree_uk_neon_f32_op_t op,
+                                                 uint8x16_t a, uint8x16_t b) {
+  float16x8_t a_f16 = vreinterpretq_f16_u8(a);
+  float16x8_t b_f16 = vreinterpretq_f16_u8(b);
+  float32x4_t r_lo = op(vcvt_f32_f16(vget_low_f16(a_f16)),
+                        vcvt_f32_f16(vget_low_f16(b_f16)));
+  float32x4_t r_hi = op(vcvt_high_f32_f16(a_f16), vcvt_high_f32_f16(b_f16));
+  return vreinterpretq_u8_f16(vcvt_high_f16_f32(vcvt_f16_f32(r_lo), r_hi));
+}
+
+// Returns the f32 bits rounded so that their high half is the nearest-even
+// bf16. NaNs are kept NaN by setting the quiet bit, as the rounding increment
+// could otherwise carry through the exponent.
+static inline uint32x4_t iree_uk_neon_round_f32_to_bf16(float32x4_t a) {
+  uint32x4_t bits = vreinterpretq_u32_f32(a);
+  uint32x4_t lsb = vandq_u32(vshrq_n_u32(bits, 16), vdupq_n_u32(1));
+  uint32x4_t rounded = vaddq_u32(vaddq_u32(bits, vdupq_n_u32(0x7FFF)), lsb);
+  uint32x4_t nan = vorrq_u32(bits, vdupq_n_u32(0x00400000));
+  return vbslq_u32(vceqq_f32(a, a), rounded, nan);
+}
+
+static inline uint8x16_t iree_uk_neon_bf16_binary(iree_uk_neon_f32_op_t op,
+                                                  uint8x16_t a, uint8x16_t b) {
+  uint16x8_t a_u16 = vreinterpretq_u16_u8(a);
+  uint16x8_t b_u16 = vreinterpretq_u16_u8(b);
+  float32x4_t r_lo =
+      op(vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(a_u16), 16)),
+         vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(b_u16), 16)));
+  float32x4_t r_hi = op(vreinterpretq_f32_u32(vshll_high_n_u16(a_u16, 16)),
+                        vreinterpretq_f32_u32(vshll_high_n_u16(b_u16, 16)));
+  uint16x4_t r_lo_u16 = vshrn_n_u32(iree_uk_neon_round_f32_to_bf16(r_lo), 16);
+  return vreinterpretq_u8_u16(vshrn_high_n_u32(
+      r_lo_u16, iree_uk_neon_round_f32_to_bf16(r_hi), 16));
+}
+
+#define IREE_UK_NEON_F16_BINARY_OPS(name, intrinsic)                 \
+  static inline uint8x16_t iree_uk_neon_##name##f16(uint8x16_t a,    \
+                                                    uint8x16_t b) {  \
+    return iree_uk_neon_f16_binary(intrinsic, a, b);                 \
+  }                                                                  \
+  static inline uint8x16_t iree_uk_neon_##name##bf16(uint8x16_t a,   \
+                                                     uint8x16_t b) { \
+    return iree_uk_neon_bf16_binary(intrinsic, a, b);                \
+  }
+
+static inline float32x4_t iree_uk_neon_add_f32x4(float32x4_t a,
+                                                 float32x4_t b) {
+  return vaddq_f32(a, b);
+}
+static inline float32x4_t iree_uk_neon_sub_f32x4(float32x4_t a,
+                                                 float32x4_t b) {
+  return vsubq_f32(a, b);
+}
+static inline float32x4_t iree_uk_neon_mul_f32x4(float32x4_t a,
+                                                 float32x4_t b) {
+  return vmulq_f32(a, b);
+}
+static inline float32x4_t iree_uk_neon_div_f32x4(float32x4_t a,
+                                                 float32x4_t b) {
+  return vdivq_f32(a, b);
+}
+
+IREE_UK_NEON_F16_BINARY_OPS(add, iree_uk_neon_add_f32x4)
+IREE_UK_NEON_F16_BINARY_OPS(sub, iree_uk_neon_sub_f32x4)
+IREE_UK_NEON_F16_BINARY_OPS(mul, iree_uk_neon_mul_f32x4)
+IREE_UK_NEON_F16_BINARY_OPS(div, iree_uk_neon_div_f32x4)
+
+//===----------------------------------------------------------------------===//
+// Row functions and selection.
+//===----------------------------------------------------------------------===//
+
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, addf, 4, addf32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, subf, 4, subf32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, mulf, 4, mulf32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, divf, 4, divf32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, addi, 4, addi32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, subi, 4, subi32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, muli, 4, muli32)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, andi, 4, and)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, ori, 4, or)
+IREE_UK_NEON_BINARY_ROW_FUNC(x32b, xori, 4, xor)
+
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, absf, 4, absf32)
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, negf, 4, negf32)
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, floorf, 4, floorf32)
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, ceilf, 4, ceilf32)
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, rsqrtf, 4, rsqrtf32)
+IREE_UK_NEON_UNARY_ROW_FUNC(x32u, ctlz, 4, ctlzi32)
+
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, addf16, 2, addf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, subf16, 2, subf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, mulf16, 2, mulf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, divf16, 2, divf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, addbf16, 2, addbf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, subbf16, 2, subbf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, mulbf16, 2, mulbf16)
+IREE_UK_NEON_BINARY_ROW_FUNC(x16b, divbf16, 2, divbf16)
+
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, addi, 1, addi8)
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, subi, 1, subi8)
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, muli, 1, muli8)
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, andi, 1, and)
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, ori, 1, or)
+IREE_UK_NEON_BINARY_ROW_FUNC(x8b, xori, 1, xor)
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_arm_64;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_arm_64;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_arm_64;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_arm_64;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_arm_64;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_arm_64;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_arm_64;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_arm_64;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_arm_64;
+    case IREE_UK_X32B_XORI:
+      return iree_uk_x32b_xori_row_arm_64;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_unary_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_arm_64;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_arm_64;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_ctlz_row_arm_64;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_arm_64;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_arm_64;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_arm_64;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x16b_select_row_func_arm_64(
+    iree_uk_x16b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X16B_ADDBF16:
+      return iree_uk_x16b_addbf16_row_arm_64;
+    case IREE_UK_X16B_ADDF16:
+      return iree_uk_x16b_addf16_row_arm_64;
+    case IREE_UK_X16B_DIVBF16:
+      return iree_uk_x16b_divbf16_row_arm_64;
+    case IREE_UK_X16B_DIVF16:
+      return iree_uk_x16b_divf16_row_arm_64;
+    case IREE_UK_X16B_MULBF16:
+      return iree_uk_x16b_mulbf16_row_arm_64;
+    case IREE_UK_X16B_MULF16:
+      return iree_uk_x16b_mulf16_row_arm_64;
+    case IREE_UK_X16B_SUBBF16:
+      return iree_uk_x16b_subbf16_row_arm_64;
+    case IREE_UK_X16B_SUBF16:
+      return iree_uk_x16b_subf16_row_arm_64;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x8b_select_row_func_arm_64(
+    iree_uk_x8b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X8B_ADDI:
+      return iree_uk_x8b_addi_row_arm_64;
+    case IREE_UK_X8B_ANDI:
+      return iree_uk_x8b_andi_row_arm_64;
+    case IREE_UK_X8B_MULI:
+      return iree_uk_x8b_muli_row_arm_64;
+    case IREE_UK_X8B_ORI:
+      return iree_uk_x8b_ori_row_arm_64;
+    case IREE_UK_X8B_SUBI:
+      return iree_uk_x8b_subi_row_arm_64;
+    case IREE_UK_X8B_XORI:
+      return iree_uk_x8b_xori_row_arm_64;
+    default:
+      return 0;
+  }
+}
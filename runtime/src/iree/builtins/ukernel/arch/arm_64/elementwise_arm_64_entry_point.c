@@ -0,0 +1,31 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64_entry_point.h"
+#include "iree/builtins/ukernel/arch/arm_64/elementwise_arm_64_internal.h"
+
+// All elementwise row functions only need baseline NEON for now, so there is
+// no CPU feature check here.
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x32b_select_row_func_arch(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x32b_select_row_func_arm_64(opcode);
+}
+
+iree_uk_elementwise_unary_row_func_t iree_uk_x32u_select_row_func_arch(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x32u_select_row_func_arm_64(opcode);
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x16b_select_row_func_arch(
+    iree_uk_x16b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x16b_select_row_func_arm_64(opcode);
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x8b_select_row_func_arch(
+    iree_uk_x8b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x8b_select_row_func_arm_64(opcode);
+}
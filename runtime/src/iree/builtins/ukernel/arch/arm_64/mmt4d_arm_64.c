@@ -329,3 +329,128 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x1_arm_64(
   vst1q_s32(out_ptr + 4 * 14, acc14);
   vst1q_s32(out_ptr + 4 * 15, acc15);
 }
+
+void iree_uk_mmt4d_tile_f32i4f32_8x8x1_arm_64(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  float32x4_t acc0, acc1, acc2, acc3, acc4, acc5, acc6, acc7, acc8, acc9, acc10,
+      acc11, acc12, acc13, acc14, acc15;
+  if (flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    acc0 = vld1q_f32(out_ptr + 4 * 0);
+    acc1 = vld1q_f32(out_ptr + 4 * 1);
+    acc2 = vld1q_f32(out_ptr + 4 * 2);
+    acc3 = vld1q_f32(out_ptr + 4 * 3);
+    acc4 = vld1q_f32(out_ptr + 4 * 4);
+    acc5 = vld1q_f32(out_ptr + 4 * 5);
+    acc6 = vld1q_f32(out_ptr + 4 * 6);
+    acc7 = vld1q_f32(out_ptr + 4 * 7);
+    acc8 = vld1q_f32(out_ptr + 4 * 8);
+    acc9 = vld1q_f32(out_ptr + 4 * 9);
+    acc10 = vld1q_f32(out_ptr + 4 * 10);
+    acc11 = vld1q_f32(out_ptr + 4 * 11);
+    acc12 = vld1q_f32(out_ptr + 4 * 12);
+    acc13 = vld1q_f32(out_ptr + 4 * 13);
+    acc14 = vld1q_f32(out_ptr + 4 * 14);
+    acc15 = vld1q_f32(out_ptr + 4 * 15);
+  } else {
+    acc0 = vdupq_n_f32(0);
+    acc1 = vdupq_n_f32(0);
+    acc2 = vdupq_n_f32(0);
+    acc3 = vdupq_n_f32(0);
+    acc4 = vdupq_n_f32(0);
+    acc5 = vdupq_n_f32(0);
+    acc6 = vdupq_n_f32(0);
+    acc7 = vdupq_n_f32(0);
+    acc8 = vdupq_n_f32(0);
+    acc9 = vdupq_n_f32(0);
+    acc10 = vdupq_n_f32(0);
+    acc11 = vdupq_n_f32(0);
+    acc12 = vdupq_n_f32(0);
+    acc13 = vdupq_n_f32(0);
+    acc14 = vdupq_n_f32(0);
+    acc15 = vdupq_n_f32(0);
+  }
+  // Without group quantization, the whole K range is a single group and the
+  // RHS is converted as-is. Otherwise, the scale and zero-point of the current
+  // group are kept in registers, and each RHS row is dequantized once before
+  // being used in the FMAs below.
+  const bool rhs_group_quantized =
+      flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
+  const float* scales_ptr = 0;
+  const float* zero_points_ptr = 0;
+  iree_uk_int32_t group_K = K;
+  if (rhs_group_quantized) {
+    scales_ptr = (const float*)params->rhs_group_scales_buffer +
+                 params->rhs_group_offset;
+    if (params->rhs_group_zero_points_buffer) {
+      zero_points_ptr = (const float*)params->rhs_group_zero_points_buffer +
+                        params->rhs_group_offset;
+    }
+    group_K = params->rhs_group_size;  // K0 == 1.
+  }
+  float32x4_t scale0 = vdupq_n_f32(1), scale1 = vdupq_n_f32(1);
+  float32x4_t zero_point0 = vdupq_n_f32(0), zero_point1 = vdupq_n_f32(0);
+  IREE_UK_ASSUME(K >= 1);
+  for (int k = 0; k < K;) {
+    if (rhs_group_quantized) {
+      scale0 = vld1q_f32(scales_ptr + 0);
+      scale1 = vld1q_f32(scales_ptr + 4);
+      scales_ptr += 8;
+      if (zero_points_ptr) {
+        zero_point0 = vld1q_f32(zero_points_ptr + 0);
+        zero_point1 = vld1q_f32(zero_points_ptr + 4);
+        zero_points_ptr += 8;
+      }
+    }
+    int group_end = iree_uk_index_min(K, k + group_K);
+    for (; k < group_end; ++k) {
+      float32x4_t lhs0 = vld1q_f32(lhs_ptr + 0);
+      float32x4_t lhs1 = vld1q_f32(lhs_ptr + 4);
+      lhs_ptr += 8;
+      float32x4x2_t rhs = iree_uk_neon_load_8xi4_to_8xf32(rhs_ptr);
+      rhs_ptr += 4;
+      float32x4_t rhs0 = rhs.val[0];
+      float32x4_t rhs1 = rhs.val[1];
+      if (rhs_group_quantized) {
+        rhs0 = vmulq_f32(vsubq_f32(rhs0, zero_point0), scale0);
+        rhs1 = vmulq_f32(vsubq_f32(rhs1, zero_point1), scale1);
+      }
+      acc0 = vfmaq_lane_f32(acc0, rhs0, vget_low_f32(lhs0), 0);
+      acc1 = vfmaq_lane_f32(acc1, rhs1, vget_low_f32(lhs0), 0);
+      acc2 = vfmaq_lane_f32(acc2, rhs0, vget_low_f32(lhs0), 1);
+      acc3 = vfmaq_lane_f32(acc3, rhs1, vget_low_f32(lhs0), 1);
+      acc4 = vfmaq_lane_f32(acc4, rhs0, vget_high_f32(lhs0), 0);
+      acc5 = vfmaq_lane_f32(acc5, rhs1, vget_high_f32(lhs0), 0);
+      acc6 = vfmaq_lane_f32(acc6, rhs0, vget_high_f32(lhs0), 1);
+      acc7 = vfmaq_lane_f32(acc7, rhs1, vget_high_f32(lhs0), 1);
+      acc8 = vfmaq_lane_f32(acc8, rhs0, vget_low_f32(lhs1), 0);
+      acc9 = vfmaq_lane_f32(acc9, rhs1, vget_low_f32(lhs1), 0);
+      acc10 = vfmaq_lane_f32(acc10, rhs0, vget_low_f32(lhs1), 1);
+      acc11 = vfmaq_lane_f32(acc11, rhs1, vget_low_f32(lhs1), 1);
+      acc12 = vfmaq_lane_f32(acc12, rhs0, vget_high_f32(lhs1), 0);
+      acc13 = vfmaq_lane_f32(acc13, rhs1, vget_high_f32(lhs1), 0);
+      acc14 = vfmaq_lane_f32(acc14, rhs0, vget_high_f32(lhs1), 1);
+      acc15 = vfmaq_lane_f32(acc15, rhs1, vget_high_f32(lhs1), 1);
+    }
+  }
+  vst1q_f32(out_ptr + 4 * 0, acc0);
+  vst1q_f32(out_ptr + 4 * 1, acc1);
+  vst1q_f32(out_ptr + 4 * 2, acc2);
+  vst1q_f32(out_ptr + 4 * 3, acc3);
+  vst1q_f32(out_ptr + 4 * 4, acc4);
+  vst1q_f32(out_ptr + 4 * 5, acc5);
+  vst1q_f32(out_ptr + 4 * 6, acc6);
+  vst1q_f32(out_ptr + 4 * 7, acc7);
+  vst1q_f32(out_ptr + 4 * 8, acc8);
+  vst1q_f32(out_ptr + 4 * 9, acc9);
+  vst1q_f32(out_ptr + 4 * 10, acc10);
+  vst1q_f32(out_ptr + 4 * 11, acc11);
+  vst1q_f32(out_ptr + 4 * 12, acc12);
+  vst1q_f32(out_ptr + 4 * 13, acc13);
+  vst1q_f32(out_ptr + 4 * 14, acc14);
+  vst1q_f32(out_ptr + 4 * 15, acc15);
+}
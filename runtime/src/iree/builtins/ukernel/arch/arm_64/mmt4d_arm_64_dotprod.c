@@ -7,10 +7,13 @@
 #include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_internal.h"
 
-void iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod(
+// Shared implementation for i8i8i32 and i8i4i32. The int4 RHS is widened to
+// int8 in registers, so they only differ in how the RHS is loaded.
+static void iree_uk_mmt4d_tile_i8iXi32_8x8x4_arm_64_dotprod(
     void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
     const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
-    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params,
+    iree_uk_type_t rhs_type) {
   (void)params;
   const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
   const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
@@ -57,9 +60,17 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod(
     int8x16_t lhs0 = vld1q_s8(lhs_ptr + 0);
     int8x16_t lhs1 = vld1q_s8(lhs_ptr + 16);
     lhs_ptr += 32;
-    int8x16_t rhs0 = vld1q_s8(rhs_ptr + 0);
-    int8x16_t rhs1 = vld1q_s8(rhs_ptr + 16);
-    rhs_ptr += 32;
+    int8x16_t rhs0, rhs1;
+    if (rhs_type == IREE_UK_TYPE_INT_8) {
+      rhs0 = vld1q_s8(rhs_ptr + 0);
+      rhs1 = vld1q_s8(rhs_ptr + 16);
+      rhs_ptr += 32;
+    } else {
+      int8x16x2_t rhs = iree_uk_neon_load_32xi4_to_32xi8(rhs_ptr);
+      rhs0 = rhs.val[0];
+      rhs1 = rhs.val[1];
+      rhs_ptr += 16;
+    }
     acc0 = vdotq_lane_s32(acc0, rhs0, vget_low_s8(lhs0), 0);
     acc1 = vdotq_lane_s32(acc1, rhs1, vget_low_s8(lhs0), 0);
     acc2 = vdotq_lane_s32(acc2, rhs0, vget_low_s8(lhs0), 1);
@@ -94,3 +105,19 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod(
   vst1q_s32(out_ptr + 4 * 14, acc14);
   vst1q_s32(out_ptr + 4 * 15, acc15);
 }
+
+void iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x4_arm_64_dotprod(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_8);
+}
+
+void iree_uk_mmt4d_tile_i8i4i32_8x8x4_arm_64_dotprod(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x4_arm_64_dotprod(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_4);
+}
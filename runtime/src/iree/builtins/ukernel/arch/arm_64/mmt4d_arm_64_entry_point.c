@@ -36,6 +36,32 @@ iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32_8x8x4(
   return 0;
 }
 
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32_8x8x8(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_I8MM
+  if (iree_uk_cpu_supports_i8mm(params->cpu_data)) {
+    return iree_uk_mmt4d_tile_i8i4i32_8x8x8_arm_64_i8mm;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32_8x8x4(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_DOTPROD
+  if (iree_uk_cpu_supports_dotprod(params->cpu_data)) {
+    return iree_uk_mmt4d_tile_i8i4i32_8x8x4_arm_64_dotprod;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
 static iree_uk_mmt4d_tile_func_t
 iree_uk_mmt4d_select_tile_func_arm_64_f32f32f32(
     const iree_uk_mmt4d_params_t* params) {
@@ -108,6 +134,26 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(
   return 0;
 }
 
+static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32(
+    const iree_uk_mmt4d_params_t* params) {
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 4) {
+    return iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32_8x8x4(params);
+  }
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 8) {
+    return iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32_8x8x8(params);
+  }
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_f32i4f32(
+    const iree_uk_mmt4d_params_t* params) {
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
+    return iree_uk_mmt4d_tile_f32i4f32_8x8x1_arm_64;
+  }
+  return 0;
+}
+
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
     const iree_uk_mmt4d_params_t* params) {
   switch (iree_uk_mmt4d_type(params->flags)) {
@@ -123,6 +169,10 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
       return iree_uk_mmt4d_select_tile_func_arm_64_bf16bf16bf16(params);
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(params);
+    case iree_uk_mmt4d_type_i8i4i32:
+      return iree_uk_mmt4d_select_tile_func_arm_64_i8i4i32(params);
+    case iree_uk_mmt4d_type_f32i4f32:
+      return iree_uk_mmt4d_select_tile_func_arm_64_f32i4f32(params);
     default:
       IREE_UK_ASSUME_UNREACHABLE;
       return 0;
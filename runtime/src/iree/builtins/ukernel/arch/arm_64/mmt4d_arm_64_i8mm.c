@@ -27,10 +27,13 @@ static inline int32x4_t iree_uk_neon_uzp2_s32_as_s64(int32x4_t a, int32x4_t b) {
       vuzp2q_s64(vreinterpretq_s64_s32(a), vreinterpretq_s64_s32(b)));
 }
 
-void iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm_intrinsics(
+// Shared implementation for i8i8i32 and i8i4i32. The int4 RHS is widened to
+// int8 in registers, so they only differ in how the RHS is loaded.
+static void iree_uk_mmt4d_tile_i8iXi32_8x8x8_arm_64_i8mm_intrinsics(
     void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
     const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
-    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params,
+    iree_uk_type_t rhs_type) {
   (void)params;
   const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
   const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
@@ -97,11 +100,22 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm_intrinsics(
     int8x16_t lhs45 = vld1q_s8(lhs_ptr + 32);
     int8x16_t lhs67 = vld1q_s8(lhs_ptr + 48);
     lhs_ptr += 64;
-    int8x16_t rhs01 = vld1q_s8(rhs_ptr + 0);
-    int8x16_t rhs23 = vld1q_s8(rhs_ptr + 16);
-    int8x16_t rhs45 = vld1q_s8(rhs_ptr + 32);
-    int8x16_t rhs67 = vld1q_s8(rhs_ptr + 48);
-    rhs_ptr += 64;
+    int8x16_t rhs01, rhs23, rhs45, rhs67;
+    if (rhs_type == IREE_UK_TYPE_INT_8) {
+      rhs01 = vld1q_s8(rhs_ptr + 0);
+      rhs23 = vld1q_s8(rhs_ptr + 16);
+      rhs45 = vld1q_s8(rhs_ptr + 32);
+      rhs67 = vld1q_s8(rhs_ptr + 48);
+      rhs_ptr += 64;
+    } else {
+      int8x16x2_t rhs0123 = iree_uk_neon_load_32xi4_to_32xi8(rhs_ptr + 0);
+      int8x16x2_t rhs4567 = iree_uk_neon_load_32xi4_to_32xi8(rhs_ptr + 16);
+      rhs01 = rhs0123.val[0];
+      rhs23 = rhs0123.val[1];
+      rhs45 = rhs4567.val[0];
+      rhs67 = rhs4567.val[1];
+      rhs_ptr += 32;
+    }
     acc_01_01 = vmmlaq_s32(acc_01_01, lhs01, rhs01);
     acc_01_23 = vmmlaq_s32(acc_01_23, lhs01, rhs23);
     acc_01_45 = vmmlaq_s32(acc_01_45, lhs01, rhs45);
@@ -154,6 +168,22 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm_intrinsics(
   vst1q_s32(out_ptr + 8 * 7 + 4, acc_7_4567);
 }
 
+void iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm_intrinsics(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x8_arm_64_i8mm_intrinsics(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_8);
+}
+
+void iree_uk_mmt4d_tile_i8i4i32_8x8x8_arm_64_i8mm(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x8_arm_64_i8mm_intrinsics(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_4);
+}
+
 #if defined(IREE_UK_ENABLE_INLINE_ASM)
 // Compared to the intrinsics code path, this asm code has optimizations (loop
 // pipelining, 2x partial unrolling) that were introduced in #10552. An attempt
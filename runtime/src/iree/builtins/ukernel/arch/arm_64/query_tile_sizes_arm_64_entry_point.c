@@ -29,6 +29,19 @@ iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
 }
 
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_arm_64_i8i4i32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  // Same as i8i8i32: the int4 RHS is widened in registers to the same layout.
+  return iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(params);
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_arm_64_f32i4f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
 bool iree_uk_query_matmul_tile_sizes_arch(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
@@ -41,6 +54,14 @@ bool iree_uk_query_matmul_tile_sizes_arch(
     *out_matmul_tile_sizes =
         iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(params);
     return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I4I32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_arm_64_i8i4i32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32I4F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_arm_64_f32i4f32(params);
+    return true;
   } else {
     // Can't happen, validated earlier.
     IREE_UK_ASSUME_UNREACHABLE;
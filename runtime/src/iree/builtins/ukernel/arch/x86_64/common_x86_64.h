@@ -224,6 +224,26 @@ iree_uk_avx2_copy_8x16xi8_tiled_1x2_transpose_strided_to_strided(
                            r0123456701234567_3);
 }
 
+// Loads 16 int4 values packed two per byte (see
+// IREE_UK_FLAG_MMT4D_TYPE_I8I4I32) and sign-extends them to int16.
+static inline __m256i iree_uk_avx2_load_16xi4_to_16xi16(const void* src) {
+  __m128i bytes_i16 = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)src));
+  __m128i even_i16 = _mm_srai_epi16(_mm_slli_epi16(bytes_i16, 12), 12);
+  __m128i odd_i16 = _mm_srai_epi16(bytes_i16, 4);
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_unpacklo_epi16(even_i16, odd_i16)),
+      _mm_unpackhi_epi16(even_i16, odd_i16), 1);
+}
+
+// Loads 8 int4 values packed two per byte and converts them to float.
+static inline __m256 iree_uk_avx2_load_8xi4_to_8xf32(const void* src) {
+  iree_uk_int32_t word;
+  iree_uk_memcpy(&word, src, sizeof word);
+  __m256i shifted = _mm256_sllv_epi32(
+      _mm256_set1_epi32(word), _mm256_setr_epi32(28, 24, 20, 16, 12, 8, 4, 0));
+  return _mm256_cvtepi32_ps(_mm256_srai_epi32(shifted, 28));
+}
+
 #if defined(__AVX512F__)
 
 static inline __m512i iree_uk_avx512_loadu_4x128(const void* src0,
@@ -406,6 +426,34 @@ iree_uk_avx512_copy_16x16xi8_tiled_1x2_transpose_strided_to_strided(
       r0123456701234567_3);
 }
 
+// Loads 32 int4 values packed two per byte and sign-extends them to int16.
+static inline __m512i iree_uk_avx512_load_32xi4_to_32xi16(const void* src) {
+  __m256i bytes_i16 =
+      _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)src));
+  __m256i even_i16 = _mm256_srai_epi16(_mm256_slli_epi16(bytes_i16, 12), 12);
+  __m256i odd_i16 = _mm256_srai_epi16(bytes_i16, 4);
+  // unpack{lo,hi} interleave within 128-bit lanes, so the results hold the
+  // values 0-7,16-23 and 8-15,24-31 respectively.
+  __m256i lo = _mm256_unpacklo_epi16(even_i16, odd_i16);
+  __m256i hi = _mm256_unpackhi_epi16(even_i16, odd_i16);
+  return _mm512_inserti64x4(
+      _mm512_castsi256_si512(_mm256_permute2x128_si256(lo, hi, 0x20)),
+      _mm256_permute2x128_si256(lo, hi, 0x31), 1);
+}
+
+// Loads 16 int4 values packed two per byte and converts them to float.
+static inline __m512 iree_uk_avx512_load_16xi4_to_16xf32(const void* src) {
+  iree_uk_int32_t words[2];
+  iree_uk_memcpy(words, src, sizeof words);
+  __m512i broadcast = _mm512_inserti64x4(
+      _mm512_castsi256_si512(_mm256_set1_epi32(words[0])),
+      _mm256_set1_epi32(words[1]), 1);
+  __m512i shifted = _mm512_sllv_epi32(
+      broadcast, _mm512_setr_epi32(28, 24, 20, 16, 12, 8, 4, 0, 28, 24, 20, 16,
+                                   12, 8, 4, 0));
+  return _mm512_cvtepi32_ps(_mm512_srai_epi32(shifted, 28));
+}
+
 #endif  // defined (__AVX512F__)
 
 #endif  // defined(__AVX2__)
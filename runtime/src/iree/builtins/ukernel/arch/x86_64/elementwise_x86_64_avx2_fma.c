@@ -0,0 +1,373 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64_internal.h"
+
+// All ops here operate on __m256i registers regardless of element type, so
+// that a single row loop can be shared by all of them. The float ops bitcast
+// to and from __m256.
+
+typedef __m256i (*iree_uk_avx2_binary_op_t)(__m256i, __m256i);
+typedef __m256i (*iree_uk_avx2_unary_op_t)(__m256i);
+
+// Applies `op` to rows of `size_bytes` bytes. The remainder that does not fill
+// a whole register goes through zero-padded temporary registers, so ops must
+// not trap on zero lanes (true here: no integer division).
+static inline void iree_uk_avx2_binary_row(iree_uk_avx2_binary_op_t op,
+                                           const void* lhs, const void* rhs,
+                                           void* out,
+                                           iree_uk_index_t size_bytes) {
+  const char* lhs_ptr = lhs;
+  const char* rhs_ptr = rhs;
+  char* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 32 <= size_bytes; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(lhs_ptr + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(rhs_ptr + i));
+    _mm256_storeu_si256((__m256i*)(out_ptr + i), op(a, b));
+  }
+  if (i < size_bytes) {
+    iree_uk_index_t tail_bytes = size_bytes - i;
+    IREE_UK_ATTRIBUTE_ALIGNED(32) char buf[3][32] = {{0}};
+    iree_uk_memcpy(buf[0], lhs_ptr + i, tail_bytes);
+    iree_uk_memcpy(buf[1], rhs_ptr + i, tail_bytes);
+    __m256i a = _mm256_load_si256((const __m256i*)buf[0]);
+    __m256i b = _mm256_load_si256((const __m256i*)buf[1]);
+    _mm256_store_si256((__m256i*)buf[2], op(a, b));
+    iree_uk_memcpy(out_ptr + i, buf[2], tail_bytes);
+  }
+}
+
+static inline void iree_uk_avx2_unary_row(iree_uk_avx2_unary_op_t op,
+                                          const void* in, void* out,
+                                          iree_uk_index_t size_bytes) {
+  const char* in_ptr = in;
+  char* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 32 <= size_bytes; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(in_ptr + i));
+    _mm256_storeu_si256((__m256i*)(out_ptr + i), op(a));
+  }
+  if (i < size_bytes) {
+    iree_uk_index_t tail_bytes = size_bytes - i;
+    IREE_UK_ATTRIBUTE_ALIGNED(32) char buf[2][32] = {{0}};
+    iree_uk_memcpy(buf[0], in_ptr + i, tail_bytes);
+    __m256i a = _mm256_load_si256((const __m256i*)buf[0]);
+    _mm256_store_si256((__m256i*)buf[1], op(a));
+    iree_uk_memcpy(out_ptr + i, buf[1], tail_bytes);
+  }
+}
+
+// Defines the row function iree_uk_{category}_{name}_row_x86_64_avx2_fma
+// applying iree_uk_avx2_{op}.
+#define IREE_UK_AVX2_BINARY_ROW_FUNC(category, name, elem_size, op)        \
+  static void iree_uk_##category##_##name##_row_x86_64_avx2_fma(           \
+      const void* lhs, const void* rhs, void* out, iree_uk_index_t size) { \
+    iree_uk_avx2_binary_row(iree_uk_avx2_##op, lhs, rhs, out,              \
+                            size * (elem_size));                           \
+  }
+#define IREE_UK_AVX2_UNARY_ROW_FUNC(category, name, elem_size, op)          \
+  static void iree_uk_##category##_##name##_row_x86_64_avx2_fma(            \
+      const void* in, void* out, iree_uk_index_t size) {                    \
+    iree_uk_avx2_unary_row(iree_uk_avx2_##op, in, out, size * (elem_size)); \
+  }
+
+//===----------------------------------------------------------------------===//
+// f32
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_AVX2_F32_BINARY_OP(name, intrinsic)                 \
+  static inline __m256i iree_uk_avx2_##name(__m256i a, __m256i b) { \
+    return _mm256_castps_si256(                                     \
+        intrinsic(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); \
+  }
+
+IREE_UK_AVX2_F32_BINARY_OP(addf32, _mm256_add_ps)
+IREE_UK_AVX2_F32_BINARY_OP(subf32, _mm256_sub_ps)
+IREE_UK_AVX2_F32_BINARY_OP(mulf32, _mm256_mul_ps)
+IREE_UK_AVX2_F32_BINARY_OP(divf32, _mm256_div_ps)
+
+static inline __m256i iree_uk_avx2_absf32(__m256i a) {
+  return _mm256_and_si256(a, _mm256_set1_epi32(0x7FFFFFFF));
+}
+
+static inline __m256i iree_uk_avx2_negf32(__m256i a) {
+  return _mm256_xor_si256(a, _mm256_set1_epi32(0x80000000));
+}
+
+static inline __m256i iree_uk_avx2_floorf32(__m256i a) {
+  return _mm256_castps_si256(_mm256_round_ps(
+      _mm256_castsi256_ps(a), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+
+static inline __m256i iree_uk_avx2_ceilf32(__m256i a) {
+  return _mm256_castps_si256(_mm256_round_ps(
+      _mm256_castsi256_ps(a), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+}
+
+// Not _mm256_rsqrt_ps, which is only an approximation: this has to match the
+// correctly rounded 1.0f / sqrtf(x) of the portable fallback.
+static inline __m256i iree_uk_avx2_rsqrtf32(__m256i a) {
+  return _mm256_castps_si256(_mm256_div_ps(
+      _mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_castsi256_ps(a))));
+}
+
+//===----------------------------------------------------------------------===//
+// i32
+//===----------------------------------------------------------------------===//
+
+static inline __m256i iree_uk_avx2_addi32(__m256i a, __m256i b) {
+  return _mm256_add_epi32(a, b);
+}
+
+static inline __m256i iree_uk_avx2_subi32(__m256i a, __m256i b) {
+  return _mm256_sub_epi32(a, b);
+}
+
+static inline __m256i iree_uk_avx2_muli32(__m256i a, __m256i b) {
+  return _mm256_mullo_epi32(a, b);
+}
+
+static inline __m256i iree_uk_avx2_shli32(__m256i a, __m256i b) {
+  return _mm256_sllv_epi32(a, b);
+}
+
+static inline __m256i iree_uk_avx2_shrsi32(__m256i a, __m256i b) {
+  return _mm256_srav_epi32(a, b);
+}
+
+static inline __m256i iree_uk_avx2_shrui32(__m256i a, __m256i b) {
+  return _mm256_srlv_epi32(a, b);
+}
+
+//===----------------------------------------------------------------------===//
+// Bitwise ops, independent of the element type.
+//===----------------------------------------------------------------------===//
+
+static inline __m256i iree_uk_avx2_and(__m256i a, __m256i b) {
+  return _mm256_and_si256(a, b);
+}
+
+static inline __m256i iree_uk_avx2_or(__m256i a, __m256i b) {
+  return _mm256_or_si256(a, b);
+}
+
+static inline __m256i iree_uk_avx2_xor(__m256i a, __m256i b) {
+  return _mm256_xor_si256(a, b);
+}
+
+//===----------------------------------------------------------------------===//
+// i8
+//===----------------------------------------------------------------------===//
+
+static inline __m256i iree_uk_avx2_addi8(__m256i a, __m256i b) {
+  return _mm256_add_epi8(a, b);
+}
+
+static inline __m256i iree_uk_avx2_subi8(__m256i a, __m256i b) {
+  return _mm256_sub_epi8(a, b);
+}
+
+//===----------------------------------------------------------------------===//
+// f16 and bf16: computed in f32, rounding back to nearest-even.
+//===----------------------------------------------------------------------===//
+
+typedef __m256 (*iree_uk_avx2_f32_op_t)(__m256, __m256);
+
+static inline __m256i iree_uk_avx2_f16_binary(iree_uk_avx2_f32_op_t op,
+                                              __m256i a, __m256i b) {
+  __m256 a_lo = _mm256_cvtph_ps(_mm256_castsi256_si128(a));
+  __m256 a_hi = _mm256_cvtph_ps(_mm256_extracti128_si256(a, 1));
+  __m256 b_lo = _mm256_cvtph_ps(_mm256_castsi256_si128(b));
+  __m256 b_hi = _mm256_cvtph_ps(_mm256_extracti128_si256(b, 1));
+  __m128i r_lo = _mm256_cvtps_ph(op(a_lo, b_lo), _MM_FROUND_TO_NEAREST_INT);
+  __m128i r_hi = _mm256_cvtps_ph(op(a_hi, b_hi), _MM_FROUND_TO_NEAREST_INT);
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(r_lo), r_hi, 1);
+}
+
+static inline __m256 iree_uk_avx2_bf16_to_f32(__m128i a) {
+  return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(a), 16));
+}
+
+// Returns the bf16 bits in the low half of each 32-bit lane. NaNs are kept
+// NaN by setting the quiet bit, as the rounding increment could otherwise
+// carry through the exponent.
+static inline __m256i iree_uk_avx2_f32_to_bf16(__m256 a) {
+  __m256i bits = _mm256_castps_si256(a);
+  __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16),
+                                 _mm256_set1_epi32(1));
+  __m256i rounded = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(bits, _mm256_set1_epi32(0x7FFF)), lsb),
+      16);
+  __m256i nan = _mm256_or_si256(_mm256_srli_epi32(bits, 16),
+                                _mm256_set1_epi32(0x40));
+  __m256 is_nan = _mm256_cmp_ps(a, a, _CMP_UNORD_Q);
+  return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(rounded),
+                                              _mm256_castsi256_ps(nan),
+                                              is_nan));
+}
+
+static inline __m256i iree_uk_avx2_bf16_binary(iree_uk_avx2_f32_op_t op,
+                                               __m256i a, __m256i b) {
+  __m256 a_lo = iree_uk_avx2_bf16_to_f32(_mm256_castsi256_si128(a));
+  __m256 a_hi = iree_uk_avx2_bf16_to_f32(_mm256_extracti128_si256(a, 1));
+  __m256 b_lo = iree_uk_avx2_bf16_to_f32(_mm256_castsi256_si128(b));
+  __m256 b_hi = iree_uk_avx2_bf16_to_f32(_mm256_extracti128_si256(b, 1));
+  __m256i r_lo = iree_uk_avx2_f32_to_bf16(op(a_lo, b_lo));
+  __m256i r_hi = iree_uk_avx2_f32_to_bf16(op(a_hi, b_hi));
+  // The pack interleaves 128-bit lanes, which the permute undoes.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(r_lo, r_hi), 0xD8);
+}
+
+#define IREE_UK_AVX2_F16_BINARY_OPS(name, intrinsic)                      \
+  static inline __m256 iree_uk_avx2_##name##_ps(__m256 a, __m256 b) {     \
+    return intrinsic(a, b);                                               \
+  }                                                                       \
+  static inline __m256i iree_uk_avx2_##name##f16(__m256i a, __m256i b) {  \
+    return iree_uk_avx2_f16_binary(iree_uk_avx2_##name##_ps, a, b);       \
+  }                                                                       \
+  static inline __m256i iree_uk_avx2_##name##bf16(__m256i a, __m256i b) { \
+    return iree_uk_avx2_bf16_binary(iree_uk_avx2_##name##_ps, a, b);      \
+  }
+
+IREE_UK_AVX2_F16_BINARY_OPS(add, _mm256_add_ps)
+IREE_UK_AVX2_F16_BINARY_OPS(sub, _mm256_sub_ps)
+IREE_UK_AVX2_F16_BINARY_OPS(mul, _mm256_mul_ps)
+IREE_UK_AVX2_F16_BINARY_OPS(div, _mm256_div_ps)
+
+//===----------------------------------------------------------------------===//
+// Row functions and selection.
+//===----------------------------------------------------------------------===//
+
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, addf, 4, addf32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, subf, 4, subf32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, mulf, 4, mulf32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, divf, 4, divf32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, addi, 4, addi32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, subi, 4, subi32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, muli, 4, muli32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, shli, 4, shli32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, shrsi, 4, shrsi32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, shrui, 4, shrui32)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, andi, 4, and)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, ori, 4, or)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x32b, xori, 4, xor)
+
+IREE_UK_AVX2_UNARY_ROW_FUNC(x32u, absf, 4, absf32)
+IREE_UK_AVX2_UNARY_ROW_FUNC(x32u, negf, 4, negf32)
+IREE_UK_AVX2_UNARY_ROW_FUNC(x32u, floorf, 4, floorf32)
+IREE_UK_AVX2_UNARY_ROW_FUNC(x32u, ceilf, 4, ceilf32)
+IREE_UK_AVX2_UNARY_ROW_FUNC(x32u, rsqrtf, 4, rsqrtf32)
+
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, addf16, 2, addf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, subf16, 2, subf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, mulf16, 2, mulf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, divf16, 2, divf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, addbf16, 2, addbf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, subbf16, 2, subbf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, mulbf16, 2, mulbf16)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x16b, divbf16, 2, divbf16)
+
+IREE_UK_AVX2_BINARY_ROW_FUNC(x8b, addi, 1, addi8)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x8b, subi, 1, subi8)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x8b, andi, 1, and)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x8b, ori, 1, or)
+IREE_UK_AVX2_BINARY_ROW_FUNC(x8b, xori, 1, xor)
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func_x86_64_avx2_fma(iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_shli_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_shrsi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_shrui_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_XORI:
+      return iree_uk_x32b_xori_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func_x86_64_avx2_fma(iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func_x86_64_avx2_fma(iree_uk_x16b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X16B_ADDBF16:
+      return iree_uk_x16b_addbf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_ADDF16:
+      return iree_uk_x16b_addf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_DIVBF16:
+      return iree_uk_x16b_divbf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_DIVF16:
+      return iree_uk_x16b_divf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_MULBF16:
+      return iree_uk_x16b_mulbf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_MULF16:
+      return iree_uk_x16b_mulf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_SUBBF16:
+      return iree_uk_x16b_subbf16_row_x86_64_avx2_fma;
+    case IREE_UK_X16B_SUBF16:
+      return iree_uk_x16b_subf16_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func_x86_64_avx2_fma(iree_uk_x8b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X8B_ADDI:
+      return iree_uk_x8b_addi_row_x86_64_avx2_fma;
+    case IREE_UK_X8B_ANDI:
+      return iree_uk_x8b_andi_row_x86_64_avx2_fma;
+    case IREE_UK_X8B_ORI:
+      return iree_uk_x8b_ori_row_x86_64_avx2_fma;
+    case IREE_UK_X8B_SUBI:
+      return iree_uk_x8b_subi_row_x86_64_avx2_fma;
+    case IREE_UK_X8B_XORI:
+      return iree_uk_x8b_xori_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,372 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64_internal.h"
+
+// Same structure as the AVX2 file, with 512-bit registers. The remainder of
+// each row is handled with AVX-512BW byte-masked loads and stores.
+
+typedef __m512i (*iree_uk_avx512_binary_op_t)(__m512i, __m512i);
+typedef __m512i (*iree_uk_avx512_unary_op_t)(__m512i);
+
+static inline __mmask64 iree_uk_avx512_tail_mask(iree_uk_index_t tail_bytes) {
+  return ((__mmask64)1 << tail_bytes) - 1;
+}
+
+// Applies `op` to rows of `size_bytes` bytes. Masked-off lanes are zero, so
+// ops must not trap on zero lanes (true here: no integer division).
+static inline void iree_uk_avx512_binary_row(iree_uk_avx512_binary_op_t op,
+                                             const void* lhs, const void* rhs,
+                                             void* out,
+                                             iree_uk_index_t size_bytes) {
+  const char* lhs_ptr = lhs;
+  const char* rhs_ptr = rhs;
+  char* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 64 <= size_bytes; i += 64) {
+    __m512i a = _mm512_loadu_si512(lhs_ptr + i);
+    __m512i b = _mm512_loadu_si512(rhs_ptr + i);
+    _mm512_storeu_si512(out_ptr + i, op(a, b));
+  }
+  if (i < size_bytes) {
+    __mmask64 mask = iree_uk_avx512_tail_mask(size_bytes - i);
+    __m512i a = _mm512_maskz_loadu_epi8(mask, lhs_ptr + i);
+    __m512i b = _mm512_maskz_loadu_epi8(mask, rhs_ptr + i);
+    _mm512_mask_storeu_epi8(out_ptr + i, mask, op(a, b));
+  }
+}
+
+static inline void iree_uk_avx512_unary_row(iree_uk_avx512_unary_op_t op,
+                                            const void* in, void* out,
+                                            iree_uk_index_t size_bytes) {
+  const char* in_ptr = in;
+  char* out_ptr = out;
+  iree_uk_index_t i = 0;
+  for (; i + 64 <= size_bytes; i += 64) {
+    __m512i a = _mm512_loadu_si512(in_ptr + i);
+    _mm512_storeu_si512(out_ptr + i, op(a));
+  }
+  if (i < size_bytes) {
+    __mmask64 mask = iree_uk_avx512_tail_mask(size_bytes - i);
+    __m512i a = _mm512_maskz_loadu_epi8(mask, in_ptr + i);
+    _mm512_mask_storeu_epi8(out_ptr + i, mask, op(a));
+  }
+}
+
+// Defines the row function iree_uk_{category}_{name}_row_x86_64_avx512_base
+// applying iree_uk_avx512_{op}.
+#define IREE_UK_AVX512_BINARY_ROW_FUNC(category, name, elem_size, op)      \
+  static void iree_uk_##category##_##name##_row_x86_64_avx512_base(        \
+      const void* lhs, const void* rhs, void* out, iree_uk_index_t size) { \
+    iree_uk_avx512_binary_row(iree_uk_avx512_##op, lhs, rhs, out,          \
+                              size * (elem_size));                         \
+  }
+#define IREE_UK_AVX512_UNARY_ROW_FUNC(category, name, elem_size, op) \
+  static void iree_uk_##category##_##name##_row_x86_64_avx512_base(  \
+      const void* in, void* out, iree_uk_index_t size) {             \
+    iree_uk_avx512_unary_row(iree_uk_avx512_##op, in, out,           \
+                             size * (elem_size));                    \
+  }
+
+//===----------------------------------------------------------------------===//
+// f32
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_AVX512_F32_BINARY_OP(name, intrinsic)                 \
+  static inline __m512i iree_uk_avx512_##name(__m512i a, __m512i b) { \
+    return _mm512_castps_si512(                                       \
+        intrinsic(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b)));   \
+  }
+
+IREE_UK_AVX512_F32_BINARY_OP(addf32, _mm512_add_ps)
+IREE_UK_AVX512_F32_BINARY_OP(subf32, _mm512_sub_ps)
+IREE_UK_AVX512_F32_BINARY_OP(mulf32, _mm512_mul_ps)
+IREE_UK_AVX512_F32_BINARY_OP(divf32, _mm512_div_ps)
+
+static inline __m512i iree_uk_avx512_absf32(__m512i a) {
+  return _mm512_and_si512(a, _mm512_set1_epi32(0x7FFFFFFF));
+}
+
+static inline __m512i iree_uk_avx512_negf32(__m512i a) {
+  return _mm512_xor_si512(a, _mm512_set1_epi32(0x80000000));
+}
+
+static inline __m512i iree_uk_avx512_floorf32(__m512i a) {
+  return _mm512_castps_si512(_mm512_roundscale_ps(
+      _mm512_castsi512_ps(a), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+
+static inline __m512i iree_uk_avx512_ceilf32(__m512i a) {
+  return _mm512_castps_si512(_mm512_roundscale_ps(
+      _mm512_castsi512_ps(a), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+}
+
+// Not _mm512_rsqrt14_ps, which is only an approximation: this has to match
+// the correctly rounded 1.0f / sqrtf(x) of the portable fallback.
+static inline __m512i iree_uk_avx512_rsqrtf32(__m512i a) {
+  return _mm512_castps_si512(_mm512_div_ps(
+      _mm512_set1_ps(1.0f), _mm512_sqrt_ps(_mm512_castsi512_ps(a))));
+}
+
+//===----------------------------------------------------------------------===//
+// i32
+//===----------------------------------------------------------------------===//
+
+static inline __m512i iree_uk_avx512_addi32(__m512i a, __m512i b) {
+  return _mm512_add_epi32(a, b);
+}
+
+static inline __m512i iree_uk_avx512_subi32(__m512i a, __m512i b) {
+  return _mm512_sub_epi32(a, b);
+}
+
+static inline __m512i iree_uk_avx512_muli32(__m512i a, __m512i b) {
+  return _mm512_mullo_epi32(a, b);
+}
+
+static inline __m512i iree_uk_avx512_shli32(__m512i a, __m512i b) {
+  return _mm512_sllv_epi32(a, b);
+}
+
+static inline __m512i iree_uk_avx512_shrsi32(__m512i a, __m512i b) {
+  return _mm512_srav_epi32(a, b);
+}
+
+static inline __m512i iree_uk_avx512_shrui32(__m512i a, __m512i b) {
+  return _mm512_srlv_epi32(a, b);
+}
+
+// AVX-512CD, part of the base feature set here.
+static inline __m512i iree_uk_avx512_ctlzi32(__m512i a) {
+  return _mm512_lzcnt_epi32(a);
+}
+
+//===----------------------------------------------------------------------===//
+// Bitwise ops, independent of the element type.
+//===----------------------------------------------------------------------===//
+
+static inline __m512i iree_uk_avx512_and(__m512i a, __m512i b) {
+  return _mm512_and_si512(a, b);
+}
+
+static inline __m512i iree_uk_avx512_or(__m512i a, __m512i b) {
+  return _mm512_or_si512(a, b);
+}
+
+static inline __m512i iree_uk_avx512_xor(__m512i a, __m512i b) {
+  return _mm512_xor_si512(a, b);
+}
+
+//===----------------------------------------------------------------------===//
+// i8
+//===----------------------------------------------------------------------===//
+
+static inline __m512i iree_uk_avx512_addi8(__m512i a, __m512i b) {
+  return _mm512_add_epi8(a, b);
+}
+
+static inline __m512i iree_uk_avx512_subi8(__m512i a, __m512i b) {
+  return _mm512_sub_epi8(a, b);
+}
+
+//===----------------------------------------------------------------------===//
+// f16 and bf16: computed in f32, rounding back to nearest-even.
+//===----------------------------------------------------------------------===//
+
+typedef __m512 (*iree_uk_avx512_f32_op_t)(__m512, __m512);
+
+static inline __m512i iree_uk_avx512_f16_binary(iree_uk_avx512_f32_op_t op,
+                                                __m512i a, __m512i b) {
+  __m512 a_lo = _mm512_cvtph_ps(_mm512_castsi512_si256(a));
+  __m512 a_hi = _mm512_cvtph_ps(_mm512_extracti64x4_epi64(a, 1));
+  __m512 b_lo = _mm512_cvtph_ps(_mm512_castsi512_si256(b));
+  __m512 b_hi = _mm512_cvtph_ps(_mm512_extracti64x4_epi64(b, 1));
+  __m256i r_lo = _mm512_cvtps_ph(op(a_lo, b_lo), _MM_FROUND_TO_NEAREST_INT);
+  __m256i r_hi = _mm512_cvtps_ph(op(a_hi, b_hi), _MM_FROUND_TO_NEAREST_INT);
+  return _mm512_inserti64x4(_mm512_castsi256_si512(r_lo), r_hi, 1);
+}
+
+static inline __m512 iree_uk_avx512_bf16_to_f32(__m256i a) {
+  return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(a), 16));
+}
+
+// See iree_uk_avx2_f32_to_bf16. Here the narrowing is a plain truncation.
+static inline __m256i iree_uk_avx512_f32_to_bf16(__m512 a) {
+  __m512i bits = _mm512_castps_si512(a);
+  __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(bits, 16),
+                                 _mm512_set1_epi32(1));
+  __m512i rounded = _mm512_srli_epi32(
+      _mm512_add_epi32(_mm512_add_epi32(bits, _mm512_set1_epi32(0x7FFF)), lsb),
+      16);
+  __m512i nan = _mm512_or_si512(_mm512_srli_epi32(bits, 16),
+                                _mm512_set1_epi32(0x40));
+  __mmask16 is_nan = _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q);
+  return _mm512_cvtepi32_epi16(_mm512_mask_blend_epi32(is_nan, rounded, nan));
+}
+
+static inline __m512i iree_uk_avx512_bf16_binary(iree_uk_avx512_f32_op_t op,
+                                                 __m512i a, __m512i b) {
+  __m512 a_lo = iree_uk_avx512_bf16_to_f32(_mm512_castsi512_si256(a));
+  __m512 a_hi = iree_uk_avx512_bf16_to_f32(_mm512_extracti64x4_epi64(a, 1));
+  __m512 b_lo = iree_uk_avx512_bf16_to_f32(_mm512_castsi512_si256(b));
+  __m512 b_hi = iree_uk_avx512_bf16_to_f32(_mm512_extracti64x4_epi64(b, 1));
+  __m256i r_lo = iree_uk_avx512_f32_to_bf16(op(a_lo, b_lo));
+  __m256i r_hi = iree_uk_avx512_f32_to_bf16(op(a_hi, b_hi));
+  return _mm512_inserti64x4(_mm512_castsi256_si512(r_lo), r_hi, 1);
+}
+
+#define IREE_UK_AVX512_F16_BINARY_OPS(name, intrinsic)                      \
+  static inline __m512 iree_uk_avx512_##name##_ps(__m512 a, __m512 b) {     \
+    return intrinsic(a, b);                                                 \
+  }                                                                         \
+  static inline __m512i iree_uk_avx512_##name##f16(__m512i a, __m512i b) {  \
+    return iree_uk_avx512_f16_binary(iree_uk_avx512_##name##_ps, a, b);     \
+  }                                                                         \
+  static inline __m512i iree_uk_avx512_##name##bf16(__m512i a, __m512i b) { \
+    return iree_uk_avx512_bf16_binary(iree_uk_avx512_##name##_ps, a, b);    \
+  }
+
+IREE_UK_AVX512_F16_BINARY_OPS(add, _mm512_add_ps)
+IREE_UK_AVX512_F16_BINARY_OPS(sub, _mm512_sub_ps)
+IREE_UK_AVX512_F16_BINARY_OPS(mul, _mm512_mul_ps)
+IREE_UK_AVX512_F16_BINARY_OPS(div, _mm512_div_ps)
+
+//===----------------------------------------------------------------------===//
+// Row functions and selection.
+//===----------------------------------------------------------------------===//
+
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, addf, 4, addf32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, subf, 4, subf32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, mulf, 4, mulf32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, divf, 4, divf32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, addi, 4, addi32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, subi, 4, subi32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, muli, 4, muli32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, shli, 4, shli32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, shrsi, 4, shrsi32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, shrui, 4, shrui32)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, andi, 4, and)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, ori, 4, or)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x32b, xori, 4, xor)
+
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, absf, 4, absf32)
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, negf, 4, negf32)
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, floorf, 4, floorf32)
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, ceilf, 4, ceilf32)
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, rsqrtf, 4, rsqrtf32)
+IREE_UK_AVX512_UNARY_ROW_FUNC(x32u, ctlz, 4, ctlzi32)
+
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, addf16, 2, addf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, subf16, 2, subf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, mulf16, 2, mulf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, divf16, 2, divf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, addbf16, 2, addbf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, subbf16, 2, subbf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, mulbf16, 2, mulbf16)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x16b, divbf16, 2, divbf16)
+
+IREE_UK_AVX512_BINARY_ROW_FUNC(x8b, addi, 1, addi8)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x8b, subi, 1, subi8)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x8b, andi, 1, and)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x8b, ori, 1, or)
+IREE_UK_AVX512_BINARY_ROW_FUNC(x8b, xori, 1, xor)
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func_x86_64_avx512_base(iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_x86_64_avx512_base;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_x86_64_avx512_base;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_x86_64_avx512_base;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_x86_64_avx512_base;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_x86_64_avx512_base;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_x86_64_avx512_base;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_x86_64_avx512_base;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_shli_row_x86_64_avx512_base;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_shrsi_row_x86_64_avx512_base;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_shrui_row_x86_64_avx512_base;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_x86_64_avx512_base;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_x86_64_avx512_base;
+    case IREE_UK_X32B_XORI:
+      return iree_uk_x32b_xori_row_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func_x86_64_avx512_base(iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_x86_64_avx512_base;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_x86_64_avx512_base;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_ctlz_row_x86_64_avx512_base;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_x86_64_avx512_base;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_x86_64_avx512_base;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func_x86_64_avx512_base(iree_uk_x16b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X16B_ADDBF16:
+      return iree_uk_x16b_addbf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_ADDF16:
+      return iree_uk_x16b_addf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_DIVBF16:
+      return iree_uk_x16b_divbf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_DIVF16:
+      return iree_uk_x16b_divf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_MULBF16:
+      return iree_uk_x16b_mulbf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_MULF16:
+      return iree_uk_x16b_mulf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_SUBBF16:
+      return iree_uk_x16b_subbf16_row_x86_64_avx512_base;
+    case IREE_UK_X16B_SUBF16:
+      return iree_uk_x16b_subf16_row_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func_x86_64_avx512_base(iree_uk_x8b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X8B_ADDI:
+      return iree_uk_x8b_addi_row_x86_64_avx512_base;
+    case IREE_UK_X8B_ANDI:
+      return iree_uk_x8b_andi_row_x86_64_avx512_base;
+    case IREE_UK_X8B_ORI:
+      return iree_uk_x8b_ori_row_x86_64_avx512_base;
+    case IREE_UK_X8B_SUBI:
+      return iree_uk_x8b_subi_row_x86_64_avx512_base;
+    case IREE_UK_X8B_XORI:
+      return iree_uk_x8b_xori_row_x86_64_avx512_base;
+    default:
+      return 0;
+  }
+}
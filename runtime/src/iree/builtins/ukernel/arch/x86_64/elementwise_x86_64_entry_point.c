@@ -0,0 +1,79 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64_entry_point.h"
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64_internal.h"
+
+// Each selection below tries the widest ISA first, falling through to the
+// next one when that ISA has no implementation for the opcode.
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x32b_select_row_func_arch(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_elementwise_binary_row_func_t func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (iree_uk_cpu_supports_avx512_base(cpu_data)) {
+    func = iree_uk_x32b_select_row_func_x86_64_avx512_base(opcode);
+    if (func) return func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (iree_uk_cpu_supports_avx2_fma(cpu_data)) {
+    func = iree_uk_x32b_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  return func;
+}
+
+iree_uk_elementwise_unary_row_func_t iree_uk_x32u_select_row_func_arch(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_elementwise_unary_row_func_t func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (iree_uk_cpu_supports_avx512_base(cpu_data)) {
+    func = iree_uk_x32u_select_row_func_x86_64_avx512_base(opcode);
+    if (func) return func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (iree_uk_cpu_supports_avx2_fma(cpu_data)) {
+    func = iree_uk_x32u_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  return func;
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x16b_select_row_func_arch(
+    iree_uk_x16b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_elementwise_binary_row_func_t func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (iree_uk_cpu_supports_avx512_base(cpu_data)) {
+    func = iree_uk_x16b_select_row_func_x86_64_avx512_base(opcode);
+    if (func) return func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (iree_uk_cpu_supports_avx2_fma(cpu_data)) {
+    func = iree_uk_x16b_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  return func;
+}
+
+iree_uk_elementwise_binary_row_func_t iree_uk_x8b_select_row_func_arch(
+    iree_uk_x8b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  iree_uk_elementwise_binary_row_func_t func = 0;
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (iree_uk_cpu_supports_avx512_base(cpu_data)) {
+    func = iree_uk_x8b_select_row_func_x86_64_avx512_base(opcode);
+    if (func) return func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (iree_uk_cpu_supports_avx2_fma(cpu_data)) {
+    func = iree_uk_x8b_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#endif
+  return func;
+}
@@ -0,0 +1,35 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_INTERNAL_H_
+
+#include "iree/builtins/ukernel/elementwise_internal.h"
+
+// Per-ISA row function selection, returning NULL for opcodes that have no
+// implementation for that ISA. Since these are defined in translation units
+// compiled for that ISA, they must only be called once the CPU is known to
+// support it.
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func_x86_64_avx2_fma(iree_uk_x32b_opcode_t opcode);
+iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func_x86_64_avx2_fma(iree_uk_x32u_opcode_t opcode);
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func_x86_64_avx2_fma(iree_uk_x16b_opcode_t opcode);
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func_x86_64_avx2_fma(iree_uk_x8b_opcode_t opcode);
+
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func_x86_64_avx512_base(iree_uk_x32b_opcode_t opcode);
+iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func_x86_64_avx512_base(iree_uk_x32u_opcode_t opcode);
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func_x86_64_avx512_base(iree_uk_x16b_opcode_t opcode);
+iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func_x86_64_avx512_base(iree_uk_x8b_opcode_t opcode);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_INTERNAL_H_
@@ -176,10 +176,13 @@ void iree_uk_mmt4d_tile_f16f16f32_8x8x1_x86_64_avx2_fma(
       out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_FLOAT_32);
 }
 
-void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
+// Shared implementation for i8i8i32 and i8i4i32. Both are widened to int16
+// before the multiplications, so they only differ in how the RHS is loaded.
+static void iree_uk_mmt4d_tile_i8iXi32_8x8x2_x86_64_avx2_fma(
     void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
     const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
-    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params,
+    iree_uk_type_t rhs_type) {
   iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
   const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
   const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
@@ -220,9 +223,15 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
     acc_3_4567_7_0123 = _mm256_setzero_si256();
   }
   for (iree_uk_int32_t k = 0; k < K; ++k) {
-    __m256i rhs_i16_01234567 =
-        _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)rhs_ptr));
-    rhs_ptr += 16;
+    __m256i rhs_i16_01234567;
+    if (rhs_type == IREE_UK_TYPE_INT_8) {
+      rhs_i16_01234567 =
+          _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)rhs_ptr));
+      rhs_ptr += 16;
+    } else {
+      rhs_i16_01234567 = iree_uk_avx2_load_16xi4_to_16xi16(rhs_ptr);
+      rhs_ptr += 8;
+    }
     __m256i lhs_i16_01234567 =
         _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)lhs_ptr));
     lhs_ptr += 16;
@@ -275,3 +284,103 @@ void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
   iree_uk_avx_storeu_2x128((__m128i*)(out_ptr + 3 * 8 + 4),
                            (__m128i*)(out_ptr + 7 * 8 + 0), acc_3_4567_7_0123);
 }
+
+void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x2_x86_64_avx2_fma(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_8);
+}
+
+void iree_uk_mmt4d_tile_i8i4i32_8x8x2_x86_64_avx2_fma(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_8x8x2_x86_64_avx2_fma(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_4);
+}
+
+void iree_uk_mmt4d_tile_f32i4f32_8x8x1_x86_64_avx2_fma(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m256 acc0, acc1, acc2, acc3, acc4, acc5, acc6, acc7;
+  if (flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    acc0 = _mm256_loadu_ps(out_ptr + 0 * 8);
+    acc1 = _mm256_loadu_ps(out_ptr + 1 * 8);
+    acc2 = _mm256_loadu_ps(out_ptr + 2 * 8);
+    acc3 = _mm256_loadu_ps(out_ptr + 3 * 8);
+    acc4 = _mm256_loadu_ps(out_ptr + 4 * 8);
+    acc5 = _mm256_loadu_ps(out_ptr + 5 * 8);
+    acc6 = _mm256_loadu_ps(out_ptr + 6 * 8);
+    acc7 = _mm256_loadu_ps(out_ptr + 7 * 8);
+  } else {
+    acc0 = _mm256_setzero_ps();
+    acc1 = _mm256_setzero_ps();
+    acc2 = _mm256_setzero_ps();
+    acc3 = _mm256_setzero_ps();
+    acc4 = _mm256_setzero_ps();
+    acc5 = _mm256_setzero_ps();
+    acc6 = _mm256_setzero_ps();
+    acc7 = _mm256_setzero_ps();
+  }
+  // Without group quantization, the whole K range is a single group and the
+  // RHS is converted as-is. Otherwise, the scale and zero-point of the current
+  // group are kept in registers, and each RHS row is dequantized once before
+  // being used in the 8 FMAs below.
+  const bool rhs_group_quantized =
+      flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
+  const float* scales_ptr = 0;
+  const float* zero_points_ptr = 0;
+  iree_uk_int32_t group_K = K;
+  if (rhs_group_quantized) {
+    scales_ptr = (const float*)params->rhs_group_scales_buffer +
+                 params->rhs_group_offset;
+    if (params->rhs_group_zero_points_buffer) {
+      zero_points_ptr = (const float*)params->rhs_group_zero_points_buffer +
+                        params->rhs_group_offset;
+    }
+    group_K = params->rhs_group_size;  // K0 == 1.
+  }
+  __m256 scale = _mm256_set1_ps(1.0f);
+  __m256 zero_point = _mm256_setzero_ps();
+  for (iree_uk_int32_t k = 0; k < K;) {
+    if (rhs_group_quantized) {
+      scale = _mm256_loadu_ps(scales_ptr);
+      scales_ptr += 8;
+      if (zero_points_ptr) {
+        zero_point = _mm256_loadu_ps(zero_points_ptr);
+        zero_points_ptr += 8;
+      }
+    }
+    iree_uk_int32_t group_end = iree_uk_index_min(K, k + group_K);
+    for (; k < group_end; ++k) {
+      __m256 rhs = iree_uk_avx2_load_8xi4_to_8xf32(rhs_ptr);
+      rhs_ptr += 4;
+      if (rhs_group_quantized) {
+        rhs = _mm256_mul_ps(_mm256_sub_ps(rhs, zero_point), scale);
+      }
+      acc0 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 0), rhs, acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 1), rhs, acc1);
+      acc2 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 2), rhs, acc2);
+      acc3 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 3), rhs, acc3);
+      acc4 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 4), rhs, acc4);
+      acc5 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 5), rhs, acc5);
+      acc6 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 6), rhs, acc6);
+      acc7 = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + 7), rhs, acc7);
+      lhs_ptr += 8;
+    }
+  }
+  _mm256_storeu_ps(out_ptr + 0 * 8, acc0);
+  _mm256_storeu_ps(out_ptr + 1 * 8, acc1);
+  _mm256_storeu_ps(out_ptr + 2 * 8, acc2);
+  _mm256_storeu_ps(out_ptr + 3 * 8, acc3);
+  _mm256_storeu_ps(out_ptr + 4 * 8, acc4);
+  _mm256_storeu_ps(out_ptr + 5 * 8, acc5);
+  _mm256_storeu_ps(out_ptr + 6 * 8, acc6);
+  _mm256_storeu_ps(out_ptr + 7 * 8, acc7);
+}
@@ -487,3 +487,117 @@ void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_base(
   iree_uk_avx512_storeu_4x128_to_16x16xi32(out_ptr, 3, 12, 7, 8, 11, 4, 15, 0,
                                            acc_3_CDEF_7_89AB_B_4567_F_0123);
 }
+
+void iree_uk_mmt4d_tile_f32i4f32_16x16x1_x86_64_avx512_base(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512 acc0, acc1, acc2, acc3, acc4, acc5, acc6, acc7;
+  __m512 acc8, acc9, acc10, acc11, acc12, acc13, acc14, acc15;
+  if (flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    acc0 = _mm512_loadu_ps(out_ptr + 0 * 16);
+    acc1 = _mm512_loadu_ps(out_ptr + 1 * 16);
+    acc2 = _mm512_loadu_ps(out_ptr + 2 * 16);
+    acc3 = _mm512_loadu_ps(out_ptr + 3 * 16);
+    acc4 = _mm512_loadu_ps(out_ptr + 4 * 16);
+    acc5 = _mm512_loadu_ps(out_ptr + 5 * 16);
+    acc6 = _mm512_loadu_ps(out_ptr + 6 * 16);
+    acc7 = _mm512_loadu_ps(out_ptr + 7 * 16);
+    acc8 = _mm512_loadu_ps(out_ptr + 8 * 16);
+    acc9 = _mm512_loadu_ps(out_ptr + 9 * 16);
+    acc10 = _mm512_loadu_ps(out_ptr + 10 * 16);
+    acc11 = _mm512_loadu_ps(out_ptr + 11 * 16);
+    acc12 = _mm512_loadu_ps(out_ptr + 12 * 16);
+    acc13 = _mm512_loadu_ps(out_ptr + 13 * 16);
+    acc14 = _mm512_loadu_ps(out_ptr + 14 * 16);
+    acc15 = _mm512_loadu_ps(out_ptr + 15 * 16);
+  } else {
+    acc0 = _mm512_setzero_ps();
+    acc1 = _mm512_setzero_ps();
+    acc2 = _mm512_setzero_ps();
+    acc3 = _mm512_setzero_ps();
+    acc4 = _mm512_setzero_ps();
+    acc5 = _mm512_setzero_ps();
+    acc6 = _mm512_setzero_ps();
+    acc7 = _mm512_setzero_ps();
+    acc8 = _mm512_setzero_ps();
+    acc9 = _mm512_setzero_ps();
+    acc10 = _mm512_setzero_ps();
+    acc11 = _mm512_setzero_ps();
+    acc12 = _mm512_setzero_ps();
+    acc13 = _mm512_setzero_ps();
+    acc14 = _mm512_setzero_ps();
+    acc15 = _mm512_setzero_ps();
+  }
+  // See the comment in iree_uk_mmt4d_tile_f32i4f32_8x8x1_x86_64_avx2_fma.
+  const bool rhs_group_quantized =
+      flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
+  const float* scales_ptr = 0;
+  const float* zero_points_ptr = 0;
+  iree_uk_int32_t group_K = K;
+  if (rhs_group_quantized) {
+    scales_ptr = (const float*)params->rhs_group_scales_buffer +
+                 params->rhs_group_offset;
+    if (params->rhs_group_zero_points_buffer) {
+      zero_points_ptr = (const float*)params->rhs_group_zero_points_buffer +
+                        params->rhs_group_offset;
+    }
+    group_K = params->rhs_group_size;  // K0 == 1.
+  }
+  __m512 scale = _mm512_set1_ps(1.0f);
+  __m512 zero_point = _mm512_setzero_ps();
+  for (iree_uk_int32_t k = 0; k < K;) {
+    if (rhs_group_quantized) {
+      scale = _mm512_loadu_ps(scales_ptr);
+      scales_ptr += 16;
+      if (zero_points_ptr) {
+        zero_point = _mm512_loadu_ps(zero_points_ptr);
+        zero_points_ptr += 16;
+      }
+    }
+    iree_uk_int32_t group_end = iree_uk_index_min(K, k + group_K);
+    for (; k < group_end; ++k) {
+      __m512 rhs = iree_uk_avx512_load_16xi4_to_16xf32(rhs_ptr);
+      rhs_ptr += 8;
+      if (rhs_group_quantized) {
+        rhs = _mm512_mul_ps(_mm512_sub_ps(rhs, zero_point), scale);
+      }
+      acc0 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[0]), rhs, acc0);
+      acc1 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[1]), rhs, acc1);
+      acc2 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[2]), rhs, acc2);
+      acc3 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[3]), rhs, acc3);
+      acc4 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[4]), rhs, acc4);
+      acc5 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[5]), rhs, acc5);
+      acc6 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[6]), rhs, acc6);
+      acc7 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[7]), rhs, acc7);
+      acc8 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[8]), rhs, acc8);
+      acc9 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[9]), rhs, acc9);
+      acc10 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[10]), rhs, acc10);
+      acc11 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[11]), rhs, acc11);
+      acc12 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[12]), rhs, acc12);
+      acc13 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[13]), rhs, acc13);
+      acc14 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[14]), rhs, acc14);
+      acc15 = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[15]), rhs, acc15);
+      lhs_ptr += 16;
+    }
+  }
+  _mm512_storeu_ps(out_ptr + 0 * 16, acc0);
+  _mm512_storeu_ps(out_ptr + 1 * 16, acc1);
+  _mm512_storeu_ps(out_ptr + 2 * 16, acc2);
+  _mm512_storeu_ps(out_ptr + 3 * 16, acc3);
+  _mm512_storeu_ps(out_ptr + 4 * 16, acc4);
+  _mm512_storeu_ps(out_ptr + 5 * 16, acc5);
+  _mm512_storeu_ps(out_ptr + 6 * 16, acc6);
+  _mm512_storeu_ps(out_ptr + 7 * 16, acc7);
+  _mm512_storeu_ps(out_ptr + 8 * 16, acc8);
+  _mm512_storeu_ps(out_ptr + 9 * 16, acc9);
+  _mm512_storeu_ps(out_ptr + 10 * 16, acc10);
+  _mm512_storeu_ps(out_ptr + 11 * 16, acc11);
+  _mm512_storeu_ps(out_ptr + 12 * 16, acc12);
+  _mm512_storeu_ps(out_ptr + 13 * 16, acc13);
+  _mm512_storeu_ps(out_ptr + 14 * 16, acc14);
+  _mm512_storeu_ps(out_ptr + 15 * 16, acc15);
+}
@@ -7,10 +7,13 @@
 #include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
 #include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64_internal.h"
 
-void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
+// Shared implementation for i8i8i32 and i8i4i32. Both are widened to int16
+// before the multiplications, so they only differ in how the RHS is loaded.
+static void iree_uk_mmt4d_tile_i8iXi32_16x16x2_x86_64_avx512_vnni(
     void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
     const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
-    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params,
+    iree_uk_type_t rhs_type) {
   iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
   const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
   const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
@@ -92,9 +95,15 @@ void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
       _mm512_setr_epi32(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
 
   for (iree_uk_int32_t k = 0; k < K; ++k) {
-    __m512i rhs_i16_0123456789ABCDEF =
-        _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)rhs_ptr));
-    rhs_ptr += 32;
+    __m512i rhs_i16_0123456789ABCDEF;
+    if (rhs_type == IREE_UK_TYPE_INT_8) {
+      rhs_i16_0123456789ABCDEF =
+          _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)rhs_ptr));
+      rhs_ptr += 32;
+    } else {
+      rhs_i16_0123456789ABCDEF = iree_uk_avx512_load_32xi4_to_32xi16(rhs_ptr);
+      rhs_ptr += 16;
+    }
     __m512i lhs_i16_0123456789ABCDEF =
         _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)lhs_ptr));
     lhs_ptr += 32;
@@ -197,3 +206,19 @@ void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
   iree_uk_avx512_storeu_4x128_to_16x16xi32(out_ptr, 3, 12, 7, 8, 11, 4, 15, 0,
                                            acc_3_CDEF_7_89AB_B_4567_F_0123);
 }
+
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_16x16x2_x86_64_avx512_vnni(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_8);
+}
+
+void iree_uk_mmt4d_tile_i8i4i32_16x16x2_x86_64_avx512_vnni(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_i8iXi32_16x16x2_x86_64_avx512_vnni(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, IREE_UK_TYPE_INT_4);
+}
@@ -41,6 +41,33 @@ iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 4};
 }
 
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_x86_64_i8i4i32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  // Only tile sizes that have an int4 tile function: the int4 RHS is widened in
+  // registers to the i8i8i32 layout, but not every i8i8i32 kernel has an int4
+  // variant.
+#if defined(IREE_UK_BUILD_X86_64_AVX512_VNNI)
+  if (iree_uk_cpu_supports_avx512_vnni(params->cpu_data)) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 2, .N = 16};
+  }
+#endif
+#if defined(IREE_UK_BUILD_X86_64_AVX2_FMA)
+  if (iree_uk_cpu_supports_avx2_fma(params->cpu_data)) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 8};
+  }
+#endif
+  // Generic fallback.
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 4};
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_x86_64_f32i4f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  // Same as f32f32f32: the int4 RHS is converted in registers to float.
+  return iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(params);
+}
+
 bool iree_uk_query_matmul_tile_sizes_arch(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
@@ -53,6 +80,14 @@ bool iree_uk_query_matmul_tile_sizes_arch(
     *out_matmul_tile_sizes =
         iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(params);
     return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I4I32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_i8i4i32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32I4F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_f32i4f32(params);
+    return true;
   } else {
     // Can't happen, validated earlier.
     IREE_UK_ASSUME_UNREACHABLE;
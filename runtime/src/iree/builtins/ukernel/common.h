@@ -461,14 +461,17 @@ enum {
   IREE_UK_TYPE_OPAQUE_16 = IREE_UK_TYPE_CATEGORY_OPAQUE | 4,
   IREE_UK_TYPE_OPAQUE_32 = IREE_UK_TYPE_CATEGORY_OPAQUE | 5,
   IREE_UK_TYPE_OPAQUE_64 = IREE_UK_TYPE_CATEGORY_OPAQUE | 6,
+  IREE_UK_TYPE_INT_4 = IREE_UK_TYPE_CATEGORY_INTEGER | 2,
   IREE_UK_TYPE_INT_8 = IREE_UK_TYPE_CATEGORY_INTEGER | 3,
   IREE_UK_TYPE_INT_16 = IREE_UK_TYPE_CATEGORY_INTEGER | 4,
   IREE_UK_TYPE_INT_32 = IREE_UK_TYPE_CATEGORY_INTEGER | 5,
   IREE_UK_TYPE_INT_64 = IREE_UK_TYPE_CATEGORY_INTEGER | 6,
+  IREE_UK_TYPE_SINT_4 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 2,
   IREE_UK_TYPE_SINT_8 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 3,
   IREE_UK_TYPE_SINT_16 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 4,
   IREE_UK_TYPE_SINT_32 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 5,
   IREE_UK_TYPE_SINT_64 = IREE_UK_TYPE_CATEGORY_INTEGER_SIGNED | 6,
+  IREE_UK_TYPE_UINT_4 = IREE_UK_TYPE_CATEGORY_INTEGER_UNSIGNED | 2,
   IREE_UK_TYPE_UINT_8 = IREE_UK_TYPE_CATEGORY_INTEGER_UNSIGNED | 3,
   IREE_UK_TYPE_UINT_16 = IREE_UK_TYPE_CATEGORY_INTEGER_UNSIGNED | 4,
   IREE_UK_TYPE_UINT_32 = IREE_UK_TYPE_CATEGORY_INTEGER_UNSIGNED | 5,
@@ -508,6 +511,25 @@ static inline int iree_uk_type_size(iree_uk_type_t t) {
   return 1 << iree_uk_type_size_log2(t);
 }
 
+// Returns the number of bytes spanned by `count` elements of type `t`. Unlike
+// `count << iree_uk_type_size_log2(t)`, this is also defined for sub-byte
+// types, as long as `count` elements make up a whole number of bytes (which is
+// the caller's responsibility to ensure, e.g. an even count of 4-bit elements).
+static inline iree_uk_index_t iree_uk_type_elems_to_bytes(
+    iree_uk_type_t t, iree_uk_index_t count) {
+  return (count << iree_uk_type_bit_count_log2(t)) >> 3;
+}
+
+// Returns the sign-extended value of the element at index `i` in a buffer of
+// 4-bit signed integers packed two per byte, the element at even index in the
+// low nibble.
+static inline iree_uk_int8_t iree_uk_load_packed_i4(
+    const iree_uk_uint8_t* buf, iree_uk_index_t i) {
+  iree_uk_uint8_t byte = buf[i >> 1];
+  iree_uk_int8_t nibble_in_high_bits = (i & 1) ? byte : (byte << 4);
+  return nibble_in_high_bits >> 4;
+}
+
 //===----------------------------------------------------------------------===//
 // Tuples of types, packed ("tied") into a word.
 //===----------------------------------------------------------------------===//
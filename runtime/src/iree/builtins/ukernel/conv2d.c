@@ -0,0 +1,371 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/conv2d.h"
+
+#include "iree/builtins/ukernel/conv2d_internal.h"
+
+static void iree_uk_conv2d_validate(const iree_uk_conv2d_params_t* params) {
+#ifdef IREE_UK_ENABLE_ASSERTS
+  const iree_uk_uint32_t allflags =
+      IREE_UK_FLAG_CONV2D_TYPE_MASK | IREE_UK_FLAG_CONV2D_ACCUMULATE |
+      IREE_UK_FLAG_CONV2D_PREFER_INTRINSICS | IREE_UK_FLAG_CONV2D_INPUT_NCHW;
+  IREE_UK_ASSERT(!(params->flags & ~allflags));
+  iree_uk_uint32_t flags_type = params->flags & IREE_UK_FLAG_CONV2D_TYPE_MASK;
+  IREE_UK_ASSERT(flags_type == IREE_UK_FLAG_CONV2D_TYPE_F32F32F32 ||
+                 flags_type == IREE_UK_FLAG_CONV2D_TYPE_I8I8I32 ||
+                 flags_type == IREE_UK_FLAG_CONV2D_TYPE_F16F16F32 ||
+                 flags_type == IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32);
+  IREE_UK_ASSERT(params->batch_size >= 0);
+  IREE_UK_ASSERT(params->in_height >= 0);
+  IREE_UK_ASSERT(params->in_width >= 0);
+  IREE_UK_ASSERT(params->in_channels >= 0);
+  IREE_UK_ASSERT(params->out_height >= 0);
+  IREE_UK_ASSERT(params->out_width >= 0);
+  IREE_UK_ASSERT(params->out_channels >= 0);
+  IREE_UK_ASSERT(params->kernel_height >= 0);
+  IREE_UK_ASSERT(params->kernel_width >= 0);
+  IREE_UK_ASSERT(params->stride_height > 0);
+  IREE_UK_ASSERT(params->stride_width > 0);
+  IREE_UK_ASSERT(params->dilation_height > 0);
+  IREE_UK_ASSERT(params->dilation_width > 0);
+  IREE_UK_ASSERT(params->padding_top >= 0);
+  IREE_UK_ASSERT(params->padding_left >= 0);
+  // Same ranges as enforced by mmt4d on the packed matmul dimensions.
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(
+      params->batch_size * params->out_height * params->out_width, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->out_channels, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(
+      params->kernel_height * params->kernel_width * params->in_channels, 31));
+  IREE_UK_ASSERT(params->M0 > 0 &&
+                 IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->M0, 15));
+  IREE_UK_ASSERT(params->N0 > 0 &&
+                 IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N0, 15));
+  IREE_UK_ASSERT(params->K0 > 0 &&
+                 IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K0, 15));
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  IREE_UK_ASSERT(params->M0 * params->N0 *
+                     iree_uk_type_size(iree_uk_mmt4d_out_type(mmt4d_type)) <=
+                 iree_uk_mmt4d_tile_generic_max_bytes);
+  // The gathered LHS panel buffer must hold at least one M0xK0 tile.
+  IREE_UK_ASSERT(params->M0 * params->K0 *
+                     iree_uk_type_size(iree_uk_mmt4d_lhs_type(mmt4d_type)) <=
+                 iree_uk_conv2d_lhs_panel_buf_size);
+#endif  // IREE_UK_ENABLE_ASSERTS
+}
+
+// Describes how to walk the im2col'd LHS matrix without materializing it. The
+// K dimension is decomposed into three nested loops, from outer to inner:
+// (kernel_h, kernel_w, in_channel) for NHWC, (in_channel, kernel_h, kernel_w)
+// for NCHW. Each of these loops advances the input row, column or channel.
+typedef struct iree_uk_conv2d_lhs_walk_t {
+  const char* in_ptr;
+  iree_uk_index_t in_image_stride;
+  iree_uk_index_t in_height;
+  iree_uk_index_t in_width;
+  // Input element strides along rows, columns and channels.
+  iree_uk_index_t in_h_stride;
+  iree_uk_index_t in_w_stride;
+  iree_uk_index_t in_c_stride;
+  iree_uk_index_t out_height;
+  iree_uk_index_t out_width;
+  iree_uk_index_t stride_height;
+  iree_uk_index_t stride_width;
+  iree_uk_index_t padding_top;
+  iree_uk_index_t padding_left;
+  // Sizes of the three nested K loops, outer to inner.
+  iree_uk_index_t k_size[3];
+  // Input row, column and channel increments of each K loop.
+  iree_uk_index_t k_dh[3];
+  iree_uk_index_t k_dw[3];
+  iree_uk_index_t k_dc[3];
+  iree_uk_index_t M;
+  iree_uk_index_t K;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t K0;
+  int elem_size_log2;
+} iree_uk_conv2d_lhs_walk_t;
+
+static void iree_uk_conv2d_lhs_walk_set_loop(iree_uk_conv2d_lhs_walk_t* walk,
+                                             int loop, iree_uk_index_t size,
+                                             iree_uk_index_t dh,
+                                             iree_uk_index_t dw,
+                                             iree_uk_index_t dc) {
+  walk->k_size[loop] = size;
+  walk->k_dh[loop] = dh;
+  walk->k_dw[loop] = dw;
+  walk->k_dc[loop] = dc;
+}
+
+static void iree_uk_conv2d_lhs_walk_init(const iree_uk_conv2d_params_t* params,
+                                         iree_uk_conv2d_lhs_walk_t* walk) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  walk->elem_size_log2 =
+      iree_uk_type_size_log2(iree_uk_mmt4d_lhs_type(mmt4d_type));
+  walk->in_ptr = (const char*)params->in_buffer +
+                 (params->in_offset << walk->elem_size_log2);
+  walk->in_image_stride = params->in_stride0;
+  walk->in_height = params->in_height;
+  walk->in_width = params->in_width;
+  walk->out_height = params->out_height;
+  walk->out_width = params->out_width;
+  walk->stride_height = params->stride_height;
+  walk->stride_width = params->stride_width;
+  walk->padding_top = params->padding_top;
+  walk->padding_left = params->padding_left;
+  iree_uk_index_t C = params->in_channels;
+  iree_uk_index_t H = params->in_height;
+  iree_uk_index_t W = params->in_width;
+  iree_uk_index_t KH = params->kernel_height;
+  iree_uk_index_t KW = params->kernel_width;
+  iree_uk_index_t dil_h = params->dilation_height;
+  iree_uk_index_t dil_w = params->dilation_width;
+  if (params->flags & IREE_UK_FLAG_CONV2D_INPUT_NCHW) {
+    walk->in_h_stride = W;
+    walk->in_w_stride = 1;
+    walk->in_c_stride = H * W;
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 0, C, 0, 0, 1);
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 1, KH, dil_h, 0, 0);
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 2, KW, 0, dil_w, 0);
+  } else {
+    walk->in_h_stride = W * C;
+    walk->in_w_stride = C;
+    walk->in_c_stride = 1;
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 0, KH, dil_h, 0, 0);
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 1, KW, 0, dil_w, 0);
+    iree_uk_conv2d_lhs_walk_set_loop(walk, 2, C, 0, 0, 1);
+  }
+  walk->M = params->batch_size * params->out_height * params->out_width;
+  walk->K = KH * KW * C;
+  walk->M0 = params->M0;
+  walk->K0 = params->K0;
+}
+
+// Gathers the [k_outer_count][M0][K0] LHS panel chunk for the M0 rows starting
+// at row `m_outer * M0` and the K0-wide columns starting at `k_outer_start`,
+// into `panel`. Padding, whether around the image or past the end of the M or
+// K dimensions, is zero.
+static void iree_uk_conv2d_gather_lhs_panel(
+    const iree_uk_conv2d_lhs_walk_t* walk, iree_uk_index_t m_outer,
+    iree_uk_index_t k_outer_start, iree_uk_index_t k_outer_count,
+    char* IREE_UK_RESTRICT panel) {
+  const int elem_size_log2 = walk->elem_size_log2;
+  const iree_uk_index_t elem_size = 1 << elem_size_log2;
+  const iree_uk_int32_t M0 = walk->M0;
+  const iree_uk_int32_t K0 = walk->K0;
+  const iree_uk_index_t k_begin = k_outer_start * K0;
+  const iree_uk_index_t k_end = (k_outer_start + k_outer_count) * K0;
+  const iree_uk_index_t k_valid_end = iree_uk_index_min(k_end, walk->K);
+  const iree_uk_index_t dst_tile_stride = (M0 * K0) << elem_size_log2;
+  // The innermost K loop either walks channels at a fixed image position
+  // (NHWC), or walks along an image row (NCHW).
+  const iree_uk_index_t inner_size = walk->k_size[2];
+  const iree_uk_index_t inner_dw = walk->k_dw[2];
+  const iree_uk_index_t inner_src_stride =
+      (walk->k_dh[2] * walk->in_h_stride + inner_dw * walk->in_w_stride +
+       walk->k_dc[2] * walk->in_c_stride)
+      << elem_size_log2;
+  for (iree_uk_int32_t r = 0; r < M0; ++r) {
+    char* dst_row = panel + ((r * K0) << elem_size_log2);
+    iree_uk_index_t m = m_outer * M0 + r;
+    if (m >= walk->M) {
+      for (iree_uk_index_t ko = 0; ko < k_outer_count; ++ko) {
+        iree_uk_memset(dst_row + ko * dst_tile_stride, 0, K0 * elem_size);
+      }
+      continue;
+    }
+    iree_uk_index_t ow = m % walk->out_width;
+    iree_uk_index_t oh = (m / walk->out_width) % walk->out_height;
+    iree_uk_index_t b = m / (walk->out_width * walk->out_height);
+    iree_uk_index_t ih_base = oh * walk->stride_height - walk->padding_top;
+    iree_uk_index_t iw_base = ow * walk->stride_width - walk->padding_left;
+    const char* image =
+        walk->in_ptr + ((b * walk->in_image_stride) << elem_size_log2);
+    // Decompose k_begin into the indices of the three nested K loops.
+    iree_uk_index_t k2 = k_begin % inner_size;
+    iree_uk_index_t k1 = (k_begin / inner_size) % walk->k_size[1];
+    iree_uk_index_t k0 = k_begin / (inner_size * walk->k_size[1]);
+    iree_uk_index_t k = k_begin;
+    while (k < k_end) {
+      iree_uk_index_t k_rel = k - k_begin;
+      iree_uk_index_t k_in_tile = k_rel % K0;
+      char* dst = dst_row + (k_rel / K0) * dst_tile_stride +
+                  (k_in_tile << elem_size_log2);
+      if (k >= k_valid_end) {
+        // Zero padding at the end of the last K0-wide tile.
+        iree_uk_index_t run = K0 - k_in_tile;
+        iree_uk_memset(dst, 0, run * elem_size);
+        k += run;
+        continue;
+      }
+      // Run of consecutive K indices staying within the innermost K loop and
+      // within the current K0-wide tile.
+      iree_uk_index_t run =
+          iree_uk_index_min(inner_size - k2, K0 - k_in_tile);
+      run = iree_uk_index_min(run, k_valid_end - k);
+      iree_uk_index_t ih = ih_base + k0 * walk->k_dh[0] + k1 * walk->k_dh[1] +
+                           k2 * walk->k_dh[2];
+      iree_uk_index_t iw = iw_base + k0 * walk->k_dw[0] + k1 * walk->k_dw[1] +
+                           k2 * inner_dw;
+      iree_uk_index_t c = k0 * walk->k_dc[0] + k1 * walk->k_dc[1] +
+                          k2 * walk->k_dc[2];
+      if (ih < 0 || ih >= walk->in_height) {
+        iree_uk_memset(dst, 0, run * elem_size);
+      } else if (inner_dw == 0) {
+        // The image position is fixed for the whole run.
+        if (iw < 0 || iw >= walk->in_width) {
+          iree_uk_memset(dst, 0, run * elem_size);
+        } else {
+          const char* src =
+              image + ((ih * walk->in_h_stride + iw * walk->in_w_stride +
+                        c * walk->in_c_stride)
+                       << elem_size_log2);
+          if (inner_src_stride == elem_size) {
+            iree_uk_memcpy(dst, src, run * elem_size);
+          } else {
+            for (iree_uk_index_t i = 0; i < run; ++i) {
+              iree_uk_memcpy(dst + i * elem_size, src + i * inner_src_stride,
+                             elem_size);
+            }
+          }
+        }
+      } else {
+        // The run moves along an image row, so columns are bounds-checked
+        // per element.
+        const char* row = image + ((ih * walk->in_h_stride +
+                                    c * walk->in_c_stride)
+                                   << elem_size_log2);
+        for (iree_uk_index_t i = 0; i < run; ++i) {
+          iree_uk_index_t iw_i = iw + i * inner_dw;
+          if (iw_i < 0 || iw_i >= walk->in_width) {
+            iree_uk_memset(dst + i * elem_size, 0, elem_size);
+          } else {
+            iree_uk_memcpy(dst + i * elem_size,
+                           row + ((iw_i * walk->in_w_stride) << elem_size_log2),
+                           elem_size);
+          }
+        }
+      }
+      k += run;
+      k2 += run;
+      if (k2 == inner_size) {
+        k2 = 0;
+        if (++k1 == walk->k_size[1]) {
+          k1 = 0;
+          ++k0;
+        }
+      }
+    }
+  }
+}
+
+// Helper for early-return path when the reduction is empty and we just need to
+// clear the output.
+static void iree_uk_conv2d_zero_out(const iree_uk_conv2d_params_t* params,
+                                    iree_uk_index_t M_outer,
+                                    iree_uk_index_t N_outer) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  int out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  iree_uk_index_t contiguous_size = N_outer * params->M0 * params->N0
+                                    << out_elem_size_log2;
+  iree_uk_index_t stride = params->out_stride0 << out_elem_size_log2;
+  char* out_ptr =
+      (char*)params->out_buffer + (params->out_offset << out_elem_size_log2);
+  for (iree_uk_index_t i = 0; i < M_outer; ++i) {
+    iree_uk_memset(out_ptr, 0, contiguous_size);
+    out_ptr += stride;
+  }
+}
+
+static iree_uk_index_t iree_uk_conv2d_ceil_div(iree_uk_index_t x,
+                                               iree_uk_int32_t y) {
+  return (x + y - 1) / y;
+}
+
+IREE_UK_EXPORT int iree_uk_conv2d(const iree_uk_conv2d_params_t* params) {
+  iree_uk_conv2d_validate(params);
+
+  iree_uk_conv2d_lhs_walk_t walk;
+  iree_uk_conv2d_lhs_walk_init(params, &walk);
+  const iree_uk_index_t M_outer = iree_uk_conv2d_ceil_div(walk.M, params->M0);
+  const iree_uk_index_t N_outer =
+      iree_uk_conv2d_ceil_div(params->out_channels, params->N0);
+  const iree_uk_index_t K_outer = iree_uk_conv2d_ceil_div(walk.K, params->K0);
+
+  // Trivial cases.
+  if (M_outer == 0 || N_outer == 0) return 0;
+  if (K_outer == 0) {
+    if (!(params->flags & IREE_UK_FLAG_CONV2D_ACCUMULATE)) {
+      iree_uk_conv2d_zero_out(params, M_outer, N_outer);
+    }
+    return 0;
+  }
+
+  // Select the mmt4d tile_func to use on the gathered LHS panels.
+  iree_uk_mmt4d_params_t mmt4d_params = {
+      .M = M_outer,
+      .N = N_outer,
+      .K = K_outer,
+      .M0 = params->M0,
+      .N0 = params->N0,
+      .K0 = params->K0,
+      .flags = iree_uk_conv2d_mmt4d_flags(params->flags),
+      .cpu_data = params->cpu_data,
+  };
+  iree_uk_mmt4d_tile_func_t tile_func =
+      iree_uk_mmt4d_select_tile_func(&mmt4d_params);
+
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  const int lhs_elem_size_log2 =
+      iree_uk_type_size_log2(iree_uk_mmt4d_lhs_type(mmt4d_type));
+  const int rhs_elem_size_log2 =
+      iree_uk_type_size_log2(iree_uk_mmt4d_rhs_type(mmt4d_type));
+  const int out_elem_size_log2 =
+      iree_uk_type_size_log2(iree_uk_mmt4d_out_type(mmt4d_type));
+  const iree_uk_index_t out_tile_size = (params->M0 * params->N0)
+                                        << out_elem_size_log2;
+  const iree_uk_index_t out_stride = params->out_stride0 << out_elem_size_log2;
+  const iree_uk_index_t rhs_tile_size = (params->N0 * params->K0)
+                                        << rhs_elem_size_log2;
+  const iree_uk_index_t rhs_panel_stride = params->filter_stride0
+                                           << rhs_elem_size_log2;
+  const char* rhs_panel_start = (const char*)params->filter_buffer +
+                                (params->filter_offset << rhs_elem_size_log2);
+  // The reduction is done in chunks of as many K0-wide tiles as fit in the
+  // LHS panel buffer. Each chunk of LHS panel is gathered once, then
+  // multiplied by all N_outer RHS panels.
+  IREE_UK_ATTRIBUTE_ALIGNED(64)
+  char lhs_panel[iree_uk_conv2d_lhs_panel_buf_size];
+  const iree_uk_index_t k_chunk =
+      iree_uk_conv2d_lhs_panel_buf_size /
+      ((params->M0 * params->K0) << lhs_elem_size_log2);
+  char* out_tile_row =
+      (char*)params->out_buffer + (params->out_offset << out_elem_size_log2);
+  for (iree_uk_index_t i = 0; i < M_outer; ++i) {
+    IREE_UK_PREFETCH_RW(out_tile_row, IREE_UK_PREFETCH_LOCALITY_L3);
+    for (iree_uk_index_t k_start = 0; k_start < K_outer; k_start += k_chunk) {
+      iree_uk_index_t k_count = iree_uk_index_min(k_chunk, K_outer - k_start);
+      iree_uk_conv2d_gather_lhs_panel(&walk, i, k_start, k_count, lhs_panel);
+      // Chunks after the first one accumulate onto the previous ones.
+      iree_uk_uint32_t tile_flags = mmt4d_params.flags;
+      if (k_start > 0 || (params->flags & IREE_UK_FLAG_CONV2D_ACCUMULATE)) {
+        tile_flags |= IREE_UK_FLAG_MMT4D_ACCUMULATE;
+      }
+      char* out_tile = out_tile_row;
+      const char* rhs_panel = rhs_panel_start + k_start * rhs_tile_size;
+      for (iree_uk_index_t j = 0; j < N_outer; ++j) {
+        IREE_UK_PREFETCH_RO(rhs_panel, IREE_UK_PREFETCH_LOCALITY_L1);
+        tile_func(out_tile, lhs_panel, rhs_panel, k_count, tile_flags,
+                  &mmt4d_params);
+        out_tile += out_tile_size;
+        rhs_panel += rhs_panel_stride;
+      }
+    }
+    out_tile_row += out_stride;
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_CONV2D_H_
+#define IREE_BUILTINS_UKERNEL_CONV2D_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// `conv2d` microkernel: a 2D convolution computed as an implicit-im2col
+// matmul. The input is read directly in its unpacked NHWC or NCHW layout, and
+// patches are gathered into a small LHS panel that is fed to the same tile
+// functions as `mmt4d`. This avoids materializing the im2col'd LHS, which is
+// kernel_height * kernel_width times larger than the input.
+//
+// With M = batch_size * out_height * out_width, N = out_channels and
+// K = kernel_height * kernel_width * in_channels:
+// * The filter is packed like the `mmt4d` RHS, with shape
+//   [ceil(N / N0)][ceil(K / K0)][N0][K0] and zero padding. The K dimension is
+//   ordered (kernel_h, kernel_w, in_channel) with NHWC input, and
+//   (in_channel, kernel_h, kernel_w) with NCHW input, matching the
+//   corresponding HWCF and FCHW filter layouts.
+// * The output is packed like the `mmt4d` output, with shape
+//   [ceil(M / M0)][ceil(N / N0)][M0][N0]. The M dimension is ordered
+//   (batch, out_h, out_w).
+// * Padding is implicit: input elements outside of the in_height x in_width
+//   image read as zero. Only the top and left amounts are passed, the bottom
+//   and right amounts follow from the output size.
+typedef struct iree_uk_conv2d_params_t {
+  const void* in_buffer;
+  iree_uk_index_t in_offset;
+  // Stride between consecutive batch images. The dimensions within an image
+  // are contiguous.
+  iree_uk_index_t in_stride0;
+  const void* filter_buffer;
+  iree_uk_index_t filter_offset;
+  iree_uk_index_t filter_stride0;
+  void* out_buffer;
+  iree_uk_index_t out_offset;
+  iree_uk_index_t out_stride0;
+  iree_uk_index_t batch_size;
+  iree_uk_index_t in_height;
+  iree_uk_index_t in_width;
+  iree_uk_index_t in_channels;
+  iree_uk_index_t out_height;
+  iree_uk_index_t out_width;
+  iree_uk_index_t out_channels;
+  iree_uk_index_t kernel_height;
+  iree_uk_index_t kernel_width;
+  iree_uk_index_t stride_height;
+  iree_uk_index_t stride_width;
+  iree_uk_index_t dilation_height;
+  iree_uk_index_t dilation_width;
+  iree_uk_index_t padding_top;
+  iree_uk_index_t padding_left;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+  iree_uk_uint32_t flags;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_conv2d_params_t;
+
+IREE_UK_EXPORT int iree_uk_conv2d(const iree_uk_conv2d_params_t* params);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_CONV2D_H_
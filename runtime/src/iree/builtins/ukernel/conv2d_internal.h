@@ -0,0 +1,47 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_CONV2D_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_CONV2D_INTERNAL_H_
+
+#include "iree/builtins/ukernel/conv2d.h"
+#include "iree/builtins/ukernel/mmt4d_internal.h"
+
+// The conv2d type flags share their values with the mmt4d type flags, so that
+// the conv2d element types are just the mmt4d element types.
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_F32F32F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_I8I8I32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_TYPE_F16F16F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_F16F16F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_ACCUMULATE ==
+                      IREE_UK_FLAG_MMT4D_ACCUMULATE);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_CONV2D_PREFER_INTRINSICS ==
+                      IREE_UK_FLAG_MMT4D_PREFER_INTRINSICS);
+
+static inline iree_uk_mmt4d_type_t iree_uk_conv2d_type(
+    iree_uk_uint32_t flags) {
+  return iree_uk_mmt4d_type(flags & IREE_UK_FLAG_CONV2D_TYPE_MASK);
+}
+
+// Returns the flags to pass to the mmt4d tile function, given conv2d `flags`.
+// This does not include IREE_UK_FLAG_MMT4D_ACCUMULATE, which depends on which
+// chunk of the reduction dimension is being computed.
+static inline iree_uk_uint32_t iree_uk_conv2d_mmt4d_flags(
+    iree_uk_uint32_t flags) {
+  return flags & (IREE_UK_FLAG_CONV2D_TYPE_MASK |
+                  IREE_UK_FLAG_CONV2D_PREFER_INTRINSICS);
+}
+
+// Size in bytes of the stack buffer that LHS panels are gathered into. Each
+// gathered panel chunk is reused across all N0-wide column tiles, so this
+// should be L1-resident alongside the streamed RHS panels.
+enum { iree_uk_conv2d_lhs_panel_buf_size = 8192 };
+
+#endif  // IREE_BUILTINS_UKERNEL_CONV2D_INTERNAL_H_
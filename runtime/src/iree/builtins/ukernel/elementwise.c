@@ -0,0 +1,35 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/elementwise_internal.h"
+
+// There are no generic row functions here: they need libm for some opcodes,
+// which ukernels can't depend on, so the portable fallbacks live with the
+// caller. These entry points only forward to the arch code.
+
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func(iree_uk_x32b_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x32b_select_row_func_arch(opcode, cpu_data);
+}
+
+IREE_UK_EXPORT iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func(iree_uk_x32u_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x32u_select_row_func_arch(opcode, cpu_data);
+}
+
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func(iree_uk_x16b_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x16b_select_row_func_arch(opcode, cpu_data);
+}
+
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func(iree_uk_x8b_opcode_t opcode,
+                            const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_x8b_select_row_func_arch(opcode, cpu_data);
+}
@@ -0,0 +1,144 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
+#define IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Elementwise row functions: architecture-specific SIMD implementations of
+// simple elementwise ops over contiguous rows. These are the inner loops of the
+// 2D elementwise kernels of the VMVX module, which selects them once and keeps
+// its own portable fallbacks for opcodes or CPUs that have no arch code.
+//
+// Opcodes are grouped by element width, as the callers only differentiate
+// based on width; all other type specificity is carried by the opcode.
+// Binary opcode categories are named "X{width}B" and unary ones "X{width}U".
+// The initial lists were sorted, and it is encouraged to sort extensions, but
+// each opcode must be numerically stable, so the lists are not expected to
+// be sorted over time. Each enum ends with a _COUNT value for sizing tables.
+
+typedef enum iree_uk_x32b_opcode_e {
+  IREE_UK_X32B_ADDF = 0,
+  IREE_UK_X32B_ADDI = 1,
+  IREE_UK_X32B_ANDI = 2,
+  IREE_UK_X32B_DIVF = 3,
+  IREE_UK_X32B_DIVSI = 4,
+  IREE_UK_X32B_DIVUI = 5,
+  IREE_UK_X32B_MULF = 6,
+  IREE_UK_X32B_MULI = 7,
+  IREE_UK_X32B_ORI = 8,
+  IREE_UK_X32B_SHLI = 9,
+  IREE_UK_X32B_SHRSI = 10,
+  IREE_UK_X32B_SHRUI = 11,
+  IREE_UK_X32B_SUBF = 12,
+  IREE_UK_X32B_SUBI = 13,
+  IREE_UK_X32B_XORI = 14,
+  IREE_UK_X32B_COUNT
+} iree_uk_x32b_opcode_t;
+
+typedef enum iree_uk_x32u_opcode_e {
+  IREE_UK_X32U_ABSF = 0,
+  IREE_UK_X32U_CEILF = 1,
+  IREE_UK_X32U_CTLZ = 2,
+  IREE_UK_X32U_EXPF = 3,
+  IREE_UK_X32U_FLOORF = 4,
+  IREE_UK_X32U_LOGF = 5,
+  IREE_UK_X32U_NEGF = 6,
+  IREE_UK_X32U_RSQRTF = 7,
+  IREE_UK_X32U_COUNT
+} iree_uk_x32u_opcode_t;
+
+// 16-bit opcodes are floating-point only, and name the element type as there
+// are two of them (f16 and bf16) sharing the width.
+typedef enum iree_uk_x16b_opcode_e {
+  IREE_UK_X16B_ADDBF16 = 0,
+  IREE_UK_X16B_ADDF16 = 1,
+  IREE_UK_X16B_DIVBF16 = 2,
+  IREE_UK_X16B_DIVF16 = 3,
+  IREE_UK_X16B_MULBF16 = 4,
+  IREE_UK_X16B_MULF16 = 5,
+  IREE_UK_X16B_SUBBF16 = 6,
+  IREE_UK_X16B_SUBF16 = 7,
+  IREE_UK_X16B_COUNT
+} iree_uk_x16b_opcode_t;
+
+typedef enum iree_uk_x16u_opcode_e {
+  IREE_UK_X16U_ABSBF16 = 0,
+  IREE_UK_X16U_ABSF16 = 1,
+  IREE_UK_X16U_CEILBF16 = 2,
+  IREE_UK_X16U_CEILF16 = 3,
+  IREE_UK_X16U_EXPBF16 = 4,
+  IREE_UK_X16U_EXPF16 = 5,
+  IREE_UK_X16U_FLOORBF16 = 6,
+  IREE_UK_X16U_FLOORF16 = 7,
+  IREE_UK_X16U_LOGBF16 = 8,
+  IREE_UK_X16U_LOGF16 = 9,
+  IREE_UK_X16U_NEGBF16 = 10,
+  IREE_UK_X16U_NEGF16 = 11,
+  IREE_UK_X16U_RSQRTBF16 = 12,
+  IREE_UK_X16U_RSQRTF16 = 13,
+  IREE_UK_X16U_COUNT
+} iree_uk_x16u_opcode_t;
+
+// 8-bit opcodes are integer only.
+typedef enum iree_uk_x8b_opcode_e {
+  IREE_UK_X8B_ADDI = 0,
+  IREE_UK_X8B_ANDI = 1,
+  IREE_UK_X8B_DIVSI = 2,
+  IREE_UK_X8B_DIVUI = 3,
+  IREE_UK_X8B_MULI = 4,
+  IREE_UK_X8B_ORI = 5,
+  IREE_UK_X8B_SHLI = 6,
+  IREE_UK_X8B_SHRSI = 7,
+  IREE_UK_X8B_SHRUI = 8,
+  IREE_UK_X8B_SUBI = 9,
+  IREE_UK_X8B_XORI = 10,
+  IREE_UK_X8B_COUNT
+} iree_uk_x8b_opcode_t;
+
+typedef enum iree_uk_x8u_opcode_e {
+  IREE_UK_X8U_CTLZ = 0,
+  IREE_UK_X8U_COUNT
+} iree_uk_x8u_opcode_t;
+
+// Binary row function: out[i] = op(lhs[i], rhs[i]) for i in [0, size).
+// The element type is implied by the opcode the function was selected for.
+// `out` may alias `lhs` or `rhs` exactly, but must not otherwise overlap them.
+typedef void (*iree_uk_elementwise_binary_row_func_t)(
+    const void* lhs, const void* rhs, void* out, iree_uk_index_t size);
+
+// Unary row function: out[i] = op(in[i]) for i in [0, size).
+// `out` may alias `in` exactly, but must not otherwise overlap it.
+typedef void (*iree_uk_elementwise_unary_row_func_t)(const void* in, void* out,
+                                                     iree_uk_index_t size);
+
+// Returns the best row function for `opcode` supported by the CPU described by
+// `cpu_data`, or NULL if there is no architecture-specific implementation, in
+// which case the caller is expected to use a portable fallback. Selection is
+// meant to be done once, ahead of time, not on every call.
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func(iree_uk_x32b_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data);
+IREE_UK_EXPORT iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func(iree_uk_x32u_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data);
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func(iree_uk_x16b_opcode_t opcode,
+                             const iree_uk_uint64_t* cpu_data);
+IREE_UK_EXPORT iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func(iree_uk_x8b_opcode_t opcode,
+                            const iree_uk_uint64_t* cpu_data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
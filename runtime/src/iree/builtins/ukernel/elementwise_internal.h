@@ -0,0 +1,29 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ELEMENTWISE_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_ELEMENTWISE_INTERNAL_H_
+
+#include "iree/builtins/ukernel/elementwise.h"
+
+// Helpers to declare row functions in arch code.
+#define IREE_UK_ELEMENTWISE_BINARY_ROW_FUNC_DECL(NAME)   \
+  void NAME(const void* lhs, const void* rhs, void* out, \
+            iree_uk_index_t size);
+#define IREE_UK_ELEMENTWISE_UNARY_ROW_FUNC_DECL(NAME) \
+  void NAME(const void* in, void* out, iree_uk_index_t size);
+
+// Architecture-specific implementations, returning NULL when unsupported.
+iree_uk_elementwise_binary_row_func_t iree_uk_x32b_select_row_func_arch(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+iree_uk_elementwise_unary_row_func_t iree_uk_x32u_select_row_func_arch(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+iree_uk_elementwise_binary_row_func_t iree_uk_x16b_select_row_func_arch(
+    iree_uk_x16b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+iree_uk_elementwise_binary_row_func_t iree_uk_x8b_select_row_func_arch(
+    iree_uk_x8b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ELEMENTWISE_INTERNAL_H_
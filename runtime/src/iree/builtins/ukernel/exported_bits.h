@@ -49,6 +49,10 @@
 #define IREE_UK_FLAG_MMT4D_TYPE_F16F16F16 0x04
 #define IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32 0x05
 #define IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16 0x06
+// Weight-only quantized types: the RHS is 4-bit signed integers, packed two per
+// byte, the element at even index in the low nibble.
+#define IREE_UK_FLAG_MMT4D_TYPE_I8I4I32 0x07
+#define IREE_UK_FLAG_MMT4D_TYPE_F32I4F32 0x08
 
 // bit flags
 #define IREE_UK_FLAG_MMT4D_ACCUMULATE 0x100
@@ -56,6 +60,35 @@
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_ACCUMULATE);
 #define IREE_UK_FLAG_MMT4D_PREFER_INTRINSICS 0x200
 #define IREE_UK_FLAG_MMT4D_SKIP_INTERMEDIATE_ROUNDINGS 0x400
+// The RHS is dequantized with group-wise scales and optional zero-points given
+// by the rhs_group_* params fields. Only valid with TYPE_F32I4F32.
+#define IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED 0x800
+
+//===----------------------------------------------------------------------===//
+// mmt4d_fused
+//===----------------------------------------------------------------------===//
+
+// type enum. Same values as the corresponding IREE_UK_FLAG_MMT4D_TYPE_*. Only
+// types with a 32-bit accumulator are supported.
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_MASK 0xFF
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_NONE 0x00
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32 0x01
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32 0x02
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_F16F16F32 0x03
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_BF16BF16F32 0x05
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I4I32 0x07
+#define IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32I4F32 0x08
+
+// bit flags. The first ones have the same values as the corresponding
+// IREE_UK_FLAG_MMT4D_*.
+#define IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE 0x100
+#define IREE_UK_FLAG_MMT4D_FUSED_PREFER_INTRINSICS 0x200
+#define IREE_UK_FLAG_MMT4D_FUSED_SKIP_INTERMEDIATE_ROUNDINGS 0x400
+// Epilogue steps, applied in this order. At most one of the BIAS_* flags.
+#define IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW 0x1000
+#define IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN 0x2000
+#define IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8 0x4000
+#define IREE_UK_FLAG_MMT4D_FUSED_CLAMP 0x8000
 
 //===----------------------------------------------------------------------===//
 // pack
@@ -69,6 +102,7 @@ IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_ACCUMULATE);
 #define IREE_UK_FLAG_PACK_TYPE_I32I32 0x03
 #define IREE_UK_FLAG_PACK_TYPE_F16F16 0x04
 #define IREE_UK_FLAG_PACK_TYPE_BF16BF16 0x05
+#define IREE_UK_FLAG_PACK_TYPE_I4I4 0x06
 
 // bit flags
 #define IREE_UK_FLAG_PACK_TRANSPOSE_INNER 0x100
@@ -91,6 +125,26 @@ IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_ACCUMULATE);
 #define IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER 0x100
 #define IREE_UK_FLAG_UNPACK_TRANSPOSE_OUTER 0x200
 
+//===----------------------------------------------------------------------===//
+// conv2d
+//===----------------------------------------------------------------------===//
+
+// type enum. Same values as the corresponding IREE_UK_FLAG_MMT4D_TYPE_*. Only
+// types with a 32-bit accumulator are supported, as the accumulator round-trips
+// through the output buffer between chunks of the reduction.
+#define IREE_UK_FLAG_CONV2D_TYPE_MASK 0xFF
+#define IREE_UK_FLAG_CONV2D_TYPE_NONE 0x00
+#define IREE_UK_FLAG_CONV2D_TYPE_F32F32F32 0x01
+#define IREE_UK_FLAG_CONV2D_TYPE_I8I8I32 0x02
+#define IREE_UK_FLAG_CONV2D_TYPE_F16F16F32 0x03
+#define IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32 0x05
+
+// bit flags
+#define IREE_UK_FLAG_CONV2D_ACCUMULATE 0x100
+#define IREE_UK_FLAG_CONV2D_PREFER_INTRINSICS 0x200
+// The input is NCHW instead of the default NHWC.
+#define IREE_UK_FLAG_CONV2D_INPUT_NCHW 0x400
+
 //===----------------------------------------------------------------------===//
 // query_tile_sizes
 //===----------------------------------------------------------------------===//
@@ -113,5 +167,7 @@ IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_ACCUMULATE);
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16 0x0400
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32 0x0500
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16BF16 0x0600
+#define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I4I32 0x0700
+#define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32I4F32 0x0800
 
 #endif  // IREE_BUILTINS_UKERNEL_EXPORTED_BITS_H_
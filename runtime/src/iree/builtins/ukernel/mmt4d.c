@@ -13,7 +13,8 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
   const iree_uk_uint32_t allflags =
       IREE_UK_FLAG_MMT4D_TYPE_MASK | IREE_UK_FLAG_MMT4D_ACCUMULATE |
       IREE_UK_FLAG_MMT4D_PREFER_INTRINSICS |
-      IREE_UK_FLAG_MMT4D_SKIP_INTERMEDIATE_ROUNDINGS;
+      IREE_UK_FLAG_MMT4D_SKIP_INTERMEDIATE_ROUNDINGS |
+      IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
   IREE_UK_ASSERT(!(params->flags & ~allflags));
   iree_uk_uint32_t flags_type = params->flags & IREE_UK_FLAG_MMT4D_TYPE_MASK;
   IREE_UK_ASSERT(flags_type == IREE_UK_FLAG_MMT4D_TYPE_F32F32F32 ||
@@ -21,7 +22,9 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
                  flags_type == IREE_UK_FLAG_MMT4D_TYPE_F16F16F32 ||
                  flags_type == IREE_UK_FLAG_MMT4D_TYPE_F16F16F16 ||
                  flags_type == IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32 ||
-                 flags_type == IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16);
+                 flags_type == IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_TYPE_I8I4I32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_TYPE_F32I4F32);
   // Some implementations may wish to avoid supporting absurdly wide types. For
   // instance, K is the innermost (i.e. hottest) loop bound, so some 32bit
   // targets may benefit from K being int32, not int64. We still let K be of
@@ -39,6 +42,19 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
   IREE_UK_ASSERT(params->M0 * params->N0 *
                      iree_uk_type_size(iree_uk_mmt4d_out_type(mmt4d_type)) <=
                  iree_uk_mmt4d_tile_generic_max_bytes);
+  // Sub-byte RHS elements are packed in whole bytes, so RHS tiles and panels
+  // must start on byte boundaries.
+  if (iree_uk_type_bit_count(iree_uk_mmt4d_rhs_type(mmt4d_type)) < 8) {
+    IREE_UK_ASSERT(!((params->N0 * params->K0) & 1));
+    IREE_UK_ASSERT(!(params->rhs_offset & 1));
+    IREE_UK_ASSERT(!(params->rhs_stride0 & 1));
+  }
+  if (params->flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED) {
+    IREE_UK_ASSERT(flags_type == IREE_UK_FLAG_MMT4D_TYPE_F32I4F32);
+    IREE_UK_ASSERT(params->rhs_group_scales_buffer);
+    IREE_UK_ASSERT(params->rhs_group_size > 0);
+    IREE_UK_ASSERT(params->rhs_group_size % params->K0 == 0);
+  }
 #endif  // IREE_UK_ENABLE_ASSERTS
 }
 
@@ -59,18 +75,33 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
   const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
   const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
   const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
-  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
   const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
   char* out_tile_row =
       (char*)params->out_buffer + (params->out_offset << out_elem_size_log2);
   const char* lhs_panel = (const char*)params->lhs_buffer +
                           (params->lhs_offset << lhs_elem_size_log2);
-  const char* rhs_panel_start = (const char*)params->rhs_buffer +
-                                (params->rhs_offset << rhs_elem_size_log2);
+  // The RHS type may be sub-byte (e.g. int4), so its byte offsets are not
+  // simply shifts by a size_log2.
+  const char* rhs_panel_start =
+      (const char*)params->rhs_buffer +
+      iree_uk_type_elems_to_bytes(rhs_type, params->rhs_offset);
   iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
   iree_uk_index_t lhs_panel_stride = params->lhs_stride0 << lhs_elem_size_log2;
-  iree_uk_index_t rhs_panel_stride = params->rhs_stride0 << rhs_elem_size_log2;
+  iree_uk_index_t rhs_panel_stride =
+      iree_uk_type_elems_to_bytes(rhs_type, params->rhs_stride0);
   iree_uk_index_t out_stride = params->out_stride0 << out_elem_size_log2;
+  // With a group-quantized RHS, the tile_func finds the scales and zero-points
+  // of the current RHS panel at `rhs_group_offset`, so we advance that in a
+  // local copy of params alongside `rhs_panel`.
+  const bool rhs_group_quantized =
+      params->flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
+  iree_uk_mmt4d_params_t group_quantized_params;
+  iree_uk_index_t rhs_group_offset_start = 0;
+  if (rhs_group_quantized) {
+    group_quantized_params = *params;
+    rhs_group_offset_start = params->rhs_group_offset;
+    params = &group_quantized_params;
+  }
   for (iree_uk_int32_t i = 0; i < M; ++i) {
     char* out_tile = out_tile_row;
     const char* rhs_panel = rhs_panel_start;
@@ -79,6 +110,11 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
     IREE_UK_PREFETCH_RO(lhs_panel, IREE_UK_PREFETCH_LOCALITY_L1);
     IREE_UK_PREFETCH_RO(rhs_panel, IREE_UK_PREFETCH_LOCALITY_L1);
     for (iree_uk_int32_t j = 0; j < N; ++j) {
+      if (rhs_group_quantized) {
+        group_quantized_params.rhs_group_offset =
+            group_quantized_params.rhs_group_stride0 * j +
+            rhs_group_offset_start;
+      }
       tile_func(out_tile, lhs_panel, rhs_panel, K, params->flags, params);
       out_tile += out_tile_size;
       rhs_panel += rhs_panel_stride;
@@ -34,6 +34,23 @@ typedef struct iree_uk_mmt4d_params_t {
   iree_uk_int32_t K0;
   iree_uk_uint32_t flags;
   const iree_uk_uint64_t* cpu_data;
+  // Group-wise RHS dequantization parameters. These are only read when `flags`
+  // has IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED. They come after `cpu_data`
+  // because compiler-generated code passes the above fields positionally, with
+  // `cpu_data` appended as the `processor_data` import field, and never sets
+  // that flag.
+  //
+  // Scales and zero-points are f32 arrays of shape
+  // [N][ceil(K * K0 / rhs_group_size)][N0], sharing the same offset and outer
+  // stride. The dequantized value of a RHS element q is (q - zero_point) *
+  // scale. The zero-points buffer may be NULL, meaning all zero-points are 0.
+  const void* rhs_group_scales_buffer;
+  const void* rhs_group_zero_points_buffer;
+  iree_uk_index_t rhs_group_offset;
+  iree_uk_index_t rhs_group_stride0;
+  // Number of consecutive elements along the (unpacked) K dimension sharing
+  // the same scale and zero-point. Must be a multiple of K0.
+  iree_uk_int32_t rhs_group_size;
 } iree_uk_mmt4d_params_t;
 
 IREE_UK_EXPORT int iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params);
@@ -0,0 +1,302 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/mmt4d_fused.h"
+
+#include "iree/builtins/ukernel/mmt4d_fused_internal.h"
+
+static void iree_uk_mmt4d_fused_validate(
+    const iree_uk_mmt4d_fused_params_t* params) {
+#ifdef IREE_UK_ENABLE_ASSERTS
+  const iree_uk_uint32_t allflags =
+      IREE_UK_FLAG_MMT4D_FUSED_TYPE_MASK | IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE |
+      IREE_UK_FLAG_MMT4D_FUSED_PREFER_INTRINSICS |
+      IREE_UK_FLAG_MMT4D_FUSED_SKIP_INTERMEDIATE_ROUNDINGS |
+      IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW |
+      IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN |
+      IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8 | IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+  IREE_UK_ASSERT(!(params->flags & ~allflags));
+  iree_uk_uint32_t flags_type =
+      params->flags & IREE_UK_FLAG_MMT4D_FUSED_TYPE_MASK;
+  IREE_UK_ASSERT(flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_F16F16F32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_BF16BF16F32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I4I32 ||
+                 flags_type == IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32I4F32);
+  IREE_UK_ASSERT(!((params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW) &&
+                   (params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN)));
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_fused_type(params->flags);
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  if (params->flags & IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8) {
+    // The accumulator does not round-trip through the int8 output.
+    IREE_UK_ASSERT(acc_type == IREE_UK_TYPE_INT_32);
+    IREE_UK_ASSERT(!(params->flags & IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE));
+    IREE_UK_ASSERT(params->out_zero_point >= IREE_UK_INT8_MIN &&
+                   params->out_zero_point <= IREE_UK_INT8_MAX);
+  }
+  if (params->flags & (IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW |
+                       IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN)) {
+    IREE_UK_ASSERT(params->bias_buffer);
+  }
+  // Same ranges as enforced by mmt4d.
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->M, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->M0, 15));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N0, 15));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K0, 15));
+  // The accumulator tile must fit in the stack buffer that it is computed into
+  // when requantizing, which has the same size as the generic tile functions'.
+  IREE_UK_ASSERT(params->M0 * params->N0 * iree_uk_type_size(acc_type) <=
+                 iree_uk_mmt4d_tile_generic_max_bytes);
+  if (iree_uk_type_bit_count(iree_uk_mmt4d_rhs_type(mmt4d_type)) < 8) {
+    IREE_UK_ASSERT(!((params->N0 * params->K0) & 1));
+    IREE_UK_ASSERT(!(params->rhs_offset & 1));
+    IREE_UK_ASSERT(!(params->rhs_stride0 & 1));
+  }
+#endif  // IREE_UK_ENABLE_ASSERTS
+}
+
+// Converts `x` to the nearest int32, rounding half away from zero, and
+// saturating, so that e.g. infinite clamp bounds are well-defined.
+static iree_uk_int32_t iree_uk_mmt4d_fused_round_to_i32(float x) {
+  // Not (float)IREE_UK_INT32_MIN: that macro has an unsigned type.
+  if (x <= -2147483648.f) return IREE_UK_INT32_MIN;
+  if (x >= 2147483648.f) return IREE_UK_INT32_MAX;
+  return (iree_uk_int32_t)(x >= 0.f ? x + 0.5f : x - 0.5f);
+}
+
+// Returns `a + b` wrapping around on overflow, like the int32 accumulation in
+// the tile functions, instead of the undefined behavior of signed overflow.
+static inline iree_uk_int32_t iree_uk_mmt4d_fused_add_i32(iree_uk_int32_t a,
+                                                          iree_uk_int32_t b) {
+  return (iree_uk_int32_t)((iree_uk_uint32_t)a + (iree_uk_uint32_t)b);
+}
+
+// The per-tile epilogue state that does not change from tile to tile.
+typedef struct iree_uk_mmt4d_fused_epilogue_t {
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_uint32_t flags;
+  float requantize_scale;
+  iree_uk_int32_t out_zero_point;
+  float clamp_min_f32;
+  float clamp_max_f32;
+  iree_uk_int32_t clamp_min_i32;
+  iree_uk_int32_t clamp_max_i32;
+} iree_uk_mmt4d_fused_epilogue_t;
+
+// In the epilogue functions below, `bias` points to the bias values of this
+// tile's rows or columns, or is NULL if there is no bias.
+
+static void iree_uk_mmt4d_fused_epilogue_f32(
+    const iree_uk_mmt4d_fused_epilogue_t* epilogue,
+    float* IREE_UK_RESTRICT tile, const float* IREE_UK_RESTRICT bias) {
+  const bool clamp = epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+  const bool bias_per_row =
+      epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+  for (iree_uk_int32_t r = 0; r < epilogue->M0; ++r) {
+    for (iree_uk_int32_t c = 0; c < epilogue->N0; ++c) {
+      float v = tile[r * epilogue->N0 + c];
+      if (bias) v += (bias_per_row ? bias[r] : bias[c]);
+      if (clamp) {
+        v = v < epilogue->clamp_min_f32 ? epilogue->clamp_min_f32 : v;
+        v = v > epilogue->clamp_max_f32 ? epilogue->clamp_max_f32 : v;
+      }
+      tile[r * epilogue->N0 + c] = v;
+    }
+  }
+}
+
+static void iree_uk_mmt4d_fused_epilogue_i32(
+    const iree_uk_mmt4d_fused_epilogue_t* epilogue,
+    iree_uk_int32_t* IREE_UK_RESTRICT tile,
+    const iree_uk_int32_t* IREE_UK_RESTRICT bias) {
+  const bool clamp = epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+  const bool bias_per_row =
+      epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+  for (iree_uk_int32_t r = 0; r < epilogue->M0; ++r) {
+    for (iree_uk_int32_t c = 0; c < epilogue->N0; ++c) {
+      iree_uk_int32_t v = tile[r * epilogue->N0 + c];
+      if (bias) {
+        v = iree_uk_mmt4d_fused_add_i32(v, bias_per_row ? bias[r] : bias[c]);
+      }
+      if (clamp) {
+        v = v < epilogue->clamp_min_i32 ? epilogue->clamp_min_i32 : v;
+        v = v > epilogue->clamp_max_i32 ? epilogue->clamp_max_i32 : v;
+      }
+      tile[r * epilogue->N0 + c] = v;
+    }
+  }
+}
+
+static void iree_uk_mmt4d_fused_epilogue_requantize_i8(
+    const iree_uk_mmt4d_fused_epilogue_t* epilogue,
+    const iree_uk_int32_t* IREE_UK_RESTRICT acc_tile,
+    iree_uk_int8_t* IREE_UK_RESTRICT out_tile,
+    const iree_uk_int32_t* IREE_UK_RESTRICT bias) {
+  // Clamping to the int8 range is the saturation of the requantization, and
+  // the CLAMP flag can only narrow that range further.
+  const bool bias_per_row =
+      epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+  iree_uk_int32_t lo = IREE_UK_INT8_MIN;
+  iree_uk_int32_t hi = IREE_UK_INT8_MAX;
+  if (epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_CLAMP) {
+    lo = iree_uk_index_max(lo, epilogue->clamp_min_i32);
+    hi = iree_uk_index_min(hi, epilogue->clamp_max_i32);
+  }
+  for (iree_uk_int32_t r = 0; r < epilogue->M0; ++r) {
+    for (iree_uk_int32_t c = 0; c < epilogue->N0; ++c) {
+      iree_uk_int32_t v = acc_tile[r * epilogue->N0 + c];
+      if (bias) {
+        v = iree_uk_mmt4d_fused_add_i32(v, bias_per_row ? bias[r] : bias[c]);
+      }
+      // Any scaled value outside of [-256, 256] saturates anyway, given the
+      // zero point range. Clamping it first keeps the addition from
+      // overflowing.
+      float scaled = (float)v * epilogue->requantize_scale;
+      scaled = scaled < -256.f ? -256.f : scaled;
+      scaled = scaled > 256.f ? 256.f : scaled;
+      v = iree_uk_mmt4d_fused_round_to_i32(scaled) + epilogue->out_zero_point;
+      v = v < lo ? lo : v;
+      v = v > hi ? hi : v;
+      out_tile[r * epilogue->N0 + c] = (iree_uk_int8_t)v;
+    }
+  }
+}
+
+// Applies the epilogue to one tile. `acc_tile` is the accumulator tile just
+// computed by the tile function. When not requantizing, it is also the output
+// tile, and is updated in place.
+static void iree_uk_mmt4d_fused_epilogue(
+    const iree_uk_mmt4d_fused_epilogue_t* epilogue, iree_uk_type_t acc_type,
+    void* acc_tile, void* out_tile, const void* bias) {
+  if (epilogue->flags & IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8) {
+    iree_uk_mmt4d_fused_epilogue_requantize_i8(epilogue, acc_tile, out_tile,
+                                               bias);
+  } else if (acc_type == IREE_UK_TYPE_INT_32) {
+    iree_uk_mmt4d_fused_epilogue_i32(epilogue, acc_tile, bias);
+  } else {
+    iree_uk_mmt4d_fused_epilogue_f32(epilogue, acc_tile, bias);
+  }
+}
+
+IREE_UK_EXPORT int iree_uk_mmt4d_fused(
+    const iree_uk_mmt4d_fused_params_t* params) {
+  iree_uk_mmt4d_fused_validate(params);
+
+  // Trivial case. Unlike in mmt4d, K == 0 is not trivial, as the epilogue
+  // still applies to the zero or existing accumulator.
+  if (params->M == 0 || params->N == 0) return 0;
+
+  // Select the mmt4d tile_func computing the accumulator tiles.
+  iree_uk_mmt4d_params_t mmt4d_params = {
+      .M = params->M,
+      .N = params->N,
+      .K = params->K,
+      .M0 = params->M0,
+      .N0 = params->N0,
+      .K0 = params->K0,
+      .flags = iree_uk_mmt4d_fused_mmt4d_flags(params->flags),
+      .cpu_data = params->cpu_data,
+  };
+  iree_uk_mmt4d_tile_func_t tile_func =
+      iree_uk_mmt4d_select_tile_func(&mmt4d_params);
+
+  iree_uk_mmt4d_fused_epilogue_t epilogue = {
+      .M0 = params->M0,
+      .N0 = params->N0,
+      .flags = params->flags,
+      .requantize_scale = params->requantize_scale,
+      .out_zero_point = params->out_zero_point,
+      .clamp_min_f32 = params->clamp_min,
+      .clamp_max_f32 = params->clamp_max,
+      .clamp_min_i32 = iree_uk_mmt4d_fused_round_to_i32(params->clamp_min),
+      .clamp_max_i32 = iree_uk_mmt4d_fused_round_to_i32(params->clamp_max),
+  };
+
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_fused_type(params->flags);
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  const iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  const iree_uk_type_t out_type = iree_uk_mmt4d_fused_out_type(params->flags);
+  const int lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
+  const int acc_elem_size_log2 = iree_uk_type_size_log2(acc_type);
+  const int out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const iree_uk_index_t out_tile_size = (params->M0 * params->N0)
+                                        << out_elem_size_log2;
+  const iree_uk_index_t out_stride = params->out_stride0 << out_elem_size_log2;
+  const iree_uk_index_t lhs_panel_stride = params->lhs_stride0
+                                           << lhs_elem_size_log2;
+  const iree_uk_index_t rhs_panel_stride =
+      iree_uk_type_elems_to_bytes(rhs_type, params->rhs_stride0);
+  char* out_tile_row =
+      (char*)params->out_buffer + (params->out_offset << out_elem_size_log2);
+  const char* lhs_panel = (const char*)params->lhs_buffer +
+                          (params->lhs_offset << lhs_elem_size_log2);
+  const char* rhs_panel_start =
+      (const char*)params->rhs_buffer +
+      iree_uk_type_elems_to_bytes(rhs_type, params->rhs_offset);
+
+  // Bias values for the current tile are found at `bias_row` + `bias_col`:
+  // per-row bias only advances with i, per-column bias only with j.
+  const bool bias_per_row =
+      params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+  const bool bias_per_col =
+      params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN;
+  const char* bias_row = 0;
+  iree_uk_index_t bias_row_stride = 0;
+  iree_uk_index_t bias_col_stride = 0;
+  if (bias_per_row || bias_per_col) {
+    bias_row = (const char*)params->bias_buffer +
+               (params->bias_offset << acc_elem_size_log2);
+    iree_uk_index_t bias_stride = params->bias_stride0 << acc_elem_size_log2;
+    if (bias_per_row) {
+      bias_row_stride = bias_stride;
+    } else {
+      bias_col_stride = bias_stride;
+    }
+  }
+
+  // When requantizing, the accumulator tile is computed in a stack buffer and
+  // the epilogue writes the narrower output tile from it.
+  const bool requantize =
+      params->flags & IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8;
+  IREE_UK_ATTRIBUTE_ALIGNED(64)
+  char acc_tile_buf[iree_uk_mmt4d_tile_generic_max_bytes];
+  const iree_uk_index_t acc_tile_size = (params->M0 * params->N0)
+                                        << acc_elem_size_log2;
+
+  for (iree_uk_index_t i = 0; i < params->M; ++i) {
+    char* out_tile = out_tile_row;
+    const char* rhs_panel = rhs_panel_start;
+    const char* bias = bias_row;
+    IREE_UK_PREFETCH_RW(out_tile_row, IREE_UK_PREFETCH_LOCALITY_L3);
+    IREE_UK_PREFETCH_RO(lhs_panel, IREE_UK_PREFETCH_LOCALITY_L1);
+    IREE_UK_PREFETCH_RO(rhs_panel, IREE_UK_PREFETCH_LOCALITY_L1);
+    for (iree_uk_index_t j = 0; j < params->N; ++j) {
+      void* acc_tile = requantize ? acc_tile_buf : out_tile;
+      if (params->K == 0) {
+        if (!(params->flags & IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE)) {
+          iree_uk_memset(acc_tile, 0, acc_tile_size);
+        }
+      } else {
+        tile_func(acc_tile, lhs_panel, rhs_panel, params->K, mmt4d_params.flags,
+                  &mmt4d_params);
+      }
+      iree_uk_mmt4d_fused_epilogue(&epilogue, acc_type, acc_tile, out_tile,
+                                   bias);
+      out_tile += out_tile_size;
+      rhs_panel += rhs_panel_stride;
+      if (bias) bias += bias_col_stride;
+    }
+    out_tile_row += out_stride;
+    lhs_panel += lhs_panel_stride;
+    if (bias_row) bias_row += bias_row_stride;
+  }
+  return 0;
+}
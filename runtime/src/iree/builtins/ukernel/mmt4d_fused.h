@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_MMT4D_FUSED_H_
+#define IREE_BUILTINS_UKERNEL_MMT4D_FUSED_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// `mmt4d_fused` microkernel: `mmt4d` followed by an elementwise epilogue that
+// is applied to each M0xN0 output tile right after it is computed, while it is
+// still cache-resident. This saves the separate dispatch that would otherwise
+// reread the whole output to add a bias, clamp or requantize it.
+//
+// The epilogue steps are selected by flags, and applied in this order:
+// 1. IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW / _BIAS_PER_COLUMN: add a bias of
+//    the accumulator type, packed like the output rows or columns, i.e. with
+//    shape [M][M0] or [N][N0] and outer stride `bias_stride0`.
+// 2. IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8: only with int32 accumulators.
+//    Convert the accumulator to an int8 output as
+//    round(acc * requantize_scale) + out_zero_point, saturating. The output
+//    buffer then has int8 elements, and ACCUMULATE is not allowed.
+// 3. IREE_UK_FLAG_MMT4D_FUSED_CLAMP: clamp to [clamp_min, clamp_max]. With
+//    integer outputs, the bounds are rounded to the nearest integer. For
+//    example, ReLU is a clamp to [0, +inf].
+//
+// The layout of this struct is what compiler-generated code passes. The bias
+// buffer is always passed; it is only read with one of the BIAS_* flags.
+typedef struct iree_uk_mmt4d_fused_params_t {
+  const void* lhs_buffer;
+  iree_uk_index_t lhs_offset;
+  iree_uk_index_t lhs_stride0;
+  const void* rhs_buffer;
+  iree_uk_index_t rhs_offset;
+  iree_uk_index_t rhs_stride0;
+  const void* bias_buffer;
+  iree_uk_index_t bias_offset;
+  iree_uk_index_t bias_stride0;
+  void* out_buffer;
+  iree_uk_index_t out_offset;
+  iree_uk_index_t out_stride0;
+  iree_uk_index_t M;
+  iree_uk_index_t N;
+  iree_uk_index_t K;
+  iree_uk_int32_t M0;
+  iree_uk_int32_t N0;
+  iree_uk_int32_t K0;
+  float requantize_scale;
+  iree_uk_int32_t out_zero_point;
+  float clamp_min;
+  float clamp_max;
+  iree_uk_uint32_t flags;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_mmt4d_fused_params_t;
+
+IREE_UK_EXPORT int iree_uk_mmt4d_fused(
+    const iree_uk_mmt4d_fused_params_t* params);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_MMT4D_FUSED_H_
@@ -0,0 +1,59 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_MMT4D_FUSED_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_MMT4D_FUSED_INTERNAL_H_
+
+#include "iree/builtins/ukernel/mmt4d_fused.h"
+#include "iree/builtins/ukernel/mmt4d_internal.h"
+
+// The mmt4d_fused type flags and the flags that are passed through to the
+// mmt4d tile function share their values with the corresponding mmt4d flags.
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_F32F32F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_I8I8I32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F16F16F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_F16F16F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_BF16BF16F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I4I32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_I8I4I32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32I4F32 ==
+                      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE ==
+                      IREE_UK_FLAG_MMT4D_ACCUMULATE);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_PREFER_INTRINSICS ==
+                      IREE_UK_FLAG_MMT4D_PREFER_INTRINSICS);
+IREE_UK_STATIC_ASSERT(IREE_UK_FLAG_MMT4D_FUSED_SKIP_INTERMEDIATE_ROUNDINGS ==
+                      IREE_UK_FLAG_MMT4D_SKIP_INTERMEDIATE_ROUNDINGS);
+
+// Returns the mmt4d type of the matmul part. Its out type is the accumulator
+// type, which is also the output type unless requantizing.
+static inline iree_uk_mmt4d_type_t iree_uk_mmt4d_fused_type(
+    iree_uk_uint32_t flags) {
+  return iree_uk_mmt4d_type(flags & IREE_UK_FLAG_MMT4D_FUSED_TYPE_MASK);
+}
+
+// Returns the type of the output buffer elements.
+static inline iree_uk_type_t iree_uk_mmt4d_fused_out_type(
+    iree_uk_uint32_t flags) {
+  return (flags & IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8)
+             ? IREE_UK_TYPE_INT_8
+             : iree_uk_mmt4d_out_type(iree_uk_mmt4d_fused_type(flags));
+}
+
+// Returns the flags to pass to the mmt4d tile function, given mmt4d_fused
+// `flags`.
+static inline iree_uk_uint32_t iree_uk_mmt4d_fused_mmt4d_flags(
+    iree_uk_uint32_t flags) {
+  return flags & (IREE_UK_FLAG_MMT4D_FUSED_TYPE_MASK |
+                  IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE |
+                  IREE_UK_FLAG_MMT4D_FUSED_PREFER_INTRINSICS |
+                  IREE_UK_FLAG_MMT4D_FUSED_SKIP_INTERMEDIATE_ROUNDINGS);
+}
+
+#endif  // IREE_BUILTINS_UKERNEL_MMT4D_FUSED_INTERNAL_H_
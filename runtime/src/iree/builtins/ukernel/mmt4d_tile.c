@@ -226,6 +226,100 @@ static void iree_uk_mmt4d_tile_bf16bf16bf16_generic(
   for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
 }
 
+// Generic implementation of matmul tile, i8*i4->i32 case.
+static void iree_uk_mmt4d_tile_i8i4i32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* out_tile = out_tile_untyped;
+  const iree_uk_int8_t* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint8_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  // Initialize the local accumulator tile.
+  iree_uk_int32_t acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_index_t k = 0; k < K; ++k) {
+    for (iree_uk_index_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_index_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_index_t k0 = 0; k0 < K0; ++k0) {
+          iree_uk_int32_t lhs_i32 = lhs_panel[i0 * K0 + k0];
+          iree_uk_int32_t rhs_i32 =
+              iree_uk_load_packed_i4(rhs_panel, j0 * K0 + k0);
+          acc[i0 * N0 + j0] += lhs_i32 * rhs_i32;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += (N0 * K0) >> 1;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
+// Generic implementation of matmul tile, f32*i4->f32 case. The RHS is
+// dequantized with group-wise scales and zero-points if the flags have
+// IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED, and converted as-is otherwise.
+static void iree_uk_mmt4d_tile_f32i4f32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* out_tile = out_tile_untyped;
+  const float* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint8_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  const float* scales = 0;
+  const float* zero_points = 0;
+  iree_uk_int32_t group_size = 0;
+  if (flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED) {
+    scales = (const float*)params->rhs_group_scales_buffer +
+             params->rhs_group_offset;
+    if (params->rhs_group_zero_points_buffer) {
+      zero_points = (const float*)params->rhs_group_zero_points_buffer +
+                    params->rhs_group_offset;
+    }
+    group_size = params->rhs_group_size;
+  }
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_index_t k = 0; k < K; ++k) {
+    // The group size is a multiple of K0, so all of this K0-slice of the RHS
+    // panel is in the same group.
+    iree_uk_index_t group_offset = scales ? (k * K0 / group_size) * N0 : 0;
+    for (iree_uk_index_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_index_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_index_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_f32 = lhs_panel[i0 * K0 + k0];
+          float rhs_f32 = iree_uk_load_packed_i4(rhs_panel, j0 * K0 + k0);
+          if (scales) {
+            if (zero_points) rhs_f32 -= zero_points[group_offset + j0];
+            rhs_f32 *= scales[group_offset + j0];
+          }
+          acc[i0 * N0 + j0] += lhs_f32 * rhs_f32;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += (N0 * K0) >> 1;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
 static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
     const iree_uk_mmt4d_params_t* params) {
   switch (iree_uk_mmt4d_type(params->flags)) {
@@ -241,6 +335,10 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
       return iree_uk_mmt4d_tile_bf16bf16f32_generic;
     case iree_uk_mmt4d_type_bf16bf16bf16:
       return iree_uk_mmt4d_tile_bf16bf16bf16_generic;
+    case iree_uk_mmt4d_type_i8i4i32:
+      return iree_uk_mmt4d_tile_i8i4i32_generic;
+    case iree_uk_mmt4d_type_f32i4f32:
+      return iree_uk_mmt4d_tile_f32i4f32_generic;
     default:
       // shouldn't happen, validated earlier.
       IREE_UK_ASSUME_UNREACHABLE;
@@ -252,7 +252,41 @@ static void iree_uk_pack_using_tile_func(const iree_uk_pack_params_t* params,
   }
 }
 
+// Packing int4 data is the same as packing int8 data with halved sizes and
+// strides along dimension 1, as long as these are all even: pairs of int4
+// values sharing a byte are adjacent along dimension 1 and stay so after
+// packing. That does not hold with IREE_UK_FLAG_PACK_TRANSPOSE_INNER, which is
+// not supported for int4.
+static void iree_uk_pack_i4_as_i8(const iree_uk_pack_params_t* params,
+                                  iree_uk_pack_params_t* i8_params) {
+  IREE_UK_ASSERT(!(params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER));
+  IREE_UK_ASSERT(!(params->in_offset & 1));
+  IREE_UK_ASSERT(!(params->in_stride0 & 1));
+  IREE_UK_ASSERT(!(params->in_size1 & 1));
+  IREE_UK_ASSERT(!(params->out_offset & 1));
+  IREE_UK_ASSERT(!(params->out_stride0 & 1));
+  IREE_UK_ASSERT(!(params->out_size3 & 1));
+  *i8_params = *params;
+  i8_params->flags = (params->flags & ~IREE_UK_FLAG_PACK_TYPE_MASK) |
+                     IREE_UK_FLAG_PACK_TYPE_I8I8;
+  i8_params->in_offset = params->in_offset >> 1;
+  i8_params->in_stride0 = params->in_stride0 >> 1;
+  i8_params->in_size1 = params->in_size1 >> 1;
+  i8_params->out_offset = params->out_offset >> 1;
+  i8_params->out_stride0 = params->out_stride0 >> 1;
+  i8_params->out_size3 = params->out_size3 >> 1;
+  iree_uk_uint8_t padding_nibble = params->padding_value & 0xF;
+  i8_params->padding_value = padding_nibble | (padding_nibble << 4);
+}
+
 IREE_UK_EXPORT int iree_uk_pack(const iree_uk_pack_params_t* params) {
+  iree_uk_pack_params_t i8_params;
+  if ((params->flags & IREE_UK_FLAG_PACK_TYPE_MASK) ==
+      IREE_UK_FLAG_PACK_TYPE_I4I4) {
+    iree_uk_pack_i4_as_i8(params, &i8_params);
+    params = &i8_params;
+  }
+
   iree_uk_pack_validate(params);
 
   if (iree_uk_pack_early(params)) return 0;
@@ -16,6 +16,9 @@ typedef enum iree_uk_pack_type_t {
   iree_uk_pack_type_f16f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_16, FLOAT_16),
   iree_uk_pack_type_bf16bf16 =
       IREE_UK_TIE_2_TYPES_LITERAL(BFLOAT_16, BFLOAT_16),
+  // Only used to describe the parameters: iree_uk_pack rewrites int4 packs as
+  // int8 packs before validating them.
+  iree_uk_pack_type_i4i4 = IREE_UK_TIE_2_TYPES_LITERAL(INT_4, INT_4),
 } iree_uk_pack_type_t;
 
 static inline iree_uk_pack_type_t iree_uk_pack_type(iree_uk_uint32_t flags) {
@@ -30,6 +33,8 @@ static inline iree_uk_pack_type_t iree_uk_pack_type(iree_uk_uint32_t flags) {
       return iree_uk_pack_type_f16f16;
     case IREE_UK_FLAG_PACK_TYPE_BF16BF16:
       return iree_uk_pack_type_bf16bf16;
+    case IREE_UK_FLAG_PACK_TYPE_I4I4:
+      return iree_uk_pack_type_i4i4;
     default:
       IREE_UK_ASSUME_UNREACHABLE;
   }
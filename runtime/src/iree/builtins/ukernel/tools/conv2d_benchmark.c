@@ -0,0 +1,151 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/conv2d_internal.h"
+#include "iree/builtins/ukernel/tools/benchmark.h"
+#include "iree/builtins/ukernel/tools/util.h"
+
+IREE_FLAG(int32_t, batch_size, 1, "Batch size of conv2d ops.");
+IREE_FLAG(int32_t, in_size, 56,
+          "Height and width of the input image, excluding padding.");
+IREE_FLAG(int32_t, in_channels, 64, "Number of input channels.");
+IREE_FLAG(int32_t, out_channels, 64, "Number of output channels.");
+IREE_FLAG(int32_t, kernel_size, 3, "Height and width of the filter.");
+IREE_FLAG(int32_t, stride, 1, "Stride of the convolution.");
+IREE_FLAG(int32_t, padding, 1,
+          "Zero padding on each side of the input image.");
+IREE_FLAG(bool, nchw, false, "Whether the input is NCHW rather than NHWC.");
+IREE_FLAG(bool, accumulate, false,
+          "Whether the kernel should accumulate into the existing accumulator "
+          "tile values, or zero the accumulator tile.");
+
+static iree_status_t iree_uk_benchmark_conv2d(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_uk_benchmark_user_data_t* user_data = benchmark_def->user_data;
+  const iree_uk_conv2d_params_t* src_params =
+      iree_uk_benchmark_params(user_data);
+  iree_uk_conv2d_params_t params;
+  memcpy(&params, src_params, sizeof params);
+  params.cpu_data = iree_uk_benchmark_cpu_data(user_data);
+  if (FLAG_accumulate) params.flags |= IREE_UK_FLAG_CONV2D_ACCUMULATE;
+  if (FLAG_nchw) params.flags |= IREE_UK_FLAG_CONV2D_INPUT_NCHW;
+  params.batch_size = FLAG_batch_size;
+  params.in_height = FLAG_in_size;
+  params.in_width = FLAG_in_size;
+  params.in_channels = FLAG_in_channels;
+  params.out_channels = FLAG_out_channels;
+  params.kernel_height = FLAG_kernel_size;
+  params.kernel_width = FLAG_kernel_size;
+  params.stride_height = FLAG_stride;
+  params.stride_width = FLAG_stride;
+  params.dilation_height = 1;
+  params.dilation_width = 1;
+  params.padding_top = FLAG_padding;
+  params.padding_left = FLAG_padding;
+  params.out_height =
+      (FLAG_in_size + 2 * FLAG_padding - FLAG_kernel_size) / FLAG_stride + 1;
+  params.out_width = params.out_height;
+  iree_uk_index_t M = params.batch_size * params.out_height * params.out_width;
+  iree_uk_index_t N = params.out_channels;
+  iree_uk_index_t K =
+      params.kernel_height * params.kernel_width * params.in_channels;
+  iree_uk_index_t M_outer = (M + params.M0 - 1) / params.M0;
+  iree_uk_index_t N_outer = (N + params.N0 - 1) / params.N0;
+  iree_uk_index_t K_outer = (K + params.K0 - 1) / params.K0;
+  params.in_stride0 = params.in_channels * params.in_height * params.in_width;
+  params.filter_stride0 = K_outer * params.N0 * params.K0;
+  params.out_stride0 = N_outer * params.M0 * params.N0;
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params.flags);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  iree_uk_index_t in_buffer_size =
+      iree_uk_2d_buffer_length(lhs_type, params.batch_size, params.in_stride0);
+  iree_uk_index_t filter_buffer_size =
+      iree_uk_2d_buffer_length(rhs_type, N_outer, params.filter_stride0);
+  iree_uk_index_t out_buffer_size =
+      iree_uk_2d_buffer_length(out_type, M_outer, params.out_stride0);
+  void* in_buffer = malloc(in_buffer_size);
+  void* filter_buffer = malloc(filter_buffer_size);
+  void* out_buffer = malloc(out_buffer_size);
+  iree_uk_random_engine_t* engine = iree_uk_benchmark_random_engine(user_data);
+  iree_uk_write_random_buffer(in_buffer, in_buffer_size, lhs_type, engine);
+  iree_uk_write_random_buffer(filter_buffer, filter_buffer_size, rhs_type,
+                              engine);
+  iree_uk_write_random_buffer(out_buffer, out_buffer_size, out_type, engine);
+  params.in_buffer = in_buffer;
+  params.filter_buffer = filter_buffer;
+  params.out_buffer = out_buffer;
+  int64_t total_iterations = 0;
+  int64_t batch_count = 1;
+  while (iree_benchmark_keep_running(benchmark_state, batch_count)) {
+    for (int i = 0; i < batch_count; ++i) {
+      iree_uk_conv2d(&params);
+    }
+    total_iterations += batch_count;
+    batch_count *= 2;
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     total_iterations * 2 * M * N * K);
+  free(in_buffer);
+  free(filter_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+static void iree_uk_benchmark_register_conv2d(iree_uk_uint32_t flags, int M0,
+                                              int N0, int K0,
+                                              const char* cpu_features) {
+  char type_str[32];
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(flags);
+  iree_uk_type_triple_str(type_str, sizeof type_str, mmt4d_type);
+  char name[128];
+  snprintf(name, sizeof name, "conv2d_%s_tile_%dx%dx%d", type_str, M0, N0, K0);
+  iree_uk_conv2d_params_t params = {
+      .flags = flags, .M0 = M0, .N0 = N0, .K0 = K0};
+  iree_uk_benchmark_register(name, iree_uk_benchmark_conv2d, &params,
+                             sizeof params, cpu_features);
+}
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage("conv2d_benchmark", "");
+
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
+  iree_uk_benchmark_initialize(&argc, argv);
+
+#if defined(IREE_ARCH_ARM_64)
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 8, 8, 1,
+                                    "");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 4,
+                                    "dotprod");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 8,
+                                    "i8mm");
+#elif defined(IREE_ARCH_X86_64)
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 8, 8, 1,
+                                    "avx2_fma");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 16, 16,
+                                    1, "avx512_base");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 2,
+                                    "avx2_fma");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 16, 16, 2,
+                                    "avx512_vnni");
+#else   // defined(IREE_ARCH_ARM_64)
+  // Architectures on which we do not have any optimized ukernel code.
+  // Benchmark some arbitrary tile shape.
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 8, 8, 1,
+                                    "");
+  iree_uk_benchmark_register_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 1,
+                                    "");
+#endif  // defined(IREE_ARCH_ARM_64)
+
+  iree_uk_benchmark_run_and_cleanup();
+}
@@ -0,0 +1,349 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/api.h"
+#include "iree/base/internal/math.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/conv2d_internal.h"
+#include "iree/builtins/ukernel/tools/test.h"
+#include "iree/builtins/ukernel/tools/util.h"
+
+// Loads an element of one of the LHS/RHS types of conv2d, widened to the
+// accumulator type. Integer accumulation is exact, and float accumulation is
+// exact too as test buffers contain small integer values.
+static float iree_conv2d_reference_load_f32(iree_uk_type_t type,
+                                            const void* buffer,
+                                            iree_uk_index_t index) {
+  switch (type) {
+    case IREE_UK_TYPE_FLOAT_32:
+      return ((const float*)buffer)[index];
+    case IREE_UK_TYPE_FLOAT_16:
+      return iree_math_f16_to_f32(((const uint16_t*)buffer)[index]);
+    case IREE_UK_TYPE_BFLOAT_16:
+      return iree_math_bf16_to_f32(((const uint16_t*)buffer)[index]);
+    default:
+      IREE_UK_ASSERT(false && "unhandled type");
+      return 0.f;
+  }
+}
+
+// Returns the index of the element of the unpacked filter at position (k, n)
+// of the logical KxN matrix. The filter is HWCF with NHWC input, so that's a
+// row-major KxN matrix, and FCHW with NCHW input, so that's a row-major NxK
+// matrix.
+static iree_uk_index_t iree_conv2d_filter_index(
+    const iree_uk_conv2d_params_t* params, iree_uk_index_t k,
+    iree_uk_index_t n) {
+  iree_uk_index_t K =
+      params->kernel_height * params->kernel_width * params->in_channels;
+  return (params->flags & IREE_UK_FLAG_CONV2D_INPUT_NCHW)
+             ? n * K + k
+             : k * params->out_channels + n;
+}
+
+// Computes conv2d from the input and the unpacked `filter`, into the packed
+// output described by `params`.
+static void iree_conv2d_reference(const iree_uk_conv2d_params_t* params,
+                                  const void* filter) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  bool nchw = params->flags & IREE_UK_FLAG_CONV2D_INPUT_NCHW;
+  bool accumulate = params->flags & IREE_UK_FLAG_CONV2D_ACCUMULATE;
+  iree_uk_index_t C = params->in_channels;
+  iree_uk_index_t H = params->in_height;
+  iree_uk_index_t W = params->in_width;
+  iree_uk_index_t KH = params->kernel_height;
+  iree_uk_index_t KW = params->kernel_width;
+  iree_uk_index_t M =
+      params->batch_size * params->out_height * params->out_width;
+  iree_uk_index_t N = params->out_channels;
+  iree_uk_index_t K = KH * KW * C;
+  iree_uk_index_t M_outer = (M + params->M0 - 1) / params->M0;
+  iree_uk_index_t N_outer = (N + params->N0 - 1) / params->N0;
+  const char* in_buffer = (const char*)params->in_buffer +
+                          params->in_offset * iree_uk_type_size(lhs_type);
+  for (iree_uk_index_t m = 0; m < M_outer * params->M0; ++m) {
+    for (iree_uk_index_t n = 0; n < N_outer * params->N0; ++n) {
+      iree_uk_index_t out_index =
+          params->out_offset + (m / params->M0) * params->out_stride0 +
+          ((n / params->N0) * params->M0 + m % params->M0) * params->N0 +
+          n % params->N0;
+      float acc_f32 = 0.f;
+      int32_t acc_i32 = 0;
+      if (accumulate) {
+        if (out_type == IREE_UK_TYPE_INT_32) {
+          acc_i32 = ((const int32_t*)params->out_buffer)[out_index];
+        } else {
+          acc_f32 = ((const float*)params->out_buffer)[out_index];
+        }
+      }
+      if (m < M && n < N) {
+        iree_uk_index_t ow = m % params->out_width;
+        iree_uk_index_t oh = (m / params->out_width) % params->out_height;
+        iree_uk_index_t b = m / (params->out_width * params->out_height);
+        for (iree_uk_index_t k = 0; k < K; ++k) {
+          iree_uk_index_t kh, kw, c;
+          if (nchw) {
+            c = k / (KH * KW);
+            kh = (k / KW) % KH;
+            kw = k % KW;
+          } else {
+            kh = k / (KW * C);
+            kw = (k / C) % KW;
+            c = k % C;
+          }
+          iree_uk_index_t ih = oh * params->stride_height -
+                               params->padding_top +
+                               kh * params->dilation_height;
+          iree_uk_index_t iw = ow * params->stride_width -
+                               params->padding_left +
+                               kw * params->dilation_width;
+          if (ih < 0 || ih >= H || iw < 0 || iw >= W) continue;
+          iree_uk_index_t in_index =
+              b * params->in_stride0 +
+              (nchw ? (c * H + ih) * W + iw : (ih * W + iw) * C + c);
+          iree_uk_index_t filter_index =
+              iree_conv2d_filter_index(params, k, n);
+          if (lhs_type == IREE_UK_TYPE_INT_8) {
+            acc_i32 += (int32_t)((const int8_t*)in_buffer)[in_index] *
+                       (int32_t)((const int8_t*)filter)[filter_index];
+          } else {
+            acc_f32 +=
+                iree_conv2d_reference_load_f32(lhs_type, in_buffer, in_index) *
+                iree_conv2d_reference_load_f32(rhs_type, filter, filter_index);
+          }
+        }
+      }
+      if (out_type == IREE_UK_TYPE_INT_32) {
+        ((int32_t*)params->out_buffer)[out_index] = acc_i32;
+      } else {
+        ((float*)params->out_buffer)[out_index] = acc_f32;
+      }
+    }
+  }
+}
+
+// Packs the unpacked `filter` into the mmt4d RHS layout expected by conv2d.
+static void iree_conv2d_pack_filter(const iree_uk_conv2d_params_t* params,
+                                    const void* filter, void* packed_filter) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params->flags);
+  iree_uk_index_t elem_size =
+      iree_uk_type_size(iree_uk_mmt4d_rhs_type(mmt4d_type));
+  iree_uk_index_t N = params->out_channels;
+  iree_uk_index_t K =
+      params->kernel_height * params->kernel_width * params->in_channels;
+  iree_uk_index_t N_outer = (N + params->N0 - 1) / params->N0;
+  iree_uk_index_t K_outer = (K + params->K0 - 1) / params->K0;
+  for (iree_uk_index_t n = 0; n < N_outer * params->N0; ++n) {
+    for (iree_uk_index_t k = 0; k < K_outer * params->K0; ++k) {
+      iree_uk_index_t packed_index =
+          (n / params->N0) * params->filter_stride0 +
+          ((k / params->K0) * params->N0 + n % params->N0) * params->K0 +
+          k % params->K0;
+      char* dst = (char*)packed_filter + packed_index * elem_size;
+      if (n < N && k < K) {
+        memcpy(dst,
+               (const char*)filter +
+                   iree_conv2d_filter_index(params, k, n) * elem_size,
+               elem_size);
+      } else {
+        memset(dst, 0, elem_size);
+      }
+    }
+  }
+}
+
+static void iree_uk_test_conv2d_for_shape_params(
+    iree_uk_test_t* test, const iree_uk_conv2d_params_t* src_params) {
+  iree_uk_conv2d_params_t params;
+  memcpy(&params, src_params, sizeof params);
+  iree_uk_random_engine_t* engine = iree_uk_test_random_engine(test);
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(params.flags);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  iree_uk_index_t M =
+      params.batch_size * params.out_height * params.out_width;
+  iree_uk_index_t N = params.out_channels;
+  iree_uk_index_t K =
+      params.kernel_height * params.kernel_width * params.in_channels;
+  iree_uk_index_t M_outer = (M + params.M0 - 1) / params.M0;
+  iree_uk_index_t N_outer = (N + params.N0 - 1) / params.N0;
+  iree_uk_index_t K_outer = (K + params.K0 - 1) / params.K0;
+  // Randomly make strides either tight or not to exercise all cases.
+  params.in_stride0 = params.in_channels * params.in_height * params.in_width +
+                      iree_uk_random_engine_get_0_1(engine);
+  params.filter_stride0 = K_outer * params.N0 * params.K0 +
+                          iree_uk_random_engine_get_0_1(engine);
+  params.out_stride0 = N_outer * params.M0 * params.N0 +
+                       iree_uk_random_engine_get_0_1(engine);
+
+  iree_uk_index_t in_buffer_size =
+      iree_uk_2d_buffer_length(lhs_type, params.batch_size, params.in_stride0);
+  void* in_buffer = malloc(in_buffer_size);
+  iree_uk_write_random_buffer(in_buffer, in_buffer_size, lhs_type, engine);
+  params.in_offset = iree_uk_random_engine_get_0_65535(engine);
+  params.in_buffer =
+      (const char*)in_buffer - params.in_offset * iree_uk_type_size(lhs_type);
+
+  iree_uk_index_t filter_size = iree_uk_2d_buffer_length(rhs_type, K, N);
+  void* filter = malloc(filter_size);
+  iree_uk_write_random_buffer(filter, filter_size, rhs_type, engine);
+  iree_uk_index_t packed_filter_size =
+      iree_uk_2d_buffer_length(rhs_type, N_outer, params.filter_stride0);
+  void* packed_filter = malloc(packed_filter_size);
+  iree_uk_write_random_buffer(packed_filter, packed_filter_size, rhs_type,
+                              engine);
+  iree_conv2d_pack_filter(&params, filter, packed_filter);
+  params.filter_offset = iree_uk_random_engine_get_0_65535(engine);
+  params.filter_buffer = (const char*)packed_filter -
+                         params.filter_offset * iree_uk_type_size(rhs_type);
+
+  params.out_offset = iree_uk_random_engine_get_0_65535(engine);
+  iree_uk_index_t out_buffer_size =
+      iree_uk_2d_buffer_length(out_type, M_outer, params.out_stride0);
+  void* init_out_buffer = malloc(out_buffer_size);
+  iree_uk_write_random_buffer(init_out_buffer, out_buffer_size, out_type,
+                              engine);
+
+  iree_uk_conv2d_params_t reference_params;
+  memcpy(&reference_params, &params, sizeof params);
+  void* reference_out_buffer = malloc(out_buffer_size);
+  memcpy(reference_out_buffer, init_out_buffer, out_buffer_size);
+  reference_params.out_buffer =
+      (char*)reference_out_buffer -
+      params.out_offset * iree_uk_type_size(out_type);
+
+  iree_uk_conv2d_params_t actual_params;
+  memcpy(&actual_params, &params, sizeof params);
+  void* actual_out_buffer = malloc(out_buffer_size);
+  memcpy(actual_out_buffer, init_out_buffer, out_buffer_size);
+  actual_params.out_buffer = (char*)actual_out_buffer -
+                             params.out_offset * iree_uk_type_size(out_type);
+
+  iree_conv2d_reference(&reference_params, filter);
+  iree_uk_conv2d(&actual_params);
+
+  // Exact comparisons, even for float, as in mmt4d_test: all values are small
+  // integers, so all intermediate values are exactly representable.
+  if (memcmp(actual_out_buffer, reference_out_buffer, out_buffer_size)) {
+    IREE_UK_TEST_FAIL(test);
+  }
+
+  free(init_out_buffer);
+  free(reference_out_buffer);
+  free(actual_out_buffer);
+  free(packed_filter);
+  free(filter);
+  free(in_buffer);
+}
+
+static void iree_uk_test_conv2d_for_tile_params(iree_uk_test_t* test,
+                                                const void* src_params) {
+  typedef struct conv_shape_t {
+    int batch, in_h, in_w, in_c, out_c, kernel_h, kernel_w, stride, dilation,
+        padding;
+  } conv_shape_t;
+  const conv_shape_t shapes[] = {
+      // Degenerate cases. Vacuous, or zeroing the output if not accumulating.
+      {0, 4, 4, 3, 5, 3, 3, 1, 1, 1},
+      {1, 4, 4, 3, 0, 3, 3, 1, 1, 1},
+      {1, 4, 4, 0, 5, 3, 3, 1, 1, 1},
+      // 1x1 convolutions, i.e. plain matmuls.
+      {1, 1, 1, 1, 1, 1, 1, 1, 1, 0},
+      {2, 5, 3, 7, 9, 1, 1, 1, 1, 0},
+      // 3x3 convolutions, the common case in vision models.
+      {1, 6, 6, 3, 4, 3, 3, 1, 1, 1},
+      {2, 7, 5, 8, 17, 3, 3, 1, 1, 0},
+      {1, 9, 11, 5, 6, 3, 3, 2, 1, 1},
+      {1, 8, 8, 4, 3, 3, 3, 1, 2, 2},
+      // Non-square kernels, large strides, padding larger than the kernel.
+      {1, 6, 9, 2, 5, 1, 5, 3, 1, 2},
+      {1, 3, 3, 3, 3, 5, 5, 1, 1, 4},
+      // Large reduction, exceeding the LHS panel buffer.
+      {1, 4, 4, 300, 7, 3, 3, 1, 1, 1},
+  };
+  for (int i = 0; i < IREE_ARRAYSIZE(shapes); ++i) {
+    conv_shape_t shape = shapes[i];
+    iree_uk_conv2d_params_t params;
+    memcpy(&params, src_params, sizeof params);
+    params.cpu_data = iree_uk_test_cpu_data(test);
+    params.batch_size = shape.batch;
+    params.in_height = shape.in_h;
+    params.in_width = shape.in_w;
+    params.in_channels = shape.in_c;
+    params.out_channels = shape.out_c;
+    params.kernel_height = shape.kernel_h;
+    params.kernel_width = shape.kernel_w;
+    params.stride_height = shape.stride;
+    params.stride_width = shape.stride;
+    params.dilation_height = shape.dilation;
+    params.dilation_width = shape.dilation;
+    params.padding_top = shape.padding;
+    params.padding_left = shape.padding;
+    params.out_height = (shape.in_h + 2 * shape.padding -
+                         shape.dilation * (shape.kernel_h - 1) - 1) /
+                            shape.stride +
+                        1;
+    params.out_width = (shape.in_w + 2 * shape.padding -
+                        shape.dilation * (shape.kernel_w - 1) - 1) /
+                           shape.stride +
+                       1;
+    for (int nchw = 0; nchw <= 1; ++nchw) {
+      for (int accumulate = 0; accumulate <= 1; ++accumulate) {
+        iree_uk_conv2d_params_t flags_params = params;
+        if (nchw) flags_params.flags |= IREE_UK_FLAG_CONV2D_INPUT_NCHW;
+        if (accumulate) flags_params.flags |= IREE_UK_FLAG_CONV2D_ACCUMULATE;
+        iree_uk_test_conv2d_for_shape_params(test, &flags_params);
+      }
+    }
+  }
+}
+
+static void iree_uk_test_conv2d(iree_uk_uint32_t flags, int M0, int N0,
+                                int K0, const char* cpu_features) {
+  char types_str[32];
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_conv2d_type(flags);
+  iree_uk_type_triple_str(types_str, sizeof types_str, mmt4d_type);
+  iree_uk_conv2d_params_t params = {
+      .flags = flags, .M0 = M0, .N0 = N0, .K0 = K0};
+  char test_label_str[256];
+  snprintf(test_label_str, sizeof test_label_str, "types:%s tile:%dx%dx%d",
+           types_str, M0, N0, K0);
+  iree_uk_test(test_label_str, iree_uk_test_conv2d_for_tile_params, &params,
+               cpu_features);
+}
+
+int main(int argc, char** argv) {
+  // Generic tests, not matching any particular CPU feature. This is the place
+  // to test weird M0, N0, K0 to ensure e.g. that we haven't unwittingly baked
+  // in a power-of-two assumption
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 3, 5, 7, "");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 9, 6, 3, "");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F16F16F32, 4, 6, 5, "");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32, 11, 4, 1, "");
+
+#if defined(IREE_ARCH_ARM_64)
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 8, 8, 1, "");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F16F16F32, 8, 8, 1, "fp16fml");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_BF16BF16F32, 8, 8, 4, "bf16");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 1, "");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 4, "dotprod");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 8, "i8mm");
+#elif defined(IREE_ARCH_X86_64)
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 8, 8, 1, "avx2_fma");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F32F32F32, 16, 16, 1,
+                      "avx512_base");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_F16F16F32, 8, 8, 1, "avx2_fma");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 8, 8, 2, "avx2_fma");
+  iree_uk_test_conv2d(IREE_UK_FLAG_CONV2D_TYPE_I8I8I32, 16, 16, 2,
+                      "avx512_vnni");
+#endif  // defined(IREE_ARCH_ARM_64)
+
+  return iree_uk_test_exit_status();
+}
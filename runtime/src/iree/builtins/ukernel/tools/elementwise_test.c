@@ -0,0 +1,414 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <math.h>
+
+#include "iree/base/api.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/tools/test.h"
+#include "iree/builtins/ukernel/tools/util.h"
+
+// Tests the architecture-specific elementwise row functions against scalar
+// reference code. Opcodes without an arch implementation for the CPU features
+// being tested are skipped, so the first, feature-less call of each test only
+// checks that nothing gets selected that the CPU can't run.
+
+typedef enum iree_uk_elementwise_test_category_e {
+  IREE_UK_ELEMENTWISE_TEST_X32B,
+  IREE_UK_ELEMENTWISE_TEST_X32U,
+  IREE_UK_ELEMENTWISE_TEST_X16B,
+  IREE_UK_ELEMENTWISE_TEST_X8B,
+} iree_uk_elementwise_test_category_t;
+
+static float iree_uk_test_as_f32(iree_uk_uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+static iree_uk_uint32_t iree_uk_test_f32_bits(float value) {
+  iree_uk_uint32_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  return bits;
+}
+
+static iree_uk_uint32_t iree_uk_x32b_reference(iree_uk_x32b_opcode_t opcode,
+                                               iree_uk_uint32_t a,
+                                               iree_uk_uint32_t b) {
+  float fa = iree_uk_test_as_f32(a);
+  float fb = iree_uk_test_as_f32(b);
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_test_f32_bits(fa + fb);
+    case IREE_UK_X32B_ADDI:
+      return a + b;
+    case IREE_UK_X32B_ANDI:
+      return a & b;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_test_f32_bits(fa / fb);
+    case IREE_UK_X32B_DIVSI:
+      return b ? (iree_uk_uint32_t)((iree_uk_int32_t)a / (iree_uk_int32_t)b)
+               : 0;
+    case IREE_UK_X32B_DIVUI:
+      return b ? a / b : 0;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_test_f32_bits(fa * fb);
+    case IREE_UK_X32B_MULI:
+      return a * b;
+    case IREE_UK_X32B_ORI:
+      return a | b;
+    case IREE_UK_X32B_SHLI:
+      return a << b;
+    case IREE_UK_X32B_SHRSI:
+      return (iree_uk_uint32_t)((iree_uk_int32_t)a >> b);
+    case IREE_UK_X32B_SHRUI:
+      return a >> b;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_test_f32_bits(fa - fb);
+    case IREE_UK_X32B_SUBI:
+      return a - b;
+    case IREE_UK_X32B_XORI:
+      return a ^ b;
+    default:
+      IREE_UK_ASSERT(false && "unhandled opcode");
+      return 0;
+  }
+}
+
+static iree_uk_uint32_t iree_uk_x32u_reference(iree_uk_x32u_opcode_t opcode,
+                                               iree_uk_uint32_t a) {
+  float fa = iree_uk_test_as_f32(a);
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_test_f32_bits(fabsf(fa));
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_test_f32_bits(ceilf(fa));
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_count_leading_zeros_u32(a);
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_test_f32_bits(expf(fa));
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_test_f32_bits(floorf(fa));
+    case IREE_UK_X32U_LOGF:
+      return iree_uk_test_f32_bits(logf(fa));
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_test_f32_bits(-fa);
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_test_f32_bits(1.0f / sqrtf(fa));
+    default:
+      IREE_UK_ASSERT(false && "unhandled opcode");
+      return 0;
+  }
+}
+
+static float iree_uk_x16b_reference_f32(iree_uk_x16b_opcode_t opcode, float a,
+                                        float b) {
+  switch (opcode) {
+    case IREE_UK_X16B_ADDBF16:
+    case IREE_UK_X16B_ADDF16:
+      return a + b;
+    case IREE_UK_X16B_DIVBF16:
+    case IREE_UK_X16B_DIVF16:
+      return a / b;
+    case IREE_UK_X16B_MULBF16:
+    case IREE_UK_X16B_MULF16:
+      return a * b;
+    case IREE_UK_X16B_SUBBF16:
+    case IREE_UK_X16B_SUBF16:
+      return a - b;
+    default:
+      IREE_UK_ASSERT(false && "unhandled opcode");
+      return 0;
+  }
+}
+
+static bool iree_uk_x16b_is_bf16(iree_uk_x16b_opcode_t opcode) {
+  return opcode == IREE_UK_X16B_ADDBF16 || opcode == IREE_UK_X16B_DIVBF16 ||
+         opcode == IREE_UK_X16B_MULBF16 || opcode == IREE_UK_X16B_SUBBF16;
+}
+
+static iree_uk_uint16_t iree_uk_x16b_reference(iree_uk_x16b_opcode_t opcode,
+                                               iree_uk_uint16_t a,
+                                               iree_uk_uint16_t b) {
+  if (iree_uk_x16b_is_bf16(opcode)) {
+    return iree_uk_f32_to_bf16(iree_uk_x16b_reference_f32(
+        opcode, iree_uk_bf16_to_f32(a), iree_uk_bf16_to_f32(b)));
+  }
+  return iree_uk_f32_to_f16(iree_uk_x16b_reference_f32(
+      opcode, iree_uk_f16_to_f32(a), iree_uk_f16_to_f32(b)));
+}
+
+static iree_uk_uint8_t iree_uk_x8b_reference(iree_uk_x8b_opcode_t opcode,
+                                             iree_uk_uint8_t a,
+                                             iree_uk_uint8_t b) {
+  switch (opcode) {
+    case IREE_UK_X8B_ADDI:
+      return a + b;
+    case IREE_UK_X8B_ANDI:
+      return a & b;
+    case IREE_UK_X8B_DIVSI:
+      return b ? (iree_uk_uint8_t)((iree_uk_int8_t)a / (iree_uk_int8_t)b) : 0;
+    case IREE_UK_X8B_DIVUI:
+      return b ? a / b : 0;
+    case IREE_UK_X8B_MULI:
+      return a * b;
+    case IREE_UK_X8B_ORI:
+      return a | b;
+    case IREE_UK_X8B_SHLI:
+      return a << b;
+    case IREE_UK_X8B_SHRSI:
+      return (iree_uk_uint8_t)((iree_uk_int8_t)a >> b);
+    case IREE_UK_X8B_SHRUI:
+      return a >> b;
+    case IREE_UK_X8B_SUBI:
+      return a - b;
+    case IREE_UK_X8B_XORI:
+      return a ^ b;
+    default:
+      IREE_UK_ASSERT(false && "unhandled opcode");
+      return 0;
+  }
+}
+
+// Returns true if `opcode` of `category` has a floating-point result, in
+// which case any NaN is accepted where the reference has a NaN: the exact NaN
+// bits are not specified.
+static bool iree_uk_elementwise_test_is_float(
+    iree_uk_elementwise_test_category_t category, int opcode) {
+  switch (category) {
+    case IREE_UK_ELEMENTWISE_TEST_X32B:
+      return opcode == IREE_UK_X32B_ADDF || opcode == IREE_UK_X32B_DIVF ||
+             opcode == IREE_UK_X32B_MULF || opcode == IREE_UK_X32B_SUBF;
+    case IREE_UK_ELEMENTWISE_TEST_X32U:
+      return opcode != IREE_UK_X32U_CTLZ;
+    case IREE_UK_ELEMENTWISE_TEST_X16B:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool iree_uk_elementwise_test_is_nan(
+    iree_uk_elementwise_test_category_t category, int opcode,
+    iree_uk_uint32_t bits) {
+  if (category == IREE_UK_ELEMENTWISE_TEST_X16B) {
+    float value = iree_uk_x16b_is_bf16(opcode) ? iree_uk_bf16_to_f32(bits)
+                                               : iree_uk_f16_to_f32(bits);
+    return isnan(value);
+  }
+  return isnan(iree_uk_test_as_f32(bits));
+}
+
+static iree_uk_index_t iree_uk_elementwise_test_elem_size(
+    iree_uk_elementwise_test_category_t category) {
+  switch (category) {
+    case IREE_UK_ELEMENTWISE_TEST_X16B:
+      return 2;
+    case IREE_UK_ELEMENTWISE_TEST_X8B:
+      return 1;
+    default:
+      return 4;
+  }
+}
+
+static iree_uk_uint32_t iree_uk_elementwise_test_load(const void* buffer,
+                                                      iree_uk_index_t i,
+                                                      iree_uk_index_t size) {
+  if (size == 1) return ((const iree_uk_uint8_t*)buffer)[i];
+  if (size == 2) return ((const iree_uk_uint16_t*)buffer)[i];
+  return ((const iree_uk_uint32_t*)buffer)[i];
+}
+
+static iree_uk_uint32_t iree_uk_elementwise_test_reference(
+    iree_uk_elementwise_test_category_t category, int opcode,
+    iree_uk_uint32_t a, iree_uk_uint32_t b) {
+  switch (category) {
+    case IREE_UK_ELEMENTWISE_TEST_X32B:
+      return iree_uk_x32b_reference(opcode, a, b);
+    case IREE_UK_ELEMENTWISE_TEST_X32U:
+      return iree_uk_x32u_reference(opcode, a);
+    case IREE_UK_ELEMENTWISE_TEST_X16B:
+      return iree_uk_x16b_reference(opcode, a, b);
+    default:
+      return iree_uk_x8b_reference(opcode, a, b);
+  }
+}
+
+// Fills `buffer` with random values suitable as operands of `opcode`: shift
+// amounts are kept in range, and f32 values get a fractional part so that
+// rounding ops have something to do.
+static void iree_uk_elementwise_test_fill(
+    iree_uk_elementwise_test_category_t category, int opcode, bool is_rhs,
+    void* buffer, iree_uk_index_t size, iree_uk_random_engine_t* engine) {
+  iree_uk_index_t elem_size = iree_uk_elementwise_test_elem_size(category);
+  for (iree_uk_index_t i = 0; i < size; ++i) {
+    int r = iree_uk_random_engine_get_minus16_plus15(engine);
+    if (category == IREE_UK_ELEMENTWISE_TEST_X16B) {
+      ((iree_uk_uint16_t*)buffer)[i] = iree_uk_x16b_is_bf16(opcode)
+                                           ? iree_uk_f32_to_bf16(r)
+                                           : iree_uk_f32_to_f16(r);
+    } else if (iree_uk_elementwise_test_is_float(category, opcode)) {
+      ((float*)buffer)[i] = r * 0.375f;
+    } else {
+      bool is_shift = is_rhs && ((category == IREE_UK_ELEMENTWISE_TEST_X32B &&
+                                  (opcode == IREE_UK_X32B_SHLI ||
+                                   opcode == IREE_UK_X32B_SHRSI ||
+                                   opcode == IREE_UK_X32B_SHRUI)) ||
+                                 (category == IREE_UK_ELEMENTWISE_TEST_X8B &&
+                                  (opcode == IREE_UK_X8B_SHLI ||
+                                   opcode == IREE_UK_X8B_SHRSI ||
+                                   opcode == IREE_UK_X8B_SHRUI)));
+      if (is_shift) r &= 8 * elem_size - 1;
+      // Exercise the full width, not just small values.
+      iree_uk_uint32_t bits =
+          is_shift ? r : iree_uk_random_engine_get_uint32(engine);
+      if (elem_size == 1) {
+        ((iree_uk_uint8_t*)buffer)[i] = bits;
+      } else {
+        ((iree_uk_uint32_t*)buffer)[i] = bits;
+      }
+    }
+  }
+}
+
+static void iree_uk_test_elementwise_opcode(
+    iree_uk_test_t* test, iree_uk_elementwise_test_category_t category,
+    int opcode, iree_uk_index_t size, bool in_place) {
+  const iree_uk_uint64_t* cpu_data = iree_uk_test_cpu_data(test);
+  iree_uk_elementwise_binary_row_func_t binary_func = 0;
+  iree_uk_elementwise_unary_row_func_t unary_func = 0;
+  switch (category) {
+    case IREE_UK_ELEMENTWISE_TEST_X32B:
+      binary_func = iree_uk_x32b_select_row_func(opcode, cpu_data);
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X32U:
+      unary_func = iree_uk_x32u_select_row_func(opcode, cpu_data);
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X16B:
+      binary_func = iree_uk_x16b_select_row_func(opcode, cpu_data);
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X8B:
+      binary_func = iree_uk_x8b_select_row_func(opcode, cpu_data);
+      break;
+  }
+  if (!binary_func && !unary_func) return;
+
+  iree_uk_random_engine_t* engine = iree_uk_test_random_engine(test);
+  iree_uk_index_t elem_size = iree_uk_elementwise_test_elem_size(category);
+  // One extra element past the end to catch out-of-bounds writes.
+  iree_uk_index_t buffer_size = (size + 1) * elem_size;
+  void* lhs = malloc(buffer_size);
+  void* rhs = malloc(buffer_size);
+  void* out = malloc(buffer_size);
+  iree_uk_elementwise_test_fill(category, opcode, false, lhs, size + 1,
+                                engine);
+  iree_uk_elementwise_test_fill(category, opcode, true, rhs, size + 1, engine);
+  void* actual_out = out;
+  if (in_place) {
+    memcpy(out, lhs, buffer_size);
+  } else {
+    iree_uk_write_random_buffer(out, buffer_size, IREE_UK_TYPE_INT_8, engine);
+  }
+  iree_uk_uint32_t guard = iree_uk_elementwise_test_load(out, size, elem_size);
+
+  if (binary_func) {
+    binary_func(in_place ? actual_out : lhs, rhs, actual_out, size);
+  } else {
+    unary_func(in_place ? actual_out : lhs, actual_out, size);
+  }
+
+  bool is_float = iree_uk_elementwise_test_is_float(category, opcode);
+  for (iree_uk_index_t i = 0; i < size; ++i) {
+    iree_uk_uint32_t expected = iree_uk_elementwise_test_reference(
+        category, opcode, iree_uk_elementwise_test_load(lhs, i, elem_size),
+        iree_uk_elementwise_test_load(rhs, i, elem_size));
+    iree_uk_uint32_t actual = iree_uk_elementwise_test_load(out, i, elem_size);
+    if (elem_size < 4) expected &= (1u << (8 * elem_size)) - 1;
+    if (actual == expected) continue;
+    if (is_float &&
+        iree_uk_elementwise_test_is_nan(category, opcode, expected) &&
+        iree_uk_elementwise_test_is_nan(category, opcode, actual)) {
+      continue;
+    }
+    fprintf(stderr,
+            "opcode %d, size %" PRIdsz ", element %" PRIdsz
+            ": expected 0x%x, actual 0x%x\n",
+            opcode, (iree_host_size_t)size, (iree_host_size_t)i, expected,
+            actual);
+    IREE_UK_TEST_FAIL(test);
+    break;
+  }
+  if (iree_uk_elementwise_test_load(out, size, elem_size) != guard) {
+    IREE_UK_TEST_FAIL(test);
+  }
+
+  free(lhs);
+  free(rhs);
+  free(out);
+}
+
+static void iree_uk_test_elementwise_for_category(iree_uk_test_t* test,
+                                                  const void* src_params) {
+  iree_uk_elementwise_test_category_t category =
+      *(const iree_uk_elementwise_test_category_t*)src_params;
+  int opcode_count = 0;
+  switch (category) {
+    case IREE_UK_ELEMENTWISE_TEST_X32B:
+      opcode_count = IREE_UK_X32B_COUNT;
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X32U:
+      opcode_count = IREE_UK_X32U_COUNT;
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X16B:
+      opcode_count = IREE_UK_X16B_COUNT;
+      break;
+    case IREE_UK_ELEMENTWISE_TEST_X8B:
+      opcode_count = IREE_UK_X8B_COUNT;
+      break;
+  }
+  // Sizes below, at and above the vector widths, to exercise the tail paths.
+  static const iree_uk_index_t sizes[] = {0, 1, 3, 8, 15, 16, 33, 64, 97, 259};
+  for (int opcode = 0; opcode < opcode_count; ++opcode) {
+    for (int i = 0; i < IREE_ARRAYSIZE(sizes); ++i) {
+      iree_uk_test_elementwise_opcode(test, category, opcode, sizes[i],
+                                      /*in_place=*/false);
+      iree_uk_test_elementwise_opcode(test, category, opcode, sizes[i],
+                                      /*in_place=*/true);
+    }
+  }
+}
+
+static void iree_uk_test_elementwise(
+    iree_uk_elementwise_test_category_t category, const char* name,
+    const char* cpu_features) {
+  iree_uk_test(name, iree_uk_test_elementwise_for_category, &category,
+               cpu_features);
+}
+
+int main(int argc, char** argv) {
+#if defined(IREE_ARCH_ARM_64)
+  const char* cpu_features = "";
+#elif defined(IREE_ARCH_X86_64)
+  const char* cpu_features = "avx2_fma";
+#else
+  const char* cpu_features = "";
+#endif  // defined(IREE_ARCH_ARM_64)
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X32B, "x32b", cpu_features);
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X32U, "x32u", cpu_features);
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X16B, "x16b", cpu_features);
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X8B, "x8b", cpu_features);
+#if defined(IREE_ARCH_X86_64)
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X32B, "x32b",
+                           "avx512_base");
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X32U, "x32u",
+                           "avx512_base");
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X16B, "x16b",
+                           "avx512_base");
+  iree_uk_test_elementwise(IREE_UK_ELEMENTWISE_TEST_X8B, "x8b", "avx512_base");
+#endif  // defined(IREE_ARCH_X86_64)
+
+  return iree_uk_test_exit_status();
+}
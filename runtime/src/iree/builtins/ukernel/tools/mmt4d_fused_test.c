@@ -0,0 +1,320 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <math.h>
+
+#include "iree/base/api.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/mmt4d_fused_internal.h"
+#include "iree/builtins/ukernel/tools/test.h"
+#include "iree/builtins/ukernel/tools/util.h"
+
+// The matmul part is checked by mmt4d_test, so the reference here is mmt4d
+// followed by a straightforward epilogue on the whole output.
+static void iree_mmt4d_fused_reference_epilogue(
+    const iree_uk_mmt4d_fused_params_t* params, const void* acc_buffer) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_fused_type(params->flags);
+  bool acc_is_i32 = iree_uk_mmt4d_out_type(mmt4d_type) == IREE_UK_TYPE_INT_32;
+  bool requantize = params->flags & IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8;
+  bool clamp = params->flags & IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+  bool bias_per_row = params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+  bool bias_per_col = params->flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN;
+  for (iree_uk_index_t i = 0; i < params->M; ++i) {
+    for (iree_uk_index_t j = 0; j < params->N; ++j) {
+      for (iree_uk_index_t r = 0; r < params->M0; ++r) {
+        for (iree_uk_index_t c = 0; c < params->N0; ++c) {
+          iree_uk_index_t acc_index =
+              params->out_offset + i * params->out_stride0 +
+              (j * params->M0 + r) * params->N0 + c;
+          iree_uk_index_t bias_index = params->bias_offset;
+          if (bias_per_row) bias_index += i * params->bias_stride0 + r;
+          if (bias_per_col) bias_index += j * params->bias_stride0 + c;
+          if (acc_is_i32) {
+            int32_t v = ((const int32_t*)acc_buffer)[acc_index];
+            if (bias_per_row || bias_per_col) {
+              // Wraps around on overflow, as the kernel does.
+              v = (int32_t)((uint32_t)v +
+                            ((const uint32_t*)params->bias_buffer)[bias_index]);
+            }
+            if (requantize) {
+              v = (int32_t)roundf(v * params->requantize_scale) +
+                  params->out_zero_point;
+              v = iree_min(iree_max(v, -128), 127);
+            }
+            if (clamp) {
+              v = iree_min(iree_max(v, (int32_t)params->clamp_min),
+                           (int32_t)params->clamp_max);
+            }
+            if (requantize) {
+              ((int8_t*)params->out_buffer)[acc_index] = v;
+            } else {
+              ((int32_t*)params->out_buffer)[acc_index] = v;
+            }
+          } else {
+            float v = ((const float*)acc_buffer)[acc_index];
+            if (bias_per_row || bias_per_col) {
+              v += ((const float*)params->bias_buffer)[bias_index];
+            }
+            if (clamp) {
+              v = iree_min(iree_max(v, params->clamp_min), params->clamp_max);
+            }
+            ((float*)params->out_buffer)[acc_index] = v;
+          }
+        }
+      }
+    }
+  }
+}
+
+// When `large_bias` is set, int32 bias values are near the ends of the int32
+// range so that adding them to the accumulator overflows.
+static void iree_uk_test_mmt4d_fused_for_shape_params(
+    iree_uk_test_t* test, const iree_uk_mmt4d_fused_params_t* src_params,
+    bool large_bias) {
+  iree_uk_mmt4d_fused_params_t params;
+  memcpy(&params, src_params, sizeof params);
+  iree_uk_random_engine_t* engine = iree_uk_test_random_engine(test);
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_fused_type(params.flags);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_fused_out_type(params.flags);
+  // Randomly make strides either tight or not to exercise all cases. Sub-byte
+  // RHS panels must start on byte boundaries, so keep the RHS stride and
+  // offset even in that case.
+  int rhs_elems_per_byte = iree_uk_type_bit_count(rhs_type) < 8 ? 2 : 1;
+  params.lhs_stride0 =
+      params.K * params.M0 * params.K0 + iree_uk_random_engine_get_0_1(engine);
+  params.rhs_stride0 =
+      params.K * params.N0 * params.K0 +
+      rhs_elems_per_byte * iree_uk_random_engine_get_0_1(engine);
+  params.out_stride0 =
+      params.N * params.M0 * params.N0 + iree_uk_random_engine_get_0_1(engine);
+  iree_uk_index_t lhs_buffer_size =
+      iree_uk_2d_buffer_length(lhs_type, params.M, params.lhs_stride0);
+  iree_uk_index_t rhs_buffer_size =
+      iree_uk_2d_buffer_length(rhs_type, params.N, params.rhs_stride0);
+  void* lhs_buffer = malloc(lhs_buffer_size);
+  void* rhs_buffer = malloc(rhs_buffer_size);
+  iree_uk_write_random_buffer(lhs_buffer, lhs_buffer_size, lhs_type, engine);
+  iree_uk_write_random_buffer(rhs_buffer, rhs_buffer_size, rhs_type, engine);
+  params.lhs_offset = iree_uk_random_engine_get_0_65535(engine);
+  params.rhs_offset =
+      rhs_elems_per_byte * iree_uk_random_engine_get_0_65535(engine);
+  params.lhs_buffer = (const char*)lhs_buffer -
+                      (params.lhs_offset * iree_uk_type_size(lhs_type));
+  params.rhs_buffer = (const char*)rhs_buffer -
+                      iree_uk_type_elems_to_bytes(rhs_type, params.rhs_offset);
+
+  // The bias has the accumulator type, and one [M0] or [N0] row per tile row
+  // or column.
+  void* bias_buffer = NULL;
+  if (params.flags & (IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW |
+                      IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN)) {
+    bool per_row = params.flags & IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW;
+    params.bias_stride0 = (per_row ? params.M0 : params.N0) +
+                          iree_uk_random_engine_get_0_1(engine);
+    iree_uk_index_t bias_buffer_size = iree_uk_2d_buffer_length(
+        acc_type, per_row ? params.M : params.N, params.bias_stride0);
+    bias_buffer = malloc(bias_buffer_size);
+    iree_uk_write_random_buffer(bias_buffer, bias_buffer_size, acc_type,
+                                engine);
+    if (large_bias && acc_type == IREE_UK_TYPE_INT_32) {
+      int32_t* bias_values = bias_buffer;
+      for (iree_uk_index_t i = 0; i < bias_buffer_size / sizeof(int32_t);
+           ++i) {
+        bias_values[i] = (i & 1) ? INT32_MIN + (bias_values[i] & 0xFF)
+                                 : INT32_MAX - (bias_values[i] & 0xFF);
+      }
+    }
+    params.bias_offset = iree_uk_random_engine_get_0_65535(engine);
+    params.bias_buffer = (const char*)bias_buffer -
+                         (params.bias_offset * iree_uk_type_size(acc_type));
+  }
+
+  // The accumulator, as computed by plain mmt4d. It starts from the initial
+  // output when accumulating, which is never the case when requantizing, so
+  // the accumulator and output buffers have the same layout in that case.
+  params.out_offset = iree_uk_random_engine_get_0_65535(engine);
+  iree_uk_index_t acc_buffer_size =
+      iree_uk_2d_buffer_length(acc_type, params.M, params.out_stride0);
+  iree_uk_index_t out_buffer_size =
+      iree_uk_2d_buffer_length(out_type, params.M, params.out_stride0);
+  void* init_out_buffer = malloc(out_buffer_size);
+  iree_uk_write_random_buffer(init_out_buffer, out_buffer_size, out_type,
+                              engine);
+  void* acc_buffer = malloc(acc_buffer_size);
+  if (out_type == acc_type) {
+    memcpy(acc_buffer, init_out_buffer, out_buffer_size);
+  }
+  iree_uk_mmt4d_params_t mmt4d_params = {
+      .lhs_buffer = params.lhs_buffer,
+      .lhs_offset = params.lhs_offset,
+      .lhs_stride0 = params.lhs_stride0,
+      .rhs_buffer = params.rhs_buffer,
+      .rhs_offset = params.rhs_offset,
+      .rhs_stride0 = params.rhs_stride0,
+      .out_buffer = (char*)acc_buffer -
+                    (params.out_offset * iree_uk_type_size(acc_type)),
+      .out_offset = params.out_offset,
+      .out_stride0 = params.out_stride0,
+      .M = params.M,
+      .N = params.N,
+      .K = params.K,
+      .M0 = params.M0,
+      .N0 = params.N0,
+      .K0 = params.K0,
+      .flags = iree_uk_mmt4d_fused_mmt4d_flags(params.flags),
+      .cpu_data = params.cpu_data,
+  };
+  iree_uk_mmt4d(&mmt4d_params);
+
+  iree_uk_mmt4d_fused_params_t reference_params;
+  memcpy(&reference_params, &params, sizeof params);
+  void* reference_out_buffer = malloc(out_buffer_size);
+  memcpy(reference_out_buffer, init_out_buffer, out_buffer_size);
+  reference_params.out_buffer =
+      (char*)reference_out_buffer -
+      (params.out_offset * iree_uk_type_size(out_type));
+
+  iree_uk_mmt4d_fused_params_t actual_params;
+  memcpy(&actual_params, &params, sizeof params);
+  void* actual_out_buffer = malloc(out_buffer_size);
+  memcpy(actual_out_buffer, init_out_buffer, out_buffer_size);
+  actual_params.out_buffer = (char*)actual_out_buffer -
+                             (params.out_offset * iree_uk_type_size(out_type));
+
+  iree_mmt4d_fused_reference_epilogue(&reference_params,
+                                      mmt4d_params.out_buffer);
+  iree_uk_mmt4d_fused(&actual_params);
+
+  // Exact comparisons, even for float, as in mmt4d_test: all values are small
+  // integers, so all intermediate values are exactly representable.
+  if (memcmp(actual_out_buffer, reference_out_buffer, out_buffer_size)) {
+    IREE_UK_TEST_FAIL(test);
+  }
+
+  free(init_out_buffer);
+  free(reference_out_buffer);
+  free(actual_out_buffer);
+  free(acc_buffer);
+  free(bias_buffer);
+  free(lhs_buffer);
+  free(rhs_buffer);
+}
+
+static void iree_uk_test_mmt4d_fused_for_tile_params(iree_uk_test_t* test,
+                                                     const void* src_params) {
+  typedef struct shape_mnk_t {
+    int m, n, k;
+  } shape_mnk_t;
+  const shape_mnk_t shapes[] = {
+      // Degenerate cases M==0 and N==0. Vacuous.
+      {0, 5, 7},
+      {5, 0, 7},
+      // Degenerate case K==0. The epilogue still applies to the zero or
+      // existing accumulator.
+      {5, 7, 0},
+      // Non-degenerate cases.
+      {1, 1, 1},
+      {1, 1, 100},
+      {2, 1, 1},
+      {1, 2, 1},
+      {5, 7, 13},
+  };
+  const iree_uk_uint32_t bias_flags[] = {
+      0,
+      IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_ROW,
+      IREE_UK_FLAG_MMT4D_FUSED_BIAS_PER_COLUMN,
+  };
+  const iree_uk_mmt4d_fused_params_t* tile_params = src_params;
+  iree_uk_mmt4d_type_t mmt4d_type =
+      iree_uk_mmt4d_fused_type(tile_params->flags);
+  bool acc_is_i32 = iree_uk_mmt4d_out_type(mmt4d_type) == IREE_UK_TYPE_INT_32;
+  for (int i = 0; i < IREE_ARRAYSIZE(shapes); ++i) {
+    iree_uk_mmt4d_fused_params_t params;
+    memcpy(&params, src_params, sizeof params);
+    params.cpu_data = iree_uk_test_cpu_data(test);
+    params.M = shapes[i].m;
+    params.N = shapes[i].n;
+    params.K = shapes[i].k;
+    // Exactly representable scale and clamp bounds, so that float results are
+    // exact and the int8 requantization has ties to round.
+    params.requantize_scale = 0.25f;
+    params.out_zero_point = -3;
+    params.clamp_min = -20.f;
+    params.clamp_max = 30.f;
+    for (int b = 0; b < IREE_ARRAYSIZE(bias_flags); ++b) {
+      for (int clamp = 0; clamp <= 1; ++clamp) {
+        for (int mode = 0; mode <= 2; ++mode) {
+          // Mode 0: overwrite, 1: accumulate, 2: requantize (int32 only).
+          if (mode == 2 && !acc_is_i32) continue;
+          iree_uk_mmt4d_fused_params_t flags_params = params;
+          flags_params.flags |= bias_flags[b];
+          if (clamp) flags_params.flags |= IREE_UK_FLAG_MMT4D_FUSED_CLAMP;
+          if (mode == 1) {
+            flags_params.flags |= IREE_UK_FLAG_MMT4D_FUSED_ACCUMULATE;
+          }
+          if (mode == 2) {
+            flags_params.flags |= IREE_UK_FLAG_MMT4D_FUSED_REQUANTIZE_I8;
+          }
+          iree_uk_test_mmt4d_fused_for_shape_params(test, &flags_params,
+                                                    /*large_bias=*/false);
+          if (acc_is_i32 && bias_flags[b]) {
+            iree_uk_test_mmt4d_fused_for_shape_params(test, &flags_params,
+                                                      /*large_bias=*/true);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void iree_uk_test_mmt4d_fused(iree_uk_uint32_t flags, int M0, int N0,
+                                     int K0, const char* cpu_features) {
+  char types_str[32];
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_fused_type(flags);
+  iree_uk_type_triple_str(types_str, sizeof types_str, mmt4d_type);
+  iree_uk_mmt4d_fused_params_t params = {
+      .flags = flags, .M0 = M0, .N0 = N0, .K0 = K0};
+  char test_label_str[256];
+  snprintf(test_label_str, sizeof test_label_str, "types:%s tile:%dx%dx%d",
+           types_str, M0, N0, K0);
+  iree_uk_test(test_label_str, iree_uk_test_mmt4d_fused_for_tile_params,
+               &params, cpu_features);
+}
+
+int main(int argc, char** argv) {
+  // Generic tests, not matching any particular CPU feature. The epilogue is
+  // architecture-independent, so we mostly want to check that it composes
+  // with each kind of tile function.
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32, 3, 5, 7,
+                           "");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32, 9, 6, 3, "");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F16F16F32, 4, 6, 5,
+                           "");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I4I32, 3, 4, 2, "");
+
+#if defined(IREE_ARCH_ARM_64)
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32, 8, 8, 1,
+                           "");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32, 8, 8, 4,
+                           "dotprod");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32, 8, 8, 8,
+                           "i8mm");
+#elif defined(IREE_ARCH_X86_64)
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32, 8, 8, 1,
+                           "avx2_fma");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_F32F32F32, 16, 16, 1,
+                           "avx512_base");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32, 8, 8, 2,
+                           "avx2_fma");
+  iree_uk_test_mmt4d_fused(IREE_UK_FLAG_MMT4D_FUSED_TYPE_I8I8I32, 16, 16, 2,
+                           "avx512_vnni");
+#endif  // defined(IREE_ARCH_ARM_64)
+
+  return iree_uk_test_exit_status();
+}
@@ -137,14 +137,61 @@ static void iree_mmt4d_reference_innerloop_i8i8i32(
   *out_ptr = acc;
 }
 
+// The int4 RHS is passed as a panel pointer and an element index in it, as
+// the elements of a given row may not start on a byte boundary.
+static void iree_mmt4d_reference_innerloop_i8i4i32(
+    int32_t* out_ptr, const int8_t* lhs_ptr, const uint8_t* rhs_panel_ptr,
+    iree_uk_index_t rhs_index, const iree_uk_mmt4d_params_t* params) {
+  int32_t acc = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE ? *out_ptr : 0;
+  for (iree_uk_index_t k = 0; k < params->K; ++k) {
+    for (iree_uk_index_t k0 = 0; k0 < params->K0; ++k0) {
+      int32_t lhs_i32 = lhs_ptr[k * params->M0 * params->K0 + k0];
+      int32_t rhs_i32 = iree_uk_load_packed_i4(
+          rhs_panel_ptr, rhs_index + k * params->N0 * params->K0 + k0);
+      acc += lhs_i32 * rhs_i32;
+    }
+  }
+  *out_ptr = acc;
+}
+
+// Same as the i8i4i32 case for the RHS. If `scales_ptr` is not NULL, it points
+// to the scale of the first group for this output element, and subsequent
+// groups' scales are N0 floats apart. Same for `zero_points_ptr`.
+static void iree_mmt4d_reference_innerloop_f32i4f32(
+    float* out_ptr, const float* lhs_ptr, const uint8_t* rhs_panel_ptr,
+    iree_uk_index_t rhs_index, const float* scales_ptr,
+    const float* zero_points_ptr, const iree_uk_mmt4d_params_t* params) {
+  float acc = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE ? *out_ptr : 0.f;
+  for (iree_uk_index_t k = 0; k < params->K; ++k) {
+    for (iree_uk_index_t k0 = 0; k0 < params->K0; ++k0) {
+      float lhs_f32 = lhs_ptr[k * params->M0 * params->K0 + k0];
+      float rhs_f32 = iree_uk_load_packed_i4(
+          rhs_panel_ptr, rhs_index + k * params->N0 * params->K0 + k0);
+      if (scales_ptr) {
+        iree_uk_index_t group =
+            (k * params->K0 + k0) / params->rhs_group_size;
+        if (zero_points_ptr) rhs_f32 -= zero_points_ptr[group * params->N0];
+        rhs_f32 *= scales_ptr[group * params->N0];
+      }
+      acc += lhs_f32 * rhs_f32;
+    }
+  }
+  *out_ptr = acc;
+}
+
 static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t* params) {
   iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params->flags);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
   iree_uk_index_t lhs_elem_size =
       iree_uk_type_size(iree_uk_mmt4d_lhs_type(mmt4d_type));
+  // Only meaningful for byte-sized RHS types. Sub-byte RHS types are handled
+  // by passing element indices to the innerloop functions.
   iree_uk_index_t rhs_elem_size =
-      iree_uk_type_size(iree_uk_mmt4d_rhs_type(mmt4d_type));
+      iree_uk_type_bit_count(rhs_type) >= 8 ? iree_uk_type_size(rhs_type) : 0;
   iree_uk_index_t out_elem_size =
       iree_uk_type_size(iree_uk_mmt4d_out_type(mmt4d_type));
+  const bool rhs_group_quantized =
+      params->flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED;
   for (iree_uk_index_t i = 0; i < params->M; ++i) {
     for (iree_uk_index_t j = 0; j < params->N; ++j) {
       void* out_tile_ptr = ((char*)params->out_buffer) +
@@ -156,7 +203,21 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t* params) {
           (params->lhs_offset + i * params->lhs_stride0) * lhs_elem_size;
       const void* rhs_panel_ptr =
           ((const char*)params->rhs_buffer) +
-          (params->rhs_offset + j * params->rhs_stride0) * rhs_elem_size;
+          iree_uk_type_elems_to_bytes(
+              rhs_type, params->rhs_offset + j * params->rhs_stride0);
+      const float* scales_panel_ptr = NULL;
+      const float* zero_points_panel_ptr = NULL;
+      if (rhs_group_quantized) {
+        iree_uk_index_t group_offset =
+            params->rhs_group_offset + j * params->rhs_group_stride0;
+        scales_panel_ptr =
+            (const float*)params->rhs_group_scales_buffer + group_offset;
+        if (params->rhs_group_zero_points_buffer) {
+          zero_points_panel_ptr =
+              (const float*)params->rhs_group_zero_points_buffer +
+              group_offset;
+        }
+      }
       for (iree_uk_index_t i0 = 0; i0 < params->M0; ++i0) {
         for (iree_uk_index_t j0 = 0; j0 < params->N0; ++j0) {
           void* out_ptr =
@@ -196,6 +257,19 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t* params) {
                   (int32_t*)out_ptr, (const int8_t*)lhs_ptr,
                   (const int8_t*)rhs_ptr, params);
               break;
+            case IREE_UK_FLAG_MMT4D_TYPE_I8I4I32:
+              iree_mmt4d_reference_innerloop_i8i4i32(
+                  (int32_t*)out_ptr, (const int8_t*)lhs_ptr,
+                  (const uint8_t*)rhs_panel_ptr, j0 * params->K0, params);
+              break;
+            case IREE_UK_FLAG_MMT4D_TYPE_F32I4F32:
+              iree_mmt4d_reference_innerloop_f32i4f32(
+                  (float*)out_ptr, (const float*)lhs_ptr,
+                  (const uint8_t*)rhs_panel_ptr, j0 * params->K0,
+                  scales_panel_ptr ? scales_panel_ptr + j0 : NULL,
+                  zero_points_panel_ptr ? zero_points_panel_ptr + j0 : NULL,
+                  params);
+              break;
             default:
               IREE_UK_ASSERT(false && "unhandled type");
           }
@@ -215,13 +289,17 @@ static void iree_uk_test_mmt4d_for_shape_params(
   iree_uk_random_engine_t* engine = iree_uk_test_random_engine(test);
   params.lhs_stride0 =
       params.K * params.M0 * params.K0 + iree_uk_random_engine_get_0_1(engine);
+  // Sub-byte RHS panels must start on byte boundaries, so keep the RHS stride
+  // and offset even in that case.
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params.flags);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  int rhs_elems_per_byte = iree_uk_type_bit_count(rhs_type) < 8 ? 2 : 1;
   params.rhs_stride0 =
-      params.K * params.N0 * params.K0 + iree_uk_random_engine_get_0_1(engine);
+      params.K * params.N0 * params.K0 +
+      rhs_elems_per_byte * iree_uk_random_engine_get_0_1(engine);
   params.out_stride0 =
       params.N * params.M0 * params.N0 + iree_uk_random_engine_get_0_1(engine);
-  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params.flags);
   iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
-  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
   iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
   iree_uk_index_t lhs_buffer_size =
       iree_uk_2d_buffer_length(lhs_type, params.M, params.lhs_stride0);
@@ -232,12 +310,45 @@ static void iree_uk_test_mmt4d_for_shape_params(
   iree_uk_write_random_buffer(lhs_buffer, lhs_buffer_size, lhs_type, engine);
   iree_uk_write_random_buffer(rhs_buffer, rhs_buffer_size, rhs_type, engine);
   params.lhs_offset = iree_uk_random_engine_get_0_65535(engine);
-  params.rhs_offset = iree_uk_random_engine_get_0_65535(engine);
+  params.rhs_offset =
+      rhs_elems_per_byte * iree_uk_random_engine_get_0_65535(engine);
   params.out_offset = iree_uk_random_engine_get_0_65535(engine);
   params.lhs_buffer = (const char*)lhs_buffer -
                       (params.lhs_offset * iree_uk_type_size(lhs_type));
   params.rhs_buffer = (const char*)rhs_buffer -
-                      (params.rhs_offset * iree_uk_type_size(rhs_type));
+                      iree_uk_type_elems_to_bytes(rhs_type, params.rhs_offset);
+
+  // Group-wise RHS scales and zero-points. These are small powers of two and
+  // small integers respectively, so that all arithmetic remains exact.
+  float* scales_buffer = NULL;
+  float* zero_points_buffer = NULL;
+  if (params.flags & IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED) {
+    params.rhs_group_size =
+        params.K0 * (1 + iree_uk_random_engine_get_0_65535(engine) % 3);
+    iree_uk_index_t groups =
+        (params.K * params.K0 + params.rhs_group_size - 1) /
+        params.rhs_group_size;
+    params.rhs_group_stride0 =
+        groups * params.N0 + iree_uk_random_engine_get_0_1(engine);
+    iree_uk_index_t group_buffer_length =
+        iree_max(1, params.N * params.rhs_group_stride0);
+    scales_buffer = malloc(group_buffer_length * sizeof(float));
+    for (iree_uk_index_t i = 0; i < group_buffer_length; ++i) {
+      scales_buffer[i] = 1 << (iree_uk_random_engine_get_0_65535(engine) % 3);
+    }
+    if (iree_uk_random_engine_get_0_1(engine)) {
+      zero_points_buffer = malloc(group_buffer_length * sizeof(float));
+      for (iree_uk_index_t i = 0; i < group_buffer_length; ++i) {
+        zero_points_buffer[i] =
+            (iree_uk_random_engine_get_0_65535(engine) % 5) - 2;
+      }
+    }
+    params.rhs_group_offset = iree_uk_random_engine_get_0_65535(engine);
+    params.rhs_group_scales_buffer = scales_buffer - params.rhs_group_offset;
+    params.rhs_group_zero_points_buffer =
+        zero_points_buffer ? zero_points_buffer - params.rhs_group_offset
+                           : NULL;
+  }
 
   iree_uk_mmt4d_params_t reference_params;
   memcpy(&reference_params, &params, sizeof params);
@@ -292,6 +403,8 @@ static void iree_uk_test_mmt4d_for_shape_params(
   free(actual_out_buffer);
   free(lhs_buffer);
   free(rhs_buffer);
+  free(scales_buffer);
+  free(zero_points_buffer);
 }
 
 static void iree_uk_test_mmt4d_for_tile_params(iree_uk_test_t* test,
@@ -372,6 +485,13 @@ static void iree_uk_test_mmt4d_default_and_skip_intermediate_roundings(
       cpu_features, " skipround");
 }
 
+static void iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+    iree_uk_uint32_t flags, int M0, int N0, int K0, const char* cpu_features) {
+  iree_uk_test_mmt4d_impl(flags, M0, N0, K0, cpu_features, "");
+  iree_uk_test_mmt4d_impl(flags | IREE_UK_FLAG_MMT4D_RHS_GROUP_QUANTIZED, M0,
+                          N0, K0, cpu_features, " groupquant");
+}
+
 int main(int argc, char** argv) {
   // Generic tests, not matching any particular CPU feature. This is the place
   // to test weird M0, N0, K0 to ensure e.g. that we haven't unwittingly baked
@@ -382,6 +502,9 @@ int main(int argc, char** argv) {
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F16F16F16, 3, 5, 8, "");
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32, 11, 4, 1, "");
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_BF16BF16BF16, 2, 9, 3, "");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 3, 4, 3, "");
+  iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32, 5, 2, 3, "");
 
 #if defined(IREE_ARCH_ARM_64)
   // On arm64, some code paths have inline asm and intrinsics variants. For them
@@ -398,6 +521,11 @@ int main(int argc, char** argv) {
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I8I32, 8, 8, 4, "dotprod");
   iree_uk_test_mmt4d_default_and_intrinsics(IREE_UK_FLAG_MMT4D_TYPE_I8I8I32, 8,
                                             8, 8, "i8mm");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 8, 8, 1, "");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 8, 8, 4, "dotprod");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 8, 8, 8, "i8mm");
+  iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32, 8, 8, 1, "");
 #elif defined(IREE_ARCH_X86_64)
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 8, 4, 1, "");  // SSE
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 8, 8, 1, "avx2_fma");
@@ -414,6 +542,15 @@ int main(int argc, char** argv) {
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I8I32, 8, 8, 2, "avx2_fma");
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I8I32, 16, 16, 2, "avx512_base");
   iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I8I32, 16, 16, 2, "avx512_vnni");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 8, 4, 2, "");  // SSE2
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 8, 8, 2, "avx2_fma");
+  iree_uk_test_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_I8I4I32, 16, 16, 2, "avx512_vnni");
+  iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32, 8, 4, 1, "");  // SSE
+  iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32, 8, 8, 1, "avx2_fma");
+  iree_uk_test_mmt4d_default_and_rhs_group_quantized(
+      IREE_UK_FLAG_MMT4D_TYPE_F32I4F32, 16, 16, 1, "avx512_base");
 #endif  // defined(IREE_ARCH_ARM_64)
 
   return iree_uk_test_exit_status();
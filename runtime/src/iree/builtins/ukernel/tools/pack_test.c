@@ -10,11 +10,27 @@
 #include "iree/builtins/ukernel/tools/test.h"
 #include "iree/builtins/ukernel/tools/util.h"
 
+// Copies the int4 value at `in_offset` to `out_offset`, in buffers of int4
+// values packed two per byte, the value at even offset in the low nibble.
+static void iree_pack_reference_copy_i4(void* out_buffer,
+                                        iree_uk_index_t out_offset,
+                                        const void* in_buffer,
+                                        iree_uk_index_t in_offset) {
+  iree_uk_uint8_t in_byte = ((const iree_uk_uint8_t*)in_buffer)[in_offset >> 1];
+  iree_uk_uint8_t nibble = (in_byte >> (4 * (in_offset & 1))) & 0xF;
+  iree_uk_uint8_t* out_ptr = (iree_uk_uint8_t*)out_buffer + (out_offset >> 1);
+  int out_shift = 4 * (out_offset & 1);
+  *out_ptr = (*out_ptr & ~(0xF << out_shift)) | (nibble << out_shift);
+}
+
 static void iree_pack_reference(const iree_uk_pack_params_t* params) {
   // For now, the input and output element types are always the same.
   iree_uk_pack_type_t pack_type = iree_uk_pack_type(params->flags);
   iree_uk_type_t elem_type = iree_uk_pack_in_type(pack_type);
-  iree_uk_index_t elem_size = iree_uk_type_size(elem_type);
+  bool is_i4 = elem_type == IREE_UK_TYPE_INT_4;
+  // Sub-byte elements have no byte size and are handled separately.
+  iree_uk_index_t elem_size = is_i4 ? 0 : iree_uk_type_size(elem_type);
+  iree_uk_uint8_t padding_i4 = params->padding_value & 0xF;
   iree_uk_index_t outer_size0 = params->out_size0;
   iree_uk_index_t outer_size1 = params->out_size1;
   iree_uk_index_t tile_size0 = params->out_size2;
@@ -43,6 +59,17 @@ static void iree_pack_reference(const iree_uk_pack_params_t* params) {
               tile_i1 * out_stride_l3;
           iree_uk_index_t i0 = outer_i0 * tile_size0 + tile_i0;
           iree_uk_index_t i1 = outer_i1 * tile_size1 + tile_i1;
+          if (is_i4) {
+            if (i0 >= params->in_size0 || i1 >= params->in_size1) {
+              iree_pack_reference_copy_i4(params->out_buffer, out_offset,
+                                          &padding_i4, 0);
+            } else {
+              iree_pack_reference_copy_i4(
+                  params->out_buffer, out_offset, params->in_buffer,
+                  params->in_offset + i1 + i0 * params->in_stride0);
+            }
+            continue;
+          }
           char* out_ptr = ((char*)params->out_buffer) + out_offset * elem_size;
           if (i0 >= params->in_size0 || i1 >= params->in_size1) {
             if (elem_size == 1) {
@@ -74,20 +101,26 @@ static void iree_uk_test_pack_for_shape_params(
   iree_uk_pack_params_t params;
   memcpy(&params, src_params, sizeof params);
   // Populate strides first - we need them below to compute buffer lengths.
-  // Randomly make strides either tight or not to exercise all cases.
+  // Randomly make strides either tight or not to exercise all cases. Int4
+  // rows must start on byte boundaries, so keep strides and offsets even in
+  // that case.
   iree_uk_random_engine_t* engine = iree_uk_test_random_engine(test);
-  params.in_stride0 = params.in_size1 + iree_uk_random_engine_get_0_1(engine);
-  params.out_stride0 = params.out_size1 * params.out_size2 * params.out_size3;
   iree_uk_pack_type_t pack_type = iree_uk_pack_type(params.flags);
   iree_uk_type_t in_type = iree_uk_pack_in_type(pack_type);
+  int elems_per_byte = iree_uk_type_bit_count(in_type) < 8 ? 2 : 1;
+  params.in_stride0 = params.in_size1 +
+                      elems_per_byte * iree_uk_random_engine_get_0_1(engine);
+  params.out_stride0 = params.out_size1 * params.out_size2 * params.out_size3;
   iree_uk_index_t in_buffer_size =
       iree_uk_2d_buffer_length(in_type, params.in_size0, params.in_stride0);
   void* in_buffer = malloc(in_buffer_size);
   iree_uk_write_random_buffer(in_buffer, in_buffer_size, in_type, engine);
-  params.in_offset = iree_uk_random_engine_get_0_65535(engine);
-  params.out_offset = iree_uk_random_engine_get_0_65535(engine);
-  params.in_buffer =
-      (const char*)in_buffer - (params.in_offset * iree_uk_type_size(in_type));
+  params.in_offset =
+      elems_per_byte * iree_uk_random_engine_get_0_65535(engine);
+  params.out_offset =
+      elems_per_byte * iree_uk_random_engine_get_0_65535(engine);
+  params.in_buffer = (const char*)in_buffer -
+                     iree_uk_type_elems_to_bytes(in_type, params.in_offset);
 
   iree_uk_pack_params_t reference_params;
   memcpy(&reference_params, &params, sizeof reference_params);
@@ -99,15 +132,16 @@ static void iree_uk_test_pack_for_shape_params(
                               engine);
   reference_params.out_buffer =
       (char*)reference_out_buffer -
-      (params.out_offset * iree_uk_type_size(out_type));
+      iree_uk_type_elems_to_bytes(out_type, params.out_offset);
 
   iree_uk_pack_params_t actual_params;
   memcpy(&actual_params, &params, sizeof actual_params);
   void* actual_out_buffer = malloc(out_buffer_size);
   iree_uk_write_random_buffer(actual_out_buffer, out_buffer_size, out_type,
                               engine);
-  actual_params.out_buffer = (char*)actual_out_buffer -
-                             (params.out_offset * iree_uk_type_size(out_type));
+  actual_params.out_buffer =
+      (char*)actual_out_buffer -
+      iree_uk_type_elems_to_bytes(out_type, params.out_offset);
 
   iree_pack_reference(&reference_params);
   iree_uk_pack(&actual_params);
@@ -141,8 +175,14 @@ static void iree_uk_test_pack_for_tile_params(iree_uk_test_t* test,
     pad_a_lot,
     pad_enum_end
   } pad_t;
+  // Int4 packs do not support transposing the inner dimensions, and need even
+  // sizes along dimension 1 (see iree_uk_pack_i4_as_i8).
+  const iree_uk_pack_params_t* tile_params = src_params;
+  bool is_i4 = iree_uk_pack_in_type(iree_uk_pack_type(tile_params->flags)) ==
+               IREE_UK_TYPE_INT_4;
   for (int i = 0; i < IREE_ARRAYSIZE(outer_shapes); ++i) {
-    for (int transpose_inner = 0; transpose_inner <= 1; ++transpose_inner) {
+    for (int transpose_inner = 0; transpose_inner <= !is_i4;
+         ++transpose_inner) {
       for (int transpose_outer = 0; transpose_outer <= 1; ++transpose_outer) {
         for (pad_t pad = 0; pad < pad_enum_end; ++pad) {
           iree_uk_pack_params_t params;
@@ -173,6 +213,7 @@ static void iree_uk_test_pack_for_tile_params(iree_uk_test_t* test,
                 iree_uk_random_engine_get_0_65535(engine) % tile_size0;
             iree_uk_index_t pad_size1 =
                 iree_uk_random_engine_get_0_65535(engine) % tile_size1;
+            if (is_i4) pad_size1 &= ~1;
             params.in_size0 = params.in_size0 - pad_size0;
             if (params.in_size0 < 0) params.in_size0 = 0;
             params.in_size1 = params.in_size1 - pad_size1;
@@ -209,6 +250,7 @@ int main(int argc, char** argv) {
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 3, 4, "");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F16F16, 6, 7, "");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_BF16BF16, 9, 2, "");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I4I4, 3, 4, "");
 
 #if defined(IREE_ARCH_ARM_64)
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1, "");
@@ -221,13 +263,18 @@ int main(int argc, char** argv) {
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 4, "");
   // Tile size selected for CPU feature i8mm. Same comment as for dotprod.
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 8, "");
+  // Int4 RHS tile sizes selected with CPU features dotprod and i8mm.
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I4I4, 8, 4, "");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I4I4, 8, 8, "");
 #elif defined(IREE_ARCH_X86_64)
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 1, "avx2_fma");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 8, 2, "avx2_fma");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I4I4, 8, 2, "avx2_fma");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 8, 8, "avx2_fma");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 8, 8, "avx2_fma");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 16, 1, "avx512_base");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I8I8, 16, 2, "avx512_base");
+  iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I4I4, 16, 2, "avx512_base");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_F32F32, 16, 16, "avx512_base");
   iree_uk_test_pack(IREE_UK_FLAG_PACK_TYPE_I32I32, 16, 16, "avx512_base");
   // avx512_vnni uses the same tile size and same pack code as avx512_base.
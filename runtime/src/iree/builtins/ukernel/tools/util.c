@@ -33,8 +33,9 @@ void iree_uk_assert_fail(const char* file, int line, const char* function,
 iree_uk_index_t iree_uk_2d_buffer_length(iree_uk_type_t type,
                                          iree_uk_index_t size0,
                                          iree_uk_index_t stride0) {
-  // Just for testing purposes, so it's OK to overestimate size.
-  return size0 * stride0 << iree_uk_type_size_log2(type);
+  // Just for testing purposes, so it's OK to overestimate size. Rounding up to
+  // whole bytes for sub-byte types.
+  return (size0 * stride0 * iree_uk_type_bit_count(type) + 7) / 8;
 }
 
 bool iree_uk_2d_buffers_equal(const void* buf1, const void* buf2,
@@ -86,6 +87,14 @@ int iree_uk_random_engine_get_minus16_plus15(iree_uk_random_engine_t* e) {
 void iree_uk_write_random_buffer(void* buffer, iree_uk_index_t size_in_bytes,
                                  iree_uk_type_t type,
                                  iree_uk_random_engine_t* engine) {
+  if (type == IREE_UK_TYPE_INT_4) {
+    // Each byte holds two 4-bit values. Any bit pattern is a valid pair of
+    // int4 values in [-8, 7], so just write random bytes.
+    for (iree_uk_index_t i = 0; i < size_in_bytes; ++i) {
+      ((uint8_t*)buffer)[i] = iree_uk_random_engine_get_0_65535(engine);
+    }
+    return;
+  }
   iree_uk_index_t elem_size = iree_uk_type_size(type);
   iree_uk_index_t size_in_elems = size_in_bytes / elem_size;
   for (iree_uk_index_t i = 0; i < size_in_elems; ++i) {
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "iree/builtins/ukernel/elementwise_internal.h"
 #include "iree/builtins/ukernel/mmt4d_internal.h"
 #include "iree/builtins/ukernel/pack_internal.h"
 #include "iree/builtins/ukernel/query_tile_sizes_internal.h"
@@ -32,4 +33,28 @@ IREE_UK_WEAK bool iree_uk_query_matmul_tile_sizes_arch(
   return false;
 }
 
+IREE_UK_WEAK iree_uk_elementwise_binary_row_func_t
+iree_uk_x32b_select_row_func_arch(iree_uk_x32b_opcode_t opcode,
+                                  const iree_uk_uint64_t* cpu_data) {
+  return 0;
+}
+
+IREE_UK_WEAK iree_uk_elementwise_unary_row_func_t
+iree_uk_x32u_select_row_func_arch(iree_uk_x32u_opcode_t opcode,
+                                  const iree_uk_uint64_t* cpu_data) {
+  return 0;
+}
+
+IREE_UK_WEAK iree_uk_elementwise_binary_row_func_t
+iree_uk_x16b_select_row_func_arch(iree_uk_x16b_opcode_t opcode,
+                                  const iree_uk_uint64_t* cpu_data) {
+  return 0;
+}
+
+IREE_UK_WEAK iree_uk_elementwise_binary_row_func_t
+iree_uk_x8b_select_row_func_arch(iree_uk_x8b_opcode_t opcode,
+                                 const iree_uk_uint64_t* cpu_data) {
+  return 0;
+}
+
 #endif  // defined(IREE_UK_HAVE_WEAK)
@@ -67,6 +67,15 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
       statistics->device_bytes_freed,
       (statistics->device_bytes_allocated - statistics->device_bytes_freed)));
 
+  if (statistics->cache_hit_count || statistics->cache_miss_count) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "       CACHE: %12" PRIu64 " hits / %12" PRIu64
+        " misses / %12" PRIdsz "B free / %12" PRIdsz "B live peak\n",
+        statistics->cache_hit_count, statistics->cache_miss_count,
+        statistics->cache_bytes_free, statistics->cache_bytes_high_water));
+  }
+
 #else
   // No-op when disabled.
 #endif  // IREE_STATISTICS_ENABLE
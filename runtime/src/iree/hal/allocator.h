@@ -365,6 +365,11 @@ typedef struct iree_hal_allocator_statistics_t {
   iree_device_size_t device_bytes_peak;
   iree_device_size_t device_bytes_allocated;
   iree_device_size_t device_bytes_freed;
+  // Caching allocator statistics; zero when allocations are not cached.
+  uint64_t cache_hit_count;
+  uint64_t cache_miss_count;
+  iree_device_size_t cache_bytes_free;
+  iree_device_size_t cache_bytes_high_water;
   // TODO(benvanik): mapping information (discarded, mapping ranges,
   //                 flushed/invalidated, etc).
 #else
@@ -814,6 +814,13 @@ iree_status_t iree_hal_heap_buffer_wrap(
     iree_byte_span_t data, iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** out_buffer);
 
+// Returns the release callback of the heap buffer backing |buffer| as provided
+// to iree_hal_heap_buffer_wrap or a null callback if |buffer| is not backed by
+// a wrapped heap buffer. Allows the owner of the wrapped memory to recover its
+// state from a buffer handle.
+iree_hal_buffer_release_callback_t iree_hal_heap_buffer_release_callback(
+    iree_hal_buffer_t* buffer);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_t implementation details
 //===----------------------------------------------------------------------===//
@@ -211,6 +211,16 @@ iree_status_t iree_hal_heap_buffer_wrap(
   return status;
 }
 
+iree_hal_buffer_release_callback_t iree_hal_heap_buffer_release_callback(
+    iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_t* allocated_buffer = iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_resource_is(allocated_buffer, &iree_hal_heap_buffer_vtable) ||
+      allocated_buffer->flags != IREE_HAL_HEAP_BUFFER_STORAGE_MODE_EXTERNAL) {
+    return iree_hal_buffer_release_callback_null();
+  }
+  return ((iree_hal_heap_buffer_t*)allocated_buffer)->release_callback;
+}
+
 static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   iree_hal_heap_buffer_t* buffer = (iree_hal_heap_buffer_t*)base_buffer;
   iree_allocator_t host_allocator = base_buffer->host_allocator;
@@ -164,6 +164,136 @@ TEST_P(command_buffer_dispatch_test, DispatchAbs) {
   CleanupExecutable();
 }
 
+// Records a nested command buffer once with indirect bindings and executes it
+// multiple times with different binding tables.
+TEST_P(command_buffer_dispatch_test, DispatchAbsIndirect) {
+  PrepareAbsExecutable();
+
+  iree_hal_command_buffer_t* nested_command_buffer = NULL;
+  iree_status_t status = iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_NESTED,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/2, &nested_command_buffer);
+  if (iree_status_is_unimplemented(status)) {
+    iree_status_ignore(status);
+    CleanupExecutable();
+    GTEST_SKIP() << "Indirect command buffers not supported";
+  }
+  IREE_ASSERT_OK(status);
+
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(nested_command_buffer));
+  iree_hal_descriptor_set_binding_t descriptor_set_bindings[] = {
+      {
+          /*binding=*/0,
+          /*buffer_slot=*/0,
+          /*buffer=*/NULL,
+          /*offset=*/0,
+          IREE_WHOLE_BUFFER,
+      },
+      {
+          /*binding=*/1,
+          /*buffer_slot=*/1,
+          /*buffer=*/NULL,
+          /*offset=*/0,
+          IREE_WHOLE_BUFFER,
+      },
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      nested_command_buffer, pipeline_layout_, /*set=*/0,
+      IREE_ARRAYSIZE(descriptor_set_bindings), descriptor_set_bindings));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+      nested_command_buffer, executable_, /*entry_point=*/0,
+      /*workgroup_x=*/1, /*workgroup_y=*/1, /*workgroup_z=*/1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(nested_command_buffer));
+
+  // Create input and output buffers for each execution.
+  const float input_values[2] = {-2.5f, 7.0f};
+  const float expected_values[2] = {2.5f, 7.0f};
+  iree_hal_buffer_params_t input_params = {0};
+  input_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  input_params.usage =
+      IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE | IREE_HAL_BUFFER_USAGE_TRANSFER;
+  iree_hal_buffer_params_t output_params = {0};
+  output_params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  output_params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                        IREE_HAL_BUFFER_USAGE_TRANSFER |
+                        IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_view_t* input_buffer_views[2] = {NULL, NULL};
+  iree_hal_buffer_t* output_buffers[2] = {NULL, NULL};
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(iree_hal_buffer_view_allocate_buffer_copy(
+        device_, device_allocator_,
+        /*shape_rank=*/0, /*shape=*/NULL, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, input_params,
+        iree_make_const_byte_span((void*)&input_values[i], sizeof(float)),
+        &input_buffer_views[i]));
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, output_params, sizeof(float), &output_buffers[i]));
+  }
+
+  // Execute the nested command buffer once per set of buffers. Some drivers
+  // can record indirect command buffers but not execute them.
+  bool is_unimplemented = false;
+  for (int i = 0; i < 2 && !is_unimplemented; ++i) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    const iree_hal_buffer_binding_t bindings[2] = {
+        {
+            iree_hal_buffer_view_buffer(input_buffer_views[i]),
+            /*offset=*/0,
+            iree_hal_buffer_view_byte_length(input_buffer_views[i]),
+        },
+        {
+            output_buffers[i],
+            /*offset=*/0,
+            sizeof(float),
+        },
+    };
+    const iree_hal_buffer_binding_table_t binding_table = {
+        IREE_ARRAYSIZE(bindings),
+        bindings,
+    };
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    status = iree_hal_command_buffer_execute_commands(
+        command_buffer, nested_command_buffer, binding_table);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_end(command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = SubmitCommandBufferAndWait(command_buffer);
+    }
+    iree_hal_command_buffer_release(command_buffer);
+    if (iree_status_is_unimplemented(status)) {
+      iree_status_ignore(status);
+      is_unimplemented = true;
+    } else {
+      IREE_ASSERT_OK(status);
+    }
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    if (!is_unimplemented) {
+      float output_value = 0.0f;
+      IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+          device_, output_buffers[i],
+          /*source_offset=*/0, &output_value, sizeof(output_value),
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+      EXPECT_EQ(expected_values[i], output_value);
+    }
+    iree_hal_buffer_release(output_buffers[i]);
+    iree_hal_buffer_view_release(input_buffer_views[i]);
+  }
+  iree_hal_command_buffer_release(nested_command_buffer);
+  CleanupExecutable();
+  if (is_unimplemented) {
+    GTEST_SKIP() << "Executing indirect command buffers not supported";
+  }
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
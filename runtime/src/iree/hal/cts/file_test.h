@@ -7,15 +7,27 @@
 #ifndef IREE_HAL_CTS_FILE_TEST_H_
 #define IREE_HAL_CTS_FILE_TEST_H_
 
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
 #include <vector>
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/cts/cts_test_base.h"
+#include "iree/hal/utils/fd_file.h"
+#include "iree/hal/utils/file_transfer.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
+#if defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/resource.h>
+#endif  // IREE_PLATFORM_LINUX
+
 namespace iree {
 namespace hal {
 namespace cts {
@@ -24,6 +36,21 @@ using ::testing::ContainerEq;
 
 namespace {
 constexpr iree_device_size_t kMinimumAlignment = 128;
+
+// Size of the large file tests. Larger than the default 64MiB staging chunk
+// used by streaming file transfers so that transfers span multiple chunks and
+// not a multiple of any chunk alignment so that the final chunk is partial.
+constexpr iree_device_size_t kLargeFileSize =
+    64 * 1024 * 1024 + 3 * 4096 + 123;
+
+// Returns |length| bytes of a pattern that differs between adjacent chunks.
+std::vector<uint8_t> MakeFileContents(iree_device_size_t length, uint8_t seed) {
+  std::vector<uint8_t> contents(length);
+  for (iree_device_size_t i = 0; i < length; ++i) {
+    contents[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12) ^ seed);
+  }
+  return contents;
+}
 }  // namespace
 
 class file_test : public CtsTestBase {
@@ -82,6 +109,63 @@ class file_test : public CtsTestBase {
                                        access, &external_file, release_callback,
                                        out_file));
   }
+
+  void TearDown() override {
+    for (auto& path : temp_paths_) remove(path.c_str());
+    CtsTestBase::TearDown();
+  }
+
+  // Returns a unique path in the test temporary directory that is removed
+  // when the test completes.
+  std::string GetTempPath(const char* unique_name) {
+    const char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+    if (!test_tmpdir) test_tmpdir = getenv("TEMP");
+    if (!test_tmpdir) test_tmpdir = "/tmp";
+    std::random_device d;
+    uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+    char path[256];
+    snprintf(path, sizeof(path), "%s/iree_cts_%" PRIx64 "_%s", test_tmpdir,
+             random, unique_name);
+    temp_paths_.push_back(path);
+    return path;
+  }
+
+  // Opens |path| as a file descriptor-backed file. Returns UNAVAILABLE if the
+  // platform does not support them.
+  iree_status_t OpenFdFile(const std::string& path,
+                           iree_hal_memory_access_t access,
+                           iree_hal_file_t** out_file) {
+    return iree_hal_fd_file_open(
+        access, iree_make_string_view(path.data(), path.size()),
+        IREE_HAL_FD_FILE_FLAG_NONE, iree_allocator_system(), out_file);
+  }
+
+  // Reads the full contents of the file at |path|.
+  std::vector<uint8_t> ReadTempFile(const std::string& path) {
+    std::vector<uint8_t> contents;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return contents;
+    uint8_t chunk[64 * 1024];
+    size_t read_length = 0;
+    while ((read_length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      contents.insert(contents.end(), chunk, chunk + read_length);
+    }
+    fclose(file);
+    return contents;
+  }
+
+  // Allocates a device buffer initialized with |contents|.
+  void CreateDeviceBufferWithContents(const std::vector<uint8_t>& contents,
+                                      iree_hal_buffer_t** out_buffer) {
+    CreatePatternedDeviceBuffer(contents.size(), 0xCD, out_buffer);
+    IREE_CHECK_OK(iree_hal_device_transfer_h2d(
+        device_, contents.data(), *out_buffer, /*target_offset=*/0,
+        contents.size(), IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+  }
+
+  std::vector<std::string> temp_paths_;
 };
 
 // Reads the entire file into a buffer and check the contents match.
@@ -132,6 +216,167 @@ TEST_P(file_test, ReadEntireFile) {
   iree_hal_file_release(file);
 }
 
+// Reads a file descriptor-backed file larger than one staging chunk into a
+// buffer and checks the contents match.
+TEST_P(file_test, ReadLargeFdFile) {
+  std::vector<uint8_t> contents = MakeFileContents(kLargeFileSize, 0x5A);
+  std::string path = GetTempPath("ReadLargeFdFile");
+  FILE* temp_file = fopen(path.c_str(), "wb");
+  ASSERT_NE(temp_file, nullptr);
+  ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), temp_file),
+            contents.size());
+  fclose(temp_file);
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = OpenFdFile(path, IREE_HAL_MEMORY_ACCESS_READ, &file);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "file descriptor files unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  iree_hal_buffer_t* buffer = NULL;
+  CreatePatternedDeviceBuffer(kLargeFileSize, 0xCD, &buffer);
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &signal_fence));
+
+  IREE_ASSERT_OK(iree_hal_device_queue_read(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      iree_hal_fence_semaphore_list(signal_fence), /*source_file=*/file,
+      /*source_offset=*/0, /*target_buffer=*/buffer, /*target_offset=*/0,
+      /*length=*/kLargeFileSize, /*flags=*/0));
+
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  std::vector<uint8_t> actual_data(kLargeFileSize);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer, /*source_offset=*/0,
+      /*target_buffer=*/actual_data.data(),
+      /*data_length=*/kLargeFileSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  EXPECT_TRUE(actual_data == contents);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+#if defined(IREE_PLATFORM_LINUX)
+// Streams a file descriptor-backed file with the file descriptor limit lowered
+// such that only the first transfer worker can create an asynchronous reader.
+// The workers that have readers must transfer the whole range.
+TEST_P(file_test, ReadFdFileStreamingWithExhaustedReaders) {
+  constexpr iree_device_size_t kFileSize = 64 * 1024 + 123;
+  std::vector<uint8_t> contents = MakeFileContents(kFileSize, 0x3C);
+  std::string path = GetTempPath("ReadFdFileStreamingWithExhaustedReaders");
+  FILE* temp_file = fopen(path.c_str(), "wb");
+  ASSERT_NE(temp_file, nullptr);
+  ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), temp_file),
+            contents.size());
+  fclose(temp_file);
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = OpenFdFile(path, IREE_HAL_MEMORY_ACCESS_READ, &file);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "file descriptor files unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  iree_hal_buffer_t* buffer = NULL;
+  CreatePatternedDeviceBuffer(kFileSize, 0xCD, &buffer);
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &signal_fence));
+
+  // Leave two file descriptors free: enough for the io_uring ring and the
+  // completion eventfd of a single reader.
+  struct rlimit original_limit;
+  ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &original_limit));
+  rlim_t fd_limit = 0;
+  for (int free_count = 0;
+       fd_limit < original_limit.rlim_cur && free_count < 2; ++fd_limit) {
+    if (fcntl((int)fd_limit, F_GETFD) == -1) ++free_count;
+  }
+  struct rlimit limit = original_limit;
+  limit.rlim_cur = fd_limit;
+  ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limit));
+  iree_status_t loop_status = iree_ok_status();
+  iree_hal_file_transfer_options_t options = {
+      /*.loop=*/iree_loop_inline(&loop_status),
+      /*.chunk_count=*/4,
+      /*.chunk_size=*/4096,
+  };
+  status = iree_hal_device_queue_read_streaming(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      iree_hal_fence_semaphore_list(signal_fence), /*source_file=*/file,
+      /*source_offset=*/0, /*target_buffer=*/buffer, /*target_offset=*/0,
+      /*length=*/kFileSize, /*flags=*/0, options);
+  ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &original_limit));
+  IREE_ASSERT_OK(status);
+  IREE_ASSERT_OK(loop_status);
+
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  std::vector<uint8_t> actual_data(kFileSize);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer, /*source_offset=*/0,
+      /*target_buffer=*/actual_data.data(),
+      /*data_length=*/kFileSize, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  EXPECT_TRUE(actual_data == contents);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+#endif  // IREE_PLATFORM_LINUX
+
+// Writes a buffer larger than one staging chunk to a file descriptor-backed
+// file and checks the file contents match.
+TEST_P(file_test, WriteLargeFdFile) {
+  std::string path = GetTempPath("WriteLargeFdFile");
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = OpenFdFile(path, IREE_HAL_MEMORY_ACCESS_ALL, &file);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "file descriptor files unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  std::vector<uint8_t> contents = MakeFileContents(kLargeFileSize, 0xA5);
+  iree_hal_buffer_t* buffer = NULL;
+  CreateDeviceBufferWithContents(contents, &buffer);
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &signal_fence));
+
+  IREE_ASSERT_OK(iree_hal_device_queue_write(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      iree_hal_fence_semaphore_list(signal_fence), /*source_buffer=*/buffer,
+      /*source_offset=*/0, /*target_file=*/file, /*target_offset=*/0,
+      /*length=*/kLargeFileSize, /*flags=*/0));
+
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(signal_fence);
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+
+  std::vector<uint8_t> actual_data = ReadTempFile(path);
+  ASSERT_EQ(actual_data.size(), contents.size());
+  EXPECT_TRUE(actual_data == contents);
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
@@ -0,0 +1,250 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+#define IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+using ::testing::ContainerEq;
+
+namespace {
+constexpr iree_device_size_t kAllocationSize = 4096;
+}  // namespace
+
+class queue_alloca_test : public CtsTestBase {
+ protected:
+  // Enqueues a fill of |buffer| with |pattern| ordered between the |wait| and
+  // |signal| timepoints of |semaphore|.
+  void EnqueueFill(iree_hal_semaphore_t* semaphore, uint64_t wait,
+                   uint64_t signal, iree_hal_buffer_t* buffer,
+                   uint8_t pattern) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffer, 0, kAllocationSize, &pattern,
+        sizeof(pattern)));
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+    iree_hal_semaphore_list_t wait_semaphores = {1, &semaphore, &wait};
+    iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore, &signal};
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores,
+        signal_semaphores, 1, &command_buffer));
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> data(kAllocationSize);
+    IREE_CHECK_OK(iree_hal_device_transfer_d2h(
+        device_, buffer, 0, data.data(), data.size(),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    return data;
+  }
+
+  // Returns the host pointer of the mapped contents of |buffer|.
+  const void* MapContents(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+        IREE_WHOLE_BUFFER, &mapping));
+    const void* contents = mapping.contents.data;
+    IREE_CHECK_OK(iree_hal_buffer_unmap_range(&mapping));
+    return contents;
+  }
+
+  iree_hal_buffer_params_t MakeParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE;
+    return params;
+  }
+};
+
+// Allocates, uses, and deallocates a buffer entirely in queue order.
+TEST_P(queue_alloca_test, AllocaUseDealloca) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+
+  uint64_t alloca_wait = 0ull;
+  uint64_t alloca_signal = 1ull;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &alloca_wait},
+      {1, &semaphore, &alloca_signal}, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      MakeParams(), kAllocationSize, &buffer));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_GE(iree_hal_buffer_byte_length(buffer), kAllocationSize);
+
+  EnqueueFill(semaphore, 1ull, 2ull, buffer, 0x5A);
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 2ull, iree_infinite_timeout()));
+  EXPECT_THAT(ReadBuffer(buffer),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, 0x5A)));
+
+  uint64_t dealloca_wait = 2ull;
+  uint64_t dealloca_signal = 3ull;
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &dealloca_wait},
+      {1, &semaphore, &dealloca_signal}, buffer));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 3ull, iree_infinite_timeout()));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Allocates a buffer ordered after the deallocation of a prior buffer such
+// that implementations may reuse the deallocated memory. The new buffer must be
+// fully usable and not alias the prior buffer while it is still live.
+TEST_P(queue_alloca_test, ReuseAfterDealloca) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+
+  uint64_t values[] = {0ull, 1ull, 2ull, 3ull, 4ull, 5ull, 6ull};
+
+  iree_hal_buffer_t* buffer0 = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[0]},
+      {1, &semaphore, &values[1]}, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      MakeParams(), kAllocationSize, &buffer0));
+  EnqueueFill(semaphore, 1ull, 2ull, buffer0, 0x11);
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[2]},
+      {1, &semaphore, &values[3]}, buffer0));
+
+  iree_hal_buffer_t* buffer1 = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[3]},
+      {1, &semaphore, &values[4]}, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      MakeParams(), kAllocationSize, &buffer1));
+  EnqueueFill(semaphore, 4ull, 5ull, buffer1, 0x22);
+
+  // A buffer allocated while buffer1 is live must not alias it.
+  iree_hal_buffer_t* buffer2 = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[5]},
+      {1, &semaphore, &values[6]}, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      MakeParams(), kAllocationSize, &buffer2));
+  EnqueueFill(semaphore, 6ull, 7ull, buffer2, 0x33);
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 7ull, iree_infinite_timeout()));
+
+  EXPECT_THAT(ReadBuffer(buffer1),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, 0x22)));
+  EXPECT_THAT(ReadBuffer(buffer2),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, 0x33)));
+
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Allocates a buffer waiting on the deallocation of a prior buffer on the same
+// timeline. Implementations that report reusing queue-ordered allocations must
+// return the deallocated memory.
+TEST_P(queue_alloca_test, DeallocaThenAllocaReusesMemory) {
+  int64_t reuses_memory = 0;
+  iree_status_t query_status = iree_hal_device_query_i64(
+      device_, IREE_SV("hal.device"), IREE_SV("queue_alloca_reuse"),
+      &reuses_memory);
+  if (!iree_status_is_ok(query_status) || !reuses_memory) {
+    iree_status_ignore(query_status);
+    GTEST_SKIP() << "Queue-ordered allocation reuse not supported";
+  }
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_buffer_params_t params = MakeParams();
+  params.type |= IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage |= IREE_HAL_BUFFER_USAGE_MAPPING;
+
+  uint64_t values[] = {0ull, 1ull, 2ull, 3ull};
+  iree_hal_buffer_t* buffer0 = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[0]},
+      {1, &semaphore, &values[1]}, IREE_HAL_ALLOCATOR_POOL_DEFAULT, params,
+      kAllocationSize, &buffer0));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout()));
+  const void* contents0 = MapContents(buffer0);
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[1]},
+      {1, &semaphore, &values[2]}, buffer0));
+
+  iree_hal_buffer_t* buffer1 = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, {1, &semaphore, &values[2]},
+      {1, &semaphore, &values[3]}, IREE_HAL_ALLOCATOR_POOL_DEFAULT, params,
+      kAllocationSize, &buffer1));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 3ull, iree_infinite_timeout()));
+  EXPECT_EQ(MapContents(buffer1), contents0);
+
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Allocates a buffer waiting on a timepoint that has not been reached. The
+// allocation must not signal until the wait is satisfied. The wait is signaled
+// from another thread as synchronous implementations block in the alloca.
+TEST_P(queue_alloca_test, AllocaWaitsOnUnsignaledSemaphore) {
+  iree_hal_semaphore_t* wait_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &wait_semaphore));
+  iree_hal_semaphore_t* signal_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &signal_semaphore));
+
+  uint64_t value_before_signal = UINT64_MAX;
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_query(signal_semaphore, &value_before_signal));
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore, 1ull));
+  });
+
+  uint64_t alloca_wait = 1ull;
+  uint64_t alloca_signal = 1ull;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+      {1, &wait_semaphore, &alloca_wait},
+      {1, &signal_semaphore, &alloca_signal}, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+      MakeParams(), kAllocationSize, &buffer));
+  ASSERT_NE(buffer, nullptr);
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(signal_semaphore, 1ull,
+                                         iree_infinite_timeout()));
+  thread.join();
+  EXPECT_EQ(value_before_signal, 0ull);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(signal_semaphore);
+  iree_hal_semaphore_release(wait_semaphore);
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
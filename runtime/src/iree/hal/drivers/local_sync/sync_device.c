@@ -18,6 +18,7 @@
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiler.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/file_transfer.h"
@@ -225,7 +226,10 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
-  if (iree_all_bits_set(mode,
+  // Indirect command buffers can't execute inline as their bindings are not
+  // known until they are executed with a binding table.
+  if (binding_capacity == 0 &&
+      iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
     return iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
@@ -260,8 +264,10 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
-      identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      identifier, /*worker_capacity=*/1,
+      iree_hal_local_executable_cache_scheduler_null(), device->loader_count,
+      device->loaders, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_sync_device_import_file(
@@ -464,23 +470,19 @@ static iree_status_t iree_hal_sync_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_sync_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  // Queue operation profiling is unimplemented (and that's ok); dispatch and
+  // executable counters are captured per export with perf_event_open where
+  // available.
+  if (!iree_hal_local_profiler_is_requested(options)) return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  return iree_hal_local_profiler_begin(options, device->host_allocator);
 }
 
 static iree_status_t iree_hal_sync_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  return iree_hal_local_profiler_end();
 }
 
 static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
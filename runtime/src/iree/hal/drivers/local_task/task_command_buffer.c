@@ -12,10 +12,14 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/nontemporal.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiler.h"
+#include "iree/hal/local/trace_location.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/list.h"
@@ -26,6 +30,132 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// Maximum number of buffer accesses tracked for hazards before the command
+// buffer collapses them into a single join task. Bounds the recording cost of
+// long command buffers at the cost of concurrency across the join.
+#define IREE_HAL_TASK_COMMAND_BUFFER_MAX_TRACKED_ACCESSES 256
+
+// An edge in the command DAG from a node to a node that must execute after it.
+typedef struct iree_hal_task_cmd_edge_t {
+  struct iree_hal_task_cmd_edge_t* next;
+  struct iree_hal_task_cmd_node_t* target;
+} iree_hal_task_cmd_edge_t;
+
+// A recorded command in the DAG wrapping the task that executes it.
+// Nodes are only used during recording and are linked into the task graph when
+// the command buffer ends.
+typedef struct iree_hal_task_cmd_node_t {
+  // Next node in recording order.
+  struct iree_hal_task_cmd_node_t* next;
+  // Task executing the command. Joins created when collapsing hazard tracking
+  // are barrier tasks and fan out to their successors directly.
+  iree_task_t* task;
+  // Execution barrier epoch the command was recorded in.
+  uint32_t epoch;
+  // Ordinal of the command in recording order.
+  uint32_t sequence;
+  // Total number of nodes that must complete before this one may execute.
+  iree_host_size_t predecessor_count;
+  // Nodes that must execute after this one, most recently added first.
+  iree_host_size_t successor_count;
+  iree_hal_task_cmd_edge_t* successors;
+} iree_hal_task_cmd_node_t;
+
+// A buffer range accessed by a recorded command.
+typedef struct iree_hal_task_cmd_access_t {
+  struct iree_hal_task_cmd_access_t* next;
+  iree_hal_task_cmd_node_t* node;
+  // Host address range accessed as [begin, end). Distinct buffers wrapping or
+  // importing the same host memory alias through their addresses. Accesses
+  // that may touch any memory use [0, IREE_DEVICE_SIZE_MAX).
+  iree_device_size_t begin;
+  iree_device_size_t end;
+  bool is_write;
+} iree_hal_task_cmd_access_t;
+
+// An event signaled within the command buffer.
+typedef struct iree_hal_task_cmd_event_t {
+  struct iree_hal_task_cmd_event_t* next;
+  const iree_hal_event_t* event;
+  // All commands with a sequence less than this precede the signal.
+  uint32_t sequence;
+} iree_hal_task_cmd_event_t;
+
+// An execution of an indirect command buffer recorded within the command
+// buffer. Later executions of the same command buffer are ordered after it as
+// there is only a single copy of its tasks.
+typedef struct iree_hal_task_cmd_execution_t {
+  struct iree_hal_task_cmd_execution_t* next;
+  const iree_hal_command_buffer_t* commands;
+  iree_hal_task_cmd_node_t* node;
+} iree_hal_task_cmd_execution_t;
+
+// A dispatch binding sourced from a binding table slot. The binding pointer and
+// length of the dispatch are written each time the indirect command buffer it
+// was recorded in is executed.
+typedef struct iree_hal_task_cmd_slot_binding_t {
+  struct iree_hal_task_cmd_slot_binding_t* next;
+  void** binding_ptr;
+  size_t* binding_length;
+  uint32_t slot;
+  // Range within the slot; |length| may be IREE_WHOLE_BUFFER.
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_task_cmd_slot_binding_t;
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+// Maximum depth of debug groups traced around each command. Groups nested
+// deeper are ignored.
+#define IREE_HAL_TASK_CMD_MAX_DEBUG_GROUP_DEPTH 8
+
+// A debug group active during recording. Commands reference the innermost
+// group active when they were recorded and have zones for it and its parents
+// opened around them as they execute.
+typedef struct iree_hal_task_cmd_debug_group_t {
+  struct iree_hal_task_cmd_debug_group_t* parent;
+  // Nesting depth of the group with 1 being the outermost.
+  iree_host_size_t depth;
+  // Interned location that lives for the process.
+  const iree_tracing_location_t* location;
+} iree_hal_task_cmd_debug_group_t;
+
+// Zones opened for the debug groups enclosing an executing command.
+typedef struct iree_hal_task_cmd_debug_zones_t {
+  iree_host_size_t count;
+  iree_zone_id_t zone_ids[IREE_HAL_TASK_CMD_MAX_DEBUG_GROUP_DEPTH];
+} iree_hal_task_cmd_debug_zones_t;
+
+// Begins zones for |group| and its parents from outermost to innermost.
+static void iree_hal_task_cmd_debug_zones_begin(
+    const iree_hal_task_cmd_debug_group_t* group,
+    iree_hal_task_cmd_debug_zones_t* out_zones) {
+  out_zones->count =
+      group ? iree_min(group->depth, IREE_HAL_TASK_CMD_MAX_DEBUG_GROUP_DEPTH)
+            : 0;
+  const iree_tracing_location_t*
+      locations[IREE_HAL_TASK_CMD_MAX_DEBUG_GROUP_DEPTH];
+  for (; group; group = group->parent) {
+    if (group->depth <= out_zones->count) {
+      locations[group->depth - 1] = group->location;
+    }
+  }
+  for (iree_host_size_t i = 0; i < out_zones->count; ++i) {
+    IREE_TRACE_ZONE_BEGIN_LOCATION(zone_id, locations[i]);
+    out_zones->zone_ids[i] = zone_id;
+  }
+}
+
+// Ends zones begun with iree_hal_task_cmd_debug_zones_begin.
+static void iree_hal_task_cmd_debug_zones_end(
+    const iree_hal_task_cmd_debug_zones_t* zones) {
+  for (iree_host_size_t i = zones->count; i > 0; --i) {
+    IREE_TRACE_ZONE_END(zones->zone_ids[i - 1]);
+  }
+}
+
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -34,12 +164,34 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Command buffers not created as one-shot are reusable: their tasks are
+// retained after recording along with the state they had prior to their first
+// issue and each time the command buffer is issued the same tasks are reset and
+// enqueued again. All leaf tasks complete into an exit barrier that marks the
+// command buffer as no longer in flight. Only one issue may be in flight at a
+// time as there is only a single copy of each task.
+//
+// Command buffers with a binding capacity are indirect and always reusable.
+// Dispatch bindings referencing binding table slots are recorded as such and
+// resolved each time the command buffer is executed with a binding table via
+// execute_commands: a call task in the executing command buffer patches the
+// bindings and then resets and nests the same tasks under itself.
+//
+// Execution barriers and events don't serialize all commands. Instead each
+// command tracks the buffer ranges it reads and writes and is only ordered
+// after commands from before a barrier (or signaled event) that it has a
+// read-after-write, write-after-read, or write-after-write hazard with.
+// Independent commands separated by barriers can then execute concurrently.
 typedef struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
   iree_task_scope_t* scope;
 
+  // Options controlling how fill and copy commands are tiled and stored.
+  iree_hal_task_transfer_options_t transfer_options;
+
   // Arena used for all allocations; references the shared device block pool.
   iree_arena_allocator_t arena;
 
@@ -54,29 +206,59 @@ typedef struct iree_hal_task_command_buffer_t {
 
   // One or more tasks at the leaves of the DAG.
   // Only once all these tasks have completed execution will the command buffer
-  // be considered completed as a whole.
-  //
-  // An empty list indicates that root_tasks are also the leaves.
-  iree_task_list_t leaf_tasks;
+  // be considered completed as a whole. Tasks may be both roots and leaves.
+  iree_host_size_t leaf_task_count;
+  iree_task_t** leaf_tasks;
+
+  // All tasks of a reusable command buffer and the state each is reset to
+  // prior to being issued. Unused by one-shot command buffers.
+  iree_host_size_t task_count;
+  iree_task_t** tasks;
+  iree_task_reset_state_t* task_reset_states;
+
+  // Barrier that all leaf tasks of a reusable command buffer complete into.
+  // Chains to the retire task of the issue it is in flight for.
+  iree_task_barrier_t exit_barrier;
+
+  // Nonzero while a reusable command buffer is issued and its exit barrier has
+  // not yet retired.
+  iree_atomic_int32_t in_flight;
+
+  // Dispatch bindings of an indirect command buffer that are resolved against
+  // the binding table each time it is executed.
+  iree_hal_task_cmd_slot_binding_t* slot_bindings;
 
   // TODO(benvanik): move this out of the struct and allocate from the arena -
   // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
   struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
+    // All recorded nodes in recording order.
+    iree_hal_task_cmd_node_t* node_head;
+    iree_hal_task_cmd_node_t* node_tail;
+    uint32_t node_count;
+
+    // Current execution barrier epoch. Commands are ordered after conflicting
+    // commands from prior epochs.
+    uint32_t epoch;
+
+    // Commands with a sequence less than this have been waited on by an event
+    // and subsequent commands are ordered after any they conflict with.
+    uint32_t event_sequence;
+
+    // Accesses of all commands that may still need to be ordered before future
+    // commands, most recent first.
+    iree_hal_task_cmd_access_t* accesses;
+    iree_host_size_t access_count;
 
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
+    // Events signaled within the command buffer, most recent first.
+    iree_hal_task_cmd_event_t* events;
 
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
+    // Indirect command buffers executed within the command buffer along with
+    // their most recent execution.
+    iree_hal_task_cmd_execution_t* executions;
+
+    // Innermost debug group active or NULL if none.
+    IREE_TRACE(iree_hal_task_cmd_debug_group_t* debug_group;)
 
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -89,6 +271,17 @@ typedef struct iree_hal_task_command_buffer_t {
         binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
+    // Offsets of bindings sourced from binding table slots.
+    iree_device_size_t
+        binding_offsets[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                        IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
+    // Bindings sourced from binding table slots and the slot of each. Offsets
+    // and lengths of those bindings are relative to the slot.
+    iree_hal_local_binding_mask_t slot_binding_mask;
+    uint32_t binding_slots[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                           IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
     // All available push constants updated each time push_constants is called.
     // Reset only with the command buffer and otherwise will maintain its values
     // during recording to allow for partial push_constants updates.
@@ -110,30 +303,13 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    const iree_hal_task_transfer_options_t* transfer_options,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
+  IREE_ASSERT_ARGUMENT(transfer_options);
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
-  if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_command_buffer_t* command_buffer = NULL;
@@ -145,9 +321,17 @@ iree_status_t iree_hal_task_command_buffer_create(
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
+    command_buffer->transfer_options = *transfer_options;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
-    iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->leaf_task_count = 0;
+    command_buffer->leaf_tasks = NULL;
+    command_buffer->task_count = 0;
+    command_buffer->tasks = NULL;
+    command_buffer->task_reset_states = NULL;
+    iree_atomic_store_int32(&command_buffer->in_flight, 0,
+                            iree_memory_order_relaxed);
+    command_buffer->slot_bindings = NULL;
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -170,8 +354,18 @@ static void iree_hal_task_command_buffer_destroy(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+  // Leaf tasks are reachable from the root tasks and discarded with them.
   iree_task_list_discard(&command_buffer->root_tasks);
-  iree_task_list_discard(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
+  // Tasks of reusable command buffers are not in flight as the command buffer
+  // is retained until its issues retire and are owned by the arena.
+  IREE_ASSERT_EQ(0, iree_atomic_load_int32(&command_buffer->in_flight,
+                                           iree_memory_order_acquire));
+  command_buffer->task_count = 0;
+  command_buffer->tasks = NULL;
+  command_buffer->task_reset_states = NULL;
+  command_buffer->slot_bindings = NULL;
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_allocator_free(host_allocator, command_buffer);
@@ -189,14 +383,15 @@ bool iree_hal_task_command_buffer_isa(
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+static iree_status_t iree_hal_task_command_buffer_link_tasks(
     iree_hal_task_command_buffer_t* command_buffer);
 
 static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (!iree_task_list_is_empty(&command_buffer->root_tasks) ||
+      command_buffer->task_count > 0) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
@@ -208,142 +403,437 @@ static iree_status_t iree_hal_task_command_buffer_end(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // Flush any open barriers.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
-  }
+  // Link all recorded commands into the task DAG.
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_link_tasks(command_buffer));
 
   iree_hal_resource_set_freeze(command_buffer->resource_set);
 
   return iree_ok_status();
 }
 
-// Flushes all open tasks to the previous barrier and prepares for more
-// recording. The root tasks are also populated here when required as this is
-// the one place where we can see both halves of the most recent synchronization
-// event: those tasks recorded prior (if any) and the task that marks the set of
-// tasks that will be recorded after (if any).
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+// Returns true if |command_buffer| retains its tasks to issue them again.
+// Indirect command buffers are always reusable as they are executed with a new
+// binding table each time.
+static bool iree_hal_task_command_buffer_is_reusable(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  return command_buffer->base.binding_capacity > 0 ||
+         !iree_all_bits_set(command_buffer->base.mode,
+                            IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+}
+
+// Cleanup for the exit barrier of a reusable command buffer marking it as no
+// longer in flight. Called when the barrier retires or is discarded after all
+// other tasks in the command buffer have retired or been discarded.
+static void iree_hal_task_command_buffer_exit_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_command_buffer_t* command_buffer =
+      (iree_hal_task_command_buffer_t*)((uint8_t*)task -
+                                        offsetof(iree_hal_task_command_buffer_t,
+                                                 exit_barrier));
+  iree_atomic_store_int32(&command_buffer->in_flight, 0,
+                          iree_memory_order_release);
+}
+
+// Links the tasks of all recorded nodes together based on the edges that were
+// added during recording and populates the root and leaf task sets. Nodes with
+// a single successor chain to it directly via their completion task while those
+// with multiple successors fork out through a barrier.
+//
+// Reusable command buffers additionally chain their leaf tasks to the exit
+// barrier and capture the state of all tasks so they can be reset on issue.
+static iree_status_t iree_hal_task_command_buffer_link_tasks(
     iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
-  if (open_barrier != NULL) {
-    // There is an open barrier we need to fixup the fork out to all of the open
-    // tasks that were recorded after it.
-    iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
-    iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
-    if (dependent_task_count == 1) {
-      // Special-case: only one open task so we can avoid the additional barrier
-      // overhead by reusing the completion task.
-      iree_task_set_completion_task(&open_barrier->header, task_head);
-    } else if (dependent_task_count > 1) {
-      // Allocate the list of tasks we'll stash back on the previous barrier.
-      // Since we couldn't know at the time how many tasks would end up in the
-      // barrier we had to defer it until now.
+  const bool is_reusable =
+      iree_hal_task_command_buffer_is_reusable(command_buffer);
+  iree_host_size_t leaf_task_count = 0;
+  iree_host_size_t task_count = 0;
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head; node;
+       node = node->next) {
+    ++task_count;
+    if (node->successor_count == 0) {
+      ++leaf_task_count;
+    } else if (node->successor_count > 1 &&
+               node->task->type != IREE_TASK_TYPE_BARRIER) {
+      ++task_count;  // fork barrier
+    }
+  }
+  if (leaf_task_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, leaf_task_count * sizeof(iree_task_t*),
+        (void**)&command_buffer->leaf_tasks));
+  }
+  iree_task_t** tasks = NULL;
+  if (is_reusable && task_count > 0) {
+    ++task_count;  // exit barrier
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             task_count * sizeof(*tasks),
+                                             (void**)&tasks));
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena,
+        task_count * sizeof(*command_buffer->task_reset_states),
+        (void**)&command_buffer->task_reset_states));
+    command_buffer->tasks = tasks;
+  }
+
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head; node;
+       node = node->next) {
+    if (tasks) tasks[command_buffer->task_count++] = node->task;
+    if (node->predecessor_count == 0) {
+      iree_task_list_push_back(&command_buffer->root_tasks, node->task);
+    }
+    if (node->successor_count == 0) {
+      command_buffer->leaf_tasks[command_buffer->leaf_task_count++] =
+          node->task;
+    } else if (node->successor_count == 1) {
+      // Special-case: only one successor so we can avoid the additional
+      // barrier overhead by reusing the completion task.
+      iree_task_set_completion_task(node->task, node->successors->target->task);
+    } else {
       iree_task_t** dependent_tasks = NULL;
       IREE_RETURN_IF_ERROR(iree_arena_allocate(
-          &command_buffer->arena, dependent_task_count * sizeof(iree_task_t*),
+          &command_buffer->arena, node->successor_count * sizeof(iree_task_t*),
           (void**)&dependent_tasks));
-      iree_task_t* task = task_head;
-      for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
-        dependent_tasks[i] = task;
-        task = task->next_task;
+      iree_host_size_t i = 0;
+      for (iree_hal_task_cmd_edge_t* edge = node->successors; edge;
+           edge = edge->next) {
+        dependent_tasks[i++] = edge->target->task;
+      }
+      iree_task_barrier_t* barrier = NULL;
+      if (node->task->type == IREE_TASK_TYPE_BARRIER) {
+        // Joins are already barriers and can fork to their successors.
+        barrier = (iree_task_barrier_t*)node->task;
+      } else {
+        IREE_RETURN_IF_ERROR(iree_arena_allocate(
+            &command_buffer->arena, sizeof(*barrier), (void**)&barrier));
+        iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+        iree_task_set_completion_task(node->task, &barrier->header);
+        if (tasks) tasks[command_buffer->task_count++] = &barrier->header;
       }
-      iree_task_barrier_set_dependent_tasks(open_barrier, dependent_task_count,
+      iree_task_barrier_set_dependent_tasks(barrier, node->successor_count,
                                             dependent_tasks);
     }
   }
-  command_buffer->state.open_barrier = NULL;
-
-  // Move the open tasks to the tail as they represent the first half of the
-  // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
-                        &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+
+  if (tasks) {
+    // The exit barrier joins all leaves and is chained to the retire task of
+    // each issue. Roots are found from the captured state when issuing.
+    iree_task_barrier_t* exit_barrier = &command_buffer->exit_barrier;
+    iree_task_barrier_initialize_empty(command_buffer->scope, exit_barrier);
+    iree_task_set_cleanup_fn(&exit_barrier->header,
+                             iree_hal_task_command_buffer_exit_cleanup);
+    for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+      iree_task_set_completion_task(command_buffer->leaf_tasks[i],
+                                    &exit_barrier->header);
+    }
+    tasks[command_buffer->task_count++] = &exit_barrier->header;
+    IREE_ASSERT_EQ(command_buffer->task_count, task_count);
+    for (iree_host_size_t i = 0; i < command_buffer->task_count; ++i) {
+      iree_task_capture_reset_state(tasks[i],
+                                    &command_buffer->task_reset_states[i]);
+    }
+    iree_task_list_initialize(&command_buffer->root_tasks);
+    command_buffer->leaf_task_count = 0;
+    command_buffer->leaf_tasks = NULL;
   }
 
+  // Recording state is no longer needed and its storage is owned by the arena.
+  command_buffer->state.node_head = NULL;
+  command_buffer->state.node_tail = NULL;
+  command_buffer->state.accesses = NULL;
+  command_buffer->state.access_count = 0;
+  command_buffer->state.events = NULL;
+  command_buffer->state.executions = NULL;
+
   return iree_ok_status();
 }
 
-// Emits a global barrier, splitting execution into all prior recorded tasks
-// and all subsequent recorded tasks. This is currently the critical piece that
-// limits our concurrency: changing to fine-grained barriers (via barrier
-// buffers or events) will allow more work to overlap at the cost of more brain
-// to build out the proper task graph.
-static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
+// Adds an edge ordering |target| after |node|.
+static iree_status_t iree_hal_task_command_buffer_add_edge(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_task_cmd_node_t* target) {
+  // Edges to a node are all added while it is the most recently recorded node
+  // and as such any existing edge to it will be at the head of the list.
+  if (node->successors && node->successors->target == target) {
+    return iree_ok_status();
+  }
+  iree_hal_task_cmd_edge_t* edge = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*edge), (void**)&edge));
+  edge->next = node->successors;
+  edge->target = target;
+  node->successors = edge;
+  ++node->successor_count;
+  ++target->predecessor_count;
+  return iree_ok_status();
+}
+
+// Appends a new node for |task| to the recorded command list.
+static iree_status_t iree_hal_task_command_buffer_append_node(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_hal_task_cmd_node_t** out_node) {
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*node), (void**)&node));
+  memset(node, 0, sizeof(*node));
+  node->task = task;
+  node->epoch = command_buffer->state.epoch;
+  node->sequence = command_buffer->state.node_count++;
+  if (command_buffer->state.node_tail) {
+    command_buffer->state.node_tail->next = node;
+  } else {
+    command_buffer->state.node_head = node;
+  }
+  command_buffer->state.node_tail = node;
+  *out_node = node;
+  return iree_ok_status();
+}
+
+// Returns true if the accessed ranges |a| and |b| may alias and at least one
+// of them is a write.
+static bool iree_hal_task_cmd_access_conflicts(
+    const iree_hal_task_cmd_access_t* a, const iree_hal_task_cmd_access_t* b) {
+  if (!a->is_write && !b->is_write) return false;
+  return a->begin < b->end && b->begin < a->end;
+}
+
+// Returns true if |a| is a write covering all memory accessed by |b|.
+static bool iree_hal_task_cmd_access_covers(
+    const iree_hal_task_cmd_access_t* a, const iree_hal_task_cmd_access_t* b) {
+  if (!a->is_write) return false;
+  return a->begin <= b->begin && b->end <= a->end;
+}
+
+// Records that |node| accesses the host address range [|begin|, |end|) and
+// orders it after any prior command that it must synchronize with.
+static iree_status_t iree_hal_task_command_buffer_track_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_device_size_t begin,
+    iree_device_size_t end, bool is_write) {
+  iree_hal_task_cmd_access_t* access = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*access), (void**)&access));
+  access->node = node;
+  access->begin = begin;
+  access->end = end;
+  access->is_write = is_write;
+
+  // Only commands recorded prior to an execution barrier or a signaled event
+  // that has since been waited on need to complete before this one. Commands
+  // within the same synchronization scope are allowed to execute concurrently.
+  for (iree_hal_task_cmd_access_t* prior = command_buffer->state.accesses;
+       prior != NULL; prior = prior->next) {
+    iree_hal_task_cmd_node_t* prior_node = prior->node;
+    if (prior_node == node) continue;
+    if (prior_node->epoch == command_buffer->state.epoch &&
+        prior_node->sequence >= command_buffer->state.event_sequence) {
+      continue;
+    }
+    if (!iree_hal_task_cmd_access_conflicts(prior, access)) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+        command_buffer, prior_node, node));
+  }
+
+  access->next = command_buffer->state.accesses;
+  command_buffer->state.accesses = access;
+  ++command_buffer->state.access_count;
+  return iree_ok_status();
+}
+
+// Records that |node| may access any memory.
+static iree_status_t iree_hal_task_command_buffer_track_all_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, bool is_write) {
+  return iree_hal_task_command_buffer_track_access(
+      command_buffer, node, 0, IREE_DEVICE_SIZE_MAX, is_write);
+}
+
+// Records that |node| accesses the host memory |contents|.
+static iree_status_t iree_hal_task_command_buffer_track_host_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_byte_span_t contents, bool is_write) {
+  iree_device_size_t begin = (iree_device_size_t)(uintptr_t)contents.data;
+  return iree_hal_task_command_buffer_track_access(
+      command_buffer, node, begin, begin + contents.data_length, is_write);
+}
+
+// Tracks an access of |length| bytes of |buffer| at |offset| by |node|.
+// The access is keyed on the host memory backing |buffer| so that commands
+// using distinct buffers that wrap the same host allocation are ordered.
+// Buffers that cannot be mapped are conservatively tracked as accessing all
+// memory.
+static iree_status_t iree_hal_task_command_buffer_track_buffer_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_buffer_t* buffer,
+    iree_device_size_t offset, iree_device_size_t length, bool is_write) {
+  if (length == 0) return iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+      !iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                         IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED)) {
+    return iree_hal_task_command_buffer_track_all_access(command_buffer, node,
+                                                         is_write);
+  }
+  iree_hal_buffer_mapping_t mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      is_write ? IREE_HAL_MEMORY_ACCESS_WRITE : IREE_HAL_MEMORY_ACCESS_READ,
+      offset, length, &mapping));
+  iree_status_t status = iree_hal_task_command_buffer_track_host_access(
+      command_buffer, node, mapping.contents, is_write);
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+}
+
+// Drops tracked accesses that have been fully overwritten by a write from a
+// later synchronization scope. The write was ordered after the dropped access
+// and any future command that conflicts with it will be ordered after the
+// write.
+static void iree_hal_task_command_buffer_prune_accesses(
     iree_hal_task_command_buffer_t* command_buffer) {
-  // Flush open tasks to the previous barrier. This resets our state such that
-  // we can assign the new open barrier and start recording tasks for it.
-  // Previous tasks will be moved into the leaf_tasks list.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
+  iree_hal_task_cmd_access_t** access_ptr = &command_buffer->state.accesses;
+  while (*access_ptr) {
+    iree_hal_task_cmd_access_t* access = *access_ptr;
+    bool is_covered = false;
+    for (iree_hal_task_cmd_access_t* write = command_buffer->state.accesses;
+         write != access; write = write->next) {
+      if (write->node->epoch > access->node->epoch &&
+          iree_hal_task_cmd_access_covers(write, access)) {
+        is_covered = true;
+        break;
+      }
+    }
+    if (is_covered) {
+      *access_ptr = access->next;
+      --command_buffer->state.access_count;
+    } else {
+      access_ptr = &access->next;
+    }
+  }
+}
 
-  // Allocate the new open barrier.
-  // As we are recording forward we can't yet assign the dependent tasks (the
-  // second half of the synchronization domain) and instead are just inserting
-  // it so we can setup the join from previous tasks (the first half of the
-  // synchronization domain).
+// Joins all commands recorded so far and replaces their tracked accesses with a
+// single access of all memory by the join. This bounds the cost of tracking
+// hazards in long command buffers at the cost of forcing a join-fork point.
+// Must only be called between commands as the join must not precede a command
+// that is still having its accesses tracked.
+static iree_status_t iree_hal_task_command_buffer_collapse_accesses(
+    iree_hal_task_command_buffer_t* command_buffer) {
   iree_task_barrier_t* barrier = NULL;
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            sizeof(*barrier), (void**)&barrier));
   iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
 
-  // If there were previous tasks then join them to the barrier.
-  for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
-       task != NULL; task = task->next_task) {
-    iree_task_set_completion_task(task, &barrier->header);
-  }
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+  // All prior commands either have no successors or transitively reach one
+  // that doesn't so joining those covers everything. The join acts as an
+  // event waited on by all subsequent commands such that those in the current
+  // synchronization scope are ordered after it as well.
+  iree_hal_task_cmd_node_t* join_node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_node(
+      command_buffer, &barrier->header, &join_node));
+  command_buffer->state.event_sequence = command_buffer->state.node_count;
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head;
+       node != join_node; node = node->next) {
+    if (node->successor_count == 0) {
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+          command_buffer, node, join_node));
+    }
   }
 
-  // Reset the tail of the command buffer to the barrier. This leaves us in a
-  // consistent state if the recording ends immediate after this (the barrier
-  // will be the last task).
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
-  iree_task_list_push_back(&command_buffer->leaf_tasks, &barrier->header);
-
-  // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+  command_buffer->state.accesses = NULL;
+  command_buffer->state.access_count = 0;
+  return iree_hal_task_command_buffer_track_all_access(
+      command_buffer, join_node, /*is_write=*/true);
+}
 
+// Begins a new synchronization scope: all commands recorded after this are
+// ordered after any command recorded prior that they have a hazard with.
+static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  ++command_buffer->state.epoch;
+  iree_hal_task_command_buffer_prune_accesses(command_buffer);
+  if (command_buffer->state.access_count >
+      IREE_HAL_TASK_COMMAND_BUFFER_MAX_TRACKED_ACCESSES) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_collapse_accesses(command_buffer));
+  }
   return iree_ok_status();
 }
 
-// Emits a the given execution |task| into the current open synchronization
-// scope (after state.open_barrier and before the next barrier).
+// Emits a the given execution |task| as a new node in the DAG. The caller must
+// track all memory accessed by the command on the returned node.
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
-    // If there is no open barrier then we are at the head and going right into
-    // the task DAG.
-    iree_task_list_push_back(&command_buffer->leaf_tasks, task);
-  } else {
-    // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_hal_task_cmd_node_t** out_node) {
+  // Commands within a single synchronization scope never prune one another and
+  // the cap must be enforced here to keep hazard tracking linear.
+  if (command_buffer->state.access_count >
+      IREE_HAL_TASK_COMMAND_BUFFER_MAX_TRACKED_ACCESSES) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_collapse_accesses(command_buffer));
   }
-  return iree_ok_status();
+  return iree_hal_task_command_buffer_append_node(command_buffer, task,
+                                                  out_node);
 }
 
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Marks the non-empty reusable |command_buffer| as in flight. There is only one
+// copy of each task and they cannot be reset while a prior issue is still
+// executing them.
+static iree_status_t iree_hal_task_command_buffer_begin_issue(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  if (iree_atomic_exchange_int32(&command_buffer->in_flight, 1,
+                                 iree_memory_order_acq_rel) != 0) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "reusable command buffer is already executing; submissions of the same "
+        "command buffer must be ordered with semaphores");
+  }
+  return iree_ok_status();
+}
+
+// Resets all tasks of a reusable command buffer marked as in flight and
+// enqueues those that are ready to run immediately. The tasks remain owned by
+// the command buffer.
+static void iree_hal_task_command_buffer_rearm(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_task_submission_t* pending_submission) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, command_buffer->task_count);
+
+  for (iree_host_size_t i = 0; i < command_buffer->task_count; ++i) {
+    iree_task_reset(command_buffer->tasks[i],
+                    &command_buffer->task_reset_states[i]);
+  }
+  iree_task_set_completion_task(&command_buffer->exit_barrier.header,
+                                retire_task);
+
+  // Enqueue all root tasks that are ready to run immediately.
+  for (iree_host_size_t i = 0; i < command_buffer->task_count; ++i) {
+    if (command_buffer->task_reset_states[i].pending_dependency_count == 0) {
+      iree_task_submission_enqueue(pending_submission,
+                                   command_buffer->tasks[i]);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Resets all tasks of a reusable command buffer and enqueues those that are
+// ready to run immediately.
+static iree_status_t iree_hal_task_command_buffer_issue_reusable(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_task_submission_t* pending_submission) {
+  // If the command buffer is empty (valid!) then we are a no-op.
+  if (command_buffer->task_count == 0) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_begin_issue(command_buffer));
+  iree_hal_task_command_buffer_rearm(command_buffer, retire_task,
+                                     pending_submission);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -352,27 +842,29 @@ iree_status_t iree_hal_task_command_buffer_issue(
       iree_hal_task_command_buffer_cast(base_command_buffer);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (IREE_UNLIKELY(command_buffer->slot_bindings)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "command buffers referencing binding table slots must be executed with "
+        "a binding table via execute_commands");
+  }
+
+  if (iree_hal_task_command_buffer_is_reusable(command_buffer)) {
+    return iree_hal_task_command_buffer_issue_reusable(
+        command_buffer, retire_task, pending_submission);
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
-  if (has_leaf_tasks) {
-    // Chain the retire task onto the leaf tasks as their completion indicates
-    // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
-  } else {
-    // If we have no leaf tasks it means that this is a single layer DAG and
-    // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
+  // Chain the retire task onto the leaf tasks as their completion indicates
+  // that all commands have completed. In a single layer DAG the root tasks are
+  // also the leaf tasks.
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i], retire_task);
   }
 
   // Enqueue all root tasks that are ready to run immediately.
@@ -380,7 +872,8 @@ iree_status_t iree_hal_task_command_buffer_issue(
   // we need to ensure the command buffer doesn't try to discard them.
   iree_task_submission_enqueue_list(pending_submission,
                                     &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
 
   return iree_ok_status();
 }
@@ -393,12 +886,39 @@ static void iree_hal_task_command_buffer_begin_debug_group(
     iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
     iree_hal_label_color_t label_color,
     const iree_hal_label_location_t* location) {
-  // TODO(benvanik): tracy event stack.
+  // Groups are resolved to interned locations while recording so that the
+  // commands executing within them only need to begin zones from pointers.
+  IREE_TRACE({
+    iree_hal_task_command_buffer_t* command_buffer =
+        iree_hal_task_command_buffer_cast(base_command_buffer);
+    iree_hal_task_cmd_debug_group_t* parent =
+        command_buffer->state.debug_group;
+    iree_hal_task_cmd_debug_group_t* group = NULL;
+    iree_status_t status = iree_arena_allocate(
+        &command_buffer->arena, sizeof(*group), (void**)&group);
+    if (iree_status_is_ok(status)) {
+      group->parent = parent;
+      group->depth = parent ? parent->depth + 1 : 1;
+      group->location = iree_hal_local_trace_location_intern_label(
+          label, label_color, location);
+      command_buffer->state.debug_group = group;
+    } else {
+      // Tracing is best-effort and the group is dropped.
+      iree_status_ignore(status);
+    }
+  });
 }
 
 static void iree_hal_task_command_buffer_end_debug_group(
     iree_hal_command_buffer_t* base_command_buffer) {
-  // TODO(benvanik): tracy event stack.
+  IREE_TRACE({
+    iree_hal_task_command_buffer_t* command_buffer =
+        iree_hal_task_command_buffer_cast(base_command_buffer);
+    if (command_buffer->state.debug_group) {
+      command_buffer->state.debug_group =
+          command_buffer->state.debug_group->parent;
+    }
+  });
 }
 
 //===----------------------------------------------------------------------===//
@@ -417,8 +937,8 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): actual DAG construction. Right now we are just doing simple
-  // global barriers each time and forcing a join-fork point.
+  // NOTE: stage masks and memory/buffer barriers are ignored: all memory
+  // accessed by commands is tracked and ordered regardless.
   return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
 
@@ -426,10 +946,36 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
 // iree_hal_command_buffer_signal_event
 //===----------------------------------------------------------------------===//
 
+// Removes |event| from the set of events signaled within the command buffer.
+static void iree_hal_task_command_buffer_forget_event(
+    iree_hal_task_command_buffer_t* command_buffer,
+    const iree_hal_event_t* event) {
+  iree_hal_task_cmd_event_t** event_ptr = &command_buffer->state.events;
+  while (*event_ptr) {
+    if ((*event_ptr)->event == event) {
+      *event_ptr = (*event_ptr)->next;
+      return;
+    }
+    event_ptr = &(*event_ptr)->next;
+  }
+}
+
 static iree_status_t iree_hal_task_command_buffer_signal_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+
+  // Events are only used to build the DAG and have no runtime representation:
+  // waiters are ordered after the commands recorded prior to the signal.
+  iree_hal_task_command_buffer_forget_event(command_buffer, event);
+  iree_hal_task_cmd_event_t* cmd_event = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*cmd_event), (void**)&cmd_event));
+  cmd_event->event = event;
+  cmd_event->sequence = command_buffer->state.node_count;
+  cmd_event->next = command_buffer->state.events;
+  command_buffer->state.events = cmd_event;
   return iree_ok_status();
 }
 
@@ -440,7 +986,9 @@ static iree_status_t iree_hal_task_command_buffer_signal_event(
 static iree_status_t iree_hal_task_command_buffer_reset_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  iree_hal_task_command_buffer_forget_event(command_buffer, event);
   return iree_ok_status();
 }
 
@@ -459,8 +1007,23 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  // TODO(#4518): implement events. For now we just insert global barriers.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+
+  // Order subsequent commands after those recorded prior to the latest signal
+  // of each event. Events not signaled within the command buffer can't be
+  // reasoned about and are treated as global barriers.
+  uint32_t event_sequence = command_buffer->state.event_sequence;
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    const iree_hal_task_cmd_event_t* cmd_event = command_buffer->state.events;
+    while (cmd_event && cmd_event->event != events[i]) {
+      cmd_event = cmd_event->next;
+    }
+    if (!cmd_event) {
+      return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+    }
+    event_sequence = iree_max(event_sequence, cmd_event->sequence);
+  }
+  command_buffer->state.event_sequence = event_sequence;
+  return iree_ok_status();
 }
 
 //===----------------------------------------------------------------------===//
@@ -475,14 +1038,41 @@ static iree_status_t iree_hal_task_command_buffer_discard_buffer(
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_fill_buffer
 //===----------------------------------------------------------------------===//
-// NOTE: for large copies we dispatch this as tiles for parallelism.
-// We'd want to do some measurement for when it's worth it; filling a 200KB
-// buffer: maybe not, filling a 200MB buffer: yeah. For now we just do
-// arbitrarily sized chunks.
+// NOTE: for large fills we dispatch this as tiles for parallelism. The tile
+// size is configured on the device and is a power of two so that each tile is
+// aligned to the pattern length.
+
+// Returns true if a fill or copy of |length| bytes should use non-temporal
+// stores.
+static bool iree_hal_task_command_buffer_use_nontemporal(
+    const iree_hal_task_command_buffer_t* command_buffer,
+    iree_device_size_t length) {
+  const iree_device_size_t threshold =
+      command_buffer->transfer_options.nontemporal_threshold;
+  return threshold != 0 && length >= threshold &&
+         iree_nontemporal_stores_supported();
+}
 
-// TODO(benvanik): make this a configurable setting. Must be aligned to pattern
-// length so pick a power of two.
-#define IREE_HAL_CMD_FILL_SLICE_LENGTH (128 * 1024)
+// Fills |length| bytes of |buffer| at |offset| using non-temporal stores.
+static iree_status_t iree_hal_cmd_fill_nontemporal(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  if (length == 0) return iree_ok_status();
+  iree_hal_buffer_mapping_t mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, offset, length, &mapping));
+  iree_nontemporal_fill(mapping.contents.data, mapping.contents.data_length,
+                        pattern, pattern_length);
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_flush_range(&mapping, 0,
+                                                 mapping.contents.data_length);
+  }
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+}
 
 typedef struct iree_hal_cmd_fill_buffer_t {
   iree_task_dispatch_t task;
@@ -491,6 +1081,9 @@ typedef struct iree_hal_cmd_fill_buffer_t {
   iree_device_size_t length;
   uint32_t pattern_length;
   uint8_t pattern[8];
+  // True if the fill uses non-temporal stores.
+  bool nontemporal;
+  IREE_TRACE(const iree_hal_task_cmd_debug_group_t* debug_group;)
 } iree_hal_cmd_fill_buffer_t;
 
 static iree_status_t iree_hal_cmd_fill_tile(
@@ -498,6 +1091,9 @@ static iree_status_t iree_hal_cmd_fill_tile(
     iree_task_submission_t* pending_submission) {
   const iree_hal_cmd_fill_buffer_t* cmd =
       (const iree_hal_cmd_fill_buffer_t*)user_context;
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_t debug_zones;)
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_begin(cmd->debug_group,
+                                                 &debug_zones));
   IREE_TRACE_ZONE_BEGIN(z0);
 
   uint32_t length_per_slice = tile_context->workgroup_size[0];
@@ -508,11 +1104,19 @@ static iree_status_t iree_hal_cmd_fill_tile(
       iree_min(length_per_slice, remaining_length);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (uint64_t)slice_length);
 
-  iree_status_t status = iree_hal_buffer_map_fill(
-      cmd->target_buffer, cmd->target_offset + slice_offset, slice_length,
-      cmd->pattern, cmd->pattern_length);
+  iree_status_t status = iree_ok_status();
+  if (cmd->nontemporal) {
+    status = iree_hal_cmd_fill_nontemporal(
+        cmd->target_buffer, cmd->target_offset + slice_offset, slice_length,
+        cmd->pattern, cmd->pattern_length);
+  } else {
+    status = iree_hal_buffer_map_fill(
+        cmd->target_buffer, cmd->target_offset + slice_offset, slice_length,
+        cmd->pattern, cmd->pattern_length);
+  }
 
   IREE_TRACE_ZONE_END(z0);
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_end(&debug_zones));
   return status;
 }
 
@@ -532,7 +1136,7 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
       iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
 
   const uint32_t workgroup_size[3] = {
-      /*x=*/IREE_HAL_CMD_FILL_SLICE_LENGTH,
+      /*x=*/(uint32_t)command_buffer->transfer_options.fill_tile_size,
       /*y=*/1,
       /*z=*/1,
   };
@@ -550,9 +1154,16 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   cmd->length = length;
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
-
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  cmd->nontemporal =
+      iree_hal_task_command_buffer_use_nontemporal(command_buffer, length);
+  IREE_TRACE(cmd->debug_group = command_buffer->state.debug_group);
+
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, &node));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -564,6 +1175,7 @@ typedef struct iree_hal_cmd_update_buffer_t {
   iree_hal_buffer_t* target_buffer;
   iree_device_size_t target_offset;
   iree_device_size_t length;
+  IREE_TRACE(const iree_hal_task_cmd_debug_group_t* debug_group;)
   uint8_t source_buffer[];
 } iree_hal_cmd_update_buffer_t;
 
@@ -572,10 +1184,14 @@ static iree_status_t iree_hal_cmd_update_buffer(
     iree_task_submission_t* pending_submission) {
   const iree_hal_cmd_update_buffer_t* cmd =
       (const iree_hal_cmd_update_buffer_t*)user_context;
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_t debug_zones;)
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_begin(cmd->debug_group,
+                                                 &debug_zones));
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_status_t status = iree_hal_buffer_map_write(
       cmd->target_buffer, cmd->target_offset, cmd->source_buffer, cmd->length);
   IREE_TRACE_ZONE_END(z0);
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_end(&debug_zones));
   return status;
 }
 
@@ -603,25 +1219,56 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
+  IREE_TRACE(cmd->debug_group = command_buffer->state.debug_group);
 
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, &node));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_copy_buffer
 //===----------------------------------------------------------------------===//
-// NOTE: for large copies we dispatch this as tiles for parallelism.
-// We'd want to do some measurement for when it's worth it; copying a 200KB
-// buffer: maybe not, copying a 200MB buffer: yeah. For now we just do
-// arbitrarily sized chunks.
+// NOTE: for large copies we dispatch this as tiles for parallelism. The tile
+// size is configured on the device.
 
-// TODO(benvanik): make this a configurable setting. Must be aligned to pattern
-// length so pick a power of two.
-#define IREE_HAL_CMD_COPY_SLICE_LENGTH (128 * 1024)
+// Copies |length| bytes from |source_buffer| at |source_offset| to
+// |target_buffer| at |target_offset| using non-temporal stores.
+static iree_status_t iree_hal_cmd_copy_nontemporal(
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+  iree_hal_buffer_mapping_t source_mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      source_buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+      source_offset, length, &source_mapping));
+  iree_hal_buffer_mapping_t target_mapping = {{0}};
+  iree_status_t status = iree_hal_buffer_map_range(
+      target_buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, target_offset, length,
+      &target_mapping);
+  if (iree_status_is_ok(status)) {
+    iree_nontemporal_copy(target_mapping.contents.data,
+                          source_mapping.contents.data,
+                          iree_min(source_mapping.contents.data_length,
+                                   target_mapping.contents.data_length));
+    if (!iree_all_bits_set(iree_hal_buffer_memory_type(target_buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+      status = iree_hal_buffer_mapping_flush_range(
+          &target_mapping, 0, target_mapping.contents.data_length);
+    }
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&target_mapping));
+  }
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&source_mapping));
+}
 
 typedef struct iree_hal_cmd_copy_buffer_t {
   iree_task_dispatch_t task;
@@ -630,6 +1277,9 @@ typedef struct iree_hal_cmd_copy_buffer_t {
   iree_hal_buffer_t* target_buffer;
   iree_device_size_t target_offset;
   iree_device_size_t length;
+  // True if the copy uses non-temporal stores.
+  bool nontemporal;
+  IREE_TRACE(const iree_hal_task_cmd_debug_group_t* debug_group;)
 } iree_hal_cmd_copy_buffer_t;
 
 static iree_status_t iree_hal_cmd_copy_tile(
@@ -637,6 +1287,9 @@ static iree_status_t iree_hal_cmd_copy_tile(
     iree_task_submission_t* pending_submission) {
   const iree_hal_cmd_copy_buffer_t* cmd =
       (const iree_hal_cmd_copy_buffer_t*)user_context;
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_t debug_zones;)
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_begin(cmd->debug_group,
+                                                 &debug_zones));
   IREE_TRACE_ZONE_BEGIN(z0);
 
   uint32_t length_per_slice = tile_context->workgroup_size[0];
@@ -647,11 +1300,19 @@ static iree_status_t iree_hal_cmd_copy_tile(
       iree_min(length_per_slice, remaining_length);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (uint64_t)slice_length);
 
-  iree_status_t status = iree_hal_buffer_map_copy(
-      cmd->source_buffer, cmd->source_offset + slice_offset, cmd->target_buffer,
-      cmd->target_offset + slice_offset, slice_length);
+  iree_status_t status = iree_ok_status();
+  if (cmd->nontemporal) {
+    status = iree_hal_cmd_copy_nontemporal(
+        cmd->source_buffer, cmd->source_offset + slice_offset,
+        cmd->target_buffer, cmd->target_offset + slice_offset, slice_length);
+  } else {
+    status = iree_hal_buffer_map_copy(
+        cmd->source_buffer, cmd->source_offset + slice_offset,
+        cmd->target_buffer, cmd->target_offset + slice_offset, slice_length);
+  }
 
   IREE_TRACE_ZONE_END(z0);
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_end(&debug_zones));
   return status;
 }
 
@@ -672,7 +1333,7 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
       iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
 
   const uint32_t workgroup_size[3] = {
-      /*x=*/IREE_HAL_CMD_COPY_SLICE_LENGTH,
+      /*x=*/(uint32_t)command_buffer->transfer_options.copy_tile_size,
       /*y=*/1,
       /*z=*/1,
   };
@@ -690,9 +1351,19 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
-
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  cmd->nontemporal =
+      iree_hal_task_command_buffer_use_nontemporal(command_buffer, length);
+  IREE_TRACE(cmd->debug_group = command_buffer->state.debug_group);
+
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, &node));
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, source_buffer, source_offset, length,
+      /*is_write=*/false));
+  return iree_hal_task_command_buffer_track_buffer_access(
+      command_buffer, node, target_buffer, target_offset, length,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -779,14 +1450,15 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
                               "buffer binding index out of bounds");
     }
     iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
-
-    // TODO(benvanik): batch insert by getting the resources in their own list.
-    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-        command_buffer->resource_set, 1, &bindings[i].buffer));
+    iree_hal_local_binding_mask_t binding_bit = 1ull << binding_ordinal;
 
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
+      // TODO(benvanik): batch insert by getting the resources in their own
+      // list.
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &bindings[i].buffer));
       IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
           bindings[i].buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
           IREE_HAL_MEMORY_ACCESS_ANY, bindings[i].offset, bindings[i].length,
@@ -795,10 +1467,30 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
           buffer_mapping.contents.data;
       command_buffer->state.binding_lengths[binding_ordinal] =
           buffer_mapping.contents.data_length;
+      command_buffer->state.slot_binding_mask &= ~binding_bit;
+    } else if (base_command_buffer->binding_capacity == 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding table slot %u referenced by a command "
+                              "buffer without a binding table",
+                              bindings[i].buffer_slot);
+    } else if (IREE_UNLIKELY(bindings[i].buffer_slot >=
+                             base_command_buffer->binding_capacity)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding table slot %u out of range (binding "
+                              "capacity is %u)",
+                              bindings[i].buffer_slot,
+                              base_command_buffer->binding_capacity);
     } else {
-      // TODO(#10144): stash indirect binding reference in the state table.
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "binding table lookup not yet supported");
+      // Resolved against the binding table each time the command buffer is
+      // executed.
+      command_buffer->state.bindings[binding_ordinal] = NULL;
+      command_buffer->state.binding_lengths[binding_ordinal] =
+          bindings[i].length;
+      command_buffer->state.binding_offsets[binding_ordinal] =
+          bindings[i].offset;
+      command_buffer->state.binding_slots[binding_ordinal] =
+          bindings[i].buffer_slot;
+      command_buffer->state.slot_binding_mask |= binding_bit;
     }
   }
 
@@ -814,6 +1506,9 @@ typedef struct iree_hal_cmd_dispatch_t {
   iree_hal_local_executable_t* executable;
   int32_t ordinal;
 
+  // Innermost debug group the dispatch was recorded in, if any.
+  IREE_TRACE(const iree_hal_task_cmd_debug_group_t* debug_group;)
+
   // Total number of available 4 byte push constant values in |push_constants|.
   uint16_t push_constant_count;
 
@@ -833,6 +1528,9 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
     iree_task_submission_t* pending_submission) {
   const iree_hal_cmd_dispatch_t* cmd =
       (const iree_hal_cmd_dispatch_t*)user_context;
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_t debug_zones;)
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_begin(cmd->debug_group,
+                                                 &debug_zones));
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // We could share this across all workgroups in a dispatch and reduce cache
@@ -870,11 +1568,30 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
           .local_memory = tile_context->local_memory.data,
           .local_memory_size = (size_t)tile_context->local_memory.data_length,
       };
+  iree_hal_local_profiler_sample_t profiler_sample;
+  const bool profiling =
+      iree_hal_local_profiler_sample_begin(&profiler_sample);
+
   iree_status_t status = iree_hal_local_executable_issue_call(
       cmd->executable, cmd->ordinal, &dispatch_state, &workgroup_state,
       tile_context->worker_id);
 
+  if (profiling) {
+    // Each workgroup is sampled on the worker executing it; the dispatch
+    // itself is counted once by whichever worker runs the first workgroup.
+    const bool is_first_workgroup = (workgroup_state.workgroup_id_x |
+                                     workgroup_state.workgroup_id_y |
+                                     workgroup_state.workgroup_id_z) == 0;
+    iree_hal_local_profiler_sample_end(
+        &profiler_sample, cmd->executable->id, cmd->ordinal,
+        cmd->executable->export_names
+            ? cmd->executable->export_names[cmd->ordinal]
+            : NULL,
+        /*dispatch_count=*/is_first_workgroup ? 1 : 0, /*workgroup_count=*/1);
+  }
+
   IREE_TRACE_ZONE_END(z0);
+  IREE_TRACE(iree_hal_task_cmd_debug_zones_end(&debug_zones));
   return status;
 }
 
@@ -882,12 +1599,13 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
     uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z,
-    iree_hal_cmd_dispatch_t** out_cmd) {
+    iree_hal_cmd_dispatch_t** out_cmd, iree_hal_task_cmd_node_t** out_node) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -899,6 +1617,8 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
           local_executable->pipeline_layouts[entry_point];
   iree_host_size_t push_constant_count = local_layout->push_constants;
   iree_hal_local_binding_mask_t used_binding_mask = local_layout->used_bindings;
+  iree_hal_local_binding_mask_t read_only_binding_mask =
+      local_layout->read_only_bindings;
   iree_host_size_t used_binding_count =
       iree_math_count_ones_u64(used_binding_mask);
 
@@ -921,6 +1641,7 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd->ordinal = entry_point;
   cmd->push_constant_count = push_constant_count;
   cmd->binding_count = used_binding_count;
+  IREE_TRACE(cmd->debug_group = command_buffer->state.debug_group);
 
   const uint32_t workgroup_count[3] = {workgroup_x, workgroup_y, workgroup_z};
   // TODO(benvanik): expose on API or keep fixed on executable.
@@ -958,23 +1679,59 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd_ptr += used_binding_count * sizeof(*binding_ptrs);
   size_t* binding_lengths = (size_t*)cmd_ptr;
   cmd_ptr += used_binding_count * sizeof(*binding_lengths);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, &node));
   iree_host_size_t binding_base = 0;
   for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
     int mask_offset = iree_math_count_trailing_zeros_u64(used_binding_mask);
     int binding_ordinal = binding_base + mask_offset;
     binding_base += mask_offset + 1;
     used_binding_mask = iree_shr(used_binding_mask, mask_offset + 1);
+    iree_hal_local_binding_mask_t binding_bit = 1ull << binding_ordinal;
+
+    // Bindings not declared read-only are conservatively assumed written.
+    const bool is_write =
+        !iree_all_bits_set(read_only_binding_mask, binding_bit);
+
+    if (iree_all_bits_set(command_buffer->state.slot_binding_mask,
+                          binding_bit)) {
+      // The binding is written when the command buffer is executed. Slots may
+      // alias any buffer and are tracked as accessing all memory.
+      binding_ptrs[i] = NULL;
+      binding_lengths[i] = 0;
+      iree_hal_task_cmd_slot_binding_t* slot_binding = NULL;
+      IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                               sizeof(*slot_binding),
+                                               (void**)&slot_binding));
+      slot_binding->binding_ptr = &binding_ptrs[i];
+      slot_binding->binding_length = &binding_lengths[i];
+      slot_binding->slot = command_buffer->state.binding_slots[binding_ordinal];
+      slot_binding->offset =
+          command_buffer->state.binding_offsets[binding_ordinal];
+      slot_binding->length =
+          command_buffer->state.binding_lengths[binding_ordinal];
+      slot_binding->next = command_buffer->slot_bindings;
+      command_buffer->slot_bindings = slot_binding;
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_all_access(
+          command_buffer, node, is_write));
+      continue;
+    }
+
     binding_ptrs[i] = command_buffer->state.bindings[binding_ordinal];
     binding_lengths[i] = command_buffer->state.binding_lengths[binding_ordinal];
     if (!binding_ptrs[i]) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "(flat) binding %d is NULL", binding_ordinal);
     }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_host_access(
+        command_buffer, node,
+        iree_make_byte_span(binding_ptrs[i], binding_lengths[i]), is_write));
   }
 
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  *out_node = node;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -986,9 +1743,10 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, 1, &executable));
   iree_hal_cmd_dispatch_t* cmd = NULL;
+  iree_hal_task_cmd_node_t* node = NULL;
   return iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_x, workgroup_y,
-      workgroup_z, &cmd);
+      workgroup_z, &cmd, &node);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
@@ -1011,31 +1769,199 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
       &buffer_mapping));
 
   iree_hal_cmd_dispatch_t* cmd = NULL;
+  iree_hal_task_cmd_node_t* node = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dispatch(
-      base_command_buffer, executable, entry_point, 0, 0, 0, &cmd));
+      base_command_buffer, executable, entry_point, 0, 0, 0, &cmd, &node));
   cmd->task.workgroup_count.ptr = (const uint32_t*)buffer_mapping.contents.data;
   cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
-  return iree_ok_status();
+  return iree_hal_task_command_buffer_track_host_access(
+      command_buffer, node, buffer_mapping.contents, /*is_write=*/false);
 }
 
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_execute_commands
 //===----------------------------------------------------------------------===//
 
+// Executes an indirect command buffer with a binding table. When executed the
+// call task resolves the slot bindings of the command buffer against the table,
+// resets its tasks and nests them under itself such that the call only
+// completes once they all have.
+typedef struct iree_hal_cmd_execute_commands_t {
+  iree_task_call_t task;
+  iree_hal_task_command_buffer_t* commands;
+
+  // True once the tasks of |commands| have been issued. The call task is
+  // executed again once they complete and this is reset by its cleanup.
+  bool is_issued;
+
+  // Mapped contents of each binding table slot or empty if a slot has no
+  // buffer bound.
+  iree_host_size_t binding_count;
+  iree_byte_span_t* bindings;
+} iree_hal_cmd_execute_commands_t;
+
+static iree_status_t iree_hal_cmd_execute_commands(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_hal_cmd_execute_commands_t* cmd =
+      (iree_hal_cmd_execute_commands_t*)user_context;
+  iree_hal_task_command_buffer_t* commands = cmd->commands;
+  if (cmd->is_issued || commands->task_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_command_buffer_begin_issue(commands));
+
+  // Slot ranges were validated against the binding table when recorded.
+  for (iree_hal_task_cmd_slot_binding_t* slot_binding =
+           commands->slot_bindings;
+       slot_binding; slot_binding = slot_binding->next) {
+    iree_byte_span_t binding = cmd->bindings[slot_binding->slot];
+    *slot_binding->binding_ptr = binding.data + slot_binding->offset;
+    *slot_binding->binding_length =
+        slot_binding->length == IREE_WHOLE_BUFFER
+            ? (size_t)(binding.data_length - slot_binding->offset)
+            : (size_t)slot_binding->length;
+  }
+
+  // Chaining the exit barrier of the nested tasks to the call adds a
+  // dependency such that the call only retires once they have all completed.
+  cmd->is_issued = true;
+  iree_hal_task_command_buffer_rearm(commands, task, pending_submission);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_cmd_execute_commands_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_cmd_execute_commands_t* cmd = (iree_hal_cmd_execute_commands_t*)task;
+  cmd->is_issued = false;
+}
+
+// Verifies that all slot bindings of |commands| are within the ranges bound in
+// |cmd|.
+static iree_status_t iree_hal_cmd_execute_commands_verify_bindings(
+    const iree_hal_cmd_execute_commands_t* cmd,
+    const iree_hal_task_command_buffer_t* commands) {
+  for (const iree_hal_task_cmd_slot_binding_t* slot_binding =
+           commands->slot_bindings;
+       slot_binding; slot_binding = slot_binding->next) {
+    if (IREE_UNLIKELY(slot_binding->slot >= cmd->binding_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding table slot %u out of range (table has "
+                              "%" PRIhsz " bindings)",
+                              slot_binding->slot, cmd->binding_count);
+    }
+    const iree_byte_span_t binding = cmd->bindings[slot_binding->slot];
+    if (IREE_UNLIKELY(!binding.data)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding table slot %u has no buffer bound",
+                              slot_binding->slot);
+    }
+    if (IREE_UNLIKELY(
+            slot_binding->offset > binding.data_length ||
+            (slot_binding->length != IREE_WHOLE_BUFFER &&
+             slot_binding->length >
+                 binding.data_length - slot_binding->offset))) {
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "binding range (offset=%" PRIdsz ", length=%" PRIdsz
+          ") exceeds binding table slot %u length %" PRIhsz,
+          slot_binding->offset, slot_binding->length, slot_binding->slot,
+          binding.data_length);
+    }
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): support indirect command buffers by using deferred command
-  // buffers or caching the task topology (probably not worth the tracking).
-  // If we could separate the topology that referenced the binding table we'd
-  // be able to reissue but not concurrently (as each task can only be in flight
-  // as a singleton) - which may be enough in many cases but adds complexity to
-  // tracking as we'd need to either enforce serialization of subsequent
-  // submissions or copy-on-write-style clone the topology for each additional
-  // concurrent submission.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  if (!iree_hal_task_command_buffer_isa(base_commands) ||
+      base_commands->binding_capacity == 0) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "only indirect command buffers created with a binding capacity can be "
+        "executed as nested command buffers");
+  }
+  iree_hal_task_command_buffer_t* commands =
+      iree_hal_task_command_buffer_cast(base_commands);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
+                                       &base_commands));
+
+  iree_hal_cmd_execute_commands_t* cmd = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(&command_buffer->arena,
+                              sizeof(*cmd) + binding_table.count *
+                                                 sizeof(*cmd->bindings),
+                              (void**)&cmd));
+  iree_task_call_initialize(
+      command_buffer->scope,
+      iree_task_make_call_closure(iree_hal_cmd_execute_commands, (void*)cmd),
+      &cmd->task);
+  iree_task_set_cleanup_fn(&cmd->task.header,
+                           iree_hal_cmd_execute_commands_cleanup);
+  cmd->commands = commands;
+  cmd->is_issued = false;
+  cmd->binding_count = binding_table.count;
+  cmd->bindings = (iree_byte_span_t*)((uint8_t*)cmd + sizeof(*cmd));
+
+  // Buffers are mapped now such that executing only needs to patch pointers.
+  // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
+  for (iree_host_size_t i = 0; i < binding_table.count; ++i) {
+    const iree_hal_buffer_binding_t* binding = &binding_table.bindings[i];
+    cmd->bindings[i] = iree_make_byte_span(NULL, 0);
+    if (!binding->buffer) continue;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
+                                         &binding->buffer));
+    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_buffer_map_range(
+                binding->buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+                IREE_HAL_MEMORY_ACCESS_ANY, binding->offset, binding->length,
+                &buffer_mapping));
+    cmd->bindings[i] = buffer_mapping.contents;
+  }
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cmd_execute_commands_verify_bindings(cmd, commands));
+
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_command_buffer_emit_execution_task(
+              command_buffer, &cmd->task.header, &node));
+
+  // There is only a single copy of the nested tasks so executions of the same
+  // command buffer are ordered even within a synchronization scope.
+  iree_hal_task_cmd_execution_t* execution = command_buffer->state.executions;
+  while (execution && execution->commands != base_commands) {
+    execution = execution->next;
+  }
+  if (execution) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_task_command_buffer_add_edge(command_buffer,
+                                                  execution->node, node));
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena, sizeof(*execution),
+                                (void**)&execution));
+    execution->commands = base_commands;
+    execution->next = command_buffer->state.executions;
+    command_buffer->state.executions = execution;
+  }
+  execution->node = node;
+
+  // Nested commands may access any memory.
+  iree_status_t status = iree_hal_task_command_buffer_track_all_access(
+      command_buffer, node, /*is_write=*/true);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 //===----------------------------------------------------------------------===//
@@ -18,11 +18,35 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Options controlling how transfer commands are executed.
+// See iree_hal_task_device_params_t for details.
+typedef struct iree_hal_task_transfer_options_t {
+  // Size in bytes of each tile of a fill command. Must be a power of two.
+  iree_device_size_t fill_tile_size;
+  // Size in bytes of each tile of a copy command. Must be a power of two.
+  iree_device_size_t copy_tile_size;
+  // Minimum size in bytes of a fill or copy that uses non-temporal stores or 0
+  // to disable them.
+  iree_device_size_t nontemporal_threshold;
+} iree_hal_task_transfer_options_t;
+
+// Creates a command buffer that records commands directly into a task DAG.
+// One-shot command buffers transfer their tasks to the executor when issued.
+// Command buffers without IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT retain their
+// tasks and reset them each time they are issued without reallocating them.
+// Executions of a reusable command buffer must not overlap and submissions of
+// it must be ordered with semaphores.
+//
+// Command buffers with a nonzero |binding_capacity| are indirect and reusable.
+// They may reference binding table slots and are executed with a binding table
+// via iree_hal_command_buffer_execute_commands, which resolves the slots and
+// re-arms the same tasks each time.
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_device_t* device, iree_task_scope_t* scope,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    const iree_hal_task_transfer_options_t* transfer_options,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
@@ -46,6 +70,11 @@ bool iree_hal_task_command_buffer_isa(
 //
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
+//
+// Returns IREE_STATUS_FAILED_PRECONDITION if a reusable command buffer is
+// issued while a prior issue of it has not yet retired and
+// IREE_STATUS_INVALID_ARGUMENT if the command buffer references binding table
+// slots.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -0,0 +1,367 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+//==============================================================================
+// Command DAG concurrency
+//==============================================================================
+// Measures how well the commands in a command buffer are spread across workers.
+// Each command fills a buffer small enough to execute as a single tile such
+// that any concurrency comes from the command DAG and not from tiling. Commands
+// are separated by execution barriers as is common in compiler-generated
+// command buffers. Independent commands each fill their own buffer and may
+// execute concurrently while dependent commands all fill the same buffer and
+// must execute in order.
+//
+// Reports the average fraction of workers busy during each submission as
+// "utilization": the process CPU time over the wall time of all workers.
+
+constexpr iree_device_size_t kFillLength = 64 * 1024;
+
+void BM_CommandDAG(benchmark::State& state) {
+  const iree_host_size_t worker_count = (iree_host_size_t)state.range(0);
+  const iree_host_size_t command_count = (iree_host_size_t)state.range(1);
+  const bool independent = state.range(2) != 0;
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(
+      options, &topology, iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("benchmark"), iree_allocator_system(),
+      iree_allocator_system(), &device_allocator));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  iree_hal_device_t* device = NULL;
+  IREE_CHECK_OK(iree_hal_task_device_create(
+      iree_make_cstring_view("benchmark"), &params, /*queue_count=*/1,
+      &executor, /*loader_count=*/0, /*loaders=*/NULL, device_allocator,
+      iree_allocator_system(), &device));
+
+  std::vector<iree_hal_buffer_t*> buffers(independent ? command_count : 1);
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  for (auto& buffer : buffers) {
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator, buffer_params, kFillLength, &buffer));
+  }
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  uint64_t semaphore_value = 0ull;
+
+  double cpu_seconds = 0.0;
+  double wall_seconds = 0.0;
+  for (auto _ : state) {
+    auto wall_start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start = std::clock();
+
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_CHECK_OK(iree_hal_command_buffer_create(
+        device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+    for (iree_host_size_t i = 0; i < command_count; ++i) {
+      const uint32_t pattern = (uint32_t)i;
+      IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+          command_buffer, buffers[independent ? i : 0], 0, kFillLength,
+          &pattern, sizeof(pattern)));
+      IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+          command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+          IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+          IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+    }
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+
+    ++semaphore_value;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        /*count=*/1,
+        /*semaphores=*/&semaphore,
+        /*payload_values=*/&semaphore_value,
+    };
+    IREE_CHECK_OK(iree_hal_device_queue_execute(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, semaphore_value,
+                                          iree_infinite_timeout()));
+    iree_hal_command_buffer_release(command_buffer);
+
+    cpu_seconds += (double)(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    wall_seconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - wall_start)
+                        .count();
+  }
+  state.SetItemsProcessed(state.iterations() * command_count);
+  state.counters["utilization"] =
+      wall_seconds > 0.0 ? cpu_seconds / (wall_seconds * worker_count) : 0.0;
+
+  iree_hal_semaphore_release(semaphore);
+  for (auto* buffer : buffers) iree_hal_buffer_release(buffer);
+  iree_hal_device_release(device);
+  iree_hal_allocator_release(device_allocator);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_CommandDAG)
+    ->ArgNames({"workers", "commands", "independent"})
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int64_t worker_count = 1;
+           worker_count <= 32 &&
+           worker_count <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT;
+           worker_count *= 2) {
+        for (int64_t command_count : {16, 128}) {
+          b->Args({worker_count, command_count, 0});
+          b->Args({worker_count, command_count, 1});
+        }
+      }
+    })
+    ->MeasureProcessCPUTime()
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+//==============================================================================
+// Submission overhead
+//==============================================================================
+// Measures the host overhead of submitting a command buffer of 100 commands.
+// Each command fills a tiny buffer such that execution is negligible compared
+// to the cost of building and issuing the task DAG. One-shot command buffers
+// are recorded for each submission while reusable command buffers are recorded
+// once and their tasks are reset and issued again on each submission.
+
+constexpr iree_host_size_t kSubmitCommandCount = 100;
+constexpr iree_device_size_t kSubmitFillLength = 64;
+
+// Records |buffers.size()| fills separated by execution barriers.
+iree_hal_command_buffer_t* RecordSubmitCommandBuffer(
+    iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
+    const std::vector<iree_hal_buffer_t*>& buffers) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_CHECK_OK(iree_hal_command_buffer_create(
+      device, mode, IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+  IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+  for (iree_host_size_t i = 0; i < buffers.size(); ++i) {
+    const uint32_t pattern = (uint32_t)i;
+    IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffers[i], 0, kSubmitFillLength, &pattern,
+        sizeof(pattern)));
+    IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  }
+  IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+  return command_buffer;
+}
+
+void BM_CommandBufferSubmit(benchmark::State& state) {
+  const bool reusable = state.range(0) != 0;
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(
+      options, &topology, iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("benchmark"), iree_allocator_system(),
+      iree_allocator_system(), &device_allocator));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  iree_hal_device_t* device = NULL;
+  IREE_CHECK_OK(iree_hal_task_device_create(
+      iree_make_cstring_view("benchmark"), &params, /*queue_count=*/1,
+      &executor, /*loader_count=*/0, /*loaders=*/NULL, device_allocator,
+      iree_allocator_system(), &device));
+
+  std::vector<iree_hal_buffer_t*> buffers(kSubmitCommandCount);
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  for (auto& buffer : buffers) {
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator, buffer_params, kSubmitFillLength, &buffer));
+  }
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  uint64_t semaphore_value = 0ull;
+
+  iree_hal_command_buffer_t* reusable_command_buffer =
+      reusable ? RecordSubmitCommandBuffer(device, /*mode=*/0, buffers) : NULL;
+  for (auto _ : state) {
+    iree_hal_command_buffer_t* command_buffer = reusable_command_buffer;
+    if (!command_buffer) {
+      command_buffer = RecordSubmitCommandBuffer(
+          device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT, buffers);
+    }
+
+    ++semaphore_value;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        /*count=*/1,
+        /*semaphores=*/&semaphore,
+        /*payload_values=*/&semaphore_value,
+    };
+    IREE_CHECK_OK(iree_hal_device_queue_execute(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, semaphore_value,
+                                          iree_infinite_timeout()));
+
+    if (command_buffer != reusable_command_buffer) {
+      iree_hal_command_buffer_release(command_buffer);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kSubmitCommandCount);
+
+  iree_hal_command_buffer_release(reusable_command_buffer);
+  iree_hal_semaphore_release(semaphore);
+  for (auto* buffer : buffers) iree_hal_buffer_release(buffer);
+  iree_hal_device_release(device);
+  iree_hal_allocator_release(device_allocator);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_CommandBufferSubmit)
+    ->ArgNames({"reusable"})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+//==============================================================================
+// Large transfers
+//==============================================================================
+// Measures fills and copies of large buffers tiled across workers with either
+// regular or non-temporal stores. Used to pick the default tile sizes and the
+// non-temporal threshold of the device: regular stores win while the transfer
+// fits in the caches and non-temporal stores win once it would evict the
+// working set anyway.
+
+void BM_CommandBufferTransfer(benchmark::State& state) {
+  const iree_host_size_t worker_count = (iree_host_size_t)state.range(0);
+  const iree_device_size_t length = (iree_device_size_t)state.range(1);
+  const bool copy = state.range(2) != 0;
+  const bool nontemporal = state.range(3) != 0;
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(
+      options, &topology, iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("benchmark"), iree_allocator_system(),
+      iree_allocator_system(), &device_allocator));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.nontemporal_transfer_threshold = nontemporal ? 1 : 0;
+  iree_hal_device_t* device = NULL;
+  IREE_CHECK_OK(iree_hal_task_device_create(
+      iree_make_cstring_view("benchmark"), &params, /*queue_count=*/1,
+      &executor, /*loader_count=*/0, /*loaders=*/NULL, device_allocator,
+      iree_allocator_system(), &device));
+
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  iree_hal_buffer_t* source_buffer = NULL;
+  iree_hal_buffer_t* target_buffer = NULL;
+  if (copy) {
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator, buffer_params, length, &source_buffer));
+  }
+  IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator, buffer_params, length, &target_buffer));
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  uint64_t semaphore_value = 0ull;
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_CHECK_OK(iree_hal_command_buffer_create(
+      device, /*mode=*/0, IREE_HAL_COMMAND_CATEGORY_ANY,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &command_buffer));
+  IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+  if (copy) {
+    IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+        command_buffer, source_buffer, 0, target_buffer, 0, length));
+  } else {
+    const uint32_t pattern = 0xCDCDCDCDu;
+    IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, target_buffer, 0, length, &pattern, sizeof(pattern)));
+  }
+  IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+
+  for (auto _ : state) {
+    ++semaphore_value;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        /*count=*/1,
+        /*semaphores=*/&semaphore,
+        /*payload_values=*/&semaphore_value,
+    };
+    IREE_CHECK_OK(iree_hal_device_queue_execute(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, semaphore_value,
+                                          iree_infinite_timeout()));
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t)length);
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+  iree_hal_device_release(device);
+  iree_hal_allocator_release(device_allocator);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_CommandBufferTransfer)
+    ->ArgNames({"workers", "bytes", "copy", "nontemporal"})
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int64_t worker_count = 1;
+           worker_count <= 32 &&
+           worker_count <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT;
+           worker_count *= 4) {
+        for (int64_t length : {1ll << 20, 16ll << 20, 256ll << 20, 1ll << 30}) {
+          for (int64_t copy : {0, 1}) {
+            b->Args({worker_count, length, copy, 0});
+            b->Args({worker_count, length, copy, 1});
+          }
+        }
+      }
+    })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,438 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_command_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/executor.h"
+#include "iree/task/submission.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Tile size of fills and copies. Each command is identified in the issued DAG
+// by its tile count by making the length of each command unique.
+constexpr iree_device_size_t kTileSize = 16;
+
+// Size of the buffers used by tests. Large enough for all command ids.
+constexpr iree_device_size_t kBufferSize = 1024 * 1024;
+
+// Returns the byte length of the command with |id|.
+static iree_device_size_t CommandLength(uint32_t id) { return id * kTileSize; }
+
+class TaskCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/4,
+                                                   &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                             host_allocator, &executor_));
+    iree_task_topology_deinitialize(&topology);
+
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), host_allocator, host_allocator,
+        &device_allocator_));
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("test"), &params, /*queue_count=*/1,
+        &executor_, /*loader_count=*/0, /*loaders=*/NULL, device_allocator_,
+        host_allocator, &device_));
+
+    iree_task_scope_initialize(iree_make_cstring_view("test"), &scope_);
+    iree_arena_block_pool_initialize(32 * 1024, host_allocator, &block_pool_);
+  }
+
+  void TearDown() override {
+    iree_arena_block_pool_deinitialize(&block_pool_);
+    iree_task_scope_deinitialize(&scope_);
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release(device_allocator_);
+    iree_task_executor_release(executor_);
+  }
+
+  iree_hal_buffer_t* CreateBuffer() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     kBufferSize, &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_zero(buffer, 0, IREE_WHOLE_BUFFER));
+    return buffer;
+  }
+
+  // Returns a buffer wrapping the caller-owned host memory |storage|.
+  iree_hal_buffer_t* ImportBuffer(std::vector<uint8_t>& storage) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_external_buffer_t external_buffer;
+    memset(&external_buffer, 0, sizeof(external_buffer));
+    external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+    external_buffer.size = storage.size();
+    external_buffer.handle.host_allocation.ptr = storage.data();
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_import_buffer(
+        device_allocator_, params, &external_buffer,
+        iree_hal_buffer_release_callback_null(), &buffer));
+    return buffer;
+  }
+
+  iree_hal_command_buffer_t* CreateCommandBuffer() {
+    iree_hal_task_transfer_options_t transfer_options;
+    memset(&transfer_options, 0, sizeof(transfer_options));
+    transfer_options.fill_tile_size = kTileSize;
+    transfer_options.copy_tile_size = kTileSize;
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_CHECK_OK(iree_hal_task_command_buffer_create(
+        device_, &scope_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &transfer_options, &block_pool_,
+        iree_allocator_system(), &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+    return command_buffer;
+  }
+
+  // Records a fill of |value| into |buffer| at |offset| identified by |id|.
+  void Fill(iree_hal_command_buffer_t* command_buffer, uint32_t id,
+            iree_hal_buffer_t* buffer, iree_device_size_t offset,
+            uint8_t value) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffer, offset, CommandLength(id), &value,
+        sizeof(value)));
+  }
+
+  // Records a copy from |source| to |target| identified by |id|.
+  void Copy(iree_hal_command_buffer_t* command_buffer, uint32_t id,
+            iree_hal_buffer_t* source, iree_device_size_t source_offset,
+            iree_hal_buffer_t* target, iree_device_size_t target_offset) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+        command_buffer, source, source_offset, target, target_offset,
+        CommandLength(id)));
+  }
+
+  void Barrier(iree_hal_command_buffer_t* command_buffer) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  }
+
+  // Ends recording and issues |command_buffer| into a pending submission,
+  // capturing the edges of the resulting task DAG. Commands are not executed
+  // until Execute is called.
+  void Issue(iree_hal_command_buffer_t* command_buffer) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+    iree_task_fence_initialize(&scope_, iree_wait_primitive_immediate(),
+                               &retire_task_);
+    iree_task_submission_initialize(&submission_);
+    iree_hal_task_queue_state_t queue_state;
+    iree_hal_task_queue_state_initialize(&queue_state);
+    iree_arena_allocator_t arena;
+    iree_arena_initialize(&block_pool_, &arena);
+    IREE_ASSERT_OK(iree_hal_task_command_buffer_issue(
+        command_buffer, &queue_state, &retire_task_.header, &arena,
+        &submission_));
+    iree_arena_deinitialize(&arena);
+    iree_hal_task_queue_state_deinitialize(&queue_state);
+
+    tasks_.clear();
+    std::vector<iree_task_t*> worklist;
+    for (iree_task_t* task = submission_.ready_list.head; task;
+         task = task->next_task) {
+      worklist.push_back(task);
+    }
+    std::unordered_set<iree_task_t*> visited;
+    while (!worklist.empty()) {
+      iree_task_t* task = worklist.back();
+      worklist.pop_back();
+      if (!visited.insert(task).second) continue;
+      tasks_.push_back(task);
+      for (iree_task_t* successor : Successors(task)) {
+        worklist.push_back(successor);
+      }
+    }
+  }
+
+  // Executes the issued commands and waits for them to complete.
+  void Execute() {
+    iree_task_executor_submit(executor_, &submission_);
+    iree_task_executor_flush(executor_);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope_, IREE_TIME_INFINITE_FUTURE));
+    IREE_ASSERT_OK(iree_task_scope_consume_status(&scope_));
+  }
+
+  // Discards the issued commands without executing them.
+  void Discard() { iree_task_submission_discard(&submission_); }
+
+  // Returns the tasks notified when |task| completes.
+  static std::vector<iree_task_t*> Successors(iree_task_t* task) {
+    std::vector<iree_task_t*> successors;
+    if (task->completion_task) successors.push_back(task->completion_task);
+    if (task->type == IREE_TASK_TYPE_BARRIER) {
+      iree_task_barrier_t* barrier = (iree_task_barrier_t*)task;
+      successors.insert(
+          successors.end(), barrier->dependent_tasks,
+          barrier->dependent_tasks + barrier->dependent_task_count);
+    }
+    return successors;
+  }
+
+  // Returns the issued task of the fill or copy command identified by |id|.
+  iree_task_t* CommandTask(uint32_t id) {
+    iree_task_t* found_task = NULL;
+    for (iree_task_t* task : tasks_) {
+      if (task->type != IREE_TASK_TYPE_DISPATCH) continue;
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      if (dispatch_task->workgroup_count.value[0] == id + 1) {
+        EXPECT_EQ(found_task, nullptr) << "command ids must be unique";
+        found_task = task;
+      }
+    }
+    EXPECT_NE(found_task, nullptr) << "command " << id << " not issued";
+    return found_task;
+  }
+
+  // Returns true if the command identified by |after| is ordered after the
+  // command identified by |before|.
+  bool IsOrderedAfter(uint32_t before, uint32_t after) {
+    iree_task_t* before_task = CommandTask(before);
+    iree_task_t* after_task = CommandTask(after);
+    if (!before_task || !after_task) return false;
+    std::vector<iree_task_t*> worklist = Successors(before_task);
+    std::unordered_set<iree_task_t*> visited;
+    while (!worklist.empty()) {
+      iree_task_t* task = worklist.back();
+      worklist.pop_back();
+      if (task == after_task) return true;
+      if (!visited.insert(task).second) continue;
+      for (iree_task_t* successor : Successors(task)) {
+        worklist.push_back(successor);
+      }
+    }
+    return false;
+  }
+
+  // Returns true if the commands identified by |a| and |b| may execute
+  // concurrently.
+  bool IsConcurrent(uint32_t a, uint32_t b) {
+    return !IsOrderedAfter(a, b) && !IsOrderedAfter(b, a);
+  }
+
+  // Returns the byte of |buffer| at |offset|.
+  static uint8_t ReadByte(iree_hal_buffer_t* buffer,
+                          iree_device_size_t offset) {
+    uint8_t value = 0;
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, offset, &value, sizeof(value)));
+    return value;
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  iree_task_scope_t scope_;
+  iree_arena_block_pool_t block_pool_;
+
+  // Retires each issue such that the scope is idle once all commands complete.
+  iree_task_fence_t retire_task_;
+  iree_task_submission_t submission_;
+  std::vector<iree_task_t*> tasks_;
+};
+
+// Reads of memory written by a command in a prior scope wait on the write.
+TEST_F(TaskCommandBufferTest, ReadAfterWrite) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_buffer_t* b = CreateBuffer();
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Fill(command_buffer, 1, a, 0, 0xAB);
+  Barrier(command_buffer);
+  Copy(command_buffer, 2, a, 0, b, 0);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, 2));
+
+  Execute();
+  EXPECT_EQ(ReadByte(b, 0), 0xAB);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+// Writes of memory read by a command in a prior scope wait on the read.
+TEST_F(TaskCommandBufferTest, WriteAfterRead) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_buffer_t* b = CreateBuffer();
+  uint8_t initial_value = 0x11;
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(a, 0, IREE_WHOLE_BUFFER,
+                                          &initial_value, 1));
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Copy(command_buffer, 1, a, 0, b, 0);
+  Barrier(command_buffer);
+  Fill(command_buffer, 2, a, 0, 0x22);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, 2));
+
+  Execute();
+  EXPECT_EQ(ReadByte(b, 0), 0x11);
+  EXPECT_EQ(ReadByte(a, 0), 0x22);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+// Overlapping writes from different scopes are ordered.
+TEST_F(TaskCommandBufferTest, WriteAfterWrite) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Fill(command_buffer, 1, a, 0, 0x11);
+  Barrier(command_buffer);
+  Fill(command_buffer, 2, a, 0, 0x22);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, 2));
+
+  Execute();
+  EXPECT_EQ(ReadByte(a, 0), 0x22);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(a);
+}
+
+// Distinct buffers wrapping the same host memory alias and are ordered.
+TEST_F(TaskCommandBufferTest, WrappedBuffersAlias) {
+  std::vector<uint8_t> storage(kBufferSize);
+  iree_hal_buffer_t* a = ImportBuffer(storage);
+  iree_hal_buffer_t* b = ImportBuffer(storage);
+  iree_hal_buffer_t* c = CreateBuffer();
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Fill(command_buffer, 1, a, 0, 0xAB);
+  Barrier(command_buffer);
+  Copy(command_buffer, 2, b, 0, c, 0);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, 2));
+
+  Execute();
+  EXPECT_EQ(ReadByte(c, 0), 0xAB);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(c);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+// Commands accessing disjoint memory are not ordered across barriers and
+// commands within the same scope are never ordered.
+TEST_F(TaskCommandBufferTest, IndependentCommandsAreConcurrent) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_buffer_t* b = CreateBuffer();
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Fill(command_buffer, 1, a, 0, 0x11);
+  Fill(command_buffer, 2, b, 0, 0x22);
+  Barrier(command_buffer);
+  Fill(command_buffer, 3, a, kBufferSize / 2, 0x33);
+  Copy(command_buffer, 4, b, kBufferSize / 2, b, kBufferSize / 4);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsConcurrent(1, 2));
+  EXPECT_TRUE(IsConcurrent(1, 3));
+  EXPECT_TRUE(IsConcurrent(2, 3));
+  EXPECT_TRUE(IsConcurrent(1, 4));
+  EXPECT_TRUE(IsConcurrent(2, 4));
+  EXPECT_TRUE(IsConcurrent(3, 4));
+
+  Execute();
+  EXPECT_EQ(ReadByte(a, 0), 0x11);
+  EXPECT_EQ(ReadByte(b, 0), 0x22);
+  EXPECT_EQ(ReadByte(a, kBufferSize / 2), 0x33);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+// Commands after an event wait are ordered after the commands recorded prior
+// to the signal of the event but not after those recorded after it. The
+// commands are discarded as the unordered ones race by design.
+TEST_F(TaskCommandBufferTest, EventWait) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_buffer_t* b = CreateBuffer();
+  iree_hal_event_t* event = NULL;
+  IREE_ASSERT_OK(iree_hal_event_create(device_, &event));
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  Fill(command_buffer, 1, a, 0, 0x11);
+  IREE_ASSERT_OK(iree_hal_command_buffer_signal_event(
+      command_buffer, event, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE));
+  Fill(command_buffer, 2, a, kBufferSize / 2, 0x22);
+  const iree_hal_event_t* events[1] = {event};
+  IREE_ASSERT_OK(iree_hal_command_buffer_wait_events(
+      command_buffer, IREE_ARRAYSIZE(events), events,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE, 0, NULL, 0, NULL));
+  Copy(command_buffer, 3, a, 0, b, 0);
+  Copy(command_buffer, 4, a, kBufferSize / 2, b, kBufferSize / 2);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, 3));
+  EXPECT_TRUE(IsConcurrent(1, 2));
+  EXPECT_TRUE(IsConcurrent(2, 4));
+
+  Discard();
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_event_release(event);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+// Scopes with more commands than are tracked are joined and subsequent
+// commands remain ordered after any they conflict with.
+TEST_F(TaskCommandBufferTest, ManyCommandsInOneScope) {
+  iree_hal_buffer_t* a = CreateBuffer();
+  iree_hal_buffer_t* b = CreateBuffer();
+  iree_hal_command_buffer_t* command_buffer = CreateCommandBuffer();
+  constexpr uint32_t kCommandCount = 300;
+  iree_device_size_t offset = 0;
+  iree_device_size_t last_offset = 0;
+  for (uint32_t id = 1; id <= kCommandCount; ++id) {
+    Fill(command_buffer, id, a, offset, (uint8_t)id);
+    last_offset = offset;
+    offset += CommandLength(id);
+  }
+  Barrier(command_buffer);
+  Copy(command_buffer, kCommandCount + 1, a, 0, b, 0);
+  Copy(command_buffer, kCommandCount + 2, a, last_offset, b, kBufferSize / 2);
+  Issue(command_buffer);
+
+  EXPECT_TRUE(IsOrderedAfter(1, kCommandCount + 1));
+  EXPECT_TRUE(IsOrderedAfter(kCommandCount, kCommandCount + 2));
+
+  Execute();
+  EXPECT_EQ(ReadByte(b, 0), 1);
+  EXPECT_EQ(ReadByte(b, kBufferSize / 2), (uint8_t)kCommandCount);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(b);
+  iree_hal_buffer_release(a);
+}
+
+}  // namespace
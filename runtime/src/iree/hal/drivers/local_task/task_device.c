@@ -19,10 +19,15 @@
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiler.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/file_transfer.h"
 #include "iree/hal/utils/memory_file.h"
 
+// Maximum fill and copy tile size in bytes. Tiles are dispatched as workgroups
+// with a 32-bit size and must not truncate.
+#define IREE_HAL_TASK_DEVICE_MAX_TILE_SIZE (1ull << 31)
+
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
   iree_string_view_t identifier;
@@ -43,6 +48,16 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Chunking of queue file transfers; see iree_hal_task_device_params_t.
+  iree_host_size_t file_transfer_chunk_count;
+  iree_device_size_t file_transfer_chunk_size;
+
+  // Tiling of command buffer transfers; see iree_hal_task_device_params_t.
+  iree_hal_task_transfer_options_t transfer_options;
+
+  // Scope of executable loads scheduled by executable caches.
+  iree_task_scope_t executable_scope;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -58,6 +73,14 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->queue_pool_slab_size = 4 * 1024 * 1024;
+  out_params->file_transfer_chunk_count =
+      IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT;
+  out_params->file_transfer_chunk_size =
+      IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT;
+  out_params->fill_tile_size = 128 * 1024;
+  out_params->copy_tile_size = 128 * 1024;
+  out_params->nontemporal_transfer_threshold = 32 * 1024 * 1024;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -66,6 +89,16 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "arena block size too small (< 4096 bytes)");
   }
+  if (params->fill_tile_size < 64 ||
+      params->fill_tile_size > IREE_HAL_TASK_DEVICE_MAX_TILE_SIZE ||
+      !iree_device_size_is_power_of_two(params->fill_tile_size) ||
+      params->copy_tile_size < 64 ||
+      params->copy_tile_size > IREE_HAL_TASK_DEVICE_MAX_TILE_SIZE ||
+      !iree_device_size_is_power_of_two(params->copy_tile_size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "fill and copy tile sizes must be powers of two "
+                            "between 64 bytes and 2GiB");
+  }
   if (queue_count == 0) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
@@ -114,6 +147,14 @@ iree_status_t iree_hal_task_device_create(
     device->host_allocator = host_allocator;
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
+    device->file_transfer_chunk_count = params->file_transfer_chunk_count;
+    device->file_transfer_chunk_size = params->file_transfer_chunk_size;
+    device->transfer_options.fill_tile_size = params->fill_tile_size;
+    device->transfer_options.copy_tile_size = params->copy_tile_size;
+    device->transfer_options.nontemporal_threshold =
+        params->nontemporal_transfer_threshold;
+
+    iree_task_scope_initialize(device->identifier, &device->executable_scope);
 
     iree_arena_block_pool_initialize(4096, host_allocator,
                                      &device->small_block_pool);
@@ -129,12 +170,15 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_executable_loader_retain(device->loaders[i]);
     }
 
-    device->queue_count = queue_count;
-    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    // NOTE: queue_count tracks the initialized queues so that on failure only
+    // those are deinitialized.
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
-      iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
-                                     &device->small_block_pool,
-                                     &device->queues[i]);
+      status = iree_hal_task_queue_initialize(
+          device->identifier, queue_executors[i], &device->small_block_pool,
+          params->queue_pool_slab_size, host_allocator, &device->queues[i]);
+      if (!iree_status_is_ok(status)) break;
+      ++device->queue_count;
     }
   }
 
@@ -152,6 +196,11 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Executable loads may still be running on the queue executors.
+  iree_status_ignore(iree_task_scope_wait_idle(&device->executable_scope,
+                                               IREE_TIME_INFINITE_FUTURE));
+  iree_task_scope_deinitialize(&device->executable_scope);
+
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
@@ -238,6 +287,11 @@ static iree_status_t iree_hal_task_device_query_i64(
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
       *out_value = (int64_t)device->queue_count;
       return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("queue_alloca_reuse"))) {
+      // Queue-ordered allocations are serviced from per-queue pools that reuse
+      // memory deallocated by operations the allocation is ordered after.
+      *out_value = 1;
+      return iree_ok_status();
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.dispatch"))) {
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
@@ -288,8 +342,8 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
       device, command_categories, queue_affinity);
   return iree_hal_task_command_buffer_create(
       base_device, &device->queues[queue_index].scope, mode, command_categories,
-      queue_affinity, binding_capacity, &device->large_block_pool,
-      device->host_allocator, out_command_buffer);
+      queue_affinity, binding_capacity, &device->transfer_options,
+      &device->large_block_pool, device->host_allocator, out_command_buffer);
 }
 
 static iree_status_t iree_hal_task_device_create_descriptor_set_layout(
@@ -309,6 +363,66 @@ static iree_status_t iree_hal_task_device_create_event(
                                     out_event);
 }
 
+// Work scheduled by an executable cache; see
+// iree_hal_task_device_schedule_executable_work.
+typedef struct iree_hal_task_device_executable_work_t {
+  iree_task_call_t task;
+  iree_allocator_t host_allocator;
+  iree_hal_local_executable_cache_work_fn_t fn;
+  void* user_data;
+} iree_hal_task_device_executable_work_t;
+
+static iree_status_t iree_hal_task_device_executable_work_call(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_hal_task_device_executable_work_t* work =
+      (iree_hal_task_device_executable_work_t*)user_context;
+  work->fn(work->user_data);
+  return iree_ok_status();
+}
+
+static void iree_hal_task_device_executable_work_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_device_executable_work_t* work =
+      (iree_hal_task_device_executable_work_t*)task;
+  // Call tasks are not tracked by their scope so the scope is ended only after
+  // the work is freed; see iree_hal_task_device_schedule_executable_work.
+  iree_task_scope_t* scope = task->scope;
+  iree_allocator_free(work->host_allocator, work);
+  iree_task_scope_end(scope);
+}
+
+// Runs executable cache work (executable loads) on the executor of the first
+// queue so that all of the executables of a module load in parallel.
+static iree_status_t iree_hal_task_device_schedule_executable_work(
+    void* self, iree_hal_local_executable_cache_work_fn_t fn,
+    void* user_data) {
+  iree_hal_task_device_t* device = (iree_hal_task_device_t*)self;
+  iree_hal_task_device_executable_work_t* work = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(device->host_allocator,
+                                             sizeof(*work), (void**)&work));
+  work->host_allocator = device->host_allocator;
+  work->fn = fn;
+  work->user_data = user_data;
+  iree_task_call_initialize(
+      &device->executable_scope,
+      iree_task_make_call_closure(iree_hal_task_device_executable_work_call,
+                                  work),
+      &work->task);
+  iree_task_set_cleanup_fn(&work->task.header,
+                           iree_hal_task_device_executable_work_cleanup);
+  // Keeps the scope from going idle (and the device from being destroyed)
+  // until the work has been cleaned up.
+  iree_task_scope_begin(&device->executable_scope);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &work->task.header);
+  iree_task_executor_submit(device->queues[0].executor, &submission);
+  iree_task_executor_flush(device->queues[0].executor);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
@@ -322,9 +436,15 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
         iree_task_executor_worker_count(device->queues[i].executor);
   }
 
+  // Executables are loaded on the executor; the device outlives the cache.
+  iree_hal_local_executable_cache_scheduler_t scheduler = {
+      .self = device,
+      .schedule = iree_hal_task_device_schedule_executable_work,
+  };
   return iree_hal_local_executable_cache_create(
-      identifier, total_worker_count, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      identifier, total_worker_count, scheduler, device->loader_count,
+      device->loaders, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_task_device_import_file(
@@ -378,6 +498,21 @@ iree_hal_task_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
 }
 
+// Submits a batch with no command buffers that signals |signal_semaphore_list|
+// once |wait_semaphore_list| has been reached, ordered on the queue.
+static iree_status_t iree_hal_task_device_queue_submit_barrier(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  iree_hal_submission_batch_t batch = {
+      .wait_semaphores = wait_semaphore_list,
+      .signal_semaphores = signal_semaphore_list,
+      .command_buffer_count = 0,
+      .command_buffers = NULL,
+  };
+  return iree_hal_task_queue_submit(queue, 1, &batch);
+}
+
 static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -385,14 +520,36 @@ static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  iree_hal_task_queue_t* queue = &device->queues[queue_index];
+
+  // The buffer is returned immediately and may reuse memory deallocated by
+  // operations the waits are ordered after. If the pool can't service the
+  // request we allocate fresh memory that is safe to use at any time.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_task_queue_pool_allocate(
+      queue->pool, device->device_allocator, wait_semaphore_list, params,
+      allocation_size, &buffer);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    status = iree_hal_allocator_allocate_buffer(
+        device->device_allocator, params, allocation_size, &buffer);
+  }
+
+  // The allocation becomes visible to the queue once the waits are satisfied.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_task_device_queue_submit_barrier(
+        queue, wait_semaphore_list, signal_semaphore_list);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_dealloca(
@@ -400,10 +557,72 @@ static iree_status_t iree_hal_task_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+
+  // Return the memory to the pool it was allocated from (which may belong to
+  // a different queue) tagged with the timepoint the deallocation signals.
+  // Buffers not allocated from a pool are freed when their last reference is
+  // released.
+  iree_hal_task_queue_pool_deallocate(buffer, signal_semaphore_list);
+
+  return iree_hal_task_device_queue_submit_barrier(
+      &device->queues[queue_index], wait_semaphore_list, signal_semaphore_list);
+}
+
+// Submits a transfer between |file| and |buffer| to the queue selected by
+// |queue_affinity|. Files backed by device-accessible storage are transferred
+// with a queue copy and all others are transferred by executor workers.
+static iree_status_t iree_hal_task_device_queue_file_transfer(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_task_queue_transfer_direction_t direction, iree_hal_file_t* file,
+    uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  const bool is_read =
+      direction == IREE_HAL_TASK_QUEUE_TRANSFER_READ_FILE_TO_BUFFER;
+
+  const iree_hal_memory_access_t required_access =
+      is_read ? IREE_HAL_MEMORY_ACCESS_READ : IREE_HAL_MEMORY_ACCESS_WRITE;
+  if (!iree_all_bits_set(iree_hal_file_allowed_access(file),
+                         required_access)) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "file does not allow %s access",
+                            is_read ? "read" : "write");
+  }
+
+  iree_hal_buffer_t* storage_buffer = iree_hal_file_storage_buffer(file);
+  if (storage_buffer) {
+    return is_read ? iree_hal_device_queue_copy(
+                         base_device, queue_affinity, wait_semaphore_list,
+                         signal_semaphore_list, storage_buffer,
+                         (iree_device_size_t)file_offset, buffer,
+                         buffer_offset, length)
+                   : iree_hal_device_queue_copy(
+                         base_device, queue_affinity, wait_semaphore_list,
+                         signal_semaphore_list, buffer, buffer_offset,
+                         storage_buffer, (iree_device_size_t)file_offset,
+                         length);
+  }
+
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_TRANSFER, queue_affinity);
+  iree_hal_task_queue_file_transfer_t transfer = {
+      .direction = direction,
+      .file = file,
+      .file_offset = file_offset,
+      .buffer = buffer,
+      .buffer_offset = buffer_offset,
+      .length = length,
+      .chunk_count = device->file_transfer_chunk_count,
+      .chunk_size = device->file_transfer_chunk_size,
+  };
+  return iree_hal_task_queue_submit_file_transfer(
+      &device->queues[queue_index], wait_semaphore_list, signal_semaphore_list,
+      &transfer);
 }
 
 static iree_status_t iree_hal_task_device_queue_read(
@@ -413,18 +632,10 @@ static iree_status_t iree_hal_task_device_queue_read(
     iree_hal_file_t* source_file, uint64_t source_offset,
     iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
     iree_device_size_t length, uint32_t flags) {
-  // TODO: expose streaming chunk count/size options.
-  iree_status_t loop_status = iree_ok_status();
-  iree_hal_file_transfer_options_t options = {
-      .loop = iree_loop_inline(&loop_status),
-      .chunk_count = IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT,
-      .chunk_size = IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT,
-  };
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_read_streaming(
+  return iree_hal_task_device_queue_file_transfer(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
-      source_file, source_offset, target_buffer, target_offset, length, flags,
-      options));
-  return loop_status;
+      IREE_HAL_TASK_QUEUE_TRANSFER_READ_FILE_TO_BUFFER, source_file,
+      source_offset, target_buffer, target_offset, length);
 }
 
 static iree_status_t iree_hal_task_device_queue_write(
@@ -434,18 +645,10 @@ static iree_status_t iree_hal_task_device_queue_write(
     iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
     iree_hal_file_t* target_file, uint64_t target_offset,
     iree_device_size_t length, uint32_t flags) {
-  // TODO: expose streaming chunk count/size options.
-  iree_status_t loop_status = iree_ok_status();
-  iree_hal_file_transfer_options_t options = {
-      .loop = iree_loop_inline(&loop_status),
-      .chunk_count = IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT,
-      .chunk_size = IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT,
-  };
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_write_streaming(
+  return iree_hal_task_device_queue_file_transfer(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
-      source_buffer, source_offset, target_file, target_offset, length, flags,
-      options));
-  return loop_status;
+      IREE_HAL_TASK_QUEUE_TRANSFER_WRITE_BUFFER_TO_FILE, target_file,
+      target_offset, source_buffer, source_offset, length);
 }
 
 static iree_status_t iree_hal_task_device_queue_execute(
@@ -484,23 +687,19 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_task_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  // Queue operation profiling is unimplemented (and that's ok); dispatch and
+  // executable counters are captured per export with perf_event_open where
+  // available.
+  if (!iree_hal_local_profiler_is_requested(options)) return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  return iree_hal_local_profiler_begin(options, device->host_allocator);
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  return iree_hal_local_profiler_end();
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
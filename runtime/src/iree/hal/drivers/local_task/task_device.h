@@ -23,6 +23,35 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Minimum size of each slab in the per-queue pools used to service
+  // queue-ordered allocations. Allocations larger than this get their own
+  // slab.
+  iree_device_size_t queue_pool_slab_size;
+
+  // Maximum number of chunks of a queue file read/write that are transferred
+  // concurrently by executor workers.
+  // IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT uses a small fraction of the
+  // executor workers as file operations block the workers performing them.
+  iree_host_size_t file_transfer_chunk_count;
+
+  // Maximum size in bytes of each chunk of a queue file read/write.
+  // IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT divides each transfer evenly
+  // across the chunks.
+  iree_device_size_t file_transfer_chunk_size;
+
+  // Size in bytes of the tiles that fill and copy commands are split into for
+  // executor workers to process concurrently. Smaller tiles spread transfers
+  // across more workers at the cost of more per-tile overhead. Must be powers
+  // of two of at least 64 bytes and at most 2GiB.
+  iree_device_size_t fill_tile_size;
+  iree_device_size_t copy_tile_size;
+
+  // Fill and copy commands of at least this many bytes use non-temporal stores
+  // that bypass the caches so that large transfers don't evict the working set
+  // of the commands that follow them. 0 disables non-temporal stores. Ignored
+  // on targets without non-temporal stores.
+  iree_device_size_t nontemporal_transfer_threshold;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -0,0 +1,639 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_device.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/utils/fd_file.h"
+#include "iree/task/executor.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Loader of executables with the "test" format whose exports count the
+// workgroups they are called with. Exports with bindings write the length of
+// their first binding to it at the index of each workgroup. Loads fail with
+// |load_error| if set.
+struct TestLoader {
+  iree_hal_executable_loader_t base;
+  iree_status_code_t load_error = IREE_STATUS_OK;
+  std::atomic<int> load_count{0};
+  std::atomic<int> workgroup_count{0};
+  std::atomic<std::thread::id> load_thread_id;
+};
+
+struct TestExecutable {
+  iree_hal_local_executable_t base;
+  TestLoader* loader;
+  iree_hal_pipeline_layout_t* layouts[1];
+};
+
+static void TestExecutableDestroy(iree_hal_executable_t* base_executable) {
+  TestExecutable* executable =
+      reinterpret_cast<TestExecutable*>(base_executable);
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(iree_allocator_system(), executable);
+}
+
+static iree_status_t TestExecutableIssueCall(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  ++reinterpret_cast<TestExecutable*>(base_executable)->loader->workgroup_count;
+  if (dispatch_state->binding_count > 0) {
+    static_cast<uint32_t*>(
+        dispatch_state->binding_ptrs[0])[workgroup_state->workgroup_id_x] =
+        static_cast<uint32_t>(dispatch_state->binding_lengths[0]);
+  }
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t kTestExecutableVTable = {
+    /*.base=*/{/*.destroy=*/TestExecutableDestroy},
+    /*.issue_call=*/TestExecutableIssueCall,
+    /*.resolve=*/nullptr,
+};
+
+static void TestLoaderDestroy(iree_hal_executable_loader_t* loader) {
+  delete reinterpret_cast<TestLoader*>(loader);
+}
+
+static bool TestLoaderQuerySupport(
+    iree_hal_executable_loader_t* loader,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  return iree_string_view_equal(executable_format,
+                                iree_make_cstring_view("test"));
+}
+
+static iree_status_t TestLoaderTryLoad(
+    iree_hal_executable_loader_t* base_loader,
+    const iree_hal_executable_params_t* executable_params,
+    iree_host_size_t worker_capacity, iree_hal_executable_t** out_executable) {
+  TestLoader* loader = reinterpret_cast<TestLoader*>(base_loader);
+  loader->load_thread_id = std::this_thread::get_id();
+  ++loader->load_count;
+  if (loader->load_error != IREE_STATUS_OK) {
+    return iree_make_status(loader->load_error, "test load failure");
+  }
+  TestExecutable* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(), sizeof(*executable), (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &kTestExecutableVTable, executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, executable->layouts,
+      iree_allocator_system(), &executable->base);
+  executable->loader = loader;
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static const iree_hal_executable_loader_vtable_t kTestLoaderVTable = {
+    /*.destroy=*/TestLoaderDestroy,
+    /*.query_support=*/TestLoaderQuerySupport,
+    /*.try_load=*/TestLoaderTryLoad,
+};
+
+class TaskDeviceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/8,
+                                                   &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor_));
+    iree_task_topology_deinitialize(&topology);
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release(device_allocator_);
+    iree_task_executor_release(executor_);
+    for (auto& path : temp_paths_) remove(path.c_str());
+  }
+
+  void CreateDevice(const iree_hal_task_device_params_t& params,
+                    iree_hal_executable_loader_t* loader = NULL) {
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("test"), &params, /*queue_count=*/1,
+        &executor_, /*loader_count=*/loader ? 1 : 0, &loader,
+        device_allocator_, iree_allocator_system(), &device_));
+  }
+
+  // Creates a device with a TestLoader failing loads with |load_error|.
+  TestLoader* CreateDeviceWithTestLoader(
+      iree_status_code_t load_error = IREE_STATUS_OK) {
+    TestLoader* loader = new TestLoader();
+    iree_hal_executable_loader_initialize(
+        &kTestLoaderVTable, iree_hal_executable_import_provider_null(),
+        &loader->base);
+    loader->load_error = load_error;
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    CreateDevice(params, &loader->base);
+    // The device retains the loader.
+    iree_hal_executable_loader_release(&loader->base);
+    return loader;
+  }
+
+  // Prepares a test executable with a single export that is loaded
+  // asynchronously by the device. If |out_pipeline_layout| is provided the
+  // export has a single storage buffer binding in set 0 and the layout is
+  // returned to the caller.
+  iree_hal_executable_t* PrepareExecutable(
+      iree_hal_executable_cache_t* executable_cache,
+      iree_hal_pipeline_layout_t** out_pipeline_layout = NULL) {
+    static const uint8_t kData[] = {1, 2, 3, 4};
+    iree_hal_descriptor_set_layout_t* set_layout = NULL;
+    if (out_pipeline_layout) {
+      const iree_hal_descriptor_set_layout_binding_t binding = {
+          /*binding=*/0,
+          IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          IREE_HAL_DESCRIPTOR_FLAG_NONE,
+      };
+      IREE_CHECK_OK(iree_hal_descriptor_set_layout_create(
+          device_, IREE_HAL_DESCRIPTOR_SET_LAYOUT_FLAG_NONE, 1, &binding,
+          &set_layout));
+    }
+    iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+    IREE_CHECK_OK(iree_hal_pipeline_layout_create(
+        device_, /*push_constants=*/0, /*set_layout_count=*/set_layout ? 1 : 0,
+        &set_layout, &pipeline_layout));
+    iree_hal_descriptor_set_layout_release(set_layout);
+    iree_hal_executable_params_t params;
+    iree_hal_executable_params_initialize(&params);
+    params.caching_mode = IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    params.executable_format = iree_make_cstring_view("test");
+    params.executable_data = iree_make_const_byte_span(kData, sizeof(kData));
+    params.pipeline_layout_count = 1;
+    params.pipeline_layouts = &pipeline_layout;
+    iree_hal_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache, &params, &executable));
+    if (out_pipeline_layout) {
+      *out_pipeline_layout = pipeline_layout;
+    } else {
+      iree_hal_pipeline_layout_release(pipeline_layout);
+    }
+    return executable;
+  }
+
+  // Records a dispatch of |executable| into a new command buffer.
+  iree_status_t RecordDispatch(iree_hal_executable_t* executable,
+                               uint32_t workgroup_x,
+                               iree_hal_command_buffer_t** out_command_buffer) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    iree_status_t status = iree_hal_command_buffer_begin(command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_dispatch(command_buffer, executable,
+                                                /*entry_point=*/0, workgroup_x,
+                                                1, 1);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_end(command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      *out_command_buffer = command_buffer;
+    } else {
+      iree_hal_command_buffer_release(command_buffer);
+    }
+    return status;
+  }
+
+  iree_hal_buffer_t* CreateBuffer(iree_device_size_t length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     length, &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_zero(buffer, 0, IREE_WHOLE_BUFFER));
+    return buffer;
+  }
+
+  // Returns a unique path in the test temporary directory that is removed
+  // when the test completes.
+  std::string GetTempPath(const char* unique_name) {
+    const char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+    if (!test_tmpdir) test_tmpdir = "/tmp";
+    std::random_device d;
+    uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+    char path[256];
+    snprintf(path, sizeof(path), "%s/iree_task_device_%" PRIx64 "_%s",
+             test_tmpdir, random, unique_name);
+    temp_paths_.push_back(path);
+    return path;
+  }
+
+  // Returns |length| bytes of deterministic pseudo-random data.
+  static std::vector<uint8_t> MakeContents(size_t length, uint32_t seed) {
+    std::vector<uint8_t> contents(length);
+    std::minstd_rand engine(seed);
+    for (auto& value : contents) value = (uint8_t)engine();
+    return contents;
+  }
+
+  // Submits a queue read or write of |file| and waits for it to complete.
+  void TransferAndWait(bool is_read, iree_hal_file_t* file,
+                       uint64_t file_offset, iree_hal_buffer_t* buffer,
+                       iree_device_size_t buffer_offset,
+                       iree_device_size_t length) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore,
+                                                   &signal_value};
+    if (is_read) {
+      IREE_ASSERT_OK(iree_hal_device_queue_read(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+          iree_hal_semaphore_list_empty(), signal_semaphores, file,
+          file_offset, buffer, buffer_offset, length, /*flags=*/0));
+    } else {
+      IREE_ASSERT_OK(iree_hal_device_queue_write(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+          iree_hal_semaphore_list_empty(), signal_semaphores, buffer,
+          buffer_offset, file, file_offset, length, /*flags=*/0));
+    }
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout()));
+    iree_hal_semaphore_release(semaphore);
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  std::vector<std::string> temp_paths_;
+};
+
+// Executables are loaded by work scheduled on the executor and dispatches of
+// them call into the loaded executable.
+TEST_F(TaskDeviceTest, ExecutableLoadsOnExecutor) {
+  TestLoader* loader = CreateDeviceWithTestLoader();
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("test"), iree_loop_inline(NULL),
+      &executable_cache));
+  iree_hal_executable_t* executable = PrepareExecutable(executable_cache);
+
+  // Preparation returns immediately and the load completes on a worker.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (loader->load_count == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(loader->load_count, 1);
+  EXPECT_NE(loader->load_thread_id.load(), std::this_thread::get_id());
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(RecordDispatch(executable, /*workgroup_x=*/3,
+                                &command_buffer));
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  uint64_t signal_value = 1ull;
+  iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore, &signal_value};
+  IREE_ASSERT_OK(iree_hal_device_queue_execute(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      signal_semaphores, 1, &command_buffer));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout()));
+  EXPECT_EQ(loader->workgroup_count, 3);
+  EXPECT_EQ(loader->load_count, 1);
+
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_executable_release(executable);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Load failures are reported when the executable is dispatched.
+TEST_F(TaskDeviceTest, ExecutableLoadErrorReportedOnDispatch) {
+  CreateDeviceWithTestLoader(IREE_STATUS_INVALID_ARGUMENT);
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("test"), iree_loop_inline(NULL),
+      &executable_cache));
+  iree_hal_executable_t* executable = PrepareExecutable(executable_cache);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  iree_status_t status =
+      RecordDispatch(executable, /*workgroup_x=*/1, &command_buffer);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT, status);
+  iree_status_free(status);
+
+  iree_hal_executable_release(executable);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Executables and the device can be released while loads are still scheduled
+// on the executor.
+TEST_F(TaskDeviceTest, ReleaseWithScheduledExecutableLoads) {
+  CreateDeviceWithTestLoader();
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("test"), iree_loop_inline(NULL),
+      &executable_cache));
+  for (int i = 0; i < 16; ++i) {
+    iree_hal_executable_release(PrepareExecutable(executable_cache));
+  }
+  iree_hal_executable_cache_release(executable_cache);
+  iree_hal_device_release(device_);
+  device_ = NULL;
+}
+
+// Indirect command buffers are recorded once and executed with different
+// binding tables, including multiple times within one command buffer.
+TEST_F(TaskDeviceTest, ExecuteIndirectCommandBuffer) {
+  TestLoader* loader = CreateDeviceWithTestLoader();
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("test"), iree_loop_inline(NULL),
+      &executable_cache));
+  iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+  iree_hal_executable_t* executable =
+      PrepareExecutable(executable_cache, &pipeline_layout);
+
+  iree_hal_command_buffer_t* nested_command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_NESTED,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/1, &nested_command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(nested_command_buffer));
+  const iree_hal_descriptor_set_binding_t descriptor_set_binding = {
+      /*binding=*/0,
+      /*buffer_slot=*/0,
+      /*buffer=*/NULL,
+      /*offset=*/4,
+      IREE_WHOLE_BUFFER,
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      nested_command_buffer, pipeline_layout, /*set=*/0, 1,
+      &descriptor_set_binding));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+      nested_command_buffer, executable, /*entry_point=*/0, 2, 1, 1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(nested_command_buffer));
+
+  iree_hal_buffer_t* buffers[2] = {CreateBuffer(16), CreateBuffer(16)};
+  const iree_hal_buffer_binding_t bindings[2] = {
+      {buffers[0], /*offset=*/0, /*length=*/16},
+      {buffers[1], /*offset=*/4, /*length=*/12},
+  };
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  for (uint64_t i = 1; i <= 2; ++i) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    for (const auto& binding : bindings) {
+      IREE_ASSERT_OK(iree_hal_command_buffer_execute_commands(
+          command_buffer, nested_command_buffer, {1, &binding}));
+    }
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+    iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore, &i};
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer));
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_wait(semaphore, i, iree_infinite_timeout()));
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  EXPECT_EQ(loader->workgroup_count, 8);
+
+  uint32_t contents[4] = {0};
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_read(buffers[0], 0, contents, sizeof(contents)));
+  EXPECT_THAT(contents, ::testing::ElementsAre(0, 12, 12, 0));
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_read(buffers[1], 0, contents, sizeof(contents)));
+  EXPECT_THAT(contents, ::testing::ElementsAre(0, 0, 8, 8));
+
+  iree_hal_semaphore_release(semaphore);
+  for (auto* buffer : buffers) iree_hal_buffer_release(buffer);
+  iree_hal_command_buffer_release(nested_command_buffer);
+  iree_hal_pipeline_layout_release(pipeline_layout);
+  iree_hal_executable_release(executable);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Binding tables that do not cover the slots referenced by an indirect command
+// buffer are rejected when it is recorded for execution.
+TEST_F(TaskDeviceTest, ExecuteIndirectCommandBufferValidatesBindings) {
+  CreateDeviceWithTestLoader();
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("test"), iree_loop_inline(NULL),
+      &executable_cache));
+  iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+  iree_hal_executable_t* executable =
+      PrepareExecutable(executable_cache, &pipeline_layout);
+
+  iree_hal_command_buffer_t* nested_command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_NESTED,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/2, &nested_command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(nested_command_buffer));
+  const iree_hal_descriptor_set_binding_t descriptor_set_binding = {
+      /*binding=*/0,
+      /*buffer_slot=*/1,
+      /*buffer=*/NULL,
+      /*offset=*/0,
+      /*length=*/8,
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      nested_command_buffer, pipeline_layout, /*set=*/0, 1,
+      &descriptor_set_binding));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+      nested_command_buffer, executable, /*entry_point=*/0, 1, 1, 1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(nested_command_buffer));
+
+  // Submitting the command buffer without a binding table fails.
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  uint64_t signal_value = 1ull;
+  iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore, &signal_value};
+  IREE_ASSERT_OK(iree_hal_device_queue_execute(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      signal_semaphores, 1, &nested_command_buffer));
+  iree_status_ignore(
+      iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout()));
+  uint64_t value = 0ull;
+  iree_status_t status = iree_hal_semaphore_query(semaphore, &value);
+  EXPECT_FALSE(iree_status_is_ok(status));
+  iree_status_free(status);
+  iree_hal_semaphore_release(semaphore);
+
+  iree_hal_buffer_t* buffer = CreateBuffer(16);
+  const iree_hal_buffer_binding_t short_bindings[2] = {
+      {buffer, /*offset=*/0, /*length=*/16},
+      {buffer, /*offset=*/12, /*length=*/4},
+  };
+  const iree_hal_buffer_binding_t empty_bindings[2] = {
+      {buffer, /*offset=*/0, /*length=*/16},
+      {NULL, /*offset=*/0, /*length=*/0},
+  };
+  struct {
+    iree_hal_buffer_binding_table_t binding_table;
+    iree_status_code_t status_code;
+  } cases[] = {
+      {{1, short_bindings}, IREE_STATUS_OUT_OF_RANGE},
+      {{2, short_bindings}, IREE_STATUS_OUT_OF_RANGE},
+      {{2, empty_bindings}, IREE_STATUS_INVALID_ARGUMENT},
+  };
+  for (const auto& test_case : cases) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    status = iree_hal_command_buffer_execute_commands(
+        command_buffer, nested_command_buffer, test_case.binding_table);
+    IREE_EXPECT_STATUS_IS(test_case.status_code, status);
+    iree_status_free(status);
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_command_buffer_release(nested_command_buffer);
+  iree_hal_pipeline_layout_release(pipeline_layout);
+  iree_hal_executable_release(executable);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tile sizes that do not fit in a 32-bit workgroup size are rejected.
+TEST_F(TaskDeviceTest, RejectsOversizedTiles) {
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.fill_tile_size = 1ull << 32;
+  iree_status_t status = iree_hal_task_device_create(
+      iree_make_cstring_view("test"), &params, /*queue_count=*/1, &executor_,
+      /*loader_count=*/0, /*loaders=*/NULL, device_allocator_,
+      iree_allocator_system(), &device_);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT, status);
+  iree_status_free(status);
+
+  iree_hal_task_device_params_initialize(&params);
+  params.copy_tile_size = 1ull << 31;
+  CreateDevice(params);
+}
+
+// Reads an unaligned range of a file descriptor-backed file split into more
+// chunks than there are tiles such that each tile reads several chunks.
+TEST_F(TaskDeviceTest, ReadFdFileChunks) {
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.file_transfer_chunk_count = 3;
+  params.file_transfer_chunk_size = 4096;
+  CreateDevice(params);
+
+  constexpr size_t kFileSize = 100 * 1024 + 17;
+  std::vector<uint8_t> contents = MakeContents(kFileSize, 1);
+  std::string path = GetTempPath("ReadFdFileChunks");
+  FILE* host_file = fopen(path.c_str(), "wb");
+  ASSERT_NE(host_file, nullptr);
+  ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), host_file),
+            contents.size());
+  fclose(host_file);
+
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = iree_hal_fd_file_open(
+      IREE_HAL_MEMORY_ACCESS_READ,
+      iree_make_string_view(path.data(), path.size()),
+      IREE_HAL_FD_FILE_FLAG_NONE, iree_allocator_system(), &file);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "file descriptor files unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  constexpr uint64_t kFileOffset = 123;
+  constexpr iree_device_size_t kBufferOffset = 7;
+  const iree_device_size_t length = kFileSize - kFileOffset;
+  iree_hal_buffer_t* buffer = CreateBuffer(kBufferOffset + length);
+  TransferAndWait(/*is_read=*/true, file, kFileOffset, buffer, kBufferOffset,
+                  length);
+
+  std::vector<uint8_t> actual(length);
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_read(buffer, kBufferOffset, actual.data(), length));
+  EXPECT_TRUE(std::equal(actual.begin(), actual.end(),
+                         contents.begin() + kFileOffset));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+// Writes to a file descriptor-backed file using the automatically selected
+// chunking and checks the file contents match.
+TEST_F(TaskDeviceTest, WriteFdFileAutoChunks) {
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  CreateDevice(params);
+
+  std::string path = GetTempPath("WriteFdFileAutoChunks");
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = iree_hal_fd_file_open(
+      IREE_HAL_MEMORY_ACCESS_ALL,
+      iree_make_string_view(path.data(), path.size()),
+      IREE_HAL_FD_FILE_FLAG_NONE, iree_allocator_system(), &file);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "file descriptor files unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  constexpr size_t kFileSize = 3 * 1024 * 1024 + 5;
+  std::vector<uint8_t> contents = MakeContents(kFileSize, 2);
+  iree_hal_buffer_t* buffer = CreateBuffer(kFileSize);
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_write(buffer, 0, contents.data(), kFileSize));
+  TransferAndWait(/*is_read=*/false, file, 0, buffer, 0, kFileSize);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+
+  std::vector<uint8_t> actual(kFileSize + 1);
+  FILE* host_file = fopen(path.c_str(), "rb");
+  ASSERT_NE(host_file, nullptr);
+  size_t actual_length = fread(actual.data(), 1, actual.size(), host_file);
+  fclose(host_file);
+  ASSERT_EQ(actual_length, kFileSize);
+  actual.resize(actual_length);
+  EXPECT_TRUE(actual == contents);
+}
+
+}  // namespace
@@ -107,6 +107,9 @@ typedef struct iree_hal_task_queue_wait_cmd_t {
   // this.
   iree_arena_allocator_t* arena;
 
+  // Pool of the executor the wait events are acquired from.
+  iree_event_pool_t* event_pool;
+
   // A list of semaphores to wait on prior to issuing the rest of the
   // submission.
   iree_hal_semaphore_list_t wait_semaphores;
@@ -119,14 +122,9 @@ static iree_status_t iree_hal_task_queue_wait_cmd(
   iree_hal_task_queue_wait_cmd_t* cmd = (iree_hal_task_queue_wait_cmd_t*)task;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < cmd->wait_semaphores.count; ++i) {
-    status = iree_hal_task_semaphore_enqueue_timepoint(
-        cmd->wait_semaphores.semaphores[i],
-        cmd->wait_semaphores.payload_values[i],
-        cmd->task.header.completion_task, cmd->arena, pending_submission);
-    if (IREE_UNLIKELY(!iree_status_is_ok(status))) break;
-  }
+  iree_status_t status = iree_hal_task_semaphore_enqueue_timepoints(
+      cmd->wait_semaphores, cmd->task.header.completion_task, cmd->event_pool,
+      cmd->arena, pending_submission);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -142,7 +140,8 @@ static void iree_hal_task_queue_wait_cmd_cleanup(
 
 // Allocates and initializes a iree_hal_task_queue_wait_cmd_t task.
 static iree_status_t iree_hal_task_queue_wait_cmd_allocate(
-    iree_task_scope_t* scope, const iree_hal_semaphore_list_t* wait_semaphores,
+    iree_task_scope_t* scope, iree_event_pool_t* event_pool,
+    const iree_hal_semaphore_list_t* wait_semaphores,
     iree_arena_allocator_t* arena, iree_hal_task_queue_wait_cmd_t** out_cmd) {
   iree_hal_task_queue_wait_cmd_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_arena_allocate(arena, sizeof(*cmd), (void**)&cmd));
@@ -152,6 +151,7 @@ static iree_status_t iree_hal_task_queue_wait_cmd_allocate(
   iree_task_set_cleanup_fn(&cmd->task.header,
                            iree_hal_task_queue_wait_cmd_cleanup);
   cmd->arena = arena;
+  cmd->event_pool = event_pool;
 
   // Clone the wait semaphores from the batch - we retain them and their
   // payloads.
@@ -408,19 +408,153 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_task_queue_transfer_cmd_t
+//===----------------------------------------------------------------------===//
+
+// Minimum size of each file operation when the chunk size is selected
+// automatically. Small enough to spread moderately sized transfers across
+// workers and large enough that syscall overhead is negligible.
+#define IREE_HAL_TASK_QUEUE_TRANSFER_MIN_CHUNK_SIZE (256 * 1024)
+
+// Alignment of automatically selected chunk sizes such that each chunk of a
+// page-aligned transfer remains page-aligned.
+#define IREE_HAL_TASK_QUEUE_TRANSFER_CHUNK_ALIGNMENT 4096
+
+// Maximum number of tiles used when the chunk count is selected automatically.
+// File operations block the worker executing them for their entire duration
+// and most storage saturates with a few requests in flight: the automatic tile
+// count uses at most a quarter of the executor workers such that the remainder
+// stay available for compute.
+#define IREE_HAL_TASK_QUEUE_TRANSFER_MAX_AUTO_TILE_COUNT 4
+
+// Task to transfer data between a host file and a buffer.
+// The transfer is split into chunks that are distributed round-robin across
+// the tiles of the dispatch. Each tile performs its chunks sequentially such
+// that at most one file operation per tile is in flight at a time. Local
+// buffers are always host mappable and chunks are read/written directly
+// without any staging.
+typedef struct iree_hal_task_queue_transfer_cmd_t {
+  // Dispatch of iree_hal_task_queue_transfer_tile.
+  iree_task_dispatch_t task;
+
+  // File and buffer are retained by the retire command.
+  iree_hal_task_queue_transfer_direction_t direction;
+  iree_hal_file_t* file;
+  uint64_t file_offset;
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t buffer_offset;
+  iree_device_size_t length;
+
+  // Size of each chunk in bytes; the last chunk may be smaller.
+  iree_device_size_t chunk_size;
+  // Total number of chunks in the transfer.
+  iree_device_size_t chunk_count;
+} iree_hal_task_queue_transfer_cmd_t;
+
+// Transfers every chunk assigned to the tile.
+static iree_status_t iree_hal_task_queue_transfer_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_task_queue_transfer_cmd_t* cmd =
+      (const iree_hal_task_queue_transfer_cmd_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_device_size_t tile_count = tile_context->workgroup_count[0];
+  iree_status_t status = iree_ok_status();
+  for (iree_device_size_t i = tile_context->workgroup_xyz[0];
+       i < cmd->chunk_count && iree_status_is_ok(status); i += tile_count) {
+    iree_device_size_t chunk_offset = i * cmd->chunk_size;
+    iree_device_size_t chunk_length =
+        iree_min(cmd->chunk_size, cmd->length - chunk_offset);
+    IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)chunk_length);
+    if (cmd->direction == IREE_HAL_TASK_QUEUE_TRANSFER_READ_FILE_TO_BUFFER) {
+      status = iree_hal_file_read(cmd->file, cmd->file_offset + chunk_offset,
+                                  cmd->buffer,
+                                  cmd->buffer_offset + chunk_offset,
+                                  chunk_length);
+    } else {
+      status = iree_hal_file_write(cmd->file, cmd->file_offset + chunk_offset,
+                                   cmd->buffer,
+                                   cmd->buffer_offset + chunk_offset,
+                                   chunk_length);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Allocates and initializes a iree_hal_task_queue_transfer_cmd_t task.
+// A |transfer| chunk count of 0 uses up to a quarter of the executor workers
+// and a chunk size of 0 divides the transfer evenly across the tiles.
+static iree_status_t iree_hal_task_queue_transfer_cmd_allocate(
+    iree_task_scope_t* scope, iree_hal_task_queue_t* queue,
+    iree_task_t* retire_task,
+    const iree_hal_task_queue_file_transfer_t* transfer,
+    iree_arena_allocator_t* arena,
+    iree_hal_task_queue_transfer_cmd_t** out_cmd) {
+  iree_host_size_t max_tile_count = transfer->chunk_count;
+  if (max_tile_count == 0) {
+    max_tile_count =
+        iree_min(iree_task_executor_worker_count(queue->executor) / 4,
+                 IREE_HAL_TASK_QUEUE_TRANSFER_MAX_AUTO_TILE_COUNT);
+  }
+  max_tile_count = iree_max(1, iree_min(max_tile_count, UINT32_MAX));
+  iree_device_size_t chunk_size = transfer->chunk_size;
+  if (chunk_size == 0) {
+    chunk_size = iree_device_align(
+        iree_max(iree_device_size_ceil_div(transfer->length, max_tile_count),
+                 IREE_HAL_TASK_QUEUE_TRANSFER_MIN_CHUNK_SIZE),
+        IREE_HAL_TASK_QUEUE_TRANSFER_CHUNK_ALIGNMENT);
+  }
+  iree_device_size_t chunk_count =
+      iree_device_size_ceil_div(transfer->length, chunk_size);
+
+  iree_hal_task_queue_transfer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(arena, sizeof(*cmd), (void**)&cmd));
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {
+      /*x=*/(uint32_t)iree_min(chunk_count, max_tile_count),
+      /*y=*/1,
+      /*z=*/1,
+  };
+  iree_task_dispatch_initialize(
+      scope,
+      iree_task_make_dispatch_closure(iree_hal_task_queue_transfer_tile,
+                                      (void*)cmd),
+      workgroup_size, workgroup_count, &cmd->task);
+  iree_task_set_completion_task(&cmd->task.header, retire_task);
+  cmd->direction = transfer->direction;
+  cmd->file = transfer->file;
+  cmd->file_offset = transfer->file_offset;
+  cmd->buffer = transfer->buffer;
+  cmd->buffer_offset = transfer->buffer_offset;
+  cmd->length = transfer->length;
+  cmd->chunk_size = chunk_size;
+  cmd->chunk_count = chunk_count;
+
+  *out_cmd = cmd;
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_queue_t
 //===----------------------------------------------------------------------===//
 
-void iree_hal_task_queue_initialize(iree_string_view_t identifier,
-                                    iree_task_executor_t* executor,
-                                    iree_arena_block_pool_t* block_pool,
-                                    iree_hal_task_queue_t* out_queue) {
+iree_status_t iree_hal_task_queue_initialize(
+    iree_string_view_t identifier, iree_task_executor_t* executor,
+    iree_arena_block_pool_t* block_pool, iree_device_size_t pool_slab_size,
+    iree_allocator_t host_allocator, iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
 
   memset(out_queue, 0, sizeof(*out_queue));
 
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_queue_pool_create(pool_slab_size, host_allocator,
+                                          &out_queue->pool));
+
   out_queue->executor = executor;
   iree_task_executor_retain(out_queue->executor);
   out_queue->block_pool = block_pool;
@@ -430,6 +564,7 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
   IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
@@ -442,24 +577,37 @@ void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
   iree_task_scope_deinitialize(&queue->scope);
   iree_task_executor_release(queue->executor);
 
+  // Buffers allocated from the pool retain it and may outlive the queue.
+  iree_hal_task_queue_pool_release(queue->pool);
+
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_hal_task_queue_trim(iree_hal_task_queue_t* queue) {
   IREE_ASSERT_ARGUMENT(queue);
   iree_task_executor_trim(queue->executor);
+  iree_hal_task_queue_pool_trim(queue->pool);
 }
 
-static iree_status_t iree_hal_task_queue_submit_batch(
-    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch) {
+// Allocates the commands shared by all submissions: the retire command that
+// signals |signal_semaphores| and owns the submission arena and, if there are
+// any |wait_semaphores|, the wait command. On success the caller must either
+// pass the commands to iree_hal_task_queue_end_submission or deinitialize the
+// retire command arena.
+static iree_status_t iree_hal_task_queue_begin_submission(
+    iree_hal_task_queue_t* queue, iree_host_size_t resource_count,
+    iree_hal_resource_t* const* resources,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_task_queue_retire_cmd_t** out_retire_cmd,
+    iree_hal_task_queue_wait_cmd_t** out_wait_cmd) {
   // Task to retire the submission and free the transient memory allocated for
   // it (including the command itself). We allocate this first so it can get an
   // arena which we will use to allocate all other commands.
   iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_queue_retire_cmd_allocate(
-      &queue->scope, batch->command_buffer_count,
-      (iree_hal_resource_t* const*)batch->command_buffers,
-      &batch->signal_semaphores, queue->block_pool, &retire_cmd));
+      &queue->scope, resource_count, resources, signal_semaphores,
+      queue->block_pool, &retire_cmd));
 
   // NOTE: if we fail from here on we must drop the retire_cmd arena.
   iree_status_t status = iree_ok_status();
@@ -469,42 +617,41 @@ static iree_status_t iree_hal_task_queue_submit_batch(
   iree_task_fence_t* fence = NULL;
   status =
       iree_task_executor_acquire_fence(queue->executor, &queue->scope, &fence);
-  iree_task_set_completion_task(&retire_cmd->task.header, &fence->header);
+  if (iree_status_is_ok(status)) {
+    iree_task_set_completion_task(&retire_cmd->task.header, &fence->header);
+  }
 
   // Task to fork and wait for unsatisfied semaphore dependencies.
   // This is optional and only required if we have previous submissions still
   // in-flight - if the queue is empty then we can directly schedule the waits.
   iree_hal_task_queue_wait_cmd_t* wait_cmd = NULL;
-  if (iree_status_is_ok(status) && batch->wait_semaphores.count > 0) {
+  if (iree_status_is_ok(status) && wait_semaphores->count > 0) {
     status = iree_hal_task_queue_wait_cmd_allocate(
-        &queue->scope, &batch->wait_semaphores, &retire_cmd->arena, &wait_cmd);
-  }
-
-  // Task to issue all the command buffers in the batch.
-  // After this task completes the commands have been issued but have not yet
-  // completed and the issued commands may complete in any order.
-  iree_hal_task_queue_issue_cmd_t* issue_cmd = NULL;
-  if (iree_status_is_ok(status) && batch->command_buffer_count > 0) {
-    status = iree_hal_task_queue_issue_cmd_allocate(
-        &queue->scope, queue, &retire_cmd->task.header,
-        batch->command_buffer_count, batch->command_buffers, &retire_cmd->arena,
-        &issue_cmd);
+        &queue->scope, iree_task_executor_event_pool(queue->executor),
+        wait_semaphores, &retire_cmd->arena, &wait_cmd);
   }
 
-  // Last chance for failure - from here on we are submitting.
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
     iree_arena_deinitialize(&retire_cmd->arena);
     return status;
   }
+  *out_retire_cmd = retire_cmd;
+  *out_wait_cmd = wait_cmd;
+  return iree_ok_status();
+}
 
+// Submits a submission to the executor. |head_task| (or the retire command if
+// NULL) is executed once all waits have been satisfied.
+static void iree_hal_task_queue_end_submission(
+    iree_hal_task_queue_t* queue, iree_hal_task_queue_retire_cmd_t* retire_cmd,
+    iree_hal_task_queue_wait_cmd_t* wait_cmd, iree_task_t* head_task) {
   iree_task_submission_t submission;
   iree_task_submission_initialize(&submission);
 
   // Sequencing: wait on semaphores or go directly into the executor queue.
-  iree_task_t* head_task =
-      issue_cmd ? &issue_cmd->task.header : &retire_cmd->task.header;
+  if (!head_task) head_task = &retire_cmd->task.header;
   if (wait_cmd != NULL) {
-    // Ensure that we only issue command buffers after all waits have completed.
+    // Ensure that we only issue work after all waits have completed.
     iree_task_set_completion_task(&wait_cmd->task.header, head_task);
     iree_task_submission_enqueue(&submission, &wait_cmd->task.header);
   } else {
@@ -515,6 +662,36 @@ static iree_status_t iree_hal_task_queue_submit_batch(
   // Submit the tasks immediately. The executor may queue them up until we
   // force the flush after all batches have been processed.
   iree_task_executor_submit(queue->executor, &submission);
+}
+
+static iree_status_t iree_hal_task_queue_submit_batch(
+    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch) {
+  iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
+  iree_hal_task_queue_wait_cmd_t* wait_cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_queue_begin_submission(
+      queue, batch->command_buffer_count,
+      (iree_hal_resource_t* const*)batch->command_buffers,
+      &batch->wait_semaphores, &batch->signal_semaphores, &retire_cmd,
+      &wait_cmd));
+
+  // Task to issue all the command buffers in the batch.
+  // After this task completes the commands have been issued but have not yet
+  // completed and the issued commands may complete in any order.
+  iree_hal_task_queue_issue_cmd_t* issue_cmd = NULL;
+  if (batch->command_buffer_count > 0) {
+    iree_status_t status = iree_hal_task_queue_issue_cmd_allocate(
+        &queue->scope, queue, &retire_cmd->task.header,
+        batch->command_buffer_count, batch->command_buffers, &retire_cmd->arena,
+        &issue_cmd);
+    // Last chance for failure - from here on we are submitting.
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      iree_arena_deinitialize(&retire_cmd->arena);
+      return status;
+    }
+  }
+
+  iree_hal_task_queue_end_submission(
+      queue, retire_cmd, wait_cmd, issue_cmd ? &issue_cmd->task.header : NULL);
   return iree_ok_status();
 }
 
@@ -546,6 +723,47 @@ iree_status_t iree_hal_task_queue_submit(
   return status;
 }
 
+iree_status_t iree_hal_task_queue_submit_file_transfer(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    const iree_hal_task_queue_file_transfer_t* transfer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer->length);
+
+  // The file and buffer are retained until the transfer retires.
+  iree_hal_resource_t* resources[2] = {
+      (iree_hal_resource_t*)transfer->file,
+      (iree_hal_resource_t*)transfer->buffer,
+  };
+  iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
+  iree_hal_task_queue_wait_cmd_t* wait_cmd = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_queue_begin_submission(
+              queue, IREE_ARRAYSIZE(resources), resources, &wait_semaphore_list,
+              &signal_semaphore_list, &retire_cmd, &wait_cmd));
+
+  iree_hal_task_queue_transfer_cmd_t* transfer_cmd = NULL;
+  if (transfer->length > 0) {
+    iree_status_t status = iree_hal_task_queue_transfer_cmd_allocate(
+        &queue->scope, queue, &retire_cmd->task.header, transfer,
+        &retire_cmd->arena, &transfer_cmd);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      iree_arena_deinitialize(&retire_cmd->arena);
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+  }
+
+  iree_hal_task_queue_end_submission(
+      queue, retire_cmd, wait_cmd,
+      transfer_cmd ? &transfer_cmd->task.header : NULL);
+  iree_task_executor_flush(queue->executor);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
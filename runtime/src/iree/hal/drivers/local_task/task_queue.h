@@ -13,6 +13,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_queue_pool.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
 #include "iree/task/executor.h"
 #include "iree/task/scope.h"
@@ -37,12 +38,17 @@ typedef struct iree_hal_task_queue_t {
   // The intra-queue synchronization (barriers/events) carries across command
   // buffers and this is used to rendezvous the tasks in each set.
   iree_hal_task_queue_state_t state;
+
+  // Pool used for queue-ordered allocations (alloca/dealloca).
+  // Memory deallocated by one submission can be reused by any later submission
+  // ordered after it without host synchronization.
+  iree_hal_task_queue_pool_t* pool;
 } iree_hal_task_queue_t;
 
-void iree_hal_task_queue_initialize(iree_string_view_t identifier,
-                                    iree_task_executor_t* executor,
-                                    iree_arena_block_pool_t* block_pool,
-                                    iree_hal_task_queue_t* out_queue);
+iree_status_t iree_hal_task_queue_initialize(
+    iree_string_view_t identifier, iree_task_executor_t* executor,
+    iree_arena_block_pool_t* block_pool, iree_device_size_t pool_slab_size,
+    iree_allocator_t host_allocator, iree_hal_task_queue_t* out_queue);
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue);
 
@@ -52,6 +58,37 @@ iree_status_t iree_hal_task_queue_submit(
     iree_hal_task_queue_t* queue, iree_host_size_t batch_count,
     const iree_hal_submission_batch_t* batches);
 
+// Direction of a queue file transfer.
+typedef enum iree_hal_task_queue_transfer_direction_e {
+  // Reads from the file into the buffer.
+  IREE_HAL_TASK_QUEUE_TRANSFER_READ_FILE_TO_BUFFER = 0,
+  // Writes from the buffer into the file.
+  IREE_HAL_TASK_QUEUE_TRANSFER_WRITE_BUFFER_TO_FILE,
+} iree_hal_task_queue_transfer_direction_t;
+
+// A transfer between a host file and a buffer executed on the queue executor.
+typedef struct iree_hal_task_queue_file_transfer_t {
+  iree_hal_task_queue_transfer_direction_t direction;
+  iree_hal_file_t* file;
+  uint64_t file_offset;
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t buffer_offset;
+  iree_device_size_t length;
+  // Maximum number of chunks transferred concurrently by executor workers.
+  iree_host_size_t chunk_count;
+  // Maximum size in bytes of each file operation.
+  iree_device_size_t chunk_size;
+} iree_hal_task_queue_file_transfer_t;
+
+// Submits |transfer| to execute on the queue executor once
+// |wait_semaphore_list| has been satisfied and then signals
+// |signal_semaphore_list|. The caller does not block on the transfer.
+iree_status_t iree_hal_task_queue_submit_file_transfer(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    const iree_hal_task_queue_file_transfer_t* transfer);
+
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout);
 
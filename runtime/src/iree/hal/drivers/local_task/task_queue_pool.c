@@ -0,0 +1,554 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_queue_pool.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_queue_pool_t
+//===----------------------------------------------------------------------===//
+
+// A free byte range within a slab.
+typedef struct iree_hal_task_queue_pool_range_t {
+  // Next free range in the slab in ascending offset order.
+  struct iree_hal_task_queue_pool_range_t* next;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  // Timepoint after which the range is no longer in use by the queue.
+  // NULL if the range is unused.
+  iree_hal_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_task_queue_pool_range_t;
+
+// A contiguous block of host memory that allocations are suballocated from.
+typedef struct iree_hal_task_queue_pool_slab_t {
+  struct iree_hal_task_queue_pool_slab_t* next;
+  iree_byte_span_t storage;
+  // Free ranges in ascending offset order.
+  iree_hal_task_queue_pool_range_t* free_ranges;
+  // Total number of allocations referencing the slab that have not been
+  // returned to the pool.
+  iree_host_size_t live_count;
+} iree_hal_task_queue_pool_slab_t;
+
+// A buffer allocated from the pool.
+// Lives as long as the buffer handle and retains the pool. Recovered from the
+// buffer handle via the user data of its release callback.
+typedef struct iree_hal_task_queue_pool_allocation_t {
+  iree_hal_task_queue_pool_t* pool;
+  // Slab the allocation was made from or NULL once returned to the pool.
+  iree_hal_task_queue_pool_slab_t* slab;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_task_queue_pool_allocation_t;
+
+struct iree_hal_task_queue_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_device_size_t slab_size;
+
+  // Guards all pool state below as allocations may be made from the host and
+  // returned from any thread.
+  iree_slim_mutex_t mutex;
+
+  // All slabs in the pool in creation order.
+  iree_hal_task_queue_pool_slab_t* slabs;
+
+  // Unused range structures available for reuse.
+  iree_hal_task_queue_pool_range_t* spare_ranges;
+};
+
+iree_status_t iree_hal_task_queue_pool_create(
+    iree_device_size_t slab_size, iree_allocator_t host_allocator,
+    iree_hal_task_queue_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_task_queue_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  memset(pool, 0, sizeof(*pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->slab_size = iree_device_align(
+      iree_max(slab_size, IREE_HAL_TASK_QUEUE_POOL_SLAB_ALIGNMENT),
+      IREE_HAL_TASK_QUEUE_POOL_SLAB_ALIGNMENT);
+  iree_slim_mutex_initialize(&pool->mutex);
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Releases the timepoint of |range|, if any, marking it as unused.
+static void iree_hal_task_queue_pool_range_reset_timepoint(
+    iree_hal_task_queue_pool_range_t* range) {
+  iree_hal_semaphore_release(range->semaphore);
+  range->semaphore = NULL;
+  range->value = 0;
+}
+
+static void iree_hal_task_queue_pool_destroy(iree_hal_task_queue_pool_t* pool) {
+  iree_allocator_t host_allocator = pool->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // All allocations retain the pool and as such there can be none live here.
+  iree_hal_task_queue_pool_slab_t* slab = pool->slabs;
+  while (slab) {
+    iree_hal_task_queue_pool_slab_t* next_slab = slab->next;
+    iree_hal_task_queue_pool_range_t* range = slab->free_ranges;
+    while (range) {
+      iree_hal_task_queue_pool_range_t* next_range = range->next;
+      iree_hal_task_queue_pool_range_reset_timepoint(range);
+      iree_allocator_free(host_allocator, range);
+      range = next_range;
+    }
+    iree_allocator_free_aligned(host_allocator, slab->storage.data);
+    iree_allocator_free(host_allocator, slab);
+    slab = next_slab;
+  }
+  iree_hal_task_queue_pool_range_t* range = pool->spare_ranges;
+  while (range) {
+    iree_hal_task_queue_pool_range_t* next_range = range->next;
+    iree_allocator_free(host_allocator, range);
+    range = next_range;
+  }
+
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_task_queue_pool_retain(iree_hal_task_queue_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_task_queue_pool_release(iree_hal_task_queue_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_task_queue_pool_destroy(pool);
+  }
+}
+
+// Acquires a range structure from the spare list or the host allocator.
+// Must be called with the pool lock held.
+static iree_status_t iree_hal_task_queue_pool_acquire_range(
+    iree_hal_task_queue_pool_t* pool,
+    iree_hal_task_queue_pool_range_t** out_range) {
+  iree_hal_task_queue_pool_range_t* range = pool->spare_ranges;
+  if (range) {
+    pool->spare_ranges = range->next;
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        pool->host_allocator, sizeof(*range), (void**)&range));
+  }
+  memset(range, 0, sizeof(*range));
+  *out_range = range;
+  return iree_ok_status();
+}
+
+// Returns |range| to the spare list after dropping its timepoint.
+// Must be called with the pool lock held.
+static void iree_hal_task_queue_pool_recycle_range(
+    iree_hal_task_queue_pool_t* pool, iree_hal_task_queue_pool_range_t* range) {
+  iree_hal_task_queue_pool_range_reset_timepoint(range);
+  range->next = pool->spare_ranges;
+  pool->spare_ranges = range;
+}
+
+void iree_hal_task_queue_pool_trim(iree_hal_task_queue_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&pool->mutex);
+
+  iree_hal_task_queue_pool_slab_t** slab_ptr = &pool->slabs;
+  while (*slab_ptr) {
+    iree_hal_task_queue_pool_slab_t* slab = *slab_ptr;
+    iree_hal_task_queue_pool_range_t* range = slab->free_ranges;
+    bool is_unused = slab->live_count == 0 && range && !range->next;
+    if (is_unused && range->semaphore) {
+      // Failed semaphores never reach their timepoint and keep the slab live.
+      uint64_t current_value = 0;
+      iree_status_t status =
+          iree_hal_semaphore_query(range->semaphore, &current_value);
+      is_unused = iree_status_is_ok(status) && current_value >= range->value;
+      iree_status_ignore(status);
+    }
+    if (is_unused) {
+      *slab_ptr = slab->next;
+      iree_hal_task_queue_pool_recycle_range(pool, range);
+      iree_allocator_free_aligned(pool->host_allocator, slab->storage.data);
+      iree_allocator_free(pool->host_allocator, slab);
+    } else {
+      slab_ptr = &slab->next;
+    }
+  }
+
+  iree_hal_task_queue_pool_range_t* range = pool->spare_ranges;
+  while (range) {
+    iree_hal_task_queue_pool_range_t* next_range = range->next;
+    iree_allocator_free(pool->host_allocator, range);
+    range = next_range;
+  }
+  pool->spare_ranges = NULL;
+
+  iree_slim_mutex_unlock(&pool->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns true if the memory in |range| may be used by an operation waiting on
+// |wait_semaphore_list|. Ranges whose timepoint has been reached are marked
+// unused for future queries.
+static bool iree_hal_task_queue_pool_range_is_available(
+    iree_hal_task_queue_pool_range_t* range,
+    const iree_hal_semaphore_list_t* wait_semaphore_list) {
+  if (!range->semaphore) return true;
+
+  // Queue ordering guarantees the operation happens after the deallocation if
+  // it waits on the same timeline at or after the deallocation signal.
+  for (iree_host_size_t i = 0; i < wait_semaphore_list->count; ++i) {
+    if (wait_semaphore_list->semaphores[i] == range->semaphore &&
+        wait_semaphore_list->payload_values[i] >= range->value) {
+      return true;
+    }
+  }
+
+  // Otherwise only if the deallocation has already happened. Failed semaphores
+  // are treated as never reaching their timepoint as operations prior to the
+  // deallocation may still be using the memory.
+  uint64_t current_value = 0;
+  iree_status_t status =
+      iree_hal_semaphore_query(range->semaphore, &current_value);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  if (current_value < range->value) return false;
+  iree_hal_task_queue_pool_range_reset_timepoint(range);
+  return true;
+}
+
+// Inserts a free range of |length| bytes at |offset| into |slab| that becomes
+// unused at the given timepoint. Adjacent ranges with the same timepoint are
+// merged. Must be called with the pool lock held.
+static iree_status_t iree_hal_task_queue_pool_insert_range(
+    iree_hal_task_queue_pool_t* pool, iree_hal_task_queue_pool_slab_t* slab,
+    iree_device_size_t offset, iree_device_size_t length,
+    iree_hal_semaphore_t* semaphore, uint64_t value) {
+  iree_hal_task_queue_pool_range_t* prev = NULL;
+  iree_hal_task_queue_pool_range_t* next = slab->free_ranges;
+  while (next && next->offset < offset) {
+    prev = next;
+    next = next->next;
+  }
+
+  // Merge with the ranges on either side if they become unused at the same
+  // time. Ranges on the same timeline can be merged by taking the later value.
+  bool merge_prev = prev && prev->offset + prev->length == offset &&
+                    prev->semaphore == semaphore;
+  bool merge_next =
+      next && offset + length == next->offset && next->semaphore == semaphore;
+  if (merge_prev) {
+    prev->length += length;
+    prev->value = iree_max(prev->value, value);
+    if (merge_next) {
+      prev->length += next->length;
+      prev->value = iree_max(prev->value, next->value);
+      prev->next = next->next;
+      iree_hal_task_queue_pool_recycle_range(pool, next);
+    }
+    return iree_ok_status();
+  } else if (merge_next) {
+    next->offset = offset;
+    next->length += length;
+    next->value = iree_max(next->value, value);
+    return iree_ok_status();
+  }
+
+  iree_hal_task_queue_pool_range_t* range = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_queue_pool_acquire_range(pool, &range));
+  range->offset = offset;
+  range->length = length;
+  range->semaphore = semaphore;
+  iree_hal_semaphore_retain(range->semaphore);
+  range->value = value;
+  range->next = next;
+  if (prev) {
+    prev->next = range;
+  } else {
+    slab->free_ranges = range;
+  }
+  return iree_ok_status();
+}
+
+// Adds a new slab to the pool with storage for at least |min_length| bytes.
+// Must be called with the pool lock held.
+static iree_status_t iree_hal_task_queue_pool_grow(
+    iree_hal_task_queue_pool_t* pool, iree_device_size_t min_length,
+    iree_hal_task_queue_pool_slab_t** out_slab) {
+  iree_device_size_t slab_length = iree_device_align(
+      iree_max(pool->slab_size, min_length), pool->slab_size);
+  if (slab_length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "slab size %" PRIdsz " exceeds host memory",
+                            slab_length);
+  }
+
+  iree_hal_task_queue_pool_slab_t* slab = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(pool->host_allocator,
+                                             sizeof(*slab), (void**)&slab));
+  memset(slab, 0, sizeof(*slab));
+  iree_status_t status = iree_allocator_malloc_aligned(
+      pool->host_allocator, (iree_host_size_t)slab_length,
+      IREE_HAL_TASK_QUEUE_POOL_SLAB_ALIGNMENT, 0, (void**)&slab->storage.data);
+  if (iree_status_is_ok(status)) {
+    slab->storage.data_length = (iree_host_size_t)slab_length;
+    status = iree_hal_task_queue_pool_insert_range(pool, slab, 0, slab_length,
+                                                   NULL, 0);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free_aligned(pool->host_allocator, slab->storage.data);
+    iree_allocator_free(pool->host_allocator, slab);
+    return status;
+  }
+
+  // Slabs are appended such that older slabs are preferred and newer ones can
+  // drain and be trimmed.
+  iree_hal_task_queue_pool_slab_t** slab_ptr = &pool->slabs;
+  while (*slab_ptr) slab_ptr = &(*slab_ptr)->next;
+  *slab_ptr = slab;
+
+  *out_slab = slab;
+  return iree_ok_status();
+}
+
+// Carves |length| bytes aligned to |alignment| out of |range| in |slab|,
+// leaving any leading or trailing bytes as free ranges with the same
+// timepoint. Must be called with the pool lock held.
+static iree_status_t iree_hal_task_queue_pool_split_range(
+    iree_hal_task_queue_pool_t* pool, iree_hal_task_queue_pool_slab_t* slab,
+    iree_hal_task_queue_pool_range_t* range, iree_device_size_t alignment,
+    iree_device_size_t length, iree_device_size_t* out_offset) {
+  iree_device_size_t offset = iree_device_align(range->offset, alignment);
+  iree_device_size_t range_end = range->offset + range->length;
+  iree_device_size_t end = offset + length;
+
+  // Reserve the storage for the trailing range first so that failure leaves the
+  // range untouched.
+  iree_hal_task_queue_pool_range_t* tail = NULL;
+  if (end < range_end) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_queue_pool_acquire_range(pool, &tail));
+    tail->offset = end;
+    tail->length = range_end - end;
+    tail->semaphore = range->semaphore;
+    iree_hal_semaphore_retain(tail->semaphore);
+    tail->value = range->value;
+    tail->next = range->next;
+    range->next = tail;
+  }
+
+  if (offset > range->offset) {
+    // Keep the leading bytes in the existing range.
+    range->length = offset - range->offset;
+  } else {
+    // Unlink the range as it has been fully consumed.
+    iree_hal_task_queue_pool_range_t** range_ptr = &slab->free_ranges;
+    while (*range_ptr != range) range_ptr = &(*range_ptr)->next;
+    *range_ptr = range->next;
+    iree_hal_task_queue_pool_recycle_range(pool, range);
+  }
+
+  *out_offset = offset;
+  return iree_ok_status();
+}
+
+// Finds and reserves |length| bytes aligned to |alignment| that may be used by
+// an operation waiting on |wait_semaphore_list|, growing the pool if needed.
+// Must be called with the pool lock held.
+static iree_status_t iree_hal_task_queue_pool_reserve(
+    iree_hal_task_queue_pool_t* pool,
+    const iree_hal_semaphore_list_t* wait_semaphore_list,
+    iree_device_size_t alignment, iree_device_size_t length,
+    iree_hal_task_queue_pool_slab_t** out_slab,
+    iree_device_size_t* out_offset) {
+  // First-fit across all slabs in creation order.
+  for (iree_hal_task_queue_pool_slab_t* slab = pool->slabs; slab;
+       slab = slab->next) {
+    for (iree_hal_task_queue_pool_range_t* range = slab->free_ranges; range;
+         range = range->next) {
+      iree_device_size_t offset = iree_device_align(range->offset, alignment);
+      if (offset + length > range->offset + range->length) continue;
+      if (!iree_hal_task_queue_pool_range_is_available(range,
+                                                       wait_semaphore_list)) {
+        continue;
+      }
+      *out_slab = slab;
+      return iree_hal_task_queue_pool_split_range(pool, slab, range, alignment,
+                                                  length, out_offset);
+    }
+  }
+
+  // No existing memory can be used so grow the pool. The new slab starts at
+  // the slab alignment which satisfies all supported alignments.
+  iree_hal_task_queue_pool_slab_t* slab = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_queue_pool_grow(pool, length, &slab));
+  *out_slab = slab;
+  return iree_hal_task_queue_pool_split_range(pool, slab, slab->free_ranges,
+                                              alignment, length, out_offset);
+}
+
+// Returns the range of |allocation| to its slab, becoming unused once
+// |semaphore| reaches |value| (or immediately if NULL).
+// Must be called with the pool lock held.
+static void iree_hal_task_queue_pool_return_allocation(
+    iree_hal_task_queue_pool_t* pool,
+    iree_hal_task_queue_pool_allocation_t* allocation,
+    iree_hal_semaphore_t* semaphore, uint64_t value) {
+  // NOTE: if we fail to insert the range (out of host memory) the slab range
+  // is leaked until the pool is destroyed.
+  iree_status_ignore(iree_hal_task_queue_pool_insert_range(
+      pool, allocation->slab, allocation->offset, allocation->length, semaphore,
+      value));
+  --allocation->slab->live_count;
+  allocation->slab = NULL;
+}
+
+// Called when a buffer allocated from the pool is destroyed.
+static void iree_hal_task_queue_pool_buffer_release(void* user_data,
+                                                    iree_hal_buffer_t* buffer) {
+  iree_hal_task_queue_pool_allocation_t* allocation =
+      (iree_hal_task_queue_pool_allocation_t*)user_data;
+  iree_hal_task_queue_pool_t* pool = allocation->pool;
+
+  // If not deallocated via the queue then the memory can be reused
+  // immediately: all queue operations retain the buffers they use and there
+  // can be no outstanding uses.
+  iree_slim_mutex_lock(&pool->mutex);
+  if (allocation->slab) {
+    iree_hal_task_queue_pool_return_allocation(pool, allocation, NULL, 0);
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_allocator_free(pool->host_allocator, allocation);
+  iree_hal_task_queue_pool_release(pool);
+}
+
+iree_status_t iree_hal_task_queue_pool_allocate(
+    iree_hal_task_queue_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+
+  // Only service allocations the device allocator could make itself. The
+  // device allocator canonicalizes the parameters and we use its results such
+  // that pooled buffers are indistinguishable from ones it allocates.
+  iree_hal_buffer_params_canonicalize(&params);
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_allocator_query_buffer_compatibility(
+          device_allocator, params, allocation_size, &params, &allocation_size);
+  if (!iree_all_bits_set(compatibility,
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE) ||
+      allocation_size == 0) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  iree_device_size_t alignment =
+      iree_max(params.min_alignment, IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+  if (alignment > IREE_HAL_TASK_QUEUE_POOL_SLAB_ALIGNMENT ||
+      !iree_device_size_is_power_of_two(alignment) ||
+      allocation_size > IREE_DEVICE_SIZE_MAX - alignment) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  iree_device_size_t length = iree_device_align(allocation_size, alignment);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
+
+  iree_hal_task_queue_pool_allocation_t* allocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(pool->host_allocator, sizeof(*allocation),
+                                (void**)&allocation));
+  memset(allocation, 0, sizeof(*allocation));
+  allocation->pool = pool;
+  allocation->length = length;
+
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_status_t status = iree_hal_task_queue_pool_reserve(
+      pool, &wait_semaphore_list, alignment, length, &allocation->slab,
+      &allocation->offset);
+  if (iree_status_is_ok(status)) {
+    ++allocation->slab->live_count;
+  }
+
+  // Wrap the range as a heap buffer that returns it to the pool on release.
+  // This is done under the lock such that a failure can be unwound before any
+  // other allocation could reuse the range.
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_hal_task_queue_pool_buffer_release,
+        .user_data = allocation,
+    };
+    status = iree_hal_heap_buffer_wrap(
+        device_allocator, params.type, params.access, params.usage,
+        allocation_size,
+        iree_make_byte_span(
+            allocation->slab->storage.data + allocation->offset,
+            (iree_host_size_t)allocation_size),
+        release_callback, &buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_task_queue_pool_return_allocation(pool, allocation, NULL, 0);
+    }
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_task_queue_pool_retain(pool);
+    *out_buffer = buffer;
+  } else {
+    iree_allocator_free(pool->host_allocator, allocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_task_queue_pool_deallocate(
+    iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_buffer_release_callback_t release_callback =
+      iree_hal_heap_buffer_release_callback(buffer);
+  if (release_callback.fn != iree_hal_task_queue_pool_buffer_release) {
+    return false;
+  }
+  iree_hal_task_queue_pool_allocation_t* allocation =
+      (iree_hal_task_queue_pool_allocation_t*)release_callback.user_data;
+  iree_hal_task_queue_pool_t* pool = allocation->pool;
+
+  iree_slim_mutex_lock(&pool->mutex);
+  bool is_live = allocation->slab != NULL;
+  if (is_live && signal_semaphore_list.count > 0) {
+    // All signals happen together once the deallocation executes so any one
+    // of them can be used to order reuse.
+    iree_hal_task_queue_pool_return_allocation(
+        pool, allocation, signal_semaphore_list.semaphores[0],
+        signal_semaphore_list.payload_values[0]);
+  }
+  // NOTE: with no signals we can't tell when the deallocation executes and
+  // the memory is returned when the buffer is released instead.
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  return is_live;
+}
@@ -0,0 +1,81 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_LOCAL_TASK_TASK_QUEUE_POOL_H_
+#define IREE_HAL_DRIVERS_LOCAL_TASK_TASK_QUEUE_POOL_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Alignment of the pool slab storage. Allocations requiring a larger alignment
+// bypass the pool.
+#define IREE_HAL_TASK_QUEUE_POOL_SLAB_ALIGNMENT 4096
+
+// A stream-ordered suballocating pool used for queue-ordered allocations.
+//
+// Memory is suballocated from large host slabs and handed out as heap buffers
+// immediately when an allocation is requested such that callers never need to
+// block on the queue. Deallocations return their memory to the pool tagged
+// with the semaphore timepoint the deallocation signals. Subsequent
+// allocations may reuse that memory once the timepoint has been reached or if
+// they themselves wait on (or after) the timepoint: queue ordering then
+// guarantees that all prior uses have completed before any new use begins.
+// This allows the memory freed by one pipelined request to be reused by the
+// next without any host synchronization.
+//
+// Thread-safe. The pool is reference counted and retained by all live
+// allocations such that buffers may outlive the queue that created them.
+typedef struct iree_hal_task_queue_pool_t iree_hal_task_queue_pool_t;
+
+// Creates a pool that allocates slabs of at least |slab_size| bytes.
+iree_status_t iree_hal_task_queue_pool_create(
+    iree_device_size_t slab_size, iree_allocator_t host_allocator,
+    iree_hal_task_queue_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_task_queue_pool_retain(iree_hal_task_queue_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+void iree_hal_task_queue_pool_release(iree_hal_task_queue_pool_t* pool);
+
+// Releases all slabs with no live or pending allocations.
+void iree_hal_task_queue_pool_trim(iree_hal_task_queue_pool_t* pool);
+
+// Allocates a buffer of |allocation_size| bytes from the pool that may be used
+// by queue operations waiting on |wait_semaphore_list|. The buffer is returned
+// immediately and may reuse memory deallocated by prior operations that the
+// waits are ordered after. |device_allocator| is used to validate |params| and
+// is referenced by the returned buffer.
+//
+// Returns IREE_STATUS_UNAVAILABLE if the allocation cannot be serviced from the
+// pool and should be allocated directly from the device allocator instead.
+iree_status_t iree_hal_task_queue_pool_allocate(
+    iree_hal_task_queue_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Returns the memory of |buffer| to the pool it was allocated from once
+// |signal_semaphore_list| has been signaled. The buffer handle may remain live
+// but its contents are undefined once the signal has been reached.
+//
+// Returns false if |buffer| was not allocated from a pool or has already been
+// deallocated.
+bool iree_hal_task_queue_pool_deallocate(
+    iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t signal_semaphore_list);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_LOCAL_TASK_TASK_QUEUE_POOL_H_
@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/wait_handle.h"
 #include "iree/hal/utils/semaphore_base.h"
@@ -196,6 +197,23 @@ static void iree_hal_task_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
                             status_code);
 }
 
+// Registers a timepoint waiting for the given value that sets the event
+// already stored in |timepoint|.
+// |timepoint| is owned by the caller and must be kept live until the
+// timepoint has been reached (or it is cancelled by the caller).
+static void iree_hal_task_semaphore_register_timepoint(
+    iree_hal_task_semaphore_t* semaphore, uint64_t minimum_value,
+    iree_timeout_t timeout, iree_hal_task_timepoint_t* timepoint) {
+  timepoint->semaphore = &semaphore->base;
+  iree_hal_semaphore_acquire_timepoint(
+      &semaphore->base, minimum_value, timeout,
+      (iree_hal_semaphore_callback_t){
+          .fn = iree_hal_task_semaphore_timepoint_callback,
+          .user_data = timepoint,
+      },
+      &timepoint->base);
+}
+
 // Acquires a timepoint waiting for the given value.
 // |out_timepoint| is owned by the caller and must be kept live until the
 // timepoint has been reached (or it is cancelled by the caller).
@@ -204,20 +222,16 @@ static iree_status_t iree_hal_task_semaphore_acquire_timepoint(
     iree_timeout_t timeout, iree_hal_task_timepoint_t* out_timepoint) {
   IREE_RETURN_IF_ERROR(
       iree_event_pool_acquire(semaphore->event_pool, 1, &out_timepoint->event));
-  out_timepoint->semaphore = &semaphore->base;
-  iree_hal_semaphore_acquire_timepoint(
-      &semaphore->base, minimum_value, timeout,
-      (iree_hal_semaphore_callback_t){
-          .fn = iree_hal_task_semaphore_timepoint_callback,
-          .user_data = out_timepoint,
-      },
-      &out_timepoint->base);
+  iree_hal_task_semaphore_register_timepoint(semaphore, minimum_value, timeout,
+                                             out_timepoint);
   return iree_ok_status();
 }
 
 typedef struct iree_hal_task_semaphore_wait_cmd_t {
   iree_task_wait_t task;
   iree_hal_task_semaphore_t* semaphore;
+  // Pool the timepoint event is returned to.
+  iree_event_pool_t* event_pool;
   iree_hal_task_timepoint_t timepoint;
 } iree_hal_task_semaphore_wait_cmd_t;
 
@@ -233,34 +247,72 @@ static void iree_hal_task_semaphore_wait_cmd_cleanup(
     iree_hal_semaphore_cancel_timepoint(&cmd->semaphore->base,
                                         &cmd->timepoint.base);
   }
-  iree_event_pool_release(cmd->semaphore->event_pool, 1, &cmd->timepoint.event);
+  iree_event_pool_release(cmd->event_pool, 1, &cmd->timepoint.event);
   iree_hal_semaphore_release((iree_hal_semaphore_t*)cmd->semaphore);
 }
 
-iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
-    iree_hal_semaphore_t* base_semaphore, uint64_t minimum_value,
-    iree_task_t* issue_task, iree_arena_allocator_t* arena,
+iree_status_t iree_hal_task_semaphore_enqueue_timepoints(
+    const iree_hal_semaphore_list_t semaphore_list, iree_task_t* issue_task,
+    iree_event_pool_t* event_pool, iree_arena_allocator_t* arena,
     iree_task_submission_t* submission) {
-  iree_hal_task_semaphore_t* semaphore =
-      iree_hal_task_semaphore_cast(base_semaphore);
+  IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_slim_mutex_lock(&semaphore->mutex);
+  // Count the timepoints not yet reached so that the events for all of them
+  // can be acquired from the pool at once. Semaphores may be signaled after
+  // this but never go backwards so this is an upper bound.
+  iree_host_size_t pending_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_task_semaphore_t* semaphore =
+        iree_hal_task_semaphore_cast(semaphore_list.semaphores[i]);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    if (semaphore->current_value < semaphore_list.payload_values[i]) {
+      ++pending_count;
+    }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+  }
+  if (pending_count == 0) {
+    // Fast path: all already satisfied.
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, pending_count);
 
-  iree_status_t status = iree_ok_status();
-  if (semaphore->current_value >= minimum_value) {
-    // Fast path: already satisfied.
-  } else if (!iree_status_is_ok(semaphore->failure_status)) {
-    // Semaphore failed; can't enqueue timepoints (they'll reject immediately).
-    status = iree_status_clone(semaphore->failure_status);
-  } else {
-    // Slow path: acquire a system wait handle and perform a full wait.
-    iree_hal_task_semaphore_wait_cmd_t* cmd = NULL;
-    status = iree_arena_allocate(arena, sizeof(*cmd), (void**)&cmd);
-    if (iree_status_is_ok(status)) {
-      status = iree_hal_task_semaphore_acquire_timepoint(
+  // Slow path: acquire system wait handles and perform full waits.
+  iree_hal_task_semaphore_wait_cmd_t* cmds = NULL;
+  iree_status_t status = iree_arena_allocate(
+      arena, pending_count * sizeof(*cmds), (void**)&cmds);
+  iree_event_t* events = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_arena_allocate(arena, pending_count * sizeof(*events),
+                                 (void**)&events);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_event_pool_acquire(event_pool, pending_count, events);
+  }
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  iree_host_size_t used_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_task_semaphore_t* semaphore =
+        iree_hal_task_semaphore_cast(semaphore_list.semaphores[i]);
+    const uint64_t minimum_value = semaphore_list.payload_values[i];
+    iree_slim_mutex_lock(&semaphore->mutex);
+    if (semaphore->current_value >= minimum_value) {
+      // Fast path: already satisfied.
+    } else if (!iree_status_is_ok(semaphore->failure_status)) {
+      // Semaphore failed; can't enqueue timepoints (they'll reject
+      // immediately).
+      status = iree_status_clone(semaphore->failure_status);
+    } else {
+      IREE_ASSERT_LT(used_count, pending_count);
+      iree_hal_task_semaphore_wait_cmd_t* cmd = &cmds[used_count];
+      cmd->timepoint.event = events[used_count];
+      ++used_count;
+      iree_hal_task_semaphore_register_timepoint(
           semaphore, minimum_value, iree_infinite_timeout(), &cmd->timepoint);
-    }
-    if (iree_status_is_ok(status)) {
       iree_task_wait_initialize(issue_task->scope,
                                 iree_event_await(&cmd->timepoint.event),
                                 IREE_TIME_INFINITE_FUTURE, &cmd->task);
@@ -268,12 +320,20 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
                                iree_hal_task_semaphore_wait_cmd_cleanup);
       iree_task_set_completion_task(&cmd->task.header, issue_task);
       cmd->semaphore = semaphore;
-      iree_hal_semaphore_retain(base_semaphore);
+      cmd->event_pool = event_pool;
+      iree_hal_semaphore_retain(&semaphore->base);
       iree_task_submission_enqueue(submission, &cmd->task.header);
     }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    if (!iree_status_is_ok(status)) break;
   }
 
-  iree_slim_mutex_unlock(&semaphore->mutex);
+  // Return the events of timepoints reached after they were counted. Events
+  // that were used are released by the wait task cleanup.
+  iree_event_pool_release(event_pool, pending_count - used_count,
+                          events + used_count);
+
+  IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
@@ -321,6 +381,44 @@ static iree_status_t iree_hal_task_semaphore_wait(
   return status;
 }
 
+// Shared by all timepoints of a multi-wait such that the waiter blocks on a
+// single event regardless of how many semaphores it is waiting on.
+typedef struct iree_hal_task_multi_wait_state_t {
+  // Set when the wait is satisfied or any timepoint fails.
+  iree_event_t event;
+  // Number of timepoints that must be reached before |event| is set.
+  iree_atomic_int32_t remaining_count;
+  // Status code of the first timepoint that failed or IREE_STATUS_OK.
+  iree_atomic_int32_t status_code;
+} iree_hal_task_multi_wait_state_t;
+
+// A timepoint of a multi-wait on |semaphore|.
+typedef struct iree_hal_task_multi_wait_timepoint_t {
+  iree_hal_semaphore_timepoint_t base;
+  iree_hal_semaphore_t* semaphore;
+} iree_hal_task_multi_wait_timepoint_t;
+
+// Handles multi-wait timepoint callbacks by counting down the timepoints
+// remaining and setting the shared event when the wait is satisfied. Failures
+// set the event immediately so that waiters can bail early.
+static iree_status_t iree_hal_task_semaphore_multi_wait_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  iree_hal_task_multi_wait_state_t* state =
+      (iree_hal_task_multi_wait_state_t*)user_data;
+  if (status_code != IREE_STATUS_OK) {
+    int32_t expected = IREE_STATUS_OK;
+    iree_atomic_compare_exchange_strong_int32(
+        &state->status_code, &expected, (int32_t)status_code,
+        iree_memory_order_acq_rel, iree_memory_order_relaxed);
+    iree_event_set(&state->event);
+  } else if (iree_atomic_fetch_sub_int32(&state->remaining_count, 1,
+                                         iree_memory_order_acq_rel) == 1) {
+    iree_event_set(&state->event);
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
@@ -337,64 +435,90 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
 
   iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
 
-  // Avoid heap allocations by using the device block pool for the wait set.
+  // Avoid heap allocations by using the device block pool for the timepoints.
   iree_arena_allocator_t arena;
   iree_arena_initialize(block_pool, &arena);
-  iree_wait_set_t* wait_set = NULL;
-  iree_status_t status = iree_wait_set_allocate(
-      semaphore_list.count, iree_arena_allocator(&arena), &wait_set);
-
-  // Acquire a wait handle for each semaphore timepoint we are to wait on.
-  // TODO(benvanik): flip this API around so we can batch request events from
-  // the event pool. We should be acquiring all required time points in one
-  // call.
   iree_host_size_t timepoint_count = 0;
-  iree_hal_task_timepoint_t* timepoints = NULL;
-  iree_host_size_t total_timepoint_size =
-      semaphore_list.count * sizeof(timepoints[0]);
-  status =
-      iree_arena_allocate(&arena, total_timepoint_size, (void**)&timepoints);
-  if (iree_status_is_ok(status)) {
-    memset(timepoints, 0, total_timepoint_size);
-    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
-      iree_hal_task_semaphore_t* semaphore =
-          iree_hal_task_semaphore_cast(semaphore_list.semaphores[i]);
-      iree_slim_mutex_lock(&semaphore->mutex);
-      if (semaphore->current_value >= semaphore_list.payload_values[i]) {
-        // Fast path: already satisfied.
-      } else {
-        // Slow path: get a native wait handle for the timepoint.
-        iree_hal_task_timepoint_t* timepoint = &timepoints[timepoint_count++];
-        status = iree_hal_task_semaphore_acquire_timepoint(
-            semaphore, semaphore_list.payload_values[i], timeout, timepoint);
-        if (iree_status_is_ok(status)) {
-          status = iree_wait_set_insert(wait_set, timepoint->event);
+  iree_hal_task_multi_wait_timepoint_t* timepoints = NULL;
+  iree_status_t status = iree_arena_allocate(
+      &arena, semaphore_list.count * sizeof(timepoints[0]),
+      (void**)&timepoints);
+
+  // All timepoints share one event that is acquired when the first unsatisfied
+  // timepoint is found. The remaining count starts with an extra reference
+  // held while registering so that the event is not set until all timepoints
+  // have been registered.
+  iree_hal_task_multi_wait_state_t state;
+  bool has_event = false;
+  iree_atomic_store_int32(&state.remaining_count, 1, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&state.status_code, IREE_STATUS_OK,
+                          iree_memory_order_relaxed);
+  bool satisfied = false;
+  for (iree_host_size_t i = 0;
+       i < semaphore_list.count && iree_status_is_ok(status); ++i) {
+    iree_hal_task_semaphore_t* semaphore =
+        iree_hal_task_semaphore_cast(semaphore_list.semaphores[i]);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    if (semaphore->current_value >= semaphore_list.payload_values[i]) {
+      // Fast path: already satisfied. Waits for any semaphore are done.
+      satisfied = wait_mode == IREE_HAL_WAIT_MODE_ANY;
+    } else {
+      // Slow path: register a timepoint signaling the shared event.
+      if (!has_event) {
+        status = iree_event_pool_acquire(event_pool, 1, &state.event);
+        has_event = iree_status_is_ok(status);
+      }
+      if (iree_status_is_ok(status)) {
+        if (wait_mode == IREE_HAL_WAIT_MODE_ALL) {
+          iree_atomic_fetch_add_int32(&state.remaining_count, 1,
+                                      iree_memory_order_relaxed);
         }
+        iree_hal_task_multi_wait_timepoint_t* timepoint =
+            &timepoints[timepoint_count++];
+        timepoint->semaphore = &semaphore->base;
+        iree_hal_semaphore_acquire_timepoint(
+            &semaphore->base, semaphore_list.payload_values[i], timeout,
+            (iree_hal_semaphore_callback_t){
+                .fn = iree_hal_task_semaphore_multi_wait_callback,
+                .user_data = &state,
+            },
+            &timepoint->base);
       }
-      iree_slim_mutex_unlock(&semaphore->mutex);
-      if (!iree_status_is_ok(status)) break;
     }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    if (satisfied) break;
+  }
+
+  // Drop the registration reference; waits for all semaphores are satisfied
+  // if every timepoint was either already reached or has since been reached.
+  if (iree_status_is_ok(status) && wait_mode == IREE_HAL_WAIT_MODE_ALL &&
+      iree_atomic_fetch_sub_int32(&state.remaining_count, 1,
+                                  iree_memory_order_acq_rel) == 1) {
+    satisfied = true;
   }
 
   // Perform the wait.
-  if (iree_status_is_ok(status)) {
-    if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
-      status = iree_wait_any(wait_set, deadline_ns, /*out_wake_handle=*/NULL);
-    } else {
-      status = iree_wait_all(wait_set, deadline_ns);
-    }
+  if (iree_status_is_ok(status) && !satisfied) {
+    status = iree_wait_one(&state.event, deadline_ns);
   }
 
-  // TODO(benvanik): if we flip the API to multi-acquire events from the pool
-  // above then we can multi-release here too.
+  // Cancel any timepoints not yet reached. Callbacks are issued under the
+  // semaphore timepoint lock and after this none can reference |state|.
   for (iree_host_size_t i = 0; i < timepoint_count; ++i) {
-    iree_hal_semaphore_t* semaphore = timepoints[i].semaphore;
-    if (semaphore) {
-      iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i].base);
-      iree_event_pool_release(event_pool, 1, &timepoints[i].event);
+    iree_hal_semaphore_cancel_timepoint(timepoints[i].semaphore,
+                                        &timepoints[i].base);
+  }
+  if (iree_status_is_ok(status) && !satisfied) {
+    iree_status_code_t status_code = (iree_status_code_t)iree_atomic_load_int32(
+        &state.status_code, iree_memory_order_acquire);
+    if (status_code == IREE_STATUS_DEADLINE_EXCEEDED) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    } else if (status_code != IREE_STATUS_OK) {
+      // Failed; return an error to tell callers to query for it.
+      status = iree_status_from_code(IREE_STATUS_ABORTED);
     }
   }
-  iree_wait_set_free(wait_set);
+  if (has_event) iree_event_pool_release(event_pool, 1, &state.event);
   iree_arena_deinitialize(&arena);
 
   IREE_TRACE_ZONE_END(z0);
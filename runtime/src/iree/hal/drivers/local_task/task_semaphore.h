@@ -29,19 +29,22 @@ iree_status_t iree_hal_task_semaphore_create(
 // Returns true if |semaphore| is a task system semaphore.
 bool iree_hal_task_semaphore_isa(iree_hal_semaphore_t* semaphore);
 
-// Reserves a new timepoint in the timeline for the given minimum payload value.
-// |issue_task| will wait until the timeline semaphore is signaled to at least
-// |minimum_value| before proceeding, with a possible wait task generated and
-// appended to the |submission|. Allocations for any intermediates will be made
-// from |arena| whose lifetime must be tied to the submission.
-iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
-    iree_hal_semaphore_t* semaphore, uint64_t minimum_value,
-    iree_task_t* issue_task, iree_arena_allocator_t* arena,
+// Reserves new timepoints in the timelines of all semaphores in
+// |semaphore_list| for their given minimum payload values. |issue_task| will
+// wait until each timeline semaphore is signaled to at least its value before
+// proceeding, with possible wait tasks generated and appended to the
+// |submission|. Events for all wait tasks are acquired from |event_pool| at
+// once. Allocations for any intermediates will be made from |arena| whose
+// lifetime must be tied to the submission.
+iree_status_t iree_hal_task_semaphore_enqueue_timepoints(
+    const iree_hal_semaphore_list_t semaphore_list, iree_task_t* issue_task,
+    iree_event_pool_t* event_pool, iree_arena_allocator_t* arena,
     iree_task_submission_t* submission);
 
 // Performs a multi-wait on one or more semaphores.
+// The waiting thread blocks on a single event shared by all semaphores.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
-// |deadline_ns| elapses.
+// |deadline_ns| elapses and IREE_STATUS_ABORTED if any semaphore fails.
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
@@ -20,6 +20,7 @@
 // Fields taken from the ELF headers used only during verification and loading.
 typedef struct iree_elf_module_load_state_t {
   iree_memory_info_t memory_info;
+  iree_memory_view_flags_t view_flags;
   const iree_elf_ehdr_t* ehdr;
   const iree_elf_phdr_t* phdr_table;  // ehdr.e_phnum has count
   const iree_elf_shdr_t* shdr_table;  // ehdr.e_shnum has count
@@ -240,11 +241,18 @@ static iree_status_t iree_elf_module_load_segments(
 
   // Reserve virtual address space in the host memory space. This memory is
   // uncommitted by default as the ELF may only sparsely use the address space.
-  module->vaddr_size = iree_page_align_end(
-      vaddr_range.length, load_state->memory_info.normal_page_size);
+  // When using large pages the reservation is padded out to the large page
+  // granularity so that the tail of the last segment can use a large page.
+  iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  if ((load_state->view_flags & IREE_MEMORY_VIEW_FLAG_LARGE_PAGES) &&
+      load_state->memory_info.large_page_granularity > page_size) {
+    page_size = load_state->memory_info.large_page_granularity;
+  }
+  module->vaddr_size = iree_page_align_end(vaddr_range.length, page_size);
   IREE_RETURN_IF_ERROR(iree_memory_view_reserve(
-      IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE, module->vaddr_size,
-      module->host_allocator, (void**)&module->vaddr_base));
+      IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE | load_state->view_flags,
+      module->vaddr_size, module->host_allocator,
+      (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
 
   // Commit and load all of the segments.
@@ -259,7 +267,7 @@ static iree_status_t iree_elf_module_load_segments(
         .length = phdr->p_memsz,
     };
     IREE_RETURN_IF_ERROR(iree_memory_view_commit_ranges(
-        module->vaddr_bias, 1, &byte_range,
+        load_state->view_flags, module->vaddr_bias, 1, &byte_range,
         IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
 
     // Copy data present in the file.
@@ -572,7 +580,7 @@ static const iree_elf_sym_t* iree_elf_module_lookup_global_symbol(
 
 iree_status_t iree_elf_module_initialize_from_memory(
     iree_const_byte_span_t raw_data,
-    const iree_elf_import_table_t* import_table,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
   IREE_ASSERT_ARGUMENT(raw_data.data);
   IREE_ASSERT_ARGUMENT(out_module);
@@ -592,6 +600,13 @@ iree_status_t iree_elf_module_initialize_from_memory(
   iree_status_t status =
       iree_elf_module_parse_headers(raw_data, &load_state, out_module);
   out_module->host_allocator = host_allocator;
+  load_state.view_flags = IREE_MEMORY_VIEW_FLAG_NONE;
+  if (flags & IREE_ELF_MODULE_FLAG_LARGE_PAGES) {
+    load_state.view_flags |= IREE_MEMORY_VIEW_FLAG_LARGE_PAGES;
+  }
+  if (flags & IREE_ELF_MODULE_FLAG_POPULATE) {
+    load_state.view_flags |= IREE_MEMORY_VIEW_FLAG_POPULATE;
+  }
 
   // Allocate and load the ELF into memory.
   iree_memory_jit_context_begin();
@@ -34,6 +34,22 @@ typedef struct iree_elf_import_table_t {
 // Runtime ELF module loader/linker
 //==============================================================================
 
+// Flags controlling how an ELF module is loaded.
+enum iree_elf_module_flag_bits_t {
+  IREE_ELF_MODULE_FLAG_NONE = 0u,
+
+  // Aligns the module reservation to the large page granularity and requests
+  // that segments be backed by large pages (transparent huge pages on Linux).
+  // Reduces iTLB/dTLB misses for modules with large code or constant segments
+  // at the cost of additional virtual address space. Best-effort.
+  IREE_ELF_MODULE_FLAG_LARGE_PAGES = 1u << 0,
+
+  // Prefaults all segment pages when loading such that the first dispatch
+  // using the module does not take page faults.
+  IREE_ELF_MODULE_FLAG_POPULATE = 1u << 1,
+};
+typedef uint32_t iree_elf_module_flags_t;
+
 // An ELF module mapped directly from memory.
 typedef struct iree_elf_module_t {
   // Allocator used for additional dynamic memory when needed.
@@ -67,6 +83,8 @@ typedef struct iree_elf_module_t {
 // system and initialization will fail if any are not present in the provided
 // table.
 //
+// |flags| controls how the module segments are mapped into memory.
+//
 // Upon return |out_module| is initialized and ready for use with any present
 // .init initialization functions having been executed. To release memory
 // allocated by the module during loading iree_elf_module_deinitialize must be
@@ -74,7 +92,7 @@ typedef struct iree_elf_module_t {
 // loaded module, etc).
 iree_status_t iree_elf_module_initialize_from_memory(
     iree_const_byte_span_t raw_data,
-    const iree_elf_import_table_t* import_table,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module);
 
 // Deinitializes a |module|, releasing any allocated executable or data pages.
@@ -125,6 +125,16 @@ enum iree_memory_view_flag_bits_t {
   // TODO(benvanik): pull from memory_object.h.
   IREE_MEMORY_VIEW_FLAG_NONE = 0u,
 
+  // Requests that the memory be backed by large pages when available.
+  // Reservations are aligned to the large page granularity and committed pages
+  // are advised to use transparent huge pages (MADV_HUGEPAGE) on Linux. This is
+  // best-effort: the system may still back the memory with normal pages.
+  IREE_MEMORY_VIEW_FLAG_LARGE_PAGES = 1u << 0,
+
+  // Prefaults committed pages such that first access does not fault.
+  // Implemented with MAP_POPULATE on Linux and ignored elsewhere.
+  IREE_MEMORY_VIEW_FLAG_POPULATE = 1u << 1,
+
   // Indicates that the memory may be used to execute code.
   // May be used to ask for special privileges (like MAP_JIT on MacOS).
   IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE = 1u << 10,
@@ -152,11 +162,14 @@ void iree_memory_view_release(void* base_address, iree_host_size_t total_length,
 
 // Commits pages overlapping the byte ranges defined by |byte_ranges|.
 // Ranges will be adjusted to the page granularity of the view.
+// |flags| may request large pages or populating the pages upon commit and
+// should match those used when reserving the view.
 //
 // Implemented by VirtualAlloc+MEM_COMMIT/mmap+!PROT_NONE.
 iree_status_t iree_memory_view_commit_ranges(
-    void* base_address, iree_host_size_t range_count,
-    const iree_byte_range_t* ranges, iree_memory_access_t initial_access);
+    iree_memory_view_flags_t flags, void* base_address,
+    iree_host_size_t range_count, const iree_byte_range_t* ranges,
+    iree_memory_access_t initial_access);
 
 // Changes the access protection of view byte ranges defined by |byte_ranges|.
 // Ranges will be adjusted to the page granularity of the view.
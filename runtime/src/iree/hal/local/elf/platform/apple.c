@@ -115,10 +115,14 @@ void iree_memory_view_release(void* base_address, iree_host_size_t total_length,
 }
 
 iree_status_t iree_memory_view_commit_ranges(
-    void* base_address, iree_host_size_t range_count,
-    const iree_byte_range_t* ranges, iree_memory_access_t initial_access) {
+    iree_memory_view_flags_t flags, void* base_address,
+    iree_host_size_t range_count, const iree_byte_range_t* ranges,
+    iree_memory_access_t initial_access) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // NOTE: IREE_MEMORY_VIEW_FLAG_LARGE_PAGES and IREE_MEMORY_VIEW_FLAG_POPULATE
+  // are ignored: superpages are only available via VM_FLAGS_SUPERPAGE_SIZE_2MB
+  // on x86_64 and there is no MAP_POPULATE equivalent.
   int mmap_prot = iree_memory_access_to_prot(initial_access);
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_FIXED;
 
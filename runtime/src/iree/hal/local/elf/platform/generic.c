@@ -57,8 +57,9 @@ void iree_memory_view_release(void* base_address, iree_host_size_t total_length,
 }
 
 iree_status_t iree_memory_view_commit_ranges(
-    void* base_address, iree_host_size_t range_count,
-    const iree_byte_range_t* ranges, iree_memory_access_t initial_access) {
+    iree_memory_view_flags_t flags, void* base_address,
+    iree_host_size_t range_count, const iree_byte_range_t* ranges,
+    iree_memory_access_t initial_access) {
   // No-op.
   return iree_ok_status();
 }
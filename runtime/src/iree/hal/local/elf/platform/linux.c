@@ -9,6 +9,8 @@
 #if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -16,6 +18,21 @@
 // Memory subsystem information and control
 //==============================================================================
 
+// Returns the transparent huge page size in bytes or 0 if transparent huge
+// pages are not supported by the kernel. We query THP instead of using
+// hugetlbfs (gethugepagesize/MAP_HUGETLB) as hugetlbfs pages must be reserved
+// by the system administrator ahead of time while THP is usually available.
+static iree_host_size_t iree_memory_query_transparent_huge_page_size(void) {
+  int fd = open("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size",
+                O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return 0;
+  char buffer[32] = {0};
+  ssize_t read_length = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (read_length <= 0) return 0;
+  return (iree_host_size_t)strtoull(buffer, NULL, 10);
+}
+
 void iree_memory_query_info(iree_memory_info_t* out_info) {
   memset(out_info, 0, sizeof(*out_info));
 
@@ -23,14 +40,16 @@ void iree_memory_query_info(iree_memory_info_t* out_info) {
   out_info->normal_page_size = page_size;
   out_info->normal_page_granularity = page_size;
 
-  // Large pages arent't currently used so we aren't introducing the build goo
-  // to detect and use them yet.
-  // https://linux.die.net/man/3/gethugepagesizes
-  // http://manpages.ubuntu.com/manpages/bionic/man3/gethugepagesize.3.html
-  // Would be:
-  //   #include <hugetlbfs.h>
-  //   out_info->large_page_granularity = gethugepagesize();
-  out_info->large_page_granularity = page_size;
+  // Large pages are provided by transparent huge pages when enabled. If not
+  // available we fall back to the normal page size such that alignment to the
+  // large page granularity is always valid.
+  iree_host_size_t huge_page_size =
+      iree_memory_query_transparent_huge_page_size();
+  out_info->large_page_granularity =
+      huge_page_size > (iree_host_size_t)page_size &&
+              iree_host_size_is_power_of_two(huge_page_size)
+          ? huge_page_size
+          : page_size;
 
   out_info->can_allocate_executable_pages = true;
 }
@@ -61,11 +80,34 @@ iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
   int mmap_prot = PROT_NONE;
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
 
+  // When large pages are requested the base address must be aligned to the
+  // large page granularity so that the kernel can back aligned ranges with huge
+  // pages. mmap only guarantees normal page alignment so we over-reserve and
+  // trim the unaligned head and tail.
+  iree_host_size_t alignment = getpagesize();
+  if (flags & IREE_MEMORY_VIEW_FLAG_LARGE_PAGES) {
+    iree_memory_info_t memory_info;
+    iree_memory_query_info(&memory_info);
+    alignment = memory_info.large_page_granularity;
+  }
+  iree_host_size_t reserve_length = total_length + alignment - getpagesize();
+
   iree_status_t status = iree_ok_status();
-  void* base_address = mmap(NULL, total_length, mmap_prot, mmap_flags, -1, 0);
+  uint8_t* base_address =
+      (uint8_t*)mmap(NULL, reserve_length, mmap_prot, mmap_flags, -1, 0);
   if (base_address == MAP_FAILED) {
     status = iree_make_status(iree_status_code_from_errno(errno),
                               "mmap reservation failed");
+    base_address = NULL;
+  } else if (reserve_length > total_length) {
+    // NOTE: return values ignored as trimming the reservation cannot fail.
+    uint8_t* aligned_address =
+        (uint8_t*)iree_host_align((uintptr_t)base_address, alignment);
+    iree_host_size_t head_length = aligned_address - base_address;
+    if (head_length > 0) munmap(base_address, head_length);
+    iree_host_size_t tail_length = reserve_length - head_length - total_length;
+    if (tail_length > 0) munmap(aligned_address + total_length, tail_length);
+    base_address = aligned_address;
   }
 
   *out_base_address = base_address;
@@ -84,13 +126,25 @@ void iree_memory_view_release(void* base_address, iree_host_size_t total_length,
 }
 
 iree_status_t iree_memory_view_commit_ranges(
-    void* base_address, iree_host_size_t range_count,
-    const iree_byte_range_t* ranges, iree_memory_access_t initial_access) {
+    iree_memory_view_flags_t flags, void* base_address,
+    iree_host_size_t range_count, const iree_byte_range_t* ranges,
+    iree_memory_access_t initial_access) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   int mmap_prot = iree_memory_access_to_prot(initial_access);
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_FIXED;
 
+  // Huge page advice must be given before the pages are faulted in so when
+  // using large pages we populate with madvise afterward instead of mmap.
+  bool large_pages = (flags & IREE_MEMORY_VIEW_FLAG_LARGE_PAGES) != 0;
+  bool populate = (flags & IREE_MEMORY_VIEW_FLAG_POPULATE) != 0;
+#if defined(MAP_POPULATE)
+  if (populate && !large_pages) {
+    mmap_flags |= MAP_POPULATE;
+    populate = false;
+  }
+#endif  // MAP_POPULATE
+
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < range_count; ++i) {
     void* range_start = NULL;
@@ -104,6 +158,20 @@ iree_status_t iree_memory_view_commit_ranges(
                                 "mmap commit failed");
       break;
     }
+
+    // NOTE: advice is best-effort and failures (such as THP being disabled or
+    // an older kernel) leave the range backed by normal pages.
+#if defined(MADV_HUGEPAGE)
+    if (large_pages) madvise(range_start, aligned_length, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+#if defined(MADV_POPULATE_WRITE)
+    if (populate) {
+      madvise(range_start, aligned_length,
+              (initial_access & IREE_MEMORY_ACCESS_WRITE)
+                  ? MADV_POPULATE_WRITE
+                  : MADV_POPULATE_READ);
+    }
+#endif  // MADV_POPULATE_WRITE
   }
 
   IREE_TRACE_ZONE_END(z0);
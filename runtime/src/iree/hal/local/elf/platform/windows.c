@@ -93,10 +93,14 @@ void iree_memory_view_release(void* base_address, iree_host_size_t total_length,
 }
 
 iree_status_t iree_memory_view_commit_ranges(
-    void* base_address, iree_host_size_t range_count,
-    const iree_byte_range_t* ranges, iree_memory_access_t initial_access) {
+    iree_memory_view_flags_t flags, void* base_address,
+    iree_host_size_t range_count, const iree_byte_range_t* ranges,
+    iree_memory_access_t initial_access) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // NOTE: IREE_MEMORY_VIEW_FLAG_LARGE_PAGES is ignored as MEM_LARGE_PAGES
+  // requires SeLockMemoryPrivilege and reserving and committing the entire
+  // range at once. Committed pages are always zero-filled on first access.
   DWORD initial_protect =
       iree_memory_access_to_win32_page_flags(initial_access);
 
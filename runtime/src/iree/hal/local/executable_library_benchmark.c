@@ -130,6 +130,68 @@ IREE_FLAG_CALLBACK(
     "  # 2 4-byte floating-point values with contents [[1.4], [2.1]]:\n"
     "  --binding=2x1xf32=1.4,2.1");
 
+// Initializes |out_executable_params| to load the executable |file_contents|.
+static void iree_hal_executable_library_params_initialize(
+    iree_file_contents_t* file_contents,
+    iree_hal_executable_params_t* out_executable_params) {
+  // This information is normally used to select the appropriate loader but in
+  // this benchmark we only have a single one.
+  iree_hal_executable_params_initialize(out_executable_params);
+  out_executable_params->caching_mode =
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION |
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+      IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION;
+  out_executable_params->executable_format =
+      iree_make_cstring_view(FLAG_executable_format);
+  out_executable_params->executable_data = file_contents->const_buffer;
+
+  // Setup the layouts defining how each entry point is interpreted.
+  // NOTE: we know for the embedded library loader that this is not required.
+  // Other loaders may need it in which case it'll have to be provided.
+  out_executable_params->pipeline_layout_count = 0;
+  out_executable_params->pipeline_layouts = NULL;
+}
+
+// Measures the time taken to load and unload the executable.
+// Loader options that change how executables are mapped into memory (such as
+// --executable_loader_populate) trade load time for dispatch time and this
+// makes the load side of that trade visible.
+static iree_status_t iree_hal_executable_library_load_run(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_hal_executable_plugin_manager_t* plugin_manager =
+      (iree_hal_executable_plugin_manager_t*)benchmark_def->user_data;
+
+  iree_hal_executable_loader_t* executable_loader = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_create_executable_loader_by_name(
+      iree_make_cstring_view(FLAG_executable_format), plugin_manager,
+      host_allocator, &executable_loader));
+
+  iree_file_contents_t* file_contents = NULL;
+  iree_status_t status = iree_file_read_contents(
+      FLAG_executable_file, IREE_FILE_READ_FLAG_DEFAULT, host_allocator,
+      &file_contents);
+  iree_hal_executable_params_t executable_params;
+  if (iree_status_is_ok(status)) {
+    iree_hal_executable_library_params_initialize(file_contents,
+                                                  &executable_params);
+  }
+
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_executable_t* executable = NULL;
+    status = iree_hal_executable_loader_try_load(
+        executable_loader, &executable_params,
+        /*worker_capacity=*/1, &executable);
+    iree_hal_executable_release(executable);
+  }
+
+  iree_file_contents_free(file_contents);
+  iree_hal_executable_loader_release(executable_loader);
+  return status;
+}
+
 // NOTE: error handling is here just for better diagnostics: it is not tracking
 // allocations correctly and will leak. Don't use this as an example for how to
 // write robust code.
@@ -146,30 +208,16 @@ static iree_status_t iree_hal_executable_library_run(
       iree_make_cstring_view(FLAG_executable_format), plugin_manager,
       host_allocator, &executable_loader));
 
-  // Setup the specification used to perform the executable load.
-  // This information is normally used to select the appropriate loader but in
-  // this benchmark we only have a single one.
-  iree_hal_executable_params_t executable_params;
-  iree_hal_executable_params_initialize(&executable_params);
-  executable_params.caching_mode =
-      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION |
-      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
-      IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION;
-  executable_params.executable_format =
-      iree_make_cstring_view(FLAG_executable_format);
-
   // Load the executable data.
   iree_file_contents_t* file_contents = NULL;
   IREE_RETURN_IF_ERROR(iree_file_read_contents(FLAG_executable_file,
                                                IREE_FILE_READ_FLAG_DEFAULT,
                                                host_allocator, &file_contents));
-  executable_params.executable_data = file_contents->const_buffer;
 
-  // Setup the layouts defining how each entry point is interpreted.
-  // NOTE: we know for the embedded library loader that this is not required.
-  // Other loaders may need it in which case it'll have to be provided.
-  executable_params.pipeline_layout_count = 0;
-  executable_params.pipeline_layouts = NULL;
+  // Setup the specification used to perform the executable load.
+  iree_hal_executable_params_t executable_params;
+  iree_hal_executable_library_params_initialize(file_contents,
+                                                &executable_params);
 
   // Perform the load, which will fail if the executable cannot be loaded or
   // there was an issue with the layouts.
@@ -301,6 +349,13 @@ int main(int argc, char** argv) {
       "  --binding=4xf32=1,2,3,4\n"
       "  --binding=4xf32=100,200,300,400\n"
       "  --binding=4xf32=0,0,0,0\n"
+      "\n"
+      "The effect of how the executable is mapped into memory can be measured\n"
+      "by comparing runs with and without the embedded ELF loader options:\n"
+      "  --executable_loader_large_pages\n"
+      "  --executable_loader_populate\n"
+      "The `load` benchmark reports the cost of loading the executable while\n"
+      "the `dispatch` benchmark reports the steady-state dispatch cost.\n"
       "\n");
 
   iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
@@ -311,6 +366,16 @@ int main(int argc, char** argv) {
       iree_allocator_system(), &plugin_manager));
 
   // TODO(benvanik): override these with our own flags.
+  iree_benchmark_def_t load_benchmark_def = {
+      .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+               IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+      .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+      .minimum_duration_ns = 0,
+      .iteration_count = 0,
+      .run = iree_hal_executable_library_load_run,
+      .user_data = plugin_manager,
+  };
+  iree_benchmark_register(iree_make_cstring_view("load"), &load_benchmark_def);
   iree_benchmark_def_t benchmark_def = {
       .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
                IREE_BENCHMARK_FLAG_USE_REAL_TIME,
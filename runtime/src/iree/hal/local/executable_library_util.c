@@ -6,6 +6,8 @@
 
 #include "iree/hal/local/executable_library_util.h"
 
+#include "iree/hal/local/trace_location.h"
+
 iree_status_t iree_hal_executable_library_verify(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_library_v0_t* library) {
@@ -98,46 +100,59 @@ void iree_hal_executable_library_deinitialize_imports(
   environment->import_thunk = NULL;
 }
 
-#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
-
-iree_zone_id_t iree_hal_executable_library_call_zone_begin(
+iree_status_t iree_hal_executable_library_initialize_trace_locations(
     iree_string_view_t executable_identifier,
-    const iree_hal_executable_library_v0_t* library, iree_host_size_t ordinal) {
-  iree_string_view_t entry_point_name = iree_string_view_empty();
-  if (library->exports.names != NULL) {
-    entry_point_name = iree_make_cstring_view(library->exports.names[ordinal]);
-  }
-  if (iree_string_view_is_empty(entry_point_name)) {
-    entry_point_name = iree_make_cstring_view("unknown_dylib_call");
-  }
-
-  const char* source_file = NULL;
-  size_t source_file_length = 0;
-  uint32_t source_line;
-  if (library->exports.src_locs != NULL) {
-    // We have source location data, so use it.
-    source_file = library->exports.src_locs[ordinal].path;
-    source_file_length = library->exports.src_locs[ordinal].path_length;
-    source_line = library->exports.src_locs[ordinal].line;
-  } else {
-    // No source location data, so make do with what we have.
-    source_file = executable_identifier.data;
-    source_file_length = executable_identifier.size;
-    source_line = ordinal;
+    const iree_hal_executable_library_v0_t* library,
+    iree_hal_local_executable_t* executable) {
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  if (library->exports.count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_tracing_location_t** locations = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(executable->host_allocator,
+                                library->exports.count * sizeof(*locations),
+                                (void**)&locations));
+  for (uint32_t ordinal = 0; ordinal < library->exports.count; ++ordinal) {
+    iree_string_view_t entry_point_name = iree_string_view_empty();
+    if (library->exports.names != NULL) {
+      entry_point_name =
+          iree_make_cstring_view(library->exports.names[ordinal]);
+    }
+    if (iree_string_view_is_empty(entry_point_name)) {
+      entry_point_name = iree_make_cstring_view("unknown_dylib_call");
+    }
+    iree_string_view_t source_file = executable_identifier;
+    uint32_t source_line = ordinal;
+    if (library->exports.src_locs != NULL) {
+      // We have source location data, so use it.
+      source_file =
+          iree_make_string_view(library->exports.src_locs[ordinal].path,
+                                library->exports.src_locs[ordinal].path_length);
+      source_line = library->exports.src_locs[ordinal].line;
+    }
+    locations[ordinal] = iree_hal_local_trace_location_intern(
+        source_file, source_line, entry_point_name, iree_string_view_empty(),
+        0);
   }
+  iree_allocator_free(executable->host_allocator,
+                      (void*)executable->export_locations);
+  executable->export_locations = locations;
+  IREE_TRACE_ZONE_END(z0);
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  return iree_ok_status();
+}
 
-  IREE_TRACE_ZONE_BEGIN_EXTERNAL(z0, source_file, source_file_length,
-                                 source_line, entry_point_name.data,
-                                 entry_point_name.size, NULL, 0);
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
+void iree_hal_executable_library_call_zone_append_tag(
+    iree_zone_id_t zone_id, const iree_hal_executable_library_v0_t* library,
+    iree_host_size_t ordinal) {
   if (library->exports.tags != NULL) {
     const char* tag = library->exports.tags[ordinal];
     if (tag) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, tag);
+      IREE_TRACE_ZONE_APPEND_TEXT(zone_id, tag);
     }
   }
-
-  return z0;
 }
 
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
@@ -11,6 +11,7 @@
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
 
 // Verifies the |library| matches the |executable_params|.
 iree_status_t iree_hal_executable_library_verify(
@@ -33,19 +34,34 @@ void iree_hal_executable_library_deinitialize_imports(
     iree_hal_executable_environment_v0_t* environment,
     iree_allocator_t host_allocator);
 
-#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
-iree_zone_id_t iree_hal_executable_library_call_zone_begin(
+// Interns tracing locations for each export in |library| and stores them on
+// |executable| such that calls can be traced without copying names per zone.
+// Uses the export source locations when available and otherwise attributes
+// exports to the |executable_identifier|. No-op when tracing is disabled.
+iree_status_t iree_hal_executable_library_initialize_trace_locations(
     iree_string_view_t executable_identifier,
-    const iree_hal_executable_library_v0_t* library, iree_host_size_t ordinal);
-#define IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(              \
-    zone_id, executable_identifier, library, ordinal)                   \
-  iree_zone_id_t zone_id = iree_hal_executable_library_call_zone_begin( \
-      executable_identifier, library, ordinal)
+    const iree_hal_executable_library_v0_t* library,
+    iree_hal_local_executable_t* executable);
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+void iree_hal_executable_library_call_zone_append_tag(
+    iree_zone_id_t zone_id, const iree_hal_executable_library_v0_t* library,
+    iree_host_size_t ordinal);
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+// Begins a zone for a call to |ordinal| in |library| loaded as |executable|.
+// Export tags are only attached in verbose tracing modes as they are copied
+// into the trace for each call.
+#if IREE_HAL_VERBOSE_TRACING_ENABLE && \
+    (IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION)
+#define IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(                  \
+    zone_id, executable, library, ordinal)                                  \
+  IREE_HAL_LOCAL_EXECUTABLE_TRACE_ZONE_BEGIN(zone_id, executable, ordinal); \
+  iree_hal_executable_library_call_zone_append_tag(zone_id, library, ordinal)
 #else
 #define IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN( \
-    zone_id, executable_identifier, library, ordinal)      \
-  iree_zone_id_t zone_id = 0;                              \
-  (void)zone_id;
-#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+    zone_id, executable, library, ordinal)                 \
+  IREE_HAL_LOCAL_EXECUTABLE_TRACE_ZONE_BEGIN(zone_id, executable, ordinal)
+#endif  // IREE_HAL_VERBOSE_TRACING_ENABLE && TRACING_FEATURE_INSTRUMENTATION
 
 #endif  // IREE_HAL_LOCAL_EXECUTABLE_LIBRARY_UTIL_H_
@@ -53,6 +53,7 @@ void iree_hal_executable_loader_initialize(
   iree_atomic_ref_count_init(&out_base_loader->ref_count);
   out_base_loader->vtable = vtable;
   out_base_loader->import_provider = import_provider;
+  out_base_loader->flags = IREE_HAL_EXECUTABLE_LOADER_FLAG_NONE;
 }
 
 void iree_hal_executable_loader_retain(
@@ -96,6 +96,16 @@ static inline bool iree_hal_executable_import_is_optional(
 typedef struct iree_hal_executable_loader_vtable_t
     iree_hal_executable_loader_vtable_t;
 
+// Bitfield describing the executables produced by a loader.
+enum iree_hal_executable_loader_flag_bits_t {
+  IREE_HAL_EXECUTABLE_LOADER_FLAG_NONE = 0u,
+  // Executables loaded may be marked IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE
+  // and published to the process-wide shared executable cache. Loaders without
+  // this flag skip hashing executable contents on every load.
+  IREE_HAL_EXECUTABLE_LOADER_FLAG_SHAREABLE_EXECUTABLES = 1u << 0,
+};
+typedef uint32_t iree_hal_executable_loader_flags_t;
+
 // Interface for compiled executable loader implementations.
 // A loader may be as simple as something that resolves function pointers in the
 // local executable for statically linked executables or as complex as a custom
@@ -109,6 +119,8 @@ typedef struct iree_hal_executable_loader_t {
   iree_atomic_ref_count_t ref_count;
   const iree_hal_executable_loader_vtable_t* vtable;
   iree_hal_executable_import_provider_t import_provider;
+  // Flags set by the parent type during initialization.
+  iree_hal_executable_loader_flags_t flags;
 } iree_hal_executable_loader_t;
 
 // Initializes the base iree_hal_executable_loader_t type.
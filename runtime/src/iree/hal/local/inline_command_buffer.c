@@ -17,11 +17,17 @@
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/trace_location.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_inline_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// Maximum depth of debug groups that are traced. Groups nested deeper are
+// ignored.
+#define IREE_HAL_INLINE_COMMAND_BUFFER_MAX_DEBUG_GROUP_DEPTH 16
+
 // Inline synchronous one-shot command "buffer".
 typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
@@ -60,6 +66,13 @@ typedef struct iree_hal_inline_command_buffer_t {
     iree_cpu_processor_tag_t processor_tag;
     // Guess at the current processor ID.
     iree_cpu_processor_id_t processor_id;
+
+    // Stack of zones opened for debug groups as commands execute inline.
+    // |debug_group_depth| may exceed the zone capacity in which case only the
+    // outermost groups have zones.
+    IREE_TRACE(iree_host_size_t debug_group_depth;)
+    IREE_TRACE(iree_zone_id_t debug_group_zones
+                   [IREE_HAL_INLINE_COMMAND_BUFFER_MAX_DEBUG_GROUP_DEPTH];)
   } state;
 } iree_hal_inline_command_buffer_t;
 
@@ -74,6 +87,18 @@ static iree_hal_inline_command_buffer_t* iree_hal_inline_command_buffer_cast(
 
 static void iree_hal_inline_command_buffer_reset(
     iree_hal_inline_command_buffer_t* command_buffer) {
+  // Close any debug group zones left open by the user. This must not route
+  // through the public API as that would also unwind validation state.
+  IREE_TRACE({
+    iree_host_size_t zone_count =
+        iree_min(command_buffer->state.debug_group_depth,
+                 IREE_HAL_INLINE_COMMAND_BUFFER_MAX_DEBUG_GROUP_DEPTH);
+    while (zone_count > 0) {
+      --zone_count;
+      IREE_TRACE_ZONE_END(command_buffer->state.debug_group_zones[zone_count]);
+    }
+  });
+
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
 
   // Setup the cached dispatch state pointers that don't change.
@@ -234,12 +259,33 @@ static void iree_hal_inline_command_buffer_begin_debug_group(
     iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
     iree_hal_label_color_t label_color,
     const iree_hal_label_location_t* location) {
-  // TODO(benvanik): tracy event stack.
+  IREE_TRACE({
+    iree_hal_inline_command_buffer_t* command_buffer =
+        iree_hal_inline_command_buffer_cast(base_command_buffer);
+    iree_host_size_t depth = command_buffer->state.debug_group_depth++;
+    if (depth < IREE_HAL_INLINE_COMMAND_BUFFER_MAX_DEBUG_GROUP_DEPTH) {
+      // Commands execute as they are recorded so the group zone encloses
+      // them on the calling thread.
+      const iree_tracing_location_t* group_location =
+          iree_hal_local_trace_location_intern_label(label, label_color,
+                                                     location);
+      IREE_TRACE_ZONE_BEGIN_LOCATION(z0, group_location);
+      command_buffer->state.debug_group_zones[depth] = z0;
+    }
+  });
 }
 
 static void iree_hal_inline_command_buffer_end_debug_group(
     iree_hal_command_buffer_t* base_command_buffer) {
-  // TODO(benvanik): tracy event stack.
+  IREE_TRACE({
+    iree_hal_inline_command_buffer_t* command_buffer =
+        iree_hal_inline_command_buffer_cast(base_command_buffer);
+    if (command_buffer->state.debug_group_depth == 0) return;
+    iree_host_size_t depth = --command_buffer->state.debug_group_depth;
+    if (depth < IREE_HAL_INLINE_COMMAND_BUFFER_MAX_DEBUG_GROUP_DEPTH) {
+      IREE_TRACE_ZONE_END(command_buffer->state.debug_group_zones[depth]);
+    }
+  });
 }
 
 //===----------------------------------------------------------------------===//
@@ -443,8 +489,9 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -579,12 +626,17 @@ static iree_status_t iree_hal_inline_command_buffer_execute_commands(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* base_commands,
     iree_hal_buffer_binding_table_t binding_table) {
-  // TODO(#10144): decide how to execute the inline command buffer; it is
-  // definitely a deferred command buffer but we don't want to force that
-  // dependency here. We could allow injection of a function to call to execute
-  // command buffers so that the device can decide how it wants to handle them.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "indirect command buffers not yet implemented");
+  // Indirect command buffers are recorded as deferred command buffers by the
+  // device as we can't execute them as we record without a binding table.
+  // Replaying them here executes them inline with the bindings resolved.
+  if (!iree_hal_deferred_command_buffer_isa(base_commands)) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "only indirect command buffers created with a binding capacity can be "
+        "executed as nested command buffers");
+  }
+  return iree_hal_deferred_command_buffer_apply_commands(
+      base_commands, base_command_buffer, binding_table);
 }
 
 //===----------------------------------------------------------------------===//
@@ -81,13 +81,16 @@ static iree_status_t iree_hal_elf_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-  return iree_ok_status();
+  executable->base.export_names = executable->library.v0->exports.names;
+  return iree_hal_executable_library_initialize_trace_locations(
+      executable->identifier, executable->library.v0, &executable->base);
 }
 
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_elf_module_flags_t module_flags, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -115,6 +118,9 @@ static iree_status_t iree_hal_elf_executable_create(
         executable_params->pipeline_layout_count,
         executable_params->pipeline_layouts, &executable->layouts[0],
         host_allocator, &executable->base);
+    // Segments are copied out of the executable data and the loaded module is
+    // immutable so all devices can share it.
+    executable->base.flags |= IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE;
   }
 
   // Copy executable constants so we own them.
@@ -133,7 +139,7 @@ static iree_status_t iree_hal_elf_executable_create(
   if (iree_status_is_ok(status)) {
     status = iree_elf_module_initialize_from_memory(
         executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+        module_flags, host_allocator, &executable->module);
   }
 
   // Query metadata and get the entry point function pointers.
@@ -198,7 +204,7 @@ static iree_status_t iree_hal_elf_executable_issue_call(
                             "entry point ordinal out of bounds");
   }
 
-  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, executable->identifier,
+  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, base_executable,
                                                     library, ordinal);
   int ret = iree_elf_call_i_ppp(library->exports.ptrs[ordinal],
                                 (void*)&base_executable->environment,
@@ -229,12 +235,15 @@ typedef struct iree_hal_embedded_elf_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
   iree_hal_executable_plugin_manager_t* plugin_manager;
+  // Flags used when loading each executable ELF module.
+  iree_elf_module_flags_t module_flags;
 } iree_hal_embedded_elf_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_embedded_elf_loader_vtable;
 
 iree_status_t iree_hal_embedded_elf_loader_create(
+    iree_hal_embedded_elf_loader_flags_t flags,
     iree_hal_executable_plugin_manager_t* plugin_manager,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader) {
@@ -250,10 +259,19 @@ iree_status_t iree_hal_embedded_elf_loader_create(
         &iree_hal_embedded_elf_loader_vtable,
         iree_hal_executable_plugin_manager_provider(plugin_manager),
         &executable_loader->base);
+    executable_loader->base.flags |=
+        IREE_HAL_EXECUTABLE_LOADER_FLAG_SHAREABLE_EXECUTABLES;
     executable_loader->host_allocator = host_allocator;
     executable_loader->plugin_manager = plugin_manager;
     iree_hal_executable_plugin_manager_retain(
         executable_loader->plugin_manager);
+    executable_loader->module_flags = IREE_ELF_MODULE_FLAG_NONE;
+    if (flags & IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES) {
+      executable_loader->module_flags |= IREE_ELF_MODULE_FLAG_LARGE_PAGES;
+    }
+    if (flags & IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_POPULATE) {
+      executable_loader->module_flags |= IREE_ELF_MODULE_FLAG_POPULATE;
+    }
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
   }
 
@@ -293,7 +311,8 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
       executable_params, base_executable_loader->import_provider,
-      executable_loader->host_allocator, out_executable);
+      executable_loader->module_flags, executable_loader->host_allocator,
+      out_executable);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -20,11 +20,29 @@ extern "C" {
 typedef struct iree_hal_executable_plugin_manager_t
     iree_hal_executable_plugin_manager_t;
 
+// Flags controlling how the embedded ELF loader maps executables into memory.
+enum iree_hal_embedded_elf_loader_flag_bits_t {
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE = 0u,
+
+  // Maps executables with large pages when available (transparent huge pages on
+  // Linux). Reduces TLB misses in executables with large code or constant
+  // segments at the cost of additional virtual address space per executable.
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES = 1u << 0,
+
+  // Prefaults all executable pages when loading so that the first dispatches
+  // do not take page faults. Increases load time and resident memory.
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_POPULATE = 1u << 1,
+};
+typedef uint32_t iree_hal_embedded_elf_loader_flags_t;
+
 // Creates an executable loader that can load minimally-featured ELF dynamic
 // libraries on any platform. This allows us to use a single file format across
 // all operating systems at the cost of some missing debugging/profiling
 // features.
+//
+// |flags| applies to all executables loaded by the loader.
 iree_status_t iree_hal_embedded_elf_loader_create(
+    iree_hal_embedded_elf_loader_flags_t flags,
     iree_hal_executable_plugin_manager_t* plugin_manager,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
@@ -25,8 +25,9 @@ typedef struct iree_hal_executable_plugin_manager_t
 // capacity. Loaders are retained upon return and must be released by the
 // caller.
 //
-// Default options are used to create the loaders. If customization is required
-// then callers should create the loaders themselves.
+// Default options are used to create the loaders except for those controlled by
+// the --executable_loader_* flags. If customization is required then callers
+// should create the loaders themselves.
 //
 // Usage:
 //  iree_host_size_t count = 0;
@@ -47,6 +48,7 @@ IREE_API_EXPORT iree_status_t iree_hal_create_all_available_executable_loaders(
     iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator);
 
 // Creates an executable loader with the given |name|.
+// Options are set as with iree_hal_create_all_available_executable_loaders.
 // |out_executable_loader| must be released by the caller.
 IREE_API_EXPORT iree_status_t iree_hal_create_executable_loader_by_name(
     iree_string_view_t name,
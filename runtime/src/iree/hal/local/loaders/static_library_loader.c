@@ -71,9 +71,14 @@ static iree_status_t iree_hal_static_executable_create(
         executable_params->pipeline_layout_count,
         executable_params->pipeline_layouts, &executable->layouts[0],
         host_allocator, &executable->base);
+    // Static libraries are immutable and not loaded from the executable data.
+    executable->base.flags |= IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE;
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+    executable->base.export_names = executable->library.v0->exports.names;
+    status = iree_hal_executable_library_initialize_trace_locations(
+        executable->identifier, executable->library.v0, &executable->base);
   }
 
   // Copy executable constants so we own them.
@@ -142,7 +147,7 @@ static iree_status_t iree_hal_static_executable_issue_call(
                             "entry point ordinal out of bounds");
   }
 
-  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, executable->identifier,
+  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, base_executable,
                                                     library, ordinal);
   int ret = library->exports.ptrs[ordinal](&base_executable->environment,
                                            dispatch_state, workgroup_state);
@@ -199,6 +204,8 @@ iree_status_t iree_hal_static_library_loader_create(
     iree_hal_executable_loader_initialize(
         &iree_hal_static_library_loader_vtable, import_provider,
         &executable_loader->base);
+    executable_loader->base.flags |=
+        IREE_HAL_EXECUTABLE_LOADER_FLAG_SHAREABLE_EXECUTABLES;
     executable_loader->host_allocator = host_allocator;
     executable_loader->library_count = library_count;
 
@@ -201,7 +201,9 @@ static iree_status_t iree_hal_system_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-  return iree_ok_status();
+  executable->base.export_names = executable->library.v0->exports.names;
+  return iree_hal_executable_library_initialize_trace_locations(
+      executable->identifier, executable->library.v0, &executable->base);
 }
 
 static int iree_hal_system_executable_import_thunk_v0(
@@ -319,7 +321,7 @@ static iree_status_t iree_hal_system_executable_issue_call(
                             "entry point ordinal out of bounds");
   }
 
-  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, executable->identifier,
+  IREE_HAL_EXECUTABLE_LIBRARY_CALL_TRACE_ZONE_BEGIN(z0, base_executable,
                                                     library, ordinal);
   int ret = library->exports.ptrs[ordinal](&base_executable->environment,
                                            dispatch_state, workgroup_state);
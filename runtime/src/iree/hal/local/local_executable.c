@@ -6,7 +6,16 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/profiler.h"
+#include "iree/hal/local/shared_executable_cache.h"
+#include "iree/hal/local/trace_location.h"
+
+// Counter used to assign process-unique executable IDs.
+static iree_atomic_int64_t iree_hal_local_executable_next_id =
+    IREE_ATOMIC_VAR_INIT(1);
 
 void iree_hal_local_executable_initialize(
     const iree_hal_local_executable_vtable_t* vtable,
@@ -17,6 +26,10 @@ void iree_hal_local_executable_initialize(
     iree_hal_local_executable_t* out_base_executable) {
   iree_hal_resource_initialize(vtable, &out_base_executable->resource);
   out_base_executable->host_allocator = host_allocator;
+  out_base_executable->flags = IREE_HAL_LOCAL_EXECUTABLE_FLAG_NONE;
+  out_base_executable->id = (uint64_t)iree_atomic_fetch_add_int64(
+      &iree_hal_local_executable_next_id, 1, iree_memory_order_relaxed);
+  out_base_executable->shared_entry = NULL;
 
   out_base_executable->pipeline_layout_count = pipeline_layout_count;
   out_base_executable->pipeline_layouts = target_pipeline_layouts;
@@ -27,6 +40,8 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->export_names = NULL;
+  IREE_TRACE(out_base_executable->export_locations = NULL);
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
@@ -35,10 +50,18 @@ void iree_hal_local_executable_initialize(
 
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable) {
+  // Lookups racing with the destruction fail to retain the executable as its
+  // reference count has already reached zero.
+  if (base_executable->shared_entry) {
+    iree_hal_local_shared_executable_cache_remove(base_executable);
+  }
   for (iree_host_size_t i = 0; i < base_executable->pipeline_layout_count;
        ++i) {
     iree_hal_pipeline_layout_release(base_executable->pipeline_layouts[i]);
   }
+  // NOTE: the locations themselves are interned and live for the process.
+  IREE_TRACE(iree_allocator_free(base_executable->host_allocator,
+                                 (void*)base_executable->export_locations));
 }
 
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
@@ -46,6 +69,20 @@ iree_hal_local_executable_t* iree_hal_local_executable_cast(
   return (iree_hal_local_executable_t*)base_value;
 }
 
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (IREE_LIKELY(!vtable->resolve)) {
+    *out_executable = executable;
+    return iree_ok_status();
+  }
+  return vtable->resolve(executable, out_executable);
+}
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -60,30 +97,54 @@ iree_status_t iree_hal_local_executable_issue_call(
                    worker_id);
 }
 
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+// Location used for dispatches of executables without export locations.
+static const iree_tracing_location_t*
+    iree_hal_local_executable_unknown_location_;
+static iree_once_flag iree_hal_local_executable_unknown_location_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_executable_unknown_location_initialize(void) {
+  iree_hal_local_executable_unknown_location_ =
+      iree_hal_local_trace_location_intern(
+          iree_make_cstring_view(__FILE__), __LINE__,
+          iree_make_cstring_view("unknown_dispatch"), iree_string_view_empty(),
+          0);
+}
+
+const iree_tracing_location_t* iree_hal_local_executable_trace_location(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal) {
+  if (IREE_LIKELY(executable->export_locations)) {
+    return executable->export_locations[ordinal];
+  }
+  iree_call_once(&iree_hal_local_executable_unknown_location_flag_,
+                 iree_hal_local_executable_unknown_location_initialize);
+  return iree_hal_local_executable_unknown_location_;
+}
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     uint32_t processor_id, iree_byte_span_t local_memory) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  // TODO(benvanik): annotate with executable name to calculate total time.
+  IREE_HAL_LOCAL_EXECUTABLE_TRACE_ZONE_BEGIN(z0, executable, ordinal);
 
   const uint32_t workgroup_count_x = dispatch_state->workgroup_count_x;
   const uint32_t workgroup_count_y = dispatch_state->workgroup_count_y;
   const uint32_t workgroup_count_z = dispatch_state->workgroup_count_z;
 
 #if IREE_HAL_VERBOSE_TRACING_ENABLE
-  // TODO(benvanik): tracing.h helper that speeds this up; too slow.
-  IREE_TRACE({
-    char xyz_string[32];
-    int xyz_string_length =
-        snprintf(xyz_string, IREE_ARRAYSIZE(xyz_string), "%ux%ux%u",
-                 workgroup_count_x, workgroup_count_y, workgroup_count_z);
-    IREE_TRACE_ZONE_APPEND_TEXT_STRING_VIEW(z0, xyz_string, xyz_string_length);
-  });
+  // Values are appended without formatting to keep the zone cheap.
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, workgroup_count_x);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, workgroup_count_y);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, workgroup_count_z);
 #endif  // IREE_HAL_VERBOSE_TRACING_ENABLE
 
   iree_status_t status = iree_ok_status();
 
+  iree_hal_local_profiler_sample_t profiler_sample;
+  const bool profiling =
+      iree_hal_local_profiler_sample_begin(&profiler_sample);
+
   iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
       .workgroup_id_x = 0,
       .workgroup_id_y = 0,
@@ -106,6 +167,14 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     }
   }
 
+  if (profiling) {
+    iree_hal_local_profiler_sample_end(
+        &profiler_sample, executable->id, ordinal,
+        executable->export_names ? executable->export_names[ordinal] : NULL,
+        /*dispatch_count=*/1,
+        workgroup_count_x * workgroup_count_y * workgroup_count_z);
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -15,10 +15,36 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Bitfield specifying properties of a local executable.
+enum iree_hal_local_executable_flag_bits_t {
+  IREE_HAL_LOCAL_EXECUTABLE_FLAG_NONE = 0u,
+  // The executable has no per-device or per-worker mutable state and does not
+  // reference the executable data it was loaded from. Once loaded it may be
+  // shared by all devices in the process that would load the same executable
+  // with the same loader.
+  IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE = 1u << 0,
+};
+typedef uint32_t iree_hal_local_executable_flags_t;
+
+typedef struct iree_hal_local_shared_executable_entry_t
+    iree_hal_local_shared_executable_entry_t;
+
 typedef struct iree_hal_local_executable_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
 
+  // Flags set by the parent type during initialization.
+  iree_hal_local_executable_flags_t flags;
+
+  // Process-unique nonzero ID assigned during initialization. Unlike the
+  // executable address the ID is never reused and identifies the executable in
+  // profiles even if it is freed and another is allocated at the same address.
+  uint64_t id;
+
+  // Entry in the process-wide shared executable cache if the executable has
+  // been published to it. Owned by the shared executable cache.
+  iree_hal_local_shared_executable_entry_t* shared_entry;
+
   // Optional pipeline layout
   // Not all users require the layouts (such as when directly calling executable
   // functions) and in those cases they can be omitted. Users routing through
@@ -35,6 +61,17 @@ typedef struct iree_hal_local_executable_t {
   // of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Optional per-entry point names used for profiling and diagnostics.
+  // May be NULL if the executable was compiled without names.
+  const char* const* export_names;
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  // Optional per-entry point tracing locations with process lifetime.
+  // Populated by iree_hal_executable_library_initialize_trace_locations and
+  // used to trace dispatches without copying names per zone.
+  const iree_tracing_location_t** export_locations;
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -47,6 +84,13 @@ typedef struct iree_hal_local_executable_vtable_t {
       const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
       const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
       uint32_t worker_id);
+
+  // Optional; returns the executable that performs dispatches on behalf of
+  // |executable| after waiting for it to load. Only implemented by executables
+  // that are loaded asynchronously.
+  iree_status_t(IREE_API_PTR* resolve)(
+      iree_hal_local_executable_t* executable,
+      iree_hal_local_executable_t** out_executable);
 } iree_hal_local_executable_vtable_t;
 
 // Initializes the local executable base type.
@@ -67,12 +111,45 @@ void iree_hal_local_executable_deinitialize(
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Returns the executable that must be used to dispatch |executable| in
+// |out_executable|, waiting for it to finish loading if it is being loaded
+// asynchronously. The returned executable is owned by |executable| and valid
+// for as long as the caller retains |executable|. Returns any error that
+// occurred while loading.
+//
+// Dispatch recording must resolve executables prior to accessing any of their
+// fields as they may not be populated until the executable has loaded.
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable);
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
     uint32_t worker_id);
 
+// Begins a zone for a dispatch of |ordinal| in |executable| attributed to the
+// export when its tracing location is available.
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+#define IREE_HAL_LOCAL_EXECUTABLE_TRACE_ZONE_BEGIN(zone_id, executable, \
+                                                   ordinal)             \
+  IREE_TRACE_ZONE_BEGIN_LOCATION(                                       \
+      zone_id, iree_hal_local_executable_trace_location(executable, ordinal))
+#else
+#define IREE_HAL_LOCAL_EXECUTABLE_TRACE_ZONE_BEGIN(zone_id, executable, \
+                                                   ordinal)             \
+  iree_zone_id_t zone_id = 0;                                           \
+  (void)zone_id;
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+// Returns the tracing location of |ordinal| in |executable| or a generic
+// location if the executable has none.
+const iree_tracing_location_t* iree_hal_local_executable_trace_location(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal);
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -8,12 +8,19 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/shared_executable_cache.h"
 
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+  iree_hal_local_executable_cache_scheduler_t scheduler;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -29,6 +36,7 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
@@ -52,6 +60,7 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
     executable_cache->worker_capacity = worker_capacity;
+    executable_cache->scheduler = scheduler;
 
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
@@ -96,39 +105,482 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+static inline void iree_hal_local_executable_cache_append_word(
+    uint64_t value, uint64_t* words, iree_host_size_t* word_count) {
+  if (words) words[*word_count] = value;
+  ++*word_count;
+}
+
+// Serializes the structure of |pipeline_layouts| into |words| such that
+// executables prepared with equivalent layouts from different devices can be
+// shared. |words| may be NULL to only compute |out_word_count|.
+static void iree_hal_local_executable_cache_serialize_layouts(
+    iree_host_size_t pipeline_layout_count,
+    iree_hal_pipeline_layout_t* const* pipeline_layouts, uint64_t* words,
+    iree_host_size_t* out_word_count) {
+  iree_host_size_t word_count = 0;
+  iree_hal_local_executable_cache_append_word(pipeline_layout_count, words,
+                                              &word_count);
+  for (iree_host_size_t i = 0; i < pipeline_layout_count; ++i) {
+    if (!pipeline_layouts[i]) {
+      iree_hal_local_executable_cache_append_word(UINT64_MAX, words,
+                                                  &word_count);
+      continue;
+    }
+    iree_hal_local_pipeline_layout_t* pipeline_layout =
+        iree_hal_local_pipeline_layout_cast(pipeline_layouts[i]);
+    iree_hal_local_executable_cache_append_word(
+        ((uint64_t)pipeline_layout->push_constants << 32) |
+            pipeline_layout->set_layout_count,
+        words, &word_count);
+    for (iree_host_size_t j = 0; j < pipeline_layout->set_layout_count; ++j) {
+      iree_hal_local_descriptor_set_layout_t* set_layout =
+          iree_hal_local_descriptor_set_layout_cast(
+              pipeline_layout->set_layouts[j]);
+      iree_hal_local_executable_cache_append_word(
+          ((uint64_t)set_layout->flags << 32) | set_layout->binding_count,
+          words, &word_count);
+      for (iree_host_size_t k = 0; k < set_layout->binding_count; ++k) {
+        const iree_hal_descriptor_set_layout_binding_t* binding =
+            &set_layout->bindings[k];
+        iree_hal_local_executable_cache_append_word(
+            ((uint64_t)binding->binding << 32) |
+                ((uint64_t)binding->type << 24) | binding->flags,
+            words, &word_count);
+      }
+    }
+  }
+  *out_word_count = word_count;
+}
+
+// Initializes |out_key| with everything in |executable_params| that may
+// influence the loaded executable. The serialized pipeline layouts referenced
+// by the key are returned in |out_layout_signature| and must be freed by the
+// caller with the cache host allocator.
+static iree_status_t iree_hal_local_executable_cache_make_key(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_local_shared_executable_key_t* out_key,
+    uint64_t** out_layout_signature) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_key, 0, sizeof(*out_key));
+  *out_layout_signature = NULL;
+
+  iree_host_size_t word_count = 0;
+  iree_hal_local_executable_cache_serialize_layouts(
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, NULL, &word_count);
+  uint64_t* layout_signature = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(executable_cache->host_allocator,
+                                word_count * sizeof(*layout_signature),
+                                (void**)&layout_signature));
+  iree_hal_local_executable_cache_serialize_layouts(
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, layout_signature, &word_count);
+
+  out_key->worker_capacity = executable_cache->worker_capacity;
+  // Shareable executables never reference the provided data so whether it
+  // may be aliased does not matter.
+  out_key->caching_mode =
+      executable_params->caching_mode &
+      ~IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  out_key->executable_format = executable_params->executable_format;
+  out_key->executable_data = executable_params->executable_data;
+  iree_hal_local_shared_executable_digest(out_key->executable_data,
+                                          out_key->executable_data_digest);
+  out_key->constants = iree_make_const_byte_span(
+      executable_params->constants,
+      executable_params->constant_count * sizeof(uint32_t));
+  out_key->layout_signature = iree_make_const_byte_span(
+      layout_signature, word_count * sizeof(*layout_signature));
+  out_key->content_hash = iree_hal_local_shared_executable_key_hash(out_key);
+  *out_layout_signature = layout_signature;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Loads the executable described by |executable_params| with the first loader
+// that supports it or retains an equivalent executable already loaded in the
+// process.
+static iree_status_t iree_hal_local_executable_cache_load(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
+  // Built on the first loader that may share executables; loaders that cannot
+  // share skip hashing the (potentially multi-megabyte) executable data.
+  iree_hal_local_shared_executable_key_t key;
+  uint64_t* layout_signature = NULL;
+  bool has_key = false;
+  bool loaded = false;
+  iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
+    iree_hal_executable_loader_t* loader = executable_cache->loaders[i];
     if (!iree_hal_executable_loader_query_support(
-            executable_cache->loaders[i], executable_params->caching_mode,
+            loader, executable_params->caching_mode,
             executable_params->executable_format)) {
       // Loader definitely can't handle the executable; no use trying so skip.
       continue;
     }
+
+    // Reuse the executable if another device or context in the process has
+    // already loaded it with the same loader.
+    const bool shareable = iree_all_bits_set(
+        loader->flags, IREE_HAL_EXECUTABLE_LOADER_FLAG_SHAREABLE_EXECUTABLES);
+    if (shareable) {
+      if (!has_key) {
+        status = iree_hal_local_executable_cache_make_key(
+            executable_cache, executable_params, &key, &layout_signature);
+        if (!iree_status_is_ok(status)) break;
+        has_key = true;
+      }
+      key.loader = loader;
+      if (iree_hal_local_shared_executable_cache_lookup(&key, out_executable)) {
+        loaded = true;
+        break;
+      }
+    }
+
     // The loader _may_ handle the executable; if the specific executable is not
     // supported then the try will fail with IREE_STATUS_CANCELLED and we should
     // continue trying other loaders.
-    iree_status_t status = iree_hal_executable_loader_try_load(
-        executable_cache->loaders[i], executable_params,
-        executable_cache->worker_capacity, out_executable);
+    iree_hal_executable_t* executable = NULL;
+    status = iree_hal_executable_loader_try_load(
+        loader, executable_params, executable_cache->worker_capacity,
+        &executable);
     if (iree_status_is_ok(status)) {
-      // Executable was successfully loaded.
-      return status;
+      if (shareable) {
+        // Executable was successfully loaded; publish it for other devices.
+        iree_hal_local_shared_executable_cache_insert(&key, executable,
+                                                      out_executable);
+        iree_hal_executable_release(executable);
+      } else {
+        *out_executable = executable;
+      }
+      loaded = true;
+      break;
     } else if (!iree_status_is_cancelled(status)) {
       // Error beyond just the try failing due to unsupported formats.
-      return status;
+      break;
     }
     iree_status_ignore(status);
+    status = iree_ok_status();
+  }
+  iree_allocator_free(executable_cache->host_allocator, layout_signature);
+
+  if (iree_status_is_ok(status) && !loaded) {
+    status = iree_make_status(
+        IREE_STATUS_NOT_FOUND,
+        "no executable loader registered for the given executable format "
+        "'%.*s'",
+        (int)executable_params->executable_format.size,
+        executable_params->executable_format.data);
+  }
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_deferred_executable_t
+//===----------------------------------------------------------------------===//
+// An executable that is loaded asynchronously using the cache scheduler.
+// Loading is started when the executable is prepared and dispatches resolve
+// the loaded executable, waiting for the load to complete if it is still in
+// progress. If the scheduled load has not started by the time the executable
+// is first resolved the resolving thread performs the load itself so that it
+// never waits behind unrelated work.
+
+typedef enum iree_hal_local_deferred_load_state_e {
+  // Load has not started.
+  IREE_HAL_LOCAL_DEFERRED_LOAD_PENDING = 0,
+  // Load is in progress on some thread.
+  IREE_HAL_LOCAL_DEFERRED_LOAD_LOADING,
+  // Load completed (successfully or not).
+  IREE_HAL_LOCAL_DEFERRED_LOAD_COMPLETE,
+  // Executable was released before the load started.
+  IREE_HAL_LOCAL_DEFERRED_LOAD_CANCELLED,
+} iree_hal_local_deferred_load_state_t;
+
+typedef struct iree_hal_local_deferred_executable_t
+    iree_hal_local_deferred_executable_t;
+
+// Load state shared between the executable and the scheduled load work.
+// Outlives the executable if it is released before the scheduled work runs.
+typedef struct iree_hal_local_deferred_load_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // iree_hal_local_deferred_load_state_t.
+  iree_atomic_int32_t state;
+  // Posted when the state changes to IREE_HAL_LOCAL_DEFERRED_LOAD_COMPLETE.
+  iree_notification_t notification;
+  // Only valid while the state is IREE_HAL_LOCAL_DEFERRED_LOAD_LOADING as
+  // the executable waits for the load to complete before being destroyed.
+  iree_hal_local_deferred_executable_t* executable;
+} iree_hal_local_deferred_load_t;
+
+struct iree_hal_local_deferred_executable_t {
+  iree_hal_local_executable_t base;
+  // Retained until the executable is destroyed for its loaders.
+  iree_hal_local_executable_cache_t* executable_cache;
+  // Parameters with all storage owned by the executable except for the
+  // executable data which the caller guarantees remains live.
+  iree_hal_executable_params_t params;
+  iree_hal_local_deferred_load_t* load;
+  // Result of the load; valid once the load has completed.
+  iree_status_t load_status;
+  iree_hal_executable_t* loaded_executable;
+  // + trailing pipeline layouts, constants, and format storage.
+};
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable;
+
+static iree_hal_local_deferred_executable_t*
+iree_hal_local_deferred_executable_cast(
+    iree_hal_local_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_deferred_executable_vtable);
+  return (iree_hal_local_deferred_executable_t*)base_value;
+}
+
+static void iree_hal_local_deferred_load_release(
+    iree_hal_local_deferred_load_t* load) {
+  if (iree_atomic_ref_count_dec(&load->ref_count) == 1) {
+    iree_notification_deinitialize(&load->notification);
+    iree_allocator_free(load->host_allocator, load);
   }
-  return iree_make_status(
-      IREE_STATUS_NOT_FOUND,
-      "no executable loader registered for the given executable format '%.*s'",
-      (int)executable_params->executable_format.size,
-      executable_params->executable_format.data);
+}
+
+static bool iree_hal_local_deferred_load_is_complete(void* arg) {
+  iree_hal_local_deferred_load_t* load = (iree_hal_local_deferred_load_t*)arg;
+  return iree_atomic_load_int32(&load->state, iree_memory_order_acquire) ==
+         IREE_HAL_LOCAL_DEFERRED_LOAD_COMPLETE;
+}
+
+// Transitions |load| from pending to loading and returns true if the caller
+// is responsible for performing the load.
+static bool iree_hal_local_deferred_load_try_begin(
+    iree_hal_local_deferred_load_t* load) {
+  int32_t expected = IREE_HAL_LOCAL_DEFERRED_LOAD_PENDING;
+  return iree_atomic_compare_exchange_strong_int32(
+      &load->state, &expected, IREE_HAL_LOCAL_DEFERRED_LOAD_LOADING,
+      iree_memory_order_acq_rel, iree_memory_order_acquire);
+}
+
+// Loads |executable| and publishes the result. Must only be called by the
+// thread that successfully began the load.
+static void iree_hal_local_deferred_executable_load(
+    iree_hal_local_deferred_executable_t* executable) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_local_deferred_load_t* load = executable->load;
+  executable->load_status = iree_hal_local_executable_cache_load(
+      executable->executable_cache, &executable->params,
+      &executable->loaded_executable);
+  iree_atomic_store_int32(&load->state, IREE_HAL_LOCAL_DEFERRED_LOAD_COMPLETE,
+                          iree_memory_order_release);
+  iree_notification_post(&load->notification, IREE_ALL_WAITERS);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Scheduled work performing the load if no other thread has begun it.
+static void IREE_API_PTR
+iree_hal_local_deferred_executable_load_work(void* user_data) {
+  iree_hal_local_deferred_load_t* load =
+      (iree_hal_local_deferred_load_t*)user_data;
+  if (iree_hal_local_deferred_load_try_begin(load)) {
+    iree_hal_local_deferred_executable_load(load->executable);
+  }
+  iree_hal_local_deferred_load_release(load);
+}
+
+// Creates an executable that will be loaded asynchronously from
+// |executable_params| and schedules its load with the cache scheduler.
+static iree_status_t iree_hal_local_deferred_executable_create(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = executable_cache->host_allocator;
+
+  iree_hal_local_deferred_load_t* load = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*load), (void**)&load));
+  iree_atomic_ref_count_init(&load->ref_count);
+  load->host_allocator = host_allocator;
+  iree_atomic_store_int32(&load->state, IREE_HAL_LOCAL_DEFERRED_LOAD_PENDING,
+                          iree_memory_order_relaxed);
+  iree_notification_initialize(&load->notification);
+
+  iree_hal_local_deferred_executable_t* executable = NULL;
+  const iree_host_size_t layouts_size =
+      executable_params->pipeline_layout_count *
+      sizeof(*executable_params->pipeline_layouts);
+  const iree_host_size_t constants_size =
+      executable_params->constant_count * sizeof(*executable_params->constants);
+  iree_host_size_t total_size = sizeof(*executable) + layouts_size +
+                                constants_size +
+                                executable_params->executable_format.size;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, total_size, (void**)&executable);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_local_deferred_load_release(load);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  uint8_t* storage = (uint8_t*)executable + sizeof(*executable);
+  iree_hal_pipeline_layout_t** layouts = (iree_hal_pipeline_layout_t**)storage;
+  iree_hal_local_executable_initialize(
+      &iree_hal_local_deferred_executable_vtable,
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, layouts, host_allocator,
+      &executable->base);
+  executable->executable_cache = executable_cache;
+  iree_hal_executable_cache_retain(
+      (iree_hal_executable_cache_t*)executable_cache);
+  executable->load = load;
+  executable->load_status = iree_ok_status();
+  executable->loaded_executable = NULL;
+  load->executable = executable;
+
+  // Copy everything but the data (which the caller allows us to alias) so that
+  // the load can happen after the caller returns.
+  executable->params = *executable_params;
+  executable->params.pipeline_layouts = layouts;
+  uint32_t* constants = (uint32_t*)(storage + layouts_size);
+  if (constants_size > 0) {
+    memcpy(constants, executable_params->constants, constants_size);
+  }
+  executable->params.constants = constants;
+  char* format = (char*)(storage + layouts_size + constants_size);
+  iree_string_view_append_to_buffer(executable_params->executable_format,
+                                    &executable->params.executable_format,
+                                    format);
+
+  // The scheduled work holds a reference to the load state until it runs. If
+  // the work cannot be scheduled the executable is loaded on first use.
+  iree_atomic_ref_count_inc(&load->ref_count);
+  status = executable_cache->scheduler.schedule(
+      executable_cache->scheduler.self,
+      iree_hal_local_deferred_executable_load_work, load);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_local_deferred_load_release(load);
+    iree_status_ignore(status);
+  }
+
+  *out_executable = (iree_hal_executable_t*)executable;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_local_deferred_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      iree_hal_local_deferred_executable_cast(
+          (iree_hal_local_executable_t*)base_executable);
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Cancel the load if it has not started; otherwise wait for it to stop using
+  // the executable (and the executable data the caller keeps live only as long
+  // as it retains the executable).
+  iree_hal_local_deferred_load_t* load = executable->load;
+  int32_t expected = IREE_HAL_LOCAL_DEFERRED_LOAD_PENDING;
+  if (!iree_atomic_compare_exchange_strong_int32(
+          &load->state, &expected, IREE_HAL_LOCAL_DEFERRED_LOAD_CANCELLED,
+          iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+    iree_notification_await(&load->notification,
+                            iree_hal_local_deferred_load_is_complete, load,
+                            iree_infinite_timeout());
+  }
+  iree_hal_local_deferred_load_release(load);
+
+  iree_hal_executable_release(executable->loaded_executable);
+  iree_status_ignore(executable->load_status);
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable->executable_cache);
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_local_deferred_executable_resolve(
+    iree_hal_local_executable_t* base_executable,
+    iree_hal_local_executable_t** out_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      iree_hal_local_deferred_executable_cast(base_executable);
+  iree_hal_local_deferred_load_t* load = executable->load;
+  if (IREE_UNLIKELY(!iree_hal_local_deferred_load_is_complete(load))) {
+    IREE_TRACE_ZONE_BEGIN(z0);
+    if (iree_hal_local_deferred_load_try_begin(load)) {
+      // Scheduled work has not started yet; load on this thread instead of
+      // waiting for it.
+      iree_hal_local_deferred_executable_load(executable);
+    } else {
+      iree_notification_await(&load->notification,
+                              iree_hal_local_deferred_load_is_complete, load,
+                              iree_infinite_timeout());
+    }
+    IREE_TRACE_ZONE_END(z0);
+  }
+  if (IREE_UNLIKELY(!iree_status_is_ok(executable->load_status))) {
+    return iree_status_clone(executable->load_status);
+  }
+  *out_executable =
+      iree_hal_local_executable_cast(executable->loaded_executable);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_deferred_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  // Dispatches should have resolved the executable when recorded but this
+  // keeps direct calls working.
+  iree_hal_local_executable_t* loaded_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_deferred_executable_resolve(
+      base_executable, &loaded_executable));
+  return iree_hal_local_executable_issue_call(loaded_executable, ordinal,
+                                              dispatch_state, workgroup_state,
+                                              worker_id);
+}
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable = {
+        .base =
+            {
+                .destroy = iree_hal_local_deferred_executable_destroy,
+            },
+        .issue_call = iree_hal_local_deferred_executable_issue_call,
+        .resolve = iree_hal_local_deferred_executable_resolve,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+
+  // Loading is deferred when there is a scheduler to run it on and the caller
+  // allows us to reference the executable data after returning. Formats that
+  // no loader supports are rejected immediately.
+  if (executable_cache->scheduler.schedule &&
+      iree_all_bits_set(executable_params->caching_mode,
+                        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA) &&
+      iree_hal_query_any_executable_loader_support(
+          executable_cache->loader_count, executable_cache->loaders,
+          executable_params->caching_mode,
+          executable_params->executable_format)) {
+    return iree_hal_local_deferred_executable_create(
+        executable_cache, executable_params, out_executable);
+  }
+
+  return iree_hal_local_executable_cache_load(
+      executable_cache, executable_params, out_executable);
 }
 
 static const iree_hal_executable_cache_vtable_t
@@ -15,16 +15,50 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Function performing work scheduled by an executable cache.
+typedef void(IREE_API_PTR* iree_hal_local_executable_cache_work_fn_t)(
+    void* user_data);
+
+// Interface used to schedule executable loads to run asynchronously.
+typedef struct iree_hal_local_executable_cache_scheduler_t {
+  // User-defined pointer passed to all functions.
+  void* self;
+
+  // Schedules |fn| to be called with |user_data| once on any thread. If an
+  // error is returned |fn| must not be called.
+  iree_status_t(IREE_API_PTR* schedule)(
+      void* self, iree_hal_local_executable_cache_work_fn_t fn,
+      void* user_data);
+} iree_hal_local_executable_cache_scheduler_t;
+
+// Returns a scheduler that causes all executables to be loaded synchronously.
+static inline iree_hal_local_executable_cache_scheduler_t
+iree_hal_local_executable_cache_scheduler_null(void) {
+  iree_hal_local_executable_cache_scheduler_t scheduler = {NULL, NULL};
+  return scheduler;
+}
+
+// Creates an executable cache that loads executables with the first of
+// |loaders| that supports them.
+//
+// Shareable executables are published to the process-wide shared executable
+// cache (see shared_executable_cache.h) such that all devices and contexts
+// preparing the same executable with the same loader share one loaded copy.
+//
+// If a |scheduler| is provided then executables whose data the caller allows
+// to be aliased (IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA) are
+// loaded asynchronously with it: preparation returns immediately and loads of
+// all executables prepared by a module proceed in parallel. Dispatches wait
+// for the load to complete (or perform it if it has not started) and any load
+// errors are reported when the executable is first dispatched.
+//
 // TODO(benvanik): when we refactor executable caches this can become something
 // more specialized; like nop_executable_cache (does nothing but pass through)
 // or inproc_lru_executable_cache (simple in-memory LRU of recent executables).
-//
-// We can also set this up so they share storage. Ideally a JIT'ed executable in
-// one device is the same JIT'ed executable in another, and in multi-tenant
-// situations we're likely to want that isolation _and_ sharing.
 
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
@@ -0,0 +1,334 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_executable_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Test loader and executable
+//===----------------------------------------------------------------------===//
+
+// Loader of executables with the "test" format that can block loads until
+// released and fail them with a configured status code.
+struct TestLoader {
+  iree_hal_executable_loader_t base;
+  std::atomic<int> load_count{0};
+  std::atomic<int> live_executable_count{0};
+  std::atomic<bool> loading{false};
+  iree_status_code_t load_error = IREE_STATUS_OK;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool blocked = false;
+
+  static TestLoader* Cast(iree_hal_executable_loader_t* loader) {
+    return reinterpret_cast<TestLoader*>(loader);
+  }
+
+  void Block() {
+    std::lock_guard<std::mutex> lock(mutex);
+    blocked = true;
+  }
+
+  void Unblock() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocked = false;
+    }
+    cv.notify_all();
+  }
+
+  // Waits until a load has started.
+  void WaitForLoading() {
+    while (!loading) std::this_thread::yield();
+  }
+};
+
+struct TestExecutable {
+  iree_hal_local_executable_t base;
+  TestLoader* loader;
+};
+
+static void TestExecutableDestroy(iree_hal_executable_t* base_executable) {
+  TestExecutable* executable =
+      reinterpret_cast<TestExecutable*>(base_executable);
+  --executable->loader->live_executable_count;
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(iree_allocator_system(), executable);
+}
+
+static const iree_hal_local_executable_vtable_t kTestExecutableVTable = {
+    /*.base=*/{/*.destroy=*/TestExecutableDestroy},
+    /*.issue_call=*/nullptr,
+    /*.resolve=*/nullptr,
+};
+
+static void TestLoaderDestroy(iree_hal_executable_loader_t* loader) {
+  delete TestLoader::Cast(loader);
+}
+
+static bool TestLoaderQuerySupport(
+    iree_hal_executable_loader_t* loader,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  return iree_string_view_equal(executable_format,
+                                iree_make_cstring_view("test"));
+}
+
+static iree_status_t TestLoaderTryLoad(
+    iree_hal_executable_loader_t* base_loader,
+    const iree_hal_executable_params_t* executable_params,
+    iree_host_size_t worker_capacity, iree_hal_executable_t** out_executable) {
+  TestLoader* loader = TestLoader::Cast(base_loader);
+  ++loader->load_count;
+  loader->loading = true;
+  {
+    std::unique_lock<std::mutex> lock(loader->mutex);
+    loader->cv.wait(lock, [&]() { return !loader->blocked; });
+  }
+  if (loader->load_error != IREE_STATUS_OK) {
+    return iree_make_status(loader->load_error, "test load failure");
+  }
+  TestExecutable* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(), sizeof(*executable), (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &kTestExecutableVTable, /*pipeline_layout_count=*/0, NULL, NULL,
+      iree_allocator_system(), &executable->base);
+  executable->loader = loader;
+  ++loader->live_executable_count;
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static const iree_hal_executable_loader_vtable_t kTestLoaderVTable = {
+    /*.destroy=*/TestLoaderDestroy,
+    /*.query_support=*/TestLoaderQuerySupport,
+    /*.try_load=*/TestLoaderTryLoad,
+};
+
+//===----------------------------------------------------------------------===//
+// Deferred executable loading
+//===----------------------------------------------------------------------===//
+
+class LocalExecutableCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    loader_ = new TestLoader();
+    iree_hal_executable_loader_initialize(
+        &kTestLoaderVTable, iree_hal_executable_import_provider_null(),
+        &loader_->base);
+    iree_hal_local_executable_cache_scheduler_t scheduler = {
+        /*.self=*/this,
+        /*.schedule=*/Schedule,
+    };
+    iree_hal_executable_loader_t* loaders[] = {&loader_->base};
+    IREE_ASSERT_OK(iree_hal_local_executable_cache_create(
+        iree_make_cstring_view("test"), /*worker_capacity=*/1, scheduler,
+        IREE_ARRAYSIZE(loaders), loaders, iree_allocator_system(),
+        &executable_cache_));
+  }
+
+  void TearDown() override {
+    // Scheduled work holds references to the load state until it runs.
+    RunScheduledWork();
+    iree_hal_executable_cache_release(executable_cache_);
+    EXPECT_EQ(loader_->live_executable_count, 0);
+    iree_hal_executable_loader_release(&loader_->base);
+  }
+
+  static iree_status_t Schedule(void* self,
+                                iree_hal_local_executable_cache_work_fn_t fn,
+                                void* user_data) {
+    LocalExecutableCacheTest* test =
+        reinterpret_cast<LocalExecutableCacheTest*>(self);
+    std::lock_guard<std::mutex> lock(test->work_mutex_);
+    test->work_.emplace_back(fn, user_data);
+    return iree_ok_status();
+  }
+
+  // Runs all scheduled work on the calling thread.
+  void RunScheduledWork() {
+    std::vector<std::pair<iree_hal_local_executable_cache_work_fn_t, void*>>
+        work;
+    {
+      std::lock_guard<std::mutex> lock(work_mutex_);
+      work.swap(work_);
+    }
+    for (auto& item : work) item.first(item.second);
+  }
+
+  iree_host_size_t ScheduledWorkCount() {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    return work_.size();
+  }
+
+  // Prepares an executable that is loaded asynchronously unless
+  // |caching_mode| disallows aliasing the executable data.
+  iree_hal_executable_t* Prepare(
+      iree_hal_executable_caching_mode_t caching_mode =
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA) {
+    static const uint8_t kData[] = {1, 2, 3, 4};
+    iree_hal_executable_params_t params;
+    iree_hal_executable_params_initialize(&params);
+    params.caching_mode = caching_mode;
+    params.executable_format = iree_make_cstring_view("test");
+    params.executable_data = iree_make_const_byte_span(kData, sizeof(kData));
+    iree_hal_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &params, &executable));
+    return executable;
+  }
+
+  static iree_status_t Resolve(iree_hal_executable_t* executable,
+                               iree_hal_local_executable_t** out_executable) {
+    return iree_hal_local_executable_resolve(
+        iree_hal_local_executable_cast(executable), out_executable);
+  }
+
+  TestLoader* loader_ = NULL;
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+  std::mutex work_mutex_;
+  std::vector<std::pair<iree_hal_local_executable_cache_work_fn_t, void*>>
+      work_;
+};
+
+// Executables whose data cannot be aliased are loaded immediately.
+TEST_F(LocalExecutableCacheTest, LoadsSynchronouslyWithoutAlias) {
+  iree_hal_executable_t* executable =
+      Prepare(IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION);
+  EXPECT_EQ(loader_->load_count, 1);
+  EXPECT_EQ(ScheduledWorkCount(), 0);
+  iree_hal_local_executable_t* resolved = NULL;
+  IREE_ASSERT_OK(Resolve(executable, &resolved));
+  EXPECT_EQ(resolved, iree_hal_local_executable_cast(executable));
+  iree_hal_executable_release(executable);
+}
+
+// The first resolve performs the load if the scheduled work has not started
+// and the scheduled work then does nothing.
+TEST_F(LocalExecutableCacheTest, LoadsOnFirstResolve) {
+  iree_hal_executable_t* executable = Prepare();
+  EXPECT_EQ(loader_->load_count, 0);
+  EXPECT_EQ(ScheduledWorkCount(), 1);
+
+  iree_hal_local_executable_t* resolved = NULL;
+  IREE_ASSERT_OK(Resolve(executable, &resolved));
+  EXPECT_EQ(loader_->load_count, 1);
+  EXPECT_NE(resolved, iree_hal_local_executable_cast(executable));
+  iree_hal_local_executable_t* resolved_again = NULL;
+  IREE_ASSERT_OK(Resolve(executable, &resolved_again));
+  EXPECT_EQ(resolved_again, resolved);
+
+  RunScheduledWork();
+  EXPECT_EQ(loader_->load_count, 1);
+  iree_hal_executable_release(executable);
+}
+
+// Scheduled work loads the executable before it is first resolved.
+TEST_F(LocalExecutableCacheTest, LoadsOnScheduledWork) {
+  iree_hal_executable_t* executable = Prepare();
+  RunScheduledWork();
+  EXPECT_EQ(loader_->load_count, 1);
+  iree_hal_local_executable_t* resolved = NULL;
+  IREE_ASSERT_OK(Resolve(executable, &resolved));
+  EXPECT_EQ(loader_->load_count, 1);
+  iree_hal_executable_release(executable);
+}
+
+// Releasing the executable before the scheduled work runs cancels the load.
+TEST_F(LocalExecutableCacheTest, DestroyBeforeLoadStarts) {
+  iree_hal_executable_t* executable = Prepare();
+  iree_hal_executable_release(executable);
+  RunScheduledWork();
+  EXPECT_EQ(loader_->load_count, 0);
+}
+
+// Releasing the executable while it is loading waits for the load to finish
+// and releases the loaded executable.
+TEST_F(LocalExecutableCacheTest, DestroyWhileLoading) {
+  iree_hal_executable_t* executable = Prepare();
+  loader_->Block();
+  std::thread worker([&]() { RunScheduledWork(); });
+  loader_->WaitForLoading();
+
+  std::atomic<bool> released{false};
+  std::thread releaser([&]() {
+    iree_hal_executable_release(executable);
+    released = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(released);
+
+  loader_->Unblock();
+  worker.join();
+  releaser.join();
+  EXPECT_TRUE(released);
+  EXPECT_EQ(loader_->load_count, 1);
+  EXPECT_EQ(loader_->live_executable_count, 0);
+}
+
+// Load failures are reported by every resolve of the executable.
+TEST_F(LocalExecutableCacheTest, LoadErrorReportedOnResolve) {
+  loader_->load_error = IREE_STATUS_INVALID_ARGUMENT;
+  iree_hal_executable_t* executable = Prepare();
+  RunScheduledWork();
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_local_executable_t* resolved = NULL;
+    iree_status_t status = Resolve(executable, &resolved);
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT, status);
+    iree_status_free(status);
+  }
+  EXPECT_EQ(loader_->load_count, 1);
+  iree_hal_executable_release(executable);
+}
+
+// Concurrent resolves (and the scheduled work) load the executable once and
+// all observe the same loaded executable.
+TEST_F(LocalExecutableCacheTest, ConcurrentResolves) {
+  iree_hal_executable_t* executable = Prepare();
+  loader_->Block();
+  constexpr int kThreadCount = 8;
+  std::vector<iree_hal_local_executable_t*> resolved(kThreadCount, nullptr);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back(
+        [&, i]() { IREE_EXPECT_OK(Resolve(executable, &resolved[i])); });
+  }
+  threads.emplace_back([&]() { RunScheduledWork(); });
+  loader_->WaitForLoading();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  loader_->Unblock();
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(loader_->load_count, 1);
+  ASSERT_NE(resolved[0], nullptr);
+  for (int i = 1; i < kThreadCount; ++i) {
+    EXPECT_EQ(resolved[i], resolved[0]);
+  }
+  iree_hal_executable_release(executable);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
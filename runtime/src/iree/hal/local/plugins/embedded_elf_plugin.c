@@ -41,7 +41,8 @@ iree_status_t iree_hal_embedded_elf_executable_plugin_load_from_memory(
 
   // Attempt to load the ELF module.
   iree_status_t status = iree_elf_module_initialize_from_memory(
-      buffer, /*import_table=*/NULL, host_allocator, &plugin->module);
+      buffer, /*import_table=*/NULL, IREE_ELF_MODULE_FLAG_NONE, host_allocator,
+      &plugin->module);
 
   // Get the exported symbol used to get the plugin metadata.
   iree_hal_executable_plugin_query_fn_t query_fn = NULL;
@@ -137,8 +138,8 @@ iree_status_t iree_hal_embedded_elf_executable_plugin_load_from_file(
 
   // Attempt to load the ELF module.
   status = iree_elf_module_initialize_from_memory(
-      file_contents->const_buffer, /*import_table=*/NULL, host_allocator,
-      &plugin->module);
+      file_contents->const_buffer, /*import_table=*/NULL,
+      IREE_ELF_MODULE_FLAG_NONE, host_allocator, &plugin->module);
 
   // Get the exported symbol used to get the plugin metadata.
   iree_hal_executable_plugin_query_fn_t query_fn = NULL;
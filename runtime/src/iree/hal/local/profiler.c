@@ -0,0 +1,670 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#define IREE_HAL_LOCAL_PROFILER_PERF_EVENTS 1
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define IREE_HAL_LOCAL_PROFILER_PERF_EVENTS 0
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+//===----------------------------------------------------------------------===//
+// Counters
+//===----------------------------------------------------------------------===//
+
+// Counters captured for each dispatch in group order. The task clock is a
+// software counter that is always available and leads the group such that the
+// group can be read even when hardware counters are unavailable (such as in
+// virtual machines).
+typedef enum iree_hal_local_profiler_counter_e {
+  IREE_HAL_LOCAL_PROFILER_COUNTER_TASK_CLOCK = 0,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_MISSES,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_BRANCH_MISSES,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT,
+} iree_hal_local_profiler_counter_t;
+
+static_assert(IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT <=
+                  IREE_HAL_LOCAL_PROFILER_MAX_COUNTERS,
+              "sample storage must hold all counters");
+
+static const char* iree_hal_local_profiler_counter_names[] = {
+    "task_clock_ns", "cycles", "instructions", "cache_misses", "branch_misses",
+};
+
+//===----------------------------------------------------------------------===//
+// Per-thread capture state
+//===----------------------------------------------------------------------===//
+
+// Aggregated counters for one export.
+typedef struct iree_hal_local_profiler_entry_t {
+  // Process-unique executable ID or 0 if the entry is unused.
+  uint64_t executable_id;
+  iree_host_size_t ordinal;
+  // Copied export name or NULL if unavailable.
+  char* name;
+  uint64_t dispatch_count;
+  uint64_t workgroup_count;
+  uint64_t values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+} iree_hal_local_profiler_entry_t;
+
+// Capture state owned by a single thread. Only the owning thread modifies the
+// state while the capture is active.
+typedef struct iree_hal_local_profiler_thread_t {
+  struct iree_hal_local_profiler_thread_t* next;
+  // Capture the thread is registered with.
+  struct iree_hal_local_profiler_t* profiler;
+  // OS thread ID and name at the time the thread first dispatched.
+  int64_t thread_id;
+  char thread_name[32];
+  // Counter group file descriptors (-1 if unavailable). The task clock is the
+  // group leader.
+  int fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  // Index of each counter in the group read or -1 if unavailable.
+  int value_indices[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  int value_count;
+  // Open-addressed table of exports keyed by (executable_id, ordinal).
+  iree_host_size_t entry_capacity;  // power of two
+  iree_host_size_t entry_count;
+  iree_hal_local_profiler_entry_t* entries;
+} iree_hal_local_profiler_thread_t;
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiler_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_profiler_t {
+  iree_allocator_t host_allocator;
+  // Unique ID of the capture used to detect stale thread-local state.
+  int64_t capture_id;
+  // Output file path or empty to write to stderr.
+  iree_string_view_t file_path;
+  // Guards the thread list.
+  iree_slim_mutex_t mutex;
+  iree_hal_local_profiler_thread_t* threads;
+} iree_hal_local_profiler_t;
+
+// Active capture or 0 if not profiling.
+static iree_atomic_intptr_t iree_hal_local_profiler_active =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Number of dispatches between iree_hal_local_profiler_sample_begin and
+// iree_hal_local_profiler_sample_end. The capture is kept alive while any
+// sampler is active such that dispatches in flight when the capture ends can
+// still safely complete their samples.
+static iree_atomic_int32_t iree_hal_local_profiler_active_samplers =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Counter used to assign unique capture IDs.
+static iree_atomic_int64_t iree_hal_local_profiler_next_capture_id =
+    IREE_ATOMIC_VAR_INIT(1);
+
+static void iree_hal_local_profiler_thread_free(
+    iree_hal_local_profiler_t* profiler,
+    iree_hal_local_profiler_thread_t* thread) {
+#if IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+  for (int i = IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT - 1; i >= 0; --i) {
+    if (thread->fds[i] >= 0) close(thread->fds[i]);
+  }
+#endif  // IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+  for (iree_host_size_t i = 0; i < thread->entry_capacity; ++i) {
+    iree_allocator_free(profiler->host_allocator, thread->entries[i].name);
+  }
+  iree_allocator_free(profiler->host_allocator, thread->entries);
+  iree_allocator_free(profiler->host_allocator, thread);
+}
+
+static void iree_hal_local_profiler_free(iree_hal_local_profiler_t* profiler) {
+  iree_allocator_t host_allocator = profiler->host_allocator;
+  iree_hal_local_profiler_thread_t* thread = profiler->threads;
+  while (thread) {
+    iree_hal_local_profiler_thread_t* next_thread = thread->next;
+    iree_hal_local_profiler_thread_free(profiler, thread);
+    thread = next_thread;
+  }
+  iree_slim_mutex_deinitialize(&profiler->mutex);
+  iree_allocator_free(host_allocator, profiler);
+}
+
+#if IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+
+// Thread-local capture state. The state is only valid if the capture ID
+// matches the active capture.
+static _Thread_local int64_t iree_hal_local_profiler_thread_capture_id = 0;
+static _Thread_local iree_hal_local_profiler_thread_t*
+    iree_hal_local_profiler_thread_state = NULL;
+
+static int iree_hal_local_profiler_perf_event_open(
+    struct perf_event_attr* attr, int group_fd) {
+  // Measure the calling thread on any CPU.
+  return (int)syscall(SYS_perf_event_open, attr, /*pid=*/0, /*cpu=*/-1,
+                      group_fd, /*flags=*/0);
+}
+
+// Opens the counter group for the calling thread. Counters that are not
+// supported are marked unavailable. Fails only if the group leader cannot be
+// opened.
+static iree_status_t iree_hal_local_profiler_open_counters(
+    iree_hal_local_profiler_thread_t* thread) {
+  static const struct {
+    uint32_t type;
+    uint64_t config;
+  } counter_events[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT] = {
+      {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+  thread->value_count = 0;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = counter_events[i].type;
+    attr.config = counter_events[i].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = i == 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    const int group_fd = i == 0 ? -1 : thread->fds[0];
+    thread->fds[i] = iree_hal_local_profiler_perf_event_open(&attr, group_fd);
+    if (thread->fds[i] < 0) {
+      if (i == 0) {
+        int error_number = errno;
+        return iree_make_status(
+            iree_status_code_from_errno(error_number),
+            "perf_event_open failed (%s); check "
+            "/proc/sys/kernel/perf_event_paranoid",
+            strerror(error_number));
+      }
+      thread->value_indices[i] = -1;
+    } else {
+      thread->value_indices[i] = thread->value_count++;
+    }
+  }
+  ioctl(thread->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(thread->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return iree_ok_status();
+}
+
+// Reads all counters of the calling thread into |out_values|.
+// Unavailable counters are set to 0.
+static bool iree_hal_local_profiler_read_counters(
+    const iree_hal_local_profiler_thread_t* thread,
+    uint64_t out_values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  // PERF_FORMAT_GROUP: { u64 nr; u64 values[nr]; }
+  uint64_t buffer[1 + IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  ssize_t read_length = read(thread->fds[0], buffer, sizeof(buffer));
+  if (IREE_UNLIKELY(read_length <
+                    (ssize_t)((1 + thread->value_count) * sizeof(uint64_t)))) {
+    return false;
+  }
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    const int value_index = thread->value_indices[i];
+    out_values[i] = value_index >= 0 ? buffer[1 + value_index] : 0;
+  }
+  return true;
+}
+
+// Returns the capture state of the calling thread, registering the thread with
+// |profiler| if this is the first dispatch on the thread during the capture.
+// Returns NULL if counters are unavailable on the thread.
+static iree_hal_local_profiler_thread_t* iree_hal_local_profiler_thread_acquire(
+    iree_hal_local_profiler_t* profiler) {
+  if (IREE_LIKELY(iree_hal_local_profiler_thread_capture_id ==
+                  profiler->capture_id)) {
+    return iree_hal_local_profiler_thread_state;
+  }
+  iree_hal_local_profiler_thread_capture_id = profiler->capture_id;
+  iree_hal_local_profiler_thread_state = NULL;
+
+  iree_hal_local_profiler_thread_t* thread = NULL;
+  if (!iree_status_is_ok(iree_allocator_malloc(
+          profiler->host_allocator, sizeof(*thread), (void**)&thread))) {
+    return NULL;
+  }
+  memset(thread, 0, sizeof(*thread));
+  thread->profiler = profiler;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    thread->fds[i] = -1;
+  }
+  thread->thread_id = (int64_t)syscall(SYS_gettid);
+  prctl(PR_GET_NAME, thread->thread_name, 0, 0, 0);
+  thread->thread_name[sizeof(thread->thread_name) - 1] = 0;
+  iree_status_t status = iree_hal_local_profiler_open_counters(thread);
+
+  // Threads that failed to open counters are still registered such that their
+  // resources are released when the capture ends.
+  iree_slim_mutex_lock(&profiler->mutex);
+  thread->next = profiler->threads;
+  profiler->threads = thread;
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return NULL;
+  }
+  iree_hal_local_profiler_thread_state = thread;
+  return thread;
+}
+
+#endif  // IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+
+static iree_host_size_t iree_hal_local_profiler_hash(uint64_t executable_id,
+                                                     iree_host_size_t ordinal) {
+  uint64_t key = executable_id ^ ((uint64_t)ordinal << 48);
+  // Finalizer from splitmix64.
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+  return (iree_host_size_t)(key ^ (key >> 31));
+}
+
+// Returns the slot for (|executable_id|, |ordinal|) in |entries|; either the
+// existing entry or an empty one where it should be inserted.
+static iree_hal_local_profiler_entry_t* iree_hal_local_profiler_lookup(
+    iree_hal_local_profiler_entry_t* entries, iree_host_size_t capacity,
+    uint64_t executable_id, iree_host_size_t ordinal) {
+  iree_host_size_t mask = capacity - 1;
+  iree_host_size_t i =
+      iree_hal_local_profiler_hash(executable_id, ordinal) & mask;
+  while (entries[i].executable_id &&
+         (entries[i].executable_id != executable_id ||
+          entries[i].ordinal != ordinal)) {
+    i = (i + 1) & mask;
+  }
+  return &entries[i];
+}
+
+// Grows the export table of |thread| such that at least one more entry can be
+// inserted while keeping the load factor at or below 1/2.
+static iree_status_t iree_hal_local_profiler_thread_reserve(
+    iree_hal_local_profiler_t* profiler,
+    iree_hal_local_profiler_thread_t* thread) {
+  if ((thread->entry_count + 1) * 2 <= thread->entry_capacity) {
+    return iree_ok_status();
+  }
+  iree_host_size_t new_capacity =
+      thread->entry_capacity ? thread->entry_capacity * 2 : 64;
+  iree_hal_local_profiler_entry_t* new_entries = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      profiler->host_allocator, new_capacity * sizeof(*new_entries),
+      (void**)&new_entries));
+  memset(new_entries, 0, new_capacity * sizeof(*new_entries));
+  for (iree_host_size_t i = 0; i < thread->entry_capacity; ++i) {
+    const iree_hal_local_profiler_entry_t* entry = &thread->entries[i];
+    if (!entry->executable_id) continue;
+    *iree_hal_local_profiler_lookup(new_entries, new_capacity,
+                                    entry->executable_id, entry->ordinal) =
+        *entry;
+  }
+  iree_allocator_free(profiler->host_allocator, thread->entries);
+  thread->entries = new_entries;
+  thread->entry_capacity = new_capacity;
+  return iree_ok_status();
+}
+
+// Accumulates the counter deltas of a dispatch into the export entry of
+// |thread|. The entry table must have room for at least one more entry.
+static void iree_hal_local_profiler_accumulate(
+    iree_hal_local_profiler_t* profiler,
+    iree_hal_local_profiler_thread_t* thread, uint64_t executable_id,
+    iree_host_size_t ordinal, const char* export_name,
+    uint32_t dispatch_count, uint32_t workgroup_count,
+    const uint64_t begin_values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT],
+    const uint64_t end_values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  iree_hal_local_profiler_entry_t* entry = iree_hal_local_profiler_lookup(
+      thread->entries, thread->entry_capacity, executable_id, ordinal);
+  if (!entry->executable_id) {
+    entry->executable_id = executable_id;
+    entry->ordinal = ordinal;
+    if (export_name) {
+      iree_host_size_t name_length = strlen(export_name);
+      if (iree_status_is_ok(iree_allocator_malloc(profiler->host_allocator,
+                                                  name_length + 1,
+                                                  (void**)&entry->name))) {
+        memcpy(entry->name, export_name, name_length + 1);
+      }
+    }
+    ++thread->entry_count;
+  }
+  entry->dispatch_count += dispatch_count;
+  entry->workgroup_count += workgroup_count;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    entry->values[i] += end_values[i] - begin_values[i];
+  }
+}
+
+bool iree_hal_local_profiler_sample_begin(
+    iree_hal_local_profiler_sample_t* out_sample) {
+#if IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+  // Fast path when not profiling. The sampler is registered before the capture
+  // is loaded (both sequentially consistent) such that either
+  // iree_hal_local_profiler_end observes the sampler and waits for it or the
+  // sampler observes that the capture has ended.
+  if (IREE_LIKELY(!iree_atomic_load_intptr(&iree_hal_local_profiler_active,
+                                           iree_memory_order_relaxed))) {
+    return false;
+  }
+  iree_atomic_fetch_add_int32(&iree_hal_local_profiler_active_samplers, 1,
+                              iree_memory_order_seq_cst);
+  iree_hal_local_profiler_t* profiler =
+      (iree_hal_local_profiler_t*)iree_atomic_load_intptr(
+          &iree_hal_local_profiler_active, iree_memory_order_seq_cst);
+  iree_hal_local_profiler_thread_t* thread =
+      profiler ? iree_hal_local_profiler_thread_acquire(profiler) : NULL;
+  if (!thread ||
+      !iree_hal_local_profiler_read_counters(thread, out_sample->values)) {
+    iree_atomic_fetch_sub_int32(&iree_hal_local_profiler_active_samplers, 1,
+                                iree_memory_order_release);
+    return false;
+  }
+  out_sample->thread = thread;
+  return true;
+#else
+  return false;
+#endif  // IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+}
+
+void iree_hal_local_profiler_sample_end(
+    const iree_hal_local_profiler_sample_t* sample, uint64_t executable_id,
+    iree_host_size_t ordinal, const char* export_name,
+    uint32_t dispatch_count, uint32_t workgroup_count) {
+#if IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+  // The capture that owns the thread state is kept alive until the sampler is
+  // released below even if iree_hal_local_profiler_end was called while the
+  // dispatch was running.
+  iree_hal_local_profiler_thread_t* thread =
+      (iree_hal_local_profiler_thread_t*)sample->thread;
+  iree_hal_local_profiler_t* profiler = thread->profiler;
+  uint64_t values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  if (iree_hal_local_profiler_read_counters(thread, values)) {
+    iree_status_t status =
+        iree_hal_local_profiler_thread_reserve(profiler, thread);
+    if (iree_status_is_ok(status)) {
+      iree_hal_local_profiler_accumulate(
+          profiler, thread, executable_id, ordinal, export_name,
+          dispatch_count, workgroup_count, sample->values, values);
+    }
+    iree_status_ignore(status);
+  }
+  iree_atomic_fetch_sub_int32(&iree_hal_local_profiler_active_samplers, 1,
+                              iree_memory_order_release);
+#endif  // IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+}
+
+//===----------------------------------------------------------------------===//
+// Capture control
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_local_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(options);
+#if IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_local_profiler_t* profiler = NULL;
+  iree_string_view_t file_path =
+      iree_make_cstring_view(options->file_path ? options->file_path : "");
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                sizeof(*profiler) + file_path.size + 1,
+                                (void**)&profiler));
+  memset(profiler, 0, sizeof(*profiler));
+  profiler->host_allocator = host_allocator;
+  profiler->capture_id = iree_atomic_fetch_add_int64(
+      &iree_hal_local_profiler_next_capture_id, 1, iree_memory_order_relaxed);
+  char* file_path_storage = (char*)profiler + sizeof(*profiler);
+  memcpy(file_path_storage, file_path.data, file_path.size);
+  file_path_storage[file_path.size] = 0;
+  profiler->file_path =
+      iree_make_string_view(file_path_storage, file_path.size);
+  iree_slim_mutex_initialize(&profiler->mutex);
+
+  // Verify counters can be opened such that permission issues are reported
+  // to the user instead of silently producing no results.
+  iree_hal_local_profiler_thread_t probe;
+  memset(&probe, 0, sizeof(probe));
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    probe.fds[i] = -1;
+  }
+  iree_status_t status = iree_hal_local_profiler_open_counters(&probe);
+  for (int i = IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT - 1; i >= 0; --i) {
+    if (probe.fds[i] >= 0) close(probe.fds[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    intptr_t expected = 0;
+    if (!iree_atomic_compare_exchange_strong_intptr(
+            &iree_hal_local_profiler_active, &expected, (intptr_t)profiler,
+            iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "a local dispatch profile capture is already "
+                                "active in the process");
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_local_profiler_free(profiler);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  // Unsupported on this platform; profiling is a no-op.
+  return iree_ok_status();
+#endif  // IREE_HAL_LOCAL_PROFILER_PERF_EVENTS
+}
+
+// Aggregated export entry used when writing results.
+typedef struct iree_hal_local_profiler_row_t {
+  const iree_hal_local_profiler_thread_t* thread;  // NULL for all threads
+  const iree_hal_local_profiler_entry_t* entry;
+  iree_hal_local_profiler_entry_t total;
+} iree_hal_local_profiler_row_t;
+
+static int iree_hal_local_profiler_compare_rows(const void* lhs_ptr,
+                                                const void* rhs_ptr) {
+  const iree_hal_local_profiler_row_t* lhs =
+      (const iree_hal_local_profiler_row_t*)lhs_ptr;
+  const iree_hal_local_profiler_row_t* rhs =
+      (const iree_hal_local_profiler_row_t*)rhs_ptr;
+  // Most expensive exports first (by thread CPU time).
+  const int i = IREE_HAL_LOCAL_PROFILER_COUNTER_TASK_CLOCK;
+  const uint64_t lhs_time = lhs->total.values[i];
+  const uint64_t rhs_time = rhs->total.values[i];
+  return lhs_time < rhs_time ? 1 : (lhs_time > rhs_time ? -1 : 0);
+}
+
+static iree_status_t iree_hal_local_profiler_append_row(
+    const iree_hal_local_profiler_entry_t* entry, const char* thread_name,
+    int64_t thread_id, const bool available[],
+    iree_string_builder_t* builder) {
+  if (entry->name) {
+    IREE_RETURN_IF_ERROR(
+        iree_string_builder_append_cstring(builder, entry->name));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "executable_%" PRIu64 "_%" PRIhsz, entry->executable_id,
+        entry->ordinal));
+  }
+  if (thread_name) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, ",%s:%" PRId64, thread_name, thread_id));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ",*"));
+  }
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, ",%" PRIu64 ",%" PRIu64, entry->dispatch_count,
+      entry->workgroup_count));
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    if (available[i]) {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, ",%" PRIu64, entry->values[i]));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ","));
+    }
+  }
+  const uint64_t cycles = entry->values[IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES];
+  const uint64_t instructions =
+      entry->values[IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS];
+  if (available[IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES] &&
+      available[IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS] && cycles) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, ",%.3f\n", (double)instructions / (double)cycles));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ",\n"));
+  }
+  return iree_ok_status();
+}
+
+// Formats the results of |profiler| as CSV into |builder|.
+static iree_status_t iree_hal_local_profiler_format(
+    iree_hal_local_profiler_t* profiler, iree_string_builder_t* builder) {
+  // Counters are reported if available on any thread.
+  bool available[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT] = {0};
+  iree_host_size_t max_row_count = 0;
+  for (iree_hal_local_profiler_thread_t* thread = profiler->threads; thread;
+       thread = thread->next) {
+    for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+      available[i] |= thread->fds[i] >= 0;
+    }
+    max_row_count += thread->entry_count;
+  }
+
+  IREE_RETURN_IF_ERROR(
+      iree_string_builder_append_cstring(builder, "export,thread,dispatches,"
+                                                  "workgroups"));
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, ",%s", iree_hal_local_profiler_counter_names[i]));
+  }
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ",ipc\n"));
+  if (max_row_count == 0) return iree_ok_status();
+
+  // Totals across all threads for each export followed by the per-thread
+  // breakdown, both sorted by cost.
+  iree_hal_local_profiler_row_t* rows = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      profiler->host_allocator, 2 * max_row_count * sizeof(*rows),
+      (void**)&rows));
+  iree_hal_local_profiler_row_t* total_rows = rows;
+  iree_hal_local_profiler_row_t* thread_rows = rows + max_row_count;
+  iree_host_size_t total_row_count = 0;
+  iree_host_size_t thread_row_count = 0;
+  for (iree_hal_local_profiler_thread_t* thread = profiler->threads; thread;
+       thread = thread->next) {
+    for (iree_host_size_t i = 0; i < thread->entry_capacity; ++i) {
+      const iree_hal_local_profiler_entry_t* entry = &thread->entries[i];
+      if (!entry->executable_id) continue;
+      iree_hal_local_profiler_row_t* thread_row =
+          &thread_rows[thread_row_count++];
+      thread_row->thread = thread;
+      thread_row->entry = entry;
+      thread_row->total = *entry;
+
+      iree_hal_local_profiler_row_t* total_row = NULL;
+      for (iree_host_size_t j = 0; j < total_row_count; ++j) {
+        if (total_rows[j].total.executable_id == entry->executable_id &&
+            total_rows[j].total.ordinal == entry->ordinal) {
+          total_row = &total_rows[j];
+          break;
+        }
+      }
+      if (!total_row) {
+        total_row = &total_rows[total_row_count++];
+        memset(total_row, 0, sizeof(*total_row));
+        total_row->entry = entry;
+        total_row->total.executable_id = entry->executable_id;
+        total_row->total.ordinal = entry->ordinal;
+        total_row->total.name = entry->name;
+      }
+      total_row->total.dispatch_count += entry->dispatch_count;
+      total_row->total.workgroup_count += entry->workgroup_count;
+      for (int k = 0; k < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++k) {
+        total_row->total.values[k] += entry->values[k];
+      }
+    }
+  }
+  qsort(total_rows, total_row_count, sizeof(*total_rows),
+        iree_hal_local_profiler_compare_rows);
+  qsort(thread_rows, thread_row_count, sizeof(*thread_rows),
+        iree_hal_local_profiler_compare_rows);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < total_row_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_local_profiler_append_row(&total_rows[i].total, NULL, 0,
+                                                available, builder);
+  }
+  for (iree_host_size_t i = 0;
+       i < thread_row_count && iree_status_is_ok(status); ++i) {
+    const iree_hal_local_profiler_row_t* row = &thread_rows[i];
+    status = iree_hal_local_profiler_append_row(
+        &row->total, row->thread->thread_name, row->thread->thread_id,
+        available, builder);
+  }
+
+  iree_allocator_free(profiler->host_allocator, rows);
+  return status;
+}
+
+iree_status_t iree_hal_local_profiler_end(void) {
+  // Clearing the capture must be sequentially consistent with the sampler
+  // registration and capture load in iree_hal_local_profiler_sample_begin:
+  // with acquire/release alone both this thread and a sampler could miss each
+  // other's store and the capture could be freed while being sampled.
+  iree_hal_local_profiler_t* profiler =
+      (iree_hal_local_profiler_t*)iree_atomic_exchange_intptr(
+          &iree_hal_local_profiler_active, 0, iree_memory_order_seq_cst);
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait for dispatches that began sampling before the capture ended. Samples
+  // only span a single dispatch so this is expected to be short.
+  while (iree_atomic_load_int32(&iree_hal_local_profiler_active_samplers,
+                                iree_memory_order_seq_cst) > 0) {
+    iree_thread_yield();
+  }
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(profiler->host_allocator, &builder);
+  iree_status_t status = iree_hal_local_profiler_format(profiler, &builder);
+  if (iree_status_is_ok(status)) {
+    if (iree_string_view_is_empty(profiler->file_path)) {
+      fprintf(stderr, "%.*s", (int)iree_string_builder_size(&builder),
+              iree_string_builder_buffer(&builder));
+      fflush(stderr);
+    } else {
+      status = iree_file_write_contents(
+          profiler->file_path.data,
+          iree_make_const_byte_span(iree_string_builder_buffer(&builder),
+                                    iree_string_builder_size(&builder)));
+    }
+  }
+  iree_string_builder_deinitialize(&builder);
+
+  iree_hal_local_profiler_free(profiler);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
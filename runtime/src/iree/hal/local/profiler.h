@@ -0,0 +1,95 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_PROFILER_H_
+#define IREE_HAL_LOCAL_PROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Local dispatch profiling
+//===----------------------------------------------------------------------===//
+// Captures hardware performance counters around each executable dispatch
+// performed by local devices and aggregates them per executable export and
+// per host thread. On Linux/Android this uses perf_event_open with one counter
+// group per thread that is opened lazily the first time the thread dispatches
+// while profiling is active. Other platforms do not support counters and
+// profiling is a no-op.
+//
+// Counters captured (when supported by the kernel/hardware):
+//   task-clock (ns of thread CPU time), cycles, instructions, cache misses,
+//   branch misses
+//
+// Only one profile capture may be active in the process at a time and it
+// captures dispatches from all local devices. Ending the capture waits for
+// dispatches that are in flight to finish sampling.
+//
+// Results are written as CSV to the capture file path or, if none is
+// specified, to stderr. Each row aggregates one export either across all
+// threads (thread `*`) or on a single thread.
+
+// Returns true if |options| requests dispatch counters.
+static inline bool iree_hal_local_profiler_is_requested(
+    const iree_hal_device_profiling_options_t* options) {
+  return iree_any_bit_set(
+      options->mode, IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS |
+                         IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS);
+}
+
+// Begins a process-wide dispatch counter capture with the given |options|.
+// Returns IREE_STATUS_FAILED_PRECONDITION if a capture is already active and
+// IREE_STATUS_PERMISSION_DENIED if the process is not allowed to use
+// performance counters.
+iree_status_t iree_hal_local_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator);
+
+// Ends the active capture, if any, and writes out the results.
+iree_status_t iree_hal_local_profiler_end(void);
+
+// Maximum number of counters captured per dispatch.
+#define IREE_HAL_LOCAL_PROFILER_MAX_COUNTERS 5
+
+// Counter values captured at the start of a dispatch.
+typedef struct iree_hal_local_profiler_sample_t {
+  // Per-thread capture state or NULL if not profiling.
+  void* thread;
+  uint64_t values[IREE_HAL_LOCAL_PROFILER_MAX_COUNTERS];
+} iree_hal_local_profiler_sample_t;
+
+// Begins sampling a dispatch on the calling thread.
+// Returns false if no capture is active (or counters are unavailable on the
+// calling thread) in which case iree_hal_local_profiler_sample_end must not be
+// called. Otherwise iree_hal_local_profiler_sample_end must be called on the
+// same thread once the dispatch completes as ending the capture waits for it.
+bool iree_hal_local_profiler_sample_begin(
+    iree_hal_local_profiler_sample_t* out_sample);
+
+// Ends sampling a dispatch on the calling thread and accumulates the counter
+// deltas since |sample| into the export identified by |executable_id| and
+// |ordinal|. |executable_id| must be nonzero and unique for the lifetime of the
+// process (unlike executable addresses which may be reused once freed).
+// |export_name| is copied the first time the export is seen on the thread and
+// may be NULL if unavailable. |dispatch_count| and |workgroup_count| are added
+// to the export totals.
+void iree_hal_local_profiler_sample_end(
+    const iree_hal_local_profiler_sample_t* sample, uint64_t executable_id,
+    iree_host_size_t ordinal, const char* export_name,
+    uint32_t dispatch_count, uint32_t workgroup_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_PROFILER_H_
@@ -0,0 +1,187 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Stands in for the process-unique ID of an executable.
+static const uint64_t kExecutableId = 1;
+
+class ProfilerTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    IREE_EXPECT_OK(iree_hal_local_profiler_end());
+    for (auto& path : temp_paths_) remove(path.c_str());
+  }
+
+  // Returns a unique path in the test temporary directory that is removed
+  // when the test completes.
+  std::string GetTempPath(const char* unique_name) {
+    const char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+    if (!test_tmpdir) test_tmpdir = "/tmp";
+    std::random_device d;
+    uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+    char path[256];
+    snprintf(path, sizeof(path), "%s/iree_profiler_%" PRIx64 "_%s.csv",
+             test_tmpdir, random, unique_name);
+    temp_paths_.push_back(path);
+    return path;
+  }
+
+  // Begins a capture writing to |path|. Returns false if counters are not
+  // available to the process.
+  bool Begin(const std::string& path) {
+    iree_hal_device_profiling_options_t options = {0};
+    options.mode = IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS;
+    options.file_path = path.c_str();
+    iree_status_t status =
+        iree_hal_local_profiler_begin(&options, iree_allocator_system());
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      return false;
+    }
+    return true;
+  }
+
+  // Samples a single dispatch of |export_name| on the calling thread.
+  static void Dispatch(const char* export_name, uint32_t workgroup_count,
+                       uint64_t executable_id = kExecutableId) {
+    iree_hal_local_profiler_sample_t sample;
+    ASSERT_TRUE(iree_hal_local_profiler_sample_begin(&sample));
+    Spin();
+    iree_hal_local_profiler_sample_end(&sample, executable_id, /*ordinal=*/0,
+                                       export_name, /*dispatch_count=*/1,
+                                       workgroup_count);
+  }
+
+  // Performs some work such that counters advance.
+  static void Spin() {
+    volatile uint64_t value = 0;
+    for (int i = 0; i < 100000; ++i) value = value + i;
+  }
+
+  static std::string ReadFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+  }
+
+  std::vector<std::string> temp_paths_;
+};
+
+constexpr char kHeader[] =
+    "export,thread,dispatches,workgroups,task_clock_ns,cycles,instructions,"
+    "cache_misses,branch_misses,ipc\n";
+
+// Samples are ignored when no capture is active.
+TEST_F(ProfilerTest, Inactive) {
+  iree_hal_local_profiler_sample_t sample;
+  EXPECT_FALSE(iree_hal_local_profiler_sample_begin(&sample));
+  IREE_EXPECT_OK(iree_hal_local_profiler_end());
+}
+
+// Dispatches sampled during a capture are aggregated into the CSV.
+TEST_F(ProfilerTest, CaptureDispatches) {
+  std::string path = GetTempPath("CaptureDispatches");
+  if (!Begin(path)) GTEST_SKIP() << "performance counters unavailable";
+  Dispatch("dispatch_a", 4);
+  Dispatch("dispatch_a", 4);
+  IREE_ASSERT_OK(iree_hal_local_profiler_end());
+
+  std::string csv = ReadFile(path);
+  ASSERT_EQ(csv.compare(0, sizeof(kHeader) - 1, kHeader), 0) << csv;
+  EXPECT_NE(csv.find("\ndispatch_a,*,2,8,"), std::string::npos) << csv;
+}
+
+// Exports are keyed by executable ID such that executables allocated at the
+// address of a freed executable are reported separately.
+TEST_F(ProfilerTest, ExecutablesAreKeyedById) {
+  std::string path = GetTempPath("ExecutablesAreKeyedById");
+  if (!Begin(path)) GTEST_SKIP() << "performance counters unavailable";
+  Dispatch(/*export_name=*/NULL, 1, /*executable_id=*/1);
+  Dispatch(/*export_name=*/NULL, 2, /*executable_id=*/2);
+  Dispatch(/*export_name=*/NULL, 4, /*executable_id=*/1);
+  IREE_ASSERT_OK(iree_hal_local_profiler_end());
+
+  std::string csv = ReadFile(path);
+  EXPECT_NE(csv.find("\nexecutable_1_0,*,2,5,"), std::string::npos) << csv;
+  EXPECT_NE(csv.find("\nexecutable_2_0,*,1,2,"), std::string::npos) << csv;
+}
+
+// Thread state from an earlier capture is not reused by a later one.
+TEST_F(ProfilerTest, CapturesAreIndependent) {
+  std::string path_0 = GetTempPath("CapturesAreIndependent0");
+  if (!Begin(path_0)) GTEST_SKIP() << "performance counters unavailable";
+  Dispatch("dispatch_a", 1);
+  IREE_ASSERT_OK(iree_hal_local_profiler_end());
+
+  std::string path_1 = GetTempPath("CapturesAreIndependent1");
+  ASSERT_TRUE(Begin(path_1));
+  Dispatch("dispatch_b", 2);
+  IREE_ASSERT_OK(iree_hal_local_profiler_end());
+
+  std::string csv = ReadFile(path_1);
+  EXPECT_EQ(csv.find("dispatch_a"), std::string::npos) << csv;
+  EXPECT_NE(csv.find("\ndispatch_b,*,1,2,"), std::string::npos) << csv;
+}
+
+// Ending a capture while a dispatch is being sampled waits for the dispatch
+// and includes it in the results.
+TEST_F(ProfilerTest, EndDuringDispatch) {
+  std::string path = GetTempPath("EndDuringDispatch");
+  if (!Begin(path)) GTEST_SKIP() << "performance counters unavailable";
+
+  iree_hal_local_profiler_sample_t sample;
+  ASSERT_TRUE(iree_hal_local_profiler_sample_begin(&sample));
+  std::atomic<bool> ended{false};
+  std::thread thread([&]() {
+    IREE_EXPECT_OK(iree_hal_local_profiler_end());
+    ended = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(ended);
+
+  // New dispatches are not sampled once the capture has begun ending.
+  iree_hal_local_profiler_sample_t late_sample;
+  EXPECT_FALSE(iree_hal_local_profiler_sample_begin(&late_sample));
+
+  Spin();
+  iree_hal_local_profiler_sample_end(&sample, kExecutableId, /*ordinal=*/0,
+                                     "dispatch_a", /*dispatch_count=*/1,
+                                     /*workgroup_count=*/3);
+  thread.join();
+  EXPECT_TRUE(ended);
+
+  std::string csv = ReadFile(path);
+  EXPECT_NE(csv.find("\ndispatch_a,*,1,3,"), std::string::npos) << csv;
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
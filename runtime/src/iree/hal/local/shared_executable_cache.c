@@ -0,0 +1,319 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/shared_executable_cache.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+
+// Number of hash buckets in the table. Processes usually have dozens to
+// thousands of live executables and this only needs to keep chains short.
+#define IREE_HAL_LOCAL_SHARED_EXECUTABLE_BUCKET_COUNT 1024
+
+// A published executable. Entries are owned by the table and removed when the
+// executable is destroyed. The contents referenced by the key other than the
+// executable data are stored immediately following the entry.
+struct iree_hal_local_shared_executable_entry_t {
+  iree_hal_local_shared_executable_entry_t* next;
+  iree_hal_local_shared_executable_key_t key;
+  // Unretained; the entry is removed when the executable is destroyed.
+  iree_hal_local_executable_t* executable;
+};
+
+typedef struct iree_hal_local_shared_executable_table_t {
+  iree_slim_mutex_t mutex;
+  uint64_t hit_count;
+  uint64_t miss_count;
+  iree_host_size_t entry_count;
+  iree_hal_local_shared_executable_entry_t*
+      buckets[IREE_HAL_LOCAL_SHARED_EXECUTABLE_BUCKET_COUNT];
+} iree_hal_local_shared_executable_table_t;
+
+static iree_hal_local_shared_executable_table_t
+    iree_hal_local_shared_executables_;
+static iree_once_flag iree_hal_local_shared_executables_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_shared_executables_initialize(void) {
+  memset(&iree_hal_local_shared_executables_, 0,
+         sizeof(iree_hal_local_shared_executables_));
+  iree_slim_mutex_initialize(&iree_hal_local_shared_executables_.mutex);
+}
+
+static iree_hal_local_shared_executable_table_t*
+iree_hal_local_shared_executables(void) {
+  iree_call_once(&iree_hal_local_shared_executables_flag_,
+                 iree_hal_local_shared_executables_initialize);
+  return &iree_hal_local_shared_executables_;
+}
+
+static inline uint64_t iree_hal_local_shared_executable_mix(uint64_t value) {
+  value *= 0x9E3779B97F4A7C15ull;
+  return value ^ (value >> 29);
+}
+
+// Mixes with different constants than iree_hal_local_shared_executable_mix
+// such that the two digest lanes are independent.
+static inline uint64_t iree_hal_local_shared_executable_mix_alt(
+    uint64_t value) {
+  value *= 0xC2B2AE3D27D4EB4Full;
+  return value ^ (value >> 31);
+}
+
+uint64_t iree_hal_local_shared_executable_hash(uint64_t hash,
+                                               iree_const_byte_span_t data) {
+  // Executables can be many megabytes and are hashed on every load so this
+  // consumes a word at a time.
+  const uint8_t* ptr = data.data;
+  iree_host_size_t length = data.data_length;
+  for (; length >= sizeof(uint64_t);
+       ptr += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, ptr, sizeof(word));
+    hash = iree_hal_local_shared_executable_mix(hash ^ word);
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, ptr, length);
+  hash = iree_hal_local_shared_executable_mix(hash ^ tail);
+  return iree_hal_local_shared_executable_mix(hash ^ data.data_length);
+}
+
+void iree_hal_local_shared_executable_digest(iree_const_byte_span_t data,
+                                             uint64_t out_digest[2]) {
+  // Same word-at-a-time consumption as iree_hal_local_shared_executable_hash
+  // with two lanes mixed independently.
+  uint64_t lo = 0x6A09E667F3BCC908ull;
+  uint64_t hi = 0xBB67AE8584CAA73Bull;
+  const uint8_t* ptr = data.data;
+  iree_host_size_t length = data.data_length;
+  for (; length >= sizeof(uint64_t);
+       ptr += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, ptr, sizeof(word));
+    lo = iree_hal_local_shared_executable_mix(lo ^ word);
+    hi = iree_hal_local_shared_executable_mix_alt(hi + word);
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, ptr, length);
+  lo = iree_hal_local_shared_executable_mix(lo ^ tail);
+  hi = iree_hal_local_shared_executable_mix_alt(hi + tail);
+  out_digest[0] = iree_hal_local_shared_executable_mix(lo ^ data.data_length);
+  out_digest[1] =
+      iree_hal_local_shared_executable_mix_alt(hi + data.data_length);
+}
+
+uint64_t iree_hal_local_shared_executable_key_hash(
+    const iree_hal_local_shared_executable_key_t* key) {
+  uint64_t hash = 0;
+  hash = iree_hal_local_shared_executable_hash(
+      hash, iree_make_const_byte_span(key->executable_format.data,
+                                      key->executable_format.size));
+  hash = iree_hal_local_shared_executable_hash(
+      hash, iree_make_const_byte_span(key->executable_data_digest,
+                                      sizeof(key->executable_data_digest)));
+  hash = iree_hal_local_shared_executable_hash(hash, key->constants);
+  hash = iree_hal_local_shared_executable_hash(hash, key->layout_signature);
+  return hash;
+}
+
+static bool iree_hal_local_shared_executable_span_equal(
+    iree_const_byte_span_t lhs, iree_const_byte_span_t rhs) {
+  return lhs.data_length == rhs.data_length &&
+         (lhs.data_length == 0 ||
+          memcmp(lhs.data, rhs.data, lhs.data_length) == 0);
+}
+
+static bool iree_hal_local_shared_executable_key_equal(
+    const iree_hal_local_shared_executable_key_t* lhs,
+    const iree_hal_local_shared_executable_key_t* rhs) {
+  // The hash rejects nearly all mismatches before the contents are compared.
+  return lhs->content_hash == rhs->content_hash &&
+         lhs->loader == rhs->loader &&
+         lhs->worker_capacity == rhs->worker_capacity &&
+         lhs->caching_mode == rhs->caching_mode &&
+         iree_string_view_equal(lhs->executable_format,
+                                rhs->executable_format) &&
+         lhs->executable_data.data_length == rhs->executable_data.data_length &&
+         lhs->executable_data_digest[0] == rhs->executable_data_digest[0] &&
+         lhs->executable_data_digest[1] == rhs->executable_data_digest[1] &&
+         iree_hal_local_shared_executable_span_equal(lhs->constants,
+                                                     rhs->constants) &&
+         iree_hal_local_shared_executable_span_equal(lhs->layout_signature,
+                                                     rhs->layout_signature);
+}
+
+// Copies |span| to |*storage| and advances the storage pointer.
+static iree_const_byte_span_t iree_hal_local_shared_executable_copy_span(
+    iree_const_byte_span_t span, uint8_t** storage) {
+  if (span.data_length == 0) return iree_const_byte_span_empty();
+  memcpy(*storage, span.data, span.data_length);
+  iree_const_byte_span_t copy =
+      iree_make_const_byte_span(*storage, span.data_length);
+  *storage += span.data_length;
+  return copy;
+}
+
+static iree_hal_local_shared_executable_entry_t**
+iree_hal_local_shared_executable_bucket(
+    iree_hal_local_shared_executable_table_t* table,
+    const iree_hal_local_shared_executable_key_t* key) {
+  return &table->buckets[key->content_hash %
+                         IREE_HAL_LOCAL_SHARED_EXECUTABLE_BUCKET_COUNT];
+}
+
+// Retains |executable| unless its last reference has already been released
+// and it is pending removal from the table. Must be called with the table lock
+// held so that the executable is not freed while being inspected.
+static bool iree_hal_local_shared_executable_try_retain(
+    iree_hal_local_executable_t* executable) {
+  int32_t ref_count = iree_atomic_load_int32(&executable->resource.ref_count,
+                                             iree_memory_order_relaxed);
+  while (ref_count > 0) {
+    if (iree_atomic_compare_exchange_weak_int32(
+            &executable->resource.ref_count, &ref_count, ref_count + 1,
+            iree_memory_order_acquire, iree_memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns a retained live executable matching |key| or NULL.
+static iree_hal_executable_t* iree_hal_local_shared_executable_find(
+    iree_hal_local_shared_executable_table_t* table,
+    const iree_hal_local_shared_executable_key_t* key) {
+  for (iree_hal_local_shared_executable_entry_t* entry =
+           *iree_hal_local_shared_executable_bucket(table, key);
+       entry; entry = entry->next) {
+    if (iree_hal_local_shared_executable_key_equal(&entry->key, key) &&
+        iree_hal_local_shared_executable_try_retain(entry->executable)) {
+      return (iree_hal_executable_t*)entry->executable;
+    }
+  }
+  return NULL;
+}
+
+bool iree_hal_local_shared_executable_cache_lookup(
+    const iree_hal_local_shared_executable_key_t* key,
+    iree_hal_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  iree_hal_local_shared_executable_table_t* table =
+      iree_hal_local_shared_executables();
+  iree_slim_mutex_lock(&table->mutex);
+  *out_executable = iree_hal_local_shared_executable_find(table, key);
+  if (*out_executable) {
+    ++table->hit_count;
+  } else {
+    ++table->miss_count;
+  }
+  iree_slim_mutex_unlock(&table->mutex);
+  return *out_executable != NULL;
+}
+
+void iree_hal_local_shared_executable_cache_insert(
+    const iree_hal_local_shared_executable_key_t* key,
+    iree_hal_executable_t* executable, iree_hal_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  iree_hal_executable_retain(executable);
+  *out_executable = executable;
+  if (!iree_all_bits_set(local_executable->flags,
+                         IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE) ||
+      local_executable->shared_entry) {
+    return;
+  }
+
+  // Failing to allocate the entry only prevents sharing.
+  iree_hal_local_shared_executable_entry_t* entry = NULL;
+  iree_host_size_t total_size =
+      sizeof(*entry) + key->executable_format.size +
+      key->constants.data_length + key->layout_signature.data_length;
+  iree_status_t status = iree_allocator_malloc(iree_allocator_system(),
+                                               total_size, (void**)&entry);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return;
+  }
+  entry->key = *key;
+  uint8_t* storage = (uint8_t*)entry + sizeof(*entry);
+  iree_const_byte_span_t format = iree_hal_local_shared_executable_copy_span(
+      iree_make_const_byte_span(key->executable_format.data,
+                                key->executable_format.size),
+      &storage);
+  entry->key.executable_format =
+      iree_make_string_view((const char*)format.data, format.data_length);
+  entry->key.executable_data =
+      iree_make_const_byte_span(NULL, key->executable_data.data_length);
+  entry->key.constants =
+      iree_hal_local_shared_executable_copy_span(key->constants, &storage);
+  entry->key.layout_signature = iree_hal_local_shared_executable_copy_span(
+      key->layout_signature, &storage);
+  entry->executable = local_executable;
+
+  iree_hal_local_shared_executable_table_t* table =
+      iree_hal_local_shared_executables();
+  iree_slim_mutex_lock(&table->mutex);
+  iree_hal_executable_t* existing =
+      iree_hal_local_shared_executable_find(table, key);
+  if (!existing) {
+    iree_hal_local_shared_executable_entry_t** bucket =
+        iree_hal_local_shared_executable_bucket(table, key);
+    entry->next = *bucket;
+    *bucket = entry;
+    local_executable->shared_entry = entry;
+    ++table->entry_count;
+    iree_hal_executable_loader_retain(key->loader);
+  }
+  iree_slim_mutex_unlock(&table->mutex);
+
+  if (existing) {
+    // Lost the race with another load of the same executable.
+    iree_allocator_free(iree_allocator_system(), entry);
+    iree_hal_executable_release(*out_executable);
+    *out_executable = existing;
+  }
+}
+
+void iree_hal_local_shared_executable_cache_remove(
+    iree_hal_local_executable_t* executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  iree_hal_local_shared_executable_entry_t* entry = executable->shared_entry;
+  if (!entry) return;
+  iree_hal_local_shared_executable_table_t* table =
+      iree_hal_local_shared_executables();
+  iree_slim_mutex_lock(&table->mutex);
+  for (iree_hal_local_shared_executable_entry_t** it =
+           iree_hal_local_shared_executable_bucket(table, &entry->key);
+       *it; it = &(*it)->next) {
+    if (*it == entry) {
+      *it = entry->next;
+      --table->entry_count;
+      break;
+    }
+  }
+  executable->shared_entry = NULL;
+  iree_slim_mutex_unlock(&table->mutex);
+  iree_hal_executable_loader_release(entry->key.loader);
+  iree_allocator_free(iree_allocator_system(), entry);
+}
+
+void iree_hal_local_shared_executable_cache_query_statistics(
+    iree_hal_local_shared_executable_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_hal_local_shared_executable_table_t* table =
+      iree_hal_local_shared_executables();
+  iree_slim_mutex_lock(&table->mutex);
+  out_statistics->hit_count = table->hit_count;
+  out_statistics->miss_count = table->miss_count;
+  out_statistics->entry_count = table->entry_count;
+  iree_slim_mutex_unlock(&table->mutex);
+}
@@ -0,0 +1,118 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_SHARED_EXECUTABLE_CACHE_H_
+#define IREE_HAL_LOCAL_SHARED_EXECUTABLE_CACHE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Process-wide shared executable cache
+//===----------------------------------------------------------------------===//
+// Executables marked with IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE can be
+// published to a process-wide table keyed by the content of the executable and
+// the parameters it was loaded with. Subsequent loads of the same executable
+// with the same loader from any device or context retain the published
+// executable instead of parsing, copying, and relocating it again.
+//
+// The table does not retain executables: entries are removed when the last
+// reference to the executable is released. This keeps the table from extending
+// the lifetime of executables past that requested by users.
+//
+// Executable data is identified by its length and a 128-bit digest instead of
+// its contents: executables can be many megabytes and keeping a copy in each
+// published entry would double their resident size. The remaining contents of
+// the key are small and compared byte-for-byte.
+
+// Identifies a loaded executable.
+// All fields must match exactly. Keys used for lookups reference the contents
+// provided by the caller and published entries reference their own copies of
+// all but the executable data.
+typedef struct iree_hal_local_shared_executable_key_t {
+  // Loader used to load the executable. Retained by the table while an
+  // executable loaded with it is published.
+  iree_hal_executable_loader_t* loader;
+  // Worker capacity the executable was loaded with.
+  iree_host_size_t worker_capacity;
+  // Caching mode the executable was loaded with.
+  iree_hal_executable_caching_mode_t caching_mode;
+  // Executable format, data, and constants the executable was loaded from.
+  // Only the length of |executable_data| is retained by published entries.
+  iree_string_view_t executable_format;
+  iree_const_byte_span_t executable_data;
+  iree_const_byte_span_t constants;
+  // Digest of |executable_data| as returned by
+  // iree_hal_local_shared_executable_digest.
+  uint64_t executable_data_digest[2];
+  // Serialized structure of the pipeline layouts the executable was loaded
+  // with such that executables prepared on different devices can be shared.
+  iree_const_byte_span_t layout_signature;
+  // Hash of the key as returned by iree_hal_local_shared_executable_key_hash.
+  uint64_t content_hash;
+} iree_hal_local_shared_executable_key_t;
+
+// Statistics of the process-wide shared executable cache.
+typedef struct iree_hal_local_shared_executable_statistics_t {
+  // Total number of lookups that returned a published executable.
+  uint64_t hit_count;
+  // Total number of lookups that did not find a published executable.
+  uint64_t miss_count;
+  // Number of executables currently published.
+  iree_host_size_t entry_count;
+} iree_hal_local_shared_executable_statistics_t;
+
+// Returns a hash of |data| continuing from |hash|.
+uint64_t iree_hal_local_shared_executable_hash(uint64_t hash,
+                                               iree_const_byte_span_t data);
+
+// Computes a 128-bit digest of |data| into |out_digest|.
+// Accidental collisions are negligible but the digest is not cryptographic.
+void iree_hal_local_shared_executable_digest(iree_const_byte_span_t data,
+                                             uint64_t out_digest[2]);
+
+// Returns the hash of |key|. The executable data digest must have been
+// computed.
+uint64_t iree_hal_local_shared_executable_key_hash(
+    const iree_hal_local_shared_executable_key_t* key);
+
+// Looks up a published executable matching |key| and returns it retained in
+// |out_executable|. Returns false if no live executable was found.
+bool iree_hal_local_shared_executable_cache_lookup(
+    const iree_hal_local_shared_executable_key_t* key,
+    iree_hal_executable_t** out_executable);
+
+// Publishes |executable| loaded as described by |key| and returns the
+// executable to use retained in |out_executable|. If an equivalent executable
+// was published by another thread since a lookup failed it is returned instead.
+// Executables that are not shareable are returned without being published.
+// The caller retains its reference to |executable|.
+void iree_hal_local_shared_executable_cache_insert(
+    const iree_hal_local_shared_executable_key_t* key,
+    iree_hal_executable_t* executable, iree_hal_executable_t** out_executable);
+
+// Removes |executable| from the table.
+// Called by iree_hal_local_executable_deinitialize.
+void iree_hal_local_shared_executable_cache_remove(
+    iree_hal_local_executable_t* executable);
+
+// Queries the process-wide shared executable cache statistics.
+void iree_hal_local_shared_executable_cache_query_statistics(
+    iree_hal_local_shared_executable_statistics_t* out_statistics);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_SHARED_EXECUTABLE_CACHE_H_
@@ -0,0 +1,272 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/shared_executable_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Test loader and executable
+//===----------------------------------------------------------------------===//
+
+static void TestLoaderDestroy(iree_hal_executable_loader_t* loader) {
+  iree_allocator_free(iree_allocator_system(), loader);
+}
+
+static const iree_hal_executable_loader_vtable_t kTestLoaderVTable = {
+    /*.destroy=*/TestLoaderDestroy,
+    /*.query_support=*/nullptr,
+    /*.try_load=*/nullptr,
+};
+
+static void TestExecutableDestroy(iree_hal_executable_t* base_executable) {
+  iree_hal_local_executable_t* executable =
+      iree_hal_local_executable_cast(base_executable);
+  iree_hal_local_executable_deinitialize(executable);
+  iree_allocator_free(iree_allocator_system(), executable);
+}
+
+static const iree_hal_local_executable_vtable_t kTestExecutableVTable = {
+    /*.base=*/{/*.destroy=*/TestExecutableDestroy},
+    /*.issue_call=*/nullptr,
+};
+
+class SharedExecutableCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_allocator_malloc(iree_allocator_system(),
+                                         sizeof(*loader_), (void**)&loader_));
+    iree_hal_executable_loader_initialize(
+        &kTestLoaderVTable, iree_hal_executable_import_provider_null(),
+        loader_);
+    iree_hal_local_shared_executable_cache_query_statistics(&baseline_);
+  }
+
+  void TearDown() override {
+    iree_hal_executable_loader_release(loader_);
+    // All executables must have been removed when released.
+    iree_hal_local_shared_executable_statistics_t statistics;
+    iree_hal_local_shared_executable_cache_query_statistics(&statistics);
+    EXPECT_EQ(statistics.entry_count, baseline_.entry_count);
+  }
+
+  iree_hal_executable_t* CreateExecutable(
+      iree_hal_local_executable_flags_t flags) {
+    iree_hal_local_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_allocator_malloc(
+        iree_allocator_system(), sizeof(*executable), (void**)&executable));
+    iree_hal_local_executable_initialize(&kTestExecutableVTable,
+                                         /*pipeline_layout_count=*/0, NULL,
+                                         NULL, iree_allocator_system(),
+                                         executable);
+    executable->flags = flags;
+    return (iree_hal_executable_t*)executable;
+  }
+
+  iree_hal_local_shared_executable_key_t MakeKey(const char* contents) {
+    iree_hal_local_shared_executable_key_t key;
+    memset(&key, 0, sizeof(key));
+    key.loader = loader_;
+    key.worker_capacity = 4;
+    key.executable_format = iree_make_cstring_view("test");
+    key.executable_data = iree_make_const_byte_span(contents, strlen(contents));
+    iree_hal_local_shared_executable_digest(key.executable_data,
+                                            key.executable_data_digest);
+    key.content_hash = iree_hal_local_shared_executable_key_hash(&key);
+    return key;
+  }
+
+  // Creates a shareable executable and publishes it under |key|.
+  iree_hal_executable_t* Publish(
+      const iree_hal_local_shared_executable_key_t& key) {
+    iree_hal_executable_t* executable =
+        CreateExecutable(IREE_HAL_LOCAL_EXECUTABLE_FLAG_SHAREABLE);
+    iree_hal_executable_t* published = NULL;
+    iree_hal_local_shared_executable_cache_insert(&key, executable,
+                                                  &published);
+    iree_hal_executable_release(executable);
+    return published;
+  }
+
+  iree_hal_local_shared_executable_statistics_t QueryStatistics() {
+    iree_hal_local_shared_executable_statistics_t statistics;
+    iree_hal_local_shared_executable_cache_query_statistics(&statistics);
+    statistics.hit_count -= baseline_.hit_count;
+    statistics.miss_count -= baseline_.miss_count;
+    statistics.entry_count -= baseline_.entry_count;
+    return statistics;
+  }
+
+  iree_hal_executable_loader_t* loader_ = NULL;
+  iree_hal_local_shared_executable_statistics_t baseline_;
+};
+
+TEST_F(SharedExecutableCacheTest, Hash) {
+  auto hash = [](const char* value, iree_host_size_t length) {
+    return iree_hal_local_shared_executable_hash(
+        0, iree_make_const_byte_span(value, length));
+  };
+  const char data[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  EXPECT_EQ(hash(data, 17), hash(data, 17));
+  EXPECT_NE(hash(data, 17), hash(data + 1, 17));
+  EXPECT_NE(hash(data, 16), hash(data, 17));
+  // Trailing zeros are not absorbed into the tail word.
+  const char zeros[16] = {0};
+  EXPECT_NE(hash(zeros, 3), hash(zeros, 4));
+  EXPECT_NE(hash(zeros, 8), hash(zeros, 16));
+}
+
+TEST_F(SharedExecutableCacheTest, Digest) {
+  auto digest = [](const char* value, iree_host_size_t length) {
+    uint64_t words[2] = {0, 0};
+    iree_hal_local_shared_executable_digest(
+        iree_make_const_byte_span(value, length), words);
+    return std::make_pair(words[0], words[1]);
+  };
+  const char data[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  EXPECT_EQ(digest(data, 17), digest(data, 17));
+  EXPECT_NE(digest(data, 17).first, digest(data + 1, 17).first);
+  EXPECT_NE(digest(data, 17).second, digest(data + 1, 17).second);
+  EXPECT_NE(digest(data, 16), digest(data, 17));
+  const char zeros[16] = {0};
+  EXPECT_NE(digest(zeros, 3), digest(zeros, 4));
+  EXPECT_NE(digest(zeros, 8), digest(zeros, 16));
+}
+
+TEST_F(SharedExecutableCacheTest, LookupAfterPublish) {
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+
+  iree_hal_executable_t* found = NULL;
+  EXPECT_FALSE(iree_hal_local_shared_executable_cache_lookup(&key, &found));
+  EXPECT_EQ(found, nullptr);
+
+  iree_hal_executable_t* executable = Publish(key);
+  ASSERT_NE(executable, nullptr);
+  EXPECT_EQ(QueryStatistics().entry_count, 1);
+
+  EXPECT_TRUE(iree_hal_local_shared_executable_cache_lookup(&key, &found));
+  EXPECT_EQ(found, executable);
+  iree_hal_executable_release(found);
+
+  iree_hal_local_shared_executable_statistics_t statistics = QueryStatistics();
+  EXPECT_EQ(statistics.hit_count, 1);
+  EXPECT_EQ(statistics.miss_count, 1);
+
+  // Releasing the last user reference removes the entry.
+  iree_hal_executable_release(executable);
+  EXPECT_EQ(QueryStatistics().entry_count, 0);
+  EXPECT_FALSE(iree_hal_local_shared_executable_cache_lookup(&key, &found));
+}
+
+TEST_F(SharedExecutableCacheTest, KeyMismatch) {
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  iree_hal_executable_t* executable = Publish(key);
+
+  iree_hal_executable_t* found = NULL;
+  iree_hal_local_shared_executable_key_t other_contents = MakeKey("other");
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_contents, &found));
+  iree_hal_local_shared_executable_key_t other_capacity = key;
+  other_capacity.worker_capacity = 8;
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_capacity, &found));
+  iree_hal_local_shared_executable_key_t other_mode = key;
+  other_mode.caching_mode = IREE_HAL_EXECUTABLE_CACHING_MODE_ENABLE_PROFILING;
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_mode, &found));
+
+  iree_hal_executable_release(executable);
+}
+
+// Keys whose hashes collide are still distinguished by their contents.
+TEST_F(SharedExecutableCacheTest, HashCollision) {
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  iree_hal_executable_t* executable = Publish(key);
+
+  iree_hal_executable_t* found = NULL;
+  iree_hal_local_shared_executable_key_t other_data = MakeKey("executablf");
+  other_data.content_hash = key.content_hash;
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_data, &found));
+  iree_hal_local_shared_executable_key_t other_format = key;
+  other_format.executable_format = iree_make_cstring_view("tesu");
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_format, &found));
+  const uint32_t constants[1] = {1};
+  iree_hal_local_shared_executable_key_t other_constants = key;
+  other_constants.constants =
+      iree_make_const_byte_span(constants, sizeof(constants));
+  EXPECT_FALSE(
+      iree_hal_local_shared_executable_cache_lookup(&other_constants, &found));
+
+  iree_hal_executable_release(executable);
+}
+
+// Published entries do not reference the executable data of the caller.
+TEST_F(SharedExecutableCacheTest, DoesNotReferenceExecutableData) {
+  std::string contents = "executable";
+  iree_hal_executable_t* executable = Publish(MakeKey(contents.c_str()));
+  contents.assign("0123456789");
+
+  iree_hal_executable_t* found = NULL;
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  EXPECT_TRUE(iree_hal_local_shared_executable_cache_lookup(&key, &found));
+  EXPECT_EQ(found, executable);
+  iree_hal_executable_release(found);
+
+  iree_hal_executable_release(executable);
+}
+
+TEST_F(SharedExecutableCacheTest, NotShareable) {
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  iree_hal_executable_t* executable =
+      CreateExecutable(IREE_HAL_LOCAL_EXECUTABLE_FLAG_NONE);
+  iree_hal_executable_t* published = NULL;
+  iree_hal_local_shared_executable_cache_insert(&key, executable, &published);
+  EXPECT_EQ(published, executable);
+  iree_hal_executable_release(published);
+  EXPECT_EQ(QueryStatistics().entry_count, 0);
+
+  iree_hal_executable_t* found = NULL;
+  EXPECT_FALSE(iree_hal_local_shared_executable_cache_lookup(&key, &found));
+  iree_hal_executable_release(executable);
+}
+
+TEST_F(SharedExecutableCacheTest, InsertRace) {
+  // Two loads that both missed publish equivalent executables and the second
+  // receives the first.
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  iree_hal_executable_t* first = Publish(key);
+  iree_hal_executable_t* second = Publish(key);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(QueryStatistics().entry_count, 1);
+  iree_hal_executable_release(second);
+  iree_hal_executable_release(first);
+}
+
+TEST_F(SharedExecutableCacheTest, RetainsLoader) {
+  iree_hal_local_shared_executable_key_t key = MakeKey("executable");
+  iree_hal_executable_t* executable = Publish(key);
+  EXPECT_EQ(iree_atomic_ref_count_load(&loader_->ref_count), 2);
+  iree_hal_executable_release(executable);
+  EXPECT_EQ(iree_atomic_ref_count_load(&loader_->ref_count), 1);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,153 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/trace_location.h"
+
+#include <string.h>
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+
+// Number of hash buckets in the location table. Executables usually have
+// dozens to hundreds of exports and this only needs to keep chains short.
+#define IREE_HAL_LOCAL_TRACE_LOCATION_BUCKET_COUNT 1024
+
+// An interned location. The strings are stored NUL-terminated immediately
+// following the entry.
+typedef struct iree_hal_local_trace_location_entry_t {
+  struct iree_hal_local_trace_location_entry_t* next;
+  uint64_t hash;
+  iree_string_view_t file_name;
+  iree_string_view_t function_name;
+  iree_string_view_t name;
+  iree_tracing_location_t location;
+} iree_hal_local_trace_location_entry_t;
+
+// Process-wide location table. Entries are never freed as tracing providers
+// may reference them until the process exits.
+typedef struct iree_hal_local_trace_location_table_t {
+  iree_slim_mutex_t mutex;
+  // Returned when an entry could not be allocated.
+  iree_tracing_location_t fallback;
+  iree_hal_local_trace_location_entry_t*
+      buckets[IREE_HAL_LOCAL_TRACE_LOCATION_BUCKET_COUNT];
+} iree_hal_local_trace_location_table_t;
+
+static iree_hal_local_trace_location_table_t iree_hal_local_trace_locations_;
+static iree_once_flag iree_hal_local_trace_locations_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_trace_locations_initialize(void) {
+  memset(&iree_hal_local_trace_locations_, 0,
+         sizeof(iree_hal_local_trace_locations_));
+  iree_slim_mutex_initialize(&iree_hal_local_trace_locations_.mutex);
+  static const char fallback_name[] = "unknown_location";
+  iree_tracing_location_initialize(
+      NULL, 0, fallback_name, IREE_ARRAYSIZE(fallback_name) - 1, __FILE__,
+      strlen(__FILE__), __LINE__, 0, &iree_hal_local_trace_locations_.fallback);
+}
+
+// FNV-1a over |value| continuing from |hash|.
+static uint64_t iree_hal_local_trace_location_hash_string(
+    uint64_t hash, iree_string_view_t value) {
+  for (iree_host_size_t i = 0; i < value.size; ++i) {
+    hash ^= (uint8_t)value.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  // Separates adjacent strings such that "ab"+"c" != "a"+"bc".
+  hash ^= 0xFF;
+  hash *= 0x100000001B3ull;
+  return hash;
+}
+
+// Copies |value| into |*storage_ptr| with a NUL terminator and advances it.
+static iree_string_view_t iree_hal_local_trace_location_copy_string(
+    iree_string_view_t value, char** storage_ptr) {
+  char* storage = *storage_ptr;
+  memcpy(storage, value.data, value.size);
+  storage[value.size] = 0;
+  *storage_ptr += value.size + 1;
+  return iree_make_string_view(storage, value.size);
+}
+
+const iree_tracing_location_t* iree_hal_local_trace_location_intern(
+    iree_string_view_t file_name, uint32_t line,
+    iree_string_view_t function_name, iree_string_view_t name,
+    uint32_t color) {
+  iree_call_once(&iree_hal_local_trace_locations_flag_,
+                 iree_hal_local_trace_locations_initialize);
+  iree_hal_local_trace_location_table_t* table =
+      &iree_hal_local_trace_locations_;
+
+  uint64_t hash = 0xCBF29CE484222325ull;
+  hash = iree_hal_local_trace_location_hash_string(hash, file_name);
+  hash = iree_hal_local_trace_location_hash_string(hash, function_name);
+  hash = iree_hal_local_trace_location_hash_string(hash, name);
+  hash = (hash ^ line) * 0x100000001B3ull;
+  hash = (hash ^ color) * 0x100000001B3ull;
+  iree_hal_local_trace_location_entry_t** bucket =
+      &table->buckets[hash % IREE_HAL_LOCAL_TRACE_LOCATION_BUCKET_COUNT];
+
+  iree_slim_mutex_lock(&table->mutex);
+
+  for (iree_hal_local_trace_location_entry_t* entry = *bucket; entry;
+       entry = entry->next) {
+    if (entry->hash == hash && entry->location.line == line &&
+        entry->location.color == color &&
+        iree_string_view_equal(entry->file_name, file_name) &&
+        iree_string_view_equal(entry->function_name, function_name) &&
+        iree_string_view_equal(entry->name, name)) {
+      iree_slim_mutex_unlock(&table->mutex);
+      return &entry->location;
+    }
+  }
+
+  iree_hal_local_trace_location_entry_t* entry = NULL;
+  iree_host_size_t total_size = sizeof(*entry) + file_name.size + 1 +
+                                function_name.size + 1 + name.size + 1;
+  iree_status_t status = iree_allocator_malloc(iree_allocator_system(),
+                                               total_size, (void**)&entry);
+  if (!iree_status_is_ok(status)) {
+    iree_slim_mutex_unlock(&table->mutex);
+    iree_status_ignore(status);
+    return &table->fallback;
+  }
+  char* storage = (char*)entry + sizeof(*entry);
+  entry->hash = hash;
+  entry->file_name =
+      iree_hal_local_trace_location_copy_string(file_name, &storage);
+  entry->function_name =
+      iree_hal_local_trace_location_copy_string(function_name, &storage);
+  entry->name = iree_hal_local_trace_location_copy_string(name, &storage);
+  iree_tracing_location_initialize(
+      iree_string_view_is_empty(name) ? NULL : entry->name.data,
+      entry->name.size, entry->function_name.data, entry->function_name.size,
+      entry->file_name.data, entry->file_name.size, line, color,
+      &entry->location);
+  entry->next = *bucket;
+  *bucket = entry;
+
+  iree_slim_mutex_unlock(&table->mutex);
+  return &entry->location;
+}
+
+const iree_tracing_location_t* iree_hal_local_trace_location_intern_label(
+    iree_string_view_t label, iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {
+  // Tracing providers take 0xRRGGBB with 0 indicating the default color.
+  uint32_t color = 0;
+  if (label_color.a != 0) {
+    color = ((uint32_t)label_color.r << 16) | ((uint32_t)label_color.g << 8) |
+            (uint32_t)label_color.b;
+  }
+  return iree_hal_local_trace_location_intern(
+      location ? location->file : iree_string_view_empty(),
+      location ? (uint32_t)location->line : 0, label, iree_string_view_empty(),
+      color);
+}
+
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
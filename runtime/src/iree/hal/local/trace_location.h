@@ -0,0 +1,46 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_TRACE_LOCATION_H_
+#define IREE_HAL_LOCAL_TRACE_LOCATION_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+// Returns a tracing source location for zones attributed to |function_name| in
+// |file_name| at |line| and optionally displayed as |name|. The returned
+// location can be used with IREE_TRACE_ZONE_BEGIN_LOCATION to begin zones
+// without copying any strings.
+//
+// Locations are interned and identical requests return the same location.
+// Tracing providers may read locations at any time and as such they remain
+// valid for the lifetime of the process. Returns a generic location if the
+// location could not be allocated.
+const iree_tracing_location_t* iree_hal_local_trace_location_intern(
+    iree_string_view_t file_name, uint32_t line,
+    iree_string_view_t function_name, iree_string_view_t name, uint32_t color);
+
+// Returns an interned tracing source location for a command buffer debug group
+// with the given |label|, |label_color|, and optional source |location|.
+// Labels are expected to be drawn from a small set of static strings as each
+// unique label is retained for the lifetime of the process.
+const iree_tracing_location_t* iree_hal_local_trace_location_intern_label(
+    iree_string_view_t label, iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location);
+
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_TRACE_LOCATION_H_
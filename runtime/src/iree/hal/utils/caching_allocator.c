@@ -6,11 +6,38 @@
 
 #include "iree/hal/utils/caching_allocator.h"
 
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 
 // Default capacity of a pool free list when not specified by the user.
 #define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY 64
 
+// Number of size classes per power of two. Free buffers are bucketed by size
+// class so that best-fit lookups only need to scan buffers of similar size.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_STEPS_LOG2 2
+
+// Allocations at or below this size all share the first size class.
+#define IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_LOG2 8
+
+// Total number of size classes covering the full 64-bit size range.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT 256
+
+// A free buffer may be reused for a smaller request without splitting only if
+// it is at most this many times larger than the request.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_REUSE_RATIO 2
+
+// Pools retain at most this many times the peak live size observed since the
+// last trim. Buffers beyond this are released oldest-first when a request
+// misses the cache.
+#define IREE_HAL_CACHING_ALLOCATOR_HIGH_WATER_RATIO 2
+
+// Minimum alignment of suballocations made from split blocks.
+#define IREE_HAL_CACHING_ALLOCATOR_MIN_SPLIT_ALIGNMENT 256
+
+// Maximum number of disjoint free ranges tracked per split block. Ranges that
+// cannot be tracked are reclaimed when the entire block is released.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_BLOCK_RANGES 8
+
 //===----------------------------------------------------------------------===//
 // iree_hal_caching_allocator_pool_t
 //===----------------------------------------------------------------------===//
@@ -28,11 +55,70 @@ void iree_hal_caching_allocator_pool_params_initialize(
   out_params->max_allocation_capacity = IREE_DEVICE_SIZE_MAX;
   out_params->max_free_allocation_count =
       IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY;
+  out_params->min_split_size = 0;
+}
+
+// Returns the size class of a buffer of |size| bytes.
+// Classes are geometric with 2^STEPS_LOG2 classes per power of two such that
+// all buffers in a class are within ~25% of each other.
+static uint32_t iree_hal_caching_allocator_size_class(iree_device_size_t size) {
+  if (size < (1ull << IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_LOG2)) {
+    return 0;
+  }
+  const uint32_t msb =
+      63 - (uint32_t)iree_math_count_leading_zeros_u64((uint64_t)size);
+  const uint32_t step =
+      (uint32_t)((uint64_t)size >>
+                 (msb - IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_STEPS_LOG2)) &
+      ((1u << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_STEPS_LOG2) - 1);
+  return ((msb - IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_LOG2)
+          << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_STEPS_LOG2) +
+         step + 1;
 }
 
+// A free buffer retained by the pool.
+typedef struct iree_hal_caching_allocator_free_entry_t {
+  // Links in the size class bucket the buffer is in.
+  struct iree_hal_caching_allocator_free_entry_t* bucket_prev;
+  struct iree_hal_caching_allocator_free_entry_t* bucket_next;
+  // Links in the pool recency list (from least to most recently used).
+  struct iree_hal_caching_allocator_free_entry_t* lru_prev;
+  struct iree_hal_caching_allocator_free_entry_t* lru_next;
+  // Retained buffer.
+  iree_hal_buffer_t* buffer;
+  // Cached allocation size of the buffer.
+  iree_device_size_t allocation_size;
+  // Size class of the buffer.
+  uint32_t size_class;
+} iree_hal_caching_allocator_free_entry_t;
+
+// A cached buffer that has been split into one or more suballocations.
+// Suballocations are handed out as subspan buffers that route back to the
+// caching allocator when released. Once all suballocations have been released
+// the block buffer returns to the pool free list.
+typedef struct iree_hal_caching_allocator_block_t {
+  struct iree_hal_caching_allocator_block_t* next;
+  // Retained block buffer.
+  iree_hal_buffer_t* buffer;
+  // Number of live suballocations.
+  iree_host_size_t live_count;
+  // Free ranges sorted by ascending offset.
+  iree_host_size_t range_count;
+  struct {
+    iree_device_size_t offset;
+    iree_device_size_t length;
+  } ranges[IREE_HAL_CACHING_ALLOCATOR_MAX_BLOCK_RANGES];
+} iree_hal_caching_allocator_block_t;
+
 // Pool of arbitrarily-sized device allocations for a particular heap.
 // This maintains a free list of blocks available for use but does not track
-// outstanding allocations.
+// outstanding allocations (other than those suballocated from split blocks).
+//
+// Free buffers are bucketed by size class and requests are serviced by the
+// smallest compatible free buffer in the first non-empty class that can hold
+// them. Buffers larger than the request are handed out as subspans and, if
+// splitting is enabled and the remainder is large enough, the remainder is
+// made available to subsequent requests.
 //
 // Thread-safe. Pools can service requests from multiple threads concurrently by
 // way of a pool-specific mutex. The mutex will not be held during underlying
@@ -47,6 +133,9 @@ typedef iree_alignas(
   // Unretained as the parent allocator retains it for us.
   iree_hal_allocator_t* device_allocator;
 
+  // Host allocator used for split block bookkeeping.
+  iree_allocator_t host_allocator;
+
   // Guards access to the pool data structures as buffers can be
   // acquired/released from multiple threads if shared across user-visible
   // devices.
@@ -63,13 +152,37 @@ typedef iree_alignas(
   // Total size, in bytes, of all free buffers currently in this pool.
   iree_device_size_t free_allocated_size;
 
-  // Flat MRU list of available buffers with max_free_allocation_count slots.
-  // Sorted by ascending recency (the higher the index the more recent).
-  // If we really cared about optimizing the interior removal then we'd want
-  // a linked/skip list or some bucketing but that's really for the higher
-  // level allocators to do.
+  // Total size, in bytes, of all buffers and suballocations currently in use.
+  iree_device_size_t live_size;
+
+  // Peak live size since the pool was last trimmed.
+  iree_device_size_t live_high_water;
+
+  // Number of requests serviced from cached memory and number that required
+  // a new allocation from the underlying allocator.
+  uint64_t hit_count;
+  uint64_t miss_count;
+
+  // Split blocks with live suballocations.
+  iree_hal_caching_allocator_block_t* blocks;
+
+  // Bitmap of size classes with at least one free buffer.
+  uint64_t nonempty_classes[IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT / 64];
+
+  // Free buffers bucketed by size class.
+  iree_hal_caching_allocator_free_entry_t*
+      buckets[IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT];
+
+  // Recency list of free buffers; the head is the least recently used.
+  iree_hal_caching_allocator_free_entry_t* lru_head;
+  iree_hal_caching_allocator_free_entry_t* lru_tail;
+
+  // Unused entries available for tracking free buffers.
+  iree_hal_caching_allocator_free_entry_t* unused_entries;
+
+  // Storage for max_free_allocation_count free list entries.
   iree_host_size_t free_count;
-  iree_hal_buffer_t* free_buffers[];
+  iree_hal_caching_allocator_free_entry_t entries[];
 } iree_hal_caching_allocator_pool_t;
 
 static void iree_hal_caching_allocator_pool_trim(
@@ -79,16 +192,19 @@ static void iree_hal_caching_allocator_pool_trim(
 // Buffer device storage will be allocated from |device_allocator|.
 static void iree_hal_caching_allocator_pool_initialize(
     iree_hal_caching_allocator_pool_params_t params,
-    iree_hal_allocator_t* device_allocator,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
     iree_hal_caching_allocator_pool_t* out_pool) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  memset(out_pool, 0, sizeof(*out_pool));
   out_pool->params = params;
   out_pool->device_allocator = device_allocator;
+  out_pool->host_allocator = host_allocator;
   iree_slim_mutex_initialize(&out_pool->mutex);
-  out_pool->total_allocated_size = 0;
-  out_pool->free_allocated_size = 0;
-  out_pool->free_count = 0;
+  for (iree_host_size_t i = 0; i < params.max_free_allocation_count; ++i) {
+    out_pool->entries[i].lru_next = out_pool->unused_entries;
+    out_pool->unused_entries = &out_pool->entries[i];
+  }
 
   IREE_TRACE_SET_PLOT_TYPE(IREE_HAL_CACHING_ALLOCATOR_ID,
                            IREE_TRACING_PLOT_TYPE_MEMORY, /*step=*/true,
@@ -113,80 +229,253 @@ static void iree_hal_caching_allocator_pool_deinitialize(
                  "must have released all allocations prior to deinit");
   IREE_ASSERT_EQ(pool->free_count, 0,
                  "must have released all allocations prior to deinit");
+  IREE_ASSERT(!pool->blocks,
+              "must have released all allocations prior to deinit");
 
   iree_slim_mutex_deinitialize(&pool->mutex);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns true if |buffer| can service requests with the given |params|.
+static bool iree_hal_caching_allocator_is_compatible(
+    iree_hal_buffer_t* buffer, const iree_hal_buffer_params_t* params) {
+  // NOTE: we are not currently checking alignment of whole buffers as we don't
+  // really have it. We assume programs will use consistent alignments for a
+  // particular heap (as the heap has a min alignment).
+  return iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                           params->type) &&
+         iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                           params->usage);
+}
+
 // Pushes |buffer| on to the pool free list as the most recently used.
-// The buffer will be retained in the list.
+// Ownership of a reference to |buffer| transfers to the pool.
 //
 // Must be called with the pool mutex held.
 static void iree_hal_caching_allocator_pool_push_buffer(
     iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
-  // Retain the buffer; the caller must release it to complete the ownership
-  // transfer.
-  iree_hal_buffer_retain(buffer);
-
   IREE_ASSERT_LT(pool->free_count, pool->params.max_free_allocation_count);
-
-  // Add to the end of the list (the most recent).
-  iree_host_size_t i = pool->free_count++;
-  pool->free_buffers[i] = buffer;
+  iree_hal_caching_allocator_free_entry_t* entry = pool->unused_entries;
+  pool->unused_entries = entry->lru_next;
+  ++pool->free_count;
+
+  entry->buffer = buffer;
+  entry->allocation_size = iree_hal_buffer_allocation_size(buffer);
+  entry->size_class =
+      iree_hal_caching_allocator_size_class(entry->allocation_size);
+
+  // Add to the size class bucket.
+  entry->bucket_prev = NULL;
+  entry->bucket_next = pool->buckets[entry->size_class];
+  if (entry->bucket_next) entry->bucket_next->bucket_prev = entry;
+  pool->buckets[entry->size_class] = entry;
+  pool->nonempty_classes[entry->size_class / 64] |= 1ull
+                                                    << (entry->size_class % 64);
+
+  // Add to the end of the recency list (the most recent).
+  entry->lru_prev = pool->lru_tail;
+  entry->lru_next = NULL;
+  if (pool->lru_tail) {
+    pool->lru_tail->lru_next = entry;
+  } else {
+    pool->lru_head = entry;
+  }
+  pool->lru_tail = entry;
 
   // Track that we're now retaining unused memory.
-  pool->free_allocated_size += buffer->allocation_size;
+  pool->free_allocated_size += entry->allocation_size;
   IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
                             pool->free_allocated_size);
 }
 
-// Takes the buffer in the |pool| free list at index |i| and returns ownership.
-// If the list is large this is bad but in most cases it's just a few dozen
-// elements.
+// Takes the buffer in the |pool| free list |entry| and returns ownership.
 //
 // Must be called with the pool mutex held.
-static iree_hal_buffer_t* iree_hal_caching_allocator_pool_take_buffer_at(
-    iree_hal_caching_allocator_pool_t* pool, iree_host_size_t i) {
-  iree_hal_buffer_t* buffer = pool->free_buffers[i];
-  if (i < pool->free_count - 1) {
-    // Shift the list down to keep it dense and in ascending recency order.
-    memmove(&pool->free_buffers[i], &pool->free_buffers[i + 1],
-            (pool->free_count - i - 1) * sizeof(pool->free_buffers[0]));
+static iree_hal_buffer_t* iree_hal_caching_allocator_pool_take_entry(
+    iree_hal_caching_allocator_pool_t* pool,
+    iree_hal_caching_allocator_free_entry_t* entry) {
+  iree_hal_buffer_t* buffer = entry->buffer;
+
+  // Remove from the size class bucket.
+  if (entry->bucket_prev) {
+    entry->bucket_prev->bucket_next = entry->bucket_next;
+  } else {
+    pool->buckets[entry->size_class] = entry->bucket_next;
+    if (!entry->bucket_next) {
+      pool->nonempty_classes[entry->size_class / 64] &=
+          ~(1ull << (entry->size_class % 64));
+    }
   }
-  --pool->free_count;
-  pool->free_allocated_size -= buffer->allocation_size;
+  if (entry->bucket_next) entry->bucket_next->bucket_prev = entry->bucket_prev;
+
+  // Remove from the recency list.
+  if (entry->lru_prev) {
+    entry->lru_prev->lru_next = entry->lru_next;
+  } else {
+    pool->lru_head = entry->lru_next;
+  }
+  if (entry->lru_next) {
+    entry->lru_next->lru_prev = entry->lru_prev;
+  } else {
+    pool->lru_tail = entry->lru_prev;
+  }
+
+  pool->free_allocated_size -= entry->allocation_size;
   IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
                             pool->free_allocated_size);
+
+  entry->buffer = NULL;
+  entry->lru_next = pool->unused_entries;
+  pool->unused_entries = entry;
+  --pool->free_count;
   return buffer;
 }
 
-// Scans the |pool| free list for a buffer matching the given requirements and
-// returns ownership.
+// Returns the smallest free buffer entry in |pool| compatible with |params|
+// that can hold |allocation_size| bytes from the first size class containing
+// one, or NULL if none is available.
 //
 // Must be called with the pool mutex held.
-static iree_hal_buffer_t* iree_hal_caching_allocator_pool_find_and_take_buffer(
+static iree_hal_caching_allocator_free_entry_t*
+iree_hal_caching_allocator_pool_find_entry(
     iree_hal_caching_allocator_pool_t* pool,
     const iree_hal_buffer_params_t* params,
     iree_device_size_t allocation_size) {
-  // Walk backwards so that we check the most recently released buffers first.
-  for (int i = (int)pool->free_count - 1; i >= 0; --i) {
-    // NOTE: we are not currently checking alignment as we don't really have it.
-    // We assume programs will use consistent alignments for a particular heap
-    // (as the heap has a min alignment).
-    iree_hal_buffer_t* buffer = pool->free_buffers[i];
-    if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer), params->type) &&
-        iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
-                          params->usage) &&
-        iree_hal_buffer_allocation_size(buffer) == allocation_size) {
-      return iree_hal_caching_allocator_pool_take_buffer_at(pool, i);
+  uint32_t size_class = iree_hal_caching_allocator_size_class(allocation_size);
+  while (size_class < IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT) {
+    // Skip to the next non-empty class.
+    const uint64_t word = pool->nonempty_classes[size_class / 64] &
+                          (~0ull << (size_class % 64));
+    if (!word) {
+      size_class = (size_class / 64 + 1) * 64;
+      continue;
     }
+    size_class = (size_class & ~63u) +
+                 (uint32_t)iree_math_count_trailing_zeros_u64(word);
+
+    // Best-fit within the class. Only the first class may contain buffers
+    // smaller than the request.
+    iree_hal_caching_allocator_free_entry_t* best_entry = NULL;
+    for (iree_hal_caching_allocator_free_entry_t* entry =
+             pool->buckets[size_class];
+         entry; entry = entry->bucket_next) {
+      if (entry->allocation_size >= allocation_size &&
+          (!best_entry ||
+           entry->allocation_size < best_entry->allocation_size) &&
+          iree_hal_caching_allocator_is_compatible(entry->buffer, params)) {
+        best_entry = entry;
+      }
+    }
+    if (best_entry) return best_entry;
+    ++size_class;
   }
   return NULL;  // nothing found
 }
 
-// Trims |pool| down to at most |target_size| of available allocations.
-// The oldest allocations will be trimmed first.
+// Returns the granularity of suballocations made from split blocks in |pool|.
+// Suballocation sizes are rounded up to this and offsets are aligned to it (or
+// the request alignment if larger).
+static iree_device_size_t iree_hal_caching_allocator_pool_split_alignment(
+    iree_hal_caching_allocator_pool_t* pool) {
+  return iree_max(IREE_HAL_CACHING_ALLOCATOR_MIN_SPLIT_ALIGNMENT,
+                  pool->params.heap.min_alignment);
+}
+
+// Tries to suballocate |allocation_size| bytes from the free ranges of the
+// live split blocks in |pool|. Returns the block and offset on success.
+//
+// Must be called with the pool mutex held.
+static iree_hal_caching_allocator_block_t*
+iree_hal_caching_allocator_pool_suballocate(
+    iree_hal_caching_allocator_pool_t* pool,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_device_size_t* out_offset) {
+  const iree_device_size_t alignment =
+      iree_hal_caching_allocator_pool_split_alignment(pool);
+  const iree_device_size_t offset_alignment =
+      iree_max(alignment, params->min_alignment);
+  const iree_device_size_t aligned_size =
+      iree_device_align(allocation_size, alignment);
+
+  // Best-fit across all ranges of all compatible blocks.
+  iree_hal_caching_allocator_block_t* best_block = NULL;
+  iree_host_size_t best_range = 0;
+  iree_device_size_t best_length = IREE_DEVICE_SIZE_MAX;
+  for (iree_hal_caching_allocator_block_t* block = pool->blocks; block;
+       block = block->next) {
+    if (!iree_hal_caching_allocator_is_compatible(block->buffer, params)) {
+      continue;
+    }
+    for (iree_host_size_t i = 0; i < block->range_count; ++i) {
+      if (block->ranges[i].offset % offset_alignment != 0) continue;
+      const iree_device_size_t length = block->ranges[i].length;
+      if (length >= aligned_size && length < best_length) {
+        best_block = block;
+        best_range = i;
+        best_length = length;
+      }
+    }
+  }
+  if (!best_block) return NULL;
+
+  // Carve from the front of the range.
+  *out_offset = best_block->ranges[best_range].offset;
+  if (best_length == aligned_size) {
+    memmove(&best_block->ranges[best_range],
+            &best_block->ranges[best_range + 1],
+            (best_block->range_count - best_range - 1) *
+                sizeof(best_block->ranges[0]));
+    --best_block->range_count;
+  } else {
+    best_block->ranges[best_range].offset += aligned_size;
+    best_block->ranges[best_range].length -= aligned_size;
+  }
+  ++best_block->live_count;
+  return best_block;
+}
+
+// Returns the range at |offset| of |length| bytes to |block| and returns true
+// if the block has no remaining live suballocations.
+//
+// Must be called with the pool mutex held.
+static bool iree_hal_caching_allocator_block_free_range(
+    iree_hal_caching_allocator_block_t* block, iree_device_size_t offset,
+    iree_device_size_t length) {
+  IREE_ASSERT_GT(block->live_count, 0);
+  if (--block->live_count == 0) return true;
+
+  // Find the insertion point and merge with adjacent ranges.
+  iree_host_size_t i = 0;
+  while (i < block->range_count && block->ranges[i].offset < offset) ++i;
+  const bool merge_prev =
+      i > 0 &&
+      block->ranges[i - 1].offset + block->ranges[i - 1].length == offset;
+  const bool merge_next =
+      i < block->range_count && offset + length == block->ranges[i].offset;
+  if (merge_prev && merge_next) {
+    block->ranges[i - 1].length += length + block->ranges[i].length;
+    memmove(&block->ranges[i], &block->ranges[i + 1],
+            (block->range_count - i - 1) * sizeof(block->ranges[0]));
+    --block->range_count;
+  } else if (merge_prev) {
+    block->ranges[i - 1].length += length;
+  } else if (merge_next) {
+    block->ranges[i].offset = offset;
+    block->ranges[i].length += length;
+  } else if (block->range_count < IREE_ARRAYSIZE(block->ranges)) {
+    memmove(&block->ranges[i + 1], &block->ranges[i],
+            (block->range_count - i) * sizeof(block->ranges[0]));
+    block->ranges[i].offset = offset;
+    block->ranges[i].length = length;
+    ++block->range_count;
+  }
+  // else: untracked until the whole block is released.
+  return false;
+}
+
+// Trims |pool| down to at most |target_size| of total allocations.
+// The least recently used allocations will be trimmed first.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
 static void iree_hal_caching_allocator_pool_trim_to_size(
@@ -196,11 +485,10 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
 
   iree_slim_mutex_lock(&pool->mutex);
 
-  while (pool->free_count > 0 && pool->total_allocated_size > target_size) {
+  while (pool->lru_head && pool->total_allocated_size > target_size) {
     // Take the oldest buffer in the list.
     iree_hal_buffer_t* dead_buffer =
-        iree_hal_caching_allocator_pool_take_buffer_at(pool,
-                                                       pool->free_count - 1);
+        iree_hal_caching_allocator_pool_take_entry(pool, pool->lru_head);
 
     // NOTE: we've removed the buffer but have not subtracted the size from
     // the total yet - we want to do that only after releasing the buffer.
@@ -224,21 +512,143 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
   IREE_TRACE_ZONE_END(z0);
 }
 
-// Releases all unused buffers in |pool| to the underlying device allocator.
+// Releases all unused buffers in |pool| to the underlying device allocator and
+// resets the high-water mark to the current live size.
 //
 // The pool mutex must not be held by the caller.
 static void iree_hal_caching_allocator_pool_trim(
     iree_hal_caching_allocator_pool_t* pool) {
   iree_hal_caching_allocator_pool_trim_to_size(pool, 0);
+  iree_slim_mutex_lock(&pool->mutex);
+  pool->live_high_water = pool->live_size;
+  iree_slim_mutex_unlock(&pool->mutex);
+}
+
+// Returns a cached |buffer| to |pool| if there is capacity remaining and
+// otherwise deallocates it. Ownership of a reference to |buffer| transfers to
+// the pool.
+//
+// Must be called with the pool mutex held; it may be temporarily released.
+static void iree_hal_caching_allocator_pool_cache_buffer(
+    iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
+  const iree_device_size_t allocation_size =
+      iree_hal_buffer_allocation_size(buffer);
+  const bool under_capacity = pool->total_allocated_size - allocation_size <=
+                              pool->params.max_allocation_capacity;
+  const bool under_count =
+      pool->free_count + 1 <= pool->params.max_free_allocation_count;
+  if (under_capacity && under_count) {
+    iree_hal_caching_allocator_pool_push_buffer(pool, buffer);
+    return;
+  }
+
+  // If the buffer didn't fit in the pool we drop it here while we don't hold
+  // the lock as deallocations can be very expensive.
+  iree_slim_mutex_unlock(&pool->mutex);
+  iree_hal_allocator_deallocate_buffer(pool->device_allocator, buffer);
+  iree_slim_mutex_lock(&pool->mutex);
+  pool->total_allocated_size -= allocation_size;
+}
+
+// Tries to service a request of |allocation_size| from memory cached in
+// |pool|. On success returns either a whole buffer in |out_buffer| or a
+// block buffer and the offset of the suballocation in |out_block_buffer|.
+//
+// Must be called with the pool mutex held.
+static bool iree_hal_caching_allocator_pool_try_reuse(
+    iree_hal_caching_allocator_pool_t* pool,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer, iree_hal_buffer_t** out_block_buffer,
+    iree_device_size_t* out_offset) {
+  // Suballocate from existing split blocks first to keep them packed.
+  if (pool->blocks) {
+    iree_hal_caching_allocator_block_t* block =
+        iree_hal_caching_allocator_pool_suballocate(
+            pool, params, allocation_size, out_offset);
+    if (block) {
+      *out_block_buffer = block->buffer;
+      return true;
+    }
+  }
+
+  iree_hal_caching_allocator_free_entry_t* entry =
+      iree_hal_caching_allocator_pool_find_entry(pool, params, allocation_size);
+  if (!entry) return false;
+
+  // Exact matches are returned directly.
+  const iree_device_size_t entry_size = entry->allocation_size;
+  if (entry_size == allocation_size) {
+    *out_buffer = iree_hal_caching_allocator_pool_take_entry(pool, entry);
+    return true;
+  }
+
+  // Larger buffers are suballocated. If splitting is enabled and the remainder
+  // is large enough it is made available to other requests and otherwise it is
+  // wasted until the suballocation is released.
+  const iree_device_size_t aligned_size = iree_device_align(
+      allocation_size, iree_hal_caching_allocator_pool_split_alignment(pool));
+  const bool can_split =
+      pool->params.min_split_size > 0 && aligned_size < entry_size &&
+      entry_size - aligned_size >= pool->params.min_split_size;
+  if (!can_split &&
+      entry_size / IREE_HAL_CACHING_ALLOCATOR_MAX_REUSE_RATIO >
+          allocation_size) {
+    return false;  // too wasteful
+  }
+  iree_hal_caching_allocator_block_t* block = NULL;
+  if (!iree_status_is_ok(iree_allocator_malloc(
+          pool->host_allocator, sizeof(*block), (void**)&block))) {
+    return false;
+  }
+  block->buffer = iree_hal_caching_allocator_pool_take_entry(pool, entry);
+  block->live_count = 1;
+  block->range_count = 0;
+  if (can_split) {
+    block->ranges[0].offset = aligned_size;
+    block->ranges[0].length = entry_size - aligned_size;
+    block->range_count = 1;
+  }
+  block->next = pool->blocks;
+  pool->blocks = block;
+  *out_block_buffer = block->buffer;
+  *out_offset = 0;
+  return true;
+}
+
+// Releases a suballocation at |offset| of |length| bytes from the split block
+// backed by |block_buffer|. If the block has no remaining suballocations it is
+// removed and its buffer reference is returned in |out_buffer| for caching.
+//
+// Must be called with the pool mutex held.
+static void iree_hal_caching_allocator_pool_release_range(
+    iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* block_buffer,
+    iree_device_size_t offset, iree_device_size_t length,
+    iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  iree_hal_caching_allocator_block_t** prev_next = &pool->blocks;
+  iree_hal_caching_allocator_block_t* block = pool->blocks;
+  while (block && block->buffer != block_buffer) {
+    prev_next = &block->next;
+    block = block->next;
+  }
+  IREE_ASSERT(block, "suballocation block not found");
+  if (!block) return;
+  if (iree_hal_caching_allocator_block_free_range(block, offset, length)) {
+    *prev_next = block->next;
+    *out_buffer = block->buffer;
+    iree_allocator_free(pool->host_allocator, block);
+  }
 }
 
 // Acquires a buffer of |allocation_size| from the |pool|.
 // The buffer will have a memory type and usage compatible with the given types.
+// Suballocations are returned as subspan buffers owned by |base_allocator|.
 // Fails if the pool is empty and the underlying device fails the allocation.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
 static iree_status_t iree_hal_caching_allocator_pool_acquire(
     iree_hal_caching_allocator_pool_t* pool,
+    iree_hal_allocator_t* base_allocator,
     const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
     iree_hal_buffer_t** out_buffer) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -247,25 +657,61 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
   // Scan the free list to find an appropriate block.
   // If found we pop it off the list and return it without needing to allocate.
   iree_slim_mutex_lock(&pool->mutex);
-  iree_hal_buffer_t* existing_buffer =
-      iree_hal_caching_allocator_pool_find_and_take_buffer(pool, params,
-                                                           allocation_size);
-  if (!existing_buffer) {
+  iree_hal_buffer_t* existing_buffer = NULL;
+  iree_hal_buffer_t* block_buffer = NULL;
+  iree_device_size_t block_offset = 0;
+  const bool reused = iree_hal_caching_allocator_pool_try_reuse(
+      pool, params, allocation_size, &existing_buffer, &block_buffer,
+      &block_offset);
+  pool->live_size += allocation_size;
+  pool->live_high_water = iree_max(pool->live_high_water, pool->live_size);
+  iree_device_size_t target_size = pool->params.max_allocation_capacity;
+  if (reused) {
+    ++pool->hit_count;
+  } else {
+    ++pool->miss_count;
     // We'll need to allocate so we add the size such that it'll be accounted
     // for by other threads allocating at the same time.
     pool->total_allocated_size += allocation_size;
+    // Retain at most a multiple of the peak live size such that free buffers
+    // of sizes no longer requested are eventually released.
+    const iree_device_size_t ratio =
+        IREE_HAL_CACHING_ALLOCATOR_HIGH_WATER_RATIO;
+    const iree_device_size_t high_water_size =
+        pool->live_high_water <= IREE_DEVICE_SIZE_MAX / ratio
+            ? pool->live_high_water * ratio
+            : IREE_DEVICE_SIZE_MAX;
+    target_size = iree_min(target_size, high_water_size);
   }
   iree_slim_mutex_unlock(&pool->mutex);
+
   if (existing_buffer) {
     // Found a buffer! Return it uninitialized.
     *out_buffer = existing_buffer;
     IREE_TRACE_ZONE_END(z0);
     return iree_ok_status();
+  } else if (block_buffer) {
+    // Wrap the suballocation; the subspan routes back to us when released.
+    iree_status_t status = iree_hal_subspan_buffer_create(
+        block_buffer, block_offset, allocation_size, base_allocator,
+        pool->host_allocator, out_buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_slim_mutex_lock(&pool->mutex);
+      pool->live_size -= allocation_size;
+      iree_hal_buffer_t* free_buffer = NULL;
+      iree_hal_caching_allocator_pool_release_range(
+          pool, block_buffer, block_offset, allocation_size, &free_buffer);
+      if (free_buffer) {
+        iree_hal_caching_allocator_pool_cache_buffer(pool, free_buffer);
+      }
+      iree_slim_mutex_unlock(&pool->mutex);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
   }
 
   // Trim first before allocating so that we don't go over peak.
-  iree_hal_caching_allocator_pool_trim_to_size(
-      pool, pool->params.max_allocation_capacity);
+  iree_hal_caching_allocator_pool_trim_to_size(pool, target_size);
 
   // No existing buffer was found that could be used and we'll need to allocate
   // one. Note that we do this without holding the lock as the underlying
@@ -282,6 +728,7 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
     if (buffer) iree_hal_buffer_release(buffer);
     iree_slim_mutex_lock(&pool->mutex);
     pool->total_allocated_size -= allocation_size;
+    pool->live_size -= allocation_size;
     iree_slim_mutex_unlock(&pool->mutex);
   }
 
@@ -296,32 +743,39 @@ static void iree_hal_caching_allocator_pool_release(
     iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(
-      z0, (int64_t)iree_hal_buffer_allocation_size(buffer));
+      z0, (int64_t)iree_hal_buffer_byte_length(buffer));
 
-  // Try to add the buffer to the pool. If the pool is at capacity we'll just
-  // release it back to the allocator.
   iree_slim_mutex_lock(&pool->mutex);
 
-  const iree_device_size_t allocation_size =
-      iree_hal_buffer_allocation_size(buffer);
-  const bool under_capacity = pool->total_allocated_size - allocation_size <=
-                              pool->params.max_allocation_capacity;
-  const bool under_count =
-      pool->free_count + 1 <= pool->params.max_free_allocation_count;
-  if (under_capacity && under_count) {
-    iree_hal_caching_allocator_pool_push_buffer(pool, buffer);
-    buffer = NULL;
-  }
-
-  // If the buffer didn't fit in the pool we drop it here while we don't hold
-  // the lock as deallocations can be very expensive.
-  if (buffer) {
+  if (buffer->allocated_buffer != buffer) {
+    // Suballocation subspan: return the range to its block. The subspan holds
+    // a reference to the block buffer that we drop once unlocked.
+    const iree_device_size_t byte_length = iree_hal_buffer_byte_length(buffer);
+    pool->live_size -= byte_length;
+    const iree_device_size_t aligned_length = iree_device_align(
+        byte_length, iree_hal_caching_allocator_pool_split_alignment(pool));
+    iree_hal_buffer_t* free_buffer = NULL;
+    iree_hal_caching_allocator_pool_release_range(
+        pool, buffer->allocated_buffer, iree_hal_buffer_byte_offset(buffer),
+        aligned_length, &free_buffer);
     iree_slim_mutex_unlock(&pool->mutex);
-    iree_hal_allocator_deallocate_buffer(pool->device_allocator, buffer);
-    iree_slim_mutex_lock(&pool->mutex);
-    pool->total_allocated_size -= allocation_size;
+    iree_hal_buffer_destroy(buffer);
+    if (free_buffer) {
+      iree_slim_mutex_lock(&pool->mutex);
+      iree_hal_caching_allocator_pool_cache_buffer(pool, free_buffer);
+      iree_slim_mutex_unlock(&pool->mutex);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return;
   }
 
+  // Try to add the buffer to the pool. If the pool is at capacity we'll just
+  // release it back to the allocator. The buffer has no references remaining
+  // and the pool takes a new one.
+  pool->live_size -= iree_hal_buffer_allocation_size(buffer);
+  iree_hal_buffer_retain(buffer);
+  iree_hal_caching_allocator_pool_cache_buffer(pool, buffer);
+
   iree_slim_mutex_unlock(&pool->mutex);
 
   IREE_TRACE_ZONE_END(z0);
@@ -406,7 +860,7 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
   for (iree_host_size_t i = 0; i < pool_count; ++i) {
     iree_hal_caching_allocator_pool_t* pool = NULL;
     total_size += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
   }
@@ -428,12 +882,12 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
     iree_hal_caching_allocator_pool_t* pool =
         (iree_hal_caching_allocator_pool_t*)pool_ptr;
     pool_ptr += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
     allocator->pools[i] = pool;
     iree_hal_caching_allocator_pool_initialize(pool_params[i], device_allocator,
-                                               pool);
+                                               host_allocator, pool);
   }
 
   *out_allocator = (iree_hal_allocator_t*)allocator;
@@ -547,12 +1001,15 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
     iree_string_view_t max_allocation_size_str = iree_string_view_empty();
     iree_string_view_t max_allocation_capacity_str = iree_string_view_empty();
     iree_string_view_t max_free_allocation_count_str = iree_string_view_empty();
+    iree_string_view_t min_split_size_str = iree_string_view_empty();
     iree_string_view_split(pool_config, ';', &max_allocation_size_str,
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_allocation_capacity_str,
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_free_allocation_count_str,
                            &pool_config);
+    iree_string_view_split(pool_config, ';', &min_split_size_str,
+                           &pool_config);
     max_allocation_size_str = iree_string_view_trim(max_allocation_size_str);
     if (!iree_string_view_is_empty(max_allocation_size_str) &&
         !iree_string_view_equal(max_allocation_size_str, IREE_SV("*"))) {
@@ -584,6 +1041,14 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
       }
       pool_params->max_free_allocation_count = max_free_allocation_count;
     }
+    min_split_size_str = iree_string_view_trim(min_split_size_str);
+    if (!iree_string_view_is_empty(min_split_size_str) &&
+        !iree_string_view_equal(min_split_size_str, IREE_SV("*"))) {
+      IREE_RETURN_IF_ERROR(
+          iree_string_view_parse_device_size(min_split_size_str,
+                                             &pool_params->min_split_size),
+          "parsing min_split_size");
+    }
   } while (!iree_string_view_is_empty(config_pairs));
   return iree_hal_caching_allocator_create_with_pools(
       pool_count, pool_params_storage, device_allocator, host_allocator,
@@ -633,6 +1098,17 @@ static void iree_hal_caching_allocator_query_statistics(
       iree_hal_caching_allocator_cast(base_allocator);
   iree_hal_allocator_query_statistics(allocator->device_allocator,
                                       out_statistics);
+  IREE_STATISTICS({
+    for (iree_host_size_t i = 0; i < allocator->pool_count; ++i) {
+      iree_hal_caching_allocator_pool_t* pool = allocator->pools[i];
+      iree_slim_mutex_lock(&pool->mutex);
+      out_statistics->cache_hit_count += pool->hit_count;
+      out_statistics->cache_miss_count += pool->miss_count;
+      out_statistics->cache_bytes_free += pool->free_allocated_size;
+      out_statistics->cache_bytes_high_water += pool->live_high_water;
+      iree_slim_mutex_unlock(&pool->mutex);
+    }
+  });
 }
 
 static iree_status_t iree_hal_caching_allocator_query_memory_heaps(
@@ -727,7 +1203,7 @@ static iree_status_t iree_hal_caching_allocator_allocate_buffer(
 
   // Acquire the buffer from the pool.
   IREE_RETURN_IF_ERROR(iree_hal_caching_allocator_pool_acquire(
-      pool, &compat_params, allocation_size, out_buffer));
+      pool, base_allocator, &compat_params, allocation_size, out_buffer));
 
   // Point the buffer back to us for deallocation.
   (*out_buffer)->device_allocator = base_allocator;
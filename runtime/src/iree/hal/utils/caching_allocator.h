@@ -17,6 +17,14 @@ extern "C" {
 // A HAL buffer allocator that caches allocations instead of returning them to
 // the underlying device allocator.
 //
+// Free buffers are bucketed into geometric size classes and requests are
+// serviced by the best-fitting cached buffer. Buffers larger than a request
+// are returned as subspans and may optionally be split such that the
+// remainder services other requests. Each pool retains at most a small
+// multiple of the peak live size observed since it was last trimmed and
+// releases the least recently used buffers beyond that. Cache hits and misses
+// are reported via iree_hal_allocator_query_statistics.
+//
 // Allocation limits can be independently tuned per heap they originate from to
 // enable heavier caching of more expensive allocations such as mappable
 // device-local and host-visible buffers on devices with discrete memory.
@@ -49,6 +57,11 @@ typedef struct iree_hal_caching_allocator_pool_params_t {
   // This is used to allocate storage for the free list and should be reasonably
   // bounded (~64-1024).
   iree_host_size_t max_free_allocation_count;
+
+  // Minimum size of the remainder of a cached buffer that is split to service
+  // a smaller request. Remainders at least this large are suballocated by
+  // subsequent requests while the buffer is in use. 0 disables splitting.
+  iree_device_size_t min_split_size;
 } iree_hal_caching_allocator_pool_params_t;
 
 // Initializes |out_params| to the default values using |heap| for storage.
@@ -59,8 +72,9 @@ void iree_hal_caching_allocator_pool_params_initialize(
 // Creates an allocator that caches allocations using |device_allocator| for
 // serving requests.
 //
-// All allocations will be cached until the allocator is trimmed and in highly
-// dynamic programs this can easily exceed available memory. Prefer using
+// Allocations will be cached until the allocator is trimmed or the retained
+// memory exceeds a multiple of the peak live size and in highly dynamic
+// programs this can still easily exceed available memory. Prefer using
 // explicit pools per heap with maximum sizes for safer behavior and better
 // tuning (limit caching to expensive heaps, etc).
 //
@@ -101,9 +115,10 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
 // defaults.
 //
 // Expected form:
-//   heap_key=max_allocation_size;max_allocation_capacity;max_free_allocation_count
+//   heap_key=max_allocation_size;max_allocation_capacity;max_free_allocation_count;min_split_size
 // Example:
 //   device_local=1gib;1gib;8
+//   device_local=*;*;64;1mib
 //   host_local=*;*;32
 iree_status_t iree_hal_caching_allocator_create_from_spec(
     iree_string_view_t config_pairs, iree_hal_allocator_t* device_allocator,
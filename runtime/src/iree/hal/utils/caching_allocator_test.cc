@@ -0,0 +1,178 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class CachingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), iree_allocator_system(), iree_allocator_system(),
+        &heap_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  // Creates |allocator_| with a single pool over the first heap.
+  void CreateAllocator(iree_device_size_t min_split_size) {
+    iree_hal_allocator_memory_heap_t heaps[8];
+    iree_host_size_t heap_count = 0;
+    IREE_ASSERT_OK(iree_hal_allocator_query_memory_heaps(
+        heap_allocator_, IREE_ARRAYSIZE(heaps), heaps, &heap_count));
+    ASSERT_GT(heap_count, 0);
+    iree_hal_caching_allocator_pool_params_t params;
+    iree_hal_caching_allocator_pool_params_initialize(heaps[0], &params);
+    params.min_split_size = min_split_size;
+    IREE_ASSERT_OK(iree_hal_caching_allocator_create_with_pools(
+        1, &params, heap_allocator_, iree_allocator_system(), &allocator_));
+  }
+
+  iree_hal_buffer_t* Allocate(iree_device_size_t size) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(
+        iree_hal_allocator_allocate_buffer(allocator_, params, size, &buffer));
+    return buffer;
+  }
+
+  iree_hal_allocator_statistics_t QueryStatistics() {
+    iree_hal_allocator_statistics_t statistics;
+    iree_hal_allocator_query_statistics(allocator_, &statistics);
+    return statistics;
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = NULL;
+  iree_hal_allocator_t* allocator_ = NULL;
+};
+
+// Buffers of the same size are reused exactly.
+TEST_F(CachingAllocatorTest, ReuseExactSize) {
+  CreateAllocator(/*min_split_size=*/0);
+  iree_hal_buffer_t* buffer0 = Allocate(4096);
+  iree_hal_buffer_t* allocated_buffer0 =
+      iree_hal_buffer_allocated_buffer(buffer0);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_t* buffer1 = Allocate(4096);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(buffer1), allocated_buffer0);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer1), 4096);
+  iree_hal_buffer_release(buffer1);
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics = QueryStatistics();
+  EXPECT_EQ(statistics.cache_hit_count, 1);
+  EXPECT_EQ(statistics.cache_miss_count, 1);
+  EXPECT_EQ(statistics.cache_bytes_free, 4096);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Smaller requests reuse a nearby larger buffer as a subspan with the exact
+// requested length.
+TEST_F(CachingAllocatorTest, ReuseBestFit) {
+  CreateAllocator(/*min_split_size=*/0);
+  iree_hal_buffer_t* small_buffer = Allocate(1000);
+  iree_hal_buffer_t* large_buffer = Allocate(1500);
+  iree_hal_buffer_t* large_allocation =
+      iree_hal_buffer_allocated_buffer(large_buffer);
+  iree_hal_buffer_release(small_buffer);
+  iree_hal_buffer_release(large_buffer);
+
+  // 1200 can only fit in the 1500 buffer.
+  iree_hal_buffer_t* buffer = Allocate(1200);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(buffer), large_allocation);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), 1200);
+  iree_hal_buffer_release(buffer);
+
+  // Far smaller requests do not reuse the buffer without splitting.
+  iree_hal_buffer_t* tiny_buffer = Allocate(100);
+  EXPECT_NE(iree_hal_buffer_allocated_buffer(tiny_buffer), large_allocation);
+  iree_hal_buffer_release(tiny_buffer);
+}
+
+// Large free buffers are split to service multiple live requests and return
+// to the pool once all suballocations are released.
+TEST_F(CachingAllocatorTest, SplitLargeBuffer) {
+  CreateAllocator(/*min_split_size=*/4096);
+  iree_hal_buffer_t* block_buffer = Allocate(64 * 1024);
+  iree_hal_buffer_t* block_allocation =
+      iree_hal_buffer_allocated_buffer(block_buffer);
+  iree_hal_buffer_release(block_buffer);
+
+  std::vector<iree_hal_buffer_t*> buffers;
+  for (int i = 0; i < 4; ++i) {
+    iree_hal_buffer_t* buffer = Allocate(8 * 1024);
+    EXPECT_EQ(iree_hal_buffer_allocated_buffer(buffer), block_allocation);
+    buffers.push_back(buffer);
+  }
+
+  // Suballocations must not overlap.
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    for (size_t j = i + 1; j < buffers.size(); ++j) {
+      iree_device_size_t offset_i = iree_hal_buffer_byte_offset(buffers[i]);
+      iree_device_size_t offset_j = iree_hal_buffer_byte_offset(buffers[j]);
+      EXPECT_TRUE(offset_i + 8 * 1024 <= offset_j ||
+                  offset_j + 8 * 1024 <= offset_i);
+    }
+  }
+
+  // Freed ranges are reused and coalesced.
+  iree_hal_buffer_release(buffers[1]);
+  iree_hal_buffer_release(buffers[2]);
+  iree_hal_buffer_t* merged_buffer = Allocate(16 * 1024);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(merged_buffer), block_allocation);
+  iree_hal_buffer_release(merged_buffer);
+  iree_hal_buffer_release(buffers[0]);
+  iree_hal_buffer_release(buffers[3]);
+
+  // The whole block is available again.
+  iree_hal_buffer_t* whole_buffer = Allocate(64 * 1024);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(whole_buffer), block_allocation);
+  EXPECT_EQ(iree_hal_buffer_byte_offset(whole_buffer), 0);
+  iree_hal_buffer_release(whole_buffer);
+}
+
+// Cached buffers beyond a multiple of the peak live size are released.
+TEST_F(CachingAllocatorTest, TrimToHighWater) {
+  CreateAllocator(/*min_split_size=*/0);
+  // Each request is larger than any cached buffer and misses.
+  for (iree_device_size_t size = 4 * 1024; size <= 8 * 1024; size += 1024) {
+    iree_hal_buffer_release(Allocate(size));
+  }
+#if IREE_STATISTICS_ENABLE
+  // Only the 7KB and 8KB buffers fit within 2x the 8KB peak.
+  iree_hal_allocator_statistics_t statistics = QueryStatistics();
+  EXPECT_EQ(statistics.cache_miss_count, 5);
+  EXPECT_EQ(statistics.cache_bytes_high_water, 8 * 1024);
+  EXPECT_EQ(statistics.cache_bytes_free, 15 * 1024);
+#endif  // IREE_STATISTICS_ENABLE
+
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator_));
+#if IREE_STATISTICS_ENABLE
+  statistics = QueryStatistics();
+  EXPECT_EQ(statistics.cache_bytes_free, 0);
+  EXPECT_EQ(statistics.cache_bytes_high_water, 0);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -727,13 +727,70 @@ static iree_status_t iree_hal_deferred_command_buffer_push_descriptor_set(
   return iree_ok_status();
 }
 
+// Resolves an indirect |binding| referencing a slot in |binding_table| into a
+// direct binding of the buffer in the table.
+static iree_status_t iree_hal_deferred_command_buffer_resolve_binding(
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_descriptor_set_binding_t* binding) {
+  if (IREE_UNLIKELY(binding->buffer_slot >= binding_table.count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding table slot %u out of range (table has "
+                            "%" PRIhsz " bindings)",
+                            binding->buffer_slot, binding_table.count);
+  }
+  const iree_hal_buffer_binding_t* table_binding =
+      &binding_table.bindings[binding->buffer_slot];
+  if (IREE_UNLIKELY(!table_binding->buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "binding table slot %u has no buffer bound",
+                            binding->buffer_slot);
+  }
+  binding->buffer = table_binding->buffer;
+  if (binding->length == IREE_WHOLE_BUFFER &&
+      table_binding->length != IREE_WHOLE_BUFFER) {
+    if (IREE_UNLIKELY(binding->offset > table_binding->length)) {
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "binding offset %" PRIdsz " exceeds binding table slot %u length "
+          "%" PRIdsz,
+          binding->offset, binding->buffer_slot, table_binding->length);
+    }
+    binding->length = table_binding->length - binding->offset;
+  }
+  binding->offset += table_binding->offset;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_deferred_command_buffer_apply_push_descriptor_set(
     iree_hal_command_buffer_t* target_command_buffer,
     iree_hal_buffer_binding_table_t binding_table,
     const iree_hal_cmd_push_descriptor_set_t* cmd) {
+  // Fast path for direct bindings: pass through the recorded bindings as-is.
+  iree_host_size_t indirect_count = 0;
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    if (!cmd->bindings[i].buffer) ++indirect_count;
+  }
+  if (indirect_count == 0) {
+    return iree_hal_command_buffer_push_descriptor_set(
+        target_command_buffer, cmd->pipeline_layout, cmd->set,
+        cmd->binding_count, cmd->bindings);
+  }
+
+  // Resolve indirect bindings against the binding table provided for this
+  // execution. The binding count is bounded by the recorded command and small.
+  iree_hal_descriptor_set_binding_t* bindings =
+      (iree_hal_descriptor_set_binding_t*)iree_alloca(
+          cmd->binding_count * sizeof(iree_hal_descriptor_set_binding_t));
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    bindings[i] = cmd->bindings[i];
+    if (!bindings[i].buffer) {
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_resolve_binding(
+          binding_table, &bindings[i]));
+    }
+  }
   return iree_hal_command_buffer_push_descriptor_set(
       target_command_buffer, cmd->pipeline_layout, cmd->set, cmd->binding_count,
-      cmd->bindings);
+      bindings);
 }
 
 //===----------------------------------------------------------------------===//
@@ -905,6 +962,24 @@ static const iree_hal_cmd_apply_fn_t iree_hal_cmd_apply_table[] = {
         iree_hal_deferred_command_buffer_apply_execute_commands,
 };
 
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  for (iree_hal_cmd_header_t* cmd = command_buffer->cmd_list.head; cmd != NULL;
+       cmd = cmd->next) {
+    status = iree_hal_cmd_apply_table[cmd->type](target_command_buffer,
+                                                 binding_table, cmd);
+    if (!iree_status_is_ok(status)) break;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* target_command_buffer,
@@ -917,12 +992,8 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
 
   iree_status_t status = iree_hal_command_buffer_begin(target_command_buffer);
   if (iree_status_is_ok(status)) {
-    for (iree_hal_cmd_header_t* cmd = cmd_list->head; cmd != NULL;
-         cmd = cmd->next) {
-      status = iree_hal_cmd_apply_table[cmd->type](target_command_buffer,
-                                                   binding_table, cmd);
-      if (!iree_status_is_ok(status)) break;
-    }
+    status = iree_hal_deferred_command_buffer_apply_commands(
+        base_command_buffer, target_command_buffer, binding_table);
   }
   if (iree_status_is_ok(status)) {
     status = iree_hal_command_buffer_end(target_command_buffer);
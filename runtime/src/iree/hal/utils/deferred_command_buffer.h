@@ -61,6 +61,17 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* target_command_buffer,
     iree_hal_buffer_binding_table_t binding_table);
 
+// Replays the commands recorded in |command_buffer| into a
+// |target_command_buffer| that is already recording, such as when executing
+// the command buffer as a nested command buffer. Indirect bindings referencing
+// binding table slots are resolved against |binding_table|. Unlike
+// iree_hal_deferred_command_buffer_apply the target is not begun or ended and
+// the recorded commands are retained even in one-shot mode.
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply_commands(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,671 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first before _any_ system includes (for O_DIRECT).
+#define _GNU_SOURCE
+
+#include "iree/hal/utils/fd_file.h"
+
+#include "iree/base/internal/wait_handle.h"
+
+//===----------------------------------------------------------------------===//
+// Configuration
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_IOS) || \
+    defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_MACOS)
+#define IREE_HAL_FD_FILE_HAVE_POSIX 1
+#else
+#define IREE_HAL_FD_FILE_HAVE_POSIX 0
+#endif  // IREE_PLATFORM_*
+
+// When 1 asynchronous reads will be issued with io_uring when the kernel
+// supports it. We issue the syscalls directly instead of using liburing and
+// need the eventfd wait handle type to route completions through iree_loop_t.
+#if !defined(IREE_HAL_FD_FILE_IO_URING_ENABLE)
+#if defined(IREE_PLATFORM_LINUX) && defined(IREE_HAVE_WAIT_TYPE_EVENTFD) && \
+    defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IREE_HAL_FD_FILE_IO_URING_ENABLE 1
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // IREE_PLATFORM_LINUX && IREE_HAVE_WAIT_TYPE_EVENTFD
+#endif  // !IREE_HAL_FD_FILE_IO_URING_ENABLE
+#if !defined(IREE_HAL_FD_FILE_IO_URING_ENABLE)
+#define IREE_HAL_FD_FILE_IO_URING_ENABLE 0
+#endif  // !IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+#if IREE_HAL_FD_FILE_HAVE_POSIX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_fd_file_t {
+  iree_hal_resource_t resource;
+  // Used to allocate this structure.
+  iree_allocator_t host_allocator;
+  // Allowed access bits.
+  iree_hal_memory_access_t access;
+  // File descriptor used for buffered (page cache) IO.
+  int fd;
+  // Optional O_DIRECT file descriptor used for aligned IO or -1 if not opened.
+  int direct_fd;
+  // True if the file descriptors were opened by us and must be closed.
+  bool owns_fds;
+  // Called on destruction to allow for creators to manage lifetime.
+  iree_hal_file_release_callback_t release_callback;
+} iree_hal_fd_file_t;
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable;
+
+static iree_hal_fd_file_t* iree_hal_fd_file_cast(
+    iree_hal_file_t* IREE_RESTRICT base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_fd_file_vtable);
+  return (iree_hal_fd_file_t*)base_value;
+}
+
+static iree_status_t iree_hal_fd_file_create(
+    iree_hal_memory_access_t access, int fd, int direct_fd, bool owns_fds,
+    iree_hal_file_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  iree_hal_fd_file_t* file = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, sizeof(*file), (void**)&file));
+  iree_hal_resource_initialize(&iree_hal_fd_file_vtable, &file->resource);
+  file->host_allocator = host_allocator;
+  file->access = access;
+  file->fd = fd;
+  file->direct_fd = direct_fd;
+  file->owns_fds = owns_fds;
+  file->release_callback = release_callback;
+  *out_file = (iree_hal_file_t*)file;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_open(
+    iree_hal_memory_access_t access, iree_string_view_t path,
+    iree_hal_fd_file_flags_t flags, iree_allocator_t host_allocator,
+    iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  // Paths are not guaranteed to be NUL terminated.
+  char* path_str = (char*)iree_alloca(path.size + 1);
+  memcpy(path_str, path.data, path.size);
+  path_str[path.size] = 0;
+
+  int open_flags = O_CLOEXEC;
+  if (iree_all_bits_set(access, IREE_HAL_MEMORY_ACCESS_READ |
+                                    IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    open_flags |= O_RDWR | O_CREAT;
+  } else if (iree_any_bit_set(access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    open_flags |= O_WRONLY | O_CREAT;
+  } else {
+    open_flags |= O_RDONLY;
+  }
+
+  int fd = open(path_str, open_flags, 0644);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%.*s'", (int)path.size,
+                            path.data);
+  }
+
+  // Direct IO is a hint: some file systems (tmpfs, some network file systems)
+  // reject O_DIRECT and we fall back to buffered IO for all transfers.
+  int direct_fd = -1;
+#if defined(O_DIRECT)
+  if (iree_all_bits_set(flags, IREE_HAL_FD_FILE_FLAG_DIRECT_IO)) {
+    direct_fd = open(path_str, (open_flags & ~O_CREAT) | O_DIRECT);
+    IREE_TRACE_ZONE_APPEND_TEXT(
+        z0, direct_fd != -1 ? "direct IO" : "direct IO unavailable");
+  }
+#endif  // O_DIRECT
+
+  iree_status_t status = iree_hal_fd_file_create(
+      access, fd, direct_fd, /*owns_fds=*/true,
+      iree_hal_file_release_callback_null(), host_allocator, out_file);
+  if (!iree_status_is_ok(status)) {
+    if (direct_fd != -1) close(direct_fd);
+    close(fd);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_wrap(
+    iree_hal_memory_access_t access, int fd,
+    iree_hal_file_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_fd_file_create(
+      access, fd, /*direct_fd=*/-1, /*owns_fds=*/false, release_callback,
+      host_allocator, out_file);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT bool iree_hal_fd_file_isa(iree_hal_file_t* file) {
+  return iree_hal_resource_is(file, &iree_hal_fd_file_vtable);
+}
+
+static void iree_hal_fd_file_destroy(iree_hal_file_t* IREE_RESTRICT base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  iree_allocator_t host_allocator = file->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (file->owns_fds) {
+    if (file->direct_fd != -1) close(file->direct_fd);
+    close(file->fd);
+  }
+  if (file->release_callback.fn) {
+    file->release_callback.fn(file->release_callback.user_data);
+  }
+
+  iree_allocator_free(host_allocator, file);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_hal_memory_access_t iree_hal_fd_file_allowed_access(
+    iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  return file->access;
+}
+
+static uint64_t iree_hal_fd_file_length(iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  struct stat file_stat;
+  if (fstat(file->fd, &file_stat) == -1) return 0;
+  return (uint64_t)file_stat.st_size;
+}
+
+static iree_hal_buffer_t* iree_hal_fd_file_storage_buffer(
+    iree_hal_file_t* base_file) {
+  // File descriptors are never directly device-accessible.
+  return NULL;
+}
+
+// Returns the file descriptor to use for a transfer of |length| bytes between
+// |file_offset| and |host_ptr|. O_DIRECT requires all three to be aligned.
+static int iree_hal_fd_file_select_fd(iree_hal_fd_file_t* file,
+                                      uint64_t file_offset,
+                                      const void* host_ptr,
+                                      iree_host_size_t length) {
+  if (file->direct_fd == -1) return file->fd;
+  const uint64_t combined =
+      file_offset | (uint64_t)(uintptr_t)host_ptr | (uint64_t)length;
+  return (combined % IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT) == 0
+             ? file->direct_fd
+             : file->fd;
+}
+
+// Reads all of |target| from |file_offset| handling partial reads.
+static iree_status_t iree_hal_fd_file_pread(iree_hal_fd_file_t* file,
+                                            uint64_t file_offset,
+                                            iree_byte_span_t target) {
+  const int fd = iree_hal_fd_file_select_fd(file, file_offset, target.data,
+                                            target.data_length);
+  uint8_t* ptr = target.data;
+  iree_host_size_t remaining = target.data_length;
+  while (remaining > 0) {
+    ssize_t read_length = pread(fd, ptr, remaining, (off_t)file_offset);
+    if (read_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "pread of %" PRIhsz " bytes at offset %" PRIu64
+                              " failed",
+                              remaining, file_offset);
+    } else if (read_length == 0) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "end of file reached with %" PRIhsz
+                              " bytes remaining to read at offset %" PRIu64,
+                              remaining, file_offset);
+    }
+    ptr += read_length;
+    remaining -= (iree_host_size_t)read_length;
+    file_offset += (uint64_t)read_length;
+  }
+  return iree_ok_status();
+}
+
+// Writes all of |source| to |file_offset| handling partial writes.
+static iree_status_t iree_hal_fd_file_pwrite(iree_hal_fd_file_t* file,
+                                             uint64_t file_offset,
+                                             iree_const_byte_span_t source) {
+  const int fd = iree_hal_fd_file_select_fd(file, file_offset, source.data,
+                                            source.data_length);
+  const uint8_t* ptr = source.data;
+  iree_host_size_t remaining = source.data_length;
+  while (remaining > 0) {
+    ssize_t write_length = pwrite(fd, ptr, remaining, (off_t)file_offset);
+    if (write_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "pwrite of %" PRIhsz " bytes at offset %" PRIu64
+                              " failed",
+                              remaining, file_offset);
+    }
+    ptr += write_length;
+    remaining -= (iree_host_size_t)write_length;
+    file_offset += (uint64_t)write_length;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_fd_file_read(
+    iree_hal_file_t* base_file, uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (length == 0) return iree_ok_status();
+
+  // Read directly into the mapped buffer to avoid an intermediate copy.
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, buffer_offset, length, &mapping));
+  iree_status_t status =
+      iree_hal_fd_file_pread(file, file_offset, mapping.contents);
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status =
+        iree_hal_buffer_mapping_flush_range(&mapping, 0, IREE_WHOLE_BUFFER);
+  }
+  iree_hal_buffer_unmap_range(&mapping);
+  return status;
+}
+
+static iree_status_t iree_hal_fd_file_write(
+    iree_hal_file_t* base_file, uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (length == 0) return iree_ok_status();
+
+  // Write directly from the mapped buffer to avoid an intermediate copy.
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+      buffer_offset, length, &mapping));
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_invalidate_range(&mapping, 0,
+                                                      IREE_WHOLE_BUFFER);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fd_file_pwrite(
+        file, file_offset,
+        iree_make_const_byte_span(mapping.contents.data,
+                                  mapping.contents.data_length));
+  }
+  iree_hal_buffer_unmap_range(&mapping);
+  return status;
+}
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable = {
+    .destroy = iree_hal_fd_file_destroy,
+    .allowed_access = iree_hal_fd_file_allowed_access,
+    .length = iree_hal_fd_file_length,
+    .storage_buffer = iree_hal_fd_file_storage_buffer,
+    .read = iree_hal_fd_file_read,
+    .write = iree_hal_fd_file_write,
+};
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_open(
+    iree_hal_memory_access_t access, iree_string_view_t path,
+    iree_hal_fd_file_flags_t flags, iree_allocator_t host_allocator,
+    iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptors not supported on this platform");
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_wrap(
+    iree_hal_memory_access_t access, int fd,
+    iree_hal_file_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptors not supported on this platform");
+}
+
+IREE_API_EXPORT bool iree_hal_fd_file_isa(iree_hal_file_t* file) {
+  return false;
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_POSIX
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_reader_t
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_FD_FILE_HAVE_POSIX && IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// Each reader has a single read in flight at a time so the rings can be tiny.
+#define IREE_HAL_FD_FILE_READER_RING_ENTRIES 1
+
+struct iree_hal_fd_file_reader_t {
+  // Used to allocate this structure.
+  iree_allocator_t host_allocator;
+  // Retained file being read.
+  iree_hal_fd_file_t* file;
+
+  // io_uring instance file descriptor.
+  int ring_fd;
+  // Mapped submission queue ring and its fields.
+  void* sq_ring;
+  size_t sq_ring_size;
+  uint32_t* sq_tail;
+  uint32_t* sq_mask;
+  uint32_t* sq_array;
+  // Mapped submission queue entries.
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  // Mapped completion queue ring and its fields.
+  void* cq_ring;
+  size_t cq_ring_size;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t* cq_mask;
+  struct io_uring_cqe* cqes;
+
+  // Event registered with the ring that is signaled on each completion.
+  iree_event_t event;
+
+  // True if a read has been submitted and not yet ended.
+  bool in_flight;
+  // Pending read file offset and target memory.
+  uint64_t file_offset;
+  iree_byte_span_t target;
+  // Storage for the IORING_OP_READV iovec; must remain valid while in flight.
+  struct iovec iovec;
+};
+
+static int iree_io_uring_setup(unsigned entries, struct io_uring_params* p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int iree_io_uring_enter(int ring_fd, unsigned to_submit,
+                               unsigned min_complete, unsigned flags) {
+  return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                      flags, NULL, 0);
+}
+
+static int iree_io_uring_register(int ring_fd, unsigned opcode,
+                                  const void* arg, unsigned nr_args) {
+  return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_create(
+    iree_hal_file_t* base_file, iree_allocator_t host_allocator,
+    iree_hal_fd_file_reader_t** out_reader) {
+  IREE_ASSERT_ARGUMENT(base_file);
+  IREE_ASSERT_ARGUMENT(out_reader);
+  *out_reader = NULL;
+  if (!iree_hal_fd_file_isa(base_file)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "async readers require file descriptor files");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Setup the ring first so that we can early-exit if the kernel doesn't
+  // support io_uring (too old, disabled by seccomp policy, etc).
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = iree_io_uring_setup(IREE_HAL_FD_FILE_READER_RING_ENTRIES,
+                                    &params);
+  if (ring_fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "io_uring unavailable (%d)", errno);
+  }
+
+  iree_hal_fd_file_reader_t* reader = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*reader), (void**)&reader);
+  if (!iree_status_is_ok(status)) {
+    close(ring_fd);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  memset(reader, 0, sizeof(*reader));
+  reader->host_allocator = host_allocator;
+  reader->file = iree_hal_fd_file_cast(base_file);
+  iree_hal_file_retain(base_file);
+  reader->ring_fd = ring_fd;
+  reader->sq_ring = MAP_FAILED;
+  reader->cq_ring = MAP_FAILED;
+  reader->sqes = MAP_FAILED;
+  reader->event.type = IREE_WAIT_PRIMITIVE_TYPE_NONE;
+
+  // Map the rings; we map the SQ and CQ separately as older kernels without
+  // IORING_FEAT_SINGLE_MMAP require it and newer kernels accept it.
+  reader->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  reader->sq_ring = mmap(NULL, reader->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd,
+                         IORING_OFF_SQ_RING);
+  reader->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  reader->cq_ring = mmap(NULL, reader->cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd,
+                         IORING_OFF_CQ_RING);
+  reader->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  reader->sqes = mmap(NULL, reader->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (reader->sq_ring == MAP_FAILED || reader->cq_ring == MAP_FAILED ||
+      reader->sqes == MAP_FAILED) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to map io_uring rings");
+  }
+
+  if (iree_status_is_ok(status)) {
+    uint8_t* sq_ring = (uint8_t*)reader->sq_ring;
+    reader->sq_tail = (uint32_t*)(sq_ring + params.sq_off.tail);
+    reader->sq_mask = (uint32_t*)(sq_ring + params.sq_off.ring_mask);
+    reader->sq_array = (uint32_t*)(sq_ring + params.sq_off.array);
+    uint8_t* cq_ring = (uint8_t*)reader->cq_ring;
+    reader->cq_head = (uint32_t*)(cq_ring + params.cq_off.head);
+    reader->cq_tail = (uint32_t*)(cq_ring + params.cq_off.tail);
+    reader->cq_mask = (uint32_t*)(cq_ring + params.cq_off.ring_mask);
+    reader->cqes = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+  }
+
+  // Completions signal the eventfd which can be waited on via the loop.
+  if (iree_status_is_ok(status)) {
+    status = iree_event_initialize(/*initial_state=*/false, &reader->event);
+  }
+  if (iree_status_is_ok(status)) {
+    int event_fd = reader->event.value.event.fd;
+    if (iree_io_uring_register(ring_fd, IORING_REGISTER_EVENTFD, &event_fd,
+                               1) < 0) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "io_uring eventfd registration failed (%d)",
+                                errno);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_reader = reader;
+  } else {
+    iree_hal_fd_file_reader_destroy(reader);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_hal_fd_file_reader_destroy(
+    iree_hal_fd_file_reader_t* reader) {
+  if (!reader) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = reader->host_allocator;
+
+  // The kernel may still be writing into the target memory; wait for it.
+  iree_status_ignore(iree_hal_fd_file_reader_end(reader));
+
+  if (reader->sqes != MAP_FAILED) munmap(reader->sqes, reader->sqes_size);
+  if (reader->cq_ring != MAP_FAILED) {
+    munmap(reader->cq_ring, reader->cq_ring_size);
+  }
+  if (reader->sq_ring != MAP_FAILED) {
+    munmap(reader->sq_ring, reader->sq_ring_size);
+  }
+  close(reader->ring_fd);
+  iree_event_deinitialize(&reader->event);
+  iree_hal_file_release((iree_hal_file_t*)reader->file);
+
+  iree_allocator_free(host_allocator, reader);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_begin(
+    iree_hal_fd_file_reader_t* reader, uint64_t file_offset,
+    iree_byte_span_t target, iree_wait_source_t* out_wait_source) {
+  IREE_ASSERT_ARGUMENT(reader);
+  IREE_ASSERT_ARGUMENT(out_wait_source);
+  *out_wait_source = iree_wait_source_immediate();
+  if (reader->in_flight) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "reader already has a read in flight");
+  }
+  if (target.data_length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, file_offset);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)target.data_length);
+
+  reader->file_offset = file_offset;
+  reader->target = target;
+  reader->iovec.iov_base = target.data;
+  reader->iovec.iov_len = target.data_length;
+
+  // Fill the only SQE and publish it to the kernel.
+  struct io_uring_sqe* sqe = &reader->sqes[0];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = iree_hal_fd_file_select_fd(reader->file, file_offset, target.data,
+                                       target.data_length);
+  sqe->off = file_offset;
+  sqe->addr = (uint64_t)(uintptr_t)&reader->iovec;
+  sqe->len = 1;
+  const uint32_t sq_tail = *reader->sq_tail;
+  reader->sq_array[sq_tail & *reader->sq_mask] = 0;
+  __atomic_store_n(reader->sq_tail, sq_tail + 1, __ATOMIC_RELEASE);
+
+  int ret = 0;
+  do {
+    ret = iree_io_uring_enter(reader->ring_fd, /*to_submit=*/1,
+                              /*min_complete=*/0, /*flags=*/0);
+  } while (ret < 0 && errno == EINTR);
+  if (ret != 1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        ret < 0 ? iree_status_code_from_errno(errno) : IREE_STATUS_INTERNAL,
+        "io_uring read submission failed");
+  }
+
+  reader->in_flight = true;
+  *out_wait_source = iree_event_await(&reader->event);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_fd_file_reader_end(iree_hal_fd_file_reader_t* reader) {
+  IREE_ASSERT_ARGUMENT(reader);
+  if (!reader->in_flight) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Reap the completion, blocking if it has not yet been posted.
+  const uint32_t cq_head = *reader->cq_head;
+  while (cq_head == __atomic_load_n(reader->cq_tail, __ATOMIC_ACQUIRE)) {
+    int ret = iree_io_uring_enter(reader->ring_fd, /*to_submit=*/0,
+                                  /*min_complete=*/1, IORING_ENTER_GETEVENTS);
+    if (ret < 0 && errno != EINTR) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring completion wait failed");
+    }
+  }
+  const int32_t result = reader->cqes[cq_head & *reader->cq_mask].res;
+  __atomic_store_n(reader->cq_head, cq_head + 1, __ATOMIC_RELEASE);
+  reader->in_flight = false;
+
+  // NOTE: the kernel may signal the event after we observe the completion. A
+  // stale signal only causes an early wake on the next read and we block above
+  // for the real completion.
+  iree_event_reset(&reader->event);
+
+  iree_status_t status = iree_ok_status();
+  if (result < 0) {
+    status = iree_make_status(iree_status_code_from_errno(-result),
+                              "io_uring read at offset %" PRIu64 " failed",
+                              reader->file_offset);
+  } else if ((iree_host_size_t)result < reader->target.data_length) {
+    // Short reads happen on signals and very large reads; finish the
+    // remainder synchronously as it's rare.
+    status = iree_hal_fd_file_pread(
+        reader->file, reader->file_offset + (uint64_t)result,
+        iree_make_byte_span(reader->target.data + result,
+                            reader->target.data_length - result));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+struct iree_hal_fd_file_reader_t {
+  int reserved;
+};
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_create(
+    iree_hal_file_t* base_file, iree_allocator_t host_allocator,
+    iree_hal_fd_file_reader_t** out_reader) {
+  IREE_ASSERT_ARGUMENT(out_reader);
+  *out_reader = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "async file reads not supported on this platform");
+}
+
+IREE_API_EXPORT void iree_hal_fd_file_reader_destroy(
+    iree_hal_fd_file_reader_t* reader) {}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_begin(
+    iree_hal_fd_file_reader_t* reader, uint64_t file_offset,
+    iree_byte_span_t target, iree_wait_source_t* out_wait_source) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "async file reads not supported on this platform");
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_fd_file_reader_end(iree_hal_fd_file_reader_t* reader) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "async file reads not supported on this platform");
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_POSIX && IREE_HAL_FD_FILE_IO_URING_ENABLE
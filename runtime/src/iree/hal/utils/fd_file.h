@@ -0,0 +1,104 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_FD_FILE_H_
+#define IREE_HAL_UTILS_FD_FILE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_t
+//===----------------------------------------------------------------------===//
+
+// Required alignment of file offsets, lengths, and host pointers for transfers
+// to use the direct (unbuffered) file descriptor. Transfers that don't meet the
+// alignment fall back to the buffered file descriptor.
+#define IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT 4096
+
+// Flags controlling how a file descriptor file is opened.
+enum iree_hal_fd_file_flag_bits_t {
+  IREE_HAL_FD_FILE_FLAG_NONE = 0u,
+  // Opens an additional O_DIRECT file descriptor that bypasses the page cache
+  // for aligned transfers. Useful for streaming large files that will only be
+  // read once (parameters, weights) without evicting the rest of the cache.
+  // Ignored on platforms without O_DIRECT support.
+  IREE_HAL_FD_FILE_FLAG_DIRECT_IO = 1u << 0,
+};
+typedef uint32_t iree_hal_fd_file_flags_t;
+
+// Opens the file at |path| as a file handle backed by a POSIX file descriptor.
+// Reads and writes are performed with pread/pwrite into mapped buffers and the
+// file length is queried from the file system when opened.
+//
+// |access| determines whether the file is opened read-only, write-only, or
+// read-write. Writable files will be created if they do not exist.
+//
+// Returns IREE_STATUS_UNAVAILABLE on platforms without POSIX file descriptors.
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_open(
+    iree_hal_memory_access_t access, iree_string_view_t path,
+    iree_hal_fd_file_flags_t flags, iree_allocator_t host_allocator,
+    iree_hal_file_t** out_file);
+
+// Wraps an existing POSIX file descriptor |fd| in a file handle.
+// The file descriptor is not owned and must remain valid until
+// |release_callback| is called when the file is destroyed.
+//
+// Returns IREE_STATUS_UNAVAILABLE on platforms without POSIX file descriptors.
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_wrap(
+    iree_hal_memory_access_t access, int fd,
+    iree_hal_file_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file);
+
+// Returns true if |file| is a file descriptor file.
+IREE_API_EXPORT bool iree_hal_fd_file_isa(iree_hal_file_t* file);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_reader_t
+//===----------------------------------------------------------------------===//
+
+// An asynchronous reader with a single read in flight at a time.
+// Streaming transfers create one reader per transfer worker such that there can
+// be as many reads in flight as there are staging chunks. Completion is
+// signaled via a wait source that can be waited on with iree_loop_wait_one.
+//
+// Backed by io_uring on Linux; not available on other platforms.
+typedef struct iree_hal_fd_file_reader_t iree_hal_fd_file_reader_t;
+
+// Creates an asynchronous reader for the file descriptor file |file|.
+// Returns IREE_STATUS_UNAVAILABLE if asynchronous reads are not supported by
+// the platform or kernel and callers should use iree_hal_file_read instead.
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_create(
+    iree_hal_file_t* file, iree_allocator_t host_allocator,
+    iree_hal_fd_file_reader_t** out_reader);
+
+// Destroys |reader|, blocking until any read in flight has completed.
+IREE_API_EXPORT void iree_hal_fd_file_reader_destroy(
+    iree_hal_fd_file_reader_t* reader);
+
+// Begins reading |target|.data_length bytes from |file_offset| into |target|.
+// |out_wait_source| will resolve when the read completes and the caller must
+// then call iree_hal_fd_file_reader_end to retrieve the result. The |target|
+// memory must remain valid until the read has ended.
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_reader_begin(
+    iree_hal_fd_file_reader_t* reader, uint64_t file_offset,
+    iree_byte_span_t target, iree_wait_source_t* out_wait_source);
+
+// Ends the read begun with iree_hal_fd_file_reader_begin and returns its
+// result. Blocks if the read has not yet completed such that callers aborting
+// a transfer can safely release the target memory afterward.
+IREE_API_EXPORT iree_status_t
+iree_hal_fd_file_reader_end(iree_hal_fd_file_reader_t* reader);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_FD_FILE_H_
@@ -0,0 +1,249 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/fd_file.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if IREE_FILE_IO_ENABLE
+
+namespace iree {
+namespace hal {
+namespace {
+
+std::string GetUniquePath(const char* unique_name) {
+  const char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TEMP");
+  if (!test_tmpdir) test_tmpdir = "/tmp";
+  std::random_device d;
+  uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+  char unique_path[256];
+  snprintf(unique_path, sizeof(unique_path), "%s/iree_test_%" PRIx64 "_%s",
+           test_tmpdir, random, unique_name);
+  return unique_path;
+}
+
+// Returns |length| bytes of a pattern that differs at every offset within a
+// direct IO alignment block.
+std::vector<uint8_t> MakeContents(size_t length) {
+  std::vector<uint8_t> contents(length);
+  for (size_t i = 0; i < length; ++i) {
+    contents[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+  }
+  return contents;
+}
+
+class FdFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override {
+    for (auto& path : paths_) remove(path.c_str());
+    iree_hal_allocator_release(device_allocator_);
+  }
+
+  // Writes |contents| to a new file and returns its path.
+  std::string WriteFile(const char* unique_name,
+                        const std::vector<uint8_t>& contents) {
+    std::string path = GetUniquePath(unique_name);
+    paths_.push_back(path);
+    IREE_CHECK_OK(iree_file_write_contents(
+        path.c_str(),
+        iree_make_const_byte_span(contents.data(), contents.size())));
+    return path;
+  }
+
+  // Opens |path| as a file descriptor file.
+  iree_hal_file_t* OpenFile(const std::string& path,
+                            iree_hal_memory_access_t access,
+                            iree_hal_fd_file_flags_t flags) {
+    iree_hal_file_t* file = NULL;
+    iree_status_t status = iree_hal_fd_file_open(
+        access, iree_make_string_view(path.data(), path.size()), flags,
+        iree_allocator_system(), &file);
+    IREE_CHECK_OK(status);
+    return file;
+  }
+
+  iree_hal_buffer_t* AllocateBuffer(iree_device_size_t length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+    params.min_alignment = IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     length, &buffer));
+    return buffer;
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer,
+                                  iree_device_size_t offset,
+                                  iree_device_size_t length) {
+    std::vector<uint8_t> contents(length);
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, offset, contents.data(), length));
+    return contents;
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  std::vector<std::string> paths_;
+};
+
+TEST_F(FdFileTest, Read) {
+  auto contents = MakeContents(10000);
+  auto path = WriteFile("Read", contents);
+  iree_hal_file_t* file = OpenFile(path, IREE_HAL_MEMORY_ACCESS_READ,
+                                   IREE_HAL_FD_FILE_FLAG_NONE);
+  EXPECT_TRUE(iree_hal_fd_file_isa(file));
+  EXPECT_EQ(iree_hal_file_allowed_access(file), IREE_HAL_MEMORY_ACCESS_READ);
+  EXPECT_EQ(iree_hal_file_length(file), contents.size());
+  EXPECT_EQ(iree_hal_file_storage_buffer(file), nullptr);
+
+  // Read an unaligned subrange into an offset within the buffer.
+  iree_hal_buffer_t* buffer = AllocateBuffer(8192);
+  IREE_ASSERT_OK(iree_hal_file_read(file, 123, buffer, 16, 5000));
+  auto actual = ReadBuffer(buffer, 16, 5000);
+  EXPECT_EQ(actual, std::vector<uint8_t>(contents.begin() + 123,
+                                         contents.begin() + 123 + 5000));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, ReadPastEnd) {
+  auto contents = MakeContents(100);
+  auto path = WriteFile("ReadPastEnd", contents);
+  iree_hal_file_t* file = OpenFile(path, IREE_HAL_MEMORY_ACCESS_READ,
+                                   IREE_HAL_FD_FILE_FLAG_NONE);
+  iree_hal_buffer_t* buffer = AllocateBuffer(256);
+  iree_status_t status = iree_hal_file_read(file, 50, buffer, 0, 100);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE, status);
+  iree_status_free(status);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, WriteThenRead) {
+  auto path = GetUniquePath("WriteThenRead");
+  paths_.push_back(path);
+  iree_hal_file_t* file =
+      OpenFile(path, IREE_HAL_MEMORY_ACCESS_ALL, IREE_HAL_FD_FILE_FLAG_NONE);
+
+  auto contents = MakeContents(3000);
+  iree_hal_buffer_t* source_buffer = AllocateBuffer(contents.size());
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(source_buffer, 0, contents.data(),
+                                           contents.size()));
+  IREE_ASSERT_OK(
+      iree_hal_file_write(file, 100, source_buffer, 0, contents.size()));
+  EXPECT_EQ(iree_hal_file_length(file), 100 + contents.size());
+
+  iree_hal_buffer_t* target_buffer = AllocateBuffer(contents.size());
+  IREE_ASSERT_OK(
+      iree_hal_file_read(file, 100, target_buffer, 0, contents.size()));
+  EXPECT_EQ(ReadBuffer(target_buffer, 0, contents.size()), contents);
+
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+  iree_hal_file_release(file);
+}
+
+// Direct IO may not be supported by the file system in which case the file
+// falls back to buffered IO; either way the results must match.
+TEST_F(FdFileTest, DirectIO) {
+  const size_t kAlignment = IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT;
+  auto contents = MakeContents(4 * kAlignment);
+  auto path = WriteFile("DirectIO", contents);
+  iree_hal_file_t* file = OpenFile(path, IREE_HAL_MEMORY_ACCESS_READ,
+                                   IREE_HAL_FD_FILE_FLAG_DIRECT_IO);
+  iree_hal_buffer_t* buffer = AllocateBuffer(contents.size());
+
+  // Aligned: may use the direct file descriptor.
+  IREE_ASSERT_OK(
+      iree_hal_file_read(file, kAlignment, buffer, 0, 2 * kAlignment));
+  EXPECT_EQ(ReadBuffer(buffer, 0, 2 * kAlignment),
+            std::vector<uint8_t>(contents.begin() + kAlignment,
+                                 contents.begin() + 3 * kAlignment));
+
+  // Unaligned: must use the buffered file descriptor.
+  IREE_ASSERT_OK(iree_hal_file_read(file, 7, buffer, 0, kAlignment + 3));
+  EXPECT_EQ(ReadBuffer(buffer, 0, kAlignment + 3),
+            std::vector<uint8_t>(contents.begin() + 7,
+                                 contents.begin() + 7 + kAlignment + 3));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, AsyncReader) {
+  auto contents = MakeContents(64 * 1024 + 17);
+  auto path = WriteFile("AsyncReader", contents);
+  iree_hal_file_t* file = OpenFile(path, IREE_HAL_MEMORY_ACCESS_READ,
+                                   IREE_HAL_FD_FILE_FLAG_DIRECT_IO);
+
+  iree_hal_fd_file_reader_t* reader = NULL;
+  iree_status_t status =
+      iree_hal_fd_file_reader_create(file, iree_allocator_system(), &reader);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    iree_hal_file_release(file);
+    GTEST_SKIP() << "async reads unavailable";
+  }
+  IREE_ASSERT_OK(status);
+
+  // Read the file in several chunks reusing the reader for each.
+  std::vector<uint8_t> actual(contents.size());
+  const size_t kChunkSize = 16 * 1024;
+  for (size_t offset = 0; offset < contents.size(); offset += kChunkSize) {
+    size_t length = std::min(kChunkSize, contents.size() - offset);
+    iree_wait_source_t wait_source = iree_wait_source_immediate();
+    IREE_ASSERT_OK(iree_hal_fd_file_reader_begin(
+        reader, offset, iree_make_byte_span(actual.data() + offset, length),
+        &wait_source));
+    IREE_ASSERT_OK(
+        iree_wait_source_wait_one(wait_source, iree_infinite_timeout()));
+    IREE_ASSERT_OK(iree_hal_fd_file_reader_end(reader));
+  }
+  EXPECT_EQ(actual, contents);
+
+  // Reads past the end of the file fail when ended.
+  uint8_t scratch[64];
+  iree_wait_source_t wait_source = iree_wait_source_immediate();
+  IREE_ASSERT_OK(iree_hal_fd_file_reader_begin(
+      reader, contents.size() - 10,
+      iree_make_byte_span(scratch, sizeof(scratch)), &wait_source));
+  status = iree_hal_fd_file_reader_end(reader);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE, status);
+  iree_status_free(status);
+
+  iree_hal_fd_file_reader_destroy(reader);
+  iree_hal_file_release(file);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_FILE_IO_ENABLE
@@ -7,7 +7,7 @@
 #include "iree/hal/utils/file_transfer.h"
 
 #include "iree/base/internal/math.h"
-#include "iree/hal/utils/memory_file.h"
+#include "iree/hal/utils/fd_file.h"
 
 //===----------------------------------------------------------------------===//
 // Configuration
@@ -23,6 +23,13 @@
 #define IREE_HAL_TRANSFER_WORKER_LIMIT 1
 #endif  // !IREE_HAL_TRANSFER_WORKER_LIMIT
 
+#if !defined(IREE_HAL_TRANSFER_ASYNC_WORKER_LIMIT)
+// Maximum number of workers that will be used when reads from the file can be
+// performed asynchronously. Each worker keeps one read in flight and the
+// device copies overlap with the reads of other workers.
+#define IREE_HAL_TRANSFER_ASYNC_WORKER_LIMIT 8
+#endif  // !IREE_HAL_TRANSFER_ASYNC_WORKER_LIMIT
+
 #if !defined(IREE_HAL_TRANSFER_CHUNK_SIZE)
 // Bytes per worker to stage chunks of data. Larger chunks will result in less
 // overhead as fewer copy operations are required.
@@ -36,12 +43,16 @@
 #define IREE_HAL_TRANSFER_CHUNKS_PER_WORKER 8
 #endif  // IREE_HAL_TRANSFER_CHUNKS_PER_WORKER
 
+#if !defined(IREE_HAL_TRANSFER_STAGING_ALIGNMENT)
+// Minimum alignment of staging chunks. File descriptor files are aligned to
+// IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT so that they can use direct IO.
+#define IREE_HAL_TRANSFER_STAGING_ALIGNMENT 64
+#endif  // !IREE_HAL_TRANSFER_STAGING_ALIGNMENT
+
 //===----------------------------------------------------------------------===//
 // iree_hal_transfer_operation_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): move to utils/ without relying on iree_hal_memory_file_t.
-
 // Maximum number of transfer workers that can be used; common usage should be
 // 1-4 but on very large systems with lots of bandwidth we may be able to
 // use more.
@@ -92,6 +103,11 @@ typedef struct iree_hal_transfer_worker_t {
   // Length of the current worker transfer; usually staging_buffer_length but
   // may be less if this worker is processing the end of the file.
   iree_device_size_t pending_transfer_length;
+  // Optional asynchronous file reader used in place of iree_hal_file_read.
+  iree_hal_fd_file_reader_t* reader;
+  // Mapping of the worker staging storage while an asynchronous read is in
+  // flight.
+  iree_hal_buffer_mapping_t staging_mapping;
 } iree_hal_transfer_worker_t;
 
 // Manages an asynchronous transfer operation.
@@ -132,6 +148,8 @@ typedef struct iree_hal_transfer_operation_t {
   // We avoid a subspan buffer here to reduce overheads.
   iree_hal_buffer_t* staging_buffer;
   iree_device_size_t staging_buffer_size;
+  // Minimum alignment of the staging buffer and each worker chunk within it.
+  iree_device_size_t staging_buffer_alignment;
 
   // Offset to where the transfer head is in the operation.
   // Ranges from 0 at the start and length at the end.
@@ -173,11 +191,24 @@ static iree_status_t iree_hal_transfer_operation_create(
 
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(device);
 
+  // File descriptor files read directly into the staging buffer and when
+  // supported keep one asynchronous read in flight per worker. Chunks are
+  // aligned such that direct IO can be used when the file offset allows it.
+  const bool is_fd_file = iree_hal_fd_file_isa(file);
+  bool use_async_reads =
+      is_fd_file && direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER;
+  iree_device_size_t staging_alignment = IREE_HAL_TRANSFER_STAGING_ALIGNMENT;
+  if (is_fd_file) {
+    staging_alignment =
+        iree_max(staging_alignment, IREE_HAL_FD_FILE_DIRECT_IO_ALIGNMENT);
+  }
+
   // Determine how many workers are required and their staging reservation.
   iree_device_size_t worker_chunk_size = options.chunk_size;
   if (worker_chunk_size == IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT) {
     worker_chunk_size = iree_min(IREE_HAL_TRANSFER_CHUNK_SIZE, length);
   }
+  worker_chunk_size = iree_device_align(worker_chunk_size, staging_alignment);
   iree_device_size_t total_chunk_count =
       iree_device_size_ceil_div(length, worker_chunk_size);
   iree_host_size_t worker_count = options.chunk_count;
@@ -186,9 +217,11 @@ static iree_status_t iree_hal_transfer_operation_create(
     worker_count = (iree_host_size_t)iree_device_size_ceil_div(
         total_chunk_count, IREE_HAL_TRANSFER_CHUNKS_PER_WORKER);
   }
-  worker_count =
-      iree_min(worker_count, iree_min(IREE_HAL_TRANSFER_WORKER_LIMIT,
-                                      IREE_HAL_TRANSFER_WORKER_MAX_COUNT));
+  worker_count = iree_min(
+      worker_count,
+      iree_min(use_async_reads ? IREE_HAL_TRANSFER_ASYNC_WORKER_LIMIT
+                               : IREE_HAL_TRANSFER_WORKER_LIMIT,
+               IREE_HAL_TRANSFER_WORKER_MAX_COUNT));
 
   // Calculate total size of the structure with all its associated data.
   iree_hal_transfer_operation_t* operation = NULL;
@@ -223,6 +256,7 @@ static iree_status_t iree_hal_transfer_operation_create(
   operation->buffer_offset = buffer_offset;
   operation->length = length;
   operation->staging_buffer_size = worker_count * worker_chunk_size;
+  operation->staging_buffer_alignment = staging_alignment;
   operation->transfer_head = 0;
   operation->remaining_chunks = (iree_host_size_t)total_chunk_count;
   operation->worker_count = worker_count;
@@ -281,6 +315,33 @@ static iree_status_t iree_hal_transfer_operation_create(
     status = iree_hal_semaphore_create(device, worker->pending_timepoint,
                                        &worker->semaphore);
     if (!iree_status_is_ok(status)) break;
+
+    // Create the asynchronous reader, if possible. If the platform doesn't
+    // support them we fall back to synchronous reads with fewer workers as
+    // there's no benefit in having more than the device can overlap. Readers
+    // can also become unavailable after some have been created (such as when
+    // the process runs out of file descriptors or locked memory for the rings)
+    // in which case the workers that have readers transfer the whole range.
+    if (use_async_reads) {
+      status = iree_hal_fd_file_reader_create(file, host_allocator,
+                                              &worker->reader);
+      if (iree_status_is_unavailable(status)) {
+        status = iree_status_ignore(status);
+        if (i == 0) {
+          IREE_TRACE_ZONE_APPEND_TEXT(z0, "async reads unavailable");
+          use_async_reads = false;
+          worker_count = iree_min(worker_count, IREE_HAL_TRANSFER_WORKER_LIMIT);
+        } else {
+          IREE_TRACE_ZONE_APPEND_TEXT(z0, "async readers exhausted");
+          iree_hal_semaphore_release(worker->semaphore);
+          worker->semaphore = NULL;
+          worker_count = i;
+        }
+        operation->worker_count = worker_count;
+        operation->staging_buffer_size = worker_count * worker_chunk_size;
+      }
+      if (!iree_status_is_ok(status)) break;
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -323,6 +384,7 @@ static void iree_hal_transfer_operation_destroy(
   IREE_ASSERT(operation->live_workers == 0, "all workers must have exited");
 
   for (iree_host_size_t i = 0; i < operation->worker_count; ++i) {
+    iree_hal_fd_file_reader_destroy(operation->workers[i].reader);
     iree_hal_semaphore_release(operation->workers[i].semaphore);
   }
   iree_hal_buffer_release(operation->staging_buffer);
@@ -458,40 +520,19 @@ static iree_status_t iree_hal_transfer_worker_exit(
 }
 
 static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
-    void* user_data, iree_loop_t loop, iree_status_t status) {
-  iree_hal_transfer_worker_t* worker = (iree_hal_transfer_worker_t*)user_data;
-  iree_hal_transfer_operation_t* operation = worker->operation;
+    void* user_data, iree_loop_t loop, iree_status_t status);
+
+// Issues an asynchronous copy of the worker's pending transfer from the
+// staging buffer into the target buffer and waits for it to complete. If the
+// remaining chunks are covered by other live workers then the worker exits
+// instead such that the final dealloca can chain on to the copy.
+static iree_status_t iree_hal_transfer_worker_copy_staging_to_buffer(
+    iree_hal_transfer_operation_t* operation,
+    iree_hal_transfer_worker_t* worker, iree_loop_t loop) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker->trace_id);
 
-  // Bail immediately if the operation has failed.
-  if (!iree_status_is_ok(status) ||
-      !iree_status_is_ok(operation->error_status)) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: loop error");
-    IREE_TRACE_ZONE_END(z0);
-    return iree_hal_transfer_worker_exit(operation, worker, status);
-  }
-
-  // Early-exit if we're out of chunks to process.
-  // This can happen with some loop implementations that run things in batches.
-  if (operation->remaining_chunks == 0) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "exit: no remaining chunks");
-    IREE_TRACE_ZONE_END(z0);
-    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
-  }
-
-  // Grab a piece of the transfer to operate on.
-  --operation->remaining_chunks;
-  iree_device_size_t transfer_offset = operation->transfer_head;
-  iree_device_size_t transfer_length = iree_min(
-      operation->length - transfer_offset, worker->staging_buffer_length);
-  IREE_ASSERT(transfer_length > 0,
-              "should not have ticked if there was no work to do");
-  operation->transfer_head += transfer_length;
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_offset);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
-
   // Timeline increments by one.
   uint64_t wait_timepoint = worker->pending_timepoint;
   iree_hal_semaphore_list_t wait_semaphore_list = {
@@ -506,25 +547,13 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
       .payload_values = &signal_timepoint,
   };
 
-  // Track the pending copy operation so we know where to place it in the
-  // buffer.
-  worker->pending_transfer_offset = transfer_offset;
-  worker->pending_transfer_length = transfer_length;
-
-  // Synchronously copy the contents from the file to the staging buffer.
-  status = iree_hal_file_read(
-      operation->file, operation->file_offset + worker->pending_transfer_offset,
-      operation->staging_buffer, worker->staging_buffer_offset,
-      worker->pending_transfer_length);
-
   // Issue asynchronous copy from the staging buffer into the target buffer.
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_device_queue_copy(
-        operation->device, operation->queue_affinity, wait_semaphore_list,
-        signal_semaphore_list, operation->staging_buffer,
-        worker->staging_buffer_offset, operation->buffer,
-        operation->buffer_offset + transfer_offset, transfer_length);
-  }
+  iree_status_t status = iree_hal_device_queue_copy(
+      operation->device, operation->queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, operation->staging_buffer,
+      worker->staging_buffer_offset, operation->buffer,
+      operation->buffer_offset + worker->pending_transfer_offset,
+      worker->pending_transfer_length);
 
   // Wait for the copy to complete and tick again if we expect there to be more
   // work. If there are no more chunks to copy (or they are spoken for by other
@@ -548,6 +577,42 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
     }
   }
 
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Completes an asynchronous read into the worker staging storage and issues
+// the copy into the target buffer.
+static iree_status_t iree_hal_transfer_worker_read_completed(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_hal_transfer_worker_t* worker = (iree_hal_transfer_worker_t*)user_data;
+  iree_hal_transfer_operation_t* operation = worker->operation;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker->trace_id);
+
+  // Always end the read even if bailing: the kernel may still be writing into
+  // the staging buffer and we can't unmap it until it has finished.
+  status =
+      iree_status_join(status, iree_hal_fd_file_reader_end(worker->reader));
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(iree_hal_buffer_memory_type(operation->staging_buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_flush_range(&worker->staging_mapping, 0,
+                                                 IREE_WHOLE_BUFFER);
+  }
+  iree_hal_buffer_unmap_range(&worker->staging_mapping);
+
+  // Bail if the read failed or the operation has failed.
+  if (!iree_status_is_ok(status) ||
+      !iree_status_is_ok(operation->error_status)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: read error");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_hal_transfer_worker_exit(operation, worker, status);
+  }
+
+  status =
+      iree_hal_transfer_worker_copy_staging_to_buffer(operation, worker, loop);
   if (!iree_status_is_ok(status)) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: copy/wait failure");
     status = iree_hal_transfer_worker_exit(operation, worker, status);
@@ -556,6 +621,102 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
   return status;
 }
 
+// Begins an asynchronous read of the worker's pending transfer directly into
+// the worker staging storage. The staging buffer remains mapped until the read
+// completes.
+static iree_status_t iree_hal_transfer_worker_begin_read(
+    iree_hal_transfer_operation_t* operation,
+    iree_hal_transfer_worker_t* worker, iree_loop_t loop) {
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      operation->staging_buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, worker->staging_buffer_offset,
+      worker->pending_transfer_length, &worker->staging_mapping));
+  iree_wait_source_t wait_source = iree_wait_source_immediate();
+  iree_status_t status = iree_hal_fd_file_reader_begin(
+      worker->reader, operation->file_offset + worker->pending_transfer_offset,
+      worker->staging_mapping.contents, &wait_source);
+  if (iree_status_is_ok(status)) {
+    status = iree_loop_wait_one(loop, wait_source, iree_infinite_timeout(),
+                                iree_hal_transfer_worker_read_completed,
+                                worker);
+    if (!iree_status_is_ok(status)) {
+      // The read is in flight and must finish before we can unmap.
+      status = iree_status_join(status,
+                                iree_hal_fd_file_reader_end(worker->reader));
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_buffer_unmap_range(&worker->staging_mapping);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_hal_transfer_worker_t* worker = (iree_hal_transfer_worker_t*)user_data;
+  iree_hal_transfer_operation_t* operation = worker->operation;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker->trace_id);
+
+  // Bail immediately if the operation has failed.
+  if (!iree_status_is_ok(status) ||
+      !iree_status_is_ok(operation->error_status)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: loop error");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_hal_transfer_worker_exit(operation, worker, status);
+  }
+
+  // Early-exit if we're out of chunks to process.
+  // This can happen with some loop implementations that run things in batches.
+  if (operation->remaining_chunks == 0) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "exit: no remaining chunks");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
+  }
+
+  // Grab a piece of the transfer to operate on.
+  --operation->remaining_chunks;
+  iree_device_size_t transfer_offset = operation->transfer_head;
+  iree_device_size_t transfer_length = iree_min(
+      operation->length - transfer_offset, worker->staging_buffer_length);
+  IREE_ASSERT(transfer_length > 0,
+              "should not have ticked if there was no work to do");
+  operation->transfer_head += transfer_length;
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_offset);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
+
+  // Track the pending copy operation so we know where to place it in the
+  // buffer.
+  worker->pending_transfer_offset = transfer_offset;
+  worker->pending_transfer_length = transfer_length;
+
+  if (worker->reader) {
+    // Asynchronously read the contents from the file to the staging buffer.
+    // The copy into the target buffer is issued when the read completes and
+    // other workers can issue their reads in the meantime.
+    status = iree_hal_transfer_worker_begin_read(operation, worker, loop);
+  } else {
+    // Synchronously copy the contents from the file to the staging buffer.
+    status = iree_hal_file_read(
+        operation->file,
+        operation->file_offset + worker->pending_transfer_offset,
+        operation->staging_buffer, worker->staging_buffer_offset,
+        worker->pending_transfer_length);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_transfer_worker_copy_staging_to_buffer(operation,
+                                                               worker, loop);
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: read/copy/wait failure");
+    status = iree_hal_transfer_worker_exit(operation, worker, status);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Begins the transfer operation after |wait_semaphore_list| is satisfied.
 // Note that if this fails then the transfer never started and it's safe to
 // immediately tear down.
@@ -573,7 +734,7 @@ static iree_status_t iree_hal_transfer_operation_launch_read(
   iree_hal_buffer_params_t staging_buffer_params = {
       .access = IREE_HAL_MEMORY_ACCESS_ALL,
       // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
+      .min_alignment = operation->staging_buffer_alignment,
       .queue_affinity = operation->queue_affinity,
       .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
               IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
@@ -666,16 +827,17 @@ static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
 
   // Timeline increments by one.
+  uint64_t wait_timepoint = worker->pending_timepoint;
   iree_hal_semaphore_list_t wait_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &wait_timepoint,
   };
-  ++worker->pending_timepoint;
+  uint64_t signal_timepoint = ++worker->pending_timepoint;
   iree_hal_semaphore_list_t signal_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &signal_timepoint,
   };
 
   // Track the pending copy operation so we know where to place it in the file.
@@ -764,7 +926,7 @@ static iree_status_t iree_hal_transfer_operation_launch_write(
   iree_hal_buffer_params_t staging_buffer_params = {
       .access = IREE_HAL_MEMORY_ACCESS_ALL,
       // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
+      .min_alignment = operation->staging_buffer_alignment,
       .queue_affinity = operation->queue_affinity,
       .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
               IREE_HAL_MEMORY_TYPE_HOST_CACHED |
@@ -826,7 +988,7 @@ static iree_status_t iree_hal_transfer_operation_launch_write(
 }
 
 //===----------------------------------------------------------------------===//
-// Memory file IO API
+// Streaming file IO API
 //===----------------------------------------------------------------------===//
 
 static iree_status_t iree_hal_file_validate_access(
@@ -901,7 +1063,6 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
     iree_hal_file_t* target_file, uint64_t target_offset,
     iree_device_size_t length, uint32_t flags,
     iree_hal_file_transfer_options_t options) {
-  // EXPERIMENTAL: assume memory files only today (as that's all we have).
   IREE_RETURN_IF_ERROR(
       iree_hal_file_validate_access(target_file, IREE_HAL_MEMORY_ACCESS_WRITE));
 
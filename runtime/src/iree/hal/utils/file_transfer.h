@@ -50,10 +50,13 @@ typedef struct iree_hal_file_transfer_options_t {
 // allocated at once.
 //
 // The provided |options.loop| is used for any asynchronous host operations
-// performed as part of the transfer.
+// performed as part of the transfer. When |source_file| is a file descriptor
+// file (iree_hal_fd_file_open) and the platform supports it each chunk is read
+// asynchronously such that up to |options.chunk_count| reads are in flight
+// while the device copies completed chunks.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with host files such as those created via
+// iree_hal_memory_file_wrap or iree_hal_fd_file_open.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -75,8 +78,8 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
 // The provided |options.loop| is used for any asynchronous host operations
 // performed as part of the transfer.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with host files such as those created via
+// iree_hal_memory_file_wrap or iree_hal_fd_file_open.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
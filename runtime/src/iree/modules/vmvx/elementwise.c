@@ -14,263 +14,461 @@
 #include <math.h>
 
 //===----------------------------------------------------------------------===//
-// Helpers for defining generic implementations of elementwise functions.
-// Since it affords the best code size tradeoff options, the entrypoint
-// is dispatched based on an opcode.
+// Generic row functions.
+// These are the portable fallbacks used for every opcode that has no
+// architecture-specific row function (see iree_uk_*_select_row_func) on the
+// current CPU. Each is a plain loop that compilers are free to autovectorize.
 //===----------------------------------------------------------------------===//
 
-// Opcodes for generic functions operating on 32-bit operands and result.
-// Since the outer dispatcher only differentiates based on width, all other
-// type specificity is carried by the opcode.
-// Binary opcodes are named "X32B" and unary opcodes "X32U".
-// The initial list was sorted, and it is encouraged to sort extensions, but
-// each opcode must be numerically stable, so the list is not expected to
-// be sorted over time.
-typedef enum {
-  IREE_UK_X32B_ADDF = 0,
-  IREE_UK_X32B_ADDI = 1,
-  IREE_UK_X32B_ANDI = 2,
-  IREE_UK_X32B_DIVF = 3,
-  IREE_UK_X32B_DIVSI = 4,
-  IREE_UK_X32B_DIVUI = 5,
-  IREE_UK_X32B_MULF = 6,
-  IREE_UK_X32B_MULI = 7,
-  IREE_UK_X32B_ORI = 8,
-  IREE_UK_X32B_SHLI = 9,
-  IREE_UK_X32B_SHRSI = 10,
-  IREE_UK_X32B_SHRUI = 11,
-  IREE_UK_X32B_SUBF = 12,
-  IREE_UK_X32B_SUBI = 13,
-  IREE_UKENREL_X32B_XORI = 14,
-} iree_uk_x32b_opcode_t;
+// Defines iree_uk_generic_{category}_{name}_row computing |expr| of the
+// elements `a` and `b` of type |type|.
+#define IREE_UK_GENERIC_BINARY_ROW_FUNC(category, name, type, expr) \
+  static void iree_uk_generic_##category##_##name##_row(            \
+      const void* lhs_ptr, const void* rhs_ptr, void* out_ptr,      \
+      iree_uk_index_t size) {                                       \
+    const type* lhs = (const type*)lhs_ptr;                         \
+    const type* rhs = (const type*)rhs_ptr;                         \
+    type* out = (type*)out_ptr;                                     \
+    for (iree_uk_index_t i = 0; i < size; ++i) {                    \
+      type a = lhs[i];                                              \
+      type b = rhs[i];                                              \
+      out[i] = (type)(expr);                                        \
+    }                                                               \
+  }
 
-typedef enum {
-  IREE_UK_X32U_ABSF,
-  IREE_UK_X32U_CEILF,
-  IREE_UK_X32U_CTLZ,
-  IREE_UK_X32U_EXPF,
-  IREE_UK_X32U_FLOORF,
-  IREE_UK_X32U_LOGF,
-  IREE_UK_X32U_NEGF,
-  IREE_UK_X32U_RSQRTF,
-} iree_uk_x32u_opcode_t;
+// Defines iree_uk_generic_{category}_{name}_row computing |expr| of the
+// element `a` of type |type|.
+#define IREE_UK_GENERIC_UNARY_ROW_FUNC(category, name, type, expr) \
+  static void iree_uk_generic_##category##_##name##_row(           \
+      const void* in_ptr, void* out_ptr, iree_uk_index_t size) {   \
+    const type* in = (const type*)in_ptr;                          \
+    type* out = (type*)out_ptr;                                    \
+    for (iree_uk_index_t i = 0; i < size; ++i) {                   \
+      type a = in[i];                                              \
+      out[i] = (type)(expr);                                       \
+    }                                                              \
+  }
 
-// Macros to access various typed, dereferenced pointers.
-#define ASF32(ptr) *((float*)ptr)
-#define ASUI32(ptr) *((iree_uk_uint32_t*)ptr)
-#define ASSI32(ptr) *((iree_uk_int32_t*)ptr)
+// 16-bit floating-point ops are computed in f32 and rounded back.
+#define IREE_UK_F16_BINARY(op) \
+  iree_uk_f32_to_f16(iree_uk_f16_to_f32(a) op iree_uk_f16_to_f32(b))
+#define IREE_UK_BF16_BINARY(op) \
+  iree_uk_f32_to_bf16(iree_uk_bf16_to_f32(a) op iree_uk_bf16_to_f32(b))
+#define IREE_UK_F16_UNARY(func) iree_uk_f32_to_f16(func(iree_uk_f16_to_f32(a)))
+#define IREE_UK_BF16_UNARY(func) \
+  iree_uk_f32_to_bf16(func(iree_uk_bf16_to_f32(a)))
 
-//===----------------------------------------------------------------------===//
-// Implementation macros.
-//===----------------------------------------------------------------------===//
+static float iree_uk_rsqrtf(float a) { return 1.0f / sqrtf(a); }
 
-// Defines a generic "dispatched" implementation via opcode_t by invoking
-// the function iree_uk_generic_{category}_2d.
-// Corresponds to the header macro DECLARE_UKERNEL_BINARY_2D.
-#define DISPATCH_UKERNEL_BINARY_2D(opcode, opcode_t, dtype, category)         \
-  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                      \
-      const dtype* lhs, iree_uk_index_t lhs_offset,                           \
-      iree_uk_index_t lhs_stride0, iree_uk_index_t lhs_stride1,               \
-      const dtype* rhs, iree_uk_index_t rhs_offset,                           \
-      iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1,               \
-      dtype* IREE_UK_RESTRICT out, iree_uk_index_t out_offset,                \
-      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,               \
-      iree_uk_index_t size0, iree_uk_index_t size1) {                         \
-    return iree_uk_generic_##category##_2d(                                   \
-        opcode_t, lhs, lhs_offset, lhs_stride0, lhs_stride1, rhs, rhs_offset, \
-        rhs_stride0, rhs_stride1, out, out_offset, out_stride0, out_stride1,  \
-        size0, size1);                                                        \
-  }
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, addf, float, a + b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, addi, iree_uk_uint32_t, a + b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, andi, iree_uk_uint32_t, a & b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, divf, float, a / b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, divsi, iree_uk_uint32_t,
+                                (iree_uk_int32_t)a / (iree_uk_int32_t)b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, divui, iree_uk_uint32_t, a / b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, mulf, float, a * b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, muli, iree_uk_uint32_t, a * b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, ori, iree_uk_uint32_t, a | b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, shli, iree_uk_uint32_t, a << b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, shrsi, iree_uk_uint32_t,
+                                (iree_uk_int32_t)a >> (iree_uk_int32_t)b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, shrui, iree_uk_uint32_t, a >> b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, subf, float, a - b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, subi, iree_uk_uint32_t, a - b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x32b, xori, iree_uk_uint32_t, a ^ b)
 
-// Defines a generic "dispatched" implementation via opcode_t by invoking
-// the function iree_uk_generic_{category}_2d.
-// Corresponds to the header macro DECLARE_UKERNEL_BINARY_2D.
-#define DISPATCH_UKERNEL_UNARY_2D(opcode, opcode_t, dtype, category)          \
-  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                      \
-      const dtype* in, iree_uk_index_t in_offset, iree_uk_index_t in_stride0, \
-      iree_uk_index_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
-      iree_uk_index_t out_offset, iree_uk_index_t out_stride0,                \
-      iree_uk_index_t out_stride1, iree_uk_index_t size0,                     \
-      iree_uk_index_t size1) {                                                \
-    return iree_uk_generic_##category##_2d(                                   \
-        opcode_t, in, in_offset, in_stride0, in_stride1, out, out_offset,     \
-        out_stride0, out_stride1, size0, size1);                              \
-  }
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, absf, float, fabsf(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, ceilf, float, ceilf(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, ctlz, iree_uk_uint32_t,
+                               iree_uk_count_leading_zeros_u32(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, expf, float, expf(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, floorf, float, floorf(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, logf, float, logf(a))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, negf, float, -a)
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x32u, rsqrtf, float, iree_uk_rsqrtf(a))
 
-//===----------------------------------------------------------------------===//
-// Internal helpers.
-//===----------------------------------------------------------------------===//
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, addbf16, iree_uk_uint16_t,
+                                IREE_UK_BF16_BINARY(+))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, addf16, iree_uk_uint16_t,
+                                IREE_UK_F16_BINARY(+))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, divbf16, iree_uk_uint16_t,
+                                IREE_UK_BF16_BINARY(/))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, divf16, iree_uk_uint16_t,
+                                IREE_UK_F16_BINARY(/))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, mulbf16, iree_uk_uint16_t,
+                                IREE_UK_BF16_BINARY(*))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, mulf16, iree_uk_uint16_t,
+                                IREE_UK_F16_BINARY(*))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, subbf16, iree_uk_uint16_t,
+                                IREE_UK_BF16_BINARY(-))
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x16b, subf16, iree_uk_uint16_t,
+                                IREE_UK_F16_BINARY(-))
 
-// Computes a single element of an x32b opcode. On error, should set
-// |*result_code| to a non-zero value (but should not touch it otherwise).
-static void iree_uk_generic_x32b_op(iree_uk_x32b_opcode_t opcode,
-                                    int* result_code,
-                                    const iree_uk_uint32_t* lhs,
-                                    const iree_uk_uint32_t* rhs,
-                                    iree_uk_uint32_t* out) {
-  switch (opcode) {
-    case IREE_UK_X32B_ADDF:
-      ASF32(out) = ASF32(lhs) + ASF32(rhs);
-      return;
-    case IREE_UK_X32B_ADDI:
-      ASUI32(out) = ASUI32(lhs) + ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_ANDI:
-      ASUI32(out) = ASUI32(lhs) & ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_DIVF:
-      ASF32(out) = ASF32(lhs) / ASF32(rhs);
-      return;
-    case IREE_UK_X32B_DIVSI:
-      ASSI32(out) = ASSI32(lhs) / ASSI32(rhs);
-      return;
-    case IREE_UK_X32B_DIVUI:
-      ASUI32(out) = ASUI32(lhs) / ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_MULF:
-      ASF32(out) = ASF32(lhs) * ASF32(rhs);
-      return;
-    case IREE_UK_X32B_MULI:
-      ASUI32(out) = ASUI32(lhs) * ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_ORI:
-      ASUI32(out) = ASUI32(lhs) | ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_SHLI:
-      ASUI32(out) = ASUI32(lhs) << ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_SHRSI:
-      ASSI32(out) = ASSI32(lhs) >> ASSI32(rhs);
-      return;
-    case IREE_UK_X32B_SHRUI:
-      ASUI32(out) = ASUI32(lhs) >> ASUI32(rhs);
-      return;
-    case IREE_UKENREL_X32B_XORI:
-      ASUI32(out) = ASUI32(lhs) ^ ASUI32(rhs);
-      return;
-    case IREE_UK_X32B_SUBF:
-      ASF32(out) = ASF32(lhs) - ASF32(rhs);
-      return;
-    case IREE_UK_X32B_SUBI:
-      ASSI32(out) = ASUI32(lhs) - ASUI32(rhs);
-      return;
-    default:
-      *result_code = 1;
-  }
-}
+// abs and neg only touch the sign bit, which is the same in f16 and bf16.
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, absbf16, iree_uk_uint16_t, a & 0x7FFF)
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, absf16, iree_uk_uint16_t, a & 0x7FFF)
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, ceilbf16, iree_uk_uint16_t,
+                               IREE_UK_BF16_UNARY(ceilf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, ceilf16, iree_uk_uint16_t,
+                               IREE_UK_F16_UNARY(ceilf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, expbf16, iree_uk_uint16_t,
+                               IREE_UK_BF16_UNARY(expf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, expf16, iree_uk_uint16_t,
+                               IREE_UK_F16_UNARY(expf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, floorbf16, iree_uk_uint16_t,
+                               IREE_UK_BF16_UNARY(floorf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, floorf16, iree_uk_uint16_t,
+                               IREE_UK_F16_UNARY(floorf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, logbf16, iree_uk_uint16_t,
+                               IREE_UK_BF16_UNARY(logf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, logf16, iree_uk_uint16_t,
+                               IREE_UK_F16_UNARY(logf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, negbf16, iree_uk_uint16_t, a ^ 0x8000)
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, negf16, iree_uk_uint16_t, a ^ 0x8000)
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, rsqrtbf16, iree_uk_uint16_t,
+                               IREE_UK_BF16_UNARY(iree_uk_rsqrtf))
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x16u, rsqrtf16, iree_uk_uint16_t,
+                               IREE_UK_F16_UNARY(iree_uk_rsqrtf))
+
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, addi, iree_uk_uint8_t, a + b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, andi, iree_uk_uint8_t, a & b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, divsi, iree_uk_uint8_t,
+                                (iree_uk_int8_t)a / (iree_uk_int8_t)b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, divui, iree_uk_uint8_t, a / b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, muli, iree_uk_uint8_t, a * b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, ori, iree_uk_uint8_t, a | b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, shli, iree_uk_uint8_t, a << b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, shrsi, iree_uk_uint8_t,
+                                (iree_uk_int8_t)a >> (iree_uk_int8_t)b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, shrui, iree_uk_uint8_t, a >> b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, subi, iree_uk_uint8_t, a - b)
+IREE_UK_GENERIC_BINARY_ROW_FUNC(x8b, xori, iree_uk_uint8_t, a ^ b)
+
+IREE_UK_GENERIC_UNARY_ROW_FUNC(x8u, ctlz, iree_uk_uint8_t,
+                               iree_uk_count_leading_zeros_u32(a) - 24)
 
-// Computes a single element of an x32u opcode. On error, should set
-// |*result_code| to a non-zero value (but should not touch it otherwise).
-static void iree_uk_generic_x32u_op(iree_uk_x32u_opcode_t opcode,
-                                    int* result_code,
-                                    const iree_uk_uint32_t* in,
-                                    iree_uk_uint32_t* out) {
-  switch (opcode) {
-    case IREE_UK_X32U_ABSF:
-      ASF32(out) = fabsf(ASF32(in));
-      return;
-    case IREE_UK_X32U_CEILF:
-      ASF32(out) = ceilf(ASF32(in));
-      return;
-    case IREE_UK_X32U_CTLZ:
-      ASUI32(out) = iree_uk_count_leading_zeros_u32(ASUI32(in));
-      return;
-    case IREE_UK_X32U_EXPF:
-      ASF32(out) = expf(ASF32(in));
-      return;
-    case IREE_UK_X32U_FLOORF:
-      ASF32(out) = floorf(ASF32(in));
-      return;
-    case IREE_UK_X32U_LOGF:
-      ASF32(out) = logf(ASF32(in));
-      return;
-    case IREE_UK_X32U_NEGF:
-      ASF32(out) = -ASF32(in);
-      return;
-    case IREE_UK_X32U_RSQRTF:
-      ASF32(out) = 1.0f / sqrtf(ASF32(in));
-      return;
-    default:
-      *result_code = 1;
+static const iree_uk_elementwise_row_funcs_t iree_uk_generic_row_funcs = {
+    .x32b =
+        {
+            [IREE_UK_X32B_ADDF] = iree_uk_generic_x32b_addf_row,
+            [IREE_UK_X32B_ADDI] = iree_uk_generic_x32b_addi_row,
+            [IREE_UK_X32B_ANDI] = iree_uk_generic_x32b_andi_row,
+            [IREE_UK_X32B_DIVF] = iree_uk_generic_x32b_divf_row,
+            [IREE_UK_X32B_DIVSI] = iree_uk_generic_x32b_divsi_row,
+            [IREE_UK_X32B_DIVUI] = iree_uk_generic_x32b_divui_row,
+            [IREE_UK_X32B_MULF] = iree_uk_generic_x32b_mulf_row,
+            [IREE_UK_X32B_MULI] = iree_uk_generic_x32b_muli_row,
+            [IREE_UK_X32B_ORI] = iree_uk_generic_x32b_ori_row,
+            [IREE_UK_X32B_SHLI] = iree_uk_generic_x32b_shli_row,
+            [IREE_UK_X32B_SHRSI] = iree_uk_generic_x32b_shrsi_row,
+            [IREE_UK_X32B_SHRUI] = iree_uk_generic_x32b_shrui_row,
+            [IREE_UK_X32B_SUBF] = iree_uk_generic_x32b_subf_row,
+            [IREE_UK_X32B_SUBI] = iree_uk_generic_x32b_subi_row,
+            [IREE_UK_X32B_XORI] = iree_uk_generic_x32b_xori_row,
+        },
+    .x32u =
+        {
+            [IREE_UK_X32U_ABSF] = iree_uk_generic_x32u_absf_row,
+            [IREE_UK_X32U_CEILF] = iree_uk_generic_x32u_ceilf_row,
+            [IREE_UK_X32U_CTLZ] = iree_uk_generic_x32u_ctlz_row,
+            [IREE_UK_X32U_EXPF] = iree_uk_generic_x32u_expf_row,
+            [IREE_UK_X32U_FLOORF] = iree_uk_generic_x32u_floorf_row,
+            [IREE_UK_X32U_LOGF] = iree_uk_generic_x32u_logf_row,
+            [IREE_UK_X32U_NEGF] = iree_uk_generic_x32u_negf_row,
+            [IREE_UK_X32U_RSQRTF] = iree_uk_generic_x32u_rsqrtf_row,
+        },
+    .x16b =
+        {
+            [IREE_UK_X16B_ADDBF16] = iree_uk_generic_x16b_addbf16_row,
+            [IREE_UK_X16B_ADDF16] = iree_uk_generic_x16b_addf16_row,
+            [IREE_UK_X16B_DIVBF16] = iree_uk_generic_x16b_divbf16_row,
+            [IREE_UK_X16B_DIVF16] = iree_uk_generic_x16b_divf16_row,
+            [IREE_UK_X16B_MULBF16] = iree_uk_generic_x16b_mulbf16_row,
+            [IREE_UK_X16B_MULF16] = iree_uk_generic_x16b_mulf16_row,
+            [IREE_UK_X16B_SUBBF16] = iree_uk_generic_x16b_subbf16_row,
+            [IREE_UK_X16B_SUBF16] = iree_uk_generic_x16b_subf16_row,
+        },
+    .x16u =
+        {
+            [IREE_UK_X16U_ABSBF16] = iree_uk_generic_x16u_absbf16_row,
+            [IREE_UK_X16U_ABSF16] = iree_uk_generic_x16u_absf16_row,
+            [IREE_UK_X16U_CEILBF16] = iree_uk_generic_x16u_ceilbf16_row,
+            [IREE_UK_X16U_CEILF16] = iree_uk_generic_x16u_ceilf16_row,
+            [IREE_UK_X16U_EXPBF16] = iree_uk_generic_x16u_expbf16_row,
+            [IREE_UK_X16U_EXPF16] = iree_uk_generic_x16u_expf16_row,
+            [IREE_UK_X16U_FLOORBF16] = iree_uk_generic_x16u_floorbf16_row,
+            [IREE_UK_X16U_FLOORF16] = iree_uk_generic_x16u_floorf16_row,
+            [IREE_UK_X16U_LOGBF16] = iree_uk_generic_x16u_logbf16_row,
+            [IREE_UK_X16U_LOGF16] = iree_uk_generic_x16u_logf16_row,
+            [IREE_UK_X16U_NEGBF16] = iree_uk_generic_x16u_negbf16_row,
+            [IREE_UK_X16U_NEGF16] = iree_uk_generic_x16u_negf16_row,
+            [IREE_UK_X16U_RSQRTBF16] = iree_uk_generic_x16u_rsqrtbf16_row,
+            [IREE_UK_X16U_RSQRTF16] = iree_uk_generic_x16u_rsqrtf16_row,
+        },
+    .x8b =
+        {
+            [IREE_UK_X8B_ADDI] = iree_uk_generic_x8b_addi_row,
+            [IREE_UK_X8B_ANDI] = iree_uk_generic_x8b_andi_row,
+            [IREE_UK_X8B_DIVSI] = iree_uk_generic_x8b_divsi_row,
+            [IREE_UK_X8B_DIVUI] = iree_uk_generic_x8b_divui_row,
+            [IREE_UK_X8B_MULI] = iree_uk_generic_x8b_muli_row,
+            [IREE_UK_X8B_ORI] = iree_uk_generic_x8b_ori_row,
+            [IREE_UK_X8B_SHLI] = iree_uk_generic_x8b_shli_row,
+            [IREE_UK_X8B_SHRSI] = iree_uk_generic_x8b_shrsi_row,
+            [IREE_UK_X8B_SHRUI] = iree_uk_generic_x8b_shrui_row,
+            [IREE_UK_X8B_SUBI] = iree_uk_generic_x8b_subi_row,
+            [IREE_UK_X8B_XORI] = iree_uk_generic_x8b_xori_row,
+        },
+    .x8u =
+        {
+            [IREE_UK_X8U_CTLZ] = iree_uk_generic_x8u_ctlz_row,
+        },
+};
+
+void iree_uk_elementwise_row_funcs_initialize(
+    const iree_uk_uint64_t* cpu_data,
+    iree_uk_elementwise_row_funcs_t* out_row_funcs) {
+  *out_row_funcs = iree_uk_generic_row_funcs;
+  for (int i = 0; i < IREE_UK_X32B_COUNT; ++i) {
+    iree_uk_elementwise_binary_row_func_t row_func =
+        iree_uk_x32b_select_row_func((iree_uk_x32b_opcode_t)i, cpu_data);
+    if (row_func) out_row_funcs->x32b[i] = row_func;
+  }
+  for (int i = 0; i < IREE_UK_X32U_COUNT; ++i) {
+    iree_uk_elementwise_unary_row_func_t row_func =
+        iree_uk_x32u_select_row_func((iree_uk_x32u_opcode_t)i, cpu_data);
+    if (row_func) out_row_funcs->x32u[i] = row_func;
+  }
+  for (int i = 0; i < IREE_UK_X16B_COUNT; ++i) {
+    iree_uk_elementwise_binary_row_func_t row_func =
+        iree_uk_x16b_select_row_func((iree_uk_x16b_opcode_t)i, cpu_data);
+    if (row_func) out_row_funcs->x16b[i] = row_func;
+  }
+  for (int i = 0; i < IREE_UK_X8B_COUNT; ++i) {
+    iree_uk_elementwise_binary_row_func_t row_func =
+        iree_uk_x8b_select_row_func((iree_uk_x8b_opcode_t)i, cpu_data);
+    if (row_func) out_row_funcs->x8b[i] = row_func;
   }
 }
 
 //===----------------------------------------------------------------------===//
-// Opcode dispatch entry points.
+// 2D drivers.
 //===----------------------------------------------------------------------===//
 
-// Generic 32bit binary kernels.
-IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_generic_x32b_2d(
-    iree_uk_x32b_opcode_t opcode,
+// Size in bytes of the staging buffers used for non-unit inner strides. Kept
+// a multiple of the widest vector so that row functions see full vectors.
+#define IREE_UK_ELEMENTWISE_CHUNK_BYTES 256
+
+// Copies |count| elements of |elem_size| bytes spaced |stride| elements apart
+// in |strided| into |contiguous|, or the other way when |scatter| is set.
+static void iree_uk_elementwise_strided_copy(char* contiguous, char* strided,
+                                             iree_uk_index_t stride,
+                                             iree_uk_index_t count,
+                                             iree_uk_index_t elem_size,
+                                             int scatter) {
+  for (iree_uk_index_t j = 0; j < count; ++j) {
+    char* element = strided + j * stride * elem_size;
+    char* staged = contiguous + j * elem_size;
+    if (scatter) {
+      iree_uk_memcpy(element, staged, elem_size);
+    } else {
+      iree_uk_memcpy(staged, element, elem_size);
+    }
+  }
+}
+
+IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_elementwise_binary_2d(
+    iree_uk_elementwise_binary_row_func_t row_func, iree_uk_index_t elem_size,
     // LHS.
-    const iree_uk_uint32_t* lhs, iree_uk_index_t lhs_offset,
-    iree_uk_index_t lhs_stride0, iree_uk_index_t lhs_stride1,
-    // RHS
-    const iree_uk_uint32_t* rhs, iree_uk_index_t rhs_offset,
-    iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1,
+    const char* lhs, iree_uk_index_t lhs_stride0, iree_uk_index_t lhs_stride1,
+    // RHS.
+    const char* rhs, iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1,
     // OUT.
-    iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_index_t out_offset,
-    iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
+    char* out, iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
     // Sizes.
     iree_uk_index_t size0, iree_uk_index_t size1) {
-  int result_code = 0;
-  // TODO: Manually unroll to x4 to trigger vectorization.
+  if (lhs_stride1 == 1 && rhs_stride1 == 1 && out_stride1 == 1) {
+    // Fast path: contiguous rows go straight to the row function.
+    for (iree_uk_index_t i = 0; i < size0; ++i) {
+      row_func(lhs + i * lhs_stride0 * elem_size,
+               rhs + i * rhs_stride0 * elem_size,
+               out + i * out_stride0 * elem_size, size1);
+    }
+    return 0;
+  }
+  // Strided (including broadcast) operands are staged through contiguous
+  // chunks. Operands with unit stride are still used in place.
+  char lhs_chunk[IREE_UK_ELEMENTWISE_CHUNK_BYTES] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  char rhs_chunk[IREE_UK_ELEMENTWISE_CHUNK_BYTES] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  char out_chunk[IREE_UK_ELEMENTWISE_CHUNK_BYTES] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  const iree_uk_index_t chunk_size =
+      IREE_UK_ELEMENTWISE_CHUNK_BYTES / elem_size;
   for (iree_uk_index_t i = 0; i < size0; ++i) {
-    for (iree_uk_index_t j = 0; j < size1; ++j) {
-      iree_uk_generic_x32b_op(opcode, &result_code,
-                              &lhs[i * lhs_stride0 + j * lhs_stride1],
-                              &rhs[i * rhs_stride0 + j * rhs_stride1],
-                              &out[i * out_stride0 + j * out_stride1]);
+    for (iree_uk_index_t j = 0; j < size1; j += chunk_size) {
+      iree_uk_index_t count = iree_uk_index_min(chunk_size, size1 - j);
+      const char* lhs_ptr =
+          lhs + (i * lhs_stride0 + j * lhs_stride1) * elem_size;
+      const char* rhs_ptr =
+          rhs + (i * rhs_stride0 + j * rhs_stride1) * elem_size;
+      char* out_ptr = out + (i * out_stride0 + j * out_stride1) * elem_size;
+      if (lhs_stride1 != 1) {
+        iree_uk_elementwise_strided_copy(lhs_chunk, (char*)lhs_ptr, lhs_stride1,
+                                         count, elem_size, /*scatter=*/0);
+        lhs_ptr = lhs_chunk;
+      }
+      if (rhs_stride1 != 1) {
+        iree_uk_elementwise_strided_copy(rhs_chunk, (char*)rhs_ptr, rhs_stride1,
+                                         count, elem_size, /*scatter=*/0);
+        rhs_ptr = rhs_chunk;
+      }
+      row_func(lhs_ptr, rhs_ptr, out_stride1 == 1 ? out_ptr : out_chunk,
+               count);
+      if (out_stride1 != 1) {
+        iree_uk_elementwise_strided_copy(out_chunk, out_ptr, out_stride1, count,
+                                         elem_size, /*scatter=*/1);
+      }
     }
   }
-  return result_code;
+  return 0;
 }
 
-// Generic 32bit unary kernels.
-IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_generic_x32u_2d(
-    iree_uk_x32u_opcode_t opcode,
+IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_elementwise_unary_2d(
+    iree_uk_elementwise_unary_row_func_t row_func, iree_uk_index_t elem_size,
     // IN.
-    const iree_uk_uint32_t* in, iree_uk_index_t in_offset,
-    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1,
+    const char* in, iree_uk_index_t in_stride0, iree_uk_index_t in_stride1,
     // OUT.
-    iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_index_t out_offset,
-    iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
+    char* out, iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
     // Sizes.
     iree_uk_index_t size0, iree_uk_index_t size1) {
-  int result_code = 0;
-  // TODO: Manually unroll to x4 to trigger vectorization.
+  if (in_stride1 == 1 && out_stride1 == 1) {
+    for (iree_uk_index_t i = 0; i < size0; ++i) {
+      row_func(in + i * in_stride0 * elem_size,
+               out + i * out_stride0 * elem_size, size1);
+    }
+    return 0;
+  }
+  char in_chunk[IREE_UK_ELEMENTWISE_CHUNK_BYTES] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  char out_chunk[IREE_UK_ELEMENTWISE_CHUNK_BYTES] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  const iree_uk_index_t chunk_size =
+      IREE_UK_ELEMENTWISE_CHUNK_BYTES / elem_size;
   for (iree_uk_index_t i = 0; i < size0; ++i) {
-    for (iree_uk_index_t j = 0; j < size1; ++j) {
-      iree_uk_generic_x32u_op(opcode, &result_code,
-                              &in[i * in_stride0 + j * in_stride1],
-                              &out[i * out_stride0 + j * out_stride1]);
+    for (iree_uk_index_t j = 0; j < size1; j += chunk_size) {
+      iree_uk_index_t count = iree_uk_index_min(chunk_size, size1 - j);
+      const char* in_ptr = in + (i * in_stride0 + j * in_stride1) * elem_size;
+      char* out_ptr = out + (i * out_stride0 + j * out_stride1) * elem_size;
+      if (in_stride1 != 1) {
+        iree_uk_elementwise_strided_copy(in_chunk, (char*)in_ptr, in_stride1,
+                                         count, elem_size, /*scatter=*/0);
+        in_ptr = in_chunk;
+      }
+      row_func(in_ptr, out_stride1 == 1 ? out_ptr : out_chunk, count);
+      if (out_stride1 != 1) {
+        iree_uk_elementwise_strided_copy(out_chunk, out_ptr, out_stride1, count,
+                                         elem_size, /*scatter=*/1);
+      }
     }
   }
-  return result_code;
+  return 0;
 }
 
-DISPATCH_UKERNEL_BINARY_2D(addf, IREE_UK_X32B_ADDF, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(addi, IREE_UK_X32B_ADDI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(andi, IREE_UK_X32B_ANDI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(divf, IREE_UK_X32B_DIVF, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(divsi, IREE_UK_X32B_DIVSI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(divui, IREE_UK_X32B_DIVUI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(mulf, IREE_UK_X32B_MULF, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(muli, IREE_UK_X32B_MULI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(ori, IREE_UK_X32B_ORI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(shli, IREE_UK_X32B_SHLI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(shrsi, IREE_UK_X32B_SHRSI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(shrui, IREE_UK_X32B_SHRUI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(subf, IREE_UK_X32B_SUBF, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(subi, IREE_UK_X32B_SUBI, iree_uk_uint32_t, x32b);
-DISPATCH_UKERNEL_BINARY_2D(xori, IREE_UKENREL_X32B_XORI, iree_uk_uint32_t,
-                           x32b);
+//===----------------------------------------------------------------------===//
+// Opcode dispatch entry points.
+//===----------------------------------------------------------------------===//
+
+// Defines the exported 2D kernel of |opcode| by invoking the binary 2D driver
+// with the row function of |opcode_t| in |category|.
+// Corresponds to the header macro DECLARE_UKERNEL_BINARY_2D.
+#define DISPATCH_UKERNEL_BINARY_2D(opcode, opcode_t, category, elem_size) \
+  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                  \
+      const iree_uk_elementwise_row_funcs_t* row_funcs, const void* lhs,  \
+      iree_uk_index_t lhs_offset, iree_uk_index_t lhs_stride0,            \
+      iree_uk_index_t lhs_stride1, const void* rhs,                       \
+      iree_uk_index_t rhs_offset, iree_uk_index_t rhs_stride0,            \
+      iree_uk_index_t rhs_stride1, void* out, iree_uk_index_t out_offset, \
+      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,           \
+      iree_uk_index_t size0, iree_uk_index_t size1) {                     \
+    return iree_uk_elementwise_binary_2d(                                 \
+        row_funcs->category[opcode_t], elem_size, (const char*)lhs,       \
+        lhs_stride0, lhs_stride1, (const char*)rhs, rhs_stride0,          \
+        rhs_stride1, (char*)out, out_stride0, out_stride1, size0, size1); \
+  }
+
+// Defines the exported 2D kernel of |opcode| by invoking the unary 2D driver
+// with the row function of |opcode_t| in |category|.
+// Corresponds to the header macro DECLARE_UKERNEL_UNARY_2D.
+#define DISPATCH_UKERNEL_UNARY_2D(opcode, opcode_t, category, elem_size)     \
+  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                     \
+      const iree_uk_elementwise_row_funcs_t* row_funcs, const void* in,      \
+      iree_uk_index_t in_offset, iree_uk_index_t in_stride0,                 \
+      iree_uk_index_t in_stride1, void* out, iree_uk_index_t out_offset,     \
+      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,              \
+      iree_uk_index_t size0, iree_uk_index_t size1) {                        \
+    return iree_uk_elementwise_unary_2d(                                     \
+        row_funcs->category[opcode_t], elem_size, (const char*)in,           \
+        in_stride0, in_stride1, (char*)out, out_stride0, out_stride1, size0, \
+        size1);                                                              \
+  }
+
+DISPATCH_UKERNEL_BINARY_2D(addf, IREE_UK_X32B_ADDF, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(addi, IREE_UK_X32B_ADDI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(andi, IREE_UK_X32B_ANDI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(divf, IREE_UK_X32B_DIVF, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(divsi, IREE_UK_X32B_DIVSI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(divui, IREE_UK_X32B_DIVUI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(mulf, IREE_UK_X32B_MULF, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(muli, IREE_UK_X32B_MULI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(ori, IREE_UK_X32B_ORI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(shli, IREE_UK_X32B_SHLI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(shrsi, IREE_UK_X32B_SHRSI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(shrui, IREE_UK_X32B_SHRUI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(subf, IREE_UK_X32B_SUBF, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(subi, IREE_UK_X32B_SUBI, x32b, 4);
+DISPATCH_UKERNEL_BINARY_2D(xori, IREE_UK_X32B_XORI, x32b, 4);
+
+DISPATCH_UKERNEL_UNARY_2D(absf, IREE_UK_X32U_ABSF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(ceilf, IREE_UK_X32U_CEILF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(ctlz, IREE_UK_X32U_CTLZ, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(expf, IREE_UK_X32U_EXPF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(floorf, IREE_UK_X32U_FLOORF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(logf, IREE_UK_X32U_LOGF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(negf, IREE_UK_X32U_NEGF, x32u, 4);
+DISPATCH_UKERNEL_UNARY_2D(rsqrtf, IREE_UK_X32U_RSQRTF, x32u, 4);
+
+DISPATCH_UKERNEL_BINARY_2D(addbf16, IREE_UK_X16B_ADDBF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(addf16, IREE_UK_X16B_ADDF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(divbf16, IREE_UK_X16B_DIVBF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(divf16, IREE_UK_X16B_DIVF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(mulbf16, IREE_UK_X16B_MULBF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(mulf16, IREE_UK_X16B_MULF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(subbf16, IREE_UK_X16B_SUBBF16, x16b, 2);
+DISPATCH_UKERNEL_BINARY_2D(subf16, IREE_UK_X16B_SUBF16, x16b, 2);
+
+DISPATCH_UKERNEL_UNARY_2D(absbf16, IREE_UK_X16U_ABSBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(absf16, IREE_UK_X16U_ABSF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(ceilbf16, IREE_UK_X16U_CEILBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(ceilf16, IREE_UK_X16U_CEILF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(expbf16, IREE_UK_X16U_EXPBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(expf16, IREE_UK_X16U_EXPF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(floorbf16, IREE_UK_X16U_FLOORBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(floorf16, IREE_UK_X16U_FLOORF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(logbf16, IREE_UK_X16U_LOGBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(logf16, IREE_UK_X16U_LOGF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(negbf16, IREE_UK_X16U_NEGBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(negf16, IREE_UK_X16U_NEGF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(rsqrtbf16, IREE_UK_X16U_RSQRTBF16, x16u, 2);
+DISPATCH_UKERNEL_UNARY_2D(rsqrtf16, IREE_UK_X16U_RSQRTF16, x16u, 2);
+
+DISPATCH_UKERNEL_BINARY_2D(addi, IREE_UK_X8B_ADDI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(andi, IREE_UK_X8B_ANDI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(divsi, IREE_UK_X8B_DIVSI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(divui, IREE_UK_X8B_DIVUI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(muli, IREE_UK_X8B_MULI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(ori, IREE_UK_X8B_ORI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(shli, IREE_UK_X8B_SHLI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(shrsi, IREE_UK_X8B_SHRSI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(shrui, IREE_UK_X8B_SHRUI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(subi, IREE_UK_X8B_SUBI, x8b, 1);
+DISPATCH_UKERNEL_BINARY_2D(xori, IREE_UK_X8B_XORI, x8b, 1);
 
-DISPATCH_UKERNEL_UNARY_2D(absf, IREE_UK_X32U_ABSF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(ceilf, IREE_UK_X32U_CEILF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(ctlz, IREE_UK_X32U_CTLZ, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(expf, IREE_UK_X32U_EXPF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(floorf, IREE_UK_X32U_FLOORF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(logf, IREE_UK_X32U_LOGF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(negf, IREE_UK_X32U_NEGF, iree_uk_uint32_t, x32u);
-DISPATCH_UKERNEL_UNARY_2D(rsqrtf, IREE_UK_X32U_RSQRTF, iree_uk_uint32_t, x32u);
+DISPATCH_UKERNEL_UNARY_2D(ctlz, IREE_UK_X8U_CTLZ, x8u, 1);
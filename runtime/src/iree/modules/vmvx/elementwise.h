@@ -4,8 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
-#define IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
+#ifndef IREE_MODULES_VMVX_ELEMENTWISE_H_
+#define IREE_MODULES_VMVX_ELEMENTWISE_H_
 
 #include "iree/builtins/ukernel/api.h"
 
@@ -13,88 +13,147 @@
 extern "C" {
 #endif  // __cplusplus
 
+//===----------------------------------------------------------------------===//
+// Row function tables.
+//===----------------------------------------------------------------------===//
+
+// The row function of every elementwise opcode, indexed by opcode. Entries are
+// the SIMD ukernel row functions supported by the CPU where there are any, and
+// portable fallbacks otherwise. Filled once per module so that the per-call
+// cost of the 2d kernels below is just an indirect call per row.
+typedef struct iree_uk_elementwise_row_funcs_t {
+  iree_uk_elementwise_binary_row_func_t x32b[IREE_UK_X32B_COUNT];
+  iree_uk_elementwise_unary_row_func_t x32u[IREE_UK_X32U_COUNT];
+  iree_uk_elementwise_binary_row_func_t x16b[IREE_UK_X16B_COUNT];
+  iree_uk_elementwise_unary_row_func_t x16u[IREE_UK_X16U_COUNT];
+  iree_uk_elementwise_binary_row_func_t x8b[IREE_UK_X8B_COUNT];
+  iree_uk_elementwise_unary_row_func_t x8u[IREE_UK_X8U_COUNT];
+} iree_uk_elementwise_row_funcs_t;
+
+// Fills |out_row_funcs| with the best row functions for the CPU described by
+// |cpu_data|.
+void iree_uk_elementwise_row_funcs_initialize(
+    const iree_uk_uint64_t* cpu_data,
+    iree_uk_elementwise_row_funcs_t* out_row_funcs);
+
 //===----------------------------------------------------------------------===//
 // Public API - Binary kernels.
 //===----------------------------------------------------------------------===//
 
-// Binary ukernel func 2d, x32.
-// It takes lhs, rhs, out buffers and size, returning 0 on success and !0 on
-// error.
-typedef int (*iree_uk_x32b_2d_func_t)(
-    const iree_uk_uint32_t* lhs, iree_uk_index_t lhs_offset,
-    iree_uk_index_t lhs_stride0, iree_uk_index_t lhs_stride1,
-    const iree_uk_uint32_t* rhs, iree_uk_index_t rhs_offset,
-    iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1,
-    iree_uk_uint32_t* out, iree_uk_index_t out_offset,
-    iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
-    iree_uk_index_t size0, iree_uk_index_t size1);
+// Binary ukernel func 2d, of any element width.
+// It takes the row function table, lhs, rhs, out buffers and size, returning 0
+// on success and !0 on error. `out` may alias `lhs` or `rhs` exactly.
+typedef int (*iree_uk_elementwise_binary_2d_func_t)(
+    const iree_uk_elementwise_row_funcs_t* row_funcs, const void* lhs,
+    iree_uk_index_t lhs_offset, iree_uk_index_t lhs_stride0,
+    iree_uk_index_t lhs_stride1, const void* rhs, iree_uk_index_t rhs_offset,
+    iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1, void* out,
+    iree_uk_index_t out_offset, iree_uk_index_t out_stride0,
+    iree_uk_index_t out_stride1, iree_uk_index_t size0, iree_uk_index_t size1);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
-// of function type iree_uk_{category}_2d_func_t.
-#define DECLARE_UKERNEL_BINARY_2D(opcode, dtype, category)      \
-  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(        \
-      const dtype* lhs, iree_uk_index_t lhs_offset,             \
-      iree_uk_index_t lhs_stride0, iree_uk_index_t lhs_stride1, \
-      const dtype* rhs, iree_uk_index_t rhs_offset,             \
-      iree_uk_index_t rhs_stride0, iree_uk_index_t rhs_stride1, \
-      dtype* IREE_UK_RESTRICT out, iree_uk_index_t out_offset,  \
-      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1, \
+// of function type iree_uk_elementwise_binary_2d_func_t.
+#define DECLARE_UKERNEL_BINARY_2D(opcode, category)                       \
+  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                  \
+      const iree_uk_elementwise_row_funcs_t* row_funcs, const void* lhs,  \
+      iree_uk_index_t lhs_offset, iree_uk_index_t lhs_stride0,            \
+      iree_uk_index_t lhs_stride1, const void* rhs,                       \
+      iree_uk_index_t rhs_offset, iree_uk_index_t rhs_stride0,            \
+      iree_uk_index_t rhs_stride1, void* out, iree_uk_index_t out_offset, \
+      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,           \
       iree_uk_index_t size0, iree_uk_index_t size1)
 
-DECLARE_UKERNEL_BINARY_2D(addf, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(addi, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(andi, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(divf, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(divsi, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(divui, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(mulf, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(muli, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(ori, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(shli, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(shrsi, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(shrui, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(subf, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(subi, iree_uk_uint32_t, x32b);
-DECLARE_UKERNEL_BINARY_2D(xori, iree_uk_uint32_t, x32b);
+DECLARE_UKERNEL_BINARY_2D(addf, x32b);
+DECLARE_UKERNEL_BINARY_2D(addi, x32b);
+DECLARE_UKERNEL_BINARY_2D(andi, x32b);
+DECLARE_UKERNEL_BINARY_2D(divf, x32b);
+DECLARE_UKERNEL_BINARY_2D(divsi, x32b);
+DECLARE_UKERNEL_BINARY_2D(divui, x32b);
+DECLARE_UKERNEL_BINARY_2D(mulf, x32b);
+DECLARE_UKERNEL_BINARY_2D(muli, x32b);
+DECLARE_UKERNEL_BINARY_2D(ori, x32b);
+DECLARE_UKERNEL_BINARY_2D(shli, x32b);
+DECLARE_UKERNEL_BINARY_2D(shrsi, x32b);
+DECLARE_UKERNEL_BINARY_2D(shrui, x32b);
+DECLARE_UKERNEL_BINARY_2D(subf, x32b);
+DECLARE_UKERNEL_BINARY_2D(subi, x32b);
+DECLARE_UKERNEL_BINARY_2D(xori, x32b);
+
+DECLARE_UKERNEL_BINARY_2D(addbf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(addf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(divbf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(divf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(mulbf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(mulf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(subbf16, x16b);
+DECLARE_UKERNEL_BINARY_2D(subf16, x16b);
+
+DECLARE_UKERNEL_BINARY_2D(addi, x8b);
+DECLARE_UKERNEL_BINARY_2D(andi, x8b);
+DECLARE_UKERNEL_BINARY_2D(divsi, x8b);
+DECLARE_UKERNEL_BINARY_2D(divui, x8b);
+DECLARE_UKERNEL_BINARY_2D(muli, x8b);
+DECLARE_UKERNEL_BINARY_2D(ori, x8b);
+DECLARE_UKERNEL_BINARY_2D(shli, x8b);
+DECLARE_UKERNEL_BINARY_2D(shrsi, x8b);
+DECLARE_UKERNEL_BINARY_2D(shrui, x8b);
+DECLARE_UKERNEL_BINARY_2D(subi, x8b);
+DECLARE_UKERNEL_BINARY_2D(xori, x8b);
 
 //===----------------------------------------------------------------------===//
 // Public API - Unary kernels.
 //===----------------------------------------------------------------------===//
 
-// Unary ukernel func 2d, x32.
-// It takes in, out buffers and size, returning 0 on success and !0 on
-// error.
-typedef int (*iree_uk_x32u_2d_func_t)(
-    const iree_uk_uint32_t* in, iree_uk_index_t in_offset,
-    iree_uk_index_t in_stride0, iree_uk_index_t in_stride1,
-    iree_uk_uint32_t* out, iree_uk_index_t out_offset,
+// Unary ukernel func 2d, of any element width.
+// It takes the row function table, in, out buffers and size, returning 0 on
+// success and !0 on error. `out` may alias `in` exactly.
+typedef int (*iree_uk_elementwise_unary_2d_func_t)(
+    const iree_uk_elementwise_row_funcs_t* row_funcs, const void* in,
+    iree_uk_index_t in_offset, iree_uk_index_t in_stride0,
+    iree_uk_index_t in_stride1, void* out, iree_uk_index_t out_offset,
     iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,
     iree_uk_index_t size0, iree_uk_index_t size1);
 
-// Declares a binary 2d microkernel with the following signature:
+// Declares a unary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
-// It takes lhs, rhs, out buffers and size, returning 0 on success and !0 on
-// error.
-#define DECLARE_UKERNEL_UNARY_2D(opcode, dtype, category)                     \
-  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                      \
-      const dtype* in, iree_uk_index_t in_offset, iree_uk_index_t in_stride0, \
-      iree_uk_index_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
-      iree_uk_index_t out_offset, iree_uk_index_t out_stride0,                \
-      iree_uk_index_t out_stride1, iree_uk_index_t size0,                     \
-      iree_uk_index_t size1)
-
-DECLARE_UKERNEL_UNARY_2D(absf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(ceilf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(ctlz, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(expf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(floorf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(logf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(negf, iree_uk_uint32_t, x32u);
-DECLARE_UKERNEL_UNARY_2D(rsqrtf, iree_uk_uint32_t, x32u);
+// of function type iree_uk_elementwise_unary_2d_func_t.
+#define DECLARE_UKERNEL_UNARY_2D(opcode, category)                       \
+  IREE_UK_EXPORT int iree_uk_##category##_##opcode##_2d(                 \
+      const iree_uk_elementwise_row_funcs_t* row_funcs, const void* in,  \
+      iree_uk_index_t in_offset, iree_uk_index_t in_stride0,             \
+      iree_uk_index_t in_stride1, void* out, iree_uk_index_t out_offset, \
+      iree_uk_index_t out_stride0, iree_uk_index_t out_stride1,          \
+      iree_uk_index_t size0, iree_uk_index_t size1)
+
+DECLARE_UKERNEL_UNARY_2D(absf, x32u);
+DECLARE_UKERNEL_UNARY_2D(ceilf, x32u);
+DECLARE_UKERNEL_UNARY_2D(ctlz, x32u);
+DECLARE_UKERNEL_UNARY_2D(expf, x32u);
+DECLARE_UKERNEL_UNARY_2D(floorf, x32u);
+DECLARE_UKERNEL_UNARY_2D(logf, x32u);
+DECLARE_UKERNEL_UNARY_2D(negf, x32u);
+DECLARE_UKERNEL_UNARY_2D(rsqrtf, x32u);
+
+DECLARE_UKERNEL_UNARY_2D(absbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(absf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(ceilbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(ceilf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(expbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(expf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(floorbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(floorf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(logbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(logf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(negbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(negf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(rsqrtbf16, x16u);
+DECLARE_UKERNEL_UNARY_2D(rsqrtf16, x16u);
+
+DECLARE_UKERNEL_UNARY_2D(ctlz, x8u);
 
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_BUILTINS_UKERNEL_ELEMENTWISE_H_
+#endif  // IREE_MODULES_VMVX_ELEMENTWISE_H_
@@ -61,6 +61,11 @@ typedef struct iree_vmvx_module_state_t {
   // opaque unique identifier.
   uint32_t processor_id;
 
+  // Elementwise row functions selected for the host CPU. Selected per state
+  // instead of per module as states are only allocated once the HAL has
+  // initialized the CPU data, which may not be the case at module creation.
+  iree_uk_elementwise_row_funcs_t elementwise_row_funcs;
+
   // If we have any external libraries we want to interact with that are
   // stateful we could store their state here. Note that VMVX invocations may
   // happen from any thread and concurrently and if the state is not thread-safe
@@ -81,6 +86,9 @@ iree_vmvx_module_alloc_state(void* self, iree_allocator_t host_allocator,
       iree_allocator_malloc(host_allocator, sizeof(*state), (void**)&state));
   memset(state, 0, sizeof(*state));
   state->host_allocator = host_allocator;
+  iree_uk_elementwise_row_funcs_initialize(
+      (const iree_uk_uint64_t*)iree_cpu_data_fields(),
+      &state->elementwise_row_funcs);
   *out_module_state = (iree_vm_module_state_t*)state;
   return iree_ok_status();
 }
@@ -219,7 +227,7 @@ IREE_VMVX_ABI_DEFINE_SHIM(binary2d, v);
 // to a low level ukernel target function.
 //===----------------------------------------------------------------------===//
 
-IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32b_2d, rIIIrIIIrIIIII, {
+IREE_VMVX_ABI_FIXED_STRUCT(ukernel_binary_2d, rIIIrIIIrIIIII, {
   iree_vm_ref_t lhs_ref;
   int64_t lhs_offset;
   int64_t lhs_stride0;
@@ -236,63 +244,68 @@ IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32b_2d, rIIIrIIIrIIIII, {
   int64_t size1;
 });
 
-static iree_status_t iree_vm_shim_ukernel_x32b_2d_v(
-    iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
-    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
-    iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
-    void* IREE_RESTRICT module_state) {
-  // TODO: Figure out how to identify this with the actual target fn.
-  IREE_TRACE_ZONE_BEGIN(z0);
-  const iree_vm_abi_ukernel_x32b_2d_t* args =
-      iree_vm_abi_ukernel_x32b_2d_checked_deref(args_storage);
-  if (IREE_UNLIKELY(!((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args))) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "argument/result signature mismatch");
+// Defines the shim iree_vm_shim_ukernel_{category}_2d_v marshaling to binary
+// elementwise ukernels of |category| with elements of |elem_size| bytes.
+#define IREE_VMVX_DEFINE_UKERNEL_BINARY_2D_SHIM(category, elem_size)           \
+  static iree_status_t iree_vm_shim_ukernel_##category##_2d_v(                 \
+      iree_vm_stack_t* IREE_RESTRICT stack,                                    \
+      iree_vm_native_function_flags_t flags, iree_byte_span_t args_storage,    \
+      iree_byte_span_t rets_storage,                                           \
+      iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module, \
+      void* IREE_RESTRICT module_state) {                                      \
+    /* TODO: Figure out how to identify this with the actual target fn. */     \
+    IREE_TRACE_ZONE_BEGIN(z0);                                                 \
+    const iree_vm_abi_ukernel_binary_2d_t* args =                              \
+        iree_vm_abi_ukernel_binary_2d_checked_deref(args_storage);             \
+    if (IREE_UNLIKELY(                                                         \
+            !((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args))) {       \
+      IREE_TRACE_ZONE_END(z0);                                                 \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                    \
+                              "argument/result signature mismatch");           \
+    }                                                                          \
+    MAP_BUFFER_2D_UNTYPED_RO(lhs, elem_size,                                   \
+                             /*buffer_ref=*/args->lhs_ref,                     \
+                             /*offset=*/args->lhs_offset,                      \
+                             /*stride0=*/args->lhs_stride0,                    \
+                             /*stride1=*/args->lhs_stride1,                    \
+                             /*size0=*/args->size0,                            \
+                             /*size1=*/args->size1);                           \
+    MAP_BUFFER_2D_UNTYPED_RO(rhs, elem_size,                                   \
+                             /*buffer_ref=*/args->rhs_ref,                     \
+                             /*offset=*/args->rhs_offset,                      \
+                             /*stride0=*/args->rhs_stride0,                    \
+                             /*stride1=*/args->rhs_stride1,                    \
+                             /*size0=*/args->size0,                            \
+                             /*size1=*/args->size1);                           \
+    MAP_BUFFER_2D_UNTYPED_RW(out, elem_size,                                   \
+                             /*buffer_ref=*/args->out_ref,                     \
+                             /*offset=*/args->out_offset,                      \
+                             /*stride0=*/args->out_stride0,                    \
+                             /*stride1=*/args->out_stride1,                    \
+                             /*size0=*/args->size0,                            \
+                             /*size1=*/args->size1);                           \
+    iree_uk_elementwise_binary_2d_func_t ukernel_func =                        \
+        (iree_uk_elementwise_binary_2d_func_t)target_fn;                       \
+    iree_vmvx_module_state_t* state =                                          \
+        (iree_vmvx_module_state_t*)module_state;                               \
+    int ret = ukernel_func(&state->elementwise_row_funcs,                      \
+                           /*LHS*/ lhs, lhs_offset, lhs_stride0, lhs_stride1,  \
+                           /*RHS*/ rhs, rhs_offset, rhs_stride0, rhs_stride1,  \
+                           /*OUT*/ out, out_offset, out_stride0, out_stride1,  \
+                           /*SIZE*/ out_size0, out_size1);                     \
+    IREE_TRACE_ZONE_END(z0);                                                   \
+    return ret == 0 ? iree_ok_status()                                         \
+                    : iree_make_status(IREE_STATUS_INVALID_ARGUMENT,           \
+                                       "illegal " #category                    \
+                                       " ukernel return code (%d)",            \
+                                       ret);                                   \
   }
 
-  MAP_BUFFER_2D_RO(lhs, iree_uk_uint32_t,
-                   /*buffer_ref=*/args->lhs_ref,
-                   /*offset=*/args->lhs_offset,
-                   /*stride0=*/args->lhs_stride0,
-                   /*stride1=*/args->lhs_stride1,
-                   /*size0=*/args->size0,
-                   /*size1=*/args->size1);
-  MAP_BUFFER_2D_RO(rhs, iree_uk_uint32_t,
-                   /*buffer_ref=*/args->rhs_ref,
-                   /*offset=*/args->rhs_offset,
-                   /*stride0=*/args->rhs_stride0,
-                   /*stride1=*/args->rhs_stride1,
-                   /*size0=*/args->size0,
-                   /*size1=*/args->size1);
-  MAP_BUFFER_2D_RW(out, iree_uk_uint32_t,
-                   /*buffer_ref=*/args->out_ref,
-                   /*offset=*/args->out_offset,
-                   /*stride0=*/args->out_stride0,
-                   /*stride1=*/args->out_stride1,
-                   /*size0=*/args->size0,
-                   /*size1=*/args->size1);
-
-  iree_uk_x32b_2d_func_t ukernel_func = (iree_uk_x32b_2d_func_t)target_fn;
-
-  int ret = ukernel_func(
-      // LHS
-      lhs, lhs_offset, lhs_stride0, lhs_stride1,
-      // RHS
-      rhs, rhs_offset, rhs_stride0, rhs_stride1,
-      // OUT
-      out, out_offset, out_stride0, out_stride1,
-      // SIZE
-      out_size0, out_size1);
+IREE_VMVX_DEFINE_UKERNEL_BINARY_2D_SHIM(x32b, 4);
+IREE_VMVX_DEFINE_UKERNEL_BINARY_2D_SHIM(x16b, 2);
+IREE_VMVX_DEFINE_UKERNEL_BINARY_2D_SHIM(x8b, 1);
 
-  IREE_TRACE_ZONE_END(z0);
-  return ret == 0
-             ? iree_ok_status()
-             : iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "illegal x32b ukernel return code (%d)", ret);
-}
-
-IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32u_2d, rIIIrIIIII, {
+IREE_VMVX_ABI_FIXED_STRUCT(ukernel_unary_2d, rIIIrIIIII, {
   iree_vm_ref_t in_ref;
   int64_t in_offset;
   int64_t in_stride0;
@@ -305,52 +318,58 @@ IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32u_2d, rIIIrIIIII, {
   int64_t size1;
 });
 
-static iree_status_t iree_vm_shim_ukernel_x32u_2d_v(
-    iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
-    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
-    iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
-    void* IREE_RESTRICT module_state) {
-  // TODO: Figure out how to identify this with the actual target fn.
-  IREE_TRACE_ZONE_BEGIN(z0);
-  const iree_vm_abi_ukernel_x32u_2d_t* args =
-      iree_vm_abi_ukernel_x32u_2d_checked_deref(args_storage);
-  if (IREE_UNLIKELY(!((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args))) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "argument/result signature mismatch");
+// Defines the shim iree_vm_shim_ukernel_{category}_2d_v marshaling to unary
+// elementwise ukernels of |category| with elements of |elem_size| bytes.
+#define IREE_VMVX_DEFINE_UKERNEL_UNARY_2D_SHIM(category, elem_size)            \
+  static iree_status_t iree_vm_shim_ukernel_##category##_2d_v(                 \
+      iree_vm_stack_t* IREE_RESTRICT stack,                                    \
+      iree_vm_native_function_flags_t flags, iree_byte_span_t args_storage,    \
+      iree_byte_span_t rets_storage,                                           \
+      iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module, \
+      void* IREE_RESTRICT module_state) {                                      \
+    /* TODO: Figure out how to identify this with the actual target fn. */     \
+    IREE_TRACE_ZONE_BEGIN(z0);                                                 \
+    const iree_vm_abi_ukernel_unary_2d_t* args =                               \
+        iree_vm_abi_ukernel_unary_2d_checked_deref(args_storage);              \
+    if (IREE_UNLIKELY(                                                         \
+            !((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args))) {       \
+      IREE_TRACE_ZONE_END(z0);                                                 \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                    \
+                              "argument/result signature mismatch");           \
+    }                                                                          \
+    MAP_BUFFER_2D_UNTYPED_RO(in, elem_size,                                    \
+                             /*buffer_ref=*/args->in_ref,                      \
+                             /*offset=*/args->in_offset,                       \
+                             /*stride0=*/args->in_stride0,                     \
+                             /*stride1=*/args->in_stride1,                     \
+                             /*size0=*/args->size0,                            \
+                             /*size1=*/args->size1);                           \
+    MAP_BUFFER_2D_UNTYPED_RW(out, elem_size,                                   \
+                             /*buffer_ref=*/args->out_ref,                     \
+                             /*offset=*/args->out_offset,                      \
+                             /*stride0=*/args->out_stride0,                    \
+                             /*stride1=*/args->out_stride1,                    \
+                             /*size0=*/args->size0,                            \
+                             /*size1=*/args->size1);                           \
+    iree_uk_elementwise_unary_2d_func_t ukernel_func =                         \
+        (iree_uk_elementwise_unary_2d_func_t)target_fn;                        \
+    iree_vmvx_module_state_t* state =                                          \
+        (iree_vmvx_module_state_t*)module_state;                               \
+    int ret = ukernel_func(&state->elementwise_row_funcs,                      \
+                           /*IN*/ in, in_offset, in_stride0, in_stride1,       \
+                           /*OUT*/ out, out_offset, out_stride0, out_stride1,  \
+                           /*SIZE*/ out_size0, out_size1);                     \
+    IREE_TRACE_ZONE_END(z0);                                                   \
+    return ret == 0 ? iree_ok_status()                                         \
+                    : iree_make_status(IREE_STATUS_INVALID_ARGUMENT,           \
+                                       "illegal " #category                    \
+                                       " ukernel return code (%d)",            \
+                                       ret);                                   \
   }
 
-  MAP_BUFFER_2D_RO(in, iree_uk_uint32_t,
-                   /*buffer_ref=*/args->in_ref,
-                   /*offset=*/args->in_offset,
-                   /*stride0=*/args->in_stride0,
-                   /*stride1=*/args->in_stride1,
-                   /*size0=*/args->size0,
-                   /*size1=*/args->size1);
-  MAP_BUFFER_2D_RW(out, iree_uk_uint32_t,
-                   /*buffer_ref=*/args->out_ref,
-                   /*offset=*/args->out_offset,
-                   /*stride0=*/args->out_stride0,
-                   /*stride1=*/args->out_stride1,
-                   /*size0=*/args->size0,
-                   /*size1=*/args->size1);
-
-  iree_uk_x32u_2d_func_t ukernel_func = (iree_uk_x32u_2d_func_t)target_fn;
-
-  int ret = ukernel_func(
-      // IN
-      in, in_offset, in_stride0, in_stride1,
-      // OUT
-      out, out_offset, out_stride0, out_stride1,
-      // SIZE
-      out_size0, out_size1);
-
-  IREE_TRACE_ZONE_END(z0);
-  return ret == 0
-             ? iree_ok_status()
-             : iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "illegal x32u ukernel return code (%d)", ret);
-}
+IREE_VMVX_DEFINE_UKERNEL_UNARY_2D_SHIM(x32u, 4);
+IREE_VMVX_DEFINE_UKERNEL_UNARY_2D_SHIM(x16u, 2);
+IREE_VMVX_DEFINE_UKERNEL_UNARY_2D_SHIM(x8u, 1);
 
 //===----------------------------------------------------------------------===//
 // Exported copy function definitions
@@ -7,6 +7,7 @@
 #ifndef IREE_TASK_AFFINITY_SET_H_
 #define IREE_TASK_AFFINITY_SET_H_
 
+#include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/tuning.h"
@@ -25,23 +26,115 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
+// A set of workers within a block of up to IREE_TASK_AFFINITY_SET_BIT_COUNT
+// workers. Executors with more workers than fit in a single set partition them
+// into consecutive blocks (worker i is bit i % 64 of block i / 64) and keep one
+// set per block for their bookkeeping.
 typedef uint64_t iree_task_affinity_set_t;
 
+// Number of workers in each block of workers.
+#define IREE_TASK_AFFINITY_SET_BIT_COUNT 64
+
+// Maximum number of worker blocks in an executor.
+#define IREE_TASK_AFFINITY_SET_BLOCK_COUNT \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT + 63) / 64)
+
+// Index of a block of workers within an executor.
+typedef uint16_t iree_task_affinity_block_t;
+
+// Indicates that a task affinity set applies to every block: a task with bit N
+// set may run on worker N of any block. This allows for partitioning workloads
+// across blocks with uniform layouts (such as the same big.LITTLE arrangement
+// repeated in each NUMA node).
+#define IREE_TASK_AFFINITY_BLOCK_ANY ((iree_task_affinity_block_t)UINT16_MAX)
+
+static_assert(IREE_TASK_AFFINITY_SET_BLOCK_COUNT < IREE_TASK_AFFINITY_BLOCK_ANY,
+              "worker block indices must be representable");
+
+// Specifies which workers a task may run on as a set of workers within a
+// single block or within every block when |block| is
+// IREE_TASK_AFFINITY_BLOCK_ANY.
+typedef struct iree_task_affinity_t {
+  // Block the |mask| is relative to or IREE_TASK_AFFINITY_BLOCK_ANY.
+  iree_task_affinity_block_t block;
+  // Set of workers within the block(s).
+  iree_task_affinity_set_t mask;
+} iree_task_affinity_t;
+
+// Returns the index of the block containing the worker with |worker_index|.
+static inline iree_host_size_t iree_task_affinity_block_for_worker(
+    iree_host_size_t worker_index) {
+  return worker_index / IREE_TASK_AFFINITY_SET_BIT_COUNT;
+}
+
+// Returns the number of blocks required to hold |worker_count| workers.
+static inline iree_host_size_t iree_task_affinity_block_count(
+    iree_host_size_t worker_count) {
+  return (worker_count + IREE_TASK_AFFINITY_SET_BIT_COUNT - 1) /
+         IREE_TASK_AFFINITY_SET_BIT_COUNT;
+}
+
+// Returns the bit representing the worker with |worker_index| in the set of
+// the block containing it.
+static inline iree_task_affinity_set_t iree_task_affinity_bit_for_worker(
+    iree_host_size_t worker_index) {
+  return 1ull << (worker_index % IREE_TASK_AFFINITY_SET_BIT_COUNT);
+}
+
 // Allows for only a specific worker to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
-    uint8_t worker_index) {
-  return 1ull << worker_index;
+static inline iree_task_affinity_t iree_task_affinity_for_worker(
+    iree_host_size_t worker_index) {
+  iree_task_affinity_t affinity;
+  affinity.block = (iree_task_affinity_block_t)
+      iree_task_affinity_block_for_worker(worker_index);
+  affinity.mask = iree_task_affinity_bit_for_worker(worker_index);
+  return affinity;
 }
 
-// Allows for a range of workers to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_worker_range(
-    uint8_t worker_start, uint8_t worker_end) {
-  return ((1ull << (worker_start - 1)) - 1) ^ ((1ull << worker_end) - 1);
+// Allows for a range of workers [worker_start, worker_end) to be selected.
+// Affinities cannot span blocks and workers in the range beyond the end of the
+// block containing |worker_start| are excluded.
+static inline iree_task_affinity_t iree_task_affinity_for_worker_range(
+    iree_host_size_t worker_start, iree_host_size_t worker_end) {
+  iree_task_affinity_t affinity;
+  affinity.block = (iree_task_affinity_block_t)
+      iree_task_affinity_block_for_worker(worker_start);
+  affinity.mask = 0;
+  const iree_host_size_t block_base =
+      affinity.block * IREE_TASK_AFFINITY_SET_BIT_COUNT;
+  const iree_host_size_t bit_start = worker_start - block_base;
+  const iree_host_size_t bit_end =
+      worker_end > block_base
+          ? iree_min(worker_end - block_base,
+                     (iree_host_size_t)IREE_TASK_AFFINITY_SET_BIT_COUNT)
+          : 0;
+  if (bit_end > bit_start) {
+    affinity.mask = (UINT64_MAX >> (IREE_TASK_AFFINITY_SET_BIT_COUNT -
+                                    (bit_end - bit_start)))
+                    << bit_start;
+  }
+  return affinity;
 }
 
 // Allows for any worker to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
-  return UINT64_MAX;
+static inline iree_task_affinity_t iree_task_affinity_for_any_worker(void) {
+  iree_task_affinity_t affinity;
+  affinity.block = IREE_TASK_AFFINITY_BLOCK_ANY;
+  affinity.mask = UINT64_MAX;
+  return affinity;
+}
+
+// Returns the set of workers in block |block_index| of an executor with
+// |worker_count| workers total.
+static inline iree_task_affinity_set_t iree_task_affinity_for_block(
+    iree_host_size_t worker_count, iree_host_size_t block_index) {
+  iree_host_size_t block_base = block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT;
+  if (block_base >= worker_count) return 0;
+  iree_host_size_t block_worker_count = worker_count - block_base;
+  if (block_worker_count >= IREE_TASK_AFFINITY_SET_BIT_COUNT) {
+    return UINT64_MAX;
+  }
+  return (1ull << block_worker_count) - 1;
 }
 
 #define iree_task_affinity_set_ones(count) \
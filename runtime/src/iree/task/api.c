@@ -214,6 +214,11 @@ static iree_status_t iree_task_flags_dump_task_topologies(
       const iree_task_topology_group_t* group = &topology.groups[j];
       fprintf(stdout, "# group[%d]: '%s'\n", group->group_index, group->name);
       fprintf(stdout, "#      processor: %u\n", group->processor_index);
+      if (group->node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+        fprintf(stdout, "#      NUMA node: (unknown)\n");
+      } else {
+        fprintf(stdout, "#      NUMA node: %u\n", group->node_id);
+      }
       fprintf(stdout, "#       affinity: ");
       if (group->ideal_thread_affinity.specified) {
         fprintf(stdout, "group=%u, id=%u, smt=%u",
@@ -237,7 +242,10 @@ static iree_status_t iree_task_flags_dump_task_topologies(
              ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
           if ((group->constructive_sharing_mask >> ic) & 1) {
             if (jc > 0) fprintf(stdout, ", ");
-            fprintf(stdout, "%" PRIhsz, ic);
+            fprintf(stdout, "%" PRIhsz,
+                    (group->group_index / IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) *
+                            IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT +
+                        ic);
             ++jc;
           }
         }
@@ -24,6 +24,30 @@
 
 static void iree_task_executor_destroy(iree_task_executor_t* executor);
 
+// Calculates one mask per worker block indicating which workers are on the same
+// NUMA node as the worker at |worker_index|. Workers on an unknown node are
+// treated as being on every node such that topologies without node information
+// have all workers in the masks.
+static void iree_task_executor_calculate_node_sharing_masks(
+    const iree_task_topology_t* topology, iree_host_size_t worker_count,
+    iree_host_size_t worker_index,
+    iree_task_affinity_set_t* out_node_sharing_masks) {
+  memset(out_node_sharing_masks, 0,
+         IREE_TASK_AFFINITY_SET_BLOCK_COUNT * sizeof(iree_task_affinity_set_t));
+  const iree_task_topology_node_id_t node_id =
+      iree_task_topology_get_group(topology, worker_index)->node_id;
+  for (iree_host_size_t i = 0; i < worker_count; ++i) {
+    const iree_task_topology_node_id_t other_node_id =
+        iree_task_topology_get_group(topology, i)->node_id;
+    if (node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY ||
+        other_node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY ||
+        node_id == other_node_id) {
+      out_node_sharing_masks[iree_task_affinity_block_for_worker(i)] |=
+          iree_task_affinity_bit_for_worker(i);
+    }
+  }
+}
+
 void iree_task_executor_options_initialize(
     iree_task_executor_options_t* out_options) {
   memset(out_options, 0, sizeof(*out_options));
@@ -53,12 +77,18 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
+  // The executor is followed in memory by worker[] while each worker allocates
+  // its own local memory when it starts.
   // The whole point is that we don't want destructive sharing between workers
   // so ensure we are aligned to at least the destructive interference size.
-  options.worker_local_memory_size =
-      iree_host_align(options.worker_local_memory_size,
-                      iree_hardware_destructive_interference_size);
+  // When the workers span multiple NUMA nodes we further align each worker's
+  // local memory to pages so that it can be placed on the worker's node.
+  const bool is_numa_aware = iree_task_topology_node_count(topology) > 1;
+  const iree_host_size_t worker_local_memory_alignment =
+      is_numa_aware ? IREE_TASK_EXECUTOR_NUMA_LOCAL_MEMORY_ALIGNMENT
+                    : iree_hardware_destructive_interference_size;
+  options.worker_local_memory_size = iree_host_align(
+      options.worker_local_memory_size, worker_local_memory_alignment);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0,
                                    (int64_t)options.worker_local_memory_size);
   iree_host_size_t executor_base_size =
@@ -67,9 +97,7 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_host_size_t worker_list_size =
       iree_host_align(worker_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
-  iree_host_size_t executor_size =
-      executor_base_size + worker_list_size +
-      worker_count * options.worker_local_memory_size;
+  iree_host_size_t executor_size = executor_base_size + worker_list_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -148,30 +176,34 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   if (iree_status_is_ok(status)) {
     executor->worker_base_index = options.worker_base_index;
     executor->worker_count = worker_count;
+    executor->worker_block_count = iree_task_affinity_block_count(worker_count);
     executor->workers =
         (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
-    uint8_t* worker_local_memory =
-        (uint8_t*)executor->workers + worker_list_size;
-
-    iree_task_affinity_set_t worker_mask =
-        iree_task_affinity_set_ones(worker_count);
+    executor->worker_local_memory_size = options.worker_local_memory_size;
+    executor->worker_local_memory_alignment = worker_local_memory_alignment;
 
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
       iree_task_worker_t* worker = &executor->workers[i];
+      iree_task_affinity_set_t
+          node_sharing_masks[IREE_TASK_AFFINITY_SET_BLOCK_COUNT];
+      iree_task_executor_calculate_node_sharing_masks(
+          topology, worker_count, i, node_sharing_masks);
       status = iree_task_worker_initialize(
           executor, i, iree_task_topology_get_group(topology, i),
-          options.worker_stack_size,
-          iree_make_byte_span(worker_local_memory,
-                              options.worker_local_memory_size),
-          &seed_prng, worker);
-      worker_local_memory += options.worker_local_memory_size;
+          node_sharing_masks, options.worker_stack_size, &seed_prng, worker);
       if (!iree_status_is_ok(status)) break;
     }
 
-    iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
-                                        worker_mask, iree_memory_order_release);
-    iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
-                                        worker_mask, iree_memory_order_release);
+    for (iree_host_size_t i = 0; i < executor->worker_block_count; ++i) {
+      iree_task_affinity_set_t worker_mask =
+          iree_task_affinity_for_block(worker_count, i);
+      iree_atomic_task_affinity_set_store(&executor->worker_idle_mask[i],
+                                          worker_mask,
+                                          iree_memory_order_release);
+      iree_atomic_task_affinity_set_store(&executor->worker_live_mask[i],
+                                          worker_mask,
+                                          iree_memory_order_release);
+    }
   }
 
   if (!iree_status_is_ok(status)) {
@@ -284,7 +316,7 @@ static void iree_task_executor_relay_to_worker(
     iree_task_executor_t* executor, iree_task_post_batch_t* post_batch,
     iree_task_t* task) {
   iree_host_size_t worker_index =
-      iree_task_post_batch_select_worker(post_batch, task->affinity_set);
+      iree_task_post_batch_select_worker(post_batch, iree_task_affinity(task));
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
@@ -492,17 +524,18 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 }
 
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
-    iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
-    iree_task_queue_t* local_task_queue) {
+    iree_task_executor_t* executor, iree_host_size_t block_index,
+    iree_task_affinity_set_t victim_mask, uint32_t max_theft_attempts,
+    int rotation_offset, iree_task_queue_t* local_task_queue) {
   if (!victim_mask) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
                                 iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
 
+  const iree_host_size_t block_base =
+      block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT;
   int worker_index = rotation_offset;
   iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+      iree_task_affinity_set_rotr(victim_mask, rotation_offset);
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
     // Find the last set bit and skip to it. This avoids the need for doing
     // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
@@ -516,9 +549,12 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     //            mask >>= 1 = 0b01010101
     //            victim_index = 4 % 64 = 4
     int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
+    iree_host_size_t victim_index =
+        block_base +
+        (worker_index + offset) % IREE_TASK_AFFINITY_SET_BIT_COUNT;
     worker_index += offset + 1;
     mask = iree_shr(mask, offset + 1);
+    if (victim_index >= executor->worker_count) continue;
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
     if (iree_atomic_load_int32(&victim_worker->state,
                                iree_memory_order_acquire) !=
@@ -542,6 +578,21 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
   return NULL;
 }
 
+// Returns the set of workers in |block_index| that may have tasks to steal.
+static iree_task_affinity_set_t iree_task_executor_query_victim_mask(
+    iree_task_executor_t* executor, iree_host_size_t block_index) {
+  // The masks are accessed with 'relaxed' order because they are just hints.
+  iree_task_affinity_set_t worker_live_mask =
+      iree_atomic_task_affinity_set_load(
+          &executor->worker_live_mask[block_index], iree_memory_order_relaxed);
+  iree_task_affinity_set_t worker_idle_mask =
+      iree_atomic_task_affinity_set_load(
+          &executor->worker_idle_mask[block_index], iree_memory_order_relaxed);
+  // Limit the workers we will steal from to the ones that are currently live
+  // and not idle.
+  return worker_live_mask & ~worker_idle_mask;
+}
+
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
@@ -549,7 +600,11 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
 // cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// hierarchy and should be better to steal from than any random worker. After
+// that the remaining workers in the same block are tried and only then workers
+// in other blocks. With topologies derived from the machine each block is a
+// contiguous run of cores and so stealing from our own block is likely to stay
+// within the same NUMA node/package.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
@@ -557,46 +612,68 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // instead of bouncing around at random we just select the starting point in
 // our search and then go in-order.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t worker_block_index,
     iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_affinity_set_t* node_sharing_masks,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
-                                         iree_memory_order_relaxed);
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
-                                         iree_memory_order_relaxed);
-  // Limit the workers we will steal from to the ones that are currently live
-  // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
-
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
   // generate an 8-bit number (or even split it into two 4-bit numbers) per
   // theft attempt. The current rotation strategy is biased toward the same try
   // ordering vs. what we may really want with an unbiased random selection.
   int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
+                        (IREE_TASK_AFFINITY_SET_BIT_COUNT - 1);
 
   // Try first with the workers we may have some caches shared with. This
   // helps to prevent cache invalidations/availability updates as it's likely
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      executor, worker_block_index,
+      iree_task_executor_query_victim_mask(executor, worker_block_index) &
+          constructive_sharing_mask,
+      max_theft_attempts, rotation_offset, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
-  } else {
+  }
+
+  // Fall back to the other workers on the same NUMA node, starting with our
+  // own block and then the next blocks so that thieves from different blocks
+  // spread out. Tasks queued on workers on the same node are more likely to be
+  // touching memory local to the node.
+  for (iree_host_size_t i = 0; !task && i < executor->worker_block_count;
+       ++i) {
+    iree_host_size_t block_index =
+        (worker_block_index + i) % executor->worker_block_count;
+    iree_task_affinity_set_t victim_mask =
+        iree_task_executor_query_victim_mask(executor, block_index) &
+        node_sharing_masks[block_index];
+    if (i == 0) victim_mask &= ~constructive_sharing_mask;
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, block_index, victim_mask, max_theft_attempts,
+        rotation_offset, local_task_queue);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "node");
+    }
+  }
+
+  // Finally try the workers on other NUMA nodes (if any).
+  for (iree_host_size_t i = 0; !task && i < executor->worker_block_count;
+       ++i) {
+    iree_host_size_t block_index =
+        (worker_block_index + i) % executor->worker_block_count;
+    iree_task_affinity_set_t victim_mask =
+        iree_task_executor_query_victim_mask(executor, block_index) &
+        ~node_sharing_masks[block_index];
+    if (i == 0) victim_mask &= ~constructive_sharing_mask;
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
+        executor, block_index, victim_mask, max_theft_attempts,
         rotation_offset, local_task_queue);
     if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
     }
   }
 
@@ -0,0 +1,86 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+//==============================================================================
+// Dispatch throughput
+//==============================================================================
+// Measures the scheduling overhead of dispatches made up of many tiny tiles as
+// the number of workers scales. The tiles do nearly no work so the results are
+// dominated by the cost of distributing shards, popping tiles, and theft.
+
+// Tile function that does (almost) nothing.
+static iree_status_t TinyTile(void* user_context,
+                              const iree_task_tile_context_t* tile_context,
+                              iree_task_submission_t* pending_submission) {
+  benchmark::DoNotOptimize(tile_context->workgroup_xyz[0]);
+  return iree_ok_status();
+}
+
+void BM_DispatchTinyTiles(benchmark::State& state) {
+  const iree_host_size_t worker_count = (iree_host_size_t)state.range(0);
+  const uint32_t tile_count = (uint32_t)state.range(1);
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(
+      options, &topology, iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"), &scope);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {tile_count, 1, 1};
+  for (auto _ : state) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope, iree_task_make_dispatch_closure(TinyTile, NULL),
+        workgroup_size, workgroup_count, &dispatch);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  state.SetItemsProcessed(state.iterations() * tile_count);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+BENCHMARK(BM_DispatchTinyTiles)
+    ->ArgNames({"workers", "tiles"})
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int64_t worker_count = 1;
+           worker_count <= 128 &&
+           worker_count <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT;
+           worker_count *= 2) {
+        b->Args({worker_count, 1024});
+        b->Args({worker_count, 16 * 1024});
+      }
+    })
+    ->MeasureProcessCPUTime()
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
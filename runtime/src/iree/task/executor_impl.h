@@ -94,27 +94,30 @@ struct iree_task_executor_t {
   // existing computation on the workers to finish).
   iree_task_poller_t poller;
 
-  // A bitset indicating which workers are likely to be live and usable; all
-  // attempts to push work onto a particular worker should check first with this
-  // mask. This may change over time either automatically or by user request
-  // ("don't use these cores for awhile I'm going to be using them" etc).
+  // A bitset per block of workers indicating which workers are likely to be
+  // live and usable; all attempts to push work onto a particular worker should
+  // check first with this mask. This may change over time either
+  // automatically or by user request ("don't use these cores for awhile I'm
+  // going to be using them" etc).
   //
   // This mask is just a hint, accessed with memory_order_relaxed. Readers must
   // be OK with getting slightly out-of-date information. The only way to get
   // an authoritative answer to the question "is this worker live" is to
   // atomically query worker->state. This mask is for usage patterns where one
-  // needs a cheap (single relaxed atomic op) approximation of all N workers'
-  // live state without having to perform N expensive atomic ops.
-  iree_atomic_task_affinity_set_t worker_live_mask;
-
-  // A bitset indicating which workers are currently idle. Used to bias incoming
-  // tasks to workers that aren't doing much else. This is a balance of latency
-  // to wake the idle workers vs. latency to wait for existing work to complete
-  // on already woken workers.
+  // needs a cheap (single relaxed atomic op per block) approximation of all N
+  // workers' live state without having to perform N expensive atomic ops.
+  iree_atomic_task_affinity_set_t
+      worker_live_mask[IREE_TASK_AFFINITY_SET_BLOCK_COUNT];
+
+  // A bitset per block of workers indicating which workers are currently idle.
+  // Used to bias incoming tasks to workers that aren't doing much else. This is
+  // a balance of latency to wake the idle workers vs. latency to wait for
+  // existing work to complete on already woken workers.
   //
   // This mask is just a hint, accessed with memory_order_relaxed. See the
   // comment on worker_live_mask.
-  iree_atomic_task_affinity_set_t worker_idle_mask;
+  iree_atomic_task_affinity_set_t
+      worker_idle_mask[IREE_TASK_AFFINITY_SET_BLOCK_COUNT];
 
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
@@ -125,7 +128,16 @@ struct iree_task_executor_t {
   // For now this number is fixed per executor however if we wanted to enable
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
+  // Number of blocks of IREE_TASK_AFFINITY_SET_BIT_COUNT workers; the last
+  // block may be partially populated.
+  iree_host_size_t worker_block_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // Size and alignment of the local memory each worker allocates from its own
+  // (pinned) thread upon startup such that the pages are placed on its node.
+  // The alignment is a page when workers span NUMA nodes.
+  iree_host_size_t worker_local_memory_size;
+  iree_host_size_t worker_local_memory_alignment;
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -155,11 +167,15 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker);
 
 // Tries to steal an entire task from a sibling worker (based on topology).
-// Returns a task that is available (has not yet begun processing at all).
-// May steal multiple tasks and add them to the |local_task_queue|.
+// Workers sharing caches with the thief (|constructive_sharing_mask| within
+// block |worker_block_index|) are preferred, followed by workers on the same
+// NUMA node (|node_sharing_masks|, one per block), and then any other worker.
+// Returns a task that is available (has not yet begun processing at all). May
+// steal multiple tasks and add them to the |local_task_queue|.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t worker_block_index,
     iree_task_affinity_set_t constructive_sharing_mask,
+    const iree_task_affinity_set_t* node_sharing_masks,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
@@ -6,7 +6,10 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstring>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -133,4 +136,227 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests executors with more workers than fit in a single affinity set block.
+// Every tile of a large dispatch must be executed exactly once regardless of
+// which block's workers pick it up or steal it.
+TEST(ExecutorTest, ManyWorkersDispatch) {
+  static const iree_host_size_t kWorkerCounts[] = {
+      IREE_TASK_AFFINITY_SET_BIT_COUNT + 1,
+      IREE_TASK_AFFINITY_SET_BIT_COUNT * 2,
+      IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+  };
+  for (iree_host_size_t worker_count : kWorkerCounts) {
+    if (worker_count > IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) continue;
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(worker_count, &topology);
+    ASSERT_EQ(worker_count, iree_task_topology_group_count(&topology));
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_topology_deinitialize(&topology);
+    iree_task_scope_t scope;
+    iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+    const uint32_t tile_count = 16 * 1024;
+    std::vector<std::atomic<uint32_t>> tile_hits(tile_count);
+    for (auto& tile_hit : tile_hits) tile_hit = 0;
+
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {tile_count, 1, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              auto* tile_hits =
+                  (std::vector<std::atomic<uint32_t>>*)user_context;
+              (*tile_hits)[tile_context->workgroup_xyz[0]].fetch_add(1);
+              return iree_ok_status();
+            },
+            &tile_hits),
+        workgroup_size, workgroup_count, &dispatch);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+    for (uint32_t i = 0; i < tile_count; ++i) {
+      ASSERT_EQ(tile_hits[i], 1u) << "tile " << i << " with " << worker_count
+                                  << " workers";
+    }
+
+    iree_task_scope_deinitialize(&scope);
+    iree_task_executor_release(executor);
+  }
+}
+
+// Tests that affinities select exact workers in any block.
+TEST(ExecutorTest, AffinityForWorker) {
+  iree_task_affinity_t affinity = iree_task_affinity_for_worker(3);
+  EXPECT_EQ(affinity.block, 0);
+  EXPECT_EQ(affinity.mask, 1ull << 3);
+  affinity =
+      iree_task_affinity_for_worker(IREE_TASK_AFFINITY_SET_BIT_COUNT + 3);
+  EXPECT_EQ(affinity.block, 1);
+  EXPECT_EQ(affinity.mask, 1ull << 3);
+
+  affinity = iree_task_affinity_for_worker_range(2, 5);
+  EXPECT_EQ(affinity.block, 0);
+  EXPECT_EQ(affinity.mask, 0x1Cull);
+  affinity = iree_task_affinity_for_worker_range(
+      IREE_TASK_AFFINITY_SET_BIT_COUNT * 2 + 2,
+      IREE_TASK_AFFINITY_SET_BIT_COUNT * 2 + 5);
+  EXPECT_EQ(affinity.block, 2);
+  EXPECT_EQ(affinity.mask, 0x1Cull);
+  affinity = iree_task_affinity_for_worker_range(0, 100);
+  EXPECT_EQ(affinity.block, 0);
+  EXPECT_EQ(affinity.mask, UINT64_MAX);
+  // Ranges are clamped to the block containing the first worker.
+  affinity = iree_task_affinity_for_worker_range(
+      IREE_TASK_AFFINITY_SET_BIT_COUNT - 2,
+      IREE_TASK_AFFINITY_SET_BIT_COUNT + 2);
+  EXPECT_EQ(affinity.block, 0);
+  EXPECT_EQ(affinity.mask, 0xC000000000000000ull);
+  affinity = iree_task_affinity_for_worker_range(4, 4);
+  EXPECT_EQ(affinity.mask, 0ull);
+
+  affinity = iree_task_affinity_for_any_worker();
+  EXPECT_EQ(affinity.block, IREE_TASK_AFFINITY_BLOCK_ANY);
+  EXPECT_EQ(affinity.mask, UINT64_MAX);
+}
+
+// Tests that tasks with a restricted affinity are scheduled when there are
+// multiple affinity set blocks. Each task is bound to a single worker in any
+// block or to a worker index applied to every block.
+TEST(ExecutorTest, ManyWorkersAffinity) {
+  const iree_host_size_t worker_count =
+      iree_min(IREE_TASK_AFFINITY_SET_BIT_COUNT * 2 + 3,
+               (iree_host_size_t)IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static std::atomic<int> call_count = {0};
+  call_count = 0;
+  static const int kCallCount = 256;
+  std::vector<iree_task_call_t> calls(kCallCount);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              ++call_count;
+              return iree_ok_status();
+            },
+            NULL),
+        &calls[i]);
+    iree_task_affinity_t affinity;
+    if (i % 4 == 0) {
+      affinity = iree_task_affinity_for_any_worker();
+      affinity.mask = 1ull << (i % IREE_TASK_AFFINITY_SET_BIT_COUNT);
+    } else {
+      affinity = iree_task_affinity_for_worker(i % worker_count);
+    }
+    iree_task_set_affinity(&calls[i].header, affinity);
+    iree_task_set_completion_task(&calls[i].header, &fence->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(call_count, kCallCount);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests executors whose workers span multiple NUMA nodes. Each worker's local
+// memory must start on its own page so that it can be placed on its node.
+TEST(ExecutorTest, NumaNodes) {
+  static const iree_host_size_t kWorkerCount = 8;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  for (iree_host_size_t i = 0; i < kWorkerCount; ++i) {
+    topology.groups[i].node_id = (iree_task_topology_node_id_t)(i % 2);
+  }
+  ASSERT_EQ(2, iree_task_topology_node_count(&topology));
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 1000;
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static std::atomic<uint32_t> misaligned_count = {0};
+  static std::atomic<uint32_t> tile_count = {0};
+  misaligned_count = 0;
+  tile_count = 0;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {1024, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            if ((uintptr_t)tile_context->local_memory.data %
+                    IREE_TASK_EXECUTOR_NUMA_LOCAL_MEMORY_ALIGNMENT !=
+                0) {
+              ++misaligned_count;
+            }
+            // Ensure the memory is usable by the worker.
+            memset(tile_context->local_memory.data, 0xCD,
+                   tile_context->local_memory.data_length);
+            ++tile_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, workgroup_count, &dispatch);
+  dispatch.local_memory_size = 1000;
+
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(tile_count, 1024u);
+  EXPECT_EQ(misaligned_count, 0u);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
 }  // namespace
@@ -21,7 +21,8 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_post_batch_t* out_post_batch) {
   out_post_batch->executor = executor;
   out_post_batch->current_worker = current_worker;
-  out_post_batch->worker_pending_mask = 0;
+  memset(&out_post_batch->worker_pending_mask, 0,
+         sizeof(out_post_batch->worker_pending_mask));
   memset(&out_post_batch->worker_pending_lifos, 0,
          executor->worker_count * sizeof(iree_task_list_t));
 }
@@ -31,34 +32,104 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
-static iree_host_size_t iree_task_post_batch_select_random_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
-  // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_live_mask, iree_memory_order_relaxed);
-  iree_task_affinity_set_t valid_worker_mask = affinity_set & worker_live_mask;
-  if (!valid_worker_mask) {
-    // No valid workers as desired; for now just bail to worker 0.
-    return 0;
+// Returns the block that worker selection should begin scanning from.
+// Posting from a worker starts at its own block to keep work local.
+static iree_host_size_t iree_task_post_batch_first_block(
+    iree_task_post_batch_t* post_batch) {
+  return post_batch->current_worker
+             ? post_batch->current_worker->worker_block_index
+             : 0;
+}
+
+// Returns the number of blocks that may be selected from with |affinity| and
+// the first block to scan in |out_first_block|.
+static iree_host_size_t iree_task_post_batch_affinity_blocks(
+    iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity,
+    iree_host_size_t* out_first_block) {
+  if (affinity.block == IREE_TASK_AFFINITY_BLOCK_ANY) {
+    *out_first_block = iree_task_post_batch_first_block(post_batch);
+    return post_batch->executor->worker_block_count;
   }
+  *out_first_block = affinity.block;
+  return affinity.block < post_batch->executor->worker_block_count ? 1 : 0;
+}
 
+static iree_host_size_t iree_task_post_batch_select_random_worker(
+    iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity) {
   // TODO(benvanik): rotate through workers here. Instead, if the affinity set
   // has the current_worker allowed we just use that to avoid needing a
   // cross-thread hop.
-  return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  iree_task_executor_t* executor = post_batch->executor;
+  iree_host_size_t first_block = 0;
+  const iree_host_size_t block_count =
+      iree_task_post_batch_affinity_blocks(post_batch, affinity, &first_block);
+  for (iree_host_size_t i = 0; i < block_count; ++i) {
+    iree_host_size_t block_index =
+        (first_block + i) % executor->worker_block_count;
+    // The masks are accessed with 'relaxed' order because they are just hints.
+    iree_task_affinity_set_t worker_live_mask =
+        iree_atomic_task_affinity_set_load(
+            &executor->worker_live_mask[block_index],
+            iree_memory_order_relaxed);
+    iree_task_affinity_set_t valid_worker_mask =
+        affinity.mask & worker_live_mask;
+    if (valid_worker_mask) {
+      return block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT +
+             iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+    }
+  }
+
+  // No valid workers as desired; for now just bail to worker 0.
+  return 0;
+}
+
+// Selects an idle worker from the given affinity that has not yet had any
+// tasks posted to it in this batch. Returns false if there are none.
+static bool iree_task_post_batch_select_idle_worker(
+    iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity,
+    iree_host_size_t* out_worker_index) {
+  iree_task_executor_t* executor = post_batch->executor;
+  iree_host_size_t first_block = 0;
+  const iree_host_size_t block_count =
+      iree_task_post_batch_affinity_blocks(post_batch, affinity, &first_block);
+  for (iree_host_size_t i = 0; i < block_count; ++i) {
+    iree_host_size_t block_index =
+        (first_block + i) % executor->worker_block_count;
+    // The masks are accessed with 'relaxed' order because they are just hints.
+    iree_task_affinity_set_t worker_idle_mask =
+        iree_atomic_task_affinity_set_load(
+            &executor->worker_idle_mask[block_index],
+            iree_memory_order_relaxed);
+    worker_idle_mask &= ~post_batch->worker_pending_mask[block_index];
+    iree_task_affinity_set_t worker_live_mask =
+        iree_atomic_task_affinity_set_load(
+            &executor->worker_live_mask[block_index],
+            iree_memory_order_relaxed);
+    iree_task_affinity_set_t idle_affinity_set =
+        affinity.mask & worker_idle_mask & worker_live_mask;
+    if (idle_affinity_set) {
+      *out_worker_index =
+          block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT +
+          iree_task_affinity_set_count_trailing_zeros(idle_affinity_set);
+      return true;
+    }
+  }
+  return false;
 }
 
 iree_host_size_t iree_task_post_batch_select_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
-  if (post_batch->current_worker) {
+    iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity) {
+  iree_task_worker_t* current_worker = post_batch->current_worker;
+  if (current_worker) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
-    if ((affinity_set & post_batch->current_worker->worker_bit) &&
-        !(post_batch->worker_pending_mask &
-          post_batch->current_worker->worker_bit)) {
-      return iree_task_affinity_set_count_trailing_zeros(
-          post_batch->current_worker->worker_bit);
+    if ((affinity.block == IREE_TASK_AFFINITY_BLOCK_ANY ||
+         affinity.block == current_worker->worker_block_index) &&
+        (affinity.mask & current_worker->worker_bit) &&
+        !(post_batch->worker_pending_mask[current_worker->worker_block_index] &
+          current_worker->worker_bit)) {
+      return current_worker->worker_index -
+             post_batch->executor->worker_base_index;
     }
   }
 
@@ -68,20 +139,15 @@ iree_host_size_t iree_task_post_batch_select_worker(
   // worker's queue to finish. Note that we only consider workers idle if we
   // ourselves in this batch haven't already queued work for them (as then they
   // aren't going to be idle).
-  // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
-  worker_idle_mask &= ~post_batch->worker_pending_mask;
-  iree_task_affinity_set_t idle_affinity_set = affinity_set & worker_idle_mask;
-  if (idle_affinity_set) {
-    return iree_task_post_batch_select_random_worker(post_batch,
-                                                     idle_affinity_set);
+  iree_host_size_t worker_index = 0;
+  if (iree_task_post_batch_select_idle_worker(post_batch, affinity,
+                                              &worker_index)) {
+    return worker_index;
   }
 
   // No more workers are idle; farm out at random. In the worst case work
   // stealing will help balance things out on the backend.
-  return iree_task_post_batch_select_random_worker(post_batch, affinity_set);
+  return iree_task_post_batch_select_random_worker(post_batch, affinity);
 }
 
 void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
@@ -89,13 +155,14 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_task_t* task) {
   iree_task_list_push_front(&post_batch->worker_pending_lifos[worker_index],
                             task);
-  post_batch->worker_pending_mask |=
-      iree_task_affinity_for_worker(worker_index);
+  post_batch->worker_pending_mask[iree_task_affinity_block_for_worker(
+      worker_index)] |= iree_task_affinity_bit_for_worker(worker_index);
 }
 
-// Wakes each worker indicated in the |wake_mask|, if needed.
+// Wakes each worker in |block_index| indicated in the |wake_mask|, if needed.
 static void iree_task_post_batch_wake_workers(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
+    iree_task_post_batch_t* post_batch, iree_host_size_t block_index,
+    iree_task_affinity_set_t wake_mask) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(wake_mask));
 
@@ -109,10 +176,11 @@ static void iree_task_post_batch_wake_workers(
   // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
+  iree_host_size_t worker_index =
+      block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT;
   for (int i = 0; i < wake_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
-    int wake_index = worker_index + offset;
+    iree_host_size_t wake_index = worker_index + offset;
     worker_index += offset + 1;
     wake_mask = iree_shr(wake_mask, offset + 1);
 
@@ -127,21 +195,23 @@ static void iree_task_post_batch_wake_workers(
   IREE_TRACE_ZONE_END(z0);
 }
 
-bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
-  if (!post_batch->worker_pending_mask) return false;
-
-  IREE_TRACE_ZONE_BEGIN(z0);
-
+// Posts the pending tasks of all workers in |block_index| and wakes them.
+// Returns true if any tasks were posted.
+static bool iree_task_post_batch_submit_block(
+    iree_task_post_batch_t* post_batch, iree_host_size_t block_index) {
   // Run through each worker that has a bit set in the pending mask and post
   // the pending tasks.
-  iree_task_affinity_set_t worker_mask = post_batch->worker_pending_mask;
-  post_batch->worker_pending_mask = 0;
-  int worker_index = 0;
+  iree_task_affinity_set_t worker_mask =
+      post_batch->worker_pending_mask[block_index];
+  if (!worker_mask) return false;
+  post_batch->worker_pending_mask[block_index] = 0;
+  iree_host_size_t worker_index =
+      block_index * IREE_TASK_AFFINITY_SET_BIT_COUNT;
   int post_count = iree_task_affinity_set_count_ones(worker_mask);
   iree_task_affinity_set_t worker_wake_mask = 0;
   for (int i = 0; i < post_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(worker_mask);
-    int target_index = worker_index + offset;
+    iree_host_size_t target_index = worker_index + offset;
     worker_index += offset + 1;
     worker_mask = iree_shr(worker_mask, offset + 1);
 
@@ -157,16 +227,27 @@ bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
                                                    target_pending_lifo);
     } else {
       iree_task_worker_post_tasks(worker, target_pending_lifo);
-      worker_wake_mask |= iree_task_affinity_for_worker(target_index);
+      worker_wake_mask |= iree_task_affinity_bit_for_worker(target_index);
     }
   }
 
   // Wake all workers that now have pending work. If a worker is not already
   // waiting this will be cheap (no syscall).
   if (worker_wake_mask != 0) {
-    iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
+    iree_task_post_batch_wake_workers(post_batch, block_index,
+                                      worker_wake_mask);
   }
 
+  return true;
+}
+
+bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  bool did_post = false;
+  for (iree_host_size_t i = 0; i < post_batch->executor->worker_block_count;
+       ++i) {
+    did_post |= iree_task_post_batch_submit_block(post_batch, i);
+  }
   IREE_TRACE_ZONE_END(z0);
-  return post_count != 0;
+  return did_post;
 }
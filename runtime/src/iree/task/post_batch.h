@@ -35,9 +35,11 @@ typedef struct iree_task_post_batch_t {
   // May be NULL if not being posted from a worker (such as a submission).
   iree_task_worker_t* current_worker;
 
-  // A bitmask of workers indicating which have pending tasks in their lists.
-  // Used to quickly scan the lists and perform the posts only when required.
-  iree_task_affinity_set_t worker_pending_mask;
+  // A bitmask per block of workers indicating which have pending tasks in their
+  // lists. Used to quickly scan the lists and perform the posts only when
+  // required.
+  iree_task_affinity_set_t
+      worker_pending_mask[IREE_TASK_AFFINITY_SET_BLOCK_COUNT];
 
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
@@ -51,9 +53,11 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
-// Selects a random worker from the given affinity set.
+// Selects a random worker from the given affinity.
+// Affinities with IREE_TASK_AFFINITY_BLOCK_ANY are applied to each block of
+// workers and otherwise only the workers in the specified block are selected.
 iree_host_size_t iree_task_post_batch_select_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
+    iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity);
 
 // Enqueues a task to the given worker. Note that the pending work lists for
 // each work is kept in LIFO order so that we can easily concatenate it with the
@@ -9,83 +9,251 @@
 #include <stddef.h>
 #include <string.h>
 
+static_assert((IREE_TASK_QUEUE_CAPACITY & (IREE_TASK_QUEUE_CAPACITY - 1)) == 0,
+              "queue capacity must be a power of two");
+
+#define IREE_TASK_QUEUE_RING_MASK (IREE_TASK_QUEUE_CAPACITY - 1)
+
+//===----------------------------------------------------------------------===//
+// Chase-Lev ring
+//===----------------------------------------------------------------------===//
+// The memory orderings here follow "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (PPoPP 2013, linked in queue.h). The ring slots are
+// accessed with relaxed atomics as a thief may read a slot that the owner is
+// concurrently overwriting; the thief's CAS on |top| will then fail and the
+// value it read is discarded.
+
+static inline iree_task_t* iree_task_queue_ring_load(iree_task_queue_t* queue,
+                                                     int64_t index) {
+  return (iree_task_t*)iree_atomic_load_intptr(
+      &queue->ring[index & IREE_TASK_QUEUE_RING_MASK],
+      iree_memory_order_relaxed);
+}
+
+static inline void iree_task_queue_ring_store(iree_task_queue_t* queue,
+                                              int64_t index,
+                                              iree_task_t* task) {
+  iree_atomic_store_intptr(&queue->ring[index & IREE_TASK_QUEUE_RING_MASK],
+                           (intptr_t)task, iree_memory_order_relaxed);
+}
+
+// Returns true if the ring has no tasks in it.
+// Only accurate when called from the owner and even then may return a
+// false-negative if a thief is in the middle of claiming the last task.
+static inline bool iree_task_queue_ring_is_empty(iree_task_queue_t* queue) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_relaxed);
+  return bottom <= top;
+}
+
+// Pushes |task| to the front of the ring.
+// Returns false if the ring is full.
+// Must only be called by the owner.
+static bool iree_task_queue_ring_try_push(iree_task_queue_t* queue,
+                                          iree_task_t* task) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  if (bottom - top >= IREE_TASK_QUEUE_CAPACITY) return false;
+  iree_task_queue_ring_store(queue, bottom, task);
+  // NOTE: the paper uses a release fence followed by a relaxed store; a release
+  // store is equivalent here and is understood by thread sanitizers.
+  iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                          iree_memory_order_release);
+  return true;
+}
+
+// Pops the task at the front of the ring, if any.
+// Must only be called by the owner.
+static iree_task_t* iree_task_queue_ring_pop(iree_task_queue_t* queue) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store_int64(&queue->bottom, bottom, iree_memory_order_relaxed);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_relaxed);
+  if (top > bottom) {
+    // Empty; restore bottom.
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+    return NULL;
+  }
+  iree_task_t* task = iree_task_queue_ring_load(queue, bottom);
+  if (top == bottom) {
+    // Last task in the ring; race any thieves for it.
+    if (!iree_atomic_compare_exchange_strong_int64(
+            &queue->top, &top, top + 1, iree_memory_order_seq_cst,
+            iree_memory_order_relaxed)) {
+      task = NULL;  // lost
+    }
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+// Steals the task at the back of the ring, if any.
+// Returns NULL if the ring is empty or the task was claimed by someone else.
+// Callable from any thread.
+static iree_task_t* iree_task_queue_ring_steal(iree_task_queue_t* queue) {
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_acquire);
+  if (top >= bottom) return NULL;
+  iree_task_t* task = iree_task_queue_ring_load(queue, top);
+  if (!iree_atomic_compare_exchange_strong_int64(&queue->top, &top, top + 1,
+                                                 iree_memory_order_seq_cst,
+                                                 iree_memory_order_relaxed)) {
+    return NULL;  // lost
+  }
+  return task;
+}
+
+// Returns the approximate number of tasks in the ring.
+static iree_host_size_t iree_task_queue_ring_size(iree_task_queue_t* queue) {
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_acquire);
+  return bottom > top ? (iree_host_size_t)(bottom - top) : 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Owner-side overflow management
+//===----------------------------------------------------------------------===//
+
+// Moves up to half of the ring from the back into the front of the overflow
+// list to make room for more pushes.
+static void iree_task_queue_spill(iree_task_queue_t* queue) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_QUEUE_CAPACITY / 2; ++i) {
+    // NOTE: if a thief beats us to a task then it still made room.
+    iree_task_t* task = iree_task_queue_ring_steal(queue);
+    if (task) iree_task_list_push_front(&queue->overflow, task);
+  }
+}
+
+// Pushes |task| to the front of the queue, spilling the back of the ring to the
+// overflow list if needed.
+static void iree_task_queue_push_front_owner(iree_task_queue_t* queue,
+                                             iree_task_t* task) {
+  while (!iree_task_queue_ring_try_push(queue, task)) {
+    iree_task_queue_spill(queue);
+  }
+}
+
+// Refills the empty ring with tasks from the front of the overflow list.
+// Returns false if there were no tasks in the overflow list.
+static bool iree_task_queue_refill(iree_task_queue_t* queue) {
+  if (iree_task_list_is_empty(&queue->overflow)) return false;
+
+  // Pop the tasks we are moving into a reversed list so that the front-most
+  // task is pushed last and ends up at the front of the ring.
+  iree_task_list_t reversed;
+  iree_task_list_initialize(&reversed);
+  for (iree_host_size_t i = 0; i < IREE_TASK_QUEUE_CAPACITY; ++i) {
+    iree_task_t* task = iree_task_list_pop_front(&queue->overflow);
+    if (!task) break;
+    iree_task_list_push_front(&reversed, task);
+  }
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(&reversed)) != NULL) {
+    iree_task_queue_push_front_owner(queue, task);
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_task_queue_t
+//===----------------------------------------------------------------------===//
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
-  iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  iree_task_list_initialize(&out_queue->overflow);
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
-  iree_slim_mutex_deinitialize(&queue->mutex);
+  // Gather up all remaining tasks in queue order and discard them.
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_ring_pop(queue)) != NULL) {
+    iree_task_list_push_back(&list, task);
+  }
+  iree_task_list_append(&list, &queue->overflow);
+  iree_task_list_discard(&list);
 }
 
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-  return is_empty;
+  return iree_task_queue_ring_is_empty(queue) &&
+         iree_task_list_is_empty(&queue->overflow);
 }
 
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_queue_push_front_owner(queue, task);
 }
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
-  iree_task_list_reverse(list);
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  // The head of the LIFO list is the last task to run so push from the head
+  // such that the tail ends up at the front.
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(list)) != NULL) {
+    iree_task_queue_push_front_owner(queue, task);
+  }
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
-  // Perform the flush and swap outside of the lock; acquiring the list is
-  // atomic and then we own it exclusively.
-  iree_task_list_t suffix;
-  iree_task_list_initialize(&suffix);
-  const bool did_flush = iree_atomic_task_slist_flush(
-      source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
-      &suffix.head, &suffix.tail);
-
-  // Append the tasks and pop off the front for return.
-  iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-
-  return next_task;
+  // Acquiring the list is atomic and then we own it exclusively. We keep it in
+  // LIFO order so that we can push from the head.
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  if (iree_atomic_task_slist_flush(
+          source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+          &list.head, &list.tail)) {
+    iree_task_queue_append_from_lifo_list_unsafe(queue, &list);
+  }
+  return iree_task_queue_pop_front(queue);
 }
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-  return next_task;
+  do {
+    iree_task_t* task = iree_task_queue_ring_pop(queue);
+    if (task) return task;
+    // NOTE: the pop may have failed because a thief took the last task from
+    // the ring; either way the ring is now empty and can be refilled.
+  } while (iree_task_queue_refill(queue));
+  return NULL;
 }
 
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
+  // Steal roughly half of the tasks in the ring; if there's only one task then
+  // always prefer to steal it. This is because the victim is likely working on
+  // their last item and we can help them out by popping this off. It also has
+  // the side-effect of handling cases of donated workers wanting to steal all
+  // tasks to synchronously execute things.
+  iree_host_size_t available = iree_task_queue_ring_size(source_queue);
+  iree_host_size_t steal_count = iree_min((available + 1) / 2, max_tasks);
+
+  // Each task is claimed individually from the back of the source queue. We
+  // build the stolen list back-to-front so that it retains the queue order.
+  // If we lose a race then the victim or another thief is draining the queue
+  // and we stop with what we have.
   iree_task_list_t stolen_tasks;
   iree_task_list_initialize(&stolen_tasks);
-  if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
-    iree_slim_mutex_unlock(&source_queue->mutex);
+  for (iree_host_size_t i = 0; i < steal_count; ++i) {
+    iree_task_t* task = iree_task_queue_ring_steal(source_queue);
+    if (!task) break;
+    iree_task_list_push_front(&stolen_tasks, task);
   }
+  if (iree_task_list_is_empty(&stolen_tasks)) return NULL;
 
-  // Add any stolen tasks to the target queue and pop off the head for return.
-  iree_task_t* next_task = NULL;
-  if (!iree_task_list_is_empty(&stolen_tasks)) {
-    iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
-    iree_slim_mutex_unlock(&target_queue->mutex);
-  }
-  return next_task;
+  // Add the stolen tasks to the back of the target queue and pop off the front
+  // for return. If the ring was empty the pop will refill it from the overflow
+  // list making the remaining stolen tasks available to other thieves.
+  iree_task_list_append(&target_queue->overflow, &stolen_tasks);
+  return iree_task_queue_pop_front(target_queue);
 }
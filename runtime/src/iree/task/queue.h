@@ -10,7 +10,7 @@
 #include <stdbool.h>
 
 #include "iree/base/api.h"
-#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/task/list.h"
 #include "iree/task/task.h"
 
@@ -18,96 +18,84 @@
 extern "C" {
 #endif  // __cplusplus
 
-// A simple work-stealing LIFO queue modeled on a Chase-Lev concurrent deque.
+// Capacity of the lock-free ring portion of each queue in tasks.
+// Must be a power of two. Tasks beyond this are kept in an owner-private
+// overflow list and refilled into the ring as it drains; they cannot be stolen
+// until then.
+#define IREE_TASK_QUEUE_CAPACITY 256
+
+// A work-stealing deque modeled on a Chase-Lev concurrent deque.
 // This is used by workers to maintain their thread-local working lists. The
-// workers keep the tasks they will process in FIFO order. They allow it to
-// empty and then refresh it with more tasks from the incoming worker mailbox.
-// The performance bias here is to the workers as they are >90% of the
-// accesses and the only other accesses are thieves that hopefully we can just
-// improve our distribution to vs. introducing a slowdown here.
-//
-// A futex is used to synchronize access; because the common case is that of
-// only the worker that owns the queue touching it for pushing and popping items
-// this puts us into the sweet-spot of uncontended lightweight exclusive locks.
-// Since futices are effectively just single machine words managed with atomic
-// ops we can avoid a lot of the traditional atomic tomfoolery one finds in
-// systems like these that originated prior to the introduction of futices while
-// also keeping the tiny overhead of the pure atomic solutions.
+// owning worker pushes and pops tasks at the front of the queue and other
+// workers that have run out of work steal from the back. The performance bias
+// here is to the owner as it performs >90% of the accesses: pushes and pops by
+// the owner are a handful of uncontended loads and stores and only touch an
+// atomic read-modify-write when racing a thief for the very last task.
 //
-// We can also take advantage of the futex providing an actual exclusive region
-// such that our data structure can be whatever we want as opposed to needing to
-// be something that someone had figured out how to make atomic. For example,
-// common implementations of work-stealing queues are all bounded as unbounded
-// atomic deques are an unsolved problem in CS.
+// The queue is a fixed-size ring of task pointers indexed by two monotonically
+// increasing counters. Only the owner writes |bottom| and thieves claim tasks
+// by CASing |top| forward one at a time. As with all Chase-Lev variants the
+// ring is bounded; instead of growing it (and having to defer reclamation of
+// the old ring until no thief could be reading it) we spill the oldest tasks
+// into an intrusive overflow list owned exclusively by the worker. Logically
+// the overflow list sits behind the ring: the queue in order is
+// ring[bottom-1]...ring[top] followed by overflow.head...overflow.tail. When
+// the ring drains the owner refills it from the head of the overflow list.
+// Workloads that produce more than IREE_TASK_QUEUE_CAPACITY tasks per worker
+// at a time are rare as dispatches are split into at most one shard task per
+// worker.
 //
-// Very rarely when another worker runs out of work it'll try to steal tasks
-// from nearby workers and use this queue type to do it: the assumption is that
-// it's better to take the last task the victim worker will get to so that in a
-// long list of tasks it remains chugging through the head of the list with good
-// cache locality. If we end up with a lot of theft, though, it's possible for
-// the cache benefits of the pop_back approach to the worker to outweigh the
-// cache pessimism for all thieves. Let's hope we can schedule deterministic-
-// enough tiles such that theft is rare!
+//  +--------+ <- ring[0]
+//  |  top   | <- stealers consume here: task = ring[top++]
+//  |        |
+//  |   ||   |
+//  |        |
+//  |   vv   |
+//  | bottom | <- owner pushes here:    ring[bottom++] = task
+//  |        |    owner consumes here:  task = ring[--bottom]
+//  |        |
+//  +--------+ <- ring[IREE_TASK_QUEUE_CAPACITY-1]
+//  overflow: owner-only list of tasks logically following ring[top]
 //
-// Our queue variant here is tuned for the use case we have: we exclusively
-// push in multiple tasks at a time (flushed from the mailbox) and exclusively
-// pop a single task a time (what to work on next). The stealing part is batched
-// so that when a remote worker has to perform a theft it takes a good chunk of
-// tasks in one go (hopefully roughly half) to reduce the total overhead when
-// there is high imbalance in workloads.
+// Thieves take the tasks that the victim worker would get to last so that in a
+// long list of tasks the victim remains chugging through the front of the list
+// with good cache locality. Theft is batched so that a remote worker takes a
+// good chunk of tasks in one go (roughly half, up to a limit) to reduce the
+// total overhead when there is high imbalance in workloads. Each task in the
+// batch is claimed with its own CAS as a multi-task claim could race with the
+// owner popping the same tasks from the other end.
 //
-// Flushing from the mailbox slist (LIFO) to our list (FIFO) requires a full
-// walk of the incoming task linked list. This is generally fine as the number
-// of tasks in any given flush is low(ish) and by walking in reverse order to
-// then process forward the cache should be hot as the worker starts making its
-// way back through the tasks. As we walk forward we'll be using the task fields
-// for execution and retiring of tasks (notifing dependencies/etc) and the
-// intrusive next pointer sitting next to those should be in-cache when we need
-// to access it. This, combined with slab allocation of tasks in command buffers
-// to begin with gives us the (probabilistically) same characteristics of a flat
-// array walked with an index as is common in other work queues but with the
-// flexibility to reorder tasks as we see fit (theft, redistribution/rotation,
-// reprioritization, etc).
+// Batches of tasks arriving from the mailbox are pushed such that they are run
+// in the order they were posted. Because the owner pops from the front the most
+// recently pushed batch runs before any tasks that were already queued; workers
+// only flush their mailbox once their queue has drained so in practice this is
+// only observable when a worker posts to itself.
 //
-// Similar concepts, though implemented with atomics:
+// References:
 //   "Dynamic Circular Work-Stealing Deque":
 //   http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.170.1097&rep=rep1&type=pdf
 //   "Correct and Efficient Work-Stealing for Weak Memory Models":
 //   https://fzn.fr/readings/ppopp13.pdf
 //   Motivating article:
 //   https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
-//
-// Useful diagram from https://github.com/injinj/WSQ
-// Much of this implementation is inspired from that; though significant
-// reworking was required for our FIFO->LIFO->FIFO sandwich.
-//  +--------+ <- tasks[0]
-//  |  top   | <- stealers consume here: task = tasks[top++]
-//  |        |
-//  |   ||   |
-//  |        |
-//  |   vv   |
-//  | bottom | <- owner pushes here:    tasks[bottom++] = task
-//  |        |    owner consumes here:  task = tasks[--bottom]
-//  |        |
-//  +--------+ <- tasks[IREE_TASK_QUEUE_CAPACITY-1]
-//
-// Unlike that implementation, though, our task list is unbounded because we use
-// a linked list. To keep our options open, though, I've left the API of this
-// implementation compatible with classic atomic work-stealing queues. I'm
-// hopeful this will not need to be revisted for awhile, though!
-//
-// Future improvement idea: have the owner of the queue maintain a theft point
-// skip list that makes it possible for thieves to quickly come in and slice
-// off batches of tasks at the tail of the queue. Since we are a singly-linked
-// list we can't easily just walk backward and we don't want to be introducing
-// cache line contention as thieves start touching the same tasks as the worker
-// is while processing.
 typedef struct iree_task_queue_t {
-  // Must be held when manipulating the queue. >90% accesses are by the owner.
-  iree_slim_mutex_t mutex;
+  // Index of the back of the queue in the ring. Thieves race to advance this.
+  iree_atomic_int64_t top;
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // Destructive interference padding so that thieves hammering |top| don't
+  // contend with the owner pushing and popping at |bottom|.
+  uint8_t _top_padding[iree_hardware_destructive_interference_size -
+                       sizeof(iree_atomic_int64_t)];
+
+  // Index one past the front of the queue in the ring. Only the owner writes.
+  iree_atomic_int64_t bottom;
+
+  // Tasks logically behind ring[top] that did not fit in the ring.
+  // Only accessed by the owner.
+  iree_task_list_t overflow;
+
+  // Ring of iree_task_t* indexed by [top, bottom) modulo the capacity.
+  iree_atomic_intptr_t ring[IREE_TASK_QUEUE_CAPACITY];
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -118,25 +106,27 @@ void iree_task_queue_initialize(iree_task_queue_t* out_queue);
 void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 
 // Returns true if the queue is empty.
-// Note that due to races this may return both false-positives and -negatives.
+// Note that due to races with thieves this may return false-negatives.
+//
+// Must only be called from the owning worker's thread.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
 // Pushes a task to the front of the queue.
-// Always prefer the multi-push variants (prepend/append) when adding more than
-// one task to the queue. This is mostly useful for exceptional cases such as
-// when a task may yield and need to be reprocessed after the worker resumes.
+// This is mostly useful for exceptional cases such as when a task may yield and
+// need to be reprocessed after the worker resumes.
 //
 // Must only be called from the owning worker's thread.
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task);
 
-// Appends a LIFO |list| of tasks to the queue.
+// Pushes a LIFO |list| of tasks to the front of the queue such that they will
+// be popped in FIFO order (tail first). |list| is left empty.
 //
 // Must only be called from the owning worker's thread.
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list);
 
-// Flushes the |source_slist| LIFO mailbox into the task queue in FIFO order.
-// Returns the first task in the queue upon success; the task may be
+// Flushes the |source_slist| LIFO mailbox to the front of the task queue in
+// FIFO order. Returns the first task in the queue upon success; the task may be
 // pre-existing or from the newly flushed tasks.
 //
 // Must only be called from the owning worker's thread.
@@ -150,11 +140,12 @@ iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue);
 
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the |source_queue| will be moved to the
-// |target_queue| and the first of the stolen tasks is returned.
+// that were at the tail of the |source_queue| will be moved to the back of the
+// |target_queue| and the task at the front of the |target_queue| is returned.
+// Tasks in the overflow of the |source_queue| are not visible to thieves.
 //
-// It's expected this is not called from the queue's owning worker, though it's
-// valid to do so.
+// May be called from any thread but must be called from the thread owning the
+// |target_queue|.
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks);
@@ -6,6 +6,10 @@
 
 #include "iree/task/queue.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "iree/testing/gtest.h"
 
 namespace {
@@ -51,6 +55,27 @@ TEST(QueueTest, PushPop) {
   iree_task_queue_deinitialize(&queue);
 }
 
+// Tests that pushing more tasks than fit in the ring spills to the overflow
+// list and that the overflow is drained in order.
+TEST(QueueTest, PushPopOverflow) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  std::vector<iree_task_t> tasks(IREE_TASK_QUEUE_CAPACITY * 3 + 1);
+  for (auto& task : tasks) {
+    task = {0};
+    iree_task_queue_push_front(&queue, &task);
+  }
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_FALSE(iree_task_queue_is_empty(&queue));
+    EXPECT_EQ(&tasks[tasks.size() - i - 1], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+  EXPECT_FALSE(iree_task_queue_pop_front(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
 TEST(QueueTest, AppendListEmpty) {
   iree_task_queue_t queue;
   iree_task_queue_initialize(&queue);
@@ -319,4 +344,61 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+// Tests that every task is received exactly once when the owner pops tasks
+// while multiple thieves are stealing from it.
+TEST(QueueTest, TryStealConcurrent) {
+  static const int kThiefCount = 4;
+  static const int kTaskCount = IREE_TASK_QUEUE_CAPACITY * 16;
+
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::vector<std::atomic<int>> counts(kTaskCount);
+  std::atomic<int> total_count(0);
+  auto take_task = [&](iree_task_t* task) {
+    counts[task - tasks.data()].fetch_add(1);
+    total_count.fetch_add(1);
+  };
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t target_queue;
+      iree_task_queue_initialize(&target_queue);
+      while (total_count.load() < kTaskCount) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&source_queue, &target_queue, 8);
+        while (task) {
+          take_task(task);
+          task = iree_task_queue_pop_front(&target_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&target_queue);
+    });
+  }
+
+  // Push in batches and pop a few between each to race the thieves.
+  for (int i = 0; i < kTaskCount; ++i) {
+    tasks[i] = {0};
+    iree_task_queue_push_front(&source_queue, &tasks[i]);
+    if ((i % 3) == 0) {
+      iree_task_t* task = iree_task_queue_pop_front(&source_queue);
+      if (task) take_task(task);
+    }
+  }
+  while (iree_task_t* task = iree_task_queue_pop_front(&source_queue)) {
+    take_task(task);
+  }
+
+  for (auto& thief : thieves) thief.join();
+  EXPECT_EQ(kTaskCount, total_count.load());
+  for (int i = 0; i < kTaskCount; ++i) {
+    EXPECT_EQ(1, counts[i].load());
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
+
+  iree_task_queue_deinitialize(&source_queue);
+}
+
 }  // namespace
@@ -26,10 +26,15 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
   // NOTE: only clears the header, not the task body.
   memset(out_task, 0, sizeof(*out_task));
   out_task->scope = scope;
-  out_task->affinity_set = iree_task_affinity_for_any_worker();
+  iree_task_set_affinity(out_task, iree_task_affinity_for_any_worker());
   out_task->type = type;
 }
 
+void iree_task_set_affinity(iree_task_t* task, iree_task_affinity_t affinity) {
+  task->affinity_set = affinity.mask;
+  task->affinity_block = affinity.block;
+}
+
 void iree_task_set_cleanup_fn(iree_task_t* task,
                               iree_task_cleanup_fn_t cleanup_fn) {
   task->cleanup_fn = cleanup_fn;
@@ -52,6 +57,52 @@ bool iree_task_is_ready(iree_task_t* task) {
   return true;
 }
 
+void iree_task_capture_reset_state(iree_task_t* task,
+                                   iree_task_reset_state_t* out_state) {
+  IREE_ASSERT(!task->pool);
+  out_state->completion_task = task->completion_task;
+  out_state->workgroup_count_ptr = NULL;
+  out_state->pending_dependency_count = iree_atomic_load_int32(
+      &task->pending_dependency_count, iree_memory_order_acquire);
+  out_state->flags = task->flags;
+  if (task->type == IREE_TASK_TYPE_DISPATCH &&
+      iree_all_bits_set(task->flags, IREE_TASK_FLAG_DISPATCH_INDIRECT)) {
+    out_state->workgroup_count_ptr =
+        ((iree_task_dispatch_t*)task)->workgroup_count.ptr;
+  }
+}
+
+void iree_task_reset(iree_task_t* task, const iree_task_reset_state_t* state) {
+  task->next_task = NULL;
+  task->completion_task = state->completion_task;
+  iree_atomic_store_int32(&task->pending_dependency_count,
+                          state->pending_dependency_count,
+                          iree_memory_order_relaxed);
+  task->flags = state->flags;
+  switch (task->type) {
+    case IREE_TASK_TYPE_CALL: {
+      iree_task_call_t* call_task = (iree_task_call_t*)task;
+      iree_atomic_store_intptr(&call_task->status, 0,
+                               iree_memory_order_relaxed);
+      break;
+    }
+    case IREE_TASK_TYPE_DISPATCH: {
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      if (iree_all_bits_set(state->flags, IREE_TASK_FLAG_DISPATCH_INDIRECT)) {
+        dispatch_task->workgroup_count.ptr = state->workgroup_count_ptr;
+      }
+      iree_atomic_store_intptr(&dispatch_task->status, 0,
+                               iree_memory_order_relaxed);
+      memset(&dispatch_task->statistics, 0, sizeof(dispatch_task->statistics));
+      break;
+    }
+    default:
+      IREE_ASSERT(task->type == IREE_TASK_TYPE_NOP ||
+                  task->type == IREE_TASK_TYPE_BARRIER);
+      break;
+  }
+}
+
 static void iree_task_try_set_status(iree_atomic_intptr_t* permanent_status,
                                      iree_status_t new_status) {
   if (IREE_UNLIKELY(iree_status_is_ok(new_status))) return;
@@ -344,10 +395,18 @@ void iree_task_barrier_retire(iree_task_barrier_t* task,
                               iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // The barrier retires before releasing its dependents so that it is not
+  // accessed once they may have executed: task graphs that are reset and
+  // issued again (see iree_task_reset) may reuse the barrier as soon as all of
+  // the tasks in the graph have retired. The dependent task list is owned by
+  // the user and remains valid.
+  iree_host_size_t dependent_task_count = task->dependent_task_count;
+  iree_task_t* const* dependent_tasks = task->dependent_tasks;
+  iree_task_retire(&task->header, pending_submission, iree_ok_status());
+
   // NOTE: we walk in reverse so that we enqueue in LIFO order.
-  for (iree_host_size_t i = 0; i < task->dependent_task_count; ++i) {
-    iree_task_t* dependent_task =
-        task->dependent_tasks[task->dependent_task_count - i - 1];
+  for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
+    iree_task_t* dependent_task = dependent_tasks[dependent_task_count - i - 1];
     if (iree_atomic_fetch_sub_int32(&dependent_task->pending_dependency_count,
                                     1, iree_memory_order_acq_rel) == 1) {
       // The dependent task has retired and can now be made ready.
@@ -355,8 +414,6 @@ void iree_task_barrier_retire(iree_task_barrier_t* task,
     }
   }
 
-  iree_task_retire(&task->header, pending_submission, iree_ok_status());
-
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -576,8 +633,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
     // indirection buffer have been satisfied and its safe to read. We perform
     // the indirection here and convert the dispatch to a direct one such that
     // following code can read the value.
-    // TODO(benvanik): non-one-shot command buffers won't be able to do this as
-    // the intent is that they can be dynamic per execution.
+    // Tasks that are issued multiple times restore the indirection when reset
+    // (see iree_task_reset).
     const uint32_t* source_ptr = dispatch_task->workgroup_count.ptr;
     memcpy(dispatch_task->workgroup_count.value, source_ptr,
            sizeof(dispatch_task->workgroup_count.value));
@@ -622,7 +679,7 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
-      post_batch, dispatch_task->header.affinity_set);
+      post_batch, iree_task_affinity(&dispatch_task->header));
   iree_host_size_t worker_index = worker_offset;
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
@@ -162,6 +162,7 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
   // of the specific work being performed. For example, some dispatches can be
   // limited to run on certain microarchitectures that workers have affinity
   // with at the OS scheduler level (such as little.BIG topologies).
+  // The set is relative to |affinity_block| (see iree_task_affinity_t).
   iree_task_affinity_set_t affinity_set;
 
   // Total number of dependent tasks still outstanding. Decremented each time
@@ -169,6 +170,10 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
   // this value reaches 0.
   iree_atomic_int32_t pending_dependency_count;
 
+  // Block of workers |affinity_set| selects from or
+  // IREE_TASK_AFFINITY_BLOCK_ANY if it applies to every block.
+  iree_task_affinity_block_t affinity_block;
+
   // Optional pool the task should be returned to after it has resolved. If the
   // task was allocated as part of a larger data structure (embedded within
   // an arena for example) then this can be NULL to prevent the task system
@@ -202,6 +207,17 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
 void iree_task_set_cleanup_fn(iree_task_t* task,
                               iree_task_cleanup_fn_t cleanup_fn);
 
+// Sets the workers the task may execute on.
+void iree_task_set_affinity(iree_task_t* task, iree_task_affinity_t affinity);
+
+// Returns the workers the task may execute on.
+static inline iree_task_affinity_t iree_task_affinity(const iree_task_t* task) {
+  iree_task_affinity_t affinity;
+  affinity.block = task->affinity_block;
+  affinity.mask = task->affinity_set;
+  return affinity;
+}
+
 // Sets up a dependency edge from |task| to |completion_task| such that when
 // |task| completes |completion_task| will be notified and have its
 // pending_dependency_count decremented.
@@ -221,6 +237,33 @@ bool iree_task_is_ready(iree_task_t* task);
 // |discard_worklist| for the caller to continue discarding.
 void iree_task_discard(iree_task_t* task, iree_task_list_t* discard_worklist);
 
+// Execution state of a task captured prior to its first execution that allows
+// it to be reset and executed again. A fully-linked DAG of tasks can be issued
+// any number of times without being rebuilt by resetting all of its tasks with
+// iree_task_reset prior to each issue so long as executions do not overlap.
+// Only IREE_TASK_TYPE_NOP, IREE_TASK_TYPE_CALL, IREE_TASK_TYPE_BARRIER, and
+// IREE_TASK_TYPE_DISPATCH tasks allocated outside of task pools can be reset.
+typedef struct iree_task_reset_state_t {
+  // Task notified when the task completes.
+  iree_task_t* completion_task;
+  // Workgroup count indirection of an IREE_TASK_FLAG_DISPATCH_INDIRECT
+  // dispatch as the dispatch replaces it with the workgroup count on issue.
+  const uint32_t* workgroup_count_ptr;
+  // Number of tasks that must complete before the task is ready.
+  int32_t pending_dependency_count;
+  iree_task_flags_t flags;
+} iree_task_reset_state_t;
+
+// Captures the execution state of |task| into |out_state|.
+// Must be called after all dependencies of the task have been set up and before
+// it is issued for the first time.
+void iree_task_capture_reset_state(iree_task_t* task,
+                                   iree_task_reset_state_t* out_state);
+
+// Resets |task| to the execution state captured in |state| such that it can be
+// issued again. The task must have either retired or been discarded.
+void iree_task_reset(iree_task_t* task, const iree_task_reset_state_t* state);
+
 //==============================================================================
 // IREE_TASK_TYPE_NOP
 //==============================================================================
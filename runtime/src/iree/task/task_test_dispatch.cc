@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include "iree/base/api.h"
@@ -32,11 +33,11 @@ class GridCoverage {
     }
   }
 
-  bool Verify() {
+  bool Verify(int32_t expected_count = 1) {
     fflush(stdout);
     for (iree_host_size_t i = 0; i < workgroup_count_; ++i) {
       if (iree_atomic_load_int32(&storage_[i], iree_memory_order_seq_cst) !=
-          1) {
+          expected_count) {
         return false;
       }
     }
@@ -149,6 +150,53 @@ TEST_F(TaskDispatchTest, IssueIndirect) {
   EXPECT_TRUE(coverage.Verify());
 }
 
+// Tests that an indirect dispatch can be reset and issued again with the
+// workgroup count re-read from the indirection buffer.
+TEST_F(TaskDispatchTest, IssueIndirectReset) {
+  IREE_TRACE_SCOPE();
+
+  static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  static const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  uint32_t indirect_workgroup_count[3] = {0, 0, 0};
+  GridCoverage coverage(kWorkgroupCount);
+
+  iree_task_call_t calculate_task;
+  iree_task_call_initialize(
+      &scope_,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            uint32_t* indirect_workgroup_count_ptr = (uint32_t*)user_context;
+            for (size_t i = 0; i < IREE_ARRAYSIZE(kWorkgroupCount); ++i) {
+              indirect_workgroup_count_ptr[i] = kWorkgroupCount[i];
+            }
+            return iree_ok_status();
+          },
+          (void*)indirect_workgroup_count),
+      &calculate_task);
+
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize_indirect(
+      &scope_,
+      iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
+      kWorkgroupSize, indirect_workgroup_count, &dispatch_task);
+  iree_task_set_completion_task(&calculate_task.header, &dispatch_task.header);
+
+  iree_task_reset_state_t calculate_state;
+  iree_task_capture_reset_state(&calculate_task.header, &calculate_state);
+  iree_task_reset_state_t dispatch_state;
+  iree_task_capture_reset_state(&dispatch_task.header, &dispatch_state);
+
+  for (int32_t i = 1; i <= 2; ++i) {
+    iree_task_reset(&calculate_task.header, &calculate_state);
+    iree_task_reset(&dispatch_task.header, &dispatch_state);
+    memset(indirect_workgroup_count, 0, sizeof(indirect_workgroup_count));
+    IREE_ASSERT_OK(
+        SubmitTasksAndWaitIdle(&calculate_task.header, &dispatch_task.header));
+    EXPECT_TRUE(coverage.Verify(/*expected_count=*/i));
+  }
+}
+
 TEST_F(TaskDispatchTest, IssueFailure) {
   IREE_TRACE_SCOPE();
 
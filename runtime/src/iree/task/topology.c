@@ -12,11 +12,12 @@
 #include "iree/base/api.h"
 
 void iree_task_topology_group_initialize(
-    uint8_t group_index, iree_task_topology_group_t* out_group) {
+    uint16_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
            group_index);
+  out_group->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
@@ -57,6 +58,25 @@ iree_host_size_t iree_task_topology_group_count(
   return topology->group_count;
 }
 
+iree_host_size_t iree_task_topology_node_count(
+    const iree_task_topology_t* topology) {
+  // O(n^2) but the number of distinct nodes is always small.
+  iree_host_size_t node_count = 0;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    iree_task_topology_node_id_t node_id = topology->groups[i].node_id;
+    if (node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) continue;
+    bool is_first = true;
+    for (iree_host_size_t j = 0; j < i; ++j) {
+      if (topology->groups[j].node_id == node_id) {
+        is_first = false;
+        break;
+      }
+    }
+    if (is_first) ++node_count;
+  }
+  return node_count;
+}
+
 const iree_task_topology_group_t* iree_task_topology_get_group(
     const iree_task_topology_t* topology, iree_host_size_t group_index) {
   if (group_index >= topology->group_count) return NULL;
@@ -82,6 +102,8 @@ void iree_task_topology_initialize_from_group_count(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, group_count);
 
   iree_task_topology_initialize(out_topology);
+  group_count =
+      iree_min(group_count, iree_task_topology_group_capacity(out_topology));
   for (iree_host_size_t i = 0; i < group_count; ++i) {
     iree_task_topology_group_t* group = &out_topology->groups[i];
     iree_task_topology_group_initialize(i, group);
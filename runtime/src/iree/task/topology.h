@@ -43,6 +43,10 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
+// In topologies with more than IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT groups the
+// mask of each group is relative to the block of groups containing it: bit N
+// of group G's mask indicates group (G / 64) * 64 + N. Groups only track
+// sharing with other groups in the same block.
 typedef uint64_t iree_task_topology_group_mask_t;
 
 #define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
@@ -55,14 +59,19 @@ typedef uint64_t iree_task_topology_group_mask_t;
 typedef struct iree_task_topology_group_t {
   // Group index within the topology matching a particular bit in
   // iree_task_topology_group_mask_t.
-  uint8_t group_index;
+  uint16_t group_index;
 
   // A name assigned to executor workers used for logging/tracing.
-  char name[32 - /*group_index*/ 1];
+  char name[32 - /*group_index*/ 2];
 
   // Processor index in the cpuinfo set.
   uint32_t processor_index;
 
+  // NUMA node ID the processor belongs to or IREE_TASK_TOPOLOGY_NODE_ID_ANY if
+  // unknown. Workers prefer to steal from other workers on the same node and
+  // place their local memory on it.
+  iree_task_topology_node_id_t node_id;
+
   // Ideal thread affinity for threads within this group.
   // All threads within the group share the same affinity and this is what
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
@@ -77,7 +86,7 @@ typedef struct iree_task_topology_group_t {
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
-void iree_task_topology_group_initialize(uint8_t group_index,
+void iree_task_topology_group_initialize(uint16_t group_index,
                                          iree_task_topology_group_t* out_group);
 
 //===----------------------------------------------------------------------===//
@@ -130,6 +139,12 @@ iree_host_size_t iree_task_topology_group_capacity(
 iree_host_size_t iree_task_topology_group_count(
     const iree_task_topology_t* topology);
 
+// Returns the number of distinct NUMA nodes the groups in the topology are
+// assigned to. Groups with an unknown node (IREE_TASK_TOPOLOGY_NODE_ID_ANY) are
+// not counted.
+iree_host_size_t iree_task_topology_node_count(
+    const iree_task_topology_t* topology);
+
 // Returns the group information for the given group index.
 const iree_task_topology_group_t* iree_task_topology_get_group(
     const iree_task_topology_t* topology, iree_host_size_t group_index);
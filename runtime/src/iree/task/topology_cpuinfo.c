@@ -134,33 +134,29 @@ static void iree_task_topology_set_affinity_from_processor(
 #endif  // cpuinfo-like platform field
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
-    }
-  }
-  return mask;
+// Returns true if |cache| is the same cache as |other_cache|.
+static bool iree_task_topology_is_same_cache(
+    const struct cpuinfo_cache* cache,
+    const struct cpuinfo_cache* other_cache) {
+  // cpuinfo uses a single cpuinfo_cache per physical cache that all processors
+  // sharing it reference.
+  return cache && cache == other_cache;
 }
 
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
+// Returns true if |processor| and |other_processor| share some level of the
+// cache hierarchy.
+static bool iree_task_topology_processors_share_cache(
+    const struct cpuinfo_processor* processor,
+    const struct cpuinfo_processor* other_processor) {
   // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
   // info purely for distribution and focus the group mask on lower-latency
   // caches?
-  return mask;
+  return iree_task_topology_is_same_cache(processor->cache.l1i,
+                                          other_processor->cache.l1i) ||
+         iree_task_topology_is_same_cache(processor->cache.l1d,
+                                          other_processor->cache.l1d) ||
+         iree_task_topology_is_same_cache(processor->cache.l2,
+                                          other_processor->cache.l2);
 }
 
 // Populates |our_group| with the information from |core|.
@@ -179,31 +175,36 @@ static void iree_task_topology_group_initialize_from_core(
       cpuinfo_get_processor(processor_i);
   iree_task_topology_set_affinity_from_processor(
       processor, &out_group->ideal_thread_affinity);
+
+  // Matches iree_task_topology_query_current_node.
+  out_group->node_id = core->cluster->cluster_id;
 }
 
-// Fixes constructive_sharing_mask values such that they represent other chosen
-// topology groups instead of processor indices. We do this so that code using
+// Computes constructive_sharing_mask values such that they represent other
+// chosen topology groups instead of processors. We do this so that code using
 // the topology groups doesn't need to know anything about which physical
 // processor IDs a particular group is mapped to.
 static void iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= 64 per block (and often <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
-
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
+
+    // Sharing masks are relative to the block of groups containing the group.
+    const iree_host_size_t block_base =
+        i - i % IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT;
+    const iree_host_size_t block_end =
+        iree_min(block_base + IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT,
+                 topology->group_count);
     iree_task_topology_group_mask_t group_mask = 0;
-    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
+    for (iree_host_size_t j = block_base; j < block_end; ++j) {
       if (i == j) continue;
       const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      if (iree_task_topology_processors_share_cache(
+              processor, cpuinfo_get_processor(other_group->processor_index))) {
+        group_mask |= 1ull << (j - block_base);
       }
     }
 
@@ -237,7 +238,8 @@ static bool iree_task_topology_core_filter_by_cluster_id(
 static void iree_task_topology_initialize_from_physical_cores_with_filter(
     iree_task_topology_core_filter_t filter_fn, uintptr_t filter_fn_data,
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
-  max_core_count = iree_min(max_core_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  max_core_count =
+      iree_min(max_core_count, iree_task_topology_group_capacity(out_topology));
   if (!iree_task_topology_is_cpuinfo_available()) {
     iree_task_topology_initialize_fallback(max_core_count, out_topology);
     return;
@@ -117,6 +117,29 @@ TEST(TopologyTest, FromGroupCount) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, NodeCount) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(8, &topology);
+
+  // Groups default to an unknown node.
+  for (iree_host_size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY,
+              iree_task_topology_get_group(&topology, i)->node_id);
+  }
+  EXPECT_EQ(0, iree_task_topology_node_count(&topology));
+
+  // Nodes are counted once regardless of how many groups are on them.
+  topology.groups[0].node_id = 0;
+  topology.groups[1].node_id = 0;
+  EXPECT_EQ(1, iree_task_topology_node_count(&topology));
+  topology.groups[4].node_id = 3;
+  topology.groups[5].node_id = 1;
+  topology.groups[6].node_id = 3;
+  EXPECT_EQ(3, iree_task_topology_node_count(&topology));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Verifies only that the |topology| is usable.
 // If we actually checked the contents here then we'd just be validating that
 // cpuinfo was working and the tests would become machine-dependent.
@@ -131,6 +154,9 @@ static void EnsureTopologyValid(iree_host_size_t max_group_count,
     const iree_task_topology_group_t* group =
         iree_task_topology_get_group(topology, i);
     EXPECT_EQ(i, group->group_index);
+    if (group->node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      EXPECT_LT(group->node_id, iree_task_topology_query_node_count());
+    }
   }
 }
 
@@ -79,16 +79,37 @@ static void iree_task_topology_assign_constructive_sharing(
         (group_mask.Mask & (1ull << group->ideal_thread_affinity.id))) {
       for (iree_host_size_t group_j = 0; group_j < topology->group_count;
            ++group_j) {
+        // Sharing masks are relative to the block of groups.
+        if (group_j / IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT !=
+            group_i / IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+          continue;
+        }
         iree_task_topology_group_t* other = &topology->groups[group_j];
         if (other->ideal_thread_affinity.group == group_mask.Group &&
             (group_mask.Mask & (1ull << other->ideal_thread_affinity.id))) {
-          group->constructive_sharing_mask |= 1ull << group_j;
+          group->constructive_sharing_mask |=
+              1ull << (group_j % IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
         }
       }
     }
   }
 }
 
+// Assigns |node_id| to all topology groups pinned to processors in
+// |group_mask|.
+static void iree_task_topology_assign_node(
+    iree_task_topology_t* topology, GROUP_AFFINITY group_mask,
+    iree_task_topology_node_id_t node_id) {
+  for (iree_host_size_t group_i = 0; group_i < topology->group_count;
+       ++group_i) {
+    iree_task_topology_group_t* group = &topology->groups[group_i];
+    if (group->ideal_thread_affinity.group == group_mask.Group &&
+        (group_mask.Mask & (1ull << group->ideal_thread_affinity.id))) {
+      group->node_id = node_id;
+    }
+  }
+}
+
 iree_status_t iree_task_topology_initialize_from_physical_cores(
     iree_task_topology_node_id_t node_id, iree_host_size_t max_core_count,
     iree_task_topology_t* out_topology) {
@@ -209,10 +230,11 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     }
   }
 
-  // Clamp the total number of cores available to the max provided.
-  // This is the number of topology groups we'll create.
+  // Clamp the total number of cores available to the max provided and what
+  // fits in the topology. This is the number of topology groups we'll create.
   iree_host_size_t used_core_count =
-      iree_min(selected_core_count, max_core_count);
+      iree_min(iree_min(selected_core_count, max_core_count),
+               iree_task_topology_group_capacity(out_topology));
 
   // Check if the current (base) processor is part of the filtered groups.
   // If so we perform rotation to favor cores other than the current one.
@@ -249,7 +271,7 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
           (((base_core_index + 1) % total_core_count) + used_core_index) %
           total_core_count;
     }
-    uint8_t group_index = (uint8_t)out_topology->group_count++;
+    uint16_t group_index = (uint16_t)out_topology->group_count++;
     iree_task_topology_group_t* group = &out_topology->groups[group_index];
     iree_task_topology_group_initialize(group_index, group);
     group->processor_index = (uint32_t)adjusted_core_index;
@@ -258,6 +280,25 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
         all_cores[adjusted_core_index], &group->ideal_thread_affinity);
   }
 
+  // Assign the NUMA node of each topology group.
+  for (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* p = all_relationships;
+       p < all_relationships_end;
+       p = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)((uintptr_t)p + p->Size)) {
+    if (p->Relationship == RelationNumaNode ||
+        p->Relationship == RelationNumaNodeEx) {
+      if (p->NumaNode.GroupCount == 0) {
+        iree_task_topology_assign_node(out_topology, p->NumaNode.GroupMask,
+                                       p->NumaNode.NodeNumber);
+      } else {
+        for (WORD i = 0; i < p->NumaNode.GroupCount; ++i) {
+          iree_task_topology_assign_node(out_topology,
+                                         p->NumaNode.GroupMasks[i],
+                                         p->NumaNode.NodeNumber);
+        }
+      }
+    }
+  }
+
   // Assign constructive sharing masks to each topology group. These indicate
   // which other topology groups share L3 caches (if any).
   for (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* p = all_relationships;
@@ -12,10 +12,20 @@ extern "C" {
 #endif  // __cplusplus
 
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+// Workers are partitioned into blocks of 64 that each use a uint64_t bitmask to
+// select workers (see affinity_set.h). Raising the limit only increases the
+// size of the fixed per-executor bookkeeping and the topology structure. It's
+// easy to go smaller if it's known that only a few workers will ever be used
+// (such as for devices with 2 cores).
+#if !defined(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (256)
+#endif  // !IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+
+// Alignment of each worker's local memory when the executor workers span
+// multiple NUMA nodes. Memory is placed on nodes with page granularity so each
+// worker's local memory must start on its own page for it to be placed on the
+// worker's node. This should be at least the system page size.
+#define IREE_TASK_EXECUTOR_NUMA_LOCAL_MEMORY_ALIGNMENT (4096)
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -77,8 +87,7 @@ extern "C" {
 // In real-time systems too few tasks is better (slightly more work for much
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
-#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT (64)
 
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
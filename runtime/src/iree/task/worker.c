@@ -21,24 +21,36 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
+// Returns the total number of workers in the block containing |worker|.
+// Used for tracing utilization as idle masks are tracked per block.
+static inline int iree_task_worker_block_size(iree_task_worker_t* worker) {
+  return iree_task_affinity_set_count_ones(iree_task_affinity_for_block(
+      worker->executor->worker_count, worker->worker_block_index));
+}
+
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+    const iree_task_affinity_set_t* node_sharing_masks,
+    iree_host_size_t stack_size, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->worker_bit = iree_task_affinity_bit_for_worker(worker_index);
+  out_worker->worker_block_index =
+      iree_task_affinity_block_for_worker(worker_index);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  memcpy(out_worker->node_sharing_masks, node_sharing_masks,
+         sizeof(out_worker->node_sharing_masks));
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
-  out_worker->local_memory = local_memory;
+  out_worker->local_memory = iree_byte_span_empty();
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
 
@@ -130,12 +142,17 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // get anything more posted to it) and then discarding everything we still
   // have a reference to.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
+  iree_task_queue_deinitialize(&worker->local_task_queue);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
-  iree_task_queue_deinitialize(&worker->local_task_queue);
+
+  if (worker->local_memory.data) {
+    iree_allocator_free_aligned(worker->executor->allocator,
+                                worker->local_memory.data);
+    worker->local_memory = iree_byte_span_empty();
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -231,9 +248,10 @@ static bool iree_task_worker_pump_once(
   // the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->executor, worker->worker_block_index,
+        worker->constructive_sharing_mask, worker->node_sharing_masks,
+        worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -277,14 +295,14 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // The masks are accessed with 'relaxed' order because they are just hints.
     iree_task_affinity_set_t old_idle_mask =
         iree_atomic_task_affinity_set_fetch_and(
-            &worker->executor->worker_idle_mask, ~worker->worker_bit,
-            iree_memory_order_relaxed);
+            &worker->executor->worker_idle_mask[worker->worker_block_index],
+            ~worker->worker_bit, iree_memory_order_relaxed);
     (void)old_idle_mask;
     IREE_TRACE_PLOT_VALUE_F32(
         worker->executor->trace_name,
         100.0f - 100.0f *
                      (iree_task_affinity_set_count_ones(old_idle_mask) - 1) /
-                     (float)worker->executor->worker_count);
+                     (float)iree_task_worker_block_size(worker));
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
@@ -316,14 +334,14 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // This ensures that if any other thread comes in and wants to give us
     // work we will properly coordinate/wake below.
     old_idle_mask = iree_atomic_task_affinity_set_fetch_or(
-        &worker->executor->worker_idle_mask, worker->worker_bit,
-        iree_memory_order_relaxed);
+        &worker->executor->worker_idle_mask[worker->worker_block_index],
+        worker->worker_bit, iree_memory_order_relaxed);
     (void)old_idle_mask;
     IREE_TRACE_PLOT_VALUE_F32(
         worker->executor->trace_name,
         100.0f - 100.0f *
                      (iree_task_affinity_set_count_ones(old_idle_mask) + 1) /
-                     (float)worker->executor->worker_count);
+                     (float)iree_task_worker_block_size(worker));
 
     // When we encounter a complete lack of work we can self-nominate to check
     // the global work queue and distribute work to other threads. Only one
@@ -364,6 +382,23 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   }
 }
 
+// Allocates the worker local memory sized by the executor options.
+static void iree_task_worker_allocate_local_memory(iree_task_worker_t* worker) {
+  iree_task_executor_t* executor = worker->executor;
+  if (executor->worker_local_memory_size == 0) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  void* local_memory = NULL;
+  iree_status_t status = iree_allocator_malloc_aligned(
+      executor->allocator, executor->worker_local_memory_size,
+      executor->worker_local_memory_alignment, /*offset=*/0, &local_memory);
+  if (iree_status_is_ok(status)) {
+    worker->local_memory =
+        iree_make_byte_span(local_memory, executor->worker_local_memory_size);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  iree_status_ignore(status);
+}
+
 // Thread entry point for each worker.
 static int iree_task_worker_main(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(thread_zone);
@@ -376,6 +411,12 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Allocate the local memory from the (pinned) worker thread so that the
+  // pages are first touched by the allocator zeroing them on the worker's NUMA
+  // node. Failures leave the local memory empty and dispatches requiring any
+  // fail with RESOURCE_EXHAUSTED.
+  iree_task_worker_allocate_local_memory(worker);
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
@@ -85,19 +85,30 @@ typedef struct iree_task_worker_t {
   iree_host_size_t worker_index;
 
   // Bit the worker represents in the various worker bitsets.
-  // Local to the executor owning the worker.
+  // Local to the worker block of the executor owning the worker.
   iree_task_affinity_set_t worker_bit;
 
+  // Index of the block of workers in the executor owning the worker that
+  // |worker_bit| is relative to.
+  iree_host_size_t worker_block_index;
+
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
 
-  // A bitmask of other group indices that share some level of the cache
-  // hierarchy. Workers of this group are more likely to constructively share
-  // some cache levels higher up with these other groups. For example, if the
-  // workers in a group all share an L2 cache then the groups indicated here may
-  // all share the same L3 cache.
+  // A bitmask of other group indices in the same worker block that share some
+  // level of the cache hierarchy. Workers of this group are more likely to
+  // constructively share some cache levels higher up with these other groups.
+  // For example, if the workers in a group all share an L2 cache then the
+  // groups indicated here may all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask per worker block of the workers on the same NUMA node as this
+  // worker. Workers with an unknown node are treated as being on all nodes.
+  // Theft prefers these workers over those on other nodes as their queued
+  // tasks are more likely to touch memory local to the node.
+  iree_task_affinity_set_t
+      node_sharing_masks[IREE_TASK_AFFINITY_SET_BLOCK_COUNT];
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
@@ -134,12 +145,15 @@ typedef struct iree_task_worker_t {
 
   // Pointer to local memory available for use exclusively by the worker.
   // The base address should be aligned to avoid false sharing with other
-  // workers.
+  // workers. The worker allocates the memory from its own thread upon startup
+  // so that on systems with first-touch NUMA policies the pages are placed on
+  // its node. Empty if the allocation failed such that dispatches requiring
+  // local memory fail instead.
   iree_byte_span_t local_memory;
 
-  // Worker-local FIFO queue containing the tasks that will be processed by the
-  // worker. This queue supports work-stealing by other workers if they run out
-  // of work of their own.
+  // Worker-local lock-free deque containing the tasks that will be processed by
+  // the worker. This queue supports work-stealing by other workers if they run
+  // out of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
   iree_task_queue_t local_task_queue;
 } iree_task_worker_t;
@@ -156,11 +170,15 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// |node_sharing_masks| contains one mask per worker block indicating which
+// workers are on the same NUMA node as this one.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
+    const iree_task_affinity_set_t* node_sharing_masks,
+    iree_host_size_t stack_size, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
@@ -0,0 +1,199 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks context creation with large modules. Modules with thousands of
+// exports and imports are built at runtime instead of being compiled as the
+// cost being measured is only a function of the number of functions: each
+// export references the same trivial internal function.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/flatcc/building.h"
+#include "iree/schemas/bytecode_module_def_builder.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
+#include "iree/vm/bytecode/utils/isa.h"
+
+namespace {
+
+// A module archive built with flatcc. Must be freed with
+// flatcc_builder_aligned_free.
+struct ModuleArchive {
+  void* data = nullptr;
+  size_t size = 0;
+};
+
+// Returns the name of the |i|th function exported by the exporter module.
+std::string FunctionName(int i) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "function_%d", i);
+  return buffer;
+}
+
+// Builds a bytecode module named "exporter" with |export_count| exports of a
+// single `() -> ()` internal function.
+ModuleArchive BuildExporterModule(int export_count) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_vm_BytecodeModuleDef_start_as_root_with_size(&builder);
+
+  // vm.func @function() { vm.return }
+  const uint8_t bytecode[] = {
+      IREE_VM_OP_CORE_Block,
+      IREE_VM_OP_CORE_Return,
+      0x00,
+      0x00,  // operand count
+  };
+  flatbuffers_uint8_vec_ref_t bytecode_ref =
+      flatbuffers_uint8_vec_create(&builder, bytecode, sizeof(bytecode));
+  iree_vm_FunctionDescriptor_t descriptor;
+  iree_vm_FunctionDescriptor_assign(&descriptor, /*bytecode_offset=*/0,
+                                    /*bytecode_length=*/sizeof(bytecode),
+                                    /*requirements=*/0, /*reserved=*/0,
+                                    /*block_count=*/1,
+                                    /*i32_register_count=*/0,
+                                    /*ref_register_count=*/0);
+  iree_vm_FunctionDescriptor_vec_ref_t descriptors_ref =
+      iree_vm_FunctionDescriptor_vec_create(&builder, &descriptor, 1);
+  iree_vm_FunctionSignatureDef_ref_t signature_ref =
+      iree_vm_FunctionSignatureDef_create(
+          &builder, flatbuffers_string_create_str(&builder, "0v_v"),
+          /*attrs=*/0);
+  iree_vm_FunctionSignatureDef_vec_ref_t signatures_ref =
+      iree_vm_FunctionSignatureDef_vec_create(&builder, &signature_ref, 1);
+
+  std::vector<iree_vm_ExportFunctionDef_ref_t> export_refs(export_count);
+  for (int i = 0; i < export_count; ++i) {
+    std::string local_name = FunctionName(i);
+    export_refs[i] = iree_vm_ExportFunctionDef_create(
+        &builder, flatbuffers_string_create_str(&builder, local_name.c_str()),
+        /*internal_ordinal=*/0);
+  }
+  iree_vm_ExportFunctionDef_vec_ref_t exports_ref =
+      iree_vm_ExportFunctionDef_vec_create(&builder, export_refs.data(),
+                                           export_refs.size());
+
+  iree_vm_BytecodeModuleDef_name_create_str(&builder, "exporter");
+  iree_vm_BytecodeModuleDef_exported_functions_add(&builder, exports_ref);
+  iree_vm_BytecodeModuleDef_function_signatures_add(&builder, signatures_ref);
+  iree_vm_BytecodeModuleDef_function_descriptors_add(&builder,
+                                                     descriptors_ref);
+  iree_vm_BytecodeModuleDef_bytecode_version_add(
+      &builder,
+      (IREE_VM_BYTECODE_VERSION_MAJOR << 16) | IREE_VM_BYTECODE_VERSION_MINOR);
+  iree_vm_BytecodeModuleDef_bytecode_data_add(&builder, bytecode_ref);
+  iree_vm_BytecodeModuleDef_end_as_root(&builder);
+
+  ModuleArchive archive;
+  archive.data =
+      flatcc_builder_finalize_aligned_buffer(&builder, &archive.size);
+  flatcc_builder_clear(&builder);
+  return archive;
+}
+
+// Builds a bytecode module named "importer" that imports all |import_count|
+// functions of the exporter module in reverse order.
+ModuleArchive BuildImporterModule(int import_count) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_vm_BytecodeModuleDef_start_as_root_with_size(&builder);
+
+  iree_vm_FunctionSignatureDef_ref_t signature_ref =
+      iree_vm_FunctionSignatureDef_create(
+          &builder, flatbuffers_string_create_str(&builder, "0v_v"),
+          /*attrs=*/0);
+  std::vector<iree_vm_ImportFunctionDef_ref_t> import_refs(import_count);
+  for (int i = 0; i < import_count; ++i) {
+    std::string full_name = "exporter." + FunctionName(import_count - i - 1);
+    import_refs[i] = iree_vm_ImportFunctionDef_create(
+        &builder, flatbuffers_string_create_str(&builder, full_name.c_str()),
+        signature_ref, iree_vm_ImportFlagBits_REQUIRED);
+  }
+  iree_vm_ImportFunctionDef_vec_ref_t imports_ref =
+      iree_vm_ImportFunctionDef_vec_create(&builder, import_refs.data(),
+                                           import_refs.size());
+
+  iree_vm_BytecodeModuleDef_name_create_str(&builder, "importer");
+  iree_vm_BytecodeModuleDef_imported_functions_add(&builder, imports_ref);
+  iree_vm_BytecodeModuleDef_bytecode_version_add(
+      &builder,
+      (IREE_VM_BYTECODE_VERSION_MAJOR << 16) | IREE_VM_BYTECODE_VERSION_MINOR);
+  iree_vm_BytecodeModuleDef_end_as_root(&builder);
+
+  ModuleArchive archive;
+  archive.data =
+      flatcc_builder_finalize_aligned_buffer(&builder, &archive.size);
+  flatcc_builder_clear(&builder);
+  return archive;
+}
+
+iree_vm_module_t* CreateModule(iree_vm_instance_t* instance,
+                               const ModuleArchive& archive) {
+  iree_vm_module_t* module = nullptr;
+  IREE_CHECK_OK(iree_vm_bytecode_module_create(
+      instance, iree_make_const_byte_span(archive.data, archive.size),
+      iree_allocator_null(), iree_allocator_system(), &module));
+  return module;
+}
+
+// Measures loading a module with many exports, including verification and
+// building its function name index.
+static void BM_ModuleCreate(benchmark::State& state) {
+  const int export_count = static_cast<int>(state.range(0));
+  iree_vm_instance_t* instance = nullptr;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  ModuleArchive exporter_archive = BuildExporterModule(export_count);
+
+  for (auto _ : state) {
+    iree_vm_module_t* module = CreateModule(instance, exporter_archive);
+    benchmark::DoNotOptimize(module);
+    iree_vm_module_release(module);
+  }
+  state.SetItemsProcessed(state.iterations() * export_count);
+
+  flatcc_builder_aligned_free(exporter_archive.data);
+  iree_vm_instance_release(instance);
+}
+BENCHMARK(BM_ModuleCreate)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Measures creating a context in which one module imports every export of
+// another. Each import is resolved by looking up its name in the exporter.
+static void BM_ContextCreate(benchmark::State& state) {
+  const int function_count = static_cast<int>(state.range(0));
+  iree_vm_instance_t* instance = nullptr;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  ModuleArchive exporter_archive = BuildExporterModule(function_count);
+  ModuleArchive importer_archive = BuildImporterModule(function_count);
+  iree_vm_module_t* modules[2] = {
+      CreateModule(instance, exporter_archive),
+      CreateModule(instance, importer_archive),
+  };
+
+  for (auto _ : state) {
+    iree_vm_context_t* context = nullptr;
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules), modules,
+        iree_allocator_system(), &context));
+    benchmark::DoNotOptimize(context);
+    iree_vm_context_release(context);
+  }
+  state.SetItemsProcessed(state.iterations() * function_count);
+
+  iree_vm_module_release(modules[0]);
+  iree_vm_module_release(modules[1]);
+  flatcc_builder_aligned_free(importer_archive.data);
+  flatcc_builder_aligned_free(exporter_archive.data);
+  iree_vm_instance_release(instance);
+}
+BENCHMARK(BM_ContextCreate)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace
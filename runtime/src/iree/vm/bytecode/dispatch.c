@@ -653,6 +653,28 @@ iree_status_t iree_vm_bytecode_dispatch_resume(
                                    call_results);
 }
 
+// Op bodies shared between the op and the fused superinstructions it begins.
+#define DISPATCH_OP_BODY_CORE_GlobalLoadRef()                             \
+  {                                                                       \
+    uint32_t global = VM_DecGlobalAttr("global");                         \
+    IREE_ASSERT(global < module_state->global_ref_count);                 \
+    const iree_vm_type_def_t type_def = VM_DecTypeOf("value");            \
+    bool result_is_move;                                                  \
+    iree_vm_ref_t* result = VM_DecResultRegRef("value", &result_is_move); \
+    iree_vm_ref_t* global_ref = &module_state->global_ref_table[global];  \
+    IREE_RETURN_IF_ERROR(iree_vm_ref_retain_or_move_checked(              \
+        result_is_move, global_ref, iree_vm_type_def_as_ref(type_def),    \
+        result));                                                         \
+  }
+#define DISPATCH_OP_BODY_CORE_CmpNZRef()                                       \
+  {                                                                            \
+    bool operand_is_move;                                                      \
+    iree_vm_ref_t* operand = VM_DecOperandRegRef("operand", &operand_is_move); \
+    int32_t* result = VM_DecResultRegI32("result");                            \
+    *result = vm_cmp_nz_ref(operand);                                          \
+    if (operand_is_move) iree_vm_ref_release(operand);                         \
+  }
+
 static iree_status_t iree_vm_bytecode_dispatch(
     iree_vm_stack_t* IREE_RESTRICT stack,
     iree_vm_bytecode_module_t* IREE_RESTRICT module,
@@ -672,9 +694,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
   const iree_vm_bytecode_module_state_t* IREE_RESTRICT module_state =
       (iree_vm_bytecode_module_state_t*)current_frame->module_state;
   const uint8_t* IREE_RESTRICT bytecode_data =
-      module->bytecode_data.data +
-      module->function_descriptor_table[current_frame->function.ordinal]
-          .bytecode_offset;
+      iree_vm_bytecode_function_dispatch_data(module,
+                                              current_frame->function.ordinal);
 
   int32_t* IREE_RESTRICT regs_i32 = regs.i32;
   IREE_BUILTIN_ASSUME_ALIGNED(regs_i32, 16);
@@ -779,17 +800,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
                           value);
     });
 
-    DISPATCH_OP(CORE, GlobalLoadRef, {
-      uint32_t global = VM_DecGlobalAttr("global");
-      IREE_ASSERT(global < module_state->global_ref_count);
-      const iree_vm_type_def_t type_def = VM_DecTypeOf("value");
-      bool result_is_move;
-      iree_vm_ref_t* result = VM_DecResultRegRef("value", &result_is_move);
-      iree_vm_ref_t* global_ref = &module_state->global_ref_table[global];
-      IREE_RETURN_IF_ERROR(iree_vm_ref_retain_or_move_checked(
-          result_is_move, global_ref, iree_vm_type_def_as_ref(type_def),
-          result));
-    });
+    DISPATCH_OP(CORE, GlobalLoadRef, DISPATCH_OP_BODY_CORE_GlobalLoadRef());
 
     DISPATCH_OP(CORE, GlobalStoreRef, {
       uint32_t global = VM_DecGlobalAttr("global");
@@ -1579,13 +1590,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       if (lhs_is_move) iree_vm_ref_release(lhs);
       if (rhs_is_move) iree_vm_ref_release(rhs);
     });
-    DISPATCH_OP(CORE, CmpNZRef, {
-      bool operand_is_move;
-      iree_vm_ref_t* operand = VM_DecOperandRegRef("operand", &operand_is_move);
-      int32_t* result = VM_DecResultRegI32("result");
-      *result = vm_cmp_nz_ref(operand);
-      if (operand_is_move) iree_vm_ref_release(operand);
-    });
+    DISPATCH_OP(CORE, CmpNZRef, DISPATCH_OP_BODY_CORE_CmpNZRef());
 
     //===------------------------------------------------------------------===//
     // Control flow
@@ -1651,8 +1656,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
             stack, current_frame->function.module, function_ordinal,
             src_reg_list, dst_reg_list, &current_frame, &regs));
         bytecode_data =
-            module->bytecode_data.data +
-            module->function_descriptor_table[function_ordinal].bytecode_offset;
+            iree_vm_bytecode_function_dispatch_data(module, function_ordinal);
       }
 
       // Restore the local dispatch variables that may have changed during the
@@ -1719,10 +1723,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
           stack, current_frame, regs, src_reg_list, &current_frame, &regs));
 
       // Reset dispatch state so we can continue executing in the caller.
-      bytecode_data =
-          module->bytecode_data.data +
-          module->function_descriptor_table[current_frame->function.ordinal]
-              .bytecode_offset;
+      bytecode_data = iree_vm_bytecode_function_dispatch_data(
+          module, current_frame->function.ordinal);
       regs_i32 = regs.i32;
       IREE_BUILTIN_ASSUME_ALIGNED(regs_i32, 16);
       regs_ref = regs.ref;
@@ -2099,6 +2101,24 @@ static iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP(CORE, PrefixExtF64,
                 { return iree_make_status(IREE_STATUS_UNIMPLEMENTED); });
 
+    //===------------------------------------------------------------------===//
+    // Fused superinstructions (see fusion.h)
+    //===------------------------------------------------------------------===//
+
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+    DISPATCH_FUSED_OP_CORE_BINARY_I32(CmpEQI32, vm_cmp_eq_i32, CondBranch);
+    DISPATCH_FUSED_OP_CORE_BINARY_I32(CmpNEI32, vm_cmp_ne_i32, CondBranch);
+    DISPATCH_FUSED_OP_CORE_BINARY_I32(CmpLTI32S, vm_cmp_lt_i32s, CondBranch);
+    DISPATCH_FUSED_OP_CORE_BINARY_I32(CmpLTI32U, vm_cmp_lt_i32u, CondBranch);
+    DISPATCH_FUSED_OP_CORE_UNARY_I32(CmpNZI32, vm_cmp_nz_i32, CondBranch);
+    DISPATCH_FUSED_OP(CORE, CmpNZRef, CondBranch,
+                      DISPATCH_OP_BODY_CORE_CmpNZRef());
+    DISPATCH_FUSED_OP(CORE, GlobalLoadRef, Call,
+                      DISPATCH_OP_BODY_CORE_GlobalLoadRef());
+    DISPATCH_FUSED_OP(CORE, GlobalLoadRef, CallVariadic,
+                      DISPATCH_OP_BODY_CORE_GlobalLoadRef());
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
     // NOLINTNEXTLINE(misc-static-assert)
     DISPATCH_UNHANDLED_CORE();
   }
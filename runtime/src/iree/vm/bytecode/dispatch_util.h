@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/vm/bytecode/fusion.h"
 #include "iree/vm/bytecode/module_impl.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
@@ -93,6 +94,19 @@ static inline iree_vm_type_def_t iree_vm_map_type(
   return module->type_table[type_id];
 }
 
+// Returns the bytecode executed by the dispatcher for |function_ordinal|.
+// When fusion is enabled this is the rewritten copy of the module bytecode.
+static inline const uint8_t* iree_vm_bytecode_function_dispatch_data(
+    iree_vm_bytecode_module_t* module, uint32_t function_ordinal) {
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  const uint8_t* base_data = module->dispatch_bytecode_data.data;
+#else
+  const uint8_t* base_data = module->bytecode_data.data;
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  return base_data +
+         module->function_descriptor_table[function_ordinal].bytecode_offset;
+}
+
 //===----------------------------------------------------------------------===//
 // Debugging utilities
 //===----------------------------------------------------------------------===//
@@ -116,7 +130,7 @@ static inline iree_vm_type_def_t iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
-#if defined(IREE_COMPILER_CLANG) && \
+#if defined(IREE_COMPILER_GCC_COMPAT) && \
     IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 #define IREE_DISPATCH_MODE_COMPUTED_GOTO 1
 #else
@@ -252,7 +266,17 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
 #define END_DISPATCH_CORE()
 
 #define DECLARE_DISPATCH_CORE_OPC(ordinal, name) &&_dispatch_CORE_##name,
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+// Reserved opcodes map to fused superinstructions if one is assigned and
+// otherwise to the unhandled label. The selection is a constant expression.
+#define DECLARE_DISPATCH_CORE_FUSED(ordinal, fused_ordinal, first, second) \
+  (ordinal) == (fused_ordinal) ? &&_dispatch_CORE_##first##_##second:
+#define DECLARE_DISPATCH_CORE_RSV(ordinal)                                 \
+  (IREE_VM_OP_CORE_FUSED_TABLE(DECLARE_DISPATCH_CORE_FUSED, ordinal) && \
+   _dispatch_unhandled),
+#else
 #define DECLARE_DISPATCH_CORE_RSV(ordinal) &&_dispatch_unhandled,
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
 #define DEFINE_DISPATCH_TABLE_CORE()                                    \
   static const void* kDispatchTable_CORE[256] = {IREE_VM_OP_CORE_TABLE( \
       DECLARE_DISPATCH_CORE_OPC, DECLARE_DISPATCH_CORE_RSV)};
@@ -298,6 +322,15 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
   body;                                                               \
   goto* kDispatchTable_CORE[bytecode_data[pc++]];
 
+// Executes |body| for the first op of a fused pair and then jumps directly to
+// the handler of the second op, skipping its opcode.
+#define DISPATCH_FUSED_OP(ext, first, second, body)                 \
+  _dispatch_##ext##_##first##_##second:;                            \
+  IREE_DISPATCH_TRACE_INSTRUCTION(IREE_VM_PC_OFFSET_##ext, #first); \
+  body;                                                             \
+  ++pc;                                                             \
+  goto _dispatch_##ext##_##second;
+
 #define BEGIN_DISPATCH_PREFIX(op_name, ext)                                   \
   _dispatch_CORE_##op_name : goto* kDispatchTable_##ext[bytecode_data[pc++]]; \
   while (1)
@@ -336,6 +369,14 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
     body;                                                               \
   } break;
 
+// Executes |body| for the first op of a fused pair. The second op is then
+// dispatched normally as its opcode is left unchanged in the bytecode.
+#define DISPATCH_FUSED_OP(ext, first, second, body)                   \
+  case IREE_VM_OP_##ext##_##first##_##second: {                       \
+    IREE_DISPATCH_TRACE_INSTRUCTION(IREE_VM_PC_OFFSET_##ext, #first); \
+    body;                                                             \
+  } break;
+
 #define BEGIN_DISPATCH_PREFIX(op_name, ext) \
   case IREE_VM_OP_CORE_##op_name: {         \
     switch (bytecode_data[pc++])
@@ -369,6 +410,21 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
     *result = op_func(lhs, rhs);                      \
   });
 
+#define DISPATCH_FUSED_OP_CORE_UNARY_I32(op_name, op_func, next_op_name) \
+  DISPATCH_FUSED_OP(CORE, op_name, next_op_name, {                       \
+    int32_t operand = VM_DecOperandRegI32("operand");                    \
+    int32_t* result = VM_DecResultRegI32("result");                      \
+    *result = op_func(operand);                                          \
+  });
+
+#define DISPATCH_FUSED_OP_CORE_BINARY_I32(op_name, op_func, next_op_name) \
+  DISPATCH_FUSED_OP(CORE, op_name, next_op_name, {                        \
+    int32_t lhs = VM_DecOperandRegI32("lhs");                             \
+    int32_t rhs = VM_DecOperandRegI32("rhs");                             \
+    int32_t* result = VM_DecResultRegI32("result");                       \
+    *result = op_func(lhs, rhs);                                          \
+  });
+
 #define DISPATCH_OP_CORE_BINARY_I64(op_name, op_func) \
   DISPATCH_OP(CORE, op_name, {                        \
     int64_t lhs = VM_DecOperandRegI64("lhs");         \
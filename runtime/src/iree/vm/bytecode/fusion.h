@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_FUSION_H_
+#define IREE_VM_BYTECODE_FUSION_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/bytecode/utils/isa.h"
+
+//===----------------------------------------------------------------------===//
+// Fused superinstructions
+//===----------------------------------------------------------------------===//
+// Superinstructions are runtime-only opcodes that are never serialized. They
+// are assigned from the reserved CORE opcode range and written over the opcode
+// of the first op of a fusible pair in the dispatch copy of the bytecode after
+// the function has been verified. The operands of both ops are left unchanged
+// such that all byte offsets (branch targets, frame pcs, source locations)
+// remain valid: the fused handler executes the first op and then continues
+// directly into the handler of the second op without going back through the
+// dispatch table.
+//
+// Because the verifier operates on the original bytecode any fused opcodes
+// present in input modules are rejected as unrecognized.
+//
+// Pairs are chosen from sequences common in host-side scheduling code: loop
+// and guard conditions feeding a branch and globals (devices, executables,
+// etc) loaded immediately before being passed to an import.
+
+// X-macro table of fused opcodes as (ordinal, first op, second op).
+// Fused handlers continue into the unfused handler of the second op and as
+// such second ops must never begin another pair.
+// |arg| is passed through to each |FUSED| invocation.
+#define IREE_VM_OP_CORE_FUSED_TABLE(FUSED, arg) \
+  FUSED(arg, 0xF0, CmpEQI32, CondBranch)        \
+  FUSED(arg, 0xF1, CmpNEI32, CondBranch)        \
+  FUSED(arg, 0xF2, CmpLTI32S, CondBranch)       \
+  FUSED(arg, 0xF3, CmpLTI32U, CondBranch)       \
+  FUSED(arg, 0xF4, CmpNZI32, CondBranch)        \
+  FUSED(arg, 0xF5, CmpNZRef, CondBranch)        \
+  FUSED(arg, 0xF6, GlobalLoadRef, Call)         \
+  FUSED(arg, 0xF7, GlobalLoadRef, CallVariadic)
+
+#define IREE_VM_OP_CORE_FUSED_ENUM(arg, ordinal, first, second) \
+  IREE_VM_OP_CORE_##first##_##second = ordinal,
+enum {
+  IREE_VM_OP_CORE_FUSED_TABLE(IREE_VM_OP_CORE_FUSED_ENUM, 0)
+};
+#undef IREE_VM_OP_CORE_FUSED_ENUM
+
+// Returns the fused opcode for |first_opcode| followed by |second_opcode| or
+// |first_opcode| if the pair cannot be fused.
+static inline uint8_t iree_vm_bytecode_fuse_opcodes(uint8_t first_opcode,
+                                                    uint8_t second_opcode) {
+#define IREE_VM_OP_CORE_FUSED_MATCH(arg, ordinal, first, second) \
+  if (first_opcode == IREE_VM_OP_CORE_##first &&                 \
+      second_opcode == IREE_VM_OP_CORE_##second) {               \
+    return ordinal;                                              \
+  }
+  IREE_VM_OP_CORE_FUSED_TABLE(IREE_VM_OP_CORE_FUSED_MATCH, 0)
+#undef IREE_VM_OP_CORE_FUSED_MATCH
+  return first_opcode;
+}
+
+#endif  // IREE_VM_BYTECODE_FUSION_H_
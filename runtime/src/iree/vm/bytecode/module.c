@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/math.h"
 #include "iree/vm/bytecode/archive.h"
 #include "iree/vm/bytecode/module_impl.h"
 #include "iree/vm/bytecode/verifier.h"
@@ -22,6 +23,93 @@ static bool iree_vm_flatbuffer_strcmp(flatbuffers_string_t lhs,
   return x != 0 ? x : lhs_size < rhs.size ? -1 : lhs_size > rhs.size;
 }
 
+//===----------------------------------------------------------------------===//
+// Function name indices
+//===----------------------------------------------------------------------===//
+
+// Returns the name of the function at |ordinal| in a FlatBuffer vector.
+typedef flatbuffers_string_t (*iree_vm_bytecode_function_name_fn_t)(
+    const void* functions, iree_host_size_t ordinal);
+
+static flatbuffers_string_t iree_vm_bytecode_import_function_name(
+    const void* functions, iree_host_size_t ordinal) {
+  return iree_vm_ImportFunctionDef_full_name(iree_vm_ImportFunctionDef_vec_at(
+      (iree_vm_ImportFunctionDef_vec_t)functions, ordinal));
+}
+
+static flatbuffers_string_t iree_vm_bytecode_export_function_name(
+    const void* functions, iree_host_size_t ordinal) {
+  return iree_vm_ExportFunctionDef_local_name(iree_vm_ExportFunctionDef_vec_at(
+      (iree_vm_ExportFunctionDef_vec_t)functions, ordinal));
+}
+
+// FNV-1a hash of a function name.
+static uint32_t iree_vm_bytecode_function_name_hash(const char* data,
+                                                    iree_host_size_t size) {
+  uint32_t hash = 0x811C9DC5u;
+  for (iree_host_size_t i = 0; i < size; ++i) {
+    hash ^= (uint8_t)data[i];
+    hash *= 0x01000193u;
+  }
+  return hash;
+}
+
+// Returns the number of slots used to index |count| functions. Tables are kept
+// at most half full so that probe sequences stay short.
+static iree_host_size_t iree_vm_bytecode_function_name_index_slot_count(
+    iree_host_size_t count) {
+  return count ? iree_math_round_up_to_pow2_u32((uint32_t)count * 2) : 0;
+}
+
+// Initializes |out_index| with the names of |count| |functions| using
+// |slot_count| |slots| storage.
+static void iree_vm_bytecode_function_name_index_initialize(
+    const void* functions, iree_host_size_t count,
+    iree_vm_bytecode_function_name_fn_t get_name, iree_host_size_t slot_count,
+    uint32_t* slots, iree_vm_bytecode_function_name_index_t* out_index) {
+  out_index->mask = slot_count ? (uint32_t)slot_count - 1 : 0;
+  out_index->slots = slot_count ? slots : NULL;
+  if (!slot_count) return;
+  memset(slots, 0, slot_count * sizeof(*slots));
+  for (iree_host_size_t ordinal = 0; ordinal < count; ++ordinal) {
+    flatbuffers_string_t name = get_name(functions, ordinal);
+    const size_t name_length = flatbuffers_string_len(name);
+    uint32_t i = iree_vm_bytecode_function_name_hash(name, name_length) &
+                 out_index->mask;
+    for (;; i = (i + 1) & out_index->mask) {
+      if (!slots[i]) {
+        slots[i] = (uint32_t)ordinal + 1;
+        break;
+      }
+      // Duplicate names resolve to the first function with the name.
+      flatbuffers_string_t slot_name = get_name(functions, slots[i] - 1);
+      if (flatbuffers_string_len(slot_name) == name_length &&
+          memcmp(slot_name, name, name_length) == 0) {
+        break;
+      }
+    }
+  }
+}
+
+// Looks up the ordinal of the function with the given |name| in |index|.
+// Returns false if not found.
+static bool iree_vm_bytecode_function_name_index_lookup(
+    const iree_vm_bytecode_function_name_index_t* index, const void* functions,
+    iree_vm_bytecode_function_name_fn_t get_name, iree_string_view_t name,
+    iree_host_size_t* out_ordinal) {
+  if (!index->slots) return false;
+  for (uint32_t i = iree_vm_bytecode_function_name_hash(name.data, name.size) &
+                    index->mask;
+       index->slots[i]; i = (i + 1) & index->mask) {
+    const iree_host_size_t ordinal = index->slots[i] - 1;
+    if (iree_vm_flatbuffer_strcmp(get_name(functions, ordinal), name) == 0) {
+      *out_ordinal = ordinal;
+      return true;
+    }
+  }
+  return false;
+}
+
 // Resolves a type through either builtin rules or the ref registered types.
 static bool iree_vm_bytecode_module_resolve_type(
     iree_vm_instance_t* instance, iree_vm_TypeDef_table_t type_def,
@@ -267,39 +355,31 @@ static iree_status_t iree_vm_bytecode_module_lookup_function(
   out_function->linkage = linkage;
   out_function->module = &module->interface;
 
-  // NOTE: we could organize exports alphabetically so we could bsearch.
+  iree_host_size_t ordinal = 0;
   if (linkage == IREE_VM_FUNCTION_LINKAGE_IMPORT ||
       linkage == IREE_VM_FUNCTION_LINKAGE_IMPORT_OPTIONAL) {
     iree_vm_ImportFunctionDef_vec_t imported_functions =
         iree_vm_BytecodeModuleDef_imported_functions(module->def);
-    for (iree_host_size_t ordinal = 0;
-         ordinal < iree_vm_ImportFunctionDef_vec_len(imported_functions);
-         ++ordinal) {
+    if (iree_vm_bytecode_function_name_index_lookup(
+            &module->import_name_index, imported_functions,
+            iree_vm_bytecode_import_function_name, name, &ordinal)) {
       iree_vm_ImportFunctionDef_table_t import_def =
           iree_vm_ImportFunctionDef_vec_at(imported_functions, ordinal);
-      if (iree_vm_flatbuffer_strcmp(
-              iree_vm_ImportFunctionDef_full_name(import_def), name) == 0) {
-        out_function->ordinal = ordinal;
-        if (iree_all_bits_set(iree_vm_ImportFunctionDef_flags(import_def),
-                              iree_vm_ImportFlagBits_OPTIONAL)) {
-          out_function->linkage = IREE_VM_FUNCTION_LINKAGE_IMPORT_OPTIONAL;
-        }
-        return iree_ok_status();
+      out_function->ordinal = ordinal;
+      if (iree_all_bits_set(iree_vm_ImportFunctionDef_flags(import_def),
+                            iree_vm_ImportFlagBits_OPTIONAL)) {
+        out_function->linkage = IREE_VM_FUNCTION_LINKAGE_IMPORT_OPTIONAL;
       }
+      return iree_ok_status();
     }
   } else if (linkage == IREE_VM_FUNCTION_LINKAGE_EXPORT) {
     iree_vm_ExportFunctionDef_vec_t exported_functions =
         iree_vm_BytecodeModuleDef_exported_functions(module->def);
-    for (iree_host_size_t ordinal = 0;
-         ordinal < iree_vm_ExportFunctionDef_vec_len(exported_functions);
-         ++ordinal) {
-      iree_vm_ExportFunctionDef_table_t export_def =
-          iree_vm_ExportFunctionDef_vec_at(exported_functions, ordinal);
-      if (iree_vm_flatbuffer_strcmp(
-              iree_vm_ExportFunctionDef_local_name(export_def), name) == 0) {
-        out_function->ordinal = ordinal;
-        return iree_ok_status();
-      }
+    if (iree_vm_bytecode_function_name_index_lookup(
+            &module->export_name_index, exported_functions,
+            iree_vm_bytecode_export_function_name, name, &ordinal)) {
+      out_function->ordinal = ordinal;
+      return iree_ok_status();
     }
   }
 
@@ -832,12 +912,36 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  flatbuffers_uint8_vec_t bytecode_data =
+      iree_vm_BytecodeModuleDef_bytecode_data(module_def);
+  size_t dispatch_bytecode_size = 0;
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  dispatch_bytecode_size =
+      iree_host_align(flatbuffers_uint8_vec_len(bytecode_data), 16);
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
+  iree_vm_ImportFunctionDef_vec_t imported_functions =
+      iree_vm_BytecodeModuleDef_imported_functions(module_def);
+  iree_vm_ExportFunctionDef_vec_t exported_functions =
+      iree_vm_BytecodeModuleDef_exported_functions(module_def);
+  iree_host_size_t import_count =
+      iree_vm_ImportFunctionDef_vec_len(imported_functions);
+  iree_host_size_t export_count =
+      iree_vm_ExportFunctionDef_vec_len(exported_functions);
+  iree_host_size_t import_slot_count =
+      iree_vm_bytecode_function_name_index_slot_count(import_count);
+  iree_host_size_t export_slot_count =
+      iree_vm_bytecode_function_name_index_slot_count(export_count);
+  size_t name_index_size =
+      (import_slot_count + export_slot_count) * sizeof(uint32_t);
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    dispatch_bytecode_size + name_index_size,
+                                (void**)&module));
   module->allocator = allocator;
 
   iree_vm_FunctionDescriptor_vec_t function_descriptors =
@@ -846,15 +950,37 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
       iree_vm_FunctionDescriptor_vec_len(function_descriptors);
   module->function_descriptor_table = function_descriptors;
 
-  flatbuffers_uint8_vec_t bytecode_data =
-      iree_vm_BytecodeModuleDef_bytecode_data(module_def);
   module->bytecode_data = iree_make_const_byte_span(
       bytecode_data, flatbuffers_uint8_vec_len(bytecode_data));
 
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  // The dispatch copy starts as the original bytecode and has fused opcodes
+  // written into it as each function is verified below.
+  module->dispatch_bytecode_data = iree_make_byte_span(
+      (uint8_t*)module + sizeof(*module) + type_table_size +
+          rodata_ref_table_size,
+      module->bytecode_data.data_length);
+  memcpy(module->dispatch_bytecode_data.data, module->bytecode_data.data,
+         module->bytecode_data.data_length);
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
   module->archive_contents = archive_contents;
   module->archive_allocator = archive_allocator;
   module->def = module_def;
 
+  IREE_TRACE_ZONE_BEGIN_NAMED(z2, "iree_vm_bytecode_module_index_names");
+  uint32_t* name_index_slots =
+      (uint32_t*)((uint8_t*)module + sizeof(*module) + type_table_size +
+                  rodata_ref_table_size + dispatch_bytecode_size);
+  iree_vm_bytecode_function_name_index_initialize(
+      imported_functions, import_count, iree_vm_bytecode_import_function_name,
+      import_slot_count, name_index_slots, &module->import_name_index);
+  iree_vm_bytecode_function_name_index_initialize(
+      exported_functions, export_count, iree_vm_bytecode_export_function_name,
+      export_slot_count, name_index_slots + import_slot_count,
+      &module->export_name_index);
+  IREE_TRACE_ZONE_END(z2);
+
   module->type_count = iree_vm_TypeDef_vec_len(type_defs);
   iree_status_t resolve_status = iree_vm_bytecode_module_resolve_types(
       instance, type_defs, module->type_table);
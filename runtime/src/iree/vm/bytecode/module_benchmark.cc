@@ -71,10 +71,15 @@ static iree_status_t native_import_module_create(
 }
 
 // Benchmarks the given exported function, optionally passing in arguments.
+// If |ops_per_item| is provided the average time per executed op is reported
+// as the `time/op` counter. Compare builds with and without
+// IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE and
+// IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE to see the effect of dispatch modes.
 static iree_status_t RunFunction(benchmark::State& state,
                                  iree_string_view_t function_name,
                                  std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+                                 int result_count, int64_t batch_size = 1,
+                                 int64_t ops_per_item = 0) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -124,6 +129,11 @@ static iree_status_t RunFunction(benchmark::State& state,
         bytecode_module->begin_call(bytecode_module->self, stack, call));
   }
   iree_vm_stack_deinitialize(stack);
+  if (ops_per_item > 0) {
+    state.counters["time/op"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * ops_per_item),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  }
 
   iree_vm_module_release(import_module);
   iree_vm_module_release(bytecode_module);
@@ -314,15 +324,30 @@ static void BM_LoopSumReference(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopSumReference)->Arg(100000);
 
+// add + cmp.lt.i32.s + cond_br per iteration.
 static void BM_LoopSumBytecode(benchmark::State& state) {
   IREE_CHECK_OK(RunFunction(
       state, iree_make_cstring_view("bytecode_module_benchmark.loop_sum"),
       {static_cast<int32_t>(state.range(0))},
       /*result_count=*/1,
-      /*batch_size=*/state.range(0)));
+      /*batch_size=*/state.range(0),
+      /*ops_per_item=*/3));
 }
 BENCHMARK(BM_LoopSumBytecode)->Arg(100000);
 
+// global.load.ref + call (const + return) + add + cmp.lt.i32.s + cond_br per
+// iteration.
+static void BM_GlobalLoadCallBytecode(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(
+      state,
+      iree_make_cstring_view("bytecode_module_benchmark.global_load_call"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0),
+      /*ops_per_item=*/7));
+}
+BENCHMARK(BM_GlobalLoadCallBytecode)->Arg(100000);
+
 static void BM_BufferReduceReference(benchmark::State& state) {
   static auto work = +[](int32_t* buffer, int i, int sum) {
     int new_sum = buffer[i] + sum;
@@ -77,6 +77,27 @@ vm.module @bytecode_module_benchmark {
     vm.return %ie : i32
   }
 
+  // Measures the cost of loading a global and passing it to a call as is
+  // common in host code that loads devices/executables and calls into the HAL.
+  vm.global.ref private mutable @global_ref : !vm.buffer
+  vm.func private @ref_func(%arg0 : !vm.buffer) -> i32 attributes {noinline} {
+    %c1 = vm.const.i32 1
+    vm.return %c1 : i32
+  }
+  vm.export @global_load_call
+  vm.func @global_load_call(%count : i32) -> i32 {
+    %i0 = vm.const.i32.zero
+    vm.br ^loop(%i0 : i32)
+  ^loop(%i : i32):
+    %ref = vm.global.load.ref @global_ref : !vm.buffer
+    %inc = vm.call @ref_func(%ref) : (!vm.buffer) -> i32
+    %in = vm.add.i32 %i, %inc : i32
+    %cmp = vm.cmp.lt.i32.s %in, %count : i32
+    vm.cond_br %cmp, ^loop(%in : i32), ^loop_exit(%in : i32)
+  ^loop_exit(%ie : i32):
+    vm.return %ie : i32
+  }
+
   // Measures the cost of lots of buffer loads.
   vm.export @buffer_reduce
   vm.func @buffer_reduce(%count : i32) -> i32 {
@@ -18,6 +18,17 @@
 extern "C" {
 #endif  // __cplusplus
 
+// An open-addressed hash table mapping function names to their ordinals.
+// Built when the module is loaded so that lookups by name (such as those made
+// for each import when creating contexts) don't scan the FlatBuffer.
+typedef struct iree_vm_bytecode_function_name_index_t {
+  // Slot count minus one. The slot count is a power of two.
+  uint32_t mask;
+  // Slots holding function ordinals plus one or 0 if empty. NULL if the module
+  // has no functions of the indexed linkage.
+  uint32_t* slots;
+} iree_vm_bytecode_function_name_index_t;
+
 // A loaded bytecode module.
 typedef struct iree_vm_bytecode_module_t {
   // Interface routing to the bytecode module functions.
@@ -34,6 +45,13 @@ typedef struct iree_vm_bytecode_module_t {
   // A pointer to the bytecode data embedded within the module.
   iree_const_byte_span_t bytecode_data;
 
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  // A copy of |bytecode_data| owned by the module in which fusible op pairs
+  // have been rewritten into superinstructions during verification. Byte
+  // offsets match |bytecode_data| 1:1 and only the dispatcher uses this copy.
+  iree_byte_span_t dispatch_bytecode_data;
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
   // Allocator this module was allocated with and must be freed with.
   iree_allocator_t allocator;
 
@@ -44,6 +62,10 @@ typedef struct iree_vm_bytecode_module_t {
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+  // Indices of import full names and export local names.
+  iree_vm_bytecode_function_name_index_t import_name_index;
+  iree_vm_bytecode_function_name_index_t export_name_index;
+
   // Initialized references to rodata segments.
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
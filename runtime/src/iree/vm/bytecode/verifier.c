@@ -7,6 +7,7 @@
 #include "iree/vm/bytecode/verifier.h"
 
 #include "iree/base/internal/math.h"
+#include "iree/vm/bytecode/fusion.h"
 #include "iree/vm/bytecode/utils/block_list.h"
 #include "iree/vm/bytecode/utils/features.h"
 
@@ -375,6 +376,14 @@ iree_status_t iree_vm_bytecode_function_verify(
       function_descriptor->block_count, scratch_allocator,
       &verify_state.block_list));
 
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+  // Fused opcodes are written into the dispatch copy of the bytecode as pairs
+  // of verified ops are found.
+  uint8_t* dispatch_data = module->dispatch_bytecode_data.data +
+                           function_descriptor->bytecode_offset;
+  uint32_t previous_pc = UINT32_MAX;
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+
   // Perform bytecode verification by performing a single-pass walk of all
   // function bytecode.
   iree_status_t status = iree_ok_status();
@@ -383,6 +392,17 @@ iree_status_t iree_vm_bytecode_function_verify(
     status = iree_vm_bytecode_function_verify_bytecode_op(
         module, &verify_state, function_signature_def, function_descriptor,
         bytecode_data, start_pc, max_pc, &pc);
+#if IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
+    if (iree_status_is_ok(status)) {
+      // Both ops are verified and the second can only be reached by falling
+      // through from the first as branch targets are always block markers.
+      if (previous_pc != UINT32_MAX) {
+        dispatch_data[previous_pc] = iree_vm_bytecode_fuse_opcodes(
+            bytecode_data.data[previous_pc], bytecode_data.data[start_pc]);
+      }
+      previous_pc = start_pc;
+    }
+#endif  // IREE_VM_BYTECODE_DISPATCH_FUSION_ENABLE
     if (!iree_status_is_ok(status)) {
 #if IREE_STATUS_MODE
       // To get a useful source location we have to ask the main module; the
@@ -0,0 +1,247 @@
+// Tests for op sequences the bytecode verifier fuses into superinstructions
+// (see iree/vm/bytecode/fusion.h). Each pair must remain adjacent with the
+// result of the first op feeding the second: branches are checked both taken
+// and not taken so that both successors of the fused handler are exercised.
+vm.module @fused_ops {
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.eq.i32 + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_eq_i32_cond_br_taken
+  vm.func @test_cmp_eq_i32_cond_br_taken() {
+    %c1 = vm.const.i32 1
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.eq.i32 %c1dno, %c1 : i32
+    vm.cond_br %cond, ^bb1(%c1dno : i32), ^bb2
+  ^bb1(%arg0 : i32):
+    vm.check.eq %arg0, %c1, "branch operand" : i32
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_eq_i32_cond_br_not_taken
+  vm.func @test_cmp_eq_i32_cond_br_not_taken() {
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.eq.i32 %c1dno, %c2 : i32
+    vm.cond_br %cond, ^bb1, ^bb2(%c1dno : i32)
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2(%arg0 : i32):
+    vm.check.eq %arg0, %c1, "branch operand" : i32
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.ne.i32 + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_ne_i32_cond_br_taken
+  vm.func @test_cmp_ne_i32_cond_br_taken() {
+    %c1 = vm.const.i32 1
+    %c2 = vm.const.i32 2
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.ne.i32 %c1dno, %c2 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_ne_i32_cond_br_not_taken
+  vm.func @test_cmp_ne_i32_cond_br_not_taken() {
+    %c1 = vm.const.i32 1
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.ne.i32 %c1dno, %c1 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2:
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.lt.i32.s + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_lt_i32_s_cond_br_taken
+  vm.func @test_cmp_lt_i32_s_cond_br_taken() {
+    %cn1 = vm.const.i32 -1
+    %c1 = vm.const.i32 1
+    %cn1dno = util.optimization_barrier %cn1 : i32
+    %cond = vm.cmp.lt.i32.s %cn1dno, %c1 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_lt_i32_s_cond_br_not_taken
+  vm.func @test_cmp_lt_i32_s_cond_br_not_taken() {
+    %cn1 = vm.const.i32 -1
+    %c1 = vm.const.i32 1
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.lt.i32.s %c1dno, %cn1 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2:
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.lt.i32.u + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_lt_i32_u_cond_br_taken
+  vm.func @test_cmp_lt_i32_u_cond_br_taken() {
+    %cn1 = vm.const.i32 -1
+    %c1 = vm.const.i32 1
+    %c1dno = util.optimization_barrier %c1 : i32
+    %cond = vm.cmp.lt.i32.u %c1dno, %cn1 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_lt_i32_u_cond_br_not_taken
+  vm.func @test_cmp_lt_i32_u_cond_br_not_taken() {
+    %cn1 = vm.const.i32 -1
+    %c1 = vm.const.i32 1
+    %cn1dno = util.optimization_barrier %cn1 : i32
+    %cond = vm.cmp.lt.i32.u %cn1dno, %c1 : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2:
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.nz.i32 + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_nz_i32_cond_br_taken
+  vm.func @test_cmp_nz_i32_cond_br_taken() {
+    %c7 = vm.const.i32 7
+    %c7dno = util.optimization_barrier %c7 : i32
+    %cond = vm.cmp.nz.i32 %c7dno : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_nz_i32_cond_br_not_taken
+  vm.func @test_cmp_nz_i32_cond_br_not_taken() {
+    %c0 = vm.const.i32 0
+    %c0dno = util.optimization_barrier %c0 : i32
+    %cond = vm.cmp.nz.i32 %c0dno : i32
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2:
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.cmp.nz.ref + vm.cond_br
+  //===--------------------------------------------------------------------===//
+
+  vm.rodata private @buffer dense<[1, 2, 3]> : tensor<3xi8>
+
+  vm.export @test_cmp_nz_ref_cond_br_taken
+  vm.func @test_cmp_nz_ref_cond_br_taken() {
+    %ref = vm.const.ref.rodata @buffer : !vm.buffer
+    %refdno = util.optimization_barrier %ref : !vm.buffer
+    %cond = vm.cmp.nz.ref %refdno : !vm.buffer
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    vm.return
+  ^bb2:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch not taken"
+  }
+
+  vm.export @test_cmp_nz_ref_cond_br_not_taken
+  vm.func @test_cmp_nz_ref_cond_br_not_taken() {
+    %null = vm.const.ref.zero : !vm.buffer
+    %nulldno = util.optimization_barrier %null : !vm.buffer
+    %cond = vm.cmp.nz.ref %nulldno : !vm.buffer
+    vm.cond_br %cond, ^bb1, ^bb2
+  ^bb1:
+    %code = vm.const.i32 2
+    vm.fail %code, "branch taken"
+  ^bb2:
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.global.load.ref + vm.call
+  //===--------------------------------------------------------------------===//
+
+  vm.global.ref private mutable @g0 : !vm.buffer
+
+  vm.export @test_global_load_ref_call
+  vm.func @test_global_load_ref_call() {
+    %ref = vm.const.ref.rodata @buffer : !vm.buffer
+    vm.global.store.ref %ref, @g0 : !vm.buffer
+    %actual = vm.call @_load_g0_and_call() : () -> !vm.buffer
+    vm.check.eq %actual, %ref, "global ref not passed to callee" : !vm.buffer
+    vm.return
+  }
+
+  vm.func private @_load_g0_and_call() -> !vm.buffer attributes {noinline} {
+    %ref = vm.global.load.ref @g0 : !vm.buffer
+    %result = vm.call @_identity(%ref) : (!vm.buffer) -> !vm.buffer
+    vm.return %result : !vm.buffer
+  }
+
+  vm.func private @_identity(%arg0 : !vm.buffer) -> !vm.buffer
+      attributes {noinline} {
+    vm.return %arg0 : !vm.buffer
+  }
+
+  //===--------------------------------------------------------------------===//
+  // vm.global.load.ref + vm.call.variadic
+  //===--------------------------------------------------------------------===//
+
+  // Variadic calls may only target imports and no module providing one is
+  // registered in the test context: the fused load runs and the call must then
+  // fail as the optional import is not resolved.
+  vm.import private optional @reserved.optional_variadic(%bufs : !vm.buffer ...)
+
+  vm.export @fail_global_load_ref_call_variadic
+  vm.func @fail_global_load_ref_call_variadic() {
+    %ref = vm.const.ref.rodata @buffer : !vm.buffer
+    vm.global.store.ref %ref, @g0 : !vm.buffer
+    vm.call @_load_g0_and_call_variadic() : () -> ()
+    %code = vm.const.i32 4
+    vm.fail %code, "unreachable!"
+  }
+
+  vm.func private @_load_g0_and_call_variadic() attributes {noinline} {
+    %ref = vm.global.load.ref @g0 : !vm.buffer
+    vm.call.variadic @reserved.optional_variadic([%ref]) : (!vm.buffer ...) -> ()
+    vm.return
+  }
+
+}
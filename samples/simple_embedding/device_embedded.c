@@ -29,7 +29,8 @@ iree_status_t create_sample_device(iree_allocator_t host_allocator,
 
   iree_hal_executable_loader_t* loader = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_embedded_elf_loader_create(
-      /*plugin_manager=*/NULL, host_allocator, &loader));
+      IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE, /*plugin_manager=*/NULL,
+      host_allocator, &loader));
 
   // NOTE: hardcoded maximum executor count for this sample to keep it simple.
   iree_task_executor_t* executors[8] = {NULL};
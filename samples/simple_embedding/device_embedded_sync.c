@@ -35,7 +35,8 @@ iree_status_t create_sample_device(iree_allocator_t host_allocator,
 
   iree_hal_executable_loader_t* loader = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_embedded_elf_loader_create(
-      /*plugin_manager=*/NULL, host_allocator, &loader));
+      IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE, /*plugin_manager=*/NULL,
+      host_allocator, &loader));
 
   iree_string_view_t identifier = iree_make_cstring_view("local-sync");
 